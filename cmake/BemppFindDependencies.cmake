@@ -24,6 +24,11 @@ if (WITH_AHMED)
     set(AHMED_LIB "" CACHE PATH "Full path to AHMED library")
 endif ()
 
+# zlib (optional, used only if WITH_ZLIB is set)
+if (WITH_ZLIB)
+    find_package(ZLIB REQUIRED)
+endif ()
+
 # CUDA support
 if (WITH_CUDA)
    FIND_PACKAGE(CUDA)
@@ -5,6 +5,7 @@ option(WITH_AHMED "Link to the AHMED library to enable ACA mode assembly)" OFF)
 option(WITH_OPENCL "Add OpenCL support for Fiber module" OFF)
 option(WITH_CUDA "Add CUDA support for Fiber module" OFF)
 option(WITH_ALUGRID "Have Alugrid" OFF)
+option(WITH_ZLIB "Enable zlib-compressed VTK output" OFF)
 option(WITH_MKL "Use Intel MKL for BLAS and LAPACK functionality" OFF)
 option(WITH_GOTOBLAS "Use GotoBLAS for BLAS and LAPACK functionality" OFF)
 option(WITH_OPENBLAS "Use OpenBLAS for BLAS and LAPACK functionality" OFF)
@@ -28,7 +28,14 @@
 #include "evaluation_options.hpp"
 #include "index_permutation.hpp"
 #include "discrete_boundary_operator_composition.hpp"
+#include "discrete_h2_matrix_boundary_operator.hpp"
+#include "discrete_h_matrix_boundary_operator.hpp"
 #include "discrete_sparse_boundary_operator.hpp"
+#include "h2_matrix.hpp"
+#include "h_matrix.hpp"
+#include "h_matrix_aca.hpp"
+#include "h_matrix_cluster.hpp"
+#include "weak_form_aca_assembly_helper.hpp"
 
 #include "../common/armadillo_fwd.hpp"
 #include "../common/auto_timer.hpp"
@@ -70,7 +77,6 @@
 #include "modified_aca.hpp"
 #include "potential_operator_aca_assembly_helper.hpp"
 #include "scattered_range.hpp"
-#include "weak_form_aca_assembly_helper.hpp"
 #endif
 
 // #define DUMP_DENSE_BLOCKS // if defined, contents and DOF lists of blocks
@@ -456,7 +462,247 @@ assembleAcaOperator(
     return acaOp;
 }
 
-#endif
+#endif // WITH_AHMED
+
+// Adapter exposing the weak-form assembly helper to the built-in H-matrix code
+template <typename BasisFunctionType, typename ResultType>
+class WeakFormHMatrixEntryGenerator : public HMatrixEntryGenerator<ResultType>
+{
+public:
+    typedef HMatrixEntryGenerator<ResultType> Base;
+    typedef typename Base::CoordinateType CoordinateType;
+    typedef WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType> Helper;
+
+    explicit WeakFormHMatrixEntryGenerator(const Helper& helper) :
+        m_helper(helper)
+    {
+    }
+
+    virtual void evaluate(size_t rowBegin, size_t rowCount,
+                          size_t columnBegin, size_t columnCount,
+                          CoordinateType minimumDistance,
+                          arma::Mat<ResultType>& result) const {
+        result.set_size(rowCount, columnCount);
+        m_helper.evaluateBlock(rowBegin, rowCount, columnBegin, columnCount,
+                               minimumDistance, result.memptr());
+    }
+
+private:
+    const Helper& m_helper;
+};
+
+template <typename BasisFunctionType>
+shared_ptr<const HMatrixCluster<
+    typename Fiber::ScalarTraits<BasisFunctionType>::RealType> >
+constructHMatrixClusterTree(
+        const Space<BasisFunctionType>& space, bool indexWithGlobalDofs,
+        const AcaOptions& acaOptions,
+        shared_ptr<IndexPermutation>& o2pPermutation,
+        shared_ptr<IndexPermutation>& p2oPermutation)
+{
+    typedef typename Fiber::ScalarTraits<BasisFunctionType>::RealType
+            CoordinateType;
+    std::vector<Point3D<CoordinateType> > dofCenters;
+    if (indexWithGlobalDofs)
+        space.getGlobalDofPositions(dofCenters);
+    else
+        space.getFlatLocalDofPositions(dofCenters);
+
+    // Trees built earlier for the same DOF positions (e.g. by the assembly
+    // of another operator defined on the same space) are reused
+    shared_ptr<const std::vector<unsigned int> > p2oDofs;
+    shared_ptr<const HMatrixCluster<CoordinateType> > tree =
+            sharedClusterTree(dofCenters, acaOptions.minimumBlockSize, p2oDofs);
+    std::vector<unsigned int> o2pDofs(p2oDofs->size());
+    for (size_t i = 0; i < p2oDofs->size(); ++i)
+        o2pDofs[(*p2oDofs)[i]] = i;
+    o2pPermutation.reset(new IndexPermutation(o2pDofs));
+    p2oPermutation.reset(new IndexPermutation(*p2oDofs));
+    return tree;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::auto_ptr<DiscreteBoundaryOperator<ResultType> >
+assembleWeakFormWithBuiltInHMatrix(
+        const Space<BasisFunctionType>& testSpace,
+        const Space<BasisFunctionType>& trialSpace,
+        const std::vector<Fiber::LocalAssemblerForOperators<ResultType>*>&
+        localAssemblers,
+        const std::vector<const DiscreteBoundaryOperator<ResultType>*>&
+        sparseTermsToAdd,
+        const std::vector<ResultType>& denseTermMultipliers,
+        const std::vector<ResultType>& sparseTermMultipliers,
+        const AssemblyOptions& options,
+        int symmetry)
+{
+    typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+    typedef DiscreteBoundaryOperator<ResultType> DiscreteBndOp;
+
+    const AcaOptions& acaOptions = options.acaOptions();
+    const ParallelizationOptions& parallelOptions =
+            options.parallelizationOptions();
+    const bool indexWithGlobalDofs = acaOptions.globalAssemblyBeforeCompression;
+    const bool verbosityAtLeastDefault =
+            (options.verbosityLevel() >= VerbosityLevel::DEFAULT);
+    const bool verbosityAtLeastHigh =
+            (options.verbosityLevel() >= VerbosityLevel::HIGH);
+
+    // The built-in H-matrices do not exploit symmetry (yet)
+    if ((symmetry & (SYMMETRIC | HERMITIAN)) && verbosityAtLeastDefault)
+        std::cout << "Warning: the built-in H-matrix implementation does not "
+                     "support symmetric or Hermitian H-matrices yet. "
+                     "A general H-matrix will be assembled" << std::endl;
+
+#ifndef WITH_TRILINOS
+    if (!indexWithGlobalDofs)
+        throw std::runtime_error("AcaGlobalAssembler::assembleDetachedWeakForm(): "
+                                 "ACA assembly with globalAssemblyBeforeCompression "
+                                 "set to false requires BEM++ to be linked with "
+                                 "Trilinos");
+#endif // WITH_TRILINOS
+
+    int maxThreadCount = 1;
+    if (!parallelOptions.isOpenClEnabled())
+    {
+        if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+            maxThreadCount = tbb::task_scheduler_init::automatic;
+        else
+            maxThreadCount = parallelOptions.maxThreadCount();
+    }
+    tbb::task_scheduler_init scheduler(maxThreadCount);
+
+    // o2p: map of original indices to permuted indices
+    // p2o: map of permuted indices to original indices
+    shared_ptr<IndexPermutation> test_o2pPermutation, test_p2oPermutation;
+    shared_ptr<const Cluster> testClusterTree =
+            constructHMatrixClusterTree(testSpace, indexWithGlobalDofs,
+                                        acaOptions, test_o2pPermutation,
+                                        test_p2oPermutation);
+    shared_ptr<IndexPermutation> trial_o2pPermutation, trial_p2oPermutation;
+    shared_ptr<const Cluster> trialClusterTree;
+    if (&testSpace == &trialSpace) {
+        trialClusterTree = testClusterTree;
+        trial_o2pPermutation = test_o2pPermutation;
+        trial_p2oPermutation = test_p2oPermutation;
+    } else
+        trialClusterTree =
+                constructHMatrixClusterTree(trialSpace, indexWithGlobalDofs,
+                                            acaOptions, trial_o2pPermutation,
+                                            trial_p2oPermutation);
+
+    if (verbosityAtLeastHigh)
+        std::cout << "Test cluster count: " << testClusterTree->clusterCount()
+                  << "\nTrial cluster count: " << trialClusterTree->clusterCount()
+                  << std::endl;
+
+    shared_ptr<HMatrix<ResultType> > hMatrix(
+                new HMatrix<ResultType>(testClusterTree, trialClusterTree,
+                                        acaOptions));
+
+    if (verbosityAtLeastHigh)
+        std::cout << "Leaf block count: " << hMatrix->leaves().size()
+                  << std::endl;
+
+    typedef WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>
+            AcaAssemblyHelper;
+    AcaAssemblyHelper helper(
+                testSpace, trialSpace,
+                test_p2oPermutation->permutedIndices(),
+                trial_p2oPermutation->permutedIndices(),
+                localAssemblers, sparseTermsToAdd,
+                denseTermMultipliers, sparseTermMultipliers, options);
+    WeakFormHMatrixEntryGenerator<BasisFunctionType, ResultType>
+            generator(helper);
+
+    if (verbosityAtLeastDefault)
+        std::cout << "About to start the ACA assembly loop" << std::endl;
+    tbb::tick_count loopStart = tbb::tick_count::now();
+    {
+        Fiber::SerialBlasRegion region; // if possible, ensure that BLAS is single-threaded
+        fillHMatrix(*hMatrix, generator,
+                    acaOptions.eps, acaOptions.maximumRank);
+        if (acaOptions.recompress) {
+            if (verbosityAtLeastDefault)
+                std::cout << "About to start ACA agglomeration" << std::endl;
+            hMatrix->coarsen(acaOptions.eps, acaOptions.maximumRank);
+        }
+    }
+    tbb::tick_count loopEnd = tbb::tick_count::now();
+
+    const size_t testDofCount = hMatrix->rowCount();
+    const size_t trialDofCount = hMatrix->columnCount();
+    if (verbosityAtLeastDefault) {
+        std::cout << "ACA loop took " << (loopEnd - loopStart).seconds() << " s"
+                  << std::endl;
+        size_t totalEntryCount = testDofCount * trialDofCount;
+        size_t origMemory = sizeof(ResultType) * totalEntryCount;
+        size_t hMatrixMemory = sizeof(ResultType) * hMatrix->storedEntryCount();
+        size_t accessedEntryCount = helper.accessedEntryCount();
+        double accessedFraction = double(accessedEntryCount) / totalEntryCount;
+        std::cout << "\nNeeded storage: "
+                  << hMatrixMemory / 1024. / 1024. << " MB.\n"
+                  << "Without approximation: "
+                  << origMemory / 1024. / 1024. << " MB.\n"
+                  << "Compressed to "
+                  << (100. * hMatrixMemory) / origMemory << "%.\n"
+                  << "Maximum rank: " << hMatrix->maximumRank() << ".\n"
+                  << "Accessed "
+                  << 100. * accessedFraction << "% matrix entries.\n"
+                  << std::endl;
+    }
+
+    std::auto_ptr<DiscreteBndOp> hMatrixOp;
+    if (acaOptions.useNestedBases) {
+        if (verbosityAtLeastDefault)
+            std::cout << "About to start conversion to an H2-matrix"
+                      << std::endl;
+        shared_ptr<const H2Matrix<ResultType> > h2Matrix(
+                    new H2Matrix<ResultType>(*hMatrix, acaOptions.eps,
+                                             acaOptions.maximumRank));
+        hMatrix.reset();
+        if (verbosityAtLeastDefault)
+            std::cout << "H2-matrix storage: "
+                      << sizeof(ResultType) * h2Matrix->storedEntryCount() /
+                         1024. / 1024. << " MB.\n"
+                      << "Maximum cluster basis rank: "
+                      << h2Matrix->maximumRank() << ".\n" << std::endl;
+        hMatrixOp.reset(new DiscreteH2MatrixBoundaryOperator<ResultType>(
+                            h2Matrix,
+                            *trial_o2pPermutation, // domain
+                            *test_o2pPermutation, // range
+                            acaOptions.eps, acaOptions.maximumRank,
+                            parallelOptions));
+    } else
+        hMatrixOp.reset(new DiscreteHMatrixBoundaryOperator<ResultType>(
+                            hMatrix,
+                            *trial_o2pPermutation, // domain
+                            *test_o2pPermutation, // range
+                            acaOptions.eps, acaOptions.maximumRank,
+                            parallelOptions));
+
+    std::auto_ptr<DiscreteBndOp> result;
+    if (indexWithGlobalDofs)
+        result = hMatrixOp;
+    else {
+#ifdef WITH_TRILINOS
+        // without Trilinos, this code will never be reached -- an exception
+        // will be thrown earlier in this function
+        typedef DiscreteBoundaryOperatorComposition<ResultType> DiscreteBndOpComp;
+        shared_ptr<DiscreteBndOp> hMatrixOpShared(hMatrixOp.release());
+        shared_ptr<DiscreteBndOp> trialGlobalToLocal =
+                constructOperatorMappingGlobalToFlatLocalDofs<
+                BasisFunctionType, ResultType>(trialSpace);
+        shared_ptr<DiscreteBndOp> testLocalToGlobal =
+                constructOperatorMappingFlatLocalToGlobalDofs<
+                BasisFunctionType, ResultType>(testSpace);
+        shared_ptr<DiscreteBndOp> tmp(
+                    new DiscreteBndOpComp(hMatrixOpShared, trialGlobalToLocal));
+        result.reset(new DiscreteBndOpComp(testLocalToGlobal, tmp));
+#endif // WITH_TRILINOS
+    }
+    return result;
+}
 
 } // namespace
 
@@ -472,6 +718,13 @@ AcaGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
         const AssemblyOptions& options,
         int symmetry)
 {
+    if (options.acaOptions().backend == AcaOptions::BUILT_IN ||
+            options.acaOptions().useNestedBases)
+        return assembleWeakFormWithBuiltInHMatrix(
+                    testSpace, trialSpace, localAssemblers, sparseTermsToAdd,
+                    denseTermMultipliers, sparseTermMultipliers,
+                    options, symmetry);
+
 #ifdef WITH_AHMED
     typedef AhmedDofWrapper<CoordinateType> AhmedDofType;
     typedef ExtendedBemCluster<AhmedDofType> AhmedBemCluster;
@@ -627,8 +880,10 @@ AcaGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
 
 #else // without Ahmed
     throw std::runtime_error("AcaGlobalAssembler::assembleDetachedWeakForm(): "
-                             "To enable assembly in ACA mode, recompile BEM++ "
-                             "with the symbol WITH_AHMED defined.");
+                             "To enable assembly in ACA mode with the AHMED "
+                             "backend, recompile BEM++ with the symbol "
+                             "WITH_AHMED defined, or set AcaOptions::backend "
+                             "to AcaOptions::BUILT_IN.");
 #endif // WITH_AHMED
 }
 
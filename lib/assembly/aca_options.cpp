@@ -19,6 +19,9 @@
 // THE SOFTWARE.
 
 #include "aca_options.hpp"
+
+#include "bempp/common/config_ahmed.hpp"
+
 #include <limits>
 
 namespace Bempp
@@ -35,7 +38,13 @@ AcaOptions::AcaOptions() :
     outputPostscript(false),
     outputFname("aca.ps"),
     scaling(1.0),
-    useAhmedAca(false)
+    useAhmedAca(false),
+#ifdef WITH_AHMED
+    backend(AHMED),
+#else
+    backend(BUILT_IN),
+#endif
+    useNestedBases(false)
 {
 }
 
@@ -33,6 +33,15 @@ namespace Bempp
  */
 struct AcaOptions
 {
+    /** \brief Possible choices of the H-matrix implementation. */
+    enum Backend {
+        /** \brief Use the AHMED library (available only if BEM++ has been
+         *  compiled with AHMED support). */
+        AHMED,
+        /** \brief Use the H-matrix code built into BEM++. */
+        BUILT_IN
+    };
+
     /** \brief Initialize ACA parameters to default values. */
     AcaOptions();
 
@@ -116,6 +125,36 @@ struct AcaOptions
      *  Default value: false.
      */
     bool useAhmedAca;
+    /** \brief H-matrix implementation used to store and manipulate the
+     *  approximated operators.
+     *
+     *  The built-in implementation constructs the cluster trees, performs
+     *  ACA+ and recompression, and provides matrix-vector multiplication and
+     *  H-LU decomposition without relying on AHMED. It currently supports
+     *  only the assembly of weak forms of boundary operators; potential
+     *  operators are always approximated with AHMED. The option
+     *  useAhmedAca is ignored by the built-in implementation.
+     *
+     *  Default value: AHMED if BEM++ has been compiled with AHMED support,
+     *  BUILT_IN otherwise. */
+    Backend backend;
+    /** \brief Convert H-matrices to H2-matrices?
+     *
+     *  If true, the H-matrix produced by ACA is recompressed into an
+     *  H2-matrix, whose blocks share nested row and column cluster bases.
+     *  This reduces the memory consumption and the cost of matrix-vector
+     *  products from O(N log N) to O(N), which pays off particularly for
+     *  large problems involving non-oscillatory (e.g. Laplace) kernels. The
+     *  resulting operator is a DiscreteH2MatrixBoundaryOperator, which does
+     *  not support H-matrix arithmetic (e.g. the approximate LU
+     *  decomposition).
+     *
+     *  H2-matrices are constructed with the built-in H-matrix implementation,
+     *  which is used regardless of the value of \p backend if this option
+     *  is set.
+     *
+     *  Default value: false. */
+    bool useNestedBases;
 };
 
 } // namespace Bempp
@@ -804,18 +804,6 @@ shared_ptr<const DiscreteBoundaryOperator<ValueType> > scaledAcaOperator(
     return scaledAcaOperator(multiplier, op);
 }
 
-template <typename ValueType>
-shared_ptr<const DiscreteBoundaryOperator<ValueType> > acaOperatorApproximateLuInverse(
-        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
-        double delta)
-{
-    shared_ptr<const DiscreteAcaBoundaryOperator<ValueType> > acaOp =
-            DiscreteAcaBoundaryOperator<ValueType>::castToAca(op);
-    shared_ptr<const DiscreteBoundaryOperator<ValueType> > result(
-                new AcaApproximateLuInverse<ValueType>(*acaOp, delta));
-    return result;
-}
-
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteAcaBoundaryOperator);
 
 #define INSTANTIATE_FREE_FUNCTIONS(RESULT) \
@@ -831,11 +819,7 @@ FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteAcaBoundaryOperator);
     template shared_ptr<const DiscreteBoundaryOperator<RESULT> > \
         scaledAcaOperator( \
             const shared_ptr<const DiscreteBoundaryOperator<RESULT> >& op, \
-            const RESULT& multiplier); \
-    template shared_ptr<const DiscreteBoundaryOperator<RESULT> > \
-        acaOperatorApproximateLuInverse( \
-            const shared_ptr<const DiscreteBoundaryOperator<RESULT> >& op, \
-            double delta)
+            const RESULT& multiplier)
 
 #if defined(ENABLE_SINGLE_PRECISION)
 INSTANTIATE_FREE_FUNCTIONS(float);
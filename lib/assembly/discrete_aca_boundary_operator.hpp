@@ -31,6 +31,7 @@
 #include "discrete_boundary_operator.hpp"
 #include "ahmed_aux_fwd.hpp"
 #include "assembly_options.hpp" // actually only ParallelizationOptions are needed
+#include "h_matrix_approximate_lu_inverse.hpp" // acaOperatorApproximateLuInverse()
 #include "index_permutation.hpp"
 #include "symmetry.hpp"
 #include "../fiber/scalar_traits.hpp"
@@ -107,19 +108,6 @@ shared_ptr<const DiscreteBoundaryOperator<ValueType> > scaledAcaOperator(
 //        const shared_ptr<const DiscreteAcaBoundaryOperator<ValueType> >& op2,
 //        double eps, int maximumRank);
 
-/** \brief LU inverse of a discrete boundary operator stored as a H-matrix.
- *
- *  \param[in] op Discrete boundary operator for which to compute the LU inverse.
- *  \param[in] delta Approximation accuracy of the inverse.
- *
- *  \return A shared pointer to a newly allocated discrete boundary operator
- *  representing the (approximate) LU inverse of \p op and stored as
- *  an (approximate) LU decomposition of \p op. */
-template <typename ValueType>
-shared_ptr<const DiscreteBoundaryOperator<ValueType> > acaOperatorApproximateLuInverse(
-        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
-        double delta);
-
 // class DiscreteAcaBoundaryOperator
 
 /** \ingroup discrete_boundary_operators
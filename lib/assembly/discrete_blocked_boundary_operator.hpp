@@ -82,6 +82,13 @@ public:
     /** \brief return the block component at position (i,j) in the block operator matrix. */
     virtual shared_ptr<const DiscreteBoundaryOperator<ValueType> > getComponent(int row, int col) const;
 
+    /** \brief Return the vector whose <em>i</em>th element is the number of
+     *  rows of the operators in <em>i</em>th block row. */
+    const std::vector<size_t>& blockRowCounts() const { return m_rowCounts; }
+    /** \brief Return the vector whose <em>j</em>th element is the number of
+     *  columns of the operators in <em>j</em>th block column. */
+    const std::vector<size_t>& blockColumnCounts() const { return m_columnCounts; }
+
     virtual void addBlock(const std::vector<int>& rows,
                           const std::vector<int>& cols,
                           const ValueType alpha,
@@ -30,6 +30,7 @@
 
 #include "../fiber/explicit_instantiation.hpp"
 
+#include <Thyra_DetachedMultiVectorView.hpp>
 #include <Thyra_DetachedSpmdVectorView.hpp>
 
 namespace Bempp
@@ -79,6 +80,18 @@ DiscreteBoundaryOperator<ValueType>::apply(
                                     "vectors x_in and y_inout must have "
                                     "the same number of columns");
 
+    applyBuiltInImplMultiple(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void
+DiscreteBoundaryOperator<ValueType>::applyBuiltInImplMultiple(
+        const TranspositionMode trans,
+        const arma::Mat<ValueType>& x_in,
+        arma::Mat<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta) const
+{
     for (size_t i = 0; i < x_in.n_cols; ++i) {
         const arma::Col<ValueType> x_in_col = x_in.unsafe_col(i);
         arma::Col<ValueType> y_inout_col = y_inout.unsafe_col(i);
@@ -130,8 +143,30 @@ void DiscreteBoundaryOperator<ValueType>::applyImpl(
     TEUCHOS_ASSERT(Y_inout->range()->isCompatible(*this->range()));
     TEUCHOS_ASSERT(Y_inout->domain()->isCompatible(*X_in.domain()));
 
+    const Ordinal rowCountIn = X_in.range()->dim();
+    const Ordinal rowCountOut = Y_inout->range()->dim();
     const Ordinal colCount = X_in.domain()->dim();
 
+    if (colCount > 1) {
+        // If both multivectors are stored contiguously, process all columns
+        // in one go
+        Thyra::ConstDetachedMultiVectorView<ValueType> xView(
+                    Teuchos::rcpFromRef(X_in));
+        Thyra::DetachedMultiVectorView<ValueType> yView(
+                    Teuchos::rcpFromPtr(Y_inout));
+        if (xView.leadingDim() == rowCountIn &&
+                yView.leadingDim() == rowCountOut) {
+            const arma::Mat<ValueType> xMat(
+                        const_cast<ValueType*>(xView.values()),
+                        rowCountIn, colCount, false /* copy_aux_mem */);
+            arma::Mat<ValueType> yMat(yView.values(), rowCountOut, colCount,
+                                      false /* copy_aux_mem */);
+            applyBuiltInImplMultiple(static_cast<TranspositionMode>(M_trans),
+                                     xMat, yMat, alpha, beta);
+            return;
+        }
+    }
+
     // Loop over the input columns
 
     for (Ordinal col = 0; col < colCount; ++col) {
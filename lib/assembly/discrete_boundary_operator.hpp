@@ -234,6 +234,20 @@ private:
                                   arma::Col<ValueType>& y_inout,
                                   const ValueType alpha,
                                   const ValueType beta) const = 0;
+
+    /** \brief Apply the operator to all columns of a matrix at once.
+     *
+     *  This function is called by both overloads of apply() acting on
+     *  multivectors, e.g. by block Krylov solvers. The default
+     *  implementation calls applyBuiltInImpl() on each column in turn.
+     *  Subclasses able to process several vectors more efficiently than one
+     *  at a time (for instance with a single matrix-matrix product) should
+     *  override it. */
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
 };
 
 /** \brief Unary plus: return a copy of the argument. */
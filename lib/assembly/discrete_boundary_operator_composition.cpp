@@ -112,6 +112,25 @@ applyBuiltInImpl(const TranspositionMode trans,
     }
 }
 
+template <typename ValueType>
+void DiscreteBoundaryOperatorComposition<ValueType>::
+applyBuiltInImplMultiple(const TranspositionMode trans,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta) const
+{
+    if (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE) {
+        arma::Mat<ValueType> tmp(m_outer->columnCount(), x_in.n_cols);
+        m_outer->apply(trans, x_in, tmp, alpha, 0.);
+        m_inner->apply(trans, tmp, y_inout, 1., beta);
+    } else {
+        arma::Mat<ValueType> tmp(m_inner->rowCount(), x_in.n_cols);
+        m_inner->apply(trans, x_in, tmp, alpha, 0.);
+        m_outer->apply(trans, tmp, y_inout, 1., beta);
+    }
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteBoundaryOperatorComposition);
 
 } // namespace Bempp
@@ -56,6 +56,11 @@ public:
     DiscreteBoundaryOperatorComposition(const shared_ptr<const Base>& outer,
                                         const shared_ptr<const Base>& inner);
 
+    /** \brief Return the outer (second applied) factor. */
+    shared_ptr<const Base> outer() const { return m_outer; }
+    /** \brief Return the inner (first applied) factor. */
+    shared_ptr<const Base> inner() const { return m_inner; }
+
     virtual unsigned int rowCount() const;
     virtual unsigned int columnCount() const;
 
@@ -79,6 +84,11 @@ private:
                                   arma::Col<ValueType>& y_inout,
                                   const ValueType alpha,
                                   const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
 private:
     /** \cond PRIVATE */
     shared_ptr<const Base> m_outer, m_inner;
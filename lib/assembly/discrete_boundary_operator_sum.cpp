@@ -140,6 +140,19 @@ applyBuiltInImpl(const TranspositionMode trans,
                   1. /* "+ beta * y_inout" has already been done */ );
 }
 
+template <typename ValueType>
+void DiscreteBoundaryOperatorSum<ValueType>::
+applyBuiltInImplMultiple(const TranspositionMode trans,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta) const
+{
+    m_term1->apply(trans, x_in, y_inout, alpha, beta);
+    m_term2->apply(trans, x_in, y_inout, alpha,
+                  1. /* "+ beta * y_inout" has already been done */ );
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteBoundaryOperatorSum);
 
 } // namespace Bempp
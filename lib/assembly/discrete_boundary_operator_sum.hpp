@@ -56,6 +56,11 @@ public:
     DiscreteBoundaryOperatorSum(const shared_ptr<const Base>& term1,
                                 const shared_ptr<const Base>& term2);
 
+    /** \brief Return the first term. */
+    shared_ptr<const Base> term1() const { return m_term1; }
+    /** \brief Return the second term. */
+    shared_ptr<const Base> term2() const { return m_term2; }
+
     virtual arma::Mat<ValueType> asMatrix() const;
 
     virtual unsigned int rowCount() const;
@@ -87,6 +92,11 @@ private:
                                   arma::Col<ValueType>& y_inout,
                                   const ValueType alpha,
                                   const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
 private:
     /** \cond PRIVATE */
     shared_ptr<const Base> m_term1, m_term2;
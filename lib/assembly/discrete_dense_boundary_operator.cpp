@@ -143,6 +143,41 @@ void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInImpl(
     }
 }
 
+template <typename ValueType>
+void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInImplMultiple(
+        const TranspositionMode trans,
+        const arma::Mat<ValueType>& x_in,
+        arma::Mat<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta) const
+{
+    // All columns are processed by a single matrix-matrix product
+    if (beta == static_cast<ValueType>(0.))
+        y_inout.fill(static_cast<ValueType>(0.));
+    else
+        y_inout *= beta;
+
+    switch (trans)
+    {
+    case NO_TRANSPOSE:
+        y_inout += alpha * m_mat * x_in;
+        break;
+    case CONJUGATE:
+        y_inout += alpha * arma::conj(m_mat) * x_in;
+        break;
+    case TRANSPOSE:
+        y_inout += alpha * m_mat.st() * x_in;
+        break;
+    case CONJUGATE_TRANSPOSE:
+        y_inout += alpha * m_mat.t() * x_in;
+        break;
+    default:
+        throw std::invalid_argument(
+                "DiscreteDenseBoundaryOperator::applyBuiltInImplMultiple(): "
+                "invalid transposition mode");
+    }
+}
+
 template <typename ValueType>
 shared_ptr<DiscreteDenseBoundaryOperator<ValueType> > discreteDenseBoundaryOperator(
         const arma::Mat<ValueType>& mat)
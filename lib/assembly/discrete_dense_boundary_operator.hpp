@@ -76,6 +76,11 @@ private:
                                   arma::Col<ValueType>& y_inout,
                                   const ValueType alpha,
                                   const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
 
 private:
     /** \cond PRIVATE */
@@ -0,0 +1,260 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "discrete_h2_matrix_boundary_operator.hpp"
+
+#include "h2_matrix.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <stdexcept>
+#include <typeinfo>
+
+#include <boost/pointer_cast.hpp>
+#include <tbb/task_scheduler_init.h>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceDefaultBase.hpp>
+#endif
+
+namespace Bempp
+{
+
+template <typename ValueType>
+DiscreteH2MatrixBoundaryOperator<ValueType>::DiscreteH2MatrixBoundaryOperator(
+        const shared_ptr<const H2Matrix<ValueType> >& h2Matrix,
+        const IndexPermutation& domainPermutation,
+        const IndexPermutation& rangePermutation,
+        double eps, int maximumRank,
+        const ParallelizationOptions& parallelizationOptions) :
+    m_h2Matrix(h2Matrix),
+#ifdef WITH_TRILINOS
+    m_domainSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+                      h2Matrix->columnCount())),
+    m_rangeSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+                     h2Matrix->rowCount())),
+#endif
+    m_domainPermutation(domainPermutation),
+    m_rangePermutation(rangePermutation),
+    m_eps(eps),
+    m_maximumRank(maximumRank),
+    m_parallelizationOptions(parallelizationOptions)
+{
+    if (m_domainPermutation.size() != h2Matrix->columnCount() ||
+            m_rangePermutation.size() != h2Matrix->rowCount())
+        throw std::invalid_argument(
+                "DiscreteH2MatrixBoundaryOperator::"
+                "DiscreteH2MatrixBoundaryOperator(): "
+                "permutation sizes do not match the H2-matrix size");
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> DiscreteH2MatrixBoundaryOperator<ValueType>::asMatrix() const
+{
+    const arma::Mat<ValueType> permutedMatrix = m_h2Matrix->asMatrix();
+    const unsigned int nRows = rowCount();
+    const unsigned int nCols = columnCount();
+    arma::Mat<ValueType> result(nRows, nCols);
+    for (unsigned int col = 0; col < nCols; ++col) {
+        const unsigned int permutedCol = m_domainPermutation.permuted(col);
+        for (unsigned int row = 0; row < nRows; ++row)
+            result(row, col) = permutedMatrix(
+                        m_rangePermutation.permuted(row), permutedCol);
+    }
+    return result;
+}
+
+template <typename ValueType>
+unsigned int DiscreteH2MatrixBoundaryOperator<ValueType>::rowCount() const
+{
+    return m_h2Matrix->rowCount();
+}
+
+template <typename ValueType>
+unsigned int DiscreteH2MatrixBoundaryOperator<ValueType>::columnCount() const
+{
+    return m_h2Matrix->columnCount();
+}
+
+template <typename ValueType>
+void DiscreteH2MatrixBoundaryOperator<ValueType>::addBlock(
+        const std::vector<int>& rows,
+        const std::vector<int>& cols,
+        const ValueType alpha,
+        arma::Mat<ValueType>& block) const
+{
+    if (block.n_rows != rows.size() || block.n_cols != cols.size())
+        throw std::invalid_argument(
+                "DiscreteH2MatrixBoundaryOperator::addBlock(): "
+                "incorrect block size");
+    for (size_t col = 0; col < cols.size(); ++col) {
+        const unsigned int permutedCol = m_domainPermutation.permuted(cols[col]);
+        for (size_t row = 0; row < rows.size(); ++row)
+            block(row, col) += alpha * m_h2Matrix->entry(
+                        m_rangePermutation.permuted(rows[row]), permutedCol);
+    }
+}
+
+template <typename ValueType>
+const DiscreteH2MatrixBoundaryOperator<ValueType>&
+DiscreteH2MatrixBoundaryOperator<ValueType>::castToH2Matrix(
+        const DiscreteBoundaryOperator<ValueType>& discreteOperator)
+{
+    return dynamic_cast<const DiscreteH2MatrixBoundaryOperator<ValueType>&>(
+                discreteOperator);
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteH2MatrixBoundaryOperator<ValueType> >
+DiscreteH2MatrixBoundaryOperator<ValueType>::castToH2Matrix(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >&
+        discreteOperator)
+{
+    shared_ptr<const DiscreteH2MatrixBoundaryOperator<ValueType> > result =
+        boost::dynamic_pointer_cast<const DiscreteH2MatrixBoundaryOperator<ValueType> >(
+                discreteOperator);
+    if (result.get() == 0 && discreteOperator.get() != 0)
+        throw std::bad_cast();
+    return result;
+}
+
+template <typename ValueType>
+shared_ptr<const H2Matrix<ValueType> >
+DiscreteH2MatrixBoundaryOperator<ValueType>::h2Matrix() const
+{
+    return m_h2Matrix;
+}
+
+template <typename ValueType>
+double DiscreteH2MatrixBoundaryOperator<ValueType>::eps() const
+{
+    return m_eps;
+}
+
+template <typename ValueType>
+int DiscreteH2MatrixBoundaryOperator<ValueType>::maximumRank() const
+{
+    return m_maximumRank;
+}
+
+template <typename ValueType>
+int DiscreteH2MatrixBoundaryOperator<ValueType>::actualMaximumRank() const
+{
+    return m_h2Matrix->maximumRank();
+}
+
+template <typename ValueType>
+const IndexPermutation&
+DiscreteH2MatrixBoundaryOperator<ValueType>::domainPermutation() const
+{
+    return m_domainPermutation;
+}
+
+template <typename ValueType>
+const IndexPermutation&
+DiscreteH2MatrixBoundaryOperator<ValueType>::rangePermutation() const
+{
+    return m_rangePermutation;
+}
+
+template <typename ValueType>
+const ParallelizationOptions&
+DiscreteH2MatrixBoundaryOperator<ValueType>::parallelizationOptions() const
+{
+    return m_parallelizationOptions;
+}
+
+#ifdef WITH_TRILINOS
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+DiscreteH2MatrixBoundaryOperator<ValueType>::domain() const
+{
+    return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+DiscreteH2MatrixBoundaryOperator<ValueType>::range() const
+{
+    return m_rangeSpace;
+}
+
+template <typename ValueType>
+bool DiscreteH2MatrixBoundaryOperator<ValueType>::opSupportedImpl(
+        Thyra::EOpTransp M_trans) const
+{
+    return (M_trans == Thyra::NOTRANS || M_trans == Thyra::TRANS
+            || M_trans == Thyra::CONJ || M_trans == Thyra::CONJTRANS);
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+void DiscreteH2MatrixBoundaryOperator<ValueType>::applyBuiltInImpl(
+        const TranspositionMode trans,
+        const arma::Col<ValueType>& x_in,
+        arma::Col<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta) const
+{
+    const bool transposed = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    if ((!transposed && (columnCount() != x_in.n_rows ||
+                         rowCount() != y_inout.n_rows)) ||
+            (transposed && (rowCount() != x_in.n_rows ||
+                            columnCount() != y_inout.n_rows)))
+        throw std::invalid_argument(
+                "DiscreteH2MatrixBoundaryOperator::applyBuiltInImpl(): "
+                "incorrect vector length");
+
+    const IndexPermutation& inPermutation =
+            transposed ? m_rangePermutation : m_domainPermutation;
+    const IndexPermutation& outPermutation =
+            transposed ? m_domainPermutation : m_rangePermutation;
+
+    arma::Col<ValueType> permutedArgument, permutedResult, result;
+    inPermutation.permuteVector(x_in, permutedArgument);
+
+    int maxThreadCount = 1;
+    if (!m_parallelizationOptions.isOpenClEnabled()) {
+        if (m_parallelizationOptions.maxThreadCount() ==
+                ParallelizationOptions::AUTO)
+            maxThreadCount = tbb::task_scheduler_init::automatic;
+        else
+            maxThreadCount = m_parallelizationOptions.maxThreadCount();
+    }
+    {
+        tbb::task_scheduler_init scheduler(maxThreadCount);
+        m_h2Matrix->apply(trans, permutedArgument, permutedResult,
+                         alpha, static_cast<ValueType>(0.));
+    }
+    outPermutation.unpermuteVector(permutedResult, result);
+
+    if (beta == static_cast<ValueType>(0.))
+        y_inout = result;
+    else {
+        y_inout *= beta;
+        y_inout += result;
+    }
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteH2MatrixBoundaryOperator);
+
+} // namespace Bempp
@@ -0,0 +1,290 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "discrete_h_matrix_boundary_operator.hpp"
+
+#include "h_matrix.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <stdexcept>
+#include <typeinfo>
+
+#include <boost/pointer_cast.hpp>
+#include <tbb/task_scheduler_init.h>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceDefaultBase.hpp>
+#endif
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Entry (row, col) (in the permuted ordering) of the subtree rooted at block
+template <typename ValueType>
+ValueType hMatrixEntry(const HMatrixBlock<ValueType>* block,
+                       size_t row, size_t col)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    while (block->type() == Block::SUBDIVIDED) {
+        const int i = row < block->son(0, 0).rowBegin() +
+                block->son(0, 0).rowCount() ? 0 : 1;
+        const int j = col < block->son(0, 0).columnBegin() +
+                block->son(0, 0).columnCount() ? 0 : 1;
+        block = &block->son(i, j);
+    }
+    row -= block->rowBegin();
+    col -= block->columnBegin();
+    if (block->type() == Block::DENSE)
+        return block->dense()(row, col);
+    ValueType result = 0.;
+    for (size_t l = 0; l < block->rank(); ++l)
+        result += block->lowRankU()(row, l) * block->lowRankV()(l, col);
+    return result;
+}
+
+} // namespace
+
+template <typename ValueType>
+DiscreteHMatrixBoundaryOperator<ValueType>::DiscreteHMatrixBoundaryOperator(
+        const shared_ptr<const HMatrix<ValueType> >& hMatrix,
+        const IndexPermutation& domainPermutation,
+        const IndexPermutation& rangePermutation,
+        double eps, int maximumRank,
+        const ParallelizationOptions& parallelizationOptions) :
+    m_hMatrix(hMatrix),
+#ifdef WITH_TRILINOS
+    m_domainSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+                      hMatrix->columnCount())),
+    m_rangeSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+                     hMatrix->rowCount())),
+#endif
+    m_domainPermutation(domainPermutation),
+    m_rangePermutation(rangePermutation),
+    m_eps(eps),
+    m_maximumRank(maximumRank),
+    m_parallelizationOptions(parallelizationOptions)
+{
+    if (m_domainPermutation.size() != hMatrix->columnCount() ||
+            m_rangePermutation.size() != hMatrix->rowCount())
+        throw std::invalid_argument(
+                "DiscreteHMatrixBoundaryOperator::"
+                "DiscreteHMatrixBoundaryOperator(): "
+                "permutation sizes do not match the H-matrix size");
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> DiscreteHMatrixBoundaryOperator<ValueType>::asMatrix() const
+{
+    const arma::Mat<ValueType> permutedMatrix = m_hMatrix->asMatrix();
+    const unsigned int nRows = rowCount();
+    const unsigned int nCols = columnCount();
+    arma::Mat<ValueType> result(nRows, nCols);
+    for (unsigned int col = 0; col < nCols; ++col) {
+        const unsigned int permutedCol = m_domainPermutation.permuted(col);
+        for (unsigned int row = 0; row < nRows; ++row)
+            result(row, col) = permutedMatrix(
+                        m_rangePermutation.permuted(row), permutedCol);
+    }
+    return result;
+}
+
+template <typename ValueType>
+unsigned int DiscreteHMatrixBoundaryOperator<ValueType>::rowCount() const
+{
+    return m_hMatrix->rowCount();
+}
+
+template <typename ValueType>
+unsigned int DiscreteHMatrixBoundaryOperator<ValueType>::columnCount() const
+{
+    return m_hMatrix->columnCount();
+}
+
+template <typename ValueType>
+void DiscreteHMatrixBoundaryOperator<ValueType>::addBlock(
+        const std::vector<int>& rows,
+        const std::vector<int>& cols,
+        const ValueType alpha,
+        arma::Mat<ValueType>& block) const
+{
+    if (block.n_rows != rows.size() || block.n_cols != cols.size())
+        throw std::invalid_argument(
+                "DiscreteHMatrixBoundaryOperator::addBlock(): "
+                "incorrect block size");
+    const HMatrixBlock<ValueType>* root = &m_hMatrix->root();
+    for (size_t col = 0; col < cols.size(); ++col) {
+        const unsigned int permutedCol = m_domainPermutation.permuted(cols[col]);
+        for (size_t row = 0; row < rows.size(); ++row)
+            block(row, col) += alpha * hMatrixEntry(
+                        root, m_rangePermutation.permuted(rows[row]),
+                        permutedCol);
+    }
+}
+
+template <typename ValueType>
+const DiscreteHMatrixBoundaryOperator<ValueType>&
+DiscreteHMatrixBoundaryOperator<ValueType>::castToHMatrix(
+        const DiscreteBoundaryOperator<ValueType>& discreteOperator)
+{
+    return dynamic_cast<const DiscreteHMatrixBoundaryOperator<ValueType>&>(
+                discreteOperator);
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> >
+DiscreteHMatrixBoundaryOperator<ValueType>::castToHMatrix(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >&
+        discreteOperator)
+{
+    shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> > result =
+        boost::dynamic_pointer_cast<const DiscreteHMatrixBoundaryOperator<ValueType> >(
+                discreteOperator);
+    if (result.get() == 0 && discreteOperator.get() != 0)
+        throw std::bad_cast();
+    return result;
+}
+
+template <typename ValueType>
+shared_ptr<const HMatrix<ValueType> >
+DiscreteHMatrixBoundaryOperator<ValueType>::hMatrix() const
+{
+    return m_hMatrix;
+}
+
+template <typename ValueType>
+double DiscreteHMatrixBoundaryOperator<ValueType>::eps() const
+{
+    return m_eps;
+}
+
+template <typename ValueType>
+int DiscreteHMatrixBoundaryOperator<ValueType>::maximumRank() const
+{
+    return m_maximumRank;
+}
+
+template <typename ValueType>
+int DiscreteHMatrixBoundaryOperator<ValueType>::actualMaximumRank() const
+{
+    return m_hMatrix->maximumRank();
+}
+
+template <typename ValueType>
+const IndexPermutation&
+DiscreteHMatrixBoundaryOperator<ValueType>::domainPermutation() const
+{
+    return m_domainPermutation;
+}
+
+template <typename ValueType>
+const IndexPermutation&
+DiscreteHMatrixBoundaryOperator<ValueType>::rangePermutation() const
+{
+    return m_rangePermutation;
+}
+
+template <typename ValueType>
+const ParallelizationOptions&
+DiscreteHMatrixBoundaryOperator<ValueType>::parallelizationOptions() const
+{
+    return m_parallelizationOptions;
+}
+
+#ifdef WITH_TRILINOS
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+DiscreteHMatrixBoundaryOperator<ValueType>::domain() const
+{
+    return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+DiscreteHMatrixBoundaryOperator<ValueType>::range() const
+{
+    return m_rangeSpace;
+}
+
+template <typename ValueType>
+bool DiscreteHMatrixBoundaryOperator<ValueType>::opSupportedImpl(
+        Thyra::EOpTransp M_trans) const
+{
+    return (M_trans == Thyra::NOTRANS || M_trans == Thyra::TRANS
+            || M_trans == Thyra::CONJ || M_trans == Thyra::CONJTRANS);
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+void DiscreteHMatrixBoundaryOperator<ValueType>::applyBuiltInImpl(
+        const TranspositionMode trans,
+        const arma::Col<ValueType>& x_in,
+        arma::Col<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta) const
+{
+    const bool transposed = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    if ((!transposed && (columnCount() != x_in.n_rows ||
+                         rowCount() != y_inout.n_rows)) ||
+            (transposed && (rowCount() != x_in.n_rows ||
+                            columnCount() != y_inout.n_rows)))
+        throw std::invalid_argument(
+                "DiscreteHMatrixBoundaryOperator::applyBuiltInImpl(): "
+                "incorrect vector length");
+
+    const IndexPermutation& inPermutation =
+            transposed ? m_rangePermutation : m_domainPermutation;
+    const IndexPermutation& outPermutation =
+            transposed ? m_domainPermutation : m_rangePermutation;
+
+    arma::Col<ValueType> permutedArgument, permutedResult, result;
+    inPermutation.permuteVector(x_in, permutedArgument);
+
+    int maxThreadCount = 1;
+    if (!m_parallelizationOptions.isOpenClEnabled()) {
+        if (m_parallelizationOptions.maxThreadCount() ==
+                ParallelizationOptions::AUTO)
+            maxThreadCount = tbb::task_scheduler_init::automatic;
+        else
+            maxThreadCount = m_parallelizationOptions.maxThreadCount();
+    }
+    {
+        tbb::task_scheduler_init scheduler(maxThreadCount);
+        m_hMatrix->apply(trans, permutedArgument, permutedResult,
+                         alpha, static_cast<ValueType>(0.));
+    }
+    outPermutation.unpermuteVector(permutedResult, result);
+
+    if (beta == static_cast<ValueType>(0.))
+        y_inout = result;
+    else {
+        y_inout *= beta;
+        y_inout += result;
+    }
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteHMatrixBoundaryOperator);
+
+} // namespace Bempp
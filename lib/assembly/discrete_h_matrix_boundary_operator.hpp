@@ -0,0 +1,166 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#ifndef bempp_discrete_h_matrix_boundary_operator_hpp
+#define bempp_discrete_h_matrix_boundary_operator_hpp
+
+#include "../common/common.hpp"
+
+#include "discrete_boundary_operator.hpp"
+#include "assembly_options.hpp" // actually only ParallelizationOptions are needed
+#include "index_permutation.hpp"
+
+#include "../common/shared_ptr.hpp"
+
+#ifdef WITH_TRILINOS
+#include <Teuchos_RCP.hpp>
+#include <Thyra_SpmdVectorSpaceBase_decl.hpp>
+#endif
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class HMatrix;
+/** \endcond */
+
+/** \ingroup discrete_boundary_operators
+ *  \brief Discrete boundary operator stored as an H-matrix built into BEM++.
+ *
+ *  This class plays the same role as DiscreteAcaBoundaryOperator, but it
+ *  wraps a HMatrix instead of an AHMED H-matrix and hence is available even
+ *  if BEM++ has been compiled without AHMED. Operators of this type are
+ *  produced by the ACA assembler when AcaOptions::backend is set to
+ *  AcaOptions::BUILT_IN. */
+template <typename ValueType>
+class DiscreteHMatrixBoundaryOperator :
+        public DiscreteBoundaryOperator<ValueType>
+{
+public:
+    /** \brief Constructor.
+     *
+     *  \param[in] hMatrix
+     *    H-matrix whose rows and columns are indexed in the orderings
+     *    defined by its cluster trees.
+     *  \param[in] domainPermutation
+     *    Mapping from the original to the permuted ordering of columns.
+     *  \param[in] rangePermutation
+     *    Mapping from the original to the permuted ordering of rows.
+     *  \param[in] eps, maximumRank
+     *    Parameters of the low-rank approximation used to construct the
+     *    H-matrix; used by operations (such as the LU decomposition) that
+     *    produce new H-matrices from this one.
+     *  \param[in] parallelizationOptions
+     *    Options determining the maximum number of threads used in apply().
+     */
+    DiscreteHMatrixBoundaryOperator(
+            const shared_ptr<const HMatrix<ValueType> >& hMatrix,
+            const IndexPermutation& domainPermutation,
+            const IndexPermutation& rangePermutation,
+            double eps, int maximumRank,
+            const ParallelizationOptions& parallelizationOptions);
+
+    virtual arma::Mat<ValueType> asMatrix() const;
+
+    virtual unsigned int rowCount() const;
+    virtual unsigned int columnCount() const;
+
+    virtual void addBlock(const std::vector<int>& rows,
+                          const std::vector<int>& cols,
+                          const ValueType alpha,
+                          arma::Mat<ValueType>& block) const;
+
+    /** \brief Downcast a reference to a DiscreteBoundaryOperator object to
+     *  DiscreteHMatrixBoundaryOperator.
+     *
+     *  If the object referenced by \p discreteOperator is not in fact a
+     *  DiscreteHMatrixBoundaryOperator, a std::bad_cast exception is thrown. */
+    static const DiscreteHMatrixBoundaryOperator<ValueType>& castToHMatrix(
+            const DiscreteBoundaryOperator<ValueType>& discreteOperator);
+
+    /** \brief Downcast a shared pointer to a DiscreteBoundaryOperator object to
+     *  a shared pointer to a DiscreteHMatrixBoundaryOperator.
+     *
+     *  If the object referenced by \p discreteOperator is not in fact a
+     *  DiscreteHMatrixBoundaryOperator, a std::bad_cast exception is thrown. */
+    static shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> >
+    castToHMatrix(const shared_ptr<const DiscreteBoundaryOperator<ValueType> >&
+                  discreteOperator);
+
+    /** \brief Return the underlying H-matrix. */
+    shared_ptr<const HMatrix<ValueType> > hMatrix() const;
+
+    /** \brief Return the value of the epsilon parameter specified during
+     *  H-matrix construction. */
+    double eps() const;
+
+    /** \brief Return the upper bound for the rank of low-rank blocks
+     *  specified during H-matrix construction. */
+    int maximumRank() const;
+
+    /** \brief Return the actual maximum rank of low-rank blocks. */
+    int actualMaximumRank() const;
+
+    /** \brief Return the domain index permutation. */
+    const IndexPermutation& domainPermutation() const;
+
+    /** \brief Return the range index permutation. */
+    const IndexPermutation& rangePermutation() const;
+
+    /** \brief Return the parallelization options used in the matrix-vector
+     *  multiply. */
+    const ParallelizationOptions& parallelizationOptions() const;
+
+#ifdef WITH_TRILINOS
+public:
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > domain() const;
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > range() const;
+
+protected:
+    virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+#endif
+
+private:
+    virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                  const arma::Col<ValueType>& x_in,
+                                  arma::Col<ValueType>& y_inout,
+                                  const ValueType alpha,
+                                  const ValueType beta) const;
+
+private:
+    /** \cond PRIVATE */
+    shared_ptr<const HMatrix<ValueType> > m_hMatrix;
+#ifdef WITH_TRILINOS
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_domainSpace;
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_rangeSpace;
+#endif
+    IndexPermutation m_domainPermutation;
+    IndexPermutation m_rangePermutation;
+    double m_eps;
+    int m_maximumRank;
+    ParallelizationOptions m_parallelizationOptions;
+    /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
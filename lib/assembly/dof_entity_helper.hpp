@@ -0,0 +1,101 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_dof_entity_helper_hpp
+#define bempp_dof_entity_helper_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/types.hpp"
+#include "../grid/grid.hpp"
+#include "../grid/grid_connectivity.hpp"
+#include "../space/piecewise_constant_scalar_space.hpp"
+#include "../space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <vector>
+
+namespace Bempp
+{
+
+/** \ingroup assembly
+ *  \brief Utility functions relating the global DOFs of simple spaces to
+ *  the grid entities they are attached to.
+ *
+ *  These are internal routines; they are not part of the public interface of
+ *  BEM++ and may change at any time.
+ */
+struct DofEntityHelper
+{
+    enum SpaceKind {
+        /** \brief DOFs attached to elements */
+        PIECEWISE_CONSTANT,
+        /** \brief DOFs attached to vertices */
+        PIECEWISE_LINEAR_CONTINUOUS,
+        OTHER
+    };
+
+    template <typename BasisFunctionType>
+    static SpaceKind spaceKind(const Space<BasisFunctionType>& space) {
+        if (dynamic_cast<const PiecewiseConstantScalarSpace<BasisFunctionType>*>(
+                    &space))
+            return PIECEWISE_CONSTANT;
+        if (dynamic_cast<const PiecewiseLinearContinuousScalarSpace<
+                BasisFunctionType>*>(&space))
+            return PIECEWISE_LINEAR_CONTINUOUS;
+        return OTHER;
+    }
+
+    /** \brief Return the vector whose i'th element is the index of the
+     *  entity (element or vertex, depending on \p kind) to which the i'th
+     *  global DOF of \p space is attached. */
+    template <typename BasisFunctionType>
+    static std::vector<int> dofEntities(const Space<BasisFunctionType>& space,
+                                        SpaceKind kind) {
+        const size_t dofCount = space.globalDofCount();
+        std::vector<GlobalDofIndex> globalDofs(dofCount);
+        for (size_t dof = 0; dof < dofCount; ++dof)
+            globalDofs[dof] = dof;
+        std::vector<std::vector<LocalDof> > localDofs;
+        space.global2localDofs(globalDofs, localDofs);
+
+        const arma::Mat<int>& elementCorners =
+                space.grid()->leafConnectivity().elementCorners();
+        std::vector<int> entities(dofCount);
+        for (size_t dof = 0; dof < dofCount; ++dof) {
+            if (localDofs[dof].empty()) {
+                // Only possible for a P1 space on a grid with vertices not
+                // belonging to any element; such DOFs are numbered as vertices
+                entities[dof] = dof;
+                continue;
+            }
+            const LocalDof& localDof = localDofs[dof].front();
+            if (kind == PIECEWISE_CONSTANT)
+                entities[dof] = localDof.entityIndex;
+            else // the local DOFs of a P1 space lie at the element corners
+                entities[dof] = elementCorners(localDof.dofIndex,
+                                               localDof.entityIndex);
+        }
+        return entities;
+    }
+};
+
+} // namespace Bempp
+
+#endif
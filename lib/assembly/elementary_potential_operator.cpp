@@ -34,6 +34,7 @@
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/kernel_trial_integral.hpp"
 
+#include "../grid/bounding_volume_hierarchy.hpp"
 #include "../grid/entity.hpp"
 #include "../grid/entity_iterator.hpp"
 #include "../grid/geometry.hpp"
@@ -41,9 +42,67 @@
 #include "../grid/grid_view.hpp"
 #include "../grid/index_set.hpp"
 
+#include <algorithm>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Bempp
 {
 
+namespace
+{
+
+template <typename CoordinateType>
+class NearFieldClassificationLoopBody
+{
+public:
+    NearFieldClassificationLoopBody(const BoundingVolumeHierarchy& bvh,
+                                    const arma::Mat<CoordinateType>& points,
+                                    std::vector<char>& nearFieldMask) :
+        m_bvh(bvh), m_points(points), m_nearFieldMask(nearFieldMask) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        double point[3];
+        double distance;
+        for (size_t pt = r.begin(); pt != r.end(); ++pt) {
+            for (int dim = 0; dim < 3; ++dim)
+                point[dim] = m_points(dim, pt);
+            const int element = m_bvh.nearestElement(point, &distance);
+            m_nearFieldMask[pt] =
+                    element >= 0 && distance < m_bvh.elementDiameter(element);
+        }
+    }
+
+private:
+    const BoundingVolumeHierarchy& m_bvh;
+    const arma::Mat<CoordinateType>& m_points;
+    std::vector<char>& m_nearFieldMask;
+};
+
+// Mark the points lying closer to the grid than the diameter of the element
+// nearest to them. Returns the number of such points.
+template <typename CoordinateType>
+size_t classifyNearFieldPoints(const Grid& grid,
+                               const arma::Mat<CoordinateType>& points,
+                               std::vector<char>& nearFieldMask)
+{
+    const size_t pointCount = points.n_cols;
+    nearFieldMask.assign(pointCount, false);
+    // The spatial index is only available for surfaces in 3D spaces
+    if (grid.dim() != 2 || grid.dimWorld() != 3)
+        return 0;
+
+    const size_t GRAIN_SIZE = 256;
+    typedef NearFieldClassificationLoopBody<CoordinateType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pointCount, GRAIN_SIZE),
+                      Body(grid.boundingVolumeHierarchy(), points,
+                           nearFieldMask));
+    return std::count(nearFieldMask.begin(), nearFieldMask.end(), true);
+}
+
+} // namespace
+
 template <typename BasisFunctionType, typename KernelType, typename ResultType>
 int
 ElementaryPotentialOperator<BasisFunctionType, KernelType, ResultType>::
@@ -130,10 +189,43 @@ evaluateAtPoints(
         std::auto_ptr<Evaluator> evaluator =
                 makeEvaluator(argument, quadStrategy, options);
 
-        // right now we don't bother about far and near field
-        // (this might depend on evaluation options)
         arma::Mat<ResultType> result;
-        evaluator->evaluate(Evaluator::FAR_FIELD, evaluationPoints, result);
+        std::vector<char> nearFieldMask;
+        const size_t nearFieldPointCount = classifyNearFieldPoints(
+                    *argument.grid(), evaluationPoints, nearFieldMask);
+        if (nearFieldPointCount == 0) {
+            evaluator->evaluate(Evaluator::FAR_FIELD, evaluationPoints, result);
+            return result;
+        }
+
+        // Evaluate the potential at near-field points with a higher
+        // quadrature order
+        const size_t pointCount = evaluationPoints.n_cols;
+        const size_t farFieldPointCount = pointCount - nearFieldPointCount;
+        const int coordCount = evaluationPoints.n_rows;
+        arma::Mat<CoordinateType> nearFieldPoints(coordCount,
+                                                  nearFieldPointCount);
+        arma::Mat<CoordinateType> farFieldPoints(coordCount,
+                                                 farFieldPointCount);
+        for (size_t pt = 0, nearPt = 0, farPt = 0; pt < pointCount; ++pt)
+            if (nearFieldMask[pt])
+                nearFieldPoints.col(nearPt++) = evaluationPoints.col(pt);
+            else
+                farFieldPoints.col(farPt++) = evaluationPoints.col(pt);
+
+        arma::Mat<ResultType> nearFieldResult, farFieldResult;
+        evaluator->evaluate(Evaluator::NEAR_FIELD, nearFieldPoints,
+                            nearFieldResult);
+        if (farFieldPointCount > 0)
+            evaluator->evaluate(Evaluator::FAR_FIELD, farFieldPoints,
+                                farFieldResult);
+
+        result.set_size(nearFieldResult.n_rows, pointCount);
+        for (size_t pt = 0, nearPt = 0, farPt = 0; pt < pointCount; ++pt)
+            if (nearFieldMask[pt])
+                result.col(pt) = nearFieldResult.col(nearPt++);
+            else
+                result.col(pt) = farFieldResult.col(farPt++);
         return result;
     } else if (options.evaluationMode() == EvaluationOptions::ACA) {
         AssembledPotentialOperator<BasisFunctionType, ResultType> assembledOp =
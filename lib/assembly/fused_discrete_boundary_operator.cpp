@@ -0,0 +1,450 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "fused_discrete_boundary_operator.hpp"
+
+#include "discrete_blocked_boundary_operator.hpp"
+#include "discrete_boundary_operator_composition.hpp"
+#include "discrete_boundary_operator_sum.hpp"
+#include "scaled_discrete_boundary_operator.hpp"
+#include "transposed_discrete_boundary_operator.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <stdexcept>
+
+namespace Bempp
+{
+
+template <typename ValueType>
+const size_t FusedDiscreteBoundaryOperator<ValueType>::NO_NODE;
+
+template <typename ValueType>
+FusedDiscreteBoundaryOperator<ValueType>::FusedDiscreteBoundaryOperator(
+        const shared_ptr<const Base>& op) :
+    m_operator(op)
+{
+    if (!m_operator)
+        throw std::invalid_argument(
+            "FusedDiscreteBoundaryOperator::FusedDiscreteBoundaryOperator(): "
+            "the wrapped operator must not be NULL");
+    const TranspositionMode modes[] = {
+        NO_TRANSPOSE, CONJUGATE, TRANSPOSE, CONJUGATE_TRANSPOSE };
+    for (int i = 0; i < 4; ++i) {
+        m_roots[modes[i]] = compile(m_operator, modes[i],
+                                    static_cast<ValueType>(1.));
+        planBuffers(m_roots[modes[i]]);
+    }
+}
+
+template <typename ValueType>
+size_t FusedDiscreteBoundaryOperator<ValueType>::leafCount() const
+{
+    return leafCount(m_roots[NO_TRANSPOSE]);
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> FusedDiscreteBoundaryOperator<ValueType>::asMatrix() const
+{
+    return m_operator->asMatrix();
+}
+
+template <typename ValueType>
+unsigned int FusedDiscreteBoundaryOperator<ValueType>::rowCount() const
+{
+    return m_operator->rowCount();
+}
+
+template <typename ValueType>
+unsigned int FusedDiscreteBoundaryOperator<ValueType>::columnCount() const
+{
+    return m_operator->columnCount();
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::addBlock(
+        const std::vector<int>& rows,
+        const std::vector<int>& cols,
+        const ValueType alpha,
+        arma::Mat<ValueType>& block) const
+{
+    m_operator->addBlock(rows, cols, alpha, block);
+}
+
+#ifdef WITH_TRILINOS
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+FusedDiscreteBoundaryOperator<ValueType>::domain() const
+{
+    return m_operator->domain();
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+FusedDiscreteBoundaryOperator<ValueType>::range() const
+{
+    return m_operator->range();
+}
+
+template <typename ValueType>
+bool FusedDiscreteBoundaryOperator<ValueType>::opSupportedImpl(
+        Thyra::EOpTransp M_trans) const
+{
+    return m_operator->opSupported(M_trans);
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+size_t FusedDiscreteBoundaryOperator<ValueType>::compile(
+        const shared_ptr<const Base>& op,
+        TranspositionMode trans, ValueType coefficient)
+{
+    typedef ScaledDiscreteBoundaryOperator<ValueType> Scaled;
+    typedef TransposedDiscreteBoundaryOperator<ValueType> Transposed;
+    typedef DiscreteBoundaryOperatorSum<ValueType> Sum;
+    typedef DiscreteBoundaryOperatorComposition<ValueType> Composition;
+    typedef DiscreteBlockedBoundaryOperator<ValueType> Blocked;
+    typedef FusedDiscreteBoundaryOperator<ValueType> Fused;
+
+    const bool transposed = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    const bool conjugated = (trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE);
+
+    // Nodes that only modify the scalar factor or the transposition mode
+    // of their operand are absorbed into the leaves
+    if (shared_ptr<const Scaled> scaled =
+            boost::dynamic_pointer_cast<const Scaled>(op)) {
+        ValueType multiplier = scaled->multiplier();
+        if (conjugated)
+            multiplier = conj(multiplier);
+        return compile(scaled->operand(), trans, coefficient * multiplier);
+    }
+    if (shared_ptr<const Transposed> transposedOp =
+            boost::dynamic_pointer_cast<const Transposed>(op))
+        // Bitwise xor. We use the fact that bit 0 of M_trans denotes
+        // conjugation, and bit 1 -- transposition.
+        return compile(transposedOp->operand(),
+                       TranspositionMode(trans ^ transposedOp->transpositionMode()),
+                       coefficient);
+    if (shared_ptr<const Fused> fused =
+            boost::dynamic_pointer_cast<const Fused>(op))
+        return compile(fused->operand(), trans, coefficient);
+
+    Node node;
+    node.rowCount = transposed ? op->columnCount() : op->rowCount();
+    node.columnCount = transposed ? op->rowCount() : op->columnCount();
+    node.trans = trans;
+    node.coefficient = coefficient;
+
+    if (shared_ptr<const Sum> sum =
+            boost::dynamic_pointer_cast<const Sum>(op)) {
+        node.kind = Node::SUM;
+        const shared_ptr<const Base> terms[] = { sum->term1(), sum->term2() };
+        for (int i = 0; i < 2; ++i) {
+            const size_t term = compile(terms[i], trans, coefficient);
+            if (m_nodes[term].kind == Node::SUM)
+                node.children.insert(node.children.end(),
+                                     m_nodes[term].children.begin(),
+                                     m_nodes[term].children.end());
+            else
+                node.children.push_back(term);
+        }
+    } else if (shared_ptr<const Composition> composition =
+               boost::dynamic_pointer_cast<const Composition>(op)) {
+        node.kind = Node::PRODUCT;
+        // trans(A B) = trans(B) trans(A) if trans involves transposition;
+        // the scalar factor is applied by the factor applied first
+        const size_t factors[] = {
+            compile(transposed ? composition->outer() : composition->inner(),
+                    trans, coefficient),
+            compile(transposed ? composition->inner() : composition->outer(),
+                    trans, static_cast<ValueType>(1.)) };
+        for (int i = 0; i < 2; ++i)
+            if (m_nodes[factors[i]].kind == Node::PRODUCT)
+                node.children.insert(node.children.end(),
+                                     m_nodes[factors[i]].children.begin(),
+                                     m_nodes[factors[i]].children.end());
+            else
+                node.children.push_back(factors[i]);
+    } else if (shared_ptr<const Blocked> blocked =
+               boost::dynamic_pointer_cast<const Blocked>(op)) {
+        node.kind = Node::BLOCKED;
+        node.blockRowCounts = transposed ?
+                    blocked->blockColumnCounts() : blocked->blockRowCounts();
+        node.blockColumnCounts = transposed ?
+                    blocked->blockRowCounts() : blocked->blockColumnCounts();
+        for (size_t i = 0; i < node.blockRowCounts.size(); ++i)
+            for (size_t j = 0; j < node.blockColumnCounts.size(); ++j) {
+                shared_ptr<const Base> block = transposed ?
+                            blocked->getComponent(j, i) :
+                            blocked->getComponent(i, j);
+                node.children.push_back(
+                            block ? compile(block, trans, coefficient) : NO_NODE);
+            }
+    } else {
+        node.kind = Node::LEAF;
+        node.op = op;
+    }
+    return addNode(node);
+}
+
+template <typename ValueType>
+size_t FusedDiscreteBoundaryOperator<ValueType>::addNode(const Node& node)
+{
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+template <typename ValueType>
+size_t FusedDiscreteBoundaryOperator<ValueType>::addBuffer(size_t rowCount)
+{
+    m_bufferRowCounts.push_back(rowCount);
+    return m_bufferRowCounts.size() - 1;
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::planBuffers(size_t index)
+{
+    // Nodes spliced into their parents during compilation are unreachable
+    // from the root and get no buffers
+    Node& node = m_nodes[index];
+    if (node.kind == Node::PRODUCT)
+        for (size_t i = 0; i + 1 < node.children.size(); ++i)
+            node.buffers.push_back(
+                        addBuffer(m_nodes[node.children[i]].rowCount));
+    else if (node.kind == Node::BLOCKED) {
+        for (size_t j = 0; j < node.blockColumnCounts.size(); ++j)
+            node.buffers.push_back(addBuffer(node.blockColumnCounts[j]));
+        for (size_t i = 0; i < node.blockRowCounts.size(); ++i)
+            node.buffers.push_back(addBuffer(node.blockRowCounts[i]));
+    }
+    for (size_t i = 0; i < node.children.size(); ++i)
+        if (node.children[i] != NO_NODE)
+            planBuffers(node.children[i]);
+}
+
+template <typename ValueType>
+size_t FusedDiscreteBoundaryOperator<ValueType>::leafCount(size_t index) const
+{
+    const Node& node = m_nodes[index];
+    if (node.kind == Node::LEAF)
+        return 1;
+    size_t result = 0;
+    for (size_t i = 0; i < node.children.size(); ++i)
+        if (node.children[i] != NO_NODE)
+            result += leafCount(node.children[i]);
+    return result;
+}
+
+template <typename ValueType>
+arma::Mat<ValueType>& FusedDiscreteBoundaryOperator<ValueType>::buffer(
+        Workspace& workspace, size_t index, size_t columnCount) const
+{
+    arma::Mat<ValueType>& result = workspace.buffers[index];
+    // No reallocation takes place if the buffer already has the right shape
+    if (result.n_rows != m_bufferRowCounts[index] ||
+            result.n_cols != columnCount)
+        result.set_size(m_bufferRowCounts[index], columnCount);
+    return result;
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::
+applyBuiltInImpl(const TranspositionMode trans,
+                 const arma::Col<ValueType>& x_in,
+                 arma::Col<ValueType>& y_inout,
+                 const ValueType alpha,
+                 const ValueType beta) const
+{
+    applyBuiltInImplMultiple(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::
+applyBuiltInImplMultiple(const TranspositionMode trans,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta) const
+{
+    tbb::mutex::scoped_lock lock;
+    if (lock.try_acquire(m_mutex)) {
+        // The buffer list must not be resized during evaluation, since
+        // references to its elements are held across recursive calls
+        m_workspace.buffers.resize(m_bufferRowCounts.size());
+        evaluate(m_roots[trans], x_in, y_inout, alpha, beta, m_workspace);
+    } else {
+        // The shared buffers are in use by another thread
+        Workspace workspace;
+        workspace.buffers.resize(m_bufferRowCounts.size());
+        evaluate(m_roots[trans], x_in, y_inout, alpha, beta, workspace);
+    }
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::evaluate(
+        size_t index,
+        const arma::Mat<ValueType>& x_in,
+        arma::Mat<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta,
+        Workspace& workspace) const
+{
+    const Node& node = m_nodes[index];
+    switch (node.kind) {
+    case Node::LEAF:
+        node.op->apply(node.trans, x_in, y_inout,
+                       alpha * node.coefficient, beta);
+        break;
+    case Node::SUM:
+        // Each term accumulates directly into y_inout; only the first one
+        // takes care of the "beta * y_inout" part
+        for (size_t i = 0; i < node.children.size(); ++i)
+            evaluate(node.children[i], x_in, y_inout, alpha,
+                     i == 0 ? beta : static_cast<ValueType>(1.), workspace);
+        break;
+    case Node::PRODUCT: {
+        const arma::Mat<ValueType>* input = &x_in;
+        for (size_t i = 0; i + 1 < node.children.size(); ++i) {
+            arma::Mat<ValueType>& output =
+                    buffer(workspace, node.buffers[i], x_in.n_cols);
+            evaluate(node.children[i], *input, output,
+                     static_cast<ValueType>(1.), static_cast<ValueType>(0.),
+                     workspace);
+            input = &output;
+        }
+        evaluate(node.children.back(), *input, y_inout, alpha, beta,
+                 workspace);
+        break;
+    }
+    case Node::BLOCKED:
+        evaluateBlocked(node, x_in, y_inout, alpha, beta, workspace);
+        break;
+    default:
+        throw std::runtime_error("FusedDiscreteBoundaryOperator::evaluate(): "
+                                 "invalid node kind");
+    }
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::evaluateBlocked(
+        const Node& node,
+        const arma::Mat<ValueType>& x_in,
+        arma::Mat<ValueType>& y_inout,
+        const ValueType alpha,
+        const ValueType beta,
+        Workspace& workspace) const
+{
+    const size_t blockRowCount = node.blockRowCounts.size();
+    const size_t blockColumnCount = node.blockColumnCounts.size();
+    const size_t columnCount = x_in.n_cols;
+    // Chunks of a single vector are contiguous and can be accessed in place;
+    // chunks of multivectors are gathered into buffers
+    const bool inPlace = (columnCount == 1);
+
+    if (!inPlace)
+        for (size_t j = 0, xStart = 0; j < blockColumnCount;
+             xStart += node.blockColumnCounts[j], ++j)
+            if (node.blockColumnCounts[j] > 0)
+                buffer(workspace, node.buffers[j], columnCount) =
+                        x_in.rows(xStart, xStart + node.blockColumnCounts[j] - 1);
+
+    for (size_t i = 0, yStart = 0; i < blockRowCount;
+         yStart += node.blockRowCounts[i], ++i) {
+        const size_t yChunkSize = node.blockRowCounts[i];
+        if (yChunkSize == 0)
+            continue;
+        if (inPlace) {
+            arma::Mat<ValueType> yChunk(y_inout.memptr() + yStart,
+                                        yChunkSize, 1,
+                                        false /* copy_aux_mem */);
+            evaluateBlockRow(node, i, x_in, yChunk, alpha, beta, workspace);
+        } else {
+            arma::Mat<ValueType>& yChunk =
+                    buffer(workspace, node.buffers[blockColumnCount + i],
+                           columnCount);
+            if (beta != static_cast<ValueType>(0.))
+                yChunk = y_inout.rows(yStart, yStart + yChunkSize - 1);
+            evaluateBlockRow(node, i, x_in, yChunk, alpha, beta, workspace);
+            y_inout.rows(yStart, yStart + yChunkSize - 1) = yChunk;
+        }
+    }
+}
+
+template <typename ValueType>
+void FusedDiscreteBoundaryOperator<ValueType>::evaluateBlockRow(
+        const Node& node,
+        size_t blockRow,
+        const arma::Mat<ValueType>& x_in,
+        arma::Mat<ValueType>& yChunk,
+        const ValueType alpha,
+        const ValueType beta,
+        Workspace& workspace) const
+{
+    const size_t blockColumnCount = node.blockColumnCounts.size();
+    const bool inPlace = (x_in.n_cols == 1);
+
+    bool first = true;
+    for (size_t j = 0, xStart = 0; j < blockColumnCount;
+         xStart += node.blockColumnCounts[j], ++j) {
+        const size_t block = node.children[blockRow * blockColumnCount + j];
+        if (block == NO_NODE || node.blockColumnCounts[j] == 0)
+            continue;
+        // This ensures that the "beta * y_inout" part is done once
+        const ValueType blockBeta = first ? beta : static_cast<ValueType>(1.);
+        if (inPlace) {
+            const arma::Mat<ValueType> xChunk(
+                        const_cast<ValueType*>(x_in.memptr()) + xStart,
+                        node.blockColumnCounts[j], 1,
+                        false /* copy_aux_mem */);
+            evaluate(block, xChunk, yChunk, alpha, blockBeta, workspace);
+        } else
+            evaluate(block, workspace.buffers[node.buffers[j]], yChunk,
+                     alpha, blockBeta, workspace);
+        first = false;
+    }
+    if (first) {
+        // Block row without nonzero blocks
+        if (beta == static_cast<ValueType>(0.))
+            yChunk.fill(0.);
+        else
+            yChunk *= beta;
+    }
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> > fusedDiscreteOperator(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op)
+{
+    return shared_ptr<const DiscreteBoundaryOperator<ValueType> >(
+                new FusedDiscreteBoundaryOperator<ValueType>(op));
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(FusedDiscreteBoundaryOperator);
+
+#define INSTANTIATE_FREE_FUNCTIONS(VALUE) \
+    template shared_ptr<const DiscreteBoundaryOperator<VALUE> > \
+        fusedDiscreteOperator( \
+            const shared_ptr<const DiscreteBoundaryOperator<VALUE> >& op)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
+
+} // namespace Bempp
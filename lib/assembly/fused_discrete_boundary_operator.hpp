@@ -0,0 +1,203 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_fused_discrete_boundary_operator_hpp
+#define bempp_fused_discrete_boundary_operator_hpp
+
+#include "../common/common.hpp"
+#include "bempp/common/config_trilinos.hpp"
+
+#include "discrete_boundary_operator.hpp"
+
+#include "../common/shared_ptr.hpp"
+
+#include <tbb/mutex.h>
+#include <vector>
+
+#ifdef WITH_TRILINOS
+#include <Teuchos_RCP.hpp>
+#endif
+
+namespace Bempp
+{
+
+/** \ingroup composite_discrete_boundary_operators
+ *  \brief Evaluator of a tree of composite discrete boundary operators.
+ *
+ *  Sums, scaled, transposed and blocked operators and compositions nest
+ *  arbitrarily. Applied naively, each composition allocates a temporary
+ *  vector on every call and each node of the tree is visited through a
+ *  chain of virtual calls. This class walks the tree once, at
+ *  construction, and compiles it into a flat plan in which
+ *
+ *  - scalar multipliers and transposition modes are pushed down to the
+ *    leaves, so that they are absorbed into the \p alpha argument and the
+ *    transposition mode of the leaf operators' apply() calls,
+ *  - nested sums and nested compositions are flattened,
+ *  - every term of a sum accumulates directly into the output vector,
+ *  - the intermediate results of compositions and the chunks of blocked
+ *    operators live in buffers that are allocated on the first call to
+ *    apply() and reused by subsequent calls with the same number of
+ *    right-hand sides.
+ *
+ *  The operators stored in the tree must not be modified after this object
+ *  is constructed. Concurrent calls to apply() are safe; if the buffers are
+ *  already in use by another thread, temporary buffers are allocated. */
+template <typename ValueType>
+class FusedDiscreteBoundaryOperator :
+        public DiscreteBoundaryOperator<ValueType>
+{
+public:
+    typedef DiscreteBoundaryOperator<ValueType> Base;
+
+    /** \brief Constructor.
+     *
+     *  Compile the tree of discrete boundary operators rooted at \p op.
+     *
+     *  An exception is thrown if \p op is null. */
+    explicit FusedDiscreteBoundaryOperator(const shared_ptr<const Base>& op);
+
+    /** \brief Return the operator being evaluated. */
+    shared_ptr<const Base> operand() const { return m_operator; }
+
+    /** \brief Return the number of leaf operators in the compiled plan. */
+    size_t leafCount() const;
+
+    /** \brief Return the number of buffers used by the compiled plan. */
+    size_t bufferCount() const { return m_bufferRowCounts.size(); }
+
+    virtual arma::Mat<ValueType> asMatrix() const;
+
+    virtual unsigned int rowCount() const;
+    virtual unsigned int columnCount() const;
+
+    virtual void addBlock(const std::vector<int>& rows,
+                          const std::vector<int>& cols,
+                          const ValueType alpha,
+                          arma::Mat<ValueType>& block) const;
+
+#ifdef WITH_TRILINOS
+public:
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > domain() const;
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > range() const;
+
+protected:
+    virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+#endif
+
+private:
+    /** \cond PRIVATE */
+    struct Node
+    {
+        enum Kind { LEAF, SUM, PRODUCT, BLOCKED };
+
+        Kind kind;
+        // Dimensions of the operator represented by the node
+        size_t rowCount, columnCount;
+        // LEAF: the operator is applied as coefficient * trans(op)
+        shared_ptr<const Base> op;
+        TranspositionMode trans;
+        ValueType coefficient;
+        // SUM: terms; PRODUCT: factors in the order of application;
+        // BLOCKED: blocks stored row by row (NO_NODE stands for a zero block)
+        std::vector<size_t> children;
+        // PRODUCT: buffers[i] stores the output of factor i;
+        // BLOCKED: buffers of the chunks of the input vector (one per block
+        // column) followed by the buffer of the chunk of the output vector
+        std::vector<size_t> buffers;
+        // BLOCKED: dimensions of block rows and block columns
+        std::vector<size_t> blockRowCounts, blockColumnCounts;
+    };
+
+    struct Workspace
+    {
+        std::vector<arma::Mat<ValueType> > buffers;
+    };
+
+    static const size_t NO_NODE = static_cast<size_t>(-1);
+    /** \endcond */
+
+    virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                  const arma::Col<ValueType>& x_in,
+                                  arma::Col<ValueType>& y_inout,
+                                  const ValueType alpha,
+                                  const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
+
+    size_t compile(const shared_ptr<const Base>& op,
+                   TranspositionMode trans, ValueType coefficient);
+    size_t addNode(const Node& node);
+    size_t addBuffer(size_t rowCount);
+    void planBuffers(size_t node);
+    size_t leafCount(size_t node) const;
+
+    void evaluate(size_t node,
+                  const arma::Mat<ValueType>& x_in,
+                  arma::Mat<ValueType>& y_inout,
+                  const ValueType alpha,
+                  const ValueType beta,
+                  Workspace& workspace) const;
+    void evaluateBlocked(const Node& node,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta,
+                         Workspace& workspace) const;
+    void evaluateBlockRow(const Node& node,
+                          size_t blockRow,
+                          const arma::Mat<ValueType>& x_in,
+                          arma::Mat<ValueType>& yChunk,
+                          const ValueType alpha,
+                          const ValueType beta,
+                          Workspace& workspace) const;
+    arma::Mat<ValueType>& buffer(Workspace& workspace, size_t index,
+                                 size_t columnCount) const;
+
+private:
+    /** \cond PRIVATE */
+    shared_ptr<const Base> m_operator;
+    std::vector<Node> m_nodes;
+    // Roots of the plans compiled for each transposition mode
+    size_t m_roots[4];
+    std::vector<size_t> m_bufferRowCounts;
+    mutable tbb::mutex m_mutex;
+    mutable Workspace m_workspace;
+    /** \endcond */
+};
+
+/** \relates FusedDiscreteBoundaryOperator
+ *  \brief Return a FusedDiscreteBoundaryOperator evaluating the tree of
+ *  discrete boundary operators rooted at \p op.
+ *
+ *  The returned operator represents the same matrix as \p op, but applies it
+ *  without allocating temporaries on each call. It is worth using when a
+ *  composite operator, for example a Calderon-preconditioned
+ *  operator, is applied many times, e.g. inside an iterative solver. */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> > fusedDiscreteOperator(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op);
+
+} // namespace Bempp
+
+#endif
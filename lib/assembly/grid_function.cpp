@@ -37,8 +37,10 @@
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/quadrature_strategy.hpp"
 #include "../fiber/local_assembler_for_grid_functions.hpp"
+#include "../fiber/numerical_quadrature.hpp"
 #include "../fiber/opencl_handler.hpp"
 #include "../fiber/raw_grid_geometry.hpp"
+#include "../fiber/serial_blas_region.hpp"
 #include "../grid/geometry_factory.hpp"
 #include "../grid/grid.hpp"
 #include "../grid/grid_view.hpp"
@@ -48,7 +50,12 @@
 #include "../grid/vtk_writer_helper.hpp"
 #include "../space/space.hpp"
 
-#include <set>
+#include <algorithm>
+#include <map>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
 
 // TODO: rewrite the constructor of OpenClHandler.
 // It should take a bool useOpenCl and *in addition to that* openClOptions.
@@ -68,14 +75,47 @@ namespace Bempp
 namespace
 {
 
+// Elements are processed in chunks of at least this size, so that the
+// local assembler can still group them by quadrature variant
+const size_t PROJECTION_GRAIN_SIZE = 256;
+
+// Evaluates the local weak forms on a range of elements. Each element's
+// result is stored at its own position, so the loop body can be executed
+// concurrently
+template <typename ResultType>
+class ProjectionLoopBody
+{
+public:
+    ProjectionLoopBody(
+            Fiber::LocalAssemblerForGridFunctions<ResultType>& assembler,
+            std::vector<arma::Col<ResultType> >& localResults) :
+        m_assembler(assembler), m_localResults(localResults) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        std::vector<int> elementIndices;
+        elementIndices.reserve(r.size());
+        for (size_t e = r.begin(); e != r.end(); ++e)
+            elementIndices.push_back(e);
+
+        std::vector<arma::Col<ResultType> > localResult;
+        m_assembler.evaluateLocalWeakForms(elementIndices, localResult);
+        for (size_t i = 0; i < localResult.size(); ++i)
+            m_localResults[r.begin() + i] = localResult[i];
+    }
+
+private:
+    Fiber::LocalAssemblerForGridFunctions<ResultType>& m_assembler;
+    std::vector<arma::Col<ResultType> >& m_localResults;
+};
+
 template <typename BasisFunctionType, typename ResultType>
 shared_ptr<arma::Col<ResultType> > reallyCalculateProjections(
         const Space<BasisFunctionType>& dualSpace,
         Fiber::LocalAssemblerForGridFunctions<ResultType>& assembler,
-        const AssemblyOptions& options)
+        const AssemblyOptions& options,
+        bool isFunctionThreadSafe)
 {
-    // TODO: parallelise using TBB (the parameter options will then start be used)
-
     // Get the grid's leaf view so that we can iterate over elements
     std::auto_ptr<GridView> view = dualSpace.grid()->leafView();
     const size_t elementCount = view->entityCount(0);
@@ -95,21 +135,33 @@ shared_ptr<arma::Col<ResultType> > reallyCalculateProjections(
         it->next();
     }
 
-    // Make a vector of all element indices
-    std::vector<int> testIndices(elementCount);
-    for (size_t i = 0; i < elementCount; ++i)
-        testIndices[i] = i;
-
     // Create the weak form's column vector
     shared_ptr<arma::Col<ResultType> > result(
                 new arma::Col<ResultType>(dualSpace.globalDofCount()));
     result->fill(0.);
 
-    std::vector<arma::Col<ResultType> > localResult;
-    // Evaluate local weak forms
-    assembler.evaluateLocalWeakForms(testIndices, localResult);
+    // Evaluate local weak forms in parallel
+    const ParallelizationOptions& parallelOptions =
+            options.parallelizationOptions();
+    int maxThreadCount = 1;
+    if (!parallelOptions.isOpenClEnabled() && isFunctionThreadSafe) {
+        if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+            maxThreadCount = tbb::task_scheduler_init::automatic;
+        else
+            maxThreadCount = parallelOptions.maxThreadCount();
+    }
+    std::vector<arma::Col<ResultType> > localResult(elementCount);
+    {
+        tbb::task_scheduler_init scheduler(maxThreadCount);
+        Fiber::SerialBlasRegion region;
+        typedef ProjectionLoopBody<ResultType> Body;
+        tbb::parallel_for(tbb::blocked_range<size_t>(
+                              0, elementCount, PROJECTION_GRAIN_SIZE),
+                          Body(assembler, localResult));
+    }
 
-    // Loop over test indices
+    // Loop over test indices. The contributions are added serially, in a
+    // fixed order, so that the result does not depend on the number of threads
     for (size_t testIndex = 0; testIndex < elementCount; ++testIndex)
         // Add the integrals to appropriate entries in the global weak form
         for (size_t testDof = 0; testDof < testGlobalDofs[testIndex].size(); ++testDof)
@@ -161,9 +213,268 @@ shared_ptr<arma::Col<ResultType> > calculateProjections(
                 make_shared_from_ref(globalFunction),
                 openClHandler);
 
-    return reallyCalculateProjections(dualSpace, *assembler, options);
+    return reallyCalculateProjections(dualSpace, *assembler, options,
+                                      globalFunction.isThreadSafe());
+}
+
+// Elements are processed in chunks of at least this size when a grid
+// function is integrated or evaluated at special points
+const size_t ELEMENT_GRAIN_SIZE = 1024;
+
+int schedulerThreadCount(const ParallelizationOptions& parallelOptions)
+{
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+        return tbb::task_scheduler_init::automatic;
+    else
+        return parallelOptions.maxThreadCount();
+}
+
+// Local expansions of a grid function: the type of each element (identified
+// by its basis and corner count) and the local expansion coefficients
+template <typename BasisFunctionType, typename ResultType>
+struct LocalExpansions
+{
+    typedef std::pair<const Fiber::Basis<BasisFunctionType>*, int>
+    BasisAndCornerCount;
+
+    std::vector<BasisAndCornerCount> elementTypes;
+    std::vector<int> elementTypeIndices;
+    std::vector<std::vector<ResultType> > localCoefficients;
+};
+
+template <typename BasisFunctionType, typename ResultType>
+void collectLocalExpansions(
+        const GridFunction<BasisFunctionType, ResultType>& gridFunction,
+        const GridView& view,
+        const Fiber::RawGridGeometry<
+            typename Fiber::ScalarTraits<ResultType>::RealType>& rawGeometry,
+        LocalExpansions<BasisFunctionType, ResultType>& expansions)
+{
+    typedef typename LocalExpansions<BasisFunctionType, ResultType>::
+            BasisAndCornerCount BasisAndCornerCount;
+    typedef std::map<BasisAndCornerCount, int> ElementTypeMap;
+
+    const size_t elementCount = view.entityCount(0);
+    expansions.elementTypes.clear();
+    expansions.elementTypeIndices.resize(elementCount);
+    expansions.localCoefficients.resize(elementCount);
+
+    ElementTypeMap typeIndices;
+    std::auto_ptr<EntityIterator<0> > it = view.entityIterator<0>();
+    for (size_t e = 0; e < elementCount; ++e) {
+        const Entity<0>& element = it->entity();
+        const BasisAndCornerCount type(&gridFunction.basis(element),
+                                       rawGeometry.elementCornerCount(e));
+        typename ElementTypeMap::const_iterator typeIt = typeIndices.find(type);
+        if (typeIt == typeIndices.end()) {
+            typeIt = typeIndices.insert(std::make_pair(
+                        type, int(expansions.elementTypes.size()))).first;
+            expansions.elementTypes.push_back(type);
+        }
+        expansions.elementTypeIndices[e] = typeIt->second;
+        gridFunction.getLocalCoefficients(element,
+                                          expansions.localCoefficients[e]);
+        it->next();
+    }
+}
+
+// Values of the basis functions of an element type at a fixed set of local
+// points. They are calculated before the parallel loops over elements and
+// then shared by all threads.
+template <typename BasisFunctionType, typename CoordinateType>
+struct ElementTypeData
+{
+    arma::Mat<CoordinateType> localPoints;
+    std::vector<CoordinateType> weights;
+    Fiber::BasisData<BasisFunctionType> basisData;
+};
+
+// Expand the values and/or derivatives of a function with the given local
+// coefficients from those of the basis functions
+template <typename BasisFunctionType, typename ResultType>
+void evaluateLocalExpansion(
+        size_t basisDeps,
+        const Fiber::BasisData<BasisFunctionType>& basisData,
+        const std::vector<ResultType>& localCoefficients,
+        Fiber::BasisData<ResultType>& functionData)
+{
+    if (basisDeps & Fiber::VALUES) {
+        functionData.values.set_size(basisData.values.extent(0),
+                                     1, // just one function
+                                     basisData.values.extent(2));
+        std::fill(functionData.values.begin(),
+                  functionData.values.end(), 0.);
+        for (size_t point = 0; point < basisData.values.extent(2); ++point)
+            for (size_t dim = 0; dim < basisData.values.extent(0); ++dim)
+                for (size_t fun = 0; fun < basisData.values.extent(1); ++fun)
+                    functionData.values(dim, 0, point) +=
+                            basisData.values(dim, fun, point) *
+                            localCoefficients[fun];
+    }
+    if (basisDeps & Fiber::DERIVATIVES) {
+        functionData.derivatives.set_size(basisData.derivatives.extent(0),
+                                          basisData.derivatives.extent(1),
+                                          1, // just one function
+                                          basisData.derivatives.extent(3));
+        std::fill(functionData.derivatives.begin(),
+                  functionData.derivatives.end(), 0.);
+        for (size_t point = 0; point < basisData.derivatives.extent(3); ++point)
+            for (size_t dim = 0; dim < basisData.derivatives.extent(1); ++dim)
+                for (size_t comp = 0; comp < basisData.derivatives.extent(0); ++comp)
+                    for (size_t fun = 0; fun < basisData.derivatives.extent(2); ++fun)
+                        functionData.derivatives(comp, dim, 0, point) +=
+                                basisData.derivatives(comp, dim, fun, point) *
+                                localCoefficients[fun];
+    }
 }
 
+// Integrates the squared magnitude of a grid function over a range of
+// elements. Each element's integral is stored at its own position, so the
+// loop body can be executed concurrently
+template <typename BasisFunctionType, typename ResultType>
+class L2NormLoopBody
+{
+public:
+    typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
+    typedef ElementTypeData<BasisFunctionType, CoordinateType> TypeData;
+
+    L2NormLoopBody(
+            const Fiber::RawGridGeometry<CoordinateType>& rawGeometry,
+            const GeometryFactory& geometryFactory,
+            const Fiber::CollectionOfBasisTransformations<CoordinateType>&
+            transformations,
+            size_t basisDeps, size_t geomDeps,
+            const std::vector<shared_ptr<const TypeData> >& typeData,
+            const LocalExpansions<BasisFunctionType, ResultType>& expansions,
+            std::vector<CoordinateType>& elementIntegrals) :
+        m_rawGeometry(rawGeometry), m_geometryFactory(geometryFactory),
+        m_transformations(transformations),
+        m_basisDeps(basisDeps), m_geomDeps(geomDeps),
+        m_typeData(typeData), m_expansions(expansions),
+        m_elementIntegrals(elementIntegrals) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        std::auto_ptr<typename GeometryFactory::Geometry> geometry(
+                    m_geometryFactory.make());
+        Fiber::GeometricalData<CoordinateType> geomData;
+        Fiber::BasisData<ResultType> functionData;
+        Fiber::CollectionOf3dArrays<ResultType> functionValues;
+
+        for (size_t e = r.begin(); e != r.end(); ++e) {
+            const TypeData& typeData =
+                    *m_typeData[m_expansions.elementTypeIndices[e]];
+            evaluateLocalExpansion(m_basisDeps, typeData.basisData,
+                                   m_expansions.localCoefficients[e],
+                                   functionData);
+            m_rawGeometry.setupGeometry(e, *geometry);
+            geometry->getData(m_geomDeps, typeData.localPoints, geomData);
+            m_transformations.evaluate(functionData, geomData, functionValues);
+
+            const Fiber::_3dArray<ResultType>& values = functionValues[0];
+            CoordinateType integral = 0.;
+            for (size_t point = 0; point < values.extent(2); ++point) {
+                CoordinateType sum = 0.;
+                for (size_t dim = 0; dim < values.extent(0); ++dim) {
+                    const ResultType value = values(dim, 0, point);
+                    sum += realPart(value) * realPart(value) +
+                            imagPart(value) * imagPart(value);
+                }
+                integral += typeData.weights[point] *
+                        geomData.integrationElements(point) * sum;
+            }
+            m_elementIntegrals[e] = integral;
+        }
+    }
+
+private:
+    const Fiber::RawGridGeometry<CoordinateType>& m_rawGeometry;
+    const GeometryFactory& m_geometryFactory;
+    const Fiber::CollectionOfBasisTransformations<CoordinateType>&
+    m_transformations;
+    size_t m_basisDeps, m_geomDeps;
+    const std::vector<shared_ptr<const TypeData> >& m_typeData;
+    const LocalExpansions<BasisFunctionType, ResultType>& m_expansions;
+    std::vector<CoordinateType>& m_elementIntegrals;
+};
+
+// Evaluates a grid function at the local points of its element type on a
+// range of elements. The values (and, optionally, the global coordinates of
+// the points) are written to buffers with a fixed number of entries per
+// element, so the loop body can be executed concurrently
+template <typename BasisFunctionType, typename ResultType>
+class SpecialPointsLoopBody
+{
+public:
+    typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
+    typedef ElementTypeData<BasisFunctionType, CoordinateType> TypeData;
+
+    SpecialPointsLoopBody(
+            const Fiber::RawGridGeometry<CoordinateType>& rawGeometry,
+            const GeometryFactory& geometryFactory,
+            const Fiber::CollectionOfBasisTransformations<CoordinateType>&
+            transformations,
+            size_t basisDeps, size_t geomDeps,
+            const std::vector<shared_ptr<const TypeData> >& typeData,
+            const LocalExpansions<BasisFunctionType, ResultType>& expansions,
+            size_t maxPointCount,
+            ResultType* values, CoordinateType* points) :
+        m_rawGeometry(rawGeometry), m_geometryFactory(geometryFactory),
+        m_transformations(transformations),
+        m_basisDeps(basisDeps), m_geomDeps(geomDeps),
+        m_typeData(typeData), m_expansions(expansions),
+        m_maxPointCount(maxPointCount), m_values(values), m_points(points) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        std::auto_ptr<typename GeometryFactory::Geometry> geometry(
+                    m_geometryFactory.make());
+        Fiber::GeometricalData<CoordinateType> geomData;
+        Fiber::BasisData<ResultType> functionData;
+        Fiber::CollectionOf3dArrays<ResultType> functionValues;
+
+        for (size_t e = r.begin(); e != r.end(); ++e) {
+            const TypeData& typeData =
+                    *m_typeData[m_expansions.elementTypeIndices[e]];
+            evaluateLocalExpansion(m_basisDeps, typeData.basisData,
+                                   m_expansions.localCoefficients[e],
+                                   functionData);
+            m_rawGeometry.setupGeometry(e, *geometry);
+            geometry->getData(m_geomDeps, typeData.localPoints, geomData);
+            m_transformations.evaluate(functionData, geomData, functionValues);
+            assert(functionValues[0].extent(1) == 1); // one function
+
+            const Fiber::_3dArray<ResultType>& localValues = functionValues[0];
+            const size_t componentCount = localValues.extent(0);
+            const size_t pointCount = localValues.extent(2);
+            ResultType* values = m_values + e * m_maxPointCount * componentCount;
+            for (size_t point = 0; point < pointCount; ++point)
+                for (size_t dim = 0; dim < componentCount; ++dim)
+                    *values++ = localValues(dim, 0, point);
+            if (m_points) {
+                const size_t worldDim = geomData.globals.n_rows;
+                CoordinateType* points =
+                        m_points + e * m_maxPointCount * worldDim;
+                for (size_t point = 0; point < pointCount; ++point)
+                    for (size_t dim = 0; dim < worldDim; ++dim)
+                        *points++ = geomData.globals(dim, point);
+            }
+        }
+    }
+
+private:
+    const Fiber::RawGridGeometry<CoordinateType>& m_rawGeometry;
+    const GeometryFactory& m_geometryFactory;
+    const Fiber::CollectionOfBasisTransformations<CoordinateType>&
+    m_transformations;
+    size_t m_basisDeps, m_geomDeps;
+    const std::vector<shared_ptr<const TypeData> >& m_typeData;
+    const LocalExpansions<BasisFunctionType, ResultType>& m_expansions;
+    size_t m_maxPointCount;
+    ResultType* m_values;
+    CoordinateType* m_points;
+};
+
 } // namespace
 
 // Recommended constructors
@@ -475,29 +786,68 @@ typename GridFunction<BasisFunctionType, ResultType>::MagnitudeType
 GridFunction<BasisFunctionType, ResultType>::L2Norm() const
 {
     // The L^2 norm is given by
-    //   sqrt(u^\dagger M u),
-    // where u is the coefficient vector and M the mass matrix of m_space
+    //   sqrt(\int_\Gamma |u|^2),
+    // where the integral is evaluated element by element, in parallel, with
+    // a quadrature rule exact for products of two basis functions on flat
+    // elements
 
     if (!m_space)
         throw std::runtime_error("GridFunction::L2_Norm() must not be called "
                                  "on an uninitialized GridFunction object");
-    typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
 
-    // Get the vector of coefficients
-    const arma::Col<ResultType>& coeffs = coefficients();
+    shared_ptr<const Grid> grid = m_space->grid();
+    std::auto_ptr<GridView> view = grid->leafView();
+    const size_t elementCount = view->entityCount(0);
 
-    // Calculate the mass matrix
-    BoundaryOp id = identityOperator(m_context, m_space, m_space, m_space);
-    shared_ptr<const DiscreteBoundaryOperator<ResultType> > massMatrix =
-            id.weakForm();
+    // Gather geometric data
+    Fiber::RawGridGeometry<CoordinateType> rawGeometry(grid->dim(),
+                                                       grid->dimWorld());
+    view->getRawElementData(
+                rawGeometry.vertices(), rawGeometry.elementCornerIndices(),
+                rawGeometry.auxData());
+    std::auto_ptr<GeometryFactory> geometryFactory =
+            grid->elementGeometryFactory();
 
-    arma::Col<ResultType> product(coeffs.n_rows);
-    massMatrix->apply(NO_TRANSPOSE, coeffs, product, 1., 0.);
-    ResultType result = arma::cdot(coeffs, product);
-    if (fabs(imagPart(result)) > 1000. * std::numeric_limits<MagnitudeType>::epsilon())
-        std::cout << "Warning: squared L2Norm has non-negligible imaginary part: "
-                  << imagPart(result) << std::endl;
-    return sqrt(realPart(result));
+    LocalExpansions<BasisFunctionType, ResultType> expansions;
+    collectLocalExpansions(*this, *view, rawGeometry, expansions);
+
+    size_t basisDeps = 0, geomDeps = Fiber::INTEGRATION_ELEMENTS;
+    const Fiber::CollectionOfBasisTransformations<CoordinateType>& transformations =
+            m_space->shapeFunctionValue();
+    transformations.addDependencies(basisDeps, geomDeps);
+
+    // Evaluate the basis functions of each element type at quadrature points
+    typedef ElementTypeData<BasisFunctionType, CoordinateType> TypeData;
+    std::vector<shared_ptr<const TypeData> > typeData;
+    for (size_t t = 0; t < expansions.elementTypes.size(); ++t) {
+        const Fiber::Basis<BasisFunctionType>& basis =
+                *expansions.elementTypes[t].first;
+        shared_ptr<TypeData> data(new TypeData);
+        Fiber::fillSingleQuadraturePointsAndWeights(
+                    expansions.elementTypes[t].second, 2 * basis.order(),
+                    data->localPoints, data->weights);
+        basis.evaluate(basisDeps, data->localPoints, ALL_DOFS, data->basisData);
+        typeData.push_back(data);
+    }
+
+    std::vector<MagnitudeType> elementIntegrals(elementCount);
+    {
+        tbb::task_scheduler_init scheduler(schedulerThreadCount(
+                    m_context->assemblyOptions().parallelizationOptions()));
+        typedef L2NormLoopBody<BasisFunctionType, ResultType> Body;
+        tbb::parallel_for(tbb::blocked_range<size_t>(
+                              0, elementCount, ELEMENT_GRAIN_SIZE),
+                          Body(rawGeometry, *geometryFactory, transformations,
+                               basisDeps, geomDeps, typeData, expansions,
+                               elementIntegrals));
+    }
+
+    // Sum the contributions of individual elements in a fixed order, so that
+    // the result does not depend on the number of threads
+    MagnitudeType result = 0.;
+    for (size_t e = 0; e < elementCount; ++e)
+        result += elementIntegrals[e];
+    return sqrt(result);
 }
 
 // Redundant, in fact -- can be obtained directly from Space
@@ -560,6 +910,25 @@ template <typename BasisFunctionType, typename ResultType>
 void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
         VtkWriter::DataType dataType, arma::Mat<CoordinateType>& points,
         arma::Mat<ResultType>& values) const
+{
+    if (!m_space)
+        throw std::runtime_error("GridFunction::evaluateAtSpecialPoints() must "
+                                 "not be called on an uninitialized GridFunction object");
+
+    shared_ptr<const Grid> grid = m_space->grid();
+    std::auto_ptr<GridView> view = grid->leafView();
+    const size_t pointCount = view->entityCount(
+                dataType == VtkWriter::CELL_DATA ? 0 : grid->dim());
+
+    values.set_size(componentCount(), pointCount);
+    points.set_size(grid->dimWorld(), pointCount);
+    evaluateAtSpecialPoints(dataType, values.memptr(), points.memptr());
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
+        VtkWriter::DataType dataType, ResultType* values,
+        CoordinateType* points) const
 {
     if (!m_space)
         throw std::runtime_error("GridFunction::evaluateAtSpecialPoints() must "
@@ -567,6 +936,9 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     if (dataType != VtkWriter::CELL_DATA && dataType != VtkWriter::VERTEX_DATA)
         throw std::invalid_argument("GridFunction::evaluateAtSpecialPoints(): "
                                     "invalid data type");
+    if (!values)
+        throw std::invalid_argument("GridFunction::evaluateAtSpecialPoints(): "
+                                    "values must not be null");
 
     shared_ptr<const Grid> grid = m_space->grid();
     const int gridDim = grid->dim();
@@ -579,18 +951,8 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     const size_t elementCount = view->entityCount(elementCodim);
     const size_t vertexCount = view->entityCount(vertexCodim);
 
-    values.set_size(nComponents,
-                     dataType == VtkWriter::CELL_DATA ? elementCount : vertexCount);
-    values.fill(0.);
-    points.set_size(worldDim, values.n_cols);
-
-    // Number of elements contributing to each column in result
-    // (this will be greater than 1 for VERTEX_DATA)
-    std::vector<int> multiplicities(vertexCount);
-    std::fill(multiplicities.begin(), multiplicities.end(), 0);
-
     // Gather geometric data
-    Fiber::RawGridGeometry<CoordinateType> rawGeometry(gridDim, grid->dimWorld());
+    Fiber::RawGridGeometry<CoordinateType> rawGeometry(gridDim, worldDim);
     view->getRawElementData(
                 rawGeometry.vertices(), rawGeometry.elementCornerIndices(),
                 rawGeometry.auxData());
@@ -598,30 +960,11 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     // Make geometry factory
     std::auto_ptr<GeometryFactory> geometryFactory =
             grid->elementGeometryFactory();
-    std::auto_ptr<typename GeometryFactory::Geometry> geometry(
-                geometryFactory->make());
-    Fiber::GeometricalData<CoordinateType> geomData;
 
     // For each element, get its basis and corner count (this is sufficient
     // to identify its geometry) as well as its local coefficients
-    typedef std::pair<const Fiber::Basis<BasisFunctionType>*, int> BasisAndCornerCount;
-    typedef std::vector<BasisAndCornerCount> BasisAndCornerCountVector;
-    BasisAndCornerCountVector basesAndCornerCounts(elementCount);
-    std::vector<std::vector<ResultType> > localCoefficients(elementCount);
-    {
-        std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
-        for (size_t e = 0; e < elementCount; ++e) {
-            const Entity<0>& element = it->entity();
-            basesAndCornerCounts[e] = BasisAndCornerCount(
-                        &m_space->basis(element), rawGeometry.elementCornerCount(e));
-            getLocalCoefficients(element, localCoefficients[e]);
-            it->next();
-        }
-    }
-
-    typedef std::set<BasisAndCornerCount> BasisAndCornerCountSet;
-    BasisAndCornerCountSet uniqueBasesAndCornerCounts(
-                basesAndCornerCounts.begin(), basesAndCornerCounts.end());
+    LocalExpansions<BasisFunctionType, ResultType> expansions;
+    collectLocalExpansions(*this, *view, rawGeometry, expansions);
 
     // Find out which basis data need to be calculated
     size_t basisDeps = 0, geomDeps = Fiber::GLOBALS;
@@ -632,19 +975,21 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     assert(nComponents == transformations.resultDimension(0));
     transformations.addDependencies(basisDeps, geomDeps);
 
-    // Loop over unique combinations of basis and element corner count
-    typedef typename BasisAndCornerCountSet::const_iterator
-            BasisAndCornerCountSetConstIt;
-    for (BasisAndCornerCountSetConstIt it = uniqueBasesAndCornerCounts.begin();
-         it != uniqueBasesAndCornerCounts.end(); ++it) {
-        const BasisAndCornerCount& activeBasisAndCornerCount = *it;
+    // Evaluate the basis functions of each element type at either all its
+    // vertices or its barycentre
+    typedef ElementTypeData<BasisFunctionType, CoordinateType> TypeData;
+    std::vector<shared_ptr<const TypeData> > typeData;
+    int maxCornerCount = 0;
+    for (size_t t = 0; t < expansions.elementTypes.size(); ++t) {
         const Fiber::Basis<BasisFunctionType>& activeBasis =
-                *activeBasisAndCornerCount.first;
-        int activeCornerCount = activeBasisAndCornerCount.second;
+                *expansions.elementTypes[t].first;
+        const int activeCornerCount = expansions.elementTypes[t].second;
+        maxCornerCount = std::max(maxCornerCount, activeCornerCount);
 
         // Set the local coordinates of either all vertices or the barycentre
         // of the active element type
-        arma::Mat<CoordinateType> local;
+        shared_ptr<TypeData> data(new TypeData);
+        arma::Mat<CoordinateType>& local = data->localPoints;
         if (dataType == VtkWriter::CELL_DATA) {
             local.set_size(gridDim, 1);
 
@@ -689,92 +1034,67 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
         }
 
         // Get basis data
-        Fiber::BasisData<BasisFunctionType> basisData;
-        activeBasis.evaluate(basisDeps, local, ALL_DOFS, basisData);
-
-        Fiber::BasisData<ResultType> functionData;
-        if (basisDeps & Fiber::VALUES)
-            functionData.values.set_size(basisData.values.extent(0),
-                                         1, // just one function
-                                         basisData.values.extent(2));
-        if (basisDeps & Fiber::DERIVATIVES)
-            functionData.derivatives.set_size(basisData.derivatives.extent(0),
-                                              basisData.derivatives.extent(1),
-                                              1, // just one function
-                                              basisData.derivatives.extent(3));
-        Fiber::CollectionOf3dArrays<ResultType> functionValues;
-
-        // Loop over elements and process those that use the active basis
-        for (size_t e = 0; e < elementCount; ++e) {
-            if (basesAndCornerCounts[e].first != &activeBasis)
-                continue;
-
-            // Local coefficients of the argument in the current element
-            const std::vector<ResultType>& activeLocalCoefficients =
-                    localCoefficients[e];
-
-            // Calculate the function's values and/or derivatives
-            // at the requested points in the current element
-            if (basisDeps & Fiber::VALUES) {
-                std::fill(functionData.values.begin(),
-                          functionData.values.end(), 0.);
-                for (size_t point = 0; point < basisData.values.extent(2); ++point)
-                    for (size_t dim = 0; dim < basisData.values.extent(0); ++dim)
-                        for (size_t fun = 0; fun < basisData.values.extent(1); ++fun)
-                            functionData.values(dim, 0, point) +=
-                                    basisData.values(dim, fun, point) *
-                                    activeLocalCoefficients[fun];
-            }
-            if (basisDeps & Fiber::DERIVATIVES) {
-                std::fill(functionData.derivatives.begin(),
-                          functionData.derivatives.end(), 0.);
-                for (size_t point = 0; point < basisData.derivatives.extent(3); ++point)
-                    for (size_t dim = 0; dim < basisData.derivatives.extent(1); ++dim)
-                        for (size_t comp = 0; comp < basisData.derivatives.extent(0); ++comp)
-                            for (size_t fun = 0; fun < basisData.derivatives.extent(2); ++fun)
-                                functionData.derivatives(comp, dim, 0, point) +=
-                                        basisData.derivatives(comp, dim, fun, point) *
-                                        activeLocalCoefficients[fun];
-            }
+        activeBasis.evaluate(basisDeps, local, ALL_DOFS, data->basisData);
+        typeData.push_back(data);
+    }
 
-            // Get geometrical data
-            rawGeometry.setupGeometry(e, *geometry);
-            geometry->getData(geomDeps, local, geomData);
+    // Evaluate the function in parallel. Values at barycentres are written
+    // straight into the output buffers; values at the vertices of each
+    // element are stored in a temporary buffer and averaged below
+    const size_t maxPointCount =
+            dataType == VtkWriter::CELL_DATA ? 1 : maxCornerCount;
+    std::vector<ResultType> cornerValues;
+    if (dataType == VtkWriter::VERTEX_DATA)
+        cornerValues.resize(elementCount * maxPointCount * nComponents);
+    // cornerValues is empty if the grid has no elements
+    ResultType* cornerValuesBuffer =
+            cornerValues.empty() ? 0 : &cornerValues[0];
+    {
+        tbb::task_scheduler_init scheduler(schedulerThreadCount(
+                    m_context->assemblyOptions().parallelizationOptions()));
+        typedef SpecialPointsLoopBody<BasisFunctionType, ResultType> Body;
+        tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, elementCount,
+                                               ELEMENT_GRAIN_SIZE),
+                    Body(rawGeometry, *geometryFactory, transformations,
+                         basisDeps, geomDeps, typeData, expansions,
+                         maxPointCount,
+                         dataType == VtkWriter::CELL_DATA ?
+                             values : cornerValuesBuffer,
+                         dataType == VtkWriter::CELL_DATA ? points : 0));
+    }
 
-            transformations.evaluate(functionData, geomData, functionValues);
-            assert(functionValues[0].extent(1) == 1); // one function
+    if (dataType == VtkWriter::VERTEX_DATA) {
+        // Add the values calculated in each element to the columns of the
+        // result array corresponding to the element's vertices, in a fixed
+        // order, and take the average
+        std::fill(values, values + vertexCount * nComponents, 0.);
 
-            if (dataType == VtkWriter::CELL_DATA) {
+        // Number of elements contributing to each column in result
+        std::vector<int> multiplicities(vertexCount, 0);
+        const arma::Mat<int>& cornerIndices = rawGeometry.elementCornerIndices();
+        for (size_t e = 0; e < elementCount; ++e) {
+            const int activeCornerCount = rawGeometry.elementCornerCount(e);
+            const ResultType* elementValues =
+                    &cornerValues[e * maxPointCount * nComponents];
+            for (int c = 0; c < activeCornerCount; ++c) {
+                const int vertexIndex = cornerIndices(c, e);
                 for (int dim = 0; dim < nComponents; ++dim)
-                    values(dim, e) = functionValues[0](     // array index
-                                                       dim, // component
-                                                       0,   // function index
-                                                       0);  // point index
-                for (int dim = 0; dim < worldDim; ++dim)
-                    points(dim, e) = geomData.globals(dim, 0);
-            }
-            else { // VERTEX_DATA
-                // Add the calculated values to the columns of the result array
-                // corresponding to the active element's vertices
-                for (int c = 0; c < activeCornerCount; ++c) {
-                    int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
-                    for (int dim = 0; dim < nComponents; ++dim)
-                        values(dim, vertexIndex) += functionValues[0](dim, 0, c);
-                    ++multiplicities[vertexIndex];
-                }
-                for (int c = 0; c < activeCornerCount; ++c) {
-                    int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
-                    for (int dim = 0; dim < worldDim; ++dim)
-                        points(dim, vertexIndex) = geomData.globals(dim, c);
-                }
+                    values[vertexIndex * nComponents + dim] +=
+                            elementValues[c * nComponents + dim];
+                ++multiplicities[vertexIndex];
             }
-        } // end of loop over elements
-    } // end of loop over unique combinations of basis and corner count
-
-    // Take average of the vertex values obtained in each of the adjacent elements
-    if (dataType == VtkWriter::VERTEX_DATA)
+        }
         for (size_t v = 0; v < vertexCount; ++v)
-            values.col(v) /= multiplicities[v];
+            for (int dim = 0; dim < nComponents; ++dim)
+                values[v * nComponents + dim] /=
+                        static_cast<CoordinateType>(multiplicities[v]);
+
+        if (points) {
+            const arma::Mat<CoordinateType>& vertices = rawGeometry.vertices();
+            std::copy(vertices.begin(), vertices.end(), points);
+        }
+    }
 }
 
 template <typename BasisFunctionType, typename ResultType>
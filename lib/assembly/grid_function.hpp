@@ -296,6 +296,10 @@ public:
     BEMPP_DEPRECATED void setProjections(const arma::Col<ResultType>& projects);
 
     /** \brief Return the \f$L^2\f$-norm of the grid function.
+     *
+     *  The contributions of individual elements are calculated in parallel,
+     *  using the number of threads specified in the assembly options of the
+     *  function's context.
      *
      *  \note For better accuracy, prefer to use L2NormOfDifference() or
      *  estimateL2Error() to calculate the norm of the difference between a grid
@@ -334,8 +338,10 @@ public:
         output in the current directory.
 
       \param[in] type
-        Output type (default: ASCII). See Dune reference manual for more
-        details.
+        Output type (default: ASCII). For large grids, the binary types
+        (in particular VtkWriter::APPENDED_RAW_COMPRESSED, available if
+        BEM++ has been built with zlib) produce much smaller files and are
+        written considerably faster. See VtkWriter::OutputType for details.
 
       \note An exception is thrown if this function is called on an
         uninitialized GridFunction object. */
@@ -345,6 +351,9 @@ public:
                      VtkWriter::OutputType type = VtkWriter::ASCII) const;
 
     /** \brief Evaluate function at either vertices or barycentres.
+     *
+     *  The elements are processed in parallel, using the number of threads
+     *  specified in the assembly options of the function's context.
      *
      *  \note The results of calling this function on an uninitialized
      *  GridFunction object are undefined. */
@@ -354,6 +363,32 @@ public:
             VtkWriter::DataType dataType,
             arma::Mat<CoordinateType>& points, arma::Mat<ResultType>& values) const;
 
+    /** \brief Evaluate function at either vertices or barycentres, writing
+     *  the results directly into caller-supplied buffers.
+     *
+     *  \param[in] dataType
+     *    Determines whether the function is evaluated at vertices or at
+     *    barycentres of elements.
+     *  \param[out] values
+     *    Buffer with room for componentCount() values per vertex (if
+     *    \p dataType is VtkWriter::VERTEX_DATA) or element (if \p dataType is
+     *    VtkWriter::CELL_DATA) of the leaf view of the grid. The values at
+     *    each point are stored contiguously, in the order of point indices.
+     *  \param[out] points
+     *    Buffer with room for <tt>grid()->dimWorld()</tt> coordinates per
+     *    point, laid out as \p values, or NULL if the coordinates of the
+     *    points are not needed.
+     *
+     *  This overload avoids the allocation of intermediate matrices and can
+     *  be used to stream the values of functions defined on large grids
+     *  directly into output buffers.
+     *
+     *  \note The results of calling this function on an uninitialized
+     *  GridFunction object are undefined. */
+    void evaluateAtSpecialPoints(
+            VtkWriter::DataType dataType,
+            ResultType* values, CoordinateType* points = 0) const;
+
 private:
     void initializeFromCoefficients(
             const shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
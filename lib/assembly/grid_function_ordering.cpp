@@ -0,0 +1,111 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid_function_ordering.hpp"
+
+#include "dof_entity_helper.hpp"
+#include "grid_function.hpp"
+
+#include "../common/not_implemented_error.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+#include "../grid/grid.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Return the vector whose i'th element is the original index of the entity
+// to which the i'th global DOF of space is attached
+template <typename BasisFunctionType>
+std::vector<int> originalDofEntities(const Space<BasisFunctionType>& space,
+                                     const char* caller)
+{
+    typedef DofEntityHelper Helper;
+    const Helper::SpaceKind kind = Helper::spaceKind(space);
+    if (kind == Helper::OTHER)
+        throw NotImplementedError(std::string(caller) +
+                                  ": unsupported space type");
+    std::vector<int> entities = Helper::dofEntities(space, kind);
+    std::vector<int> originalIndices;
+    if (kind == Helper::PIECEWISE_CONSTANT)
+        space.grid()->getOriginalElementIndices(originalIndices);
+    else
+        space.grid()->getOriginalVertexIndices(originalIndices);
+    for (size_t dof = 0; dof < entities.size(); ++dof)
+        entities[dof] = originalIndices[entities[dof]];
+    return entities;
+}
+
+} // namespace
+
+template <typename BasisFunctionType, typename ResultType>
+arma::Col<ResultType> coefficientsInOriginalOrdering(
+        const GridFunction<BasisFunctionType, ResultType>& function)
+{
+    const std::vector<int> entities = originalDofEntities(
+                *function.space(), "coefficientsInOriginalOrdering()");
+    const arma::Col<ResultType>& coefficients = function.coefficients();
+    arma::Col<ResultType> result(coefficients.n_rows);
+    for (size_t dof = 0; dof < entities.size(); ++dof)
+        result(entities[dof]) = coefficients(dof);
+    return result;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType> gridFunctionFromOriginalOrdering(
+        const shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
+        const shared_ptr<const Space<BasisFunctionType> >& space,
+        const arma::Col<ResultType>& originalCoefficients)
+{
+    if (!space)
+        throw std::invalid_argument("gridFunctionFromOriginalOrdering(): "
+                                    "space must not be null");
+    if (originalCoefficients.n_rows != space->globalDofCount())
+        throw std::invalid_argument("gridFunctionFromOriginalOrdering(): "
+                                    "the length of originalCoefficients must "
+                                    "be equal to the number of DOFs of space");
+    const std::vector<int> entities = originalDofEntities(
+                *space, "gridFunctionFromOriginalOrdering()");
+    arma::Col<ResultType> coefficients(entities.size());
+    for (size_t dof = 0; dof < entities.size(); ++dof)
+        coefficients(dof) = originalCoefficients(entities[dof]);
+    return GridFunction<BasisFunctionType, ResultType>(
+                context, space, coefficients);
+}
+
+#define INSTANTIATE_FUNCTIONS(BASIS, RESULT) \
+    template \
+    arma::Col<RESULT> coefficientsInOriginalOrdering( \
+            const GridFunction<BASIS, RESULT>& function); \
+    template \
+    GridFunction<BASIS, RESULT> gridFunctionFromOriginalOrdering( \
+            const shared_ptr<const Context<BASIS, RESULT> >& context, \
+            const shared_ptr<const Space<BASIS> >& space, \
+            const arma::Col<RESULT>& originalCoefficients)
+
+FIBER_ITERATE_OVER_BASIS_AND_RESULT_TYPES(INSTANTIATE_FUNCTIONS);
+
+} // namespace Bempp
@@ -0,0 +1,78 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_grid_function_ordering_hpp
+#define bempp_grid_function_ordering_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../common/shared_ptr.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename BasisFunctionType, typename ResultType> class Context;
+template <typename BasisFunctionType, typename ResultType> class GridFunction;
+template <typename BasisFunctionType> class Space;
+/** \endcond */
+
+/** \brief Return the coefficients of a grid function in the original
+ *  numbering of its grid.
+ *
+ *  If the elements and vertices of a grid were renumbered on construction
+ *  (see GridParameters::elementOrdering), the coefficients of functions
+ *  defined on that grid are numbered differently from the arrays or the file
+ *  from which the grid was created. This function returns a vector whose
+ *  \c i'th element is the coefficient associated with the element (for
+ *  PiecewiseConstantScalarSpace) or vertex (for
+ *  PiecewiseLinearContinuousScalarSpace) that had index \c i in those
+ *  arrays or that file.
+ *
+ *  \note Currently only grid functions expanded in
+ *  PiecewiseConstantScalarSpace and PiecewiseLinearContinuousScalarSpace are
+ *  supported.
+ *
+ *  \see gridFunctionFromOriginalOrdering(), Grid::getOriginalElementIndices(),
+ *  Grid::getOriginalVertexIndices(). */
+template <typename BasisFunctionType, typename ResultType>
+arma::Col<ResultType> coefficientsInOriginalOrdering(
+        const GridFunction<BasisFunctionType, ResultType>& function);
+
+/** \brief Construct a grid function from coefficients given in the original
+ *  numbering of the grid.
+ *
+ *  This is the inverse of coefficientsInOriginalOrdering(): the \c i'th
+ *  element of \p originalCoefficients is taken to be the coefficient
+ *  associated with the element or vertex that had index \c i in the arrays
+ *  or the file from which the grid of \p space was created.
+ *
+ *  \note Currently only PiecewiseConstantScalarSpace and
+ *  PiecewiseLinearContinuousScalarSpace are supported. */
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType> gridFunctionFromOriginalOrdering(
+        const shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
+        const shared_ptr<const Space<BasisFunctionType> >& space,
+        const arma::Col<ResultType>& originalCoefficients);
+
+} // namespace Bempp
+
+#endif
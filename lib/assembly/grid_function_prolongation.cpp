@@ -0,0 +1,105 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid_function_prolongation.hpp"
+
+#include "dof_entity_helper.hpp"
+#include "grid_function.hpp"
+
+#include "../common/not_implemented_error.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+#include "../grid/grid.hpp"
+#include "../grid/grid_connectivity.hpp"
+#include "../grid/grid_refinement.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace Bempp
+{
+
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType> prolongGridFunction(
+        const GridRefinement& refinement,
+        const GridFunction<BasisFunctionType, ResultType>& coarseFunction,
+        const shared_ptr<const Space<BasisFunctionType> >& fineSpace)
+{
+    if (!fineSpace)
+        throw std::invalid_argument("prolongGridFunction(): "
+                                    "fineSpace must not be null");
+    const shared_ptr<const Space<BasisFunctionType> > coarseSpace =
+            coarseFunction.space();
+    if (coarseSpace->grid() != refinement.coarseGrid())
+        throw std::invalid_argument("prolongGridFunction(): coarseFunction "
+                                    "must be defined on the coarse grid of "
+                                    "refinement");
+    if (fineSpace->grid() != refinement.fineGrid())
+        throw std::invalid_argument("prolongGridFunction(): fineSpace "
+                                    "must be defined on the fine grid of "
+                                    "refinement");
+    typedef DofEntityHelper Helper;
+    const Helper::SpaceKind kind = Helper::spaceKind(*coarseSpace);
+    if (kind == Helper::OTHER)
+        throw NotImplementedError("prolongGridFunction(): "
+                                  "unsupported space type");
+    if (Helper::spaceKind(*fineSpace) != kind)
+        throw std::invalid_argument("prolongGridFunction(): the spaces of "
+                                    "coarseFunction and fineSpace must be of "
+                                    "the same type");
+
+    // Coefficients indexed by entities of the coarse grid
+    const std::vector<int> coarseEntities =
+            Helper::dofEntities(*coarseSpace, kind);
+    const arma::Col<ResultType>& coarseCoefficients =
+            coarseFunction.coefficients();
+    const GridConnectivity& coarseConnectivity =
+            refinement.coarseGrid()->leafConnectivity();
+    arma::Col<ResultType> coarseData(kind == Helper::PIECEWISE_CONSTANT ?
+                                     coarseConnectivity.elementCount() :
+                                     coarseConnectivity.vertexCount());
+    coarseData.fill(0.);
+    for (size_t dof = 0; dof < coarseEntities.size(); ++dof)
+        coarseData(coarseEntities[dof]) = coarseCoefficients(dof);
+
+    arma::Col<ResultType> fineData;
+    if (kind == Helper::PIECEWISE_CONSTANT)
+        refinement.prolongElementData(coarseData, fineData);
+    else
+        refinement.prolongVertexData(coarseData, fineData);
+
+    const std::vector<int> fineEntities = Helper::dofEntities(*fineSpace, kind);
+    arma::Col<ResultType> fineCoefficients(fineEntities.size());
+    for (size_t dof = 0; dof < fineEntities.size(); ++dof)
+        fineCoefficients(dof) = fineData(fineEntities[dof]);
+
+    return GridFunction<BasisFunctionType, ResultType>(
+                coarseFunction.context(), fineSpace, fineCoefficients);
+}
+
+#define INSTANTIATE_FUNCTION(BASIS, RESULT) \
+    template \
+    GridFunction<BASIS, RESULT> prolongGridFunction( \
+            const GridRefinement& refinement, \
+            const GridFunction<BASIS, RESULT>& coarseFunction, \
+            const shared_ptr<const Space<BASIS> >& fineSpace)
+
+FIBER_ITERATE_OVER_BASIS_AND_RESULT_TYPES(INSTANTIATE_FUNCTION);
+
+} // namespace Bempp
@@ -0,0 +1,68 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_grid_function_prolongation_hpp
+#define bempp_grid_function_prolongation_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/shared_ptr.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class GridRefinement;
+template <typename BasisFunctionType, typename ResultType> class GridFunction;
+template <typename BasisFunctionType> class Space;
+/** \endcond */
+
+/** \brief Transfer a grid function to a refined grid.
+ *
+ *  \param[in] refinement
+ *    Refinement relating the grid of \p coarseFunction to the grid of
+ *    \p fineSpace.
+ *  \param[in] coarseFunction
+ *    Grid function defined on <tt>refinement.coarseGrid()</tt>.
+ *  \param[in] fineSpace
+ *    Space defined on <tt>refinement.fineGrid()</tt>, of the same type as
+ *    the space of \p coarseFunction.
+ *
+ *  \returns A grid function expanded in \p fineSpace and equal to
+ *  \p coarseFunction. Its coefficients are obtained directly from those of
+ *  \p coarseFunction (see GridRefinement::prolongElementData() and
+ *  GridRefinement::prolongVertexData()), without evaluating any integrals.
+ *  It uses the context of \p coarseFunction.
+ *
+ *  The returned function can be used, for instance, as the initial guess of
+ *  an iterative solver on the fine grid.
+ *
+ *  \note Currently only grid functions expanded in
+ *  PiecewiseConstantScalarSpace and PiecewiseLinearContinuousScalarSpace are
+ *  supported. */
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType> prolongGridFunction(
+        const GridRefinement& refinement,
+        const GridFunction<BasisFunctionType, ResultType>& coarseFunction,
+        const shared_ptr<const Space<BasisFunctionType> >& fineSpace);
+
+} // namespace Bempp
+
+#endif
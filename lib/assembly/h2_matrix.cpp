@@ -0,0 +1,974 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h2_matrix.hpp"
+
+#include "h_matrix.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Subtrees of cluster bases associated with smaller clusters are processed
+// serially
+const size_t MINIMUM_PARALLEL_CLUSTER_SIZE = 2048;
+
+template <typename ValueType>
+arma::Mat<ValueType> zeroMatrix(size_t rowCount, size_t columnCount)
+{
+    arma::Mat<ValueType> result(rowCount, columnCount);
+    result.fill(0.);
+    return result;
+}
+
+// a * b, safe for matrices with zero dimensions
+template <typename ValueType>
+arma::Mat<ValueType> product(const arma::Mat<ValueType>& a,
+                             const arma::Mat<ValueType>& b)
+{
+    if (a.n_rows == 0 || a.n_cols == 0 || b.n_cols == 0)
+        return zeroMatrix<ValueType>(a.n_rows, b.n_cols);
+    return a * b;
+}
+
+// a^H * b, safe for matrices with zero dimensions
+template <typename ValueType>
+arma::Mat<ValueType> adjointProduct(const arma::Mat<ValueType>& a,
+                                    const arma::Mat<ValueType>& b)
+{
+    if (a.n_cols == 0 || a.n_rows == 0 || b.n_cols == 0)
+        return zeroMatrix<ValueType>(a.n_cols, b.n_cols);
+    const arma::Mat<ValueType> at = a.t();
+    return at * b;
+}
+
+// Rows first, ..., first + count - 1 of a
+template <typename ValueType>
+arma::Mat<ValueType> rowRange(const arma::Mat<ValueType>& a,
+                              size_t first, size_t count)
+{
+    if (count == 0 || a.n_cols == 0) {
+        arma::Mat<ValueType> result(count, a.n_cols);
+        return result;
+    }
+    return a.rows(first, first + count - 1);
+}
+
+// y += a * x (or a^H * x if adjoint is true)
+template <typename ValueType>
+void addProduct(const arma::Mat<ValueType>& a, bool adjoint,
+                const arma::Col<ValueType>& x, arma::Col<ValueType>& y)
+{
+    if (a.n_elem == 0)
+        return;
+    if (adjoint)
+        y += a.t() * x;
+    else
+        y += a * x;
+}
+
+template <typename CoordinateType>
+size_t truncatedRank(const arma::Col<CoordinateType>& s,
+                     double eps, size_t maximumRank)
+{
+    if (s.n_rows == 0 || s(0) <= 0.)
+        return 0;
+    size_t rank = 0;
+    while (rank < s.n_rows && rank < maximumRank && s(rank) > eps * s(0))
+        ++rank;
+    return rank;
+}
+
+// Truncated singular value decomposition w ~= x * diag(s) * y^H
+template <typename ValueType>
+void truncatedSvd(const arma::Mat<ValueType>& w,
+                  double eps, size_t maximumRank,
+                  arma::Mat<ValueType>& x,
+                  arma::Col<typename Fiber::ScalarTraits<ValueType>::RealType>& s,
+                  arma::Mat<ValueType>& y)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    size_t rank = 0;
+    arma::Mat<ValueType> xFull, yFull;
+    arma::Col<CoordinateType> sFull;
+    if (w.n_rows > 0 && w.n_cols > 0) {
+        if (!arma::svd_econ(xFull, sFull, yFull, w))
+            throw std::runtime_error("H2Matrix::H2Matrix(): SVD failed");
+        rank = truncatedRank(sFull, eps, maximumRank);
+    }
+    if (rank == 0) {
+        x.set_size(w.n_rows, 0);
+        s.set_size(0);
+        y.set_size(w.n_cols, 0);
+        return;
+    }
+    x = xFull.cols(0, rank - 1);
+    s = sFull.rows(0, rank - 1);
+    y = yFull.cols(0, rank - 1);
+}
+
+// a^H, safe for matrices with zero dimensions
+template <typename ValueType>
+arma::Mat<ValueType> adjoint(const arma::Mat<ValueType>& a)
+{
+    arma::Mat<ValueType> result(a.n_cols, a.n_rows);
+    for (size_t j = 0; j < a.n_cols; ++j)
+        for (size_t i = 0; i < a.n_rows; ++i)
+            result(j, i) = conj(a(i, j));
+    return result;
+}
+
+// diag(s) * (first count rows of y)^H
+template <typename ValueType>
+arma::Mat<ValueType> scaledAdjoint(
+        const arma::Col<typename Fiber::ScalarTraits<ValueType>::RealType>& s,
+        const arma::Mat<ValueType>& y, size_t count)
+{
+    arma::Mat<ValueType> result(s.n_rows, count);
+    for (size_t j = 0; j < count; ++j)
+        for (size_t i = 0; i < s.n_rows; ++i)
+            result(i, j) = ValueType(s(i)) * conj(y(j, i));
+    return result;
+}
+
+// Multiply the columns of a by the elements of s
+template <typename ValueType>
+void scaleColumns(
+        arma::Mat<ValueType>& a,
+        const arma::Col<typename Fiber::ScalarTraits<ValueType>::RealType>& s)
+{
+    for (size_t l = 0; l < s.n_rows; ++l)
+        a.col(l) *= ValueType(s(l));
+}
+
+// Builds the nested cluster bases from the weights of the low-rank blocks
+template <typename ValueType>
+class ClusterBasisBuilder
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef H2ClusterBasis<ValueType> ClusterBasis;
+    typedef std::vector<std::vector<const arma::Mat<ValueType>*> > WeightLists;
+
+    ClusterBasisBuilder(const WeightLists& weights,
+                        double eps, size_t maximumRank) :
+        m_weights(weights), m_eps(eps), m_maximumRank(maximumRank) {
+    }
+
+    // Construct the basis Q of the subtree rooted at basis, making it
+    // represent the columns of incoming and of the weights of the blocks
+    // in the block row of the cluster; return Q^H * incoming
+    void build(ClusterBasis& basis, const arma::Mat<ValueType>& incoming,
+               arma::Mat<ValueType>& projectedIncoming) const {
+        const size_t clusterSize = basis.cluster().size();
+        const std::vector<const arma::Mat<ValueType>*>& own =
+                m_weights[basis.index()];
+        size_t weightCount = incoming.n_cols;
+        for (size_t i = 0; i < own.size(); ++i)
+            weightCount += own[i]->n_cols;
+        arma::Mat<ValueType> w(clusterSize, weightCount);
+        size_t offset = 0;
+        if (incoming.n_cols > 0 && clusterSize > 0) {
+            w.cols(0, incoming.n_cols - 1) = incoming;
+            offset = incoming.n_cols;
+        }
+        for (size_t i = 0; i < own.size(); ++i)
+            if (own[i]->n_cols > 0 && clusterSize > 0) {
+                w.cols(offset, offset + own[i]->n_cols - 1) = *own[i];
+                offset += own[i]->n_cols;
+            }
+
+        arma::Mat<ValueType> x, y;
+        arma::Col<CoordinateType> s;
+        if (basis.isLeaf()) {
+            truncatedSvd(w, m_eps, m_maximumRank, x, s, y);
+            basis.setLeafBasis(x);
+            // Q^H * w = diag(s) * y^H
+            projectedIncoming = scaledAdjoint(s, y, incoming.n_cols);
+            return;
+        }
+
+        // Pass a compressed version of the weights to the sons:
+        // w ~= (x * diag(s)) * y^H
+        truncatedSvd(w, m_eps, std::numeric_limits<size_t>::max(), x, s, y);
+        arma::Mat<ValueType> reduced = x;
+        scaleColumns(reduced, s);
+
+        ClusterBasis& son0 = basis.son(0);
+        ClusterBasis& son1 = basis.son(1);
+        const size_t size0 = son0.cluster().size();
+        const size_t size1 = son1.cluster().size();
+        const arma::Mat<ValueType> reduced0 = rowRange(reduced, 0, size0);
+        const arma::Mat<ValueType> reduced1 = rowRange(reduced, size0, size1);
+        arma::Mat<ValueType> z0, z1;
+        if (clusterSize >= MINIMUM_PARALLEL_CLUSTER_SIZE)
+            tbb::parallel_invoke(
+                    boost::bind(&ClusterBasisBuilder::build, this,
+                                boost::ref(son0), boost::cref(reduced0),
+                                boost::ref(z0)),
+                    boost::bind(&ClusterBasisBuilder::build, this,
+                                boost::ref(son1), boost::cref(reduced1),
+                                boost::ref(z1)));
+        else {
+            build(son0, reduced0, z0);
+            build(son1, reduced1, z1);
+        }
+
+        // Sons' coefficients of the compressed weights
+        const size_t rank0 = son0.rank(), rank1 = son1.rank();
+        arma::Mat<ValueType> z(rank0 + rank1, reduced.n_cols);
+        if (rank0 > 0 && z.n_cols > 0)
+            z.rows(0, rank0 - 1) = z0;
+        if (rank1 > 0 && z.n_cols > 0)
+            z.rows(rank0, rank0 + rank1 - 1) = z1;
+
+        arma::Mat<ValueType> a, b;
+        arma::Col<CoordinateType> sigma;
+        truncatedSvd(z, m_eps, m_maximumRank, a, sigma, b);
+        basis.setTransfers(rowRange(a, 0, rank0), rowRange(a, rank0, rank1));
+        // Q^H * incoming ~= diag(sigma) * b^H * (first rows of y)^H
+        projectedIncoming = product(
+                    scaledAdjoint(sigma, b, b.n_rows),
+                    adjoint(rowRange(y, 0, incoming.n_cols)));
+    }
+
+private:
+    const WeightLists& m_weights;
+    double m_eps;
+    size_t m_maximumRank;
+};
+
+// Q^H * x, where Q is the basis of the subtree rooted at basis
+template <typename ValueType>
+arma::Mat<ValueType> projectOntoBasis(const H2ClusterBasis<ValueType>& basis,
+                                      const arma::Mat<ValueType>& x)
+{
+    if (basis.isLeaf())
+        return adjointProduct(basis.leafBasis(), x);
+    const size_t size0 = basis.son(0).cluster().size();
+    const size_t size1 = basis.son(1).cluster().size();
+    const arma::Mat<ValueType> p0 =
+            projectOntoBasis(basis.son(0), rowRange(x, 0, size0));
+    const arma::Mat<ValueType> p1 =
+            projectOntoBasis(basis.son(1), rowRange(x, size0, size1));
+    arma::Mat<ValueType> result = adjointProduct(basis.transfer(0), p0);
+    result += adjointProduct(basis.transfer(1), p1);
+    return result;
+}
+
+// Weights determining the row and column bases of low-rank blocks
+template <typename ValueType>
+class BlockWeightLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    BlockWeightLoopBody(const std::vector<const Block*>& blocks,
+                        std::vector<arma::Mat<ValueType> >& rowWeights,
+                        std::vector<arma::Mat<ValueType> >& columnWeights) :
+        m_blocks(blocks), m_rowWeights(rowWeights),
+        m_columnWeights(columnWeights) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            const Block& block = *m_blocks[i];
+            const arma::Mat<ValueType>& u = block.lowRankU();
+            const arma::Mat<ValueType>& v = block.lowRankV();
+            arma::Mat<ValueType> x, y;
+            arma::Col<CoordinateType> s;
+            // u * v = (u * x * diag(s)) * y^H
+            truncatedSvd(v, 0., std::numeric_limits<size_t>::max(), x, s, y);
+            m_rowWeights[i] = product(u, x);
+            scaleColumns(m_rowWeights[i], s);
+            // (u * v)^H = (v^H * y * diag(s)) * x^H
+            truncatedSvd(u, 0., std::numeric_limits<size_t>::max(), x, s, y);
+            m_columnWeights[i] = adjointProduct(v, y);
+            scaleColumns(m_columnWeights[i], s);
+        }
+    }
+
+private:
+    const std::vector<const Block*>& m_blocks;
+    std::vector<arma::Mat<ValueType> >& m_rowWeights;
+    std::vector<arma::Mat<ValueType> >& m_columnWeights;
+};
+
+// Coupling matrices of the far-field blocks
+template <typename ValueType>
+class CouplingLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+    typedef H2ClusterBasis<ValueType> ClusterBasis;
+
+    CouplingLoopBody(const std::vector<const Block*>& sources,
+                     const std::vector<const ClusterBasis*>& rowBases,
+                     const std::vector<const ClusterBasis*>& columnBases,
+                     std::vector<arma::Mat<ValueType> >& couplings) :
+        m_sources(sources), m_rowBases(rowBases), m_columnBases(columnBases),
+        m_couplings(couplings) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            const Block& block = *m_sources[i];
+            // Q^H * u * v * P = (Q^H * u) * (P^H * v^H)^H
+            const arma::Mat<ValueType> left =
+                    projectOntoBasis(*m_rowBases[i], block.lowRankU());
+            const arma::Mat<ValueType> right =
+                    projectOntoBasis(*m_columnBases[i],
+                                     adjoint(block.lowRankV()));
+            m_couplings[i] = product(left, adjoint(right));
+        }
+    }
+
+private:
+    const std::vector<const Block*>& m_sources;
+    const std::vector<const ClusterBasis*>& m_rowBases;
+    const std::vector<const ClusterBasis*>& m_columnBases;
+    std::vector<arma::Mat<ValueType> >& m_couplings;
+};
+
+// Compute the coefficients xHat[t] = Q_t^H * x|t for all clusters t of the
+// subtree rooted at basis
+template <typename ValueType>
+void forwardTransform(const H2ClusterBasis<ValueType>& basis,
+                      const arma::Col<ValueType>& x,
+                      std::vector<arma::Col<ValueType> >& xHat)
+{
+    arma::Col<ValueType>& result = xHat[basis.index()];
+    result.set_size(basis.rank());
+    result.fill(0.);
+    const size_t begin = basis.cluster().begin();
+    const size_t size = basis.cluster().size();
+    if (basis.isLeaf()) {
+        if (size > 0)
+            addProduct(basis.leafBasis(), true /* adjoint */,
+                       arma::Col<ValueType>(x.rows(begin, begin + size - 1)),
+                       result);
+        return;
+    }
+    if (size >= MINIMUM_PARALLEL_CLUSTER_SIZE)
+        tbb::parallel_invoke(
+                boost::bind(forwardTransform<ValueType>,
+                            boost::cref(basis.son(0)), boost::cref(x),
+                            boost::ref(xHat)),
+                boost::bind(forwardTransform<ValueType>,
+                            boost::cref(basis.son(1)), boost::cref(x),
+                            boost::ref(xHat)));
+    else {
+        forwardTransform(basis.son(0), x, xHat);
+        forwardTransform(basis.son(1), x, xHat);
+    }
+    for (int i = 0; i < 2; ++i)
+        addProduct(basis.transfer(i), true /* adjoint */,
+                   xHat[basis.son(i).index()], result);
+}
+
+// Add Q_t * (yHat[t] + inherited) to y|t for the root t of the subtree and
+// propagate the coefficients to its descendants
+template <typename ValueType>
+void backwardTransform(const H2ClusterBasis<ValueType>& basis,
+                       const std::vector<arma::Col<ValueType> >& yHat,
+                       const arma::Col<ValueType>& inherited,
+                       arma::Col<ValueType>& y)
+{
+    arma::Col<ValueType> coefficients = yHat[basis.index()];
+    if (inherited.n_rows > 0)
+        coefficients += inherited;
+    const size_t begin = basis.cluster().begin();
+    const size_t size = basis.cluster().size();
+    if (basis.isLeaf()) {
+        if (size > 0 && basis.rank() > 0) {
+            arma::Col<ValueType> contribution(size);
+            contribution.fill(0.);
+            addProduct(basis.leafBasis(), false /* adjoint */,
+                       coefficients, contribution);
+            y.rows(begin, begin + size - 1) += contribution;
+        }
+        return;
+    }
+    arma::Col<ValueType> sonCoefficients[2];
+    for (int i = 0; i < 2; ++i) {
+        sonCoefficients[i].set_size(basis.son(i).rank());
+        sonCoefficients[i].fill(0.);
+        addProduct(basis.transfer(i), false /* adjoint */,
+                   coefficients, sonCoefficients[i]);
+    }
+    if (size >= MINIMUM_PARALLEL_CLUSTER_SIZE)
+        tbb::parallel_invoke(
+                boost::bind(backwardTransform<ValueType>,
+                            boost::cref(basis.son(0)), boost::cref(yHat),
+                            boost::cref(sonCoefficients[0]), boost::ref(y)),
+                boost::bind(backwardTransform<ValueType>,
+                            boost::cref(basis.son(1)), boost::cref(yHat),
+                            boost::cref(sonCoefficients[1]), boost::ref(y)));
+    else {
+        backwardTransform(basis.son(0), yHat, sonCoefficients[0], y);
+        backwardTransform(basis.son(1), yHat, sonCoefficients[1], y);
+    }
+}
+
+// Apply the coupling matrices of the far-field blocks in a range of block
+// rows (or block columns, if adjoint is true)
+template <typename ValueType, typename FarFieldBlock>
+class FarFieldLoopBody
+{
+public:
+    typedef H2ClusterBasis<ValueType> ClusterBasis;
+
+    FarFieldLoopBody(const std::vector<FarFieldBlock>& blocks,
+                     const std::vector<std::vector<size_t> >& blockLists,
+                     const std::vector<const ClusterBasis*>& outNodes,
+                     bool adjoint,
+                     const std::vector<arma::Col<ValueType> >& xHat,
+                     std::vector<arma::Col<ValueType> >& yHat) :
+        m_blocks(blocks), m_blockLists(blockLists), m_outNodes(outNodes),
+        m_adjoint(adjoint), m_xHat(xHat), m_yHat(yHat) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t t = r.begin(); t != r.end(); ++t) {
+            arma::Col<ValueType>& result = m_yHat[t];
+            result.set_size(m_outNodes[t]->rank());
+            result.fill(0.);
+            const std::vector<size_t>& list = m_blockLists[t];
+            for (size_t i = 0; i < list.size(); ++i) {
+                const FarFieldBlock& block = m_blocks[list[i]];
+                const size_t inIndex = m_adjoint ?
+                            block.rowBasis->index() : block.columnBasis->index();
+                addProduct(block.coupling, m_adjoint, m_xHat[inIndex], result);
+            }
+        }
+    }
+
+private:
+    const std::vector<FarFieldBlock>& m_blocks;
+    const std::vector<std::vector<size_t> >& m_blockLists;
+    const std::vector<const ClusterBasis*>& m_outNodes;
+    bool m_adjoint;
+    const std::vector<arma::Col<ValueType> >& m_xHat;
+    std::vector<arma::Col<ValueType> >& m_yHat;
+};
+
+// Compute the contributions of a range of near-field blocks to A * x (or
+// A^H * x, if adjoint is true)
+template <typename ValueType, typename NearFieldBlock>
+class NearFieldLoopBody
+{
+public:
+    NearFieldLoopBody(const std::vector<NearFieldBlock>& blocks, bool adjoint,
+                      const arma::Col<ValueType>& x, size_t resultSize) :
+        m_blocks(blocks), m_adjoint(adjoint), m_x(x), m_result(resultSize) {
+        m_result.fill(0.);
+    }
+
+    NearFieldLoopBody(NearFieldLoopBody& other, tbb::split) :
+        m_blocks(other.m_blocks), m_adjoint(other.m_adjoint), m_x(other.m_x),
+        m_result(other.m_result.n_rows) {
+        m_result.fill(0.);
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            const NearFieldBlock& block = m_blocks[i];
+            size_t inBegin = block.columnBegin, inCount = block.columnCount;
+            size_t outBegin = block.rowBegin, outCount = block.rowCount;
+            if (m_adjoint) {
+                std::swap(inBegin, outBegin);
+                std::swap(inCount, outCount);
+            }
+            if (inCount == 0 || outCount == 0)
+                continue;
+            const arma::Col<ValueType> in =
+                    m_x.rows(inBegin, inBegin + inCount - 1);
+            arma::Col<ValueType> out(outCount);
+            out.fill(0.);
+            addProduct(block.matrix, m_adjoint, in, out);
+            m_result.rows(outBegin, outBegin + outCount - 1) += out;
+        }
+    }
+
+    void join(const NearFieldLoopBody& other) {
+        m_result += other.m_result;
+    }
+
+    const arma::Col<ValueType>& result() const { return m_result; }
+
+private:
+    const std::vector<NearFieldBlock>& m_blocks;
+    bool m_adjoint;
+    const arma::Col<ValueType>& m_x;
+    arma::Col<ValueType> m_result;
+};
+
+template <typename ValueType>
+void conjugateInPlace(arma::Col<ValueType>& x)
+{
+    for (size_t i = 0; i < x.n_rows; ++i)
+        x(i) = conj(x(i));
+}
+
+} // namespace
+
+template <typename ValueType>
+H2ClusterBasis<ValueType>::H2ClusterBasis(const Cluster& cluster,
+                                          size_t& index) :
+    m_cluster(&cluster), m_index(index++), m_rank(0)
+{
+    if (!cluster.isLeaf())
+        for (int i = 0; i < 2; ++i)
+            m_sons[i].reset(new H2ClusterBasis(cluster.son(i), index));
+    m_leafBasis.set_size(cluster.size(), 0);
+}
+
+template <typename ValueType>
+void H2ClusterBasis<ValueType>::setLeafBasis(const arma::Mat<ValueType>& basis)
+{
+    if (!isLeaf() || basis.n_rows != m_cluster->size())
+        throw std::invalid_argument("H2ClusterBasis::setLeafBasis(): "
+                                    "incorrect matrix size or non-leaf node");
+    m_leafBasis = basis;
+    m_rank = basis.n_cols;
+}
+
+template <typename ValueType>
+void H2ClusterBasis<ValueType>::setTransfers(
+        const arma::Mat<ValueType>& transfer0,
+        const arma::Mat<ValueType>& transfer1)
+{
+    if (isLeaf() || transfer0.n_rows != m_sons[0]->rank() ||
+            transfer1.n_rows != m_sons[1]->rank() ||
+            transfer0.n_cols != transfer1.n_cols)
+        throw std::invalid_argument("H2ClusterBasis::setTransfers(): "
+                                    "incorrect matrix sizes or leaf node");
+    m_transfer[0] = transfer0;
+    m_transfer[1] = transfer1;
+    m_rank = transfer0.n_cols;
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> H2ClusterBasis<ValueType>::expand() const
+{
+    if (isLeaf())
+        return m_leafBasis;
+    arma::Mat<ValueType> result(m_cluster->size(), m_rank);
+    size_t offset = 0;
+    for (int i = 0; i < 2; ++i) {
+        const size_t sonSize = m_sons[i]->cluster().size();
+        if (sonSize > 0 && m_rank > 0)
+            result.rows(offset, offset + sonSize - 1) =
+                    product(m_sons[i]->expand(), m_transfer[i]);
+        offset += sonSize;
+    }
+    return result;
+}
+
+template <typename ValueType>
+arma::Row<ValueType> H2ClusterBasis<ValueType>::basisRow(size_t dof) const
+{
+    if (dof < m_cluster->begin() || dof >= m_cluster->end())
+        throw std::invalid_argument("H2ClusterBasis::basisRow(): "
+                                    "DOF does not belong to the cluster");
+    arma::Row<ValueType> result(m_rank);
+    result.fill(0.);
+    if (m_rank == 0)
+        return result;
+    if (isLeaf()) {
+        const size_t localDof = dof - m_cluster->begin();
+        for (size_t l = 0; l < m_rank; ++l)
+            result(l) = m_leafBasis(localDof, l);
+        return result;
+    }
+    const int i = dof < m_sons[0]->cluster().end() ? 0 : 1;
+    const arma::Row<ValueType> sonRow = m_sons[i]->basisRow(dof);
+    for (size_t l = 0; l < m_rank; ++l)
+        for (size_t k = 0; k < sonRow.n_cols; ++k)
+            result(l) += sonRow(k) * m_transfer[i](k, l);
+    return result;
+}
+
+template <typename ValueType>
+size_t H2ClusterBasis<ValueType>::storedEntryCount() const
+{
+    if (isLeaf())
+        return m_leafBasis.n_elem;
+    return m_transfer[0].n_elem + m_transfer[1].n_elem +
+            m_sons[0]->storedEntryCount() + m_sons[1]->storedEntryCount();
+}
+
+template <typename ValueType>
+size_t H2ClusterBasis<ValueType>::maximumRank() const
+{
+    if (isLeaf())
+        return m_rank;
+    return std::max(m_rank, std::max(m_sons[0]->maximumRank(),
+                                     m_sons[1]->maximumRank()));
+}
+
+template <typename ValueType>
+void H2ClusterBasis<ValueType>::collectNodes(
+        std::vector<const H2ClusterBasis*>& nodes) const
+{
+    nodes.push_back(this);
+    if (!isLeaf())
+        for (int i = 0; i < 2; ++i)
+            static_cast<const H2ClusterBasis&>(*m_sons[i]).collectNodes(nodes);
+}
+
+template <typename ValueType>
+void H2ClusterBasis<ValueType>::collectNodes(std::vector<H2ClusterBasis*>& nodes)
+{
+    nodes.push_back(this);
+    if (!isLeaf())
+        for (int i = 0; i < 2; ++i)
+            m_sons[i]->collectNodes(nodes);
+}
+
+template <typename ValueType>
+H2Matrix<ValueType>::H2Matrix(const HMatrix<ValueType>& hMatrix,
+                              double eps, size_t maximumRank) :
+    m_rowCount(hMatrix.rowCount()), m_columnCount(hMatrix.columnCount())
+{
+    typedef HMatrixBlock<ValueType> Block;
+    typedef std::map<const Cluster*, const ClusterBasis*> BasisMap;
+
+    size_t index = 0;
+    m_rowBasis.reset(new ClusterBasis(*hMatrix.rowClusterTree(), index));
+    index = 0;
+    m_columnBasis.reset(new ClusterBasis(*hMatrix.columnClusterTree(), index));
+    m_rowBasis->collectNodes(m_rowBasisNodes);
+    m_columnBasis->collectNodes(m_columnBasisNodes);
+    BasisMap rowBasisMap, columnBasisMap;
+    for (size_t i = 0; i < m_rowBasisNodes.size(); ++i)
+        rowBasisMap[&m_rowBasisNodes[i]->cluster()] = m_rowBasisNodes[i];
+    for (size_t i = 0; i < m_columnBasisNodes.size(); ++i)
+        columnBasisMap[&m_columnBasisNodes[i]->cluster()] = m_columnBasisNodes[i];
+
+    // Set up the block tree, the near field and the list of far-field blocks
+    std::vector<const Block*> sources;
+    appendBlockTreeNode(hMatrix.root(), sources);
+    const size_t farFieldCount = sources.size();
+    std::vector<const ClusterBasis*> farFieldRowBases(farFieldCount);
+    std::vector<const ClusterBasis*> farFieldColumnBases(farFieldCount);
+    for (size_t i = 0; i < farFieldCount; ++i) {
+        farFieldRowBases[i] = rowBasisMap[&sources[i]->rowCluster()];
+        farFieldColumnBases[i] = columnBasisMap[&sources[i]->columnCluster()];
+    }
+
+    // Construct the cluster bases
+    {
+        std::vector<arma::Mat<ValueType> > rowWeights(farFieldCount);
+        std::vector<arma::Mat<ValueType> > columnWeights(farFieldCount);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, farFieldCount),
+                          BlockWeightLoopBody<ValueType>(
+                              sources, rowWeights, columnWeights));
+        typedef ClusterBasisBuilder<ValueType> Builder;
+        typename Builder::WeightLists rowWeightLists(m_rowBasisNodes.size());
+        typename Builder::WeightLists columnWeightLists(
+                    m_columnBasisNodes.size());
+        for (size_t i = 0; i < farFieldCount; ++i) {
+            rowWeightLists[farFieldRowBases[i]->index()].push_back(
+                        &rowWeights[i]);
+            columnWeightLists[farFieldColumnBases[i]->index()].push_back(
+                        &columnWeights[i]);
+        }
+        const arma::Mat<ValueType> noRowWeights(m_rowCount, 0);
+        const arma::Mat<ValueType> noColumnWeights(m_columnCount, 0);
+        arma::Mat<ValueType> unused;
+        tbb::parallel_invoke(
+                boost::bind(&Builder::build,
+                            Builder(rowWeightLists, eps, maximumRank),
+                            boost::ref(*m_rowBasis), boost::cref(noRowWeights),
+                            boost::ref(unused)),
+                boost::bind(&Builder::build,
+                            Builder(columnWeightLists, eps, maximumRank),
+                            boost::ref(*m_columnBasis),
+                            boost::cref(noColumnWeights),
+                            boost::ref(unused)));
+    }
+
+    // Compute the coupling matrices
+    std::vector<arma::Mat<ValueType> > couplings(farFieldCount);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, farFieldCount),
+                      CouplingLoopBody<ValueType>(
+                          sources, farFieldRowBases, farFieldColumnBases,
+                          couplings));
+    m_farField.resize(farFieldCount);
+    m_farFieldByRow.resize(m_rowBasisNodes.size());
+    m_farFieldByColumn.resize(m_columnBasisNodes.size());
+    for (size_t i = 0; i < farFieldCount; ++i) {
+        m_farField[i].rowBasis = farFieldRowBases[i];
+        m_farField[i].columnBasis = farFieldColumnBases[i];
+        m_farField[i].coupling = couplings[i];
+        m_farFieldByRow[farFieldRowBases[i]->index()].push_back(i);
+        m_farFieldByColumn[farFieldColumnBases[i]->index()].push_back(i);
+    }
+}
+
+template <typename ValueType>
+size_t H2Matrix<ValueType>::appendBlockTreeNode(
+        const HMatrixBlock<ValueType>& block,
+        std::vector<const HMatrixBlock<ValueType>*>& farFieldSources)
+{
+    typedef HMatrixBlock<ValueType> Block;
+
+    BlockTreeNode node;
+    node.rowBegin = block.rowBegin();
+    node.rowCount = block.rowCount();
+    node.columnBegin = block.columnBegin();
+    node.columnCount = block.columnCount();
+    node.block = 0;
+    switch (block.type()) {
+    case Block::SUBDIVIDED:
+        node.type = BlockTreeNode::SUBDIVIDED;
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                node.sons[i + 2 * j] =
+                        appendBlockTreeNode(block.son(i, j), farFieldSources);
+        break;
+    case Block::DENSE: {
+        node.type = BlockTreeNode::NEAR_FIELD;
+        node.block = m_nearField.size();
+        NearFieldBlock nearFieldBlock;
+        nearFieldBlock.rowBegin = node.rowBegin;
+        nearFieldBlock.rowCount = node.rowCount;
+        nearFieldBlock.columnBegin = node.columnBegin;
+        nearFieldBlock.columnCount = node.columnCount;
+        nearFieldBlock.matrix = block.dense();
+        m_nearField.push_back(nearFieldBlock);
+        break;
+    }
+    case Block::LOW_RANK:
+        node.type = BlockTreeNode::FAR_FIELD;
+        node.block = farFieldSources.size();
+        farFieldSources.push_back(&block);
+        break;
+    }
+    m_blockTree.push_back(node);
+    return m_blockTree.size() - 1;
+}
+
+template <typename ValueType>
+size_t H2Matrix<ValueType>::rowCount() const
+{
+    return m_rowCount;
+}
+
+template <typename ValueType>
+size_t H2Matrix<ValueType>::columnCount() const
+{
+    return m_columnCount;
+}
+
+template <typename ValueType>
+void H2Matrix<ValueType>::applyNoTranspose(const arma::Col<ValueType>& x,
+                                           arma::Col<ValueType>& y) const
+{
+    std::vector<arma::Col<ValueType> > xHat(m_columnBasisNodes.size());
+    forwardTransform(*m_columnBasis, x, xHat);
+
+    std::vector<arma::Col<ValueType> > yHat(m_rowBasisNodes.size());
+    typedef FarFieldLoopBody<ValueType, FarFieldBlock> FarFieldBody;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rowBasisNodes.size()),
+                      FarFieldBody(m_farField, m_farFieldByRow, m_rowBasisNodes,
+                                   false /* adjoint */, xHat, yHat));
+
+    typedef NearFieldLoopBody<ValueType, NearFieldBlock> NearFieldBody;
+    NearFieldBody nearFieldBody(m_nearField, false /* adjoint */, x, m_rowCount);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, m_nearField.size()),
+                         nearFieldBody);
+    y = nearFieldBody.result();
+    backwardTransform(*m_rowBasis, yHat, arma::Col<ValueType>(), y);
+}
+
+template <typename ValueType>
+void H2Matrix<ValueType>::applyConjugateTranspose(
+        const arma::Col<ValueType>& x, arma::Col<ValueType>& y) const
+{
+    std::vector<arma::Col<ValueType> > xHat(m_rowBasisNodes.size());
+    forwardTransform(*m_rowBasis, x, xHat);
+
+    std::vector<arma::Col<ValueType> > yHat(m_columnBasisNodes.size());
+    typedef FarFieldLoopBody<ValueType, FarFieldBlock> FarFieldBody;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_columnBasisNodes.size()),
+                      FarFieldBody(m_farField, m_farFieldByColumn,
+                                   m_columnBasisNodes,
+                                   true /* adjoint */, xHat, yHat));
+
+    typedef NearFieldLoopBody<ValueType, NearFieldBlock> NearFieldBody;
+    NearFieldBody nearFieldBody(m_nearField, true /* adjoint */, x,
+                                m_columnCount);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, m_nearField.size()),
+                         nearFieldBody);
+    y = nearFieldBody.result();
+    backwardTransform(*m_columnBasis, yHat, arma::Col<ValueType>(), y);
+}
+
+template <typename ValueType>
+void H2Matrix<ValueType>::apply(TranspositionMode trans,
+                                const arma::Col<ValueType>& x,
+                                arma::Col<ValueType>& y,
+                                ValueType alpha, ValueType beta) const
+{
+    const bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    const bool conjugate = (trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE);
+    if (trans != NO_TRANSPOSE && !transpose && !conjugate)
+        throw std::invalid_argument("H2Matrix::apply(): "
+                                    "invalid transposition mode");
+    const size_t inSize = transpose ? m_rowCount : m_columnCount;
+    const size_t outSize = transpose ? m_columnCount : m_rowCount;
+    if (x.n_rows != inSize)
+        throw std::invalid_argument("H2Matrix::apply(): "
+                                    "vector x has incorrect length");
+    if (beta == static_cast<ValueType>(0.)) {
+        y.set_size(outSize);
+        y.fill(0.);
+    } else {
+        if (y.n_rows != outSize)
+            throw std::invalid_argument("H2Matrix::apply(): "
+                                        "vector y has incorrect length");
+        y *= beta;
+    }
+
+    // A^T * x = conj(A^H * conj(x)) and conj(A) * x = conj(A * conj(x))
+    const bool conjugateInput = (transpose != conjugate);
+    arma::Col<ValueType> conjugatedX;
+    if (conjugateInput) {
+        conjugatedX = x;
+        conjugateInPlace(conjugatedX);
+    }
+    arma::Col<ValueType> result;
+    if (transpose)
+        applyConjugateTranspose(conjugateInput ? conjugatedX : x, result);
+    else
+        applyNoTranspose(conjugateInput ? conjugatedX : x, result);
+    if (conjugateInput)
+        conjugateInPlace(result);
+    y += alpha * result;
+}
+
+template <typename ValueType>
+ValueType H2Matrix<ValueType>::entry(size_t row, size_t col) const
+{
+    if (row >= m_rowCount || col >= m_columnCount)
+        throw std::invalid_argument("H2Matrix::entry(): "
+                                    "index out of range");
+    const BlockTreeNode* node = &m_blockTree.back(); // the root
+    while (node->type == BlockTreeNode::SUBDIVIDED) {
+        const BlockTreeNode* next = 0;
+        for (int k = 0; k < 4 && !next; ++k) {
+            const BlockTreeNode& son = m_blockTree[node->sons[k]];
+            if (row >= son.rowBegin && row < son.rowBegin + son.rowCount &&
+                    col >= son.columnBegin &&
+                    col < son.columnBegin + son.columnCount)
+                next = &son;
+        }
+        if (!next)
+            throw std::logic_error("H2Matrix::entry(): "
+                                   "inconsistent block tree");
+        node = next;
+    }
+    if (node->type == BlockTreeNode::NEAR_FIELD)
+        return m_nearField[node->block].matrix(row - node->rowBegin,
+                                               col - node->columnBegin);
+    const FarFieldBlock& block = m_farField[node->block];
+    const arma::Row<ValueType> q = block.rowBasis->basisRow(row);
+    const arma::Row<ValueType> p = block.columnBasis->basisRow(col);
+    ValueType result = 0.;
+    for (size_t j = 0; j < p.n_cols; ++j) {
+        ValueType sum = 0.;
+        for (size_t i = 0; i < q.n_cols; ++i)
+            sum += q(i) * block.coupling(i, j);
+        result += sum * conj(p(j));
+    }
+    return result;
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> H2Matrix<ValueType>::asMatrix() const
+{
+    arma::Mat<ValueType> result(m_rowCount, m_columnCount);
+    result.fill(0.);
+    for (size_t i = 0; i < m_nearField.size(); ++i) {
+        const NearFieldBlock& block = m_nearField[i];
+        if (block.rowCount > 0 && block.columnCount > 0)
+            result.submat(block.rowBegin, block.columnBegin,
+                          block.rowBegin + block.rowCount - 1,
+                          block.columnBegin + block.columnCount - 1) =
+                    block.matrix;
+    }
+    for (size_t i = 0; i < m_farField.size(); ++i) {
+        const FarFieldBlock& block = m_farField[i];
+        const size_t rowBegin = block.rowBasis->cluster().begin();
+        const size_t rowCount = block.rowBasis->cluster().size();
+        const size_t columnBegin = block.columnBasis->cluster().begin();
+        const size_t columnCount = block.columnBasis->cluster().size();
+        if (rowCount > 0 && columnCount > 0)
+            result.submat(rowBegin, columnBegin,
+                          rowBegin + rowCount - 1,
+                          columnBegin + columnCount - 1) =
+                    product(product(block.rowBasis->expand(), block.coupling),
+                            adjoint(block.columnBasis->expand()));
+    }
+    return result;
+}
+
+template <typename ValueType>
+size_t H2Matrix<ValueType>::storedEntryCount() const
+{
+    size_t result = m_rowBasis->storedEntryCount() +
+            m_columnBasis->storedEntryCount();
+    for (size_t i = 0; i < m_farField.size(); ++i)
+        result += m_farField[i].coupling.n_elem;
+    for (size_t i = 0; i < m_nearField.size(); ++i)
+        result += m_nearField[i].matrix.n_elem;
+    return result;
+}
+
+template <typename ValueType>
+size_t H2Matrix<ValueType>::maximumRank() const
+{
+    return std::max(m_rowBasis->maximumRank(), m_columnBasis->maximumRank());
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(H2ClusterBasis);
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(H2Matrix);
+
+} // namespace Bempp
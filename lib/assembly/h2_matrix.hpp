@@ -0,0 +1,236 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h2_matrix_hpp
+#define bempp_h2_matrix_hpp
+
+#include "../common/common.hpp"
+
+#include "h_matrix_cluster.hpp"
+#include "transposition_mode.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/scalar_traits.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class HMatrix;
+template <typename ValueType> class HMatrixBlock;
+/** \endcond */
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Node of a nested cluster basis of a H2Matrix.
+ *
+ *  Each node is associated with a cluster \c t and represents an orthonormal
+ *  basis \c Q_t of rank() vectors of length <tt>t.size()</tt>. Leaf nodes
+ *  store \c Q_t explicitly; the basis of a non-leaf node is defined through
+ *  the bases of its sons by
+ *
+ *  <tt>Q_t = [Q_t0 * E_t0; Q_t1 * E_t1]</tt>,
+ *
+ *  where the transfer matrices \c E_ti have rank() columns. The tree of
+ *  bases mirrors the cluster tree. */
+template <typename ValueType>
+class H2ClusterBasis : private boost::noncopyable
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+
+    /** \brief Constructor.
+     *
+     *  Construct an empty basis tree mirroring the cluster tree rooted at
+     *  \p cluster. Nodes are numbered in depth-first order starting from
+     *  \p index; on exit, \p index is the number following that of the last
+     *  node of the tree. */
+    H2ClusterBasis(const Cluster& cluster, size_t& index);
+
+    const Cluster& cluster() const { return *m_cluster; }
+    /** \brief Position of this node in the depth-first ordering. */
+    size_t index() const { return m_index; }
+
+    bool isLeaf() const { return !m_sons[0]; }
+    H2ClusterBasis& son(int i) { return *m_sons[i]; }
+    const H2ClusterBasis& son(int i) const { return *m_sons[i]; }
+
+    /** \brief Number of basis vectors. */
+    size_t rank() const { return m_rank; }
+
+    /** \brief Basis of a leaf node. */
+    const arma::Mat<ValueType>& leafBasis() const { return m_leafBasis; }
+    /** \brief Transfer matrix from this node to its son number \p i. */
+    const arma::Mat<ValueType>& transfer(int i) const { return m_transfer[i]; }
+
+    /** \brief Store the basis of a leaf node. */
+    void setLeafBasis(const arma::Mat<ValueType>& basis);
+    /** \brief Store the transfer matrices of a non-leaf node. */
+    void setTransfers(const arma::Mat<ValueType>& transfer0,
+                      const arma::Mat<ValueType>& transfer1);
+
+    /** \brief Return the matrix \c Q_t in the explicit format. */
+    arma::Mat<ValueType> expand() const;
+
+    /** \brief Row of \c Q_t corresponding to the DOF \p dof (in the permuted
+     *  ordering; it must belong to the cluster). */
+    arma::Row<ValueType> basisRow(size_t dof) const;
+
+    /** \brief Number of matrix entries stored in this subtree. */
+    size_t storedEntryCount() const;
+
+    /** \brief Maximum rank of the bases in this subtree. */
+    size_t maximumRank() const;
+
+    /** \brief Append pointers to the nodes of this subtree to \p nodes, in
+     *  depth-first order. */
+    void collectNodes(std::vector<const H2ClusterBasis*>& nodes) const;
+    /** \overload */
+    void collectNodes(std::vector<H2ClusterBasis*>& nodes);
+
+private:
+    /** \cond PRIVATE */
+    const Cluster* m_cluster;
+    size_t m_index;
+    size_t m_rank;
+    boost::scoped_ptr<H2ClusterBasis> m_sons[2];
+    arma::Mat<ValueType> m_leafBasis;
+    arma::Mat<ValueType> m_transfer[2];
+    /** \endcond */
+};
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief H2-matrix, i.e. hierarchical matrix with nested cluster bases.
+ *
+ *  An H2-matrix is constructed by recompressing a HMatrix. Each low-rank
+ *  block \c (t, s) of the H-matrix is replaced by a small coupling matrix
+ *  \c S_ts such that the block is approximated by
+ *  <tt>Q_t * S_ts * P_s^H</tt>, where \c Q_t and \c P_s are orthonormal
+ *  row and column cluster bases shared by all blocks involving the
+ *  clusters \c t and \c s. As the bases are nested (see H2ClusterBasis),
+ *  the storage requirements and the cost of a matrix-vector product grow
+ *  only linearly with the matrix size, in contrast to the
+ *  <tt>O(N log N)</tt> cost of H-matrices. Dense blocks of the H-matrix are
+ *  copied unchanged.
+ *
+ *  The cluster bases are constructed from the total cluster bases of the
+ *  H-matrix, i.e. the basis of cluster \c t is required to represent all
+ *  low-rank blocks in the block rows of \c t and of its ancestors (see
+ *  S. Boerm, "Efficient Numerical Methods for Non-local Operators",
+ *  EMS 2010, chapter 6).
+ *
+ *  All indices refer to the permuted ordering of rows and columns. All
+ *  operations are parallelised with TBB. */
+template <typename ValueType>
+class H2Matrix : private boost::noncopyable
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+    typedef H2ClusterBasis<ValueType> ClusterBasis;
+
+    /** \brief Constructor.
+     *
+     *  Convert \p hMatrix into an H2-matrix. The cluster bases are truncated
+     *  with relative accuracy \p eps and rank limit \p maximumRank. */
+    H2Matrix(const HMatrix<ValueType>& hMatrix,
+             double eps, size_t maximumRank);
+
+    size_t rowCount() const;
+    size_t columnCount() const;
+
+    /** \brief Row cluster basis. */
+    const ClusterBasis& rowBasis() const { return *m_rowBasis; }
+    /** \brief Column cluster basis. */
+    const ClusterBasis& columnBasis() const { return *m_columnBasis; }
+
+    /** \brief Compute <tt>y := alpha * op(A) * x + beta * y</tt>.
+     *
+     *  Here \c A is this matrix and \c op is determined by \p trans. The
+     *  vectors \p x and \p y are in the permuted ordering. */
+    void apply(TranspositionMode trans,
+               const arma::Col<ValueType>& x, arma::Col<ValueType>& y,
+               ValueType alpha, ValueType beta) const;
+
+    /** \brief Return the entry (\p row, \p col) of the matrix (permuted
+     *  ordering). */
+    ValueType entry(size_t row, size_t col) const;
+
+    /** \brief Return the matrix in the dense format (permuted ordering). */
+    arma::Mat<ValueType> asMatrix() const;
+
+    /** \brief Number of matrix entries stored in the H2-matrix, including
+     *  the cluster bases. */
+    size_t storedEntryCount() const;
+
+    /** \brief Maximum rank of the cluster bases. */
+    size_t maximumRank() const;
+
+private:
+    /** \cond PRIVATE */
+    struct FarFieldBlock {
+        const ClusterBasis* rowBasis;
+        const ClusterBasis* columnBasis;
+        arma::Mat<ValueType> coupling;
+    };
+    struct NearFieldBlock {
+        size_t rowBegin, rowCount, columnBegin, columnCount;
+        arma::Mat<ValueType> matrix;
+    };
+    struct BlockTreeNode {
+        enum Type { SUBDIVIDED, NEAR_FIELD, FAR_FIELD };
+        size_t rowBegin, rowCount, columnBegin, columnCount;
+        Type type;
+        // Index of the son nodes (SUBDIVIDED) or of the block (other types)
+        size_t sons[4];
+        size_t block;
+    };
+
+    size_t appendBlockTreeNode(
+            const HMatrixBlock<ValueType>& block,
+            std::vector<const HMatrixBlock<ValueType>*>& farFieldSources);
+
+    void applyNoTranspose(const arma::Col<ValueType>& x,
+                          arma::Col<ValueType>& y) const;
+    void applyConjugateTranspose(const arma::Col<ValueType>& x,
+                                 arma::Col<ValueType>& y) const;
+
+    size_t m_rowCount, m_columnCount;
+    boost::scoped_ptr<ClusterBasis> m_rowBasis;
+    boost::scoped_ptr<ClusterBasis> m_columnBasis;
+    std::vector<const ClusterBasis*> m_rowBasisNodes;
+    std::vector<const ClusterBasis*> m_columnBasisNodes;
+    std::vector<FarFieldBlock> m_farField;
+    std::vector<NearFieldBlock> m_nearField;
+    // Indices of the far-field blocks in each block row and block column
+    std::vector<std::vector<size_t> > m_farFieldByRow;
+    std::vector<std::vector<size_t> > m_farFieldByColumn;
+    // Block tree used to locate individual entries
+    std::vector<BlockTreeNode> m_blockTree;
+    /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
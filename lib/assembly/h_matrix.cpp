@@ -0,0 +1,608 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h_matrix.hpp"
+
+#include "aca_options.hpp"
+#include "h_matrix_aca.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Blocks with fewer entries are coarsened serially
+const size_t MINIMUM_PARALLEL_BLOCK_SIZE = 65536;
+
+template <typename ValueType>
+HMatrixBlock<ValueType>* constructBlockTree(
+        const HMatrixCluster<typename Fiber::ScalarTraits<ValueType>::RealType>& rows,
+        const HMatrixCluster<typename Fiber::ScalarTraits<ValueType>::RealType>& columns,
+        const AcaOptions& options)
+{
+    typedef HMatrixBlock<ValueType> Block;
+
+    const bool admissible = rows.distance(columns) > 0. &&
+            std::min(rows.diameter(), columns.diameter()) <=
+            options.eta * rows.distance(columns);
+    if (admissible &&
+            std::min(rows.size(), columns.size()) >=
+            size_t(options.minimumBlockSize) &&
+            std::max(rows.size(), columns.size()) <=
+            size_t(options.maximumBlockSize))
+        return new Block(rows, columns, true /* admissible */, Block::LOW_RANK);
+    if (rows.isLeaf() || columns.isLeaf())
+        return new Block(rows, columns, admissible, Block::DENSE);
+
+    std::auto_ptr<Block> block(
+                new Block(rows, columns, admissible, Block::DENSE));
+    std::auto_ptr<Block> sons[4];
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i)
+            sons[i + 2 * j].reset(constructBlockTree<ValueType>(
+                                      rows.son(i), columns.son(j), options));
+    Block* rawSons[4];
+    for (int k = 0; k < 4; ++k)
+        rawSons[k] = sons[k].release();
+    block->subdivide(rawSons);
+    return block.release();
+}
+
+template <typename ValueType>
+void conjugateInPlace(arma::Col<ValueType>& x)
+{
+    for (size_t i = 0; i < x.n_rows; ++i)
+        x(i) = conj(x(i));
+}
+
+// Computes the contributions of a range of leaves to op(A) * x
+template <typename ValueType>
+class ApplyHMatrixLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+
+    ApplyHMatrixLoopBody(const std::vector<const Block*>& leaves,
+                         bool transpose, bool conjugate,
+                         const arma::Col<ValueType>& x, size_t resultSize) :
+        m_leaves(leaves), m_transpose(transpose), m_conjugate(conjugate),
+        m_x(x), m_result(resultSize) {
+        m_result.fill(0.);
+    }
+
+    ApplyHMatrixLoopBody(ApplyHMatrixLoopBody& other, tbb::split) :
+        m_leaves(other.m_leaves), m_transpose(other.m_transpose),
+        m_conjugate(other.m_conjugate), m_x(other.m_x),
+        m_result(other.m_result.n_rows) {
+        m_result.fill(0.);
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            const Block& block = *m_leaves[i];
+            size_t inBegin = block.columnBegin(), inCount = block.columnCount();
+            size_t outBegin = block.rowBegin(), outCount = block.rowCount();
+            if (m_transpose) {
+                std::swap(inBegin, outBegin);
+                std::swap(inCount, outCount);
+            }
+            if (inCount == 0 || outCount == 0)
+                continue;
+            const arma::Col<ValueType> in =
+                    m_x.rows(inBegin, inBegin + inCount - 1);
+            if (block.type() == Block::DENSE) {
+                if (!m_transpose)
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            block.dense() * in;
+                else if (m_conjugate)
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            block.dense().t() * in;
+                else
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            block.dense().st() * in;
+            } else if (block.rank() > 0) {
+                const arma::Mat<ValueType>& u = block.lowRankU();
+                const arma::Mat<ValueType>& v = block.lowRankV();
+                if (!m_transpose)
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            u * (v * in);
+                else if (m_conjugate)
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            v.t() * (u.t() * in);
+                else
+                    m_result.rows(outBegin, outBegin + outCount - 1) +=
+                            v.st() * (u.st() * in);
+            }
+        }
+    }
+
+    void join(const ApplyHMatrixLoopBody& other) {
+        m_result += other.m_result;
+    }
+
+    const arma::Col<ValueType>& result() const { return m_result; }
+
+private:
+    const std::vector<const Block*>& m_leaves;
+    bool m_transpose, m_conjugate;
+    const arma::Col<ValueType>& m_x;
+    arma::Col<ValueType> m_result;
+};
+
+template <typename ValueType>
+class AsMatrixLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+
+    AsMatrixLoopBody(const std::vector<const Block*>& leaves,
+                     arma::Mat<ValueType>& result) :
+        m_leaves(leaves), m_result(result) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i)
+            m_leaves[i]->toDense(m_result, 0, 0);
+    }
+
+private:
+    const std::vector<const Block*>& m_leaves;
+    arma::Mat<ValueType>& m_result;
+};
+
+template <typename ValueType>
+class TruncateLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+
+    TruncateLoopBody(const std::vector<Block*>& leaves,
+                     double eps, size_t maximumRank) :
+        m_leaves(leaves), m_eps(eps), m_maximumRank(maximumRank) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            Block& block = *m_leaves[i];
+            if (block.type() == Block::LOW_RANK)
+                truncateLowRank(block.lowRankU(), block.lowRankV(),
+                                m_eps, m_maximumRank);
+        }
+    }
+
+private:
+    const std::vector<Block*>& m_leaves;
+    double m_eps;
+    size_t m_maximumRank;
+};
+
+template <typename ValueType>
+void coarsenBlock(HMatrixBlock<ValueType>& block, double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+
+    if (block.isLeaf())
+        return;
+    if (block.rowCount() * block.columnCount() >= MINIMUM_PARALLEL_BLOCK_SIZE)
+        tbb::parallel_invoke(
+                boost::bind(coarsenBlock<ValueType>, boost::ref(block.son(0, 0)),
+                            eps, maximumRank),
+                boost::bind(coarsenBlock<ValueType>, boost::ref(block.son(1, 0)),
+                            eps, maximumRank),
+                boost::bind(coarsenBlock<ValueType>, boost::ref(block.son(0, 1)),
+                            eps, maximumRank),
+                boost::bind(coarsenBlock<ValueType>, boost::ref(block.son(1, 1)),
+                            eps, maximumRank));
+    else
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                coarsenBlock(block.son(i, j), eps, maximumRank);
+
+    // Try to agglomerate the sons if all of them are low-rank
+    size_t totalRank = 0, sonEntryCount = 0;
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i) {
+            const Block& son = block.son(i, j);
+            if (son.type() != Block::LOW_RANK)
+                return;
+            totalRank += son.rank();
+            sonEntryCount += son.storedEntryCount();
+        }
+
+    arma::Mat<ValueType> u(block.rowCount(), totalRank);
+    arma::Mat<ValueType> v(totalRank, block.columnCount());
+    u.fill(0.);
+    v.fill(0.);
+    size_t offset = 0;
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i) {
+            const Block& son = block.son(i, j);
+            const size_t rank = son.rank();
+            if (rank == 0)
+                continue;
+            const size_t rowOffset = son.rowBegin() - block.rowBegin();
+            const size_t columnOffset = son.columnBegin() - block.columnBegin();
+            u.submat(rowOffset, offset,
+                     rowOffset + son.rowCount() - 1, offset + rank - 1) =
+                    son.lowRankU();
+            v.submat(offset, columnOffset,
+                     offset + rank - 1, columnOffset + son.columnCount() - 1) =
+                    son.lowRankV();
+            offset += rank;
+        }
+    truncateLowRank(u, v, eps, maximumRank);
+    if (u.n_elem + v.n_elem < sonEntryCount)
+        block.setLowRank(u, v);
+}
+
+} // namespace
+
+template <typename ValueType>
+HMatrixBlock<ValueType>::HMatrixBlock(
+        const Cluster& rowCluster, const Cluster& columnCluster,
+        bool admissible, Type type) :
+    m_rowCluster(&rowCluster), m_columnCluster(&columnCluster),
+    m_admissible(admissible), m_type(type)
+{
+}
+
+template <typename ValueType>
+size_t HMatrixBlock<ValueType>::rank() const
+{
+    return m_type == LOW_RANK ? m_u.n_cols : 0;
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::subdivide(HMatrixBlock* sons[4])
+{
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i)
+            m_sons[i][j].reset(sons[i + 2 * j]);
+    m_type = SUBDIVIDED;
+    m_dense.set_size(0, 0);
+    m_u.set_size(0, 0);
+    m_v.set_size(0, 0);
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::setDense(const arma::Mat<ValueType>& data)
+{
+    if (data.n_rows != rowCount() || data.n_cols != columnCount())
+        throw std::invalid_argument("HMatrixBlock::setDense(): "
+                                    "incorrect matrix size");
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i)
+            m_sons[i][j].reset();
+    m_type = DENSE;
+    m_dense = data;
+    m_u.set_size(0, 0);
+    m_v.set_size(0, 0);
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::setLowRank(const arma::Mat<ValueType>& u,
+                                         const arma::Mat<ValueType>& v)
+{
+    if (u.n_rows != rowCount() || v.n_cols != columnCount() ||
+            u.n_cols != v.n_rows)
+        throw std::invalid_argument("HMatrixBlock::setLowRank(): "
+                                    "incorrect matrix sizes");
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i)
+            m_sons[i][j].reset();
+    m_type = LOW_RANK;
+    m_dense.set_size(0, 0);
+    m_u = u;
+    m_v = v;
+}
+
+template <typename ValueType>
+HMatrixBlock<ValueType>* HMatrixBlock<ValueType>::clone() const
+{
+    std::auto_ptr<HMatrixBlock> result(
+                new HMatrixBlock(*m_rowCluster, *m_columnCluster,
+                                 m_admissible, m_type));
+    if (m_type == SUBDIVIDED) {
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                result->m_sons[i][j].reset(m_sons[i][j]->clone());
+    } else {
+        result->m_dense = m_dense;
+        result->m_u = m_u;
+        result->m_v = m_v;
+    }
+    return result.release();
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::convertToDense()
+{
+    if (m_type != LOW_RANK)
+        throw std::logic_error("HMatrixBlock::convertToDense(): "
+                               "block is not a low-rank leaf");
+    if (rank() > 0)
+        m_dense = m_u * m_v;
+    else {
+        m_dense.set_size(rowCount(), columnCount());
+        m_dense.fill(0.);
+    }
+    m_type = DENSE;
+    m_u.set_size(0, 0);
+    m_v.set_size(0, 0);
+}
+
+template <typename ValueType>
+size_t HMatrixBlock<ValueType>::storedEntryCount() const
+{
+    switch (m_type) {
+    case DENSE:
+        return m_dense.n_elem;
+    case LOW_RANK:
+        return m_u.n_elem + m_v.n_elem;
+    default:
+        size_t result = 0;
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                result += m_sons[i][j]->storedEntryCount();
+        return result;
+    }
+}
+
+template <typename ValueType>
+size_t HMatrixBlock<ValueType>::maximumRank() const
+{
+    if (m_type != SUBDIVIDED)
+        return rank();
+    size_t result = 0;
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i)
+            result = std::max(result, m_sons[i][j]->maximumRank());
+    return result;
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::toDense(arma::Mat<ValueType>& result,
+                                      size_t rowOffset,
+                                      size_t columnOffset) const
+{
+    if (m_type == SUBDIVIDED) {
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                m_sons[i][j]->toDense(result, rowOffset, columnOffset);
+        return;
+    }
+    if (rowCount() == 0 || columnCount() == 0)
+        return;
+    const size_t firstRow = rowBegin() - rowOffset;
+    const size_t firstColumn = columnBegin() - columnOffset;
+    const size_t lastRow = firstRow + rowCount() - 1;
+    const size_t lastColumn = firstColumn + columnCount() - 1;
+    if (m_type == DENSE)
+        result.submat(firstRow, firstColumn, lastRow, lastColumn) = m_dense;
+    else if (rank() > 0)
+        result.submat(firstRow, firstColumn, lastRow, lastColumn) = m_u * m_v;
+    else
+        result.submat(firstRow, firstColumn, lastRow, lastColumn).fill(0.);
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::collectLeaves(std::vector<HMatrixBlock*>& leaves)
+{
+    if (m_type != SUBDIVIDED)
+        leaves.push_back(this);
+    else
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                m_sons[i][j]->collectLeaves(leaves);
+}
+
+template <typename ValueType>
+void HMatrixBlock<ValueType>::collectLeaves(
+        std::vector<const HMatrixBlock*>& leaves) const
+{
+    if (m_type != SUBDIVIDED)
+        leaves.push_back(this);
+    else
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                static_cast<const HMatrixBlock&>(*m_sons[i][j]).collectLeaves(
+                            leaves);
+}
+
+template <typename ValueType>
+HMatrix<ValueType>::HMatrix(
+        const shared_ptr<const Cluster>& rowClusterTree,
+        const shared_ptr<const Cluster>& columnClusterTree,
+        const AcaOptions& options) :
+    m_rowClusterTree(rowClusterTree), m_columnClusterTree(columnClusterTree)
+{
+    if (!rowClusterTree || !columnClusterTree)
+        throw std::invalid_argument("HMatrix::HMatrix(): "
+                                    "cluster trees must not be null");
+    m_root.reset(constructBlockTree<ValueType>(
+                     *rowClusterTree, *columnClusterTree, options));
+    updateLeaves();
+}
+
+template <typename ValueType>
+HMatrix<ValueType>::HMatrix(
+        const shared_ptr<const Cluster>& rowClusterTree,
+        const shared_ptr<const Cluster>& columnClusterTree,
+        Block* root) :
+    m_rowClusterTree(rowClusterTree), m_columnClusterTree(columnClusterTree),
+    m_root(root)
+{
+    updateLeaves();
+}
+
+template <typename ValueType>
+std::auto_ptr<HMatrix<ValueType> > HMatrix<ValueType>::clone() const
+{
+    std::auto_ptr<Block> root(m_root->clone());
+    std::auto_ptr<HMatrix> result(
+                new HMatrix(m_rowClusterTree, m_columnClusterTree, root.get()));
+    root.release();
+    return result;
+}
+
+template <typename ValueType>
+size_t HMatrix<ValueType>::rowCount() const
+{
+    return m_rowClusterTree->size();
+}
+
+template <typename ValueType>
+size_t HMatrix<ValueType>::columnCount() const
+{
+    return m_columnClusterTree->size();
+}
+
+template <typename ValueType>
+const shared_ptr<const typename HMatrix<ValueType>::Cluster>&
+HMatrix<ValueType>::rowClusterTree() const
+{
+    return m_rowClusterTree;
+}
+
+template <typename ValueType>
+const shared_ptr<const typename HMatrix<ValueType>::Cluster>&
+HMatrix<ValueType>::columnClusterTree() const
+{
+    return m_columnClusterTree;
+}
+
+template <typename ValueType>
+std::vector<const typename HMatrix<ValueType>::Block*>
+HMatrix<ValueType>::leaves() const
+{
+    return std::vector<const Block*>(m_leaves.begin(), m_leaves.end());
+}
+
+template <typename ValueType>
+void HMatrix<ValueType>::updateLeaves()
+{
+    m_leaves.clear();
+    m_root->collectLeaves(m_leaves);
+}
+
+template <typename ValueType>
+void HMatrix<ValueType>::apply(TranspositionMode trans,
+                               const arma::Col<ValueType>& x,
+                               arma::Col<ValueType>& y,
+                               ValueType alpha, ValueType beta) const
+{
+    const bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    const bool conjugate = (trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE);
+    if (trans != NO_TRANSPOSE && !transpose && !conjugate)
+        throw std::invalid_argument("HMatrix::apply(): "
+                                    "invalid transposition mode");
+    const size_t inSize = transpose ? rowCount() : columnCount();
+    const size_t outSize = transpose ? columnCount() : rowCount();
+    if (x.n_rows != inSize)
+        throw std::invalid_argument("HMatrix::apply(): "
+                                    "vector x has incorrect length");
+    if (beta == static_cast<ValueType>(0.)) {
+        y.set_size(outSize);
+        y.fill(0.);
+    } else {
+        if (y.n_rows != outSize)
+            throw std::invalid_argument("HMatrix::apply(): "
+                                        "vector y has incorrect length");
+        y *= beta;
+    }
+
+    // conj(A) * x = conj(A * conj(x))
+    arma::Col<ValueType> conjugatedX;
+    const bool conjugateInput = conjugate && !transpose;
+    if (conjugateInput) {
+        conjugatedX = x;
+        conjugateInPlace(conjugatedX);
+    }
+
+    const std::vector<const Block*> leafList = leaves();
+    typedef ApplyHMatrixLoopBody<ValueType> Body;
+    Body body(leafList, transpose, conjugate,
+              conjugateInput ? conjugatedX : x, outSize);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, leafList.size()), body);
+
+    if (conjugateInput) {
+        arma::Col<ValueType> result = body.result();
+        conjugateInPlace(result);
+        y += alpha * result;
+    } else
+        y += alpha * body.result();
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> HMatrix<ValueType>::asMatrix() const
+{
+    arma::Mat<ValueType> result(rowCount(), columnCount());
+    const std::vector<const Block*> leafList = leaves();
+    typedef AsMatrixLoopBody<ValueType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, leafList.size()),
+                      Body(leafList, result));
+    return result;
+}
+
+template <typename ValueType>
+void HMatrix<ValueType>::truncate(double eps, size_t maximumRank)
+{
+    typedef TruncateLoopBody<ValueType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_leaves.size(), 1),
+                      Body(m_leaves, eps, maximumRank));
+}
+
+template <typename ValueType>
+void HMatrix<ValueType>::coarsen(double eps, size_t maximumRank)
+{
+    coarsenBlock(*m_root, eps, maximumRank);
+    updateLeaves();
+}
+
+template <typename ValueType>
+size_t HMatrix<ValueType>::storedEntryCount() const
+{
+    return m_root->storedEntryCount();
+}
+
+template <typename ValueType>
+size_t HMatrix<ValueType>::maximumRank() const
+{
+    return m_root->maximumRank();
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(HMatrixBlock);
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(HMatrix);
+
+} // namespace Bempp
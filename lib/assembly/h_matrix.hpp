@@ -0,0 +1,271 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_hpp
+#define bempp_h_matrix_hpp
+
+#include "../common/common.hpp"
+
+#include "h_matrix_cluster.hpp"
+#include "transposition_mode.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../common/shared_ptr.hpp"
+#include "../fiber/scalar_traits.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <memory>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class AcaOptions;
+/** \endcond */
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Node of the block cluster tree of a HMatrix.
+ *
+ *  A block couples a row cluster with a column cluster. Leaf blocks store
+ *  their entries either as a dense matrix or in the low-rank format
+ *  <tt>U * V</tt>, where \c U has rank() columns and \c V has rank() rows.
+ *  Non-leaf blocks are subdivided into 2 x 2 sons coupling the sons of the
+ *  row and column clusters.
+ *
+ *  All indices refer to the permuted ordering of rows and columns. */
+template <typename ValueType>
+class HMatrixBlock : private boost::noncopyable
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+
+    /** \brief Possible representations of a block. */
+    enum Type {
+        /** \brief The block is subdivided into 2 x 2 sons. */
+        SUBDIVIDED,
+        /** \brief The block is a leaf stored as a dense matrix. */
+        DENSE,
+        /** \brief The block is a leaf stored in the low-rank format. */
+        LOW_RANK
+    };
+
+    /** \brief Constructor.
+     *
+     *  Construct a leaf block of type \p type coupling the clusters
+     *  \p rowCluster and \p columnCluster, with no data. */
+    HMatrixBlock(const Cluster& rowCluster, const Cluster& columnCluster,
+                 bool admissible, Type type);
+
+    const Cluster& rowCluster() const { return *m_rowCluster; }
+    const Cluster& columnCluster() const { return *m_columnCluster; }
+    size_t rowBegin() const { return m_rowCluster->begin(); }
+    size_t rowCount() const { return m_rowCluster->size(); }
+    size_t columnBegin() const { return m_columnCluster->begin(); }
+    size_t columnCount() const { return m_columnCluster->size(); }
+
+    /** \brief Return true if the block satisfies the admissibility
+     *  condition. */
+    bool isAdmissible() const { return m_admissible; }
+
+    Type type() const { return m_type; }
+    bool isLeaf() const { return m_type != SUBDIVIDED; }
+
+    /** \brief Son coupling the row son \p row with the column son \p col. */
+    HMatrixBlock& son(int row, int col) { return *m_sons[row][col]; }
+    const HMatrixBlock& son(int row, int col) const { return *m_sons[row][col]; }
+
+    /** \brief Entries of a dense leaf. */
+    arma::Mat<ValueType>& dense() { return m_dense; }
+    const arma::Mat<ValueType>& dense() const { return m_dense; }
+    /** \brief Left factor of a low-rank leaf. */
+    arma::Mat<ValueType>& lowRankU() { return m_u; }
+    const arma::Mat<ValueType>& lowRankU() const { return m_u; }
+    /** \brief Right factor of a low-rank leaf. */
+    arma::Mat<ValueType>& lowRankV() { return m_v; }
+    const arma::Mat<ValueType>& lowRankV() const { return m_v; }
+
+    /** \brief Rank of a low-rank leaf (0 for other blocks). */
+    size_t rank() const;
+
+    /** \brief Subdivide this block into 2 x 2 sons.
+     *
+     *  \p sons[i + 2 * j] becomes the son coupling the row son \p i and the
+     *  column son \p j; ownership of the sons is taken over. Any data stored
+     *  in this block are discarded. */
+    void subdivide(HMatrixBlock* sons[4]);
+
+    /** \brief Store a dense matrix in this block, turning it into a dense
+     *  leaf. Any sons are deleted. */
+    void setDense(const arma::Mat<ValueType>& data);
+
+    /** \brief Store a low-rank matrix <tt>u * v</tt> in this block, turning it
+     *  into a low-rank leaf. Any sons are deleted. */
+    void setLowRank(const arma::Mat<ValueType>& u, const arma::Mat<ValueType>& v);
+
+    /** \brief Convert a low-rank leaf into a dense leaf. */
+    void convertToDense();
+
+    /** \brief Return a newly allocated deep copy of this block and its
+     *  descendants. */
+    HMatrixBlock* clone() const;
+
+    /** \brief Number of matrix entries stored in this block and its
+     *  descendants. */
+    size_t storedEntryCount() const;
+
+    /** \brief Maximum rank of the low-rank leaves in this subtree. */
+    size_t maximumRank() const;
+
+    /** \brief Write the contents of this block into the corresponding
+     *  submatrix of \p result.
+     *
+     *  \p result(0, 0) corresponds to the entry (\p rowOffset, \p columnOffset)
+     *  of the full matrix. */
+    void toDense(arma::Mat<ValueType>& result,
+                 size_t rowOffset, size_t columnOffset) const;
+
+    /** \brief Append pointers to the leaves of this subtree to \p leaves. */
+    void collectLeaves(std::vector<HMatrixBlock*>& leaves);
+    /** \overload */
+    void collectLeaves(std::vector<const HMatrixBlock*>& leaves) const;
+
+private:
+    /** \cond PRIVATE */
+    const Cluster* m_rowCluster;
+    const Cluster* m_columnCluster;
+    bool m_admissible;
+    Type m_type;
+    boost::scoped_ptr<HMatrixBlock> m_sons[2][2];
+    arma::Mat<ValueType> m_dense;
+    arma::Mat<ValueType> m_u;
+    arma::Mat<ValueType> m_v;
+    /** \endcond */
+};
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Hierarchical matrix built into BEM++.
+ *
+ *  This class stores the block cluster tree and the blocks of an H-matrix
+ *  whose rows and columns are indexed in the orderings defined by the row
+ *  and column cluster trees. It is the data structure underlying
+ *  DiscreteHMatrixBoundaryOperator; it does not depend on AHMED.
+ *
+ *  All operations on the matrix are parallelised with TBB. The number of
+ *  threads is controlled by the tbb::task_scheduler_init object active in
+ *  the calling thread. */
+template <typename ValueType>
+class HMatrix : private boost::noncopyable
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+    typedef HMatrixBlock<ValueType> Block;
+
+    /** \brief Constructor.
+     *
+     *  Build the block cluster tree coupling \p rowClusterTree with
+     *  \p columnClusterTree. A pair of clusters is admissible if
+     *
+     *  <tt>min(diam(rows), diam(columns)) <= eta * dist(rows, columns)</tt>
+     *
+     *  where \c eta is taken from \p options. Admissible pairs whose both
+     *  clusters contain at least <tt>options.minimumBlockSize</tt> DOFs
+     *  and at most <tt>options.maximumBlockSize</tt> DOFs become low-rank
+     *  leaves; pairs involving a leaf cluster become dense leaves; all other
+     *  pairs are subdivided. The blocks contain no data after construction. */
+    HMatrix(const shared_ptr<const Cluster>& rowClusterTree,
+            const shared_ptr<const Cluster>& columnClusterTree,
+            const AcaOptions& options);
+
+    size_t rowCount() const;
+    size_t columnCount() const;
+
+    const shared_ptr<const Cluster>& rowClusterTree() const;
+    const shared_ptr<const Cluster>& columnClusterTree() const;
+
+    Block& root() { return *m_root; }
+    const Block& root() const { return *m_root; }
+
+    /** \brief Pointers to the leaf blocks, in depth-first order.
+     *
+     *  The list is refreshed by the member functions that change the block
+     *  structure (e.g. coarsen()); it must be refreshed by calling
+     *  updateLeaves() if the structure is changed in another way. */
+    const std::vector<Block*>& leaves() { return m_leaves; }
+    /** \overload */
+    std::vector<const Block*> leaves() const;
+
+    /** \brief Rebuild the list of leaf blocks. */
+    void updateLeaves();
+
+    /** \brief Return a deep copy of this H-matrix.
+     *
+     *  The copy shares the cluster trees with the original. */
+    std::auto_ptr<HMatrix> clone() const;
+
+    /** \brief Compute <tt>y := alpha * op(A) * x + beta * y</tt>.
+     *
+     *  Here \c A is this matrix and \c op is determined by \p trans. The
+     *  vectors \p x and \p y are in the permuted ordering. The contributions
+     *  of leaf blocks are computed in parallel. */
+    void apply(TranspositionMode trans,
+               const arma::Col<ValueType>& x, arma::Col<ValueType>& y,
+               ValueType alpha, ValueType beta) const;
+
+    /** \brief Return the matrix in the dense format (permuted ordering). */
+    arma::Mat<ValueType> asMatrix() const;
+
+    /** \brief Recompress all low-rank leaves with relative accuracy \p eps
+     *  and rank limit \p maximumRank, in parallel. */
+    void truncate(double eps, size_t maximumRank);
+
+    /** \brief Agglomerate sons of subdivided blocks into single low-rank
+     *  blocks wherever this reduces storage.
+     *
+     *  Low-rank approximation accuracy \p eps is relative to the norm of each
+     *  agglomerated block. Independent subtrees are processed in parallel. */
+    void coarsen(double eps, size_t maximumRank);
+
+    /** \brief Number of matrix entries stored in the H-matrix. */
+    size_t storedEntryCount() const;
+
+    /** \brief Maximum rank of the low-rank leaves. */
+    size_t maximumRank() const;
+
+private:
+    HMatrix(const shared_ptr<const Cluster>& rowClusterTree,
+            const shared_ptr<const Cluster>& columnClusterTree,
+            Block* root);
+
+private:
+    /** \cond PRIVATE */
+    shared_ptr<const Cluster> m_rowClusterTree;
+    shared_ptr<const Cluster> m_columnClusterTree;
+    boost::scoped_ptr<Block> m_root;
+    std::vector<Block*> m_leaves;
+    /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,458 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h_matrix_aca.hpp"
+
+#include "h_matrix.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+template <typename ValueType>
+typename Fiber::ScalarTraits<ValueType>::RealType
+squaredNorm(const arma::Col<ValueType>& x)
+{
+    typename Fiber::ScalarTraits<ValueType>::RealType result = 0.;
+    for (size_t i = 0; i < x.n_rows; ++i)
+        result += realPart(conj(x(i)) * x(i));
+    return result;
+}
+
+template <typename ValueType>
+ValueType dotConj(const arma::Col<ValueType>& x, const arma::Col<ValueType>& y)
+{
+    ValueType result = 0.;
+    for (size_t i = 0; i < x.n_rows; ++i)
+        result += conj(x(i)) * y(i);
+    return result;
+}
+
+// Index of the entry of x with the largest modulus among those not marked as
+// used; -1 if all such entries vanish
+template <typename ValueType>
+int maximumUnusedEntry(const arma::Col<ValueType>& x,
+                       const std::vector<char>& used)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    int result = -1;
+    CoordinateType maximum = 0.;
+    for (size_t i = 0; i < x.n_rows; ++i)
+        if (!used[i] && std::abs(x(i)) > maximum) {
+            maximum = std::abs(x(i));
+            result = i;
+        }
+    return result;
+}
+
+// Index of the first entry of used that is zero; -1 if none
+int firstUnused(const std::vector<char>& used)
+{
+    for (size_t i = 0; i < used.size(); ++i)
+        if (!used[i])
+            return i;
+    return -1;
+}
+
+// Helper class for the ACA+ algorithm. The cross approximation is stored as
+// the sum of the rank-one matrices us[l] * vs[l]^T.
+template <typename ValueType>
+class AcaPlusApproximation
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    AcaPlusApproximation(const HMatrixEntryGenerator<ValueType>& generator,
+                         size_t rowBegin, size_t rowCount,
+                         size_t columnBegin, size_t columnCount,
+                         CoordinateType minimumDistance) :
+        m_generator(generator),
+        m_rowBegin(rowBegin), m_rowCount(rowCount),
+        m_columnBegin(columnBegin), m_columnCount(columnCount),
+        m_minimumDistance(minimumDistance) {
+    }
+
+    size_t rank() const { return m_us.size(); }
+
+    // Row i of the difference between the block and its current approximation
+    void residualRow(size_t i, arma::Col<ValueType>& row) const {
+        m_generator.evaluate(m_rowBegin + i, 1, m_columnBegin, m_columnCount,
+                             m_minimumDistance, m_buffer);
+        row.set_size(m_columnCount);
+        for (size_t j = 0; j < m_columnCount; ++j)
+            row(j) = m_buffer(0, j);
+        for (size_t l = 0; l < m_us.size(); ++l) {
+            const ValueType factor = m_us[l](i);
+            for (size_t j = 0; j < m_columnCount; ++j)
+                row(j) -= factor * m_vs[l](j);
+        }
+    }
+
+    // Column j of the difference between the block and its current
+    // approximation
+    void residualColumn(size_t j, arma::Col<ValueType>& col) const {
+        m_generator.evaluate(m_rowBegin, m_rowCount, m_columnBegin + j, 1,
+                             m_minimumDistance, m_buffer);
+        col.set_size(m_rowCount);
+        for (size_t i = 0; i < m_rowCount; ++i)
+            col(i) = m_buffer(i, 0);
+        for (size_t l = 0; l < m_us.size(); ++l) {
+            const ValueType factor = m_vs[l](j);
+            for (size_t i = 0; i < m_rowCount; ++i)
+                col(i) -= factor * m_us[l](i);
+        }
+    }
+
+    // Add the rank-one term u * v^T and return the updated estimate of the
+    // squared Frobenius norm of the approximation
+    CoordinateType addTerm(const arma::Col<ValueType>& u,
+                           const arma::Col<ValueType>& v,
+                           CoordinateType squaredNormEstimate) {
+        for (size_t l = 0; l < m_us.size(); ++l)
+            squaredNormEstimate +=
+                    2. * realPart(dotConj(m_us[l], u) * dotConj(m_vs[l], v));
+        squaredNormEstimate += squaredNorm(u) * squaredNorm(v);
+        m_us.push_back(u);
+        m_vs.push_back(v);
+        return squaredNormEstimate;
+    }
+
+    void getFactors(arma::Mat<ValueType>& u, arma::Mat<ValueType>& v) const {
+        const size_t rank = m_us.size();
+        u.set_size(m_rowCount, rank);
+        v.set_size(rank, m_columnCount);
+        for (size_t l = 0; l < rank; ++l) {
+            for (size_t i = 0; i < m_rowCount; ++i)
+                u(i, l) = m_us[l](i);
+            for (size_t j = 0; j < m_columnCount; ++j)
+                v(l, j) = m_vs[l](j);
+        }
+    }
+
+private:
+    const HMatrixEntryGenerator<ValueType>& m_generator;
+    size_t m_rowBegin, m_rowCount, m_columnBegin, m_columnCount;
+    CoordinateType m_minimumDistance;
+    std::vector<arma::Col<ValueType> > m_us, m_vs;
+    mutable arma::Mat<ValueType> m_buffer;
+};
+
+// Number of singular values to keep
+template <typename CoordinateType>
+size_t truncatedRank(const arma::Col<CoordinateType>& s,
+                     double eps, size_t maximumRank)
+{
+    if (s.n_rows == 0 || s(0) <= 0.)
+        return 0;
+    size_t rank = 0;
+    while (rank < s.n_rows && rank < maximumRank && s(rank) > eps * s(0))
+        ++rank;
+    return rank;
+}
+
+template <typename ValueType>
+class FillHMatrixLoopBody
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    FillHMatrixLoopBody(const std::vector<Block*>& leaves,
+                        const HMatrixEntryGenerator<ValueType>& generator,
+                        double eps, size_t maximumRank) :
+        m_leaves(leaves), m_generator(generator),
+        m_eps(eps), m_maximumRank(maximumRank) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        arma::Mat<ValueType> u, v;
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            Block& block = *m_leaves[i];
+            // Cluster bounding boxes enclose DOF positions, not DOF
+            // supports, so their distance must be reduced to give a lower
+            // bound on the distance between elements
+            CoordinateType minimumDistance = -1.;
+            if (block.isAdmissible())
+                minimumDistance = std::max(
+                            CoordinateType(0.),
+                            block.rowCluster().distance(block.columnCluster()) -
+                            (block.rowCluster().diameter() +
+                             block.columnCluster().diameter()) / 2);
+            if (block.type() == Block::LOW_RANK &&
+                    acaPlus(m_generator,
+                            block.rowBegin(), block.rowCount(),
+                            block.columnBegin(), block.columnCount(),
+                            minimumDistance, m_eps, m_maximumRank, u, v)) {
+                truncateLowRank(u, v, m_eps, m_maximumRank);
+                block.setLowRank(u, v);
+            } else {
+                m_generator.evaluate(block.rowBegin(), block.rowCount(),
+                                     block.columnBegin(), block.columnCount(),
+                                     minimumDistance, u);
+                block.setDense(u);
+            }
+        }
+    }
+
+private:
+    const std::vector<Block*>& m_leaves;
+    const HMatrixEntryGenerator<ValueType>& m_generator;
+    double m_eps;
+    size_t m_maximumRank;
+};
+
+template <typename ValueType>
+bool isLarger(const HMatrixBlock<ValueType>* a, const HMatrixBlock<ValueType>* b)
+{
+    return a->rowCount() * a->columnCount() > b->rowCount() * b->columnCount();
+}
+
+} // namespace
+
+template <typename ValueType>
+bool acaPlus(const HMatrixEntryGenerator<ValueType>& generator,
+             size_t rowBegin, size_t rowCount,
+             size_t columnBegin, size_t columnCount,
+             typename Fiber::ScalarTraits<ValueType>::RealType minimumDistance,
+             double eps, size_t maximumRank,
+             arma::Mat<ValueType>& u, arma::Mat<ValueType>& v)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    if (rowCount == 0 || columnCount == 0) {
+        u.set_size(rowCount, 0);
+        v.set_size(0, columnCount);
+        return true;
+    }
+
+    // Beyond this rank the low-rank format is more expensive than the dense one
+    const size_t rankLimit = std::min(
+                maximumRank, rowCount * columnCount / (rowCount + columnCount));
+
+    AcaPlusApproximation<ValueType> approx(generator, rowBegin, rowCount,
+                                           columnBegin, columnCount,
+                                           minimumDistance);
+    std::vector<char> usedRows(rowCount, 0), usedColumns(columnCount, 0);
+    size_t usedRowCount = 0, usedColumnCount = 0;
+
+    int refRow = 0, refColumn = 0;
+    arma::Col<ValueType> refRowValues, refColumnValues, row, col;
+    approx.residualRow(refRow, refRowValues);
+    approx.residualColumn(refColumn, refColumnValues);
+    CoordinateType squaredNormEstimate = 0.;
+
+    while (true) {
+        if (approx.rank() >= rankLimit)
+            return false;
+        if (usedRowCount == rowCount || usedColumnCount == columnCount)
+            break; // the approximation is exact
+
+        // Replace reference row and column if they have been used as pivots
+        // or if their residuals vanish
+        while (usedRows[refRow] ||
+               maximumUnusedEntry(refRowValues, usedColumns) < 0) {
+            if (!usedRows[refRow]) {
+                usedRows[refRow] = 1;
+                ++usedRowCount;
+            }
+            refRow = firstUnused(usedRows);
+            if (refRow < 0)
+                break;
+            approx.residualRow(refRow, refRowValues);
+        }
+        while (usedColumns[refColumn] ||
+               maximumUnusedEntry(refColumnValues, usedRows) < 0) {
+            if (!usedColumns[refColumn]) {
+                usedColumns[refColumn] = 1;
+                ++usedColumnCount;
+            }
+            refColumn = firstUnused(usedColumns);
+            if (refColumn < 0)
+                break;
+            approx.residualColumn(refColumn, refColumnValues);
+        }
+        if (refRow < 0 || refColumn < 0)
+            break;
+
+        const int rowCandidate = maximumUnusedEntry(refRowValues, usedColumns);
+        const int columnCandidate = maximumUnusedEntry(refColumnValues, usedRows);
+        int pivotRow, pivotColumn;
+        if (std::abs(refRowValues(rowCandidate)) >=
+                std::abs(refColumnValues(columnCandidate))) {
+            pivotColumn = rowCandidate;
+            approx.residualColumn(pivotColumn, col);
+            pivotRow = maximumUnusedEntry(col, usedRows);
+            if (pivotRow < 0) {
+                usedColumns[pivotColumn] = 1;
+                ++usedColumnCount;
+                continue;
+            }
+            approx.residualRow(pivotRow, row);
+        } else {
+            pivotRow = columnCandidate;
+            approx.residualRow(pivotRow, row);
+            pivotColumn = maximumUnusedEntry(row, usedColumns);
+            if (pivotColumn < 0) {
+                usedRows[pivotRow] = 1;
+                ++usedRowCount;
+                continue;
+            }
+            approx.residualColumn(pivotColumn, col);
+        }
+        usedRows[pivotRow] = 1;
+        ++usedRowCount;
+        usedColumns[pivotColumn] = 1;
+        ++usedColumnCount;
+
+        const ValueType pivot = row(pivotColumn);
+        for (size_t i = 0; i < rowCount; ++i)
+            col(i) /= pivot;
+        squaredNormEstimate = approx.addTerm(col, row, squaredNormEstimate);
+
+        const ValueType refRowFactor = col(refRow);
+        for (size_t j = 0; j < columnCount; ++j)
+            refRowValues(j) -= refRowFactor * row(j);
+        const ValueType refColumnFactor = row(refColumn);
+        for (size_t i = 0; i < rowCount; ++i)
+            refColumnValues(i) -= refColumnFactor * col(i);
+
+        if (squaredNorm(col) * squaredNorm(row) <=
+                eps * eps * squaredNormEstimate)
+            break;
+    }
+    approx.getFactors(u, v);
+    return true;
+}
+
+template <typename ValueType>
+void truncateLowRank(arma::Mat<ValueType>& u, arma::Mat<ValueType>& v,
+                     double eps, size_t maximumRank)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    const size_t rowCount = u.n_rows, columnCount = v.n_cols;
+    if (u.n_cols == 0)
+        return;
+
+    // u = qu * diag(su) * wu^H
+    arma::Mat<ValueType> qu, wu;
+    arma::Col<CoordinateType> su;
+    if (!arma::svd_econ(qu, su, wu, u))
+        throw std::runtime_error("truncateLowRank(): SVD failed");
+    // diag(su) * wu^H * v = x * diag(s) * y^H
+    arma::Mat<ValueType> core = wu.t();
+    for (size_t i = 0; i < core.n_rows; ++i)
+        core.row(i) *= ValueType(su(i));
+    core = core * v;
+    arma::Mat<ValueType> x, y;
+    arma::Col<CoordinateType> s;
+    if (!arma::svd_econ(x, s, y, core))
+        throw std::runtime_error("truncateLowRank(): SVD failed");
+
+    const size_t rank = truncatedRank(s, eps, maximumRank);
+    if (rank == 0) {
+        u.set_size(rowCount, 0);
+        v.set_size(0, columnCount);
+        return;
+    }
+    arma::Mat<ValueType> xs = x.cols(0, rank - 1);
+    for (size_t l = 0; l < rank; ++l)
+        xs.col(l) *= ValueType(s(l));
+    u = qu * xs;
+    const arma::Mat<ValueType> ys = y.cols(0, rank - 1);
+    v = ys.t();
+}
+
+template <typename ValueType>
+void denseToLowRank(const arma::Mat<ValueType>& a,
+                    double eps, size_t maximumRank,
+                    arma::Mat<ValueType>& u, arma::Mat<ValueType>& v)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    const size_t rowCount = a.n_rows, columnCount = a.n_cols;
+    if (rowCount == 0 || columnCount == 0) {
+        u.set_size(rowCount, 0);
+        v.set_size(0, columnCount);
+        return;
+    }
+
+    arma::Mat<ValueType> x, y;
+    arma::Col<CoordinateType> s;
+    if (!arma::svd_econ(x, s, y, a))
+        throw std::runtime_error("denseToLowRank(): SVD failed");
+    const size_t rank = truncatedRank(s, eps, maximumRank);
+    if (rank == 0) {
+        u.set_size(rowCount, 0);
+        v.set_size(0, columnCount);
+        return;
+    }
+    u = x.cols(0, rank - 1);
+    for (size_t l = 0; l < rank; ++l)
+        u.col(l) *= ValueType(s(l));
+    const arma::Mat<ValueType> ys = y.cols(0, rank - 1);
+    v = ys.t();
+}
+
+template <typename ValueType>
+void fillHMatrix(HMatrix<ValueType>& matrix,
+                 const HMatrixEntryGenerator<ValueType>& generator,
+                 double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+
+    // Process the largest blocks first to improve load balancing
+    std::vector<Block*> leaves(matrix.leaves());
+    std::sort(leaves.begin(), leaves.end(), isLarger<ValueType>);
+
+    typedef FillHMatrixLoopBody<ValueType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, leaves.size(), 1),
+                      Body(leaves, generator, eps, maximumRank));
+}
+
+#define INSTANTIATE_FUNCTIONS(VALUE) \
+    template bool acaPlus( \
+        const HMatrixEntryGenerator<VALUE>&, \
+        size_t, size_t, size_t, size_t, \
+        Fiber::ScalarTraits<VALUE>::RealType, \
+        double, size_t, arma::Mat<VALUE>&, arma::Mat<VALUE>&); \
+    template void truncateLowRank( \
+        arma::Mat<VALUE>&, arma::Mat<VALUE>&, double, size_t); \
+    template void denseToLowRank( \
+        const arma::Mat<VALUE>&, double, size_t, \
+        arma::Mat<VALUE>&, arma::Mat<VALUE>&); \
+    template void fillHMatrix( \
+        HMatrix<VALUE>&, const HMatrixEntryGenerator<VALUE>&, double, size_t)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FUNCTIONS);
+
+} // namespace Bempp
@@ -0,0 +1,142 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_aca_hpp
+#define bempp_h_matrix_aca_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/scalar_traits.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class HMatrix;
+/** \endcond */
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Source of the entries of a matrix to be approximated by a HMatrix.
+ *
+ *  Implementations must allow evaluate() to be called concurrently from
+ *  several threads. */
+template <typename ValueType>
+class HMatrixEntryGenerator
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+
+    virtual ~HMatrixEntryGenerator() {}
+
+    /** \brief Evaluate a block of the matrix.
+     *
+     *  \param[in] rowBegin, rowCount
+     *    Range of rows (in the permuted ordering).
+     *  \param[in] columnBegin, columnCount
+     *    Range of columns (in the permuted ordering).
+     *  \param[in] minimumDistance
+     *    Lower bound on the distance between the supports of the row and
+     *    column DOFs, or a negative number if unknown.
+     *  \param[out] result
+     *    On exit, matrix of size (\p rowCount, \p columnCount) containing the
+     *    requested entries. */
+    virtual void evaluate(size_t rowBegin, size_t rowCount,
+                          size_t columnBegin, size_t columnCount,
+                          CoordinateType minimumDistance,
+                          arma::Mat<ValueType>& result) const = 0;
+};
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Approximate a matrix block by adaptive cross approximation with
+ *  partial pivoting (ACA+).
+ *
+ *  Pivots are chosen with the help of a reference row and a reference
+ *  column, which makes the algorithm robust for blocks containing zero
+ *  rows or columns. Only the rows and columns selected as pivots are
+ *  evaluated.
+ *
+ *  \param[in] generator
+ *    Source of matrix entries.
+ *  \param[in] rowBegin, rowCount, columnBegin, columnCount
+ *    Block to approximate.
+ *  \param[in] minimumDistance
+ *    Passed to HMatrixEntryGenerator::evaluate().
+ *  \param[in] eps
+ *    Requested relative accuracy (in the Frobenius norm).
+ *  \param[in] maximumRank
+ *    Maximum rank of the approximation.
+ *  \param[out] u, v
+ *    Factors of the approximation <tt>u * v</tt>.
+ *
+ *  \return false if no approximation of rank at most \p maximumRank (and
+ *  cheaper to store than the dense block) was found; in this case the
+ *  contents of \p u and \p v are undefined. */
+template <typename ValueType>
+bool acaPlus(const HMatrixEntryGenerator<ValueType>& generator,
+             size_t rowBegin, size_t rowCount,
+             size_t columnBegin, size_t columnCount,
+             typename Fiber::ScalarTraits<ValueType>::RealType minimumDistance,
+             double eps, size_t maximumRank,
+             arma::Mat<ValueType>& u, arma::Mat<ValueType>& v);
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Recompress the low-rank matrix <tt>u * v</tt>.
+ *
+ *  Singular values smaller than \p eps times the largest one are discarded,
+ *  as are all singular values beyond the first \p maximumRank ones. */
+template <typename ValueType>
+void truncateLowRank(arma::Mat<ValueType>& u, arma::Mat<ValueType>& v,
+                     double eps, size_t maximumRank);
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Compute a truncated singular value decomposition of a dense
+ *  matrix.
+ *
+ *  On exit, <tt>u * v</tt> approximates \p a with relative accuracy \p eps
+ *  and rank at most \p maximumRank. */
+template <typename ValueType>
+void denseToLowRank(const arma::Mat<ValueType>& a,
+                    double eps, size_t maximumRank,
+                    arma::Mat<ValueType>& u, arma::Mat<ValueType>& v);
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Fill the blocks of a HMatrix.
+ *
+ *  Admissible leaves are approximated with acaPlus() and recompressed with
+ *  truncateLowRank(); leaves for which this fails and inadmissible leaves
+ *  are evaluated in full. Leaves are processed in parallel, largest first.
+ *
+ *  \param[in,out] matrix
+ *    H-matrix whose block structure has been set up.
+ *  \param[in] generator
+ *    Source of matrix entries.
+ *  \param[in] eps
+ *    Requested relative accuracy of low-rank blocks.
+ *  \param[in] maximumRank
+ *    Maximum rank of low-rank blocks. */
+template <typename ValueType>
+void fillHMatrix(HMatrix<ValueType>& matrix,
+                 const HMatrixEntryGenerator<ValueType>& generator,
+                 double eps, size_t maximumRank);
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,216 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_ahmed.hpp"
+#include "bempp/common/config_trilinos.hpp"
+
+#include "h_matrix_approximate_lu_inverse.hpp"
+
+#include "discrete_h_matrix_boundary_operator.hpp"
+#include "h_matrix.hpp"
+#include "h_matrix_inverse_helper.hpp"
+#include "h_matrix_lu.hpp"
+
+#ifdef WITH_AHMED
+#include "aca_approximate_lu_inverse.hpp"
+#include "discrete_aca_boundary_operator.hpp"
+#endif
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/pointer_cast.hpp>
+#include <tbb/task_scheduler_init.h>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceDefaultBase.hpp>
+#endif
+
+namespace Bempp
+{
+
+template <typename ValueType>
+HMatrixApproximateLuInverse<ValueType>::HMatrixApproximateLuInverse(
+        const DiscreteHMatrixBoundaryOperator<ValueType>& fwdOp,
+        MagnitudeType delta,
+        VerbosityLevel::Level verbosityLevel) :
+    m_lu(fwdOp.hMatrix()->clone().release()),
+    // All range-domain swaps intended!
+#ifdef WITH_TRILINOS
+    m_domainSpace(Thyra::defaultSpmdVectorSpace<ValueType>(fwdOp.rowCount())),
+    m_rangeSpace(Thyra::defaultSpmdVectorSpace<ValueType>(fwdOp.columnCount())),
+#endif
+    m_domainPermutation(fwdOp.rangePermutation()),
+    m_rangePermutation(fwdOp.domainPermutation()),
+    m_parallelizationOptions(fwdOp.parallelizationOptions())
+{
+    const size_t maximumRank = fwdOp.maximumRank() < 0 ?
+                std::numeric_limits<size_t>::max() : fwdOp.maximumRank();
+    {
+        HMatrixInverseHelper::TimedScope scope(
+                    m_parallelizationOptions, verbosityLevel,
+                    "H-LU decomposition");
+        hMatrixLuDecompose(*m_lu, delta, maximumRank);
+    }
+
+    if (verbosityLevel >= VerbosityLevel::DEFAULT) {
+        size_t origMemory = sizeof(ValueType) *
+                m_lu->rowCount() * m_lu->columnCount();
+        size_t luMemory = sizeof(ValueType) * m_lu->storedEntryCount();
+        std::cout << "\nNeeded storage: "
+                  << luMemory / 1024. / 1024. << " MB.\n"
+                  << "Without approximation: "
+                  << origMemory / 1024. / 1024. << " MB.\n"
+                  << "Compressed to "
+                  << (100. * luMemory) / origMemory << "%.\n"
+                  << "Maximum rank: " << m_lu->maximumRank() << ".\n"
+                  << std::endl;
+    }
+}
+
+template <typename ValueType>
+HMatrixApproximateLuInverse<ValueType>::~HMatrixApproximateLuInverse()
+{
+}
+
+template <typename ValueType>
+unsigned int HMatrixApproximateLuInverse<ValueType>::rowCount() const
+{
+    return m_lu->columnCount();
+}
+
+template <typename ValueType>
+unsigned int HMatrixApproximateLuInverse<ValueType>::columnCount() const
+{
+    return m_lu->rowCount();
+}
+
+template <typename ValueType>
+void HMatrixApproximateLuInverse<ValueType>::addBlock(
+        const std::vector<int>& rows, const std::vector<int>& cols,
+        const ValueType alpha, arma::Mat<ValueType>& block) const
+{
+    throw std::runtime_error("HMatrixApproximateLuInverse::addBlock(): "
+                             "not implemented");
+}
+
+#ifdef WITH_TRILINOS
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+HMatrixApproximateLuInverse<ValueType>::domain() const
+{
+    return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+HMatrixApproximateLuInverse<ValueType>::range() const
+{
+    return m_rangeSpace;
+}
+
+template <typename ValueType>
+bool HMatrixApproximateLuInverse<ValueType>::opSupportedImpl(
+        Thyra::EOpTransp M_trans) const
+{
+    return (M_trans == Thyra::NOTRANS);
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+void HMatrixApproximateLuInverse<ValueType>::
+applyBuiltInImpl(const TranspositionMode trans,
+                 const arma::Col<ValueType>& x_in,
+                 arma::Col<ValueType>& y_inout,
+                 const ValueType alpha,
+                 const ValueType beta) const
+{
+    applyBuiltInImplMultiple(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void HMatrixApproximateLuInverse<ValueType>::
+applyBuiltInImplMultiple(const TranspositionMode trans,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta) const
+{
+    if (trans != NO_TRANSPOSE)
+        throw std::runtime_error(
+                "HMatrixApproximateLuInverse::applyBuiltInImpl(): "
+                "transposition modes other than NO_TRANSPOSE are not supported");
+    if (columnCount() != x_in.n_rows || rowCount() != y_inout.n_rows ||
+            x_in.n_cols != y_inout.n_cols)
+        throw std::invalid_argument(
+                "HMatrixApproximateLuInverse::applyBuiltInImpl(): "
+                "incorrect vector length");
+
+    // All right-hand sides are solved for in one go
+    arma::Mat<ValueType> permuted;
+    HMatrixInverseHelper::permuteRows(m_domainPermutation, x_in, permuted);
+    {
+        tbb::task_scheduler_init scheduler(
+                    HMatrixInverseHelper::maxThreadCount(
+                        m_parallelizationOptions));
+        hMatrixLuSolve(*m_lu, permuted);
+    }
+    HMatrixInverseHelper::addUnpermutedRows(m_rangePermutation, permuted,
+                                            alpha, beta, y_inout);
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> > acaOperatorApproximateLuInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
+        double delta)
+{
+    shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> > hMatOp =
+            boost::dynamic_pointer_cast<
+            const DiscreteHMatrixBoundaryOperator<ValueType> >(op);
+    if (hMatOp)
+        return shared_ptr<const DiscreteBoundaryOperator<ValueType> >(
+                    new HMatrixApproximateLuInverse<ValueType>(*hMatOp, delta));
+#ifdef WITH_AHMED
+    shared_ptr<const DiscreteAcaBoundaryOperator<ValueType> > acaOp =
+            DiscreteAcaBoundaryOperator<ValueType>::castToAca(op);
+    shared_ptr<const DiscreteBoundaryOperator<ValueType> > result(
+                new AcaApproximateLuInverse<ValueType>(*acaOp, delta));
+    return result;
+#else
+    throw std::invalid_argument(
+                "acaOperatorApproximateLuInverse(): the operator is not "
+                "stored as a H-matrix (DiscreteHMatrixBoundaryOperator)");
+#endif
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(HMatrixApproximateLuInverse);
+
+#define INSTANTIATE_FREE_FUNCTIONS(RESULT) \
+    template shared_ptr<const DiscreteBoundaryOperator<RESULT> > \
+        acaOperatorApproximateLuInverse( \
+            const shared_ptr<const DiscreteBoundaryOperator<RESULT> >& op, \
+            double delta)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
+
+} // namespace Bempp
@@ -0,0 +1,144 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_approximate_lu_inverse_hpp
+#define bempp_h_matrix_approximate_lu_inverse_hpp
+
+#include "../common/common.hpp"
+
+#include "bempp/common/config_trilinos.hpp"
+#include "discrete_boundary_operator.hpp"
+
+#include "assembly_options.hpp" // actually only ParallelizationOptions are needed
+#include "index_permutation.hpp"
+#include "../common/shared_ptr.hpp"
+#include "../fiber/scalar_traits.hpp"
+#include "../fiber/verbosity_level.hpp"
+
+#include <boost/scoped_ptr.hpp>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceBase_decl.hpp>
+#endif
+
+using Fiber::VerbosityLevel;
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class DiscreteHMatrixBoundaryOperator;
+template <typename ValueType> class HMatrix;
+/** \endcond */
+
+/** \brief LU inverse of a discrete boundary operator stored as a H-matrix.
+ *
+ *  \param[in] op Discrete boundary operator for which to compute the LU inverse.
+ *  \param[in] delta Approximation accuracy of the inverse.
+ *
+ *  \return A shared pointer to a newly allocated discrete boundary operator
+ *  representing the (approximate) LU inverse of \p op and stored as
+ *  an (approximate) LU decomposition of \p op.
+ *
+ *  \p op may be either a DiscreteHMatrixBoundaryOperator (in which case an
+ *  HMatrixApproximateLuInverse is returned) or, if BEM++ has been compiled
+ *  with AHMED, a DiscreteAcaBoundaryOperator (in which case an
+ *  AcaApproximateLuInverse is returned). Smaller values of \p delta yield a
+ *  more accurate inverse, and hence a more effective preconditioner, at the
+ *  price of a longer factorisation and a higher memory consumption. */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> > acaOperatorApproximateLuInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
+        double delta);
+
+/** \ingroup composite_discrete_operators
+ *  \brief Approximate LU decomposition of a H-matrix built into BEM++.
+ *
+ *  This class plays the same role as AcaApproximateLuInverse for operators
+ *  of type DiscreteHMatrixBoundaryOperator. The factorisation and the
+ *  triangular solves are parallelised with TBB (see hMatrixLuDecompose() and
+ *  hMatrixLuSolve()); the number of threads is determined by the
+ *  parallelization options of the factorised operator.
+ */
+template <typename ValueType>
+class HMatrixApproximateLuInverse : public DiscreteBoundaryOperator<ValueType>
+{
+public:
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType MagnitudeType;
+
+    /** \brief Construct an approximate LU decomposition of a H-matrix.
+
+    \param[in] fwdOp  Operator represented internally as a H-matrix. Its row
+                      and column cluster trees must be identical.
+    \param[in] delta  Relative accuracy of the low-rank blocks created during
+                      the factorisation (M. Bebendorf recommends
+                      delta = 0.1 for preconditioning). */
+    HMatrixApproximateLuInverse(
+            const DiscreteHMatrixBoundaryOperator<ValueType>& fwdOp,
+            MagnitudeType delta,
+            VerbosityLevel::Level verbosityLevel = VerbosityLevel::DEFAULT);
+
+    virtual ~HMatrixApproximateLuInverse();
+
+    virtual unsigned int rowCount() const;
+    virtual unsigned int columnCount() const;
+
+    virtual void addBlock(const std::vector<int>& rows,
+                          const std::vector<int>& cols,
+                          const ValueType alpha,
+                          arma::Mat<ValueType>& block) const;
+
+#ifdef WITH_TRILINOS
+public:
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > domain() const;
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > range() const;
+
+protected:
+    virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+#endif
+
+private:
+    virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                  const arma::Col<ValueType>& x_in,
+                                  arma::Col<ValueType>& y_inout,
+                                  const ValueType alpha,
+                                  const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
+
+private:
+    /** \cond PRIVATE */
+    boost::scoped_ptr<HMatrix<ValueType> > m_lu;
+#ifdef WITH_TRILINOS
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_domainSpace;
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_rangeSpace;
+#endif
+    IndexPermutation m_domainPermutation;
+    IndexPermutation m_rangePermutation;
+    ParallelizationOptions m_parallelizationOptions;
+    /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,296 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h_matrix_cluster.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <tbb/mutex.h>
+#include <tbb/parallel_invoke.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Clusters larger than this are split in parallel with their siblings
+const size_t MINIMUM_PARALLEL_CLUSTER_SIZE = 4096;
+
+template <typename CoordinateType>
+inline CoordinateType coordinate(const Point3D<CoordinateType>& point, int axis)
+{
+    return axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+}
+
+template <typename CoordinateType>
+class CoordinateLess
+{
+public:
+    CoordinateLess(const std::vector<Point3D<CoordinateType> >& points, int axis) :
+        m_points(points), m_axis(axis) {
+    }
+
+    bool operator()(unsigned int a, unsigned int b) const {
+        return coordinate(m_points[a], m_axis) < coordinate(m_points[b], m_axis);
+    }
+
+private:
+    const std::vector<Point3D<CoordinateType> >& m_points;
+    int m_axis;
+};
+
+} // namespace
+
+template <typename CoordinateType>
+HMatrixCluster<CoordinateType>::HMatrixCluster(
+        size_t begin, size_t end, int level) :
+    m_begin(begin), m_end(end), m_level(level)
+{
+    for (int d = 0; d < 3; ++d)
+        m_lowerBound[d] = m_upperBound[d] = 0.;
+}
+
+template <typename CoordinateType>
+std::auto_ptr<HMatrixCluster<CoordinateType> >
+HMatrixCluster<CoordinateType>::construct(
+        const std::vector<Point3D<CoordinateType> >& points,
+        unsigned int maximumLeafSize,
+        std::vector<unsigned int>& p2o)
+{
+    if (maximumLeafSize < 1)
+        throw std::invalid_argument("HMatrixCluster::construct(): "
+                                    "maximumLeafSize must be positive");
+    const size_t pointCount = points.size();
+    p2o.resize(pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+        p2o[i] = i;
+    std::auto_ptr<HMatrixCluster> root(new HMatrixCluster(0, pointCount, 0));
+    root->split(points, maximumLeafSize, p2o);
+    return root;
+}
+
+template <typename CoordinateType>
+void HMatrixCluster<CoordinateType>::split(
+        const std::vector<Point3D<CoordinateType> >& points,
+        unsigned int maximumLeafSize,
+        std::vector<unsigned int>& p2o)
+{
+    // Bounding box
+    if (m_begin < m_end) {
+        for (int d = 0; d < 3; ++d) {
+            m_lowerBound[d] = std::numeric_limits<CoordinateType>::max();
+            m_upperBound[d] = -std::numeric_limits<CoordinateType>::max();
+        }
+        for (size_t i = m_begin; i < m_end; ++i)
+            for (int d = 0; d < 3; ++d) {
+                const CoordinateType x = coordinate(points[p2o[i]], d);
+                m_lowerBound[d] = std::min(m_lowerBound[d], x);
+                m_upperBound[d] = std::max(m_upperBound[d], x);
+            }
+    }
+
+    if (size() <= maximumLeafSize)
+        return;
+
+    // Split across the longest side of the bounding box at the median
+    int axis = 0;
+    for (int d = 1; d < 3; ++d)
+        if (m_upperBound[d] - m_lowerBound[d] >
+                m_upperBound[axis] - m_lowerBound[axis])
+            axis = d;
+    const size_t middle = m_begin + size() / 2;
+    std::nth_element(p2o.begin() + m_begin, p2o.begin() + middle,
+                     p2o.begin() + m_end,
+                     CoordinateLess<CoordinateType>(points, axis));
+
+    m_sons[0].reset(new HMatrixCluster(m_begin, middle, m_level + 1));
+    m_sons[1].reset(new HMatrixCluster(middle, m_end, m_level + 1));
+    // The sons operate on disjoint ranges of p2o
+    if (size() >= MINIMUM_PARALLEL_CLUSTER_SIZE)
+        tbb::parallel_invoke(
+                boost::bind(&HMatrixCluster::split, m_sons[0].get(),
+                            boost::cref(points), maximumLeafSize,
+                            boost::ref(p2o)),
+                boost::bind(&HMatrixCluster::split, m_sons[1].get(),
+                            boost::cref(points), maximumLeafSize,
+                            boost::ref(p2o)));
+    else {
+        m_sons[0]->split(points, maximumLeafSize, p2o);
+        m_sons[1]->split(points, maximumLeafSize, p2o);
+    }
+}
+
+template <typename CoordinateType>
+CoordinateType HMatrixCluster<CoordinateType>::diameter() const
+{
+    CoordinateType result = 0.;
+    for (int d = 0; d < 3; ++d)
+        result += (m_upperBound[d] - m_lowerBound[d]) *
+                (m_upperBound[d] - m_lowerBound[d]);
+    return std::sqrt(result);
+}
+
+template <typename CoordinateType>
+CoordinateType HMatrixCluster<CoordinateType>::distance(
+        const HMatrixCluster& other) const
+{
+    CoordinateType result = 0.;
+    for (int d = 0; d < 3; ++d) {
+        const CoordinateType gap = std::max(
+                    CoordinateType(0.),
+                    std::max(m_lowerBound[d] - other.m_upperBound[d],
+                             other.m_lowerBound[d] - m_upperBound[d]));
+        result += gap * gap;
+    }
+    return std::sqrt(result);
+}
+
+template <typename CoordinateType>
+size_t HMatrixCluster<CoordinateType>::clusterCount() const
+{
+    if (isLeaf())
+        return 1;
+    return 1 + m_sons[0]->clusterCount() + m_sons[1]->clusterCount();
+}
+
+template <typename CoordinateType>
+int HMatrixCluster<CoordinateType>::depth() const
+{
+    if (isLeaf())
+        return 0;
+    return 1 + std::max(m_sons[0]->depth(), m_sons[1]->depth());
+}
+
+namespace
+{
+
+template <typename CoordinateType>
+struct SharedClusterTreeData
+{
+    std::vector<Point3D<CoordinateType> > points;
+    unsigned int maximumLeafSize;
+    boost::scoped_ptr<const HMatrixCluster<CoordinateType> > tree;
+    std::vector<unsigned int> p2o;
+};
+
+// Trees handed out by sharedClusterTree(). Entries expire when the last
+// H-matrix using the corresponding tree is destroyed.
+template <typename CoordinateType>
+struct SharedClusterTreeRegistry
+{
+    typedef std::list<boost::weak_ptr<const SharedClusterTreeData<
+                          CoordinateType> > > EntryList;
+    static EntryList entries;
+    static tbb::mutex mutex;
+};
+
+template <typename CoordinateType>
+typename SharedClusterTreeRegistry<CoordinateType>::EntryList
+SharedClusterTreeRegistry<CoordinateType>::entries;
+
+template <typename CoordinateType>
+tbb::mutex SharedClusterTreeRegistry<CoordinateType>::mutex;
+
+template <typename CoordinateType>
+bool arePointsEqual(const std::vector<Point3D<CoordinateType> >& a,
+                    const std::vector<Point3D<CoordinateType> >& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z)
+            return false;
+    return true;
+}
+
+} // namespace
+
+template <typename CoordinateType>
+shared_ptr<const HMatrixCluster<CoordinateType> > sharedClusterTree(
+        const std::vector<Point3D<CoordinateType> >& points,
+        unsigned int maximumLeafSize,
+        shared_ptr<const std::vector<unsigned int> >& p2o)
+{
+    typedef SharedClusterTreeData<CoordinateType> Data;
+    typedef SharedClusterTreeRegistry<CoordinateType> Registry;
+
+    shared_ptr<const Data> data;
+    {
+        tbb::mutex::scoped_lock lock(Registry::mutex);
+        typename Registry::EntryList::iterator it = Registry::entries.begin();
+        while (it != Registry::entries.end()) {
+            shared_ptr<const Data> candidate = it->lock();
+            if (!candidate) {
+                it = Registry::entries.erase(it);
+                continue;
+            }
+            if (candidate->maximumLeafSize == maximumLeafSize &&
+                    arePointsEqual(candidate->points, points)) {
+                data = candidate;
+                break;
+            }
+            ++it;
+        }
+    }
+
+    if (!data) {
+        // Construct the tree outside the critical section; if another thread
+        // builds an identical tree meanwhile, both are kept
+        shared_ptr<Data> newData(new Data);
+        newData->points = points;
+        newData->maximumLeafSize = maximumLeafSize;
+        newData->tree.reset(HMatrixCluster<CoordinateType>::construct(
+                                points, maximumLeafSize, newData->p2o).release());
+        data = newData;
+        tbb::mutex::scoped_lock lock(Registry::mutex);
+        Registry::entries.push_back(data);
+    }
+
+    // The returned pointers share ownership of the whole entry
+    p2o = shared_ptr<const std::vector<unsigned int> >(data, &data->p2o);
+    return shared_ptr<const HMatrixCluster<CoordinateType> >(
+                data, data->tree.get());
+}
+
+#ifdef ENABLE_SINGLE_PRECISION
+template class HMatrixCluster<float>;
+template shared_ptr<const HMatrixCluster<float> > sharedClusterTree(
+        const std::vector<Point3D<float> >& points,
+        unsigned int maximumLeafSize,
+        shared_ptr<const std::vector<unsigned int> >& p2o);
+#endif
+#ifdef ENABLE_DOUBLE_PRECISION
+template class HMatrixCluster<double>;
+template shared_ptr<const HMatrixCluster<double> > sharedClusterTree(
+        const std::vector<Point3D<double> >& points,
+        unsigned int maximumLeafSize,
+        shared_ptr<const std::vector<unsigned int> >& p2o);
+#endif
+
+} // namespace Bempp
@@ -0,0 +1,134 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_cluster_hpp
+#define bempp_h_matrix_cluster_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/shared_ptr.hpp"
+#include "../common/types.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <memory>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Node of a cluster tree used by the native H-matrix engine.
+ *
+ *  A cluster is a contiguous range <tt>[begin(), end())</tt> of indices in
+ *  the permuted ordering of degrees of freedom, together with the
+ *  axis-aligned bounding box of the positions of these DOFs. Non-leaf clusters
+ *  have exactly two sons, obtained by splitting the parent's bounding box
+ *  across its longest side at the median DOF position.
+ *
+ *  Cluster trees are constructed by the static function construct(). */
+template <typename CoordinateType>
+class HMatrixCluster : private boost::noncopyable
+{
+public:
+    /** \brief Construct a cluster tree.
+     *
+     *  \param[in] points
+     *    Positions of the degrees of freedom (in the original ordering).
+     *  \param[in] maximumLeafSize
+     *    Clusters containing more than this number of DOFs are split.
+     *  \param[out] p2o
+     *    On exit, the map from permuted to original DOF indices.
+     *
+     *  \return The root of the newly constructed tree. Large subtrees are
+     *  constructed in parallel. */
+    static std::auto_ptr<HMatrixCluster> construct(
+            const std::vector<Point3D<CoordinateType> >& points,
+            unsigned int maximumLeafSize,
+            std::vector<unsigned int>& p2o);
+
+    /** \brief Index of the first DOF (in the permuted ordering). */
+    size_t begin() const { return m_begin; }
+    /** \brief Index following that of the last DOF (in the permuted ordering). */
+    size_t end() const { return m_end; }
+    /** \brief Number of DOFs belonging to this cluster. */
+    size_t size() const { return m_end - m_begin; }
+    /** \brief Depth of this cluster in the tree (the root has level 0). */
+    int level() const { return m_level; }
+
+    /** \brief Return true if this cluster has no sons. */
+    bool isLeaf() const { return !m_sons[0]; }
+    /** \brief Return the son number \p i (0 or 1). */
+    const HMatrixCluster& son(int i) const { return *m_sons[i]; }
+
+    /** \brief Lower corner of the bounding box. */
+    const CoordinateType* lowerBound() const { return m_lowerBound; }
+    /** \brief Upper corner of the bounding box. */
+    const CoordinateType* upperBound() const { return m_upperBound; }
+
+    /** \brief Length of the diagonal of the bounding box. */
+    CoordinateType diameter() const;
+    /** \brief Distance between the bounding boxes of this and another cluster. */
+    CoordinateType distance(const HMatrixCluster& other) const;
+
+    /** \brief Number of clusters in the subtree rooted at this cluster. */
+    size_t clusterCount() const;
+    /** \brief Depth of the subtree rooted at this cluster. */
+    int depth() const;
+
+private:
+    HMatrixCluster(size_t begin, size_t end, int level);
+
+    void split(const std::vector<Point3D<CoordinateType> >& points,
+               unsigned int maximumLeafSize,
+               std::vector<unsigned int>& p2o);
+
+private:
+    /** \cond PRIVATE */
+    size_t m_begin, m_end;
+    int m_level;
+    CoordinateType m_lowerBound[3], m_upperBound[3];
+    boost::scoped_ptr<HMatrixCluster> m_sons[2];
+    /** \endcond */
+};
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Return a cluster tree for the DOFs located at \p points.
+ *
+ *  Trees constructed by this function are remembered for as long as they are
+ *  in use. A later call with identical \p points and \p maximumLeafSize
+ *  returns the existing tree instead of building a new one, so that
+ *  operators assembled on the same space (for example the operator of a
+ *  linear system and its preconditioner) share their cluster trees.
+ *
+ *  \param[out] p2o
+ *    On exit, the map from permuted to original DOF indices. It remains
+ *    valid for as long as the returned tree is alive.
+ *
+ *  This function is thread-safe. */
+template <typename CoordinateType>
+shared_ptr<const HMatrixCluster<CoordinateType> > sharedClusterTree(
+        const std::vector<Point3D<CoordinateType> >& points,
+        unsigned int maximumLeafSize,
+        shared_ptr<const std::vector<unsigned int> >& p2o);
+
+} // namespace Bempp
+
+#endif
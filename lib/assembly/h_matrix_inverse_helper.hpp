@@ -0,0 +1,134 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_inverse_helper_hpp
+#define bempp_h_matrix_inverse_helper_hpp
+
+#include "../common/common.hpp"
+
+#include "assembly_options.hpp" // actually only ParallelizationOptions are needed
+#include "index_permutation.hpp"
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/verbosity_level.hpp"
+
+#include <cctype>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <tbb/task_scheduler_init.h>
+#include <tbb/tick_count.h>
+
+namespace Bempp
+{
+
+using Fiber::VerbosityLevel;
+
+/** \ingroup composite_discrete_operators
+ *  \brief Utility functions used by the preconditioners built from
+ *  H-matrices, such as HMatrixApproximateLuInverse.
+ *
+ *  These are internal routines; they are not part of the public interface of
+ *  BEM++ and may change at any time.
+ */
+struct HMatrixInverseHelper
+{
+    /** \brief Number of threads to be used by TBB according to
+     *  \p parallelizationOptions. */
+    static int maxThreadCount(
+            const ParallelizationOptions& parallelizationOptions) {
+        if (parallelizationOptions.isOpenClEnabled())
+            return 1;
+        if (parallelizationOptions.maxThreadCount() ==
+                ParallelizationOptions::AUTO)
+            return tbb::task_scheduler_init::automatic;
+        return parallelizationOptions.maxThreadCount();
+    }
+
+    /** \brief Parallel region of the construction of a preconditioner.
+     *
+     *  Limits the number of TBB threads according to the parallelization
+     *  options for the lifetime of the object and, if the verbosity level is
+     *  at least DEFAULT, reports the start of the construction and, on
+     *  (normal) exit from the scope, the time it took. */
+    class TimedScope
+    {
+    public:
+        TimedScope(const ParallelizationOptions& parallelizationOptions,
+                   VerbosityLevel::Level verbosityLevel,
+                   const std::string& description) :
+            m_scheduler(maxThreadCount(parallelizationOptions)),
+            m_verbose(verbosityLevel >= VerbosityLevel::DEFAULT),
+            m_description(description) {
+            if (m_verbose)
+                std::cout << "Starting " << m_description << "..." << std::endl;
+            m_start = tbb::tick_count::now();
+        }
+
+        ~TimedScope() {
+            if (!m_verbose || std::uncaught_exception())
+                return;
+            tbb::tick_count end = tbb::tick_count::now();
+            std::string description = m_description;
+            if (!description.empty())
+                description[0] = std::toupper(description[0]);
+            std::cout << description << " took "
+                      << (end - m_start).seconds() << " s" << std::endl;
+        }
+
+    private:
+        tbb::task_scheduler_init m_scheduler;
+        bool m_verbose;
+        std::string m_description;
+        tbb::tick_count m_start;
+    };
+
+    /** \brief Copy the rows of \p in to the rows of \p out with the
+     *  indices given by \p permutation. */
+    template <typename ValueType>
+    static void permuteRows(const IndexPermutation& permutation,
+                            const arma::Mat<ValueType>& in,
+                            arma::Mat<ValueType>& out) {
+        out.set_size(in.n_rows, in.n_cols);
+        for (size_t c = 0; c < in.n_cols; ++c)
+            for (size_t i = 0; i < in.n_rows; ++i)
+                out(permutation.permuted(i), c) = in(i, c);
+    }
+
+    /** \brief Set \p y to <tt>alpha * P^T permuted + beta * y</tt>, where P
+     *  is the permutation matrix corresponding to \p permutation. */
+    template <typename ValueType>
+    static void addUnpermutedRows(const IndexPermutation& permutation,
+                                  const arma::Mat<ValueType>& permuted,
+                                  ValueType alpha, ValueType beta,
+                                  arma::Mat<ValueType>& y) {
+        if (beta == static_cast<ValueType>(0.))
+            y.fill(static_cast<ValueType>(0.));
+        else
+            y *= beta;
+        for (size_t c = 0; c < y.n_cols; ++c)
+            for (size_t i = 0; i < y.n_rows; ++i)
+                y(i, c) += alpha * permuted(permutation.permuted(i), c);
+    }
+};
+
+} // namespace Bempp
+
+#endif
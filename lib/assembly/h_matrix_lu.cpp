@@ -0,0 +1,581 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h_matrix_lu.hpp"
+
+#include "h_matrix.hpp"
+#include "h_matrix_aca.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <tbb/parallel_invoke.h>
+
+namespace Bempp
+{
+
+// The LU decomposition follows the recursive algorithm described e.g. in
+// M. Bebendorf, "Hierarchical Matrices", Springer 2008, chapter 2. All
+// matrix arguments of the helper functions below are stored in blocks of the
+// same H-matrix, and row and column indices are global (i.e. they refer to
+// the whole matrix in its permuted ordering). Dense matrices passed together
+// with an "offset" store the rows (or columns) with global indices starting
+// at that offset.
+
+namespace
+{
+
+// Operations on blocks with fewer entries are not split into parallel tasks
+const size_t MINIMUM_PARALLEL_BLOCK_SIZE = 65536;
+
+template <typename ValueType>
+inline bool isLarge(const HMatrixBlock<ValueType>& block)
+{
+    return block.rowCount() * block.columnCount() >= MINIMUM_PARALLEL_BLOCK_SIZE;
+}
+
+template <typename ValueType>
+void addProduct(const HMatrixBlock<ValueType>& a,
+                const arma::Mat<ValueType>& x, size_t xOffset,
+                arma::Mat<ValueType>& y, size_t yOffset, ValueType alpha);
+
+// y(rows(a(row, :)), :) += alpha * a(row, :) * x(columns(a), :)
+template <typename ValueType>
+void addProductOfBlockRow(const HMatrixBlock<ValueType>& a, int row,
+                          const arma::Mat<ValueType>& x, size_t xOffset,
+                          arma::Mat<ValueType>& y, size_t yOffset,
+                          ValueType alpha)
+{
+    for (int j = 0; j < 2; ++j)
+        addProduct(a.son(row, j), x, xOffset, y, yOffset, alpha);
+}
+
+// y(rows(a), :) += alpha * a * x(columns(a), :)
+template <typename ValueType>
+void addProduct(const HMatrixBlock<ValueType>& a,
+                const arma::Mat<ValueType>& x, size_t xOffset,
+                arma::Mat<ValueType>& y, size_t yOffset, ValueType alpha)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    if (a.type() == Block::SUBDIVIDED) {
+        if (isLarge(a))
+            // The two block rows update disjoint rows of y
+            tbb::parallel_invoke(
+                    boost::bind(addProductOfBlockRow<ValueType>, boost::cref(a),
+                                0, boost::cref(x), xOffset, boost::ref(y),
+                                yOffset, alpha),
+                    boost::bind(addProductOfBlockRow<ValueType>, boost::cref(a),
+                                1, boost::cref(x), xOffset, boost::ref(y),
+                                yOffset, alpha));
+        else
+            for (int i = 0; i < 2; ++i)
+                addProductOfBlockRow(a, i, x, xOffset, y, yOffset, alpha);
+        return;
+    }
+    if (a.rowCount() == 0 || a.columnCount() == 0 || x.n_cols == 0 ||
+            (a.type() == Block::LOW_RANK && a.rank() == 0))
+        return;
+    const size_t xFirst = a.columnBegin() - xOffset;
+    const size_t yFirst = a.rowBegin() - yOffset;
+    const arma::Mat<ValueType> xPart =
+            x.rows(xFirst, xFirst + a.columnCount() - 1);
+    arma::Mat<ValueType> product;
+    if (a.type() == Block::DENSE)
+        product = a.dense() * xPart;
+    else
+        product = a.lowRankU() * (a.lowRankV() * xPart);
+    y.rows(yFirst, yFirst + a.rowCount() - 1) += alpha * product;
+}
+
+// y(:, columns(a)) += alpha * x(:, rows(a)) * a
+template <typename ValueType>
+void addProductRight(const arma::Mat<ValueType>& x, size_t xOffset,
+                     const HMatrixBlock<ValueType>& a,
+                     arma::Mat<ValueType>& y, size_t yOffset, ValueType alpha)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    if (a.type() == Block::SUBDIVIDED) {
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                addProductRight(x, xOffset, a.son(i, j), y, yOffset, alpha);
+        return;
+    }
+    if (a.rowCount() == 0 || a.columnCount() == 0 || x.n_rows == 0 ||
+            (a.type() == Block::LOW_RANK && a.rank() == 0))
+        return;
+    const size_t xFirst = a.rowBegin() - xOffset;
+    const size_t yFirst = a.columnBegin() - yOffset;
+    const arma::Mat<ValueType> xPart =
+            x.cols(xFirst, xFirst + a.rowCount() - 1);
+    arma::Mat<ValueType> product;
+    if (a.type() == Block::DENSE)
+        product = xPart * a.dense();
+    else
+        product = (xPart * a.lowRankU()) * a.lowRankV();
+    y.cols(yFirst, yFirst + a.columnCount() - 1) += alpha * product;
+}
+
+template <typename ValueType>
+const arma::Mat<ValueType>& diagonalLeafData(const HMatrixBlock<ValueType>& block)
+{
+    if (block.type() != HMatrixBlock<ValueType>::DENSE)
+        throw std::logic_error("hMatrixLuDecompose(): "
+                               "diagonal leaves must be dense");
+    return block.dense();
+}
+
+// x(rows(l), :) := l^{-1} * x(rows(l), :), l unit lower triangular
+template <typename ValueType>
+void solveLowerDense(const HMatrixBlock<ValueType>& l,
+                     arma::Mat<ValueType>& x, size_t xOffset)
+{
+    if (!l.isLeaf()) {
+        solveLowerDense(l.son(0, 0), x, xOffset);
+        addProduct(l.son(1, 0), x, xOffset, x, xOffset, ValueType(-1.));
+        solveLowerDense(l.son(1, 1), x, xOffset);
+        return;
+    }
+    const arma::Mat<ValueType>& data = diagonalLeafData(l);
+    const size_t first = l.rowBegin() - xOffset;
+    const size_t n = l.rowCount();
+    for (size_t c = 0; c < x.n_cols; ++c)
+        for (size_t i = 1; i < n; ++i) {
+            ValueType sum = 0.;
+            for (size_t k = 0; k < i; ++k)
+                sum += data(i, k) * x(first + k, c);
+            x(first + i, c) -= sum;
+        }
+}
+
+// x(rows(u), :) := u^{-1} * x(rows(u), :), u upper triangular
+template <typename ValueType>
+void solveUpperDense(const HMatrixBlock<ValueType>& u,
+                     arma::Mat<ValueType>& x, size_t xOffset)
+{
+    if (!u.isLeaf()) {
+        solveUpperDense(u.son(1, 1), x, xOffset);
+        addProduct(u.son(0, 1), x, xOffset, x, xOffset, ValueType(-1.));
+        solveUpperDense(u.son(0, 0), x, xOffset);
+        return;
+    }
+    const arma::Mat<ValueType>& data = diagonalLeafData(u);
+    const size_t first = u.rowBegin() - xOffset;
+    const size_t n = u.rowCount();
+    for (size_t c = 0; c < x.n_cols; ++c)
+        for (size_t i = n; i-- > 0; ) {
+            ValueType sum = x(first + i, c);
+            for (size_t k = i + 1; k < n; ++k)
+                sum -= data(i, k) * x(first + k, c);
+            x(first + i, c) = sum / data(i, i);
+        }
+}
+
+// x(:, columns(u)) := x(:, columns(u)) * u^{-1}, u upper triangular
+template <typename ValueType>
+void solveUpperRightDense(const HMatrixBlock<ValueType>& u,
+                          arma::Mat<ValueType>& x, size_t xOffset)
+{
+    if (!u.isLeaf()) {
+        solveUpperRightDense(u.son(0, 0), x, xOffset);
+        addProductRight(x, xOffset, u.son(0, 1), x, xOffset, ValueType(-1.));
+        solveUpperRightDense(u.son(1, 1), x, xOffset);
+        return;
+    }
+    const arma::Mat<ValueType>& data = diagonalLeafData(u);
+    const size_t first = u.columnBegin() - xOffset;
+    const size_t n = u.columnCount();
+    for (size_t j = 0; j < n; ++j)
+        for (size_t r = 0; r < x.n_rows; ++r) {
+            ValueType sum = x(r, first + j);
+            for (size_t k = 0; k < j; ++k)
+                sum -= x(r, first + k) * data(k, j);
+            x(r, first + j) = sum / data(j, j);
+        }
+}
+
+// Unpivoted LU decomposition of a dense matrix
+template <typename ValueType>
+void denseLu(arma::Mat<ValueType>& a)
+{
+    const size_t n = a.n_rows;
+    for (size_t k = 0; k < n; ++k) {
+        const ValueType pivot = a(k, k);
+        if (pivot == static_cast<ValueType>(0.))
+            throw std::runtime_error("hMatrixLuDecompose(): "
+                                     "zero pivot encountered");
+        for (size_t i = k + 1; i < n; ++i)
+            a(i, k) /= pivot;
+        for (size_t j = k + 1; j < n; ++j)
+            for (size_t i = k + 1; i < n; ++i)
+                a(i, j) -= a(i, k) * a(k, j);
+    }
+}
+
+// Append alpha * (du, dv) to the low-rank matrix (u, v); du and dv cover
+// the rows starting at rowOffset and the columns starting at columnOffset
+template <typename ValueType>
+void appendLowRank(arma::Mat<ValueType>& u, arma::Mat<ValueType>& v,
+                   const arma::Mat<ValueType>& du, const arma::Mat<ValueType>& dv,
+                   size_t rowOffset, size_t columnOffset, ValueType alpha)
+{
+    const size_t oldRank = u.n_cols, extraRank = du.n_cols;
+    if (extraRank == 0)
+        return;
+    arma::Mat<ValueType> newU(u.n_rows, oldRank + extraRank);
+    arma::Mat<ValueType> newV(oldRank + extraRank, v.n_cols);
+    newU.fill(0.);
+    newV.fill(0.);
+    for (size_t l = 0; l < oldRank; ++l)
+        for (size_t i = 0; i < u.n_rows; ++i)
+            newU(i, l) = u(i, l);
+    for (size_t j = 0; j < v.n_cols; ++j)
+        for (size_t l = 0; l < oldRank; ++l)
+            newV(l, j) = v(l, j);
+    for (size_t l = 0; l < extraRank; ++l)
+        for (size_t i = 0; i < du.n_rows; ++i)
+            newU(rowOffset + i, oldRank + l) = alpha * du(i, l);
+    for (size_t j = 0; j < dv.n_cols; ++j)
+        for (size_t l = 0; l < extraRank; ++l)
+            newV(oldRank + l, columnOffset + j) = dv(l, j);
+    u = newU;
+    v = newV;
+}
+
+// Low-rank approximation (u, v) of the product a * b
+template <typename ValueType>
+void productToLowRank(const HMatrixBlock<ValueType>& a,
+                      const HMatrixBlock<ValueType>& b,
+                      double eps, size_t maximumRank,
+                      arma::Mat<ValueType>& u, arma::Mat<ValueType>& v)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    const ValueType one = 1.;
+    if (a.type() == Block::LOW_RANK) {
+        u = a.lowRankU();
+        v.set_size(a.rank(), b.columnCount());
+        v.fill(0.);
+        addProductRight(a.lowRankV(), a.columnBegin(), b, v, b.columnBegin(), one);
+    } else if (b.type() == Block::LOW_RANK) {
+        u.set_size(a.rowCount(), b.rank());
+        u.fill(0.);
+        addProduct(a, b.lowRankU(), b.rowBegin(), u, a.rowBegin(), one);
+        v = b.lowRankV();
+    } else if (a.type() == Block::DENSE || b.type() == Block::DENSE) {
+        arma::Mat<ValueType> product(a.rowCount(), b.columnCount());
+        product.fill(0.);
+        if (a.type() == Block::DENSE)
+            addProductRight(a.dense(), a.columnBegin(), b,
+                            product, b.columnBegin(), one);
+        else
+            addProduct(a, b.dense(), b.rowBegin(),
+                       product, a.rowBegin(), one);
+        denseToLowRank(product, eps, maximumRank, u, v);
+    } else {
+        u.set_size(a.rowCount(), 0);
+        v.set_size(0, b.columnCount());
+        arma::Mat<ValueType> sonU, sonV;
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                for (int k = 0; k < 2; ++k) {
+                    const Block& aSon = a.son(i, k);
+                    const Block& bSon = b.son(k, j);
+                    productToLowRank(aSon, bSon, eps, maximumRank, sonU, sonV);
+                    appendLowRank(u, v, sonU, sonV,
+                                  aSon.rowBegin() - a.rowBegin(),
+                                  bSon.columnBegin() - b.columnBegin(), one);
+                    truncateLowRank(u, v, eps, maximumRank);
+                }
+    }
+}
+
+// p += alpha * a * b, where p(0, 0) corresponds to the entry
+// (rowOffset, columnOffset) of the whole matrix; the product is exact
+template <typename ValueType>
+void addProductToDense(const HMatrixBlock<ValueType>& a,
+                       const HMatrixBlock<ValueType>& b,
+                       arma::Mat<ValueType>& p,
+                       size_t rowOffset, size_t columnOffset, ValueType alpha)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    if (a.type() == Block::SUBDIVIDED && b.type() == Block::SUBDIVIDED) {
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+                for (int k = 0; k < 2; ++k)
+                    addProductToDense(a.son(i, k), b.son(k, j), p,
+                                      rowOffset, columnOffset, alpha);
+        return;
+    }
+    if (a.rowCount() == 0 || b.columnCount() == 0)
+        return;
+    arma::Mat<ValueType> product(a.rowCount(), b.columnCount());
+    product.fill(0.);
+    if (a.type() == Block::DENSE)
+        addProductRight(a.dense(), a.columnBegin(), b,
+                        product, b.columnBegin(), ValueType(1.));
+    else if (b.type() == Block::DENSE)
+        addProduct(a, b.dense(), b.rowBegin(),
+                   product, a.rowBegin(), ValueType(1.));
+    else {
+        // One of the factors is low-rank, so no truncation takes place
+        arma::Mat<ValueType> u, v;
+        productToLowRank(a, b, 0., a.rowCount() + b.columnCount(), u, v);
+        if (u.n_cols > 0)
+            product = u * v;
+    }
+    const size_t firstRow = a.rowBegin() - rowOffset;
+    const size_t firstColumn = b.columnBegin() - columnOffset;
+    p.submat(firstRow, firstColumn,
+             firstRow + a.rowCount() - 1, firstColumn + b.columnCount() - 1) +=
+            alpha * product;
+}
+
+// c += alpha * (u, v)
+template <typename ValueType>
+void addLowRank(HMatrixBlock<ValueType>& c,
+                const arma::Mat<ValueType>& u, const arma::Mat<ValueType>& v,
+                ValueType alpha, double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    if (u.n_cols == 0 || c.rowCount() == 0 || c.columnCount() == 0)
+        return;
+    switch (c.type()) {
+    case Block::SUBDIVIDED:
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i) {
+                Block& son = c.son(i, j);
+                if (son.rowCount() == 0 || son.columnCount() == 0)
+                    continue;
+                const size_t firstRow = son.rowBegin() - c.rowBegin();
+                const size_t firstColumn = son.columnBegin() - c.columnBegin();
+                const arma::Mat<ValueType> sonU =
+                        u.rows(firstRow, firstRow + son.rowCount() - 1);
+                const arma::Mat<ValueType> sonV =
+                        v.cols(firstColumn, firstColumn + son.columnCount() - 1);
+                addLowRank(son, sonU, sonV, alpha, eps, maximumRank);
+            }
+        break;
+    case Block::DENSE:
+        c.dense() += alpha * (u * v);
+        break;
+    case Block::LOW_RANK: {
+        arma::Mat<ValueType> newU = c.lowRankU(), newV = c.lowRankV();
+        appendLowRank(newU, newV, u, v, 0, 0, alpha);
+        truncateLowRank(newU, newV, eps, maximumRank);
+        c.setLowRank(newU, newV);
+        break;
+    }
+    }
+}
+
+template <typename ValueType>
+void multiplyAdd(HMatrixBlock<ValueType>& c,
+                 const HMatrixBlock<ValueType>& a,
+                 const HMatrixBlock<ValueType>& b,
+                 ValueType alpha, double eps, size_t maximumRank);
+
+// c(i, j) += alpha * sum_k a(i, k) * b(k, j)
+template <typename ValueType>
+void multiplyAddSon(HMatrixBlock<ValueType>& c,
+                    const HMatrixBlock<ValueType>& a,
+                    const HMatrixBlock<ValueType>& b,
+                    int i, int j,
+                    ValueType alpha, double eps, size_t maximumRank)
+{
+    for (int k = 0; k < 2; ++k)
+        multiplyAdd(c.son(i, j), a.son(i, k), b.son(k, j),
+                    alpha, eps, maximumRank);
+}
+
+// c += alpha * a * b
+template <typename ValueType>
+void multiplyAdd(HMatrixBlock<ValueType>& c,
+                 const HMatrixBlock<ValueType>& a,
+                 const HMatrixBlock<ValueType>& b,
+                 ValueType alpha, double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    if (c.type() == Block::SUBDIVIDED && a.type() == Block::SUBDIVIDED &&
+            b.type() == Block::SUBDIVIDED) {
+        // The four sons of c are updated independently
+        if (isLarge(c))
+            tbb::parallel_invoke(
+                    boost::bind(multiplyAddSon<ValueType>, boost::ref(c),
+                                boost::cref(a), boost::cref(b), 0, 0,
+                                alpha, eps, maximumRank),
+                    boost::bind(multiplyAddSon<ValueType>, boost::ref(c),
+                                boost::cref(a), boost::cref(b), 1, 0,
+                                alpha, eps, maximumRank),
+                    boost::bind(multiplyAddSon<ValueType>, boost::ref(c),
+                                boost::cref(a), boost::cref(b), 0, 1,
+                                alpha, eps, maximumRank),
+                    boost::bind(multiplyAddSon<ValueType>, boost::ref(c),
+                                boost::cref(a), boost::cref(b), 1, 1,
+                                alpha, eps, maximumRank));
+        else
+            for (int j = 0; j < 2; ++j)
+                for (int i = 0; i < 2; ++i)
+                    multiplyAddSon(c, a, b, i, j, alpha, eps, maximumRank);
+    } else if (c.type() == Block::DENSE)
+        addProductToDense(a, b, c.dense(), c.rowBegin(), c.columnBegin(), alpha);
+    else {
+        arma::Mat<ValueType> u, v;
+        productToLowRank(a, b, eps, maximumRank, u, v);
+        addLowRank(c, u, v, alpha, eps, maximumRank);
+    }
+}
+
+// b := l^{-1} * b, l unit lower triangular
+template <typename ValueType>
+void solveLower(const HMatrixBlock<ValueType>& l, HMatrixBlock<ValueType>& b,
+                double eps, size_t maximumRank);
+
+template <typename ValueType>
+void solveLowerColumn(const HMatrixBlock<ValueType>& l,
+                      HMatrixBlock<ValueType>& b, int j,
+                      double eps, size_t maximumRank)
+{
+    solveLower(l.son(0, 0), b.son(0, j), eps, maximumRank);
+    multiplyAdd(b.son(1, j), l.son(1, 0), b.son(0, j),
+                ValueType(-1.), eps, maximumRank);
+    solveLower(l.son(1, 1), b.son(1, j), eps, maximumRank);
+}
+
+template <typename ValueType>
+void solveLower(const HMatrixBlock<ValueType>& l, HMatrixBlock<ValueType>& b,
+                double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    switch (b.type()) {
+    case Block::DENSE:
+        solveLowerDense(l, b.dense(), b.rowBegin());
+        break;
+    case Block::LOW_RANK:
+        solveLowerDense(l, b.lowRankU(), b.rowBegin());
+        break;
+    case Block::SUBDIVIDED:
+        // The two block columns of b are independent
+        if (isLarge(b))
+            tbb::parallel_invoke(
+                    boost::bind(solveLowerColumn<ValueType>, boost::cref(l),
+                                boost::ref(b), 0, eps, maximumRank),
+                    boost::bind(solveLowerColumn<ValueType>, boost::cref(l),
+                                boost::ref(b), 1, eps, maximumRank));
+        else
+            for (int j = 0; j < 2; ++j)
+                solveLowerColumn(l, b, j, eps, maximumRank);
+        break;
+    }
+}
+
+// b := b * u^{-1}, u upper triangular
+template <typename ValueType>
+void solveUpperRight(const HMatrixBlock<ValueType>& u, HMatrixBlock<ValueType>& b,
+                     double eps, size_t maximumRank);
+
+template <typename ValueType>
+void solveUpperRightRow(const HMatrixBlock<ValueType>& u,
+                        HMatrixBlock<ValueType>& b, int i,
+                        double eps, size_t maximumRank)
+{
+    solveUpperRight(u.son(0, 0), b.son(i, 0), eps, maximumRank);
+    multiplyAdd(b.son(i, 1), b.son(i, 0), u.son(0, 1),
+                ValueType(-1.), eps, maximumRank);
+    solveUpperRight(u.son(1, 1), b.son(i, 1), eps, maximumRank);
+}
+
+template <typename ValueType>
+void solveUpperRight(const HMatrixBlock<ValueType>& u, HMatrixBlock<ValueType>& b,
+                     double eps, size_t maximumRank)
+{
+    typedef HMatrixBlock<ValueType> Block;
+    switch (b.type()) {
+    case Block::DENSE:
+        solveUpperRightDense(u, b.dense(), b.columnBegin());
+        break;
+    case Block::LOW_RANK:
+        solveUpperRightDense(u, b.lowRankV(), b.columnBegin());
+        break;
+    case Block::SUBDIVIDED:
+        // The two block rows of b are independent
+        if (isLarge(b))
+            tbb::parallel_invoke(
+                    boost::bind(solveUpperRightRow<ValueType>, boost::cref(u),
+                                boost::ref(b), 0, eps, maximumRank),
+                    boost::bind(solveUpperRightRow<ValueType>, boost::cref(u),
+                                boost::ref(b), 1, eps, maximumRank));
+        else
+            for (int i = 0; i < 2; ++i)
+                solveUpperRightRow(u, b, i, eps, maximumRank);
+        break;
+    }
+}
+
+template <typename ValueType>
+void luDecompose(HMatrixBlock<ValueType>& a, double eps, size_t maximumRank)
+{
+    if (a.isLeaf()) {
+        if (a.type() != HMatrixBlock<ValueType>::DENSE)
+            a.convertToDense();
+        denseLu(a.dense());
+        return;
+    }
+    luDecompose(a.son(0, 0), eps, maximumRank);
+    tbb::parallel_invoke(
+            boost::bind(solveLower<ValueType>, boost::cref(a.son(0, 0)),
+                        boost::ref(a.son(0, 1)), eps, maximumRank),
+            boost::bind(solveUpperRight<ValueType>, boost::cref(a.son(0, 0)),
+                        boost::ref(a.son(1, 0)), eps, maximumRank));
+    multiplyAdd(a.son(1, 1), a.son(1, 0), a.son(0, 1),
+                ValueType(-1.), eps, maximumRank);
+    luDecompose(a.son(1, 1), eps, maximumRank);
+}
+
+} // namespace
+
+template <typename ValueType>
+void hMatrixLuDecompose(HMatrix<ValueType>& matrix,
+                        double eps, size_t maximumRank)
+{
+    if (matrix.rowClusterTree() != matrix.columnClusterTree())
+        throw std::invalid_argument("hMatrixLuDecompose(): row and column "
+                                    "cluster trees must be identical");
+    luDecompose(matrix.root(), eps, maximumRank);
+    matrix.updateLeaves();
+}
+
+template <typename ValueType>
+void hMatrixLuSolve(const HMatrix<ValueType>& lu, arma::Mat<ValueType>& x)
+{
+    if (x.n_rows != lu.rowCount())
+        throw std::invalid_argument("hMatrixLuSolve(): "
+                                    "incorrect number of rows");
+    solveLowerDense(lu.root(), x, 0);
+    solveUpperDense(lu.root(), x, 0);
+}
+
+#define INSTANTIATE_FUNCTIONS(VALUE) \
+    template void hMatrixLuDecompose(HMatrix<VALUE>&, double, size_t); \
+    template void hMatrixLuSolve(const HMatrix<VALUE>&, arma::Mat<VALUE>&)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FUNCTIONS);
+
+} // namespace Bempp
@@ -0,0 +1,73 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_lu_hpp
+#define bempp_h_matrix_lu_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class HMatrix;
+/** \endcond */
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Overwrite a HMatrix with its approximate LU decomposition.
+ *
+ *  On exit, the unit lower triangular factor \c L and the upper triangular
+ *  factor \c U are stored in place of the original matrix, in the same way
+ *  as in the LAPACK routine \c getrf. Blocks produced during the
+ *  factorisation are recompressed with relative accuracy \p eps and rank
+ *  limit \p maximumRank.
+ *
+ *  The row and column cluster trees of \p matrix must be identical. No
+ *  pivoting is done, so the method is intended for matrices whose diagonal
+ *  blocks are well conditioned, which is the case for the discretisations of
+ *  most boundary integral operators. Independent block operations are
+ *  executed in parallel.
+ *
+ *  \throws std::invalid_argument if the cluster trees differ.
+ *  \throws std::runtime_error if a zero pivot is encountered. */
+template <typename ValueType>
+void hMatrixLuDecompose(HMatrix<ValueType>& matrix,
+                        double eps, size_t maximumRank);
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Solve a system of equations using an LU decomposition computed by
+ *  hMatrixLuDecompose().
+ *
+ *  \param[in] lu
+ *    Decomposed matrix.
+ *  \param[in,out] x
+ *    On entry, the right-hand sides (one per column) in the permuted ordering
+ *    of \p lu; on exit, the solutions.
+ *
+ *  Products with the off-diagonal blocks of the triangular factors, which
+ *  dominate the cost of the solve, are computed in parallel. */
+template <typename ValueType>
+void hMatrixLuSolve(const HMatrix<ValueType>& lu, arma::Mat<ValueType>& x);
+
+} // namespace Bempp
+
+#endif
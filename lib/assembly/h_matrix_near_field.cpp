@@ -0,0 +1,391 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "h_matrix_near_field.hpp"
+
+#include "h_matrix.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Half-open range [first, second) of indices in the permuted ordering
+typedef std::pair<size_t, size_t> Interval;
+
+void mergeIntervals(std::vector<Interval>& intervals)
+{
+    std::sort(intervals.begin(), intervals.end());
+    size_t merged = 0;
+    for (size_t i = 0; i < intervals.size(); ++i)
+        if (merged > 0 && intervals[i].first <= intervals[merged - 1].second)
+            intervals[merged - 1].second =
+                    std::max(intervals[merged - 1].second, intervals[i].second);
+        else
+            intervals[merged++] = intervals[i];
+    intervals.resize(merged);
+}
+
+void expandIntervals(const std::vector<Interval>& intervals,
+                     std::vector<unsigned int>& indices)
+{
+    indices.clear();
+    for (size_t i = 0; i < intervals.size(); ++i)
+        for (size_t k = intervals[i].first; k < intervals[i].second; ++k)
+            indices.push_back(k);
+}
+
+// Leaf clusters of the cluster tree of a H-matrix together with the
+// inadmissible dense leaves (the near field) of the block row of each of
+// them
+template <typename ValueType>
+class NearField
+{
+public:
+    typedef HMatrixBlock<ValueType> Block;
+    typedef typename HMatrix<ValueType>::Cluster Cluster;
+
+    explicit NearField(const HMatrix<ValueType>& matrix) {
+        if (matrix.rowClusterTree() != matrix.columnClusterTree())
+            throw std::invalid_argument(
+                    "NearField::NearField(): the row and column cluster "
+                    "trees of the H-matrix must be identical");
+        collectLeafClusters(*matrix.rowClusterTree());
+        std::sort(m_clusters.begin(), m_clusters.end());
+
+        m_clusterOf.resize(matrix.rowCount());
+        for (size_t c = 0; c < m_clusters.size(); ++c)
+            for (size_t i = m_clusters[c].first; i < m_clusters[c].second; ++i)
+                m_clusterOf[i] = c;
+
+        m_blockRows.resize(m_clusters.size());
+        const std::vector<const Block*> leaves = matrix.leaves();
+        for (size_t l = 0; l < leaves.size(); ++l) {
+            const Block& leaf = *leaves[l];
+            if (leaf.type() != Block::DENSE || leaf.isAdmissible() ||
+                    leaf.rowCount() == 0 || leaf.columnCount() == 0)
+                continue;
+            const size_t rowEnd = leaf.rowBegin() + leaf.rowCount();
+            for (size_t c = m_clusterOf[leaf.rowBegin()];
+                 c < m_clusters.size() && m_clusters[c].first < rowEnd; ++c)
+                m_blockRows[c].push_back(&leaf);
+        }
+    }
+
+    size_t clusterCount() const { return m_clusters.size(); }
+    const Interval& cluster(size_t c) const { return m_clusters[c]; }
+
+    // Union of the columns of the near field of the given rows, which must
+    // be a union of leaf clusters
+    std::vector<Interval> neighbourhood(const std::vector<Interval>& rows) const {
+        std::vector<Interval> result;
+        for (size_t i = 0; i < rows.size(); ++i)
+            for (size_t c = m_clusterOf[rows[i].first];
+                 c < m_clusters.size() && m_clusters[c].first < rows[i].second;
+                 ++c)
+                for (size_t l = 0; l < m_blockRows[c].size(); ++l) {
+                    const Block& leaf = *m_blockRows[c][l];
+                    result.push_back(Interval(
+                        leaf.columnBegin(),
+                        leaf.columnBegin() + leaf.columnCount()));
+                }
+        mergeIntervals(result);
+        return result;
+    }
+
+    // Near-field submatrix with the given rows and columns, both sorted and
+    // the former being a union of leaf clusters
+    void extract(const std::vector<unsigned int>& rows,
+                 const std::vector<unsigned int>& columns,
+                 arma::Mat<ValueType>& result) const {
+        result.zeros(rows.size(), columns.size());
+        size_t r = 0;
+        while (r < rows.size()) {
+            const size_t c = m_clusterOf[rows[r]];
+            const Interval& cluster = m_clusters[c];
+            for (size_t l = 0; l < m_blockRows[c].size(); ++l) {
+                const Block& leaf = *m_blockRows[c][l];
+                const size_t columnEnd = leaf.columnBegin() + leaf.columnCount();
+                for (size_t k = std::lower_bound(columns.begin(), columns.end(),
+                                                 leaf.columnBegin()) -
+                     columns.begin();
+                     k < columns.size() && columns[k] < columnEnd; ++k)
+                    for (size_t i = cluster.first; i < cluster.second; ++i)
+                        result(r + i - cluster.first, k) = leaf.dense()(
+                                    i - leaf.rowBegin(),
+                                    columns[k] - leaf.columnBegin());
+            }
+            r += cluster.second - cluster.first;
+        }
+    }
+
+private:
+    void collectLeafClusters(const Cluster& cluster) {
+        if (cluster.isLeaf()) {
+            if (cluster.size() > 0)
+                m_clusters.push_back(Interval(cluster.begin(), cluster.end()));
+            return;
+        }
+        for (int i = 0; i < 2; ++i)
+            collectLeafClusters(cluster.son(i));
+    }
+
+private:
+    std::vector<Interval> m_clusters;
+    std::vector<size_t> m_clusterOf;
+    std::vector<std::vector<const Block*> > m_blockRows;
+};
+
+// Computes the rows of a near-field inverse associated with a range of leaf
+// clusters. The rows of cluster c are supported on the neighbourhood of c of
+// order "overlap" and are obtained by solving
+//
+//     A(pattern, fit)^T X = I(fit, cluster)
+//
+// in the least-squares sense, where "fit" is either equal to "pattern" (block
+// Jacobi) or to its neighbourhood (sparse approximate inverse)
+template <typename ValueType>
+class NearFieldInverseLoopBody
+{
+public:
+    NearFieldInverseLoopBody(const NearField<ValueType>& nearField,
+                             int overlap, bool leastSquares,
+                             std::vector<std::vector<unsigned int> >& patterns,
+                             std::vector<arma::Mat<ValueType> >& solutions) :
+        m_nearField(nearField), m_overlap(overlap),
+        m_leastSquares(leastSquares),
+        m_patterns(patterns), m_solutions(solutions) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t c = r.begin(); c != r.end(); ++c) {
+            const Interval& cluster = m_nearField.cluster(c);
+            std::vector<Interval> pattern(1, cluster);
+            for (int level = 0; level < m_overlap; ++level)
+                pattern = m_nearField.neighbourhood(pattern);
+            expandIntervals(pattern, m_patterns[c]);
+            std::vector<unsigned int> fit;
+            if (m_leastSquares)
+                expandIntervals(m_nearField.neighbourhood(pattern), fit);
+            else
+                fit = m_patterns[c];
+
+            arma::Mat<ValueType> block;
+            m_nearField.extract(m_patterns[c], fit, block);
+            const size_t clusterSize = cluster.second - cluster.first;
+            const size_t offset =
+                    std::lower_bound(fit.begin(), fit.end(), cluster.first) -
+                    fit.begin();
+            arma::Mat<ValueType> unit(fit.size(), clusterSize);
+            unit.fill(static_cast<ValueType>(0.));
+            for (size_t i = 0; i < clusterSize; ++i)
+                unit(offset + i, i) = static_cast<ValueType>(1.);
+            if (!arma::solve(m_solutions[c], block.st(), unit))
+                throw std::runtime_error(
+                        "NearFieldInverseLoopBody::operator(): "
+                        "singular near-field block");
+        }
+    }
+
+private:
+    const NearField<ValueType>& m_nearField;
+    int m_overlap;
+    bool m_leastSquares;
+    std::vector<std::vector<unsigned int> >& m_patterns;
+    std::vector<arma::Mat<ValueType> >& m_solutions;
+};
+
+template <typename ValueType>
+std::auto_ptr<CompressedRowMatrix<ValueType> > nearFieldInverse(
+        const HMatrix<ValueType>& matrix, int overlap, bool leastSquares)
+{
+    const NearField<ValueType> nearField(matrix);
+    const size_t clusterCount = nearField.clusterCount();
+    std::vector<std::vector<unsigned int> > patterns(clusterCount);
+    std::vector<arma::Mat<ValueType> > solutions(clusterCount);
+    typedef NearFieldInverseLoopBody<ValueType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, clusterCount),
+                      Body(nearField, overlap, leastSquares,
+                           patterns, solutions));
+
+    // Leaf clusters are sorted, so their rows can be appended in turn
+    std::auto_ptr<CompressedRowMatrix<ValueType> > result(
+                new CompressedRowMatrix<ValueType>(
+                    matrix.columnCount(), matrix.rowCount()));
+    size_t nonzeroCount = 0;
+    for (size_t c = 0; c < clusterCount; ++c)
+        nonzeroCount += patterns[c].size() * solutions[c].n_cols;
+    result->columnIndices.reserve(nonzeroCount);
+    result->values.reserve(nonzeroCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        for (size_t i = 0; i < solutions[c].n_cols; ++i) {
+            for (size_t k = 0; k < patterns[c].size(); ++k) {
+                result->columnIndices.push_back(patterns[c][k]);
+                result->values.push_back(solutions[c](k, i));
+            }
+            result->rowOffsets.push_back(result->values.size());
+        }
+    return result;
+}
+
+// Computes a range of rows of y := alpha * op(A) * x + beta * y for op(A)
+// equal to A or its complex conjugate
+template <typename ValueType>
+class CompressedRowProductLoopBody
+{
+public:
+    CompressedRowProductLoopBody(const CompressedRowMatrix<ValueType>& matrix,
+                                 bool conjugate,
+                                 const arma::Mat<ValueType>& x,
+                                 arma::Mat<ValueType>& y,
+                                 ValueType alpha, ValueType beta) :
+        m_matrix(matrix), m_conjugate(conjugate), m_x(x), m_y(y),
+        m_alpha(alpha), m_beta(beta) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t col = 0; col < m_x.n_cols; ++col)
+            for (size_t row = r.begin(); row != r.end(); ++row) {
+                ValueType sum = 0.;
+                for (size_t k = m_matrix.rowOffsets[row];
+                     k < m_matrix.rowOffsets[row + 1]; ++k) {
+                    const ValueType value = m_conjugate ?
+                                Fiber::conj(m_matrix.values[k]) :
+                                m_matrix.values[k];
+                    sum += value * m_x(m_matrix.columnIndices[k], col);
+                }
+                if (m_beta == static_cast<ValueType>(0.))
+                    m_y(row, col) = m_alpha * sum;
+                else
+                    m_y(row, col) = m_beta * m_y(row, col) + m_alpha * sum;
+            }
+    }
+
+private:
+    const CompressedRowMatrix<ValueType>& m_matrix;
+    bool m_conjugate;
+    const arma::Mat<ValueType>& m_x;
+    arma::Mat<ValueType>& m_y;
+    ValueType m_alpha, m_beta;
+};
+
+} // namespace
+
+template <typename ValueType>
+CompressedRowMatrix<ValueType>::CompressedRowMatrix(
+        size_t rowCount_, size_t columnCount_) :
+    rowCount(rowCount_), columnCount(columnCount_), rowOffsets(1, 0)
+{
+}
+
+template <typename ValueType>
+void CompressedRowMatrix<ValueType>::apply(
+        TranspositionMode trans,
+        const arma::Mat<ValueType>& x, arma::Mat<ValueType>& y,
+        ValueType alpha, ValueType beta) const
+{
+    const bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    const bool conjugate = (trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE);
+    if (trans != NO_TRANSPOSE && !transpose && !conjugate)
+        throw std::invalid_argument("CompressedRowMatrix::apply(): "
+                                    "invalid transposition mode");
+    if (rowOffsets.size() != rowCount + 1)
+        throw std::logic_error("CompressedRowMatrix::apply(): "
+                               "the matrix is incomplete");
+    if (x.n_rows != (transpose ? rowCount : columnCount) ||
+            y.n_rows != (transpose ? columnCount : rowCount) ||
+            x.n_cols != y.n_cols)
+        throw std::invalid_argument("CompressedRowMatrix::apply(): "
+                                    "incorrect vector length");
+
+    if (!transpose) {
+        typedef CompressedRowProductLoopBody<ValueType> Body;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, rowCount),
+                          Body(*this, conjugate, x, y, alpha, beta));
+        return;
+    }
+
+    // Rows of the transposed matrix are scattered over y, so the product is
+    // computed serially
+    if (beta == static_cast<ValueType>(0.))
+        y.fill(static_cast<ValueType>(0.));
+    else
+        y *= beta;
+    for (size_t col = 0; col < x.n_cols; ++col)
+        for (size_t row = 0; row < rowCount; ++row) {
+            const ValueType factor = alpha * x(row, col);
+            for (size_t k = rowOffsets[row]; k < rowOffsets[row + 1]; ++k)
+                y(columnIndices[k], col) += factor * (conjugate ?
+                    Fiber::conj(values[k]) : values[k]);
+        }
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> CompressedRowMatrix<ValueType>::asMatrix() const
+{
+    arma::Mat<ValueType> result(rowCount, columnCount);
+    result.fill(static_cast<ValueType>(0.));
+    for (size_t row = 0; row + 1 < rowOffsets.size(); ++row)
+        for (size_t k = rowOffsets[row]; k < rowOffsets[row + 1]; ++k)
+            result(row, columnIndices[k]) = values[k];
+    return result;
+}
+
+template <typename ValueType>
+std::auto_ptr<CompressedRowMatrix<ValueType> >
+hMatrixNearFieldSparseApproximateInverse(const HMatrix<ValueType>& matrix)
+{
+    return nearFieldInverse(matrix, 1 /* overlap */, true /* leastSquares */);
+}
+
+template <typename ValueType>
+std::auto_ptr<CompressedRowMatrix<ValueType> >
+hMatrixNearFieldBlockJacobiInverse(const HMatrix<ValueType>& matrix,
+                                   int overlap)
+{
+    if (overlap < 0)
+        throw std::invalid_argument("hMatrixNearFieldBlockJacobiInverse(): "
+                                    "overlap must not be negative");
+    return nearFieldInverse(matrix, overlap, false /* leastSquares */);
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(CompressedRowMatrix);
+
+#define INSTANTIATE_FREE_FUNCTIONS(RESULT) \
+    template std::auto_ptr<CompressedRowMatrix<RESULT> > \
+        hMatrixNearFieldSparseApproximateInverse( \
+            const HMatrix<RESULT>& matrix); \
+    template std::auto_ptr<CompressedRowMatrix<RESULT> > \
+        hMatrixNearFieldBlockJacobiInverse( \
+            const HMatrix<RESULT>& matrix, int overlap)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
+
+} // namespace Bempp
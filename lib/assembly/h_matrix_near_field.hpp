@@ -0,0 +1,117 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_h_matrix_near_field_hpp
+#define bempp_h_matrix_near_field_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "transposition_mode.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class HMatrix;
+/** \endcond */
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Sparse matrix stored in the compressed-row format.
+ *
+ *  The column indices of the nonzero entries of row \c i are stored in
+ *  <tt>columnIndices[rowOffsets[i]]</tt>, ...,
+ *  <tt>columnIndices[rowOffsets[i + 1] - 1]</tt> and their values at the
+ *  same positions of \c values. */
+template <typename ValueType>
+struct CompressedRowMatrix
+{
+    /** \brief Construct an empty matrix (with no nonzero entries). */
+    CompressedRowMatrix(size_t rowCount, size_t columnCount);
+
+    /** \brief Number of nonzero entries. */
+    size_t nonzeroCount() const { return values.size(); }
+
+    /** \brief Compute <tt>y := alpha * op(A) * x + beta * y</tt>.
+     *
+     *  Here \c A is this matrix, \c op is determined by \p trans and \p x
+     *  and \p y may have several columns. Rows of \c A are processed in
+     *  parallel if \p trans is NO_TRANSPOSE or CONJUGATE. */
+    void apply(TranspositionMode trans,
+               const arma::Mat<ValueType>& x, arma::Mat<ValueType>& y,
+               ValueType alpha, ValueType beta) const;
+
+    /** \brief Return the matrix in the dense format. */
+    arma::Mat<ValueType> asMatrix() const;
+
+    size_t rowCount;
+    size_t columnCount;
+    std::vector<size_t> rowOffsets;
+    std::vector<unsigned int> columnIndices;
+    std::vector<ValueType> values;
+};
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Compute a sparse approximate inverse of the near field of a
+ *  H-matrix.
+ *
+ *  The near field of \p matrix is the sparse matrix \f$A_n\f$ made of its
+ *  dense leaf blocks. The returned matrix \f$M\f$ (in the permuted ordering
+ *  of \p matrix) minimises \f$\|M A_n - I\|_F\f$ over matrices whose row
+ *  \c i is supported on the near-field neighbours of \c i, i.e. on the
+ *  columns of the dense blocks of the block row containing \c i. The rows
+ *  associated with a leaf cluster share their sparsity pattern and are
+ *  obtained together from a single dense least-squares problem; different
+ *  leaf clusters are processed in parallel. The setup cost is thus linear
+ *  in the matrix size.
+ *
+ *  \throws std::invalid_argument if the row and column cluster trees of
+ *  \p matrix differ. */
+template <typename ValueType>
+std::auto_ptr<CompressedRowMatrix<ValueType> >
+hMatrixNearFieldSparseApproximateInverse(const HMatrix<ValueType>& matrix);
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Compute an overlapping block-Jacobi inverse of the near field of
+ *  a H-matrix.
+ *
+ *  There is one block per leaf cluster of the cluster tree of \p matrix.
+ *  For \p overlap = 0 the block consists of the DOFs of the cluster only;
+ *  each further level of overlap adds the near-field neighbours of the
+ *  DOFs already in the block. The near-field submatrix associated with each
+ *  block is inverted and the rows of the inverse corresponding to the DOFs
+ *  of the cluster are stored in the returned matrix, i.e. the blocks are
+ *  combined as in the restricted additive Schwarz method. Blocks are
+ *  inverted in parallel.
+ *
+ *  \throws std::invalid_argument if the row and column cluster trees of
+ *  \p matrix differ or \p overlap is negative.
+ *  \throws std::runtime_error if a near-field block is singular. */
+template <typename ValueType>
+std::auto_ptr<CompressedRowMatrix<ValueType> >
+hMatrixNearFieldBlockJacobiInverse(const HMatrix<ValueType>& matrix,
+                                   int overlap);
+
+} // namespace Bempp
+
+#endif
@@ -89,8 +89,10 @@ public:
         output in the current directory.
 
       \param[in] type
-        Output type (default: ASCII). See Dune reference manual for more
-        details. */
+        Output type (default: ASCII). For large grids, the binary types
+        (in particular VtkWriter::APPENDED_RAW_COMPRESSED, available if
+        BEM++ has been built with zlib) produce much smaller files and are
+        written considerably faster. See VtkWriter::OutputType for details. */
     void exportToVtk(const char* dataLabel,
                      const char* fileNamesBase, const char* filesPath = 0,
                      VtkWriter::OutputType type = VtkWriter::ASCII) const;
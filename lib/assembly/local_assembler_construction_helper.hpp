@@ -56,6 +56,7 @@ struct LocalAssemblerConstructionHelper
         view->getRawElementData(
                     rawGeometry->vertices(), rawGeometry->elementCornerIndices(),
                     rawGeometry->auxData());
+        rawGeometry->removeCornerIndexPadding();
         geometryFactory = shared_ptr<GeometryFactory>(
                 grid.elementGeometryFactory().release());
     }
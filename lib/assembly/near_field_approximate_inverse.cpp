@@ -0,0 +1,239 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#include "near_field_approximate_inverse.hpp"
+
+#include "discrete_h_matrix_boundary_operator.hpp"
+#include "h_matrix.hpp"
+#include "h_matrix_inverse_helper.hpp"
+#include "h_matrix_near_field.hpp"
+
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/pointer_cast.hpp>
+#include <tbb/task_scheduler_init.h>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceDefaultBase.hpp>
+#endif
+
+namespace Bempp
+{
+
+template <typename ValueType>
+NearFieldApproximateInverse<ValueType>::NearFieldApproximateInverse(
+        const DiscreteHMatrixBoundaryOperator<ValueType>& fwdOp,
+        Method method, int overlap,
+        VerbosityLevel::Level verbosityLevel) :
+    // All range-domain swaps intended!
+#ifdef WITH_TRILINOS
+    m_domainSpace(Thyra::defaultSpmdVectorSpace<ValueType>(fwdOp.rowCount())),
+    m_rangeSpace(Thyra::defaultSpmdVectorSpace<ValueType>(fwdOp.columnCount())),
+#endif
+    m_domainPermutation(fwdOp.rangePermutation()),
+    m_rangePermutation(fwdOp.domainPermutation()),
+    m_parallelizationOptions(fwdOp.parallelizationOptions())
+{
+    {
+        HMatrixInverseHelper::TimedScope scope(
+                    m_parallelizationOptions, verbosityLevel,
+                    std::string("construction of the near-field ") +
+                    (method == BLOCK_JACOBI ?
+                         "block-Jacobi inverse" : "sparse approximate inverse"));
+        if (method == BLOCK_JACOBI)
+            m_matrix.reset(hMatrixNearFieldBlockJacobiInverse(
+                               *fwdOp.hMatrix(), overlap).release());
+        else
+            m_matrix.reset(hMatrixNearFieldSparseApproximateInverse(
+                               *fwdOp.hMatrix()).release());
+    }
+
+    if (verbosityLevel >= VerbosityLevel::DEFAULT)
+        std::cout << "Nonzero entries per row: "
+                  << double(nonzeroCount()) / std::max(1u, rowCount())
+                  << ".\n" << std::endl;
+}
+
+template <typename ValueType>
+NearFieldApproximateInverse<ValueType>::~NearFieldApproximateInverse()
+{
+}
+
+template <typename ValueType>
+unsigned int NearFieldApproximateInverse<ValueType>::rowCount() const
+{
+    return m_matrix->rowCount;
+}
+
+template <typename ValueType>
+unsigned int NearFieldApproximateInverse<ValueType>::columnCount() const
+{
+    return m_matrix->columnCount;
+}
+
+template <typename ValueType>
+size_t NearFieldApproximateInverse<ValueType>::nonzeroCount() const
+{
+    return m_matrix->nonzeroCount();
+}
+
+template <typename ValueType>
+void NearFieldApproximateInverse<ValueType>::addBlock(
+        const std::vector<int>& rows, const std::vector<int>& cols,
+        const ValueType alpha, arma::Mat<ValueType>& block) const
+{
+    throw std::runtime_error("NearFieldApproximateInverse::addBlock(): "
+                             "not implemented");
+}
+
+#ifdef WITH_TRILINOS
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+NearFieldApproximateInverse<ValueType>::domain() const
+{
+    return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> >
+NearFieldApproximateInverse<ValueType>::range() const
+{
+    return m_rangeSpace;
+}
+
+template <typename ValueType>
+bool NearFieldApproximateInverse<ValueType>::opSupportedImpl(
+        Thyra::EOpTransp M_trans) const
+{
+    return (M_trans == Thyra::NOTRANS || M_trans == Thyra::TRANS ||
+            M_trans == Thyra::CONJ || M_trans == Thyra::CONJTRANS);
+}
+#endif // WITH_TRILINOS
+
+template <typename ValueType>
+void NearFieldApproximateInverse<ValueType>::
+applyBuiltInImpl(const TranspositionMode trans,
+                 const arma::Col<ValueType>& x_in,
+                 arma::Col<ValueType>& y_inout,
+                 const ValueType alpha,
+                 const ValueType beta) const
+{
+    applyBuiltInImplMultiple(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void NearFieldApproximateInverse<ValueType>::
+applyBuiltInImplMultiple(const TranspositionMode trans,
+                         const arma::Mat<ValueType>& x_in,
+                         arma::Mat<ValueType>& y_inout,
+                         const ValueType alpha,
+                         const ValueType beta) const
+{
+    const bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
+    const size_t inSize = transpose ? rowCount() : columnCount();
+    const size_t outSize = transpose ? columnCount() : rowCount();
+    if (x_in.n_rows != inSize || y_inout.n_rows != outSize ||
+            x_in.n_cols != y_inout.n_cols)
+        throw std::invalid_argument(
+                "NearFieldApproximateInverse::applyBuiltInImpl(): "
+                "incorrect vector length");
+    const IndexPermutation& inPermutation =
+            transpose ? m_rangePermutation : m_domainPermutation;
+    const IndexPermutation& outPermutation =
+            transpose ? m_domainPermutation : m_rangePermutation;
+
+    arma::Mat<ValueType> permutedIn;
+    HMatrixInverseHelper::permuteRows(inPermutation, x_in, permutedIn);
+    arma::Mat<ValueType> permutedOut(outSize, x_in.n_cols);
+    {
+        tbb::task_scheduler_init scheduler(
+                    HMatrixInverseHelper::maxThreadCount(
+                        m_parallelizationOptions));
+        m_matrix->apply(trans, permutedIn, permutedOut,
+                        static_cast<ValueType>(1.), static_cast<ValueType>(0.));
+    }
+    HMatrixInverseHelper::addUnpermutedRows(outPermutation, permutedOut,
+                                            alpha, beta, y_inout);
+}
+
+namespace
+{
+
+template <typename ValueType>
+shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> > castToHMatrix(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
+        const char* functionName)
+{
+    shared_ptr<const DiscreteHMatrixBoundaryOperator<ValueType> > hMatOp =
+            boost::dynamic_pointer_cast<
+            const DiscreteHMatrixBoundaryOperator<ValueType> >(op);
+    if (!hMatOp)
+        throw std::invalid_argument(
+                std::string(functionName) + "(): the operator is not stored "
+                "as a H-matrix (DiscreteHMatrixBoundaryOperator)");
+    return hMatOp;
+}
+
+} // namespace
+
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> >
+nearFieldSparseApproximateInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op)
+{
+    typedef NearFieldApproximateInverse<ValueType> Inverse;
+    return shared_ptr<const DiscreteBoundaryOperator<ValueType> >(
+                new Inverse(*castToHMatrix(op, "nearFieldSparseApproximateInverse"),
+                            Inverse::SPARSE_APPROXIMATE_INVERSE));
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> >
+nearFieldBlockJacobiInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
+        int overlap)
+{
+    typedef NearFieldApproximateInverse<ValueType> Inverse;
+    return shared_ptr<const DiscreteBoundaryOperator<ValueType> >(
+                new Inverse(*castToHMatrix(op, "nearFieldBlockJacobiInverse"),
+                            Inverse::BLOCK_JACOBI, overlap));
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(NearFieldApproximateInverse);
+
+#define INSTANTIATE_FREE_FUNCTIONS(RESULT) \
+    template shared_ptr<const DiscreteBoundaryOperator<RESULT> > \
+        nearFieldSparseApproximateInverse( \
+            const shared_ptr<const DiscreteBoundaryOperator<RESULT> >& op); \
+    template shared_ptr<const DiscreteBoundaryOperator<RESULT> > \
+        nearFieldBlockJacobiInverse( \
+            const shared_ptr<const DiscreteBoundaryOperator<RESULT> >& op, \
+            int overlap)
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
+
+} // namespace Bempp
@@ -0,0 +1,177 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_near_field_approximate_inverse_hpp
+#define bempp_near_field_approximate_inverse_hpp
+
+#include "../common/common.hpp"
+
+#include "bempp/common/config_trilinos.hpp"
+#include "discrete_boundary_operator.hpp"
+
+#include "assembly_options.hpp" // actually only ParallelizationOptions are needed
+#include "index_permutation.hpp"
+#include "../common/shared_ptr.hpp"
+#include "../fiber/verbosity_level.hpp"
+
+#include <boost/scoped_ptr.hpp>
+
+#ifdef WITH_TRILINOS
+#include <Thyra_SpmdVectorSpaceBase_decl.hpp>
+#endif
+
+using Fiber::VerbosityLevel;
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class DiscreteHMatrixBoundaryOperator;
+template <typename ValueType> struct CompressedRowMatrix;
+/** \endcond */
+
+/** \brief Sparse approximate inverse of the near field of a discrete
+ *  boundary operator stored as a H-matrix.
+ *
+ *  \param[in] op
+ *    Discrete boundary operator stored as a H-matrix built into BEM++
+ *    (DiscreteHMatrixBoundaryOperator), with identical row and column
+ *    cluster trees.
+ *
+ *  \return A shared pointer to a newly allocated NearFieldApproximateInverse
+ *  object computed with the method
+ *  NearFieldApproximateInverse::SPARSE_APPROXIMATE_INVERSE.
+ *
+ *  The setup cost is proportional to the size of \p op, so this operator is
+ *  a cheaper, if usually less effective, alternative to
+ *  acaOperatorApproximateLuInverse() as a preconditioner. */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> >
+nearFieldSparseApproximateInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op);
+
+/** \brief Overlapping block-Jacobi inverse of the near field of a discrete
+ *  boundary operator stored as a H-matrix.
+ *
+ *  \param[in] op
+ *    Discrete boundary operator stored as a H-matrix built into BEM++
+ *    (DiscreteHMatrixBoundaryOperator), with identical row and column
+ *    cluster trees.
+ *  \param[in] overlap
+ *    Number of layers of near-field neighbours added to each block.
+ *
+ *  \return A shared pointer to a newly allocated NearFieldApproximateInverse
+ *  object computed with the method NearFieldApproximateInverse::BLOCK_JACOBI.
+ */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> >
+nearFieldBlockJacobiInverse(
+        const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op,
+        int overlap = 1);
+
+/** \ingroup composite_discrete_operators
+ *  \brief Sparse approximate inverse of a H-matrix built from its near field.
+ *
+ *  The near field of a H-matrix consists of its inadmissible, i.e. dense,
+ *  leaf blocks, which couple neighbouring DOFs. This class stores a sparse
+ *  matrix approximating the inverse of the near field, computed either as a
+ *  sparse approximate inverse (see
+ *  hMatrixNearFieldSparseApproximateInverse()) or as an overlapping
+ *  block-Jacobi inverse (see hMatrixNearFieldBlockJacobiInverse()). Both the
+ *  construction and the application (a sparse matrix-vector product) are
+ *  parallelised with TBB; the number of threads is determined by the
+ *  parallelization options of the inverted operator.
+ */
+template <typename ValueType>
+class NearFieldApproximateInverse : public DiscreteBoundaryOperator<ValueType>
+{
+public:
+    /** \brief Methods of construction of the inverse. */
+    enum Method {
+        /** \brief Least-squares sparse approximate inverse with the sparsity
+         *  pattern of the near field. */
+        SPARSE_APPROXIMATE_INVERSE,
+        /** \brief Block-Jacobi inverse with one (possibly overlapping) block
+         *  per leaf cluster. */
+        BLOCK_JACOBI
+    };
+
+    /** \brief Construct a near-field approximate inverse of a H-matrix.
+
+    \param[in] fwdOp    Operator represented internally as a H-matrix. Its
+                        row and column cluster trees must be identical.
+    \param[in] method   Method of construction of the inverse.
+    \param[in] overlap  Overlap of the blocks; only used by the BLOCK_JACOBI
+                        method. */
+    NearFieldApproximateInverse(
+            const DiscreteHMatrixBoundaryOperator<ValueType>& fwdOp,
+            Method method, int overlap = 1,
+            VerbosityLevel::Level verbosityLevel = VerbosityLevel::DEFAULT);
+
+    virtual ~NearFieldApproximateInverse();
+
+    virtual unsigned int rowCount() const;
+    virtual unsigned int columnCount() const;
+
+    virtual void addBlock(const std::vector<int>& rows,
+                          const std::vector<int>& cols,
+                          const ValueType alpha,
+                          arma::Mat<ValueType>& block) const;
+
+    /** \brief Number of nonzero entries of the stored sparse matrix. */
+    size_t nonzeroCount() const;
+
+#ifdef WITH_TRILINOS
+public:
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > domain() const;
+    virtual Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType> > range() const;
+
+protected:
+    virtual bool opSupportedImpl(Thyra::EOpTransp M_trans) const;
+#endif
+
+private:
+    virtual void applyBuiltInImpl(const TranspositionMode trans,
+                                  const arma::Col<ValueType>& x_in,
+                                  arma::Col<ValueType>& y_inout,
+                                  const ValueType alpha,
+                                  const ValueType beta) const;
+    virtual void applyBuiltInImplMultiple(const TranspositionMode trans,
+                                          const arma::Mat<ValueType>& x_in,
+                                          arma::Mat<ValueType>& y_inout,
+                                          const ValueType alpha,
+                                          const ValueType beta) const;
+
+private:
+    /** \cond PRIVATE */
+    boost::scoped_ptr<CompressedRowMatrix<ValueType> > m_matrix;
+#ifdef WITH_TRILINOS
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_domainSpace;
+    Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType> > m_rangeSpace;
+#endif
+    IndexPermutation m_domainPermutation;
+    IndexPermutation m_rangePermutation;
+    ParallelizationOptions m_parallelizationOptions;
+    /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
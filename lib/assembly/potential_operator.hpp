@@ -151,10 +151,13 @@ public:
      * Hence values of the potential at any points belonging to \f$\Gamma\f$
      * can be badly wrong.
      *
-     * The current implementation does not yet take special measures to prevent
-     * loss of accuracy *near* \f$\Gamma\f$, either. Users are advised to
-     * increase the quadrature accuracy for points lying in the vicinity of
-     * \f$\Gamma\f$. */
+     * In the dense evaluation mode, points lying closer to a surface in a
+     * 3D space than the diameter of the element nearest to them are
+     * identified with Grid::boundingVolumeHierarchy() and the potential at
+     * these points is evaluated with an increased quadrature order. No
+     * further measures are taken to prevent loss of accuracy *near*
+     * \f$\Gamma\f$, so users are advised to increase the quadrature
+     * accuracy if points lie very close to \f$\Gamma\f$. */
     virtual arma::Mat<ResultType> evaluateAtPoints(
             const GridFunction<BasisFunctionType, ResultType>& argument,
             const arma::Mat<CoordinateType>& evaluationPoints,
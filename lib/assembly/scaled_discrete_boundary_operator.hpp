@@ -56,6 +56,11 @@ public:
     ScaledDiscreteBoundaryOperator(ValueType multiplier,
                                    const shared_ptr<const Base>& op);
 
+    /** \brief Return the scalar multiplying the operator. */
+    ValueType multiplier() const { return m_multiplier; }
+    /** \brief Return the operator being scaled. */
+    shared_ptr<const Base> operand() const { return m_operator; }
+
     virtual arma::Mat<ValueType> asMatrix() const;
 
     virtual unsigned int rowCount() const;
@@ -55,6 +55,11 @@ public:
     TransposedDiscreteBoundaryOperator(TranspositionMode trans,
                                        const shared_ptr<const Base>& op);
 
+    /** \brief Return the transposition mode applied to the operand. */
+    TranspositionMode transpositionMode() const { return m_trans; }
+    /** \brief Return the operator being transposed and/or conjugated. */
+    shared_ptr<const Base> operand() const { return m_operator; }
+
     virtual arma::Mat<ValueType> asMatrix() const;
 
     virtual unsigned int rowCount() const;
@@ -18,10 +18,6 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#include "bempp/common/config_ahmed.hpp"
-
-#ifdef WITH_AHMED
-
 #include "weak_form_aca_assembly_helper.hpp"
 
 #include "assembly_options.hpp"
@@ -36,8 +32,10 @@
 #include "../grid/grid_view.hpp"
 #include "../space/space.hpp"
 
+#ifdef WITH_AHMED
 #include "ahmed_aux.hpp"
 #include "ahmed_complex.hpp"
+#endif
 
 #include <map>
 #include <set>
@@ -99,56 +97,15 @@ WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::WeakFormAcaAssemblyHel
 }
 
 template <typename BasisFunctionType, typename ResultType>
-typename WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::MagnitudeType
-WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::estimateMinimumDistance(
-        const cluster* c1, const cluster* c2) const
-{
-    typedef typename Fiber::ScalarTraits<BasisFunctionType>::RealType CoordinateType;
-    typedef AhmedDofWrapper<CoordinateType> AhmedDofType;
-    typedef ExtendedBemCluster<AhmedDofType> AhmedBemCluster;
-
-    AhmedBemCluster* cluster1 =
-        const_cast<AhmedBemCluster*>(// AHMED is not const-correct
-            dynamic_cast<const AhmedBemCluster*>(c1));
-    AhmedBemCluster* cluster2 =
-        const_cast<AhmedBemCluster*>(// AHMED is not const-correct
-            dynamic_cast<const AhmedBemCluster*>(c2));
-    // Lower bound on the minimum distance between elements from the two clusters
-    CoordinateType minDist = -1.; // negative, read: unknown
-    if (cluster1 && cluster2) {
-        // both getdiam2() and dist2() are effectively const, but not declared so
-        // in AHMED
-        const double diam1 = sqrt(cluster1->getdiam2());
-        const double diam2 = sqrt(cluster2->getdiam2());
-        const double dist = sqrt(cluster1->dist2(cluster2));
-        minDist = std::max(0., dist - (diam1 + diam2) / 2.);
-    }
-    // else
-        // std::cout << "Warning: clusters not available" << std::endl;
-    return minDist;
-}
-
-template <typename BasisFunctionType, typename ResultType>
-void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
+void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::evaluateBlock(
         unsigned b1, unsigned n1, unsigned b2, unsigned n2,
-        AhmedResultType* ahmedData,
-        const cluster* c1, const cluster* c2, bool countAccessedEntries) const
+        CoordinateType minDist, ResultType* data,
+        bool countAccessedEntries) const
 {
-    //    std::cout << "\nRequested block: (" << b1 << ", " << n1 << "; "
-    //              << b2 << ", " << n2 << ")" << std::endl;
     if (countAccessedEntries)
         m_accessedEntryCount += n1 * n2;
 
-    // if negative, it means: unknown
-    const CoordinateType minDist = estimateMinimumDistance(c1, c2);
-
-    // This is a non-op for real types. For complex types, it converts a pointer
-    // to Ahmed's scomp (resp. dcomp) to a pointer to std::complex<float>
-    // (resp. std::complex<double>), which should be perfectly safe since these
-    // types have the same binary representation.
-    ResultType* data = reinterpret_cast<ResultType*>(ahmedData);
-
-    // Convert AHMED matrix indices into DOF indices
+    // Convert matrix indices into DOF indices
     shared_ptr<const LocalDofLists<BasisFunctionType> > testDofLists =
             m_testDofListsCache->get(b1, n1);
     shared_ptr<const LocalDofLists<BasisFunctionType> > trialDofLists =
@@ -183,7 +140,7 @@ void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
             assert(std::abs(trialLocalDofWeights[i][j]) > 0.);
 
     // Corresponding row and column indices in the matrix to be calculated
-    // and stored in ahmedData
+    // and stored in data
     const std::vector<std::vector<int> >& blockRows =
             testDofLists->arrayIndices;
     const std::vector<std::vector<int> >& blockCols =
@@ -198,90 +155,51 @@ void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
     {
         // Only one column of the block needed. This means that we need only
         // one local DOF from just one or a few trialElements. Evaluate the
-        // local weak form for one local trial DOF at a time.
+        // local weak forms for all the needed local trial DOFs in one batch,
+        // so that the geometry of the test elements is processed only once.
 
-        std::vector<arma::Mat<ResultType> > localResult;
+        std::vector<int> batchTrialElementIndices;
+        std::vector<LocalDofIndex> batchTrialLocalDofs;
+        std::vector<BasisFunctionType> batchTrialLocalDofWeights;
         for (size_t nTrialElem = 0;
              nTrialElem < trialElementIndices.size();
              ++nTrialElem)
-        {
-            const int activeTrialElementIndex = trialElementIndices[nTrialElem];
-
-            // The body of this loop will very probably only run once (single
-            // local DOF per trial element)
             for (size_t nTrialDof = 0;
                  nTrialDof < trialLocalDofs[nTrialElem].size();
-                 ++nTrialDof)
-            {
-                LocalDofIndex activeTrialLocalDof =
-                        trialLocalDofs[nTrialElem][nTrialDof];
-                BasisFunctionType activeTrialLocalDofWeight =
-                        trialLocalDofWeights[nTrialElem][nTrialDof];
-                for (size_t nTerm = 0; nTerm < m_assemblers.size(); ++nTerm)
-                {
-                    m_assemblers[nTerm]->evaluateLocalWeakForms(
-                                Fiber::TEST_TRIAL, testElementIndices,
-                                activeTrialElementIndex, activeTrialLocalDof,
-                                localResult, minDist);
-                    for (size_t nTestElem = 0;
-                         nTestElem < testElementIndices.size();
-                         ++nTestElem)
-                        for (size_t nTestDof = 0;
-                             nTestDof < testLocalDofs[nTestElem].size();
-                             ++nTestDof)
-                            result(blockRows[nTestElem][nTestDof], 0) +=
-                                    m_denseTermsMultipliers[nTerm] *
-                                    conj(testLocalDofWeights[nTestElem][nTestDof]) *
-                                    activeTrialLocalDofWeight *
-                                    localResult[nTestElem](testLocalDofs[nTestElem][nTestDof]);
-                }
+                 ++nTrialDof) {
+                batchTrialElementIndices.push_back(
+                            trialElementIndices[nTrialElem]);
+                batchTrialLocalDofs.push_back(
+                            trialLocalDofs[nTrialElem][nTrialDof]);
+                batchTrialLocalDofWeights.push_back(
+                            trialLocalDofWeights[nTrialElem][nTrialDof]);
             }
-        }
-    }
-    else if (n1 == 1) // very few testElements
-    {
-        // Only one row of the block needed. This means that we need only
-        // one local DOF from just one or a few testElements. Evaluate the
-        // local weak form for one local test DOF at a time.
 
-        std::vector<arma::Mat<ResultType> > localResult;
-        for (size_t nTestElem = 0;
-             nTestElem < testElementIndices.size();
-             ++nTestElem)
+        Fiber::_2dArray<arma::Mat<ResultType> > localResult;
+        for (size_t nTerm = 0; nTerm < m_assemblers.size(); ++nTerm)
         {
-            const int activeTestElementIndex = testElementIndices[nTestElem];
-            // The body of this loop will very probably only run once (single
-            // local DOF per test element)
-            for (size_t nTestDof = 0;
-                 nTestDof < testLocalDofs[nTestElem].size();
-                 ++nTestDof)
-            {
-                LocalDofIndex activeTestLocalDof =
-                        testLocalDofs[nTestElem][nTestDof];
-                BasisFunctionType activeTestLocalDofWeight =
-                        testLocalDofWeights[nTestElem][nTestDof];
-                for (size_t nTerm = 0; nTerm < m_assemblers.size(); ++nTerm)
-                {
-                    m_assemblers[nTerm]->evaluateLocalWeakForms(
-                                Fiber::TRIAL_TEST, trialElementIndices,
-                                activeTestElementIndex, activeTestLocalDof,
-                                localResult, minDist);
-                    for (size_t nTrialElem = 0;
-                         nTrialElem < trialElementIndices.size();
-                         ++nTrialElem)
-                        for (size_t nTrialDof = 0;
-                             nTrialDof < trialLocalDofs[nTrialElem].size();
-                             ++nTrialDof)
-                            result(0, blockCols[nTrialElem][nTrialDof]) +=
-                                    m_denseTermsMultipliers[nTerm] *
-                                    conj(activeTestLocalDofWeight) *
-                                    trialLocalDofWeights[nTrialElem][nTrialDof] *
-                                    localResult[nTrialElem](trialLocalDofs[nTrialElem][nTrialDof]);
-                }
-            }
+            m_assemblers[nTerm]->evaluateLocalWeakForms(
+                        Fiber::TEST_TRIAL, testElementIndices,
+                        batchTrialElementIndices, batchTrialLocalDofs,
+                        localResult, minDist);
+            for (size_t nTrial = 0;
+                 nTrial < batchTrialElementIndices.size();
+                 ++nTrial)
+                for (size_t nTestElem = 0;
+                     nTestElem < testElementIndices.size();
+                     ++nTestElem)
+                    for (size_t nTestDof = 0;
+                         nTestDof < testLocalDofs[nTestElem].size();
+                         ++nTestDof)
+                        result(blockRows[nTestElem][nTestDof], 0) +=
+                                m_denseTermsMultipliers[nTerm] *
+                                conj(testLocalDofWeights[nTestElem][nTestDof]) *
+                                batchTrialLocalDofWeights[nTrial] *
+                                localResult(nTestElem, nTrial)
+                                (testLocalDofs[nTestElem][nTestDof]);
         }
     }
-    else if (n1 <= 32 && n2 <= 32) // a "fat" block
+    else if (n1 <= 32 && n2 <= 32 && n1 != 1) // a "fat" block
     {
         // The whole block or its submatrix needed. This means that we are
         // likely to need all or almost all local DOFs from most elements.
@@ -318,43 +236,69 @@ void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
     }
     else
     {
-        std::vector<arma::Mat<ResultType> > localResult;
+        // Either a single row (n1 == 1) or a large block is needed. Evaluate
+        // the local weak forms for batches of local test DOFs, so that the
+        // geometry of the trial elements is processed only once per batch
+        // rather than once per row.
+
+        const size_t maxBatchSize = 32;
+
+        std::vector<int> batchTestElementIndices;
+        std::vector<LocalDofIndex> batchTestLocalDofs;
+        std::vector<BasisFunctionType> batchTestLocalDofWeights;
+        std::vector<int> batchRows;
+        batchTestElementIndices.reserve(maxBatchSize);
+        batchTestLocalDofs.reserve(maxBatchSize);
+        batchTestLocalDofWeights.reserve(maxBatchSize);
+        batchRows.reserve(maxBatchSize);
+
+        Fiber::_2dArray<arma::Mat<ResultType> > localResult;
         for (size_t nTestElem = 0;
              nTestElem < testElementIndices.size();
              ++nTestElem)
-        {
-            const int activeTestElementIndex = testElementIndices[nTestElem];
-            // The body of this loop will very probably only run once (single
-            // local DOF per test element)
             for (size_t nTestDof = 0;
                  nTestDof < testLocalDofs[nTestElem].size();
                  ++nTestDof)
             {
-                LocalDofIndex activeTestLocalDof =
-                        testLocalDofs[nTestElem][nTestDof];
-                BasisFunctionType activeTestLocalDofWeight =
-                        testLocalDofWeights[nTestElem][nTestDof];
+                batchTestElementIndices.push_back(testElementIndices[nTestElem]);
+                batchTestLocalDofs.push_back(testLocalDofs[nTestElem][nTestDof]);
+                batchTestLocalDofWeights.push_back(
+                            testLocalDofWeights[nTestElem][nTestDof]);
+                batchRows.push_back(blockRows[nTestElem][nTestDof]);
+
+                const bool lastTestDof =
+                        nTestElem + 1 == testElementIndices.size() &&
+                        nTestDof + 1 == testLocalDofs[nTestElem].size();
+                if (batchRows.size() < maxBatchSize && !lastTestDof)
+                    continue;
+
                 for (size_t nTerm = 0; nTerm < m_assemblers.size(); ++nTerm)
                 {
                     m_assemblers[nTerm]->evaluateLocalWeakForms(
                                 Fiber::TRIAL_TEST, trialElementIndices,
-                                activeTestElementIndex, activeTestLocalDof,
+                                batchTestElementIndices, batchTestLocalDofs,
                                 localResult, minDist);
-                    for (size_t nTrialElem = 0;
-                         nTrialElem < trialElementIndices.size();
-                         ++nTrialElem)
-                        for (size_t nTrialDof = 0;
-                             nTrialDof < trialLocalDofs[nTrialElem].size();
-                             ++nTrialDof)
-                            result(blockRows[nTestElem][nTestDof],
-                                   blockCols[nTrialElem][nTrialDof]) +=
-                                    m_denseTermsMultipliers[nTerm] *
-                                    conj(activeTestLocalDofWeight) *
-                                    trialLocalDofWeights[nTrialElem][nTrialDof] *
-                                    localResult[nTrialElem](trialLocalDofs[nTrialElem][nTrialDof]);
+                    for (size_t nTest = 0; nTest < batchRows.size(); ++nTest)
+                        for (size_t nTrialElem = 0;
+                             nTrialElem < trialElementIndices.size();
+                             ++nTrialElem)
+                            for (size_t nTrialDof = 0;
+                                 nTrialDof < trialLocalDofs[nTrialElem].size();
+                                 ++nTrialDof)
+                                result(batchRows[nTest],
+                                       blockCols[nTrialElem][nTrialDof]) +=
+                                        m_denseTermsMultipliers[nTerm] *
+                                        conj(batchTestLocalDofWeights[nTest]) *
+                                        trialLocalDofWeights[nTrialElem][nTrialDof] *
+                                        localResult(nTrialElem, nTest)
+                                        (trialLocalDofs[nTrialElem][nTrialDof]);
                 }
+
+                batchTestElementIndices.clear();
+                batchTestLocalDofs.clear();
+                batchTestLocalDofWeights.clear();
+                batchRows.clear();
             }
-        }
     }
 
     // Probably can be removed
@@ -369,6 +313,59 @@ void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
     // else m_sparseTermsToAdd is empty (as we have verified in the constructor)
 }
 
+#ifdef WITH_AHMED
+
+template <typename BasisFunctionType, typename ResultType>
+typename WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::MagnitudeType
+WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::estimateMinimumDistance(
+        const cluster* c1, const cluster* c2) const
+{
+    typedef typename Fiber::ScalarTraits<BasisFunctionType>::RealType CoordinateType;
+    typedef AhmedDofWrapper<CoordinateType> AhmedDofType;
+    typedef ExtendedBemCluster<AhmedDofType> AhmedBemCluster;
+
+    AhmedBemCluster* cluster1 =
+        const_cast<AhmedBemCluster*>(// AHMED is not const-correct
+            dynamic_cast<const AhmedBemCluster*>(c1));
+    AhmedBemCluster* cluster2 =
+        const_cast<AhmedBemCluster*>(// AHMED is not const-correct
+            dynamic_cast<const AhmedBemCluster*>(c2));
+    // Lower bound on the minimum distance between elements from the two clusters
+    CoordinateType minDist = -1.; // negative, read: unknown
+    if (cluster1 && cluster2) {
+        // both getdiam2() and dist2() are effectively const, but not declared so
+        // in AHMED
+        const double diam1 = sqrt(cluster1->getdiam2());
+        const double diam2 = sqrt(cluster2->getdiam2());
+        const double dist = sqrt(cluster1->dist2(cluster2));
+        minDist = std::max(0., dist - (diam1 + diam2) / 2.);
+    }
+    // else
+        // std::cout << "Warning: clusters not available" << std::endl;
+    return minDist;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpbl(
+        unsigned b1, unsigned n1, unsigned b2, unsigned n2,
+        AhmedResultType* ahmedData,
+        const cluster* c1, const cluster* c2, bool countAccessedEntries) const
+{
+    //    std::cout << "\nRequested block: (" << b1 << ", " << n1 << "; "
+    //              << b2 << ", " << n2 << ")" << std::endl;
+
+    // if negative, it means: unknown
+    const CoordinateType minDist = estimateMinimumDistance(c1, c2);
+
+    // This is a non-op for real types. For complex types, it converts a pointer
+    // to Ahmed's scomp (resp. dcomp) to a pointer to std::complex<float>
+    // (resp. std::complex<double>), which should be perfectly safe since these
+    // types have the same binary representation.
+    ResultType* data = reinterpret_cast<ResultType*>(ahmedData);
+
+    evaluateBlock(b1, n1, b2, n2, minDist, data, countAccessedEntries);
+}
+
 template <typename BasisFunctionType, typename ResultType>
 void WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::cmpblsym(
         unsigned b1, unsigned n1, AhmedResultType* ahmedData,
@@ -434,6 +431,8 @@ WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::relativeScale(
     return result;
 }
 
+#endif // WITH_AHMED
+
 template <typename BasisFunctionType, typename ResultType>
 size_t
 WeakFormAcaAssemblyHelper<BasisFunctionType, ResultType>::
@@ -455,5 +454,3 @@ resetAccessedEntryCount()
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(WeakFormAcaAssemblyHelper);
 
 }
-
-#endif // WITH_AHMED
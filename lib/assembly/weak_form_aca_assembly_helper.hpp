@@ -56,7 +56,8 @@ template <typename BasisFunctionType> class Space;
 /** \endcond */
 
 /** \ingroup weak_form_assembly_internal
- *  \brief Class whose methods are called by Ahmed during assembly in the ACA mode.
+ *  \brief Class whose methods are called by Ahmed or by the built-in
+ *  H-matrix code during assembly in the ACA mode.
  */
 template <typename BasisFunctionType, typename ResultType>
 class WeakFormAcaAssemblyHelper
@@ -78,6 +79,18 @@ public:
                               const std::vector<ResultType>& sparseTermsMultipliers,
                               const AssemblyOptions& options);
 
+    /** \brief Evaluate entries of a general block.
+     *
+     *  Store the entries of the block defined by \p b1, \p n1, \p b2, \p n2
+     *  (in permuted ordering) columnwise in \p data. \p minDist should be a
+     *  lower bound on the distance between the test and trial elements
+     *  involved, or a negative number if it is unknown.
+     *
+     *  This function does not depend on AHMED. */
+    void evaluateBlock(unsigned b1, unsigned n1, unsigned b2, unsigned n2,
+                       CoordinateType minDist, ResultType* data,
+                       bool countAccessedEntries = true) const;
+
     /** \brief Evaluate entries of a general block.
      *
      *  Store the entries of the block defined
@@ -0,0 +1,213 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_lapack_aux_hpp
+#define bempp_lapack_aux_hpp
+
+#include <complex>
+
+// Declarations of the LAPACK routines used by BEM++ (Fortran calling
+// convention)
+
+extern "C" {
+
+void sgetrf_(int* m, int* n, float* a, int* lda, int* ipiv, int* info);
+void dgetrf_(int* m, int* n, double* a, int* lda, int* ipiv, int* info);
+void cgetrf_(int* m, int* n, std::complex<float>* a, int* lda, int* ipiv,
+             int* info);
+void zgetrf_(int* m, int* n, std::complex<double>* a, int* lda, int* ipiv,
+             int* info);
+
+void sgetrs_(char* trans, int* n, int* nrhs, const float* a, int* lda,
+             const int* ipiv, float* b, int* ldb, int* info);
+void dgetrs_(char* trans, int* n, int* nrhs, const double* a, int* lda,
+             const int* ipiv, double* b, int* ldb, int* info);
+void cgetrs_(char* trans, int* n, int* nrhs, const std::complex<float>* a,
+             int* lda, const int* ipiv, std::complex<float>* b, int* ldb,
+             int* info);
+void zgetrs_(char* trans, int* n, int* nrhs, const std::complex<double>* a,
+             int* lda, const int* ipiv, std::complex<double>* b, int* ldb,
+             int* info);
+
+void ssytrf_(char* uplo, int* n, float* a, int* lda, int* ipiv,
+             float* work, int* lwork, int* info);
+void dsytrf_(char* uplo, int* n, double* a, int* lda, int* ipiv,
+             double* work, int* lwork, int* info);
+void csytrf_(char* uplo, int* n, std::complex<float>* a, int* lda, int* ipiv,
+             std::complex<float>* work, int* lwork, int* info);
+void zsytrf_(char* uplo, int* n, std::complex<double>* a, int* lda, int* ipiv,
+             std::complex<double>* work, int* lwork, int* info);
+void chetrf_(char* uplo, int* n, std::complex<float>* a, int* lda, int* ipiv,
+             std::complex<float>* work, int* lwork, int* info);
+void zhetrf_(char* uplo, int* n, std::complex<double>* a, int* lda, int* ipiv,
+             std::complex<double>* work, int* lwork, int* info);
+
+void ssytrs_(char* uplo, int* n, int* nrhs, const float* a, int* lda,
+             const int* ipiv, float* b, int* ldb, int* info);
+void dsytrs_(char* uplo, int* n, int* nrhs, const double* a, int* lda,
+             const int* ipiv, double* b, int* ldb, int* info);
+void csytrs_(char* uplo, int* n, int* nrhs, const std::complex<float>* a,
+             int* lda, const int* ipiv, std::complex<float>* b, int* ldb,
+             int* info);
+void zsytrs_(char* uplo, int* n, int* nrhs, const std::complex<double>* a,
+             int* lda, const int* ipiv, std::complex<double>* b, int* ldb,
+             int* info);
+void chetrs_(char* uplo, int* n, int* nrhs, const std::complex<float>* a,
+             int* lda, const int* ipiv, std::complex<float>* b, int* ldb,
+             int* info);
+void zhetrs_(char* uplo, int* n, int* nrhs, const std::complex<double>* a,
+             int* lda, const int* ipiv, std::complex<double>* b, int* ldb,
+             int* info);
+
+} // extern "C"
+
+namespace Bempp
+{
+
+/** \cond PRIVATE */
+namespace Lapack
+{
+
+// LU factorisation with partial pivoting (?getrf)
+
+inline void getrf(int m, int n, float* a, int lda, int* ipiv, int& info) {
+    sgetrf_(&m, &n, a, &lda, ipiv, &info);
+}
+inline void getrf(int m, int n, double* a, int lda, int* ipiv, int& info) {
+    dgetrf_(&m, &n, a, &lda, ipiv, &info);
+}
+inline void getrf(int m, int n, std::complex<float>* a, int lda, int* ipiv,
+                  int& info) {
+    cgetrf_(&m, &n, a, &lda, ipiv, &info);
+}
+inline void getrf(int m, int n, std::complex<double>* a, int lda, int* ipiv,
+                  int& info) {
+    zgetrf_(&m, &n, a, &lda, ipiv, &info);
+}
+
+// Solution of a system factorised by getrf() (?getrs)
+
+inline void getrs(char trans, int n, int nrhs, const float* a, int lda,
+                  const int* ipiv, float* b, int ldb, int& info) {
+    sgetrs_(&trans, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void getrs(char trans, int n, int nrhs, const double* a, int lda,
+                  const int* ipiv, double* b, int ldb, int& info) {
+    dgetrs_(&trans, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void getrs(char trans, int n, int nrhs, const std::complex<float>* a,
+                  int lda, const int* ipiv, std::complex<float>* b, int ldb,
+                  int& info) {
+    cgetrs_(&trans, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void getrs(char trans, int n, int nrhs, const std::complex<double>* a,
+                  int lda, const int* ipiv, std::complex<double>* b, int ldb,
+                  int& info) {
+    zgetrs_(&trans, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+
+// Bunch-Kaufman factorisation of a symmetric matrix (?sytrf)
+
+inline void sytrf(char uplo, int n, float* a, int lda, int* ipiv,
+                  float* work, int lwork, int& info) {
+    ssytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void sytrf(char uplo, int n, double* a, int lda, int* ipiv,
+                  double* work, int lwork, int& info) {
+    dsytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void sytrf(char uplo, int n, std::complex<float>* a, int lda, int* ipiv,
+                  std::complex<float>* work, int lwork, int& info) {
+    csytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void sytrf(char uplo, int n, std::complex<double>* a, int lda, int* ipiv,
+                  std::complex<double>* work, int lwork, int& info) {
+    zsytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+
+// Bunch-Kaufman factorisation of a Hermitian matrix (?hetrf; ?sytrf for
+// real matrices)
+
+inline void hetrf(char uplo, int n, float* a, int lda, int* ipiv,
+                  float* work, int lwork, int& info) {
+    ssytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void hetrf(char uplo, int n, double* a, int lda, int* ipiv,
+                  double* work, int lwork, int& info) {
+    dsytrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void hetrf(char uplo, int n, std::complex<float>* a, int lda, int* ipiv,
+                  std::complex<float>* work, int lwork, int& info) {
+    chetrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+inline void hetrf(char uplo, int n, std::complex<double>* a, int lda, int* ipiv,
+                  std::complex<double>* work, int lwork, int& info) {
+    zhetrf_(&uplo, &n, a, &lda, ipiv, work, &lwork, &info);
+}
+
+// Solution of a system factorised by sytrf() (?sytrs)
+
+inline void sytrs(char uplo, int n, int nrhs, const float* a, int lda,
+                  const int* ipiv, float* b, int ldb, int& info) {
+    ssytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void sytrs(char uplo, int n, int nrhs, const double* a, int lda,
+                  const int* ipiv, double* b, int ldb, int& info) {
+    dsytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void sytrs(char uplo, int n, int nrhs, const std::complex<float>* a,
+                  int lda, const int* ipiv, std::complex<float>* b, int ldb,
+                  int& info) {
+    csytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void sytrs(char uplo, int n, int nrhs, const std::complex<double>* a,
+                  int lda, const int* ipiv, std::complex<double>* b, int ldb,
+                  int& info) {
+    zsytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+
+// Solution of a system factorised by hetrf() (?hetrs; ?sytrs for real
+// matrices)
+
+inline void hetrs(char uplo, int n, int nrhs, const float* a, int lda,
+                  const int* ipiv, float* b, int ldb, int& info) {
+    ssytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void hetrs(char uplo, int n, int nrhs, const double* a, int lda,
+                  const int* ipiv, double* b, int ldb, int& info) {
+    dsytrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void hetrs(char uplo, int n, int nrhs, const std::complex<float>* a,
+                  int lda, const int* ipiv, std::complex<float>* b, int ldb,
+                  int& info) {
+    chetrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+inline void hetrs(char uplo, int n, int nrhs, const std::complex<double>* a,
+                  int lda, const int* ipiv, std::complex<double>* b, int ldb,
+                  int& info) {
+    zhetrs_(&uplo, &n, &nrhs, a, &lda, ipiv, b, &ldb, &info);
+}
+
+} // namespace Lapack
+/** \endcond */
+
+} // namespace Bempp
+
+#endif
@@ -340,4 +340,15 @@ void AccuracyOptionsEx::setDoubleSingular(
         m_doubleSingular.setAbsoluteQuadratureOrder(accuracyOrder);
 }
 
+void AccuracyOptionsEx::increaseQuadratureOrders(
+        int singleRegularOffset, int doubleRegularOffset,
+        int doubleSingularOffset)
+{
+    for (size_t i = 0; i < m_singleRegular.size(); ++i)
+        m_singleRegular[i].second.increaseQuadratureOrder(singleRegularOffset);
+    for (size_t i = 0; i < m_doubleRegular.size(); ++i)
+        m_doubleRegular[i].second.increaseQuadratureOrder(doubleRegularOffset);
+    m_doubleSingular.increaseQuadratureOrder(doubleSingularOffset);
+}
+
 } // namespace Fiber
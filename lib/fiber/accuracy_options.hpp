@@ -347,6 +347,19 @@ public:
      *  above the default level. */
     void setDoubleSingular(int accuracyOrder, bool relativeToDefault = true);
 
+    /** \brief Increase the orders of all quadrature rules by given offsets.
+     *
+     *  The offsets, which may be negative, are added to the orders of
+     *  accuracy of the rules used for regular integrals on single elements
+     *  (\p singleRegularOffset), regular integrals on pairs of elements
+     *  (\p doubleRegularOffset) and singular integrals on pairs of elements
+     *  (\p doubleSingularOffset), regardless of whether these orders are
+     *  absolute or relative to the default. Any dependence of the orders on
+     *  the element distance is preserved. */
+    void increaseQuadratureOrders(int singleRegularOffset,
+                                  int doubleRegularOffset,
+                                  int doubleSingularOffset);
+
 private:
     /** \cond PRIVATE */
     std::vector<std::pair<double, QuadratureOptions> > m_singleRegular;
@@ -33,6 +33,7 @@
 #include "kernel_trial_integral.hpp"
 #include "numerical_quadrature.hpp"
 #include "opencl_handler.hpp"
+#include "quadrature_rule_registry.hpp"
 #include "raw_grid_geometry.hpp"
 #include "serial_blas_region.hpp"
 
@@ -229,7 +230,6 @@ ResultType, GeometryFactory>::cacheTrialData()
     calcTrialData(EvaluatorForIntegralOperators<ResultType>::FAR_FIELD,
                   trialGeomDeps, m_farFieldTrialGeomData,
                   m_farFieldTrialTransfValues, m_farFieldWeights);
-    // near field currently not used
     calcTrialData(EvaluatorForIntegralOperators<ResultType>::NEAR_FIELD,
                   trialGeomDeps, m_nearFieldTrialGeomData,
                   m_nearFieldTrialTransfValues, m_nearFieldWeights);
@@ -301,10 +301,11 @@ ResultType, GeometryFactory>::calcTrialData(
             }
 
         // Get quadrature points and weights
-        arma::Mat<CoordinateType> localQuadPoints;
-        std::vector<CoordinateType> quadWeights;
-        fillSingleQuadraturePointsAndWeights(
-                    elementCornerCount, order, localQuadPoints, quadWeights);
+        const SingleQuadratureRule<CoordinateType>& rule =
+                QuadratureRuleRegistry<CoordinateType>::instance().singleRule(
+                    elementCornerCount, order);
+        const arma::Mat<CoordinateType>& localQuadPoints = rule.points;
+        const std::vector<CoordinateType>& quadWeights = rule.weights;
 
         // Get basis data
         BasisData<BasisFunctionType> basisData;
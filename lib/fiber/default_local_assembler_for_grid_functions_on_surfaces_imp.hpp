@@ -24,6 +24,7 @@
 #include "../common/common.hpp"
 
 #include "numerical_test_function_integrator.hpp"
+#include "quadrature_rule_registry.hpp"
 
 #include <set>
 #include <utility>
@@ -198,15 +199,13 @@ getIntegrator(const SingleQuadratureDescriptor& desc)
     // std::cout << "getIntegrator(: " << index << "): integrator not found" << std::endl;
 
     // Integrator doesn't exist yet and must be created.
-    arma::Mat<CoordinateType> points;
-    std::vector<CoordinateType> weights;
-    fillSingleQuadraturePointsAndWeights(desc.vertexCount, desc.order,
-                                         points, weights);
+    const SingleQuadratureRule<CoordinateType>& rule =
+            QuadratureRuleRegistry<CoordinateType>::instance().singleRule(desc);
 
     typedef NumericalTestFunctionIntegrator<BasisFunctionType, UserFunctionType,
             ResultType, GeometryFactory> ConcreteIntegrator;
     Integrator* integrator(
-                new ConcreteIntegrator(points, weights,
+                new ConcreteIntegrator(rule.points, rule.weights,
                                        *m_geometryFactory, *m_rawGeometry,
                                        *m_testTransformations, *m_function,
                                        *m_openClHandler));
@@ -91,6 +91,14 @@ public:
             std::vector<arma::Mat<ResultType> >& result,
             CoordinateType nominalDistance = -1.);
 
+    virtual void evaluateLocalWeakForms(
+            CallVariant callVariant,
+            const std::vector<int>& elementIndicesA,
+            const std::vector<int>& elementIndicesB,
+            const std::vector<LocalDofIndex>& localDofIndicesB,
+            Fiber::_2dArray<arma::Mat<ResultType> >& result,
+            CoordinateType nominalDistance = -1.);
+
     virtual void evaluateLocalWeakForms(
             const std::vector<int>& testElementIndices,
             const std::vector<int>& trialElementIndices,
@@ -143,6 +151,9 @@ private:
 
     bool testAndTrialGridsAreIdentical() const;
 
+    const arma::Mat<ResultType>* findCachedLocalWeakForm(
+            int testElementIndex, int trialElementIndex) const;
+
     void cacheSingularLocalWeakForms();
     void findPairsOfAdjacentElements(ElementIndexPairSet& pairs) const;
     void cacheLocalWeakForms(const ElementIndexPairSet& elementIndexPairs);
@@ -24,6 +24,7 @@
 #include "default_local_assembler_for_integral_operators_on_surfaces.hpp"
 
 #include "nonseparable_numerical_test_kernel_trial_integrator.hpp"
+#include "quadrature_rule_registry.hpp"
 #include "separable_numerical_test_kernel_trial_integrator.hpp"
 #include "serial_blas_region.hpp"
 
@@ -272,6 +273,104 @@ evaluateLocalWeakForms(
     }
 }
 
+template <typename BasisFunctionType, typename KernelType,
+          typename ResultType, typename GeometryFactory>
+void
+DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<BasisFunctionType,
+KernelType, ResultType, GeometryFactory>::
+evaluateLocalWeakForms(
+        CallVariant callVariant,
+        const std::vector<int>& elementIndicesA,
+        const std::vector<int>& elementIndicesB,
+        const std::vector<LocalDofIndex>& localDofIndicesB,
+        Fiber::_2dArray<arma::Mat<ResultType> >& result,
+        CoordinateType nominalDistance)
+{
+    typedef Fiber::Basis<BasisFunctionType> Basis;
+
+    const int elementACount = elementIndicesA.size();
+    const int elementBCount = elementIndicesB.size();
+    if (localDofIndicesB.size() != elementIndicesB.size())
+        throw std::invalid_argument(
+                "DefaultLocalAssemblerForIntegralOperatorsOnSurfaces::"
+                "evaluateLocalWeakForms(): elementIndicesB and "
+                "localDofIndicesB must have the same length");
+    result.set_size(elementACount, elementBCount);
+
+    const std::vector<const Basis*>& basesA =
+            callVariant == TEST_TRIAL ? *m_testBases : *m_trialBases;
+    const std::vector<const Basis*>& basesB =
+            callVariant == TEST_TRIAL ? *m_trialBases : *m_testBases;
+
+    // Find cached matrices; select integrators to calculate non-cached ones
+    typedef boost::tuples::tuple<const Integrator*, const Basis*, const Basis*>
+            QuadVariant;
+    const QuadVariant CACHED(0, 0, 0);
+    Fiber::_2dArray<QuadVariant> quadVariants(elementACount, elementBCount);
+
+    for (int indexB = 0; indexB < elementBCount; ++indexB)
+        for (int indexA = 0; indexA < elementACount; ++indexA) {
+            const int elementIndexA = elementIndicesA[indexA];
+            const int elementIndexB = elementIndicesB[indexB];
+            const int testElementIndex =
+                    callVariant == TEST_TRIAL ? elementIndexA : elementIndexB;
+            const int trialElementIndex =
+                    callVariant == TEST_TRIAL ? elementIndexB : elementIndexA;
+            const arma::Mat<ResultType>* cachedLocalWeakForm =
+                    findCachedLocalWeakForm(testElementIndex, trialElementIndex);
+            if (cachedLocalWeakForm) {
+                quadVariants(indexA, indexB) = CACHED;
+                const LocalDofIndex localDofIndexB = localDofIndicesB[indexB];
+                if (localDofIndexB == ALL_DOFS)
+                    result(indexA, indexB) = *cachedLocalWeakForm;
+                else if (callVariant == TEST_TRIAL)
+                    result(indexA, indexB) =
+                            cachedLocalWeakForm->col(localDofIndexB);
+                else
+                    result(indexA, indexB) =
+                            cachedLocalWeakForm->row(localDofIndexB);
+            } else {
+                const Integrator* integrator =
+                        &selectIntegrator(testElementIndex, trialElementIndex,
+                                          nominalDistance);
+                quadVariants(indexA, indexB) = QuadVariant(
+                            integrator, basesA[elementIndexA],
+                            basesB[elementIndexB]);
+            }
+        }
+
+    // Integration will proceed in batches of element pairs having the same
+    // "quadrature variant", i.e. integrator, basis A and basis B. Each batch
+    // is handed over to the integrator in one go, so that it can reuse
+    // geometrical data across all the elements B.
+
+    typedef std::set<QuadVariant> QuadVariantSet;
+    QuadVariantSet uniqueQuadVariants(quadVariants.begin(), quadVariants.end());
+
+    std::vector<arma::Mat<ResultType>*> activeLocalResults(
+                elementACount * elementBCount);
+    for (typename QuadVariantSet::const_iterator it = uniqueQuadVariants.begin();
+         it != uniqueQuadVariants.end(); ++it) {
+        const QuadVariant activeQuadVariant = *it;
+        if (activeQuadVariant == CACHED)
+            continue;
+        const Integrator& activeIntegrator = *it->template get<0>();
+        const Basis& activeBasisA = *it->template get<1>();
+        const Basis& activeBasisB = *it->template get<2>();
+
+        for (int indexB = 0; indexB < elementBCount; ++indexB)
+            for (int indexA = 0; indexA < elementACount; ++indexA)
+                activeLocalResults[indexA + indexB * elementACount] =
+                        quadVariants(indexA, indexB) == activeQuadVariant ?
+                            &result(indexA, indexB) : 0;
+
+        activeIntegrator.integrate(callVariant,
+                                   elementIndicesA, elementIndicesB,
+                                   activeBasisA, activeBasisB,
+                                   localDofIndicesB, activeLocalResults);
+    }
+}
+
 template <typename BasisFunctionType, typename KernelType,
           typename ResultType, typename GeometryFactory>
 void
@@ -396,6 +495,19 @@ estimateRelativeScale(CoordinateType minDist) const
     return m_kernels->estimateRelativeScale(minDist);
 }
 
+template <typename BasisFunctionType, typename KernelType,
+          typename ResultType, typename GeometryFactory>
+inline const arma::Mat<ResultType>*
+DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<BasisFunctionType,
+KernelType, ResultType, GeometryFactory>::
+findCachedLocalWeakForm(int testElementIndex, int trialElementIndex) const
+{
+    for (size_t n = 0; n < m_cache.extent(0); ++n)
+        if (m_cache(n, trialElementIndex).first == testElementIndex)
+            return &m_cache(n, trialElementIndex).second;
+    return 0;
+}
+
 template <typename BasisFunctionType, typename KernelType,
           typename ResultType, typename GeometryFactory>
 void
@@ -635,18 +747,22 @@ selectIntegrator(int testElementIndex, int trialElementIndex,
 {
     DoubleQuadratureDescriptor desc;
 
-    // Get corner indices of the specified elements
-    arma::Col<int> testElementCornerIndices =
-            m_testRawGeometry->elementCornerIndices(testElementIndex);
-    arma::Col<int> trialElementCornerIndices =
-            m_trialRawGeometry->elementCornerIndices(trialElementIndex);
+    // Get corner indices of the specified elements (without copying them,
+    // since this function is called for every pair of elements)
+    const int testElementCornerCount =
+            m_testRawGeometry->elementCornerCount(testElementIndex);
+    const int trialElementCornerCount =
+            m_trialRawGeometry->elementCornerCount(trialElementIndex);
     if (testAndTrialGridsAreIdentical()) {
         desc.topology = determineElementPairTopologyIn3D(
-                    testElementCornerIndices, trialElementCornerIndices);
+                    m_testRawGeometry->elementCornerIndexArray(testElementIndex),
+                    testElementCornerCount,
+                    m_trialRawGeometry->elementCornerIndexArray(trialElementIndex),
+                    trialElementCornerCount);
     }
     else {
-        desc.topology.testVertexCount = testElementCornerIndices.n_rows;
-        desc.topology.trialVertexCount = trialElementCornerIndices.n_rows;
+        desc.topology.testVertexCount = testElementCornerCount;
+        desc.topology.trialVertexCount = trialElementCornerCount;
         desc.topology.type = ElementPairTopology::Disjoint;
     }
 
@@ -733,10 +849,16 @@ DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
 BasisFunctionType, KernelType, ResultType, GeometryFactory>::elementDistanceSquared(
         int testElementIndex, int trialElementIndex) const
 {
-    arma::Col<CoordinateType> diff =
-            m_trialElementCenters.col(trialElementIndex) -
-            m_testElementCenters.col(testElementIndex);
-    return arma::dot(diff, diff);
+    const CoordinateType* trialCenter =
+            m_trialElementCenters.colptr(trialElementIndex);
+    const CoordinateType* testCenter =
+            m_testElementCenters.colptr(testElementIndex);
+    CoordinateType distanceSquared = 0.;
+    for (size_t i = 0; i < m_testElementCenters.n_rows; ++i) {
+        const CoordinateType diff = trialCenter[i] - testCenter[i];
+        distanceSquared += diff * diff;
+    }
+    return distanceSquared;
 }
 
 template <typename BasisFunctionType, typename KernelType,
@@ -760,34 +882,30 @@ getIntegrator(const DoubleQuadratureDescriptor& desc)
     const ElementPairTopology& topology = desc.topology;
     if (topology.type == ElementPairTopology::Disjoint) {
         // Create a tensor rule
-        arma::Mat<CoordinateType> testPoints, trialPoints;
-        std::vector<CoordinateType> testWeights, trialWeights;
-
-        fillSingleQuadraturePointsAndWeights(topology.testVertexCount,
-                                             desc.testOrder,
-                                             testPoints, testWeights);
-        fillSingleQuadraturePointsAndWeights(topology.trialVertexCount,
-                                             desc.trialOrder,
-                                             trialPoints, trialWeights);
+        const SingleQuadratureRule<CoordinateType>& testRule =
+                QuadratureRuleRegistry<CoordinateType>::instance().singleRule(
+                    topology.testVertexCount, desc.testOrder);
+        const SingleQuadratureRule<CoordinateType>& trialRule =
+                QuadratureRuleRegistry<CoordinateType>::instance().singleRule(
+                    topology.trialVertexCount, desc.trialOrder);
         typedef SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType,
                 KernelType, ResultType, GeometryFactory> ConcreteIntegrator;
         integrator = new ConcreteIntegrator(
-                    testPoints, trialPoints, testWeights, trialWeights,
+                    testRule.points, trialRule.points,
+                    testRule.weights, trialRule.weights,
                     *m_testGeometryFactory, *m_trialGeometryFactory,
                     *m_testRawGeometry, *m_trialRawGeometry,
                     *m_testTransformations, *m_kernels, *m_trialTransformations,
                     *m_integral,
                     *m_openClHandler);
     } else {
-        arma::Mat<CoordinateType> testPoints, trialPoints;
-        std::vector<CoordinateType> weights;
-
-        fillDoubleSingularQuadraturePointsAndWeights(
-                    desc, testPoints, trialPoints, weights);
+        const DoubleQuadratureRule<CoordinateType>& rule =
+                QuadratureRuleRegistry<CoordinateType>::instance().
+                doubleSingularRule(desc);
         typedef NonseparableNumericalTestKernelTrialIntegrator<BasisFunctionType,
                 KernelType, ResultType, GeometryFactory> ConcreteIntegrator;
         integrator = new ConcreteIntegrator(
-                    testPoints, trialPoints, weights,
+                    rule.testPoints, rule.trialPoints, rule.weights,
                     *m_testGeometryFactory, *m_trialGeometryFactory,
                     *m_testRawGeometry, *m_trialRawGeometry,
                     *m_testTransformations, *m_kernels, *m_trialTransformations,
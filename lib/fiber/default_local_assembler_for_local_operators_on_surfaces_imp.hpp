@@ -24,6 +24,8 @@
 // Keep IDEs happy
 #include "default_local_assembler_for_local_operators_on_surfaces.hpp"
 
+#include "quadrature_rule_registry.hpp"
+
 #include <boost/tuple/tuple_comparison.hpp>
 
 namespace Fiber
@@ -193,15 +195,13 @@ getIntegrator(const SingleQuadratureDescriptor& desc)
 //        std::cout << "getIntegrator(: " << index << "): integrator not found" << std::endl;
 
     // Integrator doesn't exist yet and must be created.
-    arma::Mat<CoordinateType> points;
-    std::vector<CoordinateType> weights;
-    fillSingleQuadraturePointsAndWeights(desc.vertexCount, desc.order,
-                                         points, weights);
+    const SingleQuadratureRule<CoordinateType>& rule =
+            QuadratureRuleRegistry<CoordinateType>::instance().singleRule(desc);
 
     typedef NumericalTestTrialIntegrator<BasisFunctionType, ResultType,
             GeometryFactory> Integrator;
     std::auto_ptr<TestTrialIntegrator<BasisFunctionType, ResultType> > integrator(
-        new Integrator(points, weights,
+        new Integrator(rule.points, rule.weights,
                        *m_geometryFactory, *m_rawGeometry,
                        *m_testTransformations, *m_trialTransformations,
                        *m_integral,
@@ -80,7 +80,7 @@ elementSizeSquared(int elementIndex,
     const arma::Mat<int>& cornerIndices = rawGeometry.elementCornerIndices();
     const arma::Mat<CoordinateType>& vertices = rawGeometry.vertices();
     arma::Col<CoordinateType> edge;
-    if (cornerIndices(cornerIndices.n_rows - 1, elementIndex) == -1) {
+    if (rawGeometry.elementCornerCount(elementIndex) == 3) {
         // Triangular element
         const int cornerCount = 3;
         for (int i = 0; i < cornerCount; ++i) {
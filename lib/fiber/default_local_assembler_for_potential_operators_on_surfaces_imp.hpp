@@ -24,6 +24,7 @@
 #include "basis.hpp"
 #include "kernel_trial_integral.hpp"
 #include "numerical_kernel_trial_integrator.hpp"
+#include "quadrature_rule_registry.hpp"
 #include "raw_grid_geometry.hpp"
 #include "serial_blas_region.hpp"
 
@@ -404,16 +405,12 @@ getIntegrator(const SingleQuadratureDescriptor& desc)
     // Integrator doesn't exist yet and must be created.
     Integrator* integrator = 0;
     // Create a quadrature rule
-    arma::Mat<CoordinateType> trialPoints;
-    std::vector<CoordinateType> trialWeights;
-
-    fillSingleQuadraturePointsAndWeights(desc.vertexCount,
-                                         desc.order,
-                                         trialPoints, trialWeights);
+    const SingleQuadratureRule<CoordinateType>& trialRule =
+            QuadratureRuleRegistry<CoordinateType>::instance().singleRule(desc);
     typedef NumericalKernelTrialIntegrator<BasisFunctionType,
             KernelType, ResultType, GeometryFactory> ConcreteIntegrator;
     integrator = new ConcreteIntegrator(
-                trialPoints, trialWeights,
+                trialRule.points, trialRule.weights,
                 m_points,
                 *m_geometryFactory, *m_rawGeometry,
                 *m_kernels, *m_trialTransformations, *m_integral);
@@ -87,9 +87,13 @@ struct ElementPairTopology
     }
 };
 
+/** \brief Determine the topology of a pair of elements from the arrays of
+ *  indices of their corners.
+ *
+ *  This overload does not allocate memory. */
 inline ElementPairTopology determineElementPairTopologyIn3D(
-        const arma::Col<int>& testElementCornerIndices,
-        const arma::Col<int>& trialElementCornerIndices)
+        const int* testElementCornerIndices, int testElementCornerCount,
+        const int* trialElementCornerIndices, int trialElementCornerCount)
 {
     ElementPairTopology topology;
 
@@ -98,10 +102,10 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
     const int MIN_VERTEX_COUNT = 3;
 #endif
     const int MAX_VERTEX_COUNT = 4;
-    topology.testVertexCount = testElementCornerIndices.n_rows;
+    topology.testVertexCount = testElementCornerCount;
     assert(MIN_VERTEX_COUNT <= topology.testVertexCount &&
            topology.testVertexCount <= MAX_VERTEX_COUNT);
-    topology.trialVertexCount = trialElementCornerIndices.n_rows;
+    topology.trialVertexCount = trialElementCornerCount;
     assert(MIN_VERTEX_COUNT <= topology.trialVertexCount &&
            topology.trialVertexCount <= MAX_VERTEX_COUNT);
 
@@ -112,8 +116,8 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
 
     for (int trialV = 0; trialV < topology.trialVertexCount; ++trialV)
         for (int testV = 0; testV < topology.testVertexCount; ++testV)
-            if (testElementCornerIndices(testV) ==
-                    trialElementCornerIndices(trialV))
+            if (testElementCornerIndices[testV] ==
+                    trialElementCornerIndices[trialV])
             {
                 testSharedVertices[hits] = testV;
                 trialSharedVertices[hits] = trialV;
@@ -158,6 +162,17 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
     return topology;
 }
 
+inline ElementPairTopology determineElementPairTopologyIn3D(
+        const arma::Col<int>& testElementCornerIndices,
+        const arma::Col<int>& trialElementCornerIndices)
+{
+    return determineElementPairTopologyIn3D(
+                testElementCornerIndices.memptr(),
+                testElementCornerIndices.n_rows,
+                trialElementCornerIndices.memptr(),
+                trialElementCornerIndices.n_rows);
+}
+
 } // namespace Fiber
 
 #endif
@@ -48,8 +48,36 @@ public:
 
     virtual void addGeometricalDependencies(size_t& geomDeps) const = 0;
 
+    /** \brief Evaluate the function at the points described by \p geomData.
+     *
+     *  The points need not belong to a single element; integrators may pass
+     *  the quadrature points of a whole batch of elements in a single call.
+     *  On output, \p result should be a matrix with codomainDimension() rows
+     *  and one column per point. */
     virtual void evaluate(const GeometricalData<CoordinateType>& geomData,
                           arma::Mat<ValueType>& result) const = 0;
+
+    /** \brief Return true if evaluate() may be called concurrently from
+     *  several threads.
+     *
+     *  If this function returns false, integrals involving this function
+     *  (e.g. the projections of a GridFunction) are evaluated serially. */
+    virtual bool isThreadSafe() const {
+        return true;
+    }
+};
+
+/** \brief Thread-safety traits of the functors wrapped by
+ *  SurfaceNormalIndependentFunction and SurfaceNormalDependentFunction.
+ *
+ *  Functors are assumed to be thread-safe. Specialise this template, setting
+ *  \p value to false, for functors whose evaluate() method must not be
+ *  called concurrently from several threads (e.g. ones calling into an
+ *  interpreter). */
+template <typename Functor>
+struct IsFunctorThreadSafe
+{
+    static const bool value = true;
 };
 
 } // namespace Fiber
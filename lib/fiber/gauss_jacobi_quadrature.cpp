@@ -0,0 +1,173 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gauss_jacobi_quadrature.hpp"
+
+#include "bempp/common/config_data_types.hpp"
+
+#include <boost/math/special_functions/gamma.hpp>
+#include <cmath>
+#include <stdexcept>
+
+namespace Fiber
+{
+
+namespace
+{
+
+// Golub-Welsch algorithm: the quadrature points are the eigenvalues of the
+// symmetric tridiagonal Jacobi matrix built from the three-term recurrence
+// coefficients of the orthonormal Jacobi polynomials; the weights are
+// proportional to the squares of the first components of the eigenvectors.
+void gaussJacobiInDoublePrecision(int n, double alpha, double beta,
+                                  arma::Col<double>& points,
+                                  arma::Col<double>& weights)
+{
+    if (n <= 0)
+        throw std::invalid_argument("fillGaussJacobiPointsAndWeights(): "
+                                    "pointCount must be positive");
+    if (alpha <= -1. || beta <= -1.)
+        throw std::invalid_argument("fillGaussJacobiPointsAndWeights(): "
+                                    "alpha and beta must be greater than -1");
+
+    const double ab = alpha + beta;
+    arma::Mat<double> J(n, n);
+    J.fill(0.);
+    for (int k = 0; k < n; ++k) {
+        const double twoKAb = 2. * k + ab;
+        if (k == 0)
+            J(0, 0) = (beta - alpha) / (ab + 2.);
+        else
+            J(k, k) = (beta * beta - alpha * alpha) /
+                    (twoKAb * (twoKAb + 2.));
+        if (k > 0) {
+            const double num = 4. * k * (k + alpha) * (k + beta) * (k + ab);
+            const double den = twoKAb * twoKAb * (twoKAb + 1.) * (twoKAb - 1.);
+            J(k, k - 1) = J(k - 1, k) = std::sqrt(num / den);
+        }
+    }
+
+    arma::Col<double> eigval;
+    arma::Mat<double> eigvec;
+    if (!arma::eig_sym(eigval, eigvec, J))
+        throw std::runtime_error("fillGaussJacobiPointsAndWeights(): "
+                                 "eigenvalue decomposition failed");
+
+    // Integral of the weight function over [-1, 1]
+    const double mu0 = std::pow(2., ab + 1.) *
+            boost::math::tgamma(alpha + 1.) * boost::math::tgamma(beta + 1.) /
+            boost::math::tgamma(ab + 2.);
+    points = eigval;
+    weights.set_size(n);
+    for (int k = 0; k < n; ++k)
+        weights(k) = mu0 * eigvec(0, k) * eigvec(0, k);
+}
+
+} // namespace
+
+template <typename ValueType>
+void fillGaussJacobiPointsAndWeights(int pointCount,
+                                     double alpha, double beta,
+                                     std::vector<ValueType>& points,
+                                     std::vector<ValueType>& weights)
+{
+    arma::Col<double> p, w;
+    gaussJacobiInDoublePrecision(pointCount, alpha, beta, p, w);
+    points.resize(pointCount);
+    weights.resize(pointCount);
+    for (int i = 0; i < pointCount; ++i) {
+        points[i] = p(i);
+        weights[i] = w(i);
+    }
+}
+
+template <typename ValueType>
+void fillCollapsedGaussTrianglePointsAndWeights(int accuracyOrder,
+                                                arma::Mat<ValueType>& points,
+                                                std::vector<ValueType>& weights)
+{
+    // A polynomial of degree p in (x, y) becomes, after the substitution
+    // x = u (1 - v), y = v, a polynomial of degree at most p in each of u
+    // and v; the Jacobian (1 - v) is absorbed in the Gauss-Jacobi weight.
+    const int n = std::max(accuracyOrder + 2, 2) / 2;
+
+    arma::Col<double> pu, wu, pv, wv;
+    gaussJacobiInDoublePrecision(n, 0., 0., pu, wu);
+    gaussJacobiInDoublePrecision(n, 1., 0., pv, wv);
+
+    points.set_size(2, n * n);
+    weights.resize(n * n);
+    for (int j = 0; j < n; ++j) {
+        // Map from [-1, 1] to [0, 1]; weight (1 - t) becomes 2 (1 - v)
+        const double v = 0.5 * (pv(j) + 1.);
+        const double wvj = 0.25 * wv(j);
+        for (int i = 0; i < n; ++i) {
+            const double u = 0.5 * (pu(i) + 1.);
+            const double wui = 0.5 * wu(i);
+            const int col = i + j * n;
+            points(0, col) = u * (1. - v);
+            points(1, col) = v;
+            weights[col] = wui * wvj;
+        }
+    }
+}
+
+template <typename ValueType>
+void fillGaussTensorQuadranglePointsAndWeights(int pointCountIn1d,
+                                               arma::Mat<ValueType>& points,
+                                               std::vector<ValueType>& weights)
+{
+    const int n = pointCountIn1d;
+    arma::Col<double> p, w;
+    gaussJacobiInDoublePrecision(n, 0., 0., p, w);
+
+    points.set_size(2, n * n);
+    weights.resize(n * n);
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            const int col = i + j * n;
+            points(0, col) = 0.5 * (p(i) + 1.);
+            points(1, col) = 0.5 * (p(j) + 1.);
+            weights[col] = 0.25 * w(i) * w(j);
+        }
+}
+
+#define INSTANTIATE_GAUSS_JACOBI_FUNCTIONS(VALUE) \
+    template \
+    void fillGaussJacobiPointsAndWeights<VALUE>( \
+            int pointCount, double alpha, double beta, \
+            std::vector<VALUE>& points, std::vector<VALUE>& weights); \
+    template \
+    void fillCollapsedGaussTrianglePointsAndWeights<VALUE>( \
+            int accuracyOrder, arma::Mat<VALUE>& points, \
+            std::vector<VALUE>& weights); \
+    template \
+    void fillGaussTensorQuadranglePointsAndWeights<VALUE>( \
+            int pointCountIn1d, arma::Mat<VALUE>& points, \
+            std::vector<VALUE>& weights)
+
+#ifdef ENABLE_SINGLE_PRECISION
+INSTANTIATE_GAUSS_JACOBI_FUNCTIONS(float);
+#endif
+// Always instantiated: used internally to generate singular quadrature rules
+INSTANTIATE_GAUSS_JACOBI_FUNCTIONS(double);
+
+} // namespace Fiber
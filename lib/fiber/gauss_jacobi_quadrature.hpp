@@ -0,0 +1,85 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef fiber_gauss_jacobi_quadrature_hpp
+#define fiber_gauss_jacobi_quadrature_hpp
+
+#include "../common/common.hpp"
+
+/** \file
+ *
+ *  Generators of quadrature rules of arbitrary order.
+ *
+ *  The tabulated rules from the Hyena library are limited to accuracy orders
+ *  up to 20 on triangles and to 20 points per dimension on quadrilaterals.
+ *  The functions declared in this file compute Gauss-Jacobi rules on the fly,
+ *  which makes it possible to use rules of any order. */
+
+#include "../common/armadillo_fwd.hpp"
+#include <vector>
+
+namespace Fiber
+{
+
+/** \brief Compute the points and weights of the \p pointCount-point
+ *  Gauss-Jacobi quadrature rule.
+ *
+ *  The rule integrates exactly functions of the form
+ *  \f$(1-t)^\alpha (1+t)^\beta p(t)\f$ over the interval [-1, 1], where
+ *  \f$p\f$ is a polynomial of degree up to 2 * \p pointCount - 1.
+ *  The points are computed with the Golub-Welsch algorithm and returned in
+ *  increasing order.
+ *
+ *  \param[in] pointCount Number of quadrature points (must be positive).
+ *  \param[in] alpha, beta Exponents of the weight function (must be > -1).
+ *  \param[out] points Quadrature points.
+ *  \param[out] weights Quadrature weights. */
+template <typename ValueType>
+void fillGaussJacobiPointsAndWeights(int pointCount,
+                                     double alpha, double beta,
+                                     std::vector<ValueType>& points,
+                                     std::vector<ValueType>& weights);
+
+/** \brief Compute the points and weights of a collapsed Gauss-Jacobi
+ *  quadrature rule on the reference triangle (0,0)--(1,0)--(0,1).
+ *
+ *  The rule is the image of a tensor product of a Gauss-Legendre rule and a
+ *  Gauss-Jacobi rule with weight \f$1-t\f$ under the Duffy transformation.
+ *  It uses \f$\lceil(p+1)/2\rceil^2\f$ points, where \f$p\f$ is the
+ *  requested degree of exactness \p accuracyOrder. */
+template <typename ValueType>
+void fillCollapsedGaussTrianglePointsAndWeights(int accuracyOrder,
+                                                arma::Mat<ValueType>& points,
+                                                std::vector<ValueType>& weights);
+
+/** \brief Compute the points and weights of a tensor-product Gauss-Legendre
+ *  quadrature rule on the reference square [0, 1]^2.
+ *
+ *  The rule has \p pointCountIn1d points in each dimension. Points are
+ *  numbered with the first coordinate varying fastest. */
+template <typename ValueType>
+void fillGaussTensorQuadranglePointsAndWeights(int pointCountIn1d,
+                                               arma::Mat<ValueType>& points,
+                                               std::vector<ValueType>& weights);
+
+} // namespace Fiber
+
+#endif
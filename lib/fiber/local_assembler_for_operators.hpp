@@ -27,6 +27,8 @@
 #include "scalar_traits.hpp"
 #include "types.hpp"
 
+#include "../common/armadillo_fwd.hpp"
+#include <stdexcept>
 #include <vector>
 
 namespace Fiber
@@ -84,6 +86,46 @@ public:
             std::vector<arma::Mat<ResultType> >& result,
             CoordinateType nominalDistance = -1.) = 0;
 
+    /** \brief Assemble local weak forms for several elements B at once.
+
+    This overload is equivalent to calling the overload taking a single
+    element B for each element \p elementIndicesB[j] and the local DOF
+    \p localDofIndicesB[j] in turn and storing the results in the
+    consecutive columns of \p result. In other words, on exit
+    <tt>result(i, j)</tt> is the local weak form corresponding to
+    the elements \p elementIndicesA[i] and \p elementIndicesB[j] (in the
+    order determined by \p callVariant).
+
+    The same element B may appear several times in \p elementIndicesB, with
+    different local DOFs. This overload is used to evaluate several rows or
+    columns of a matrix at once; concrete assemblers can override it to reuse
+    the geometrical data of elements across the whole batch. The default
+    implementation simply loops over the elements B. */
+    virtual void evaluateLocalWeakForms(
+            CallVariant callVariant,
+            const std::vector<int>& elementIndicesA,
+            const std::vector<int>& elementIndicesB,
+            const std::vector<LocalDofIndex>& localDofIndicesB,
+            Fiber::_2dArray<arma::Mat<ResultType> >& result,
+            CoordinateType nominalDistance = -1.) {
+        const size_t elementBCount = elementIndicesB.size();
+        if (localDofIndicesB.size() != elementBCount)
+            throw std::invalid_argument(
+                    "LocalAssemblerForOperators::evaluateLocalWeakForms(): "
+                    "elementIndicesB and localDofIndicesB must have the same "
+                    "length");
+        result.set_size(elementIndicesA.size(), elementBCount);
+        std::vector<arma::Mat<ResultType> > column;
+        for (size_t indexB = 0; indexB < elementBCount; ++indexB) {
+            evaluateLocalWeakForms(callVariant, elementIndicesA,
+                                   elementIndicesB[indexB],
+                                   localDofIndicesB[indexB],
+                                   column, nominalDistance);
+            for (size_t indexA = 0; indexA < elementIndicesA.size(); ++indexA)
+                result(indexA, indexB) = column[indexA];
+        }
+    }
+
     /** \brief Assemble local weak forms.
 
     This overload constructs and assigns to the output parameter \p result the
@@ -51,7 +51,7 @@ public:
     NonseparableNumericalTestKernelTrialIntegrator(
             const arma::Mat<CoordinateType>& localTestQuadPoints,
             const arma::Mat<CoordinateType>& localTrialQuadPoints,
-            const std::vector<CoordinateType> quadWeights,
+            const std::vector<CoordinateType>& quadWeights,
             const GeometryFactory& testGeometryFactory,
             const GeometryFactory& trialGgeometryFactory,
             const RawGridGeometry<CoordinateType>& testRawGeometry,
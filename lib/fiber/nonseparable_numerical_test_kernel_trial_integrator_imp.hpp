@@ -52,7 +52,7 @@ BasisFunctionType, KernelType, ResultType, GeometryFactory>::
 NonseparableNumericalTestKernelTrialIntegrator(
         const arma::Mat<CoordinateType>& localTestQuadPoints,
         const arma::Mat<CoordinateType>& localTrialQuadPoints,
-        const std::vector<CoordinateType> quadWeights,
+        const std::vector<CoordinateType>& quadWeights,
         const GeometryFactory& testGeometryFactory,
         const GeometryFactory& trialGeometryFactory,
         const RawGridGeometry<CoordinateType>& testRawGeometry,
@@ -49,7 +49,7 @@ public:
 
     NumericalKernelTrialIntegrator(
             const arma::Mat<CoordinateType>& localQuadPoints,
-            const std::vector<CoordinateType> quadWeights,
+            const std::vector<CoordinateType>& quadWeights,
             const arma::Mat<CoordinateType>& points,
             const GeometryFactory& geometryFactory,
             const RawGridGeometry<CoordinateType>& rawGeometry,
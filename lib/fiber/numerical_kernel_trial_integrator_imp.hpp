@@ -47,7 +47,7 @@ NumericalKernelTrialIntegrator<
 BasisFunctionType, KernelType, ResultType, GeometryFactory>::
 NumericalKernelTrialIntegrator(
         const arma::Mat<CoordinateType>& localQuadPoints,
-        const std::vector<CoordinateType> quadWeights,
+        const std::vector<CoordinateType>& quadWeights,
         const arma::Mat<CoordinateType>& points,
         const GeometryFactory& geometryFactory,
         const RawGridGeometry<CoordinateType>& rawGeometry,
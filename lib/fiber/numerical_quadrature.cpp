@@ -20,6 +20,8 @@
 
 #include "numerical_quadrature.hpp"
 
+#include "gauss_jacobi_quadrature.hpp"
+
 #include "bempp/common/config_data_types.hpp"
 
 // Hyena code
@@ -47,6 +49,15 @@ inline void reallyFillPointsAndWeightsRegular(
         // QuadratureRule<TRIANGLE, GAUSS>, which expects the exactness degree.
         order = (order + 1 + 1) / 2;
     order = std::max(order, 1); // Hyena does not accept order == 0 for triangles
+    if (SHAPE == TRIANGLE && order > int(highestOrder)) {
+        // Beyond the range of the tabulated Dunavant rules
+        fillCollapsedGaussTrianglePointsAndWeights(order, points, weights);
+        return;
+    }
+    if (SHAPE == QUADRANGLE && order > int(numberOfTensorRules)) {
+        fillGaussTensorQuadranglePointsAndWeights(order, points, weights);
+        return;
+    }
     const QuadratureRule<SHAPE, GAUSS>& rule(order);
     const int pointCount = rule.getNumPoints();
     points.set_size(elementDim, pointCount);
@@ -192,19 +203,46 @@ inline void remapPointsSharedEdge(
 }
 
 
-template<ELEMENT_SHAPE SHAPE, SING_INT SINGULARITY, typename ValueType>
-inline void reallyFillPointsAndWeightsSingular(
+/** \brief Tensor-product Gauss rule on the unit square generated on the fly.
+ *
+ *  Exposes the subset of the interface of QuadratureRule<QUADRANGLE, GAUSS>
+ *  used by GalerkinDuffyExpression, so that singular rules can be built for
+ *  orders exceeding those available in the Hyena tables. */
+class GeneratedQuadrangleRule
+{
+public:
+    explicit GeneratedQuadrangleRule(int pointCountIn1d) {
+        fillGaussTensorQuadranglePointsAndWeights(
+                    pointCountIn1d, m_points, m_weights);
+    }
+
+    unsigned int getNumPoints() const {
+        return m_weights.size();
+    }
+
+    const Point2 getPoint(unsigned int node) const {
+        return Point2(m_points(0, node), m_points(1, node));
+    }
+
+    double getWeight(unsigned int node) const {
+        return m_weights[node];
+    }
+
+private:
+    arma::Mat<double> m_points;
+    std::vector<double> m_weights;
+};
+
+template<ELEMENT_SHAPE SHAPE, SING_INT SINGULARITY, typename Rule,
+         typename ValueType>
+inline void fillPointsAndWeightsSingularFromRule(
+        const Rule& rule,
         const DoubleQuadratureDescriptor& desc,
         arma::Mat<ValueType>& testPoints,
         arma::Mat<ValueType>& trialPoints,
         std::vector<ValueType>& weights)
 {
     const int elementDim = 2;
-    // Is there a more efficient way?
-    const int order = std::max(desc.testOrder, desc.trialOrder);
-    const int numPointsIn1d = (order + 1 + 1) / 2;
-    // quadrangle regardless of SHAPE
-    const QuadratureRule<QUADRANGLE, GAUSS> rule(numPointsIn1d);
     const GalerkinDuffyExpression<SHAPE, SINGULARITY> transform(rule);
     const int pointCount = rule.getNumPoints();
     const int regionCount = transform.getNumRegions();
@@ -277,6 +315,28 @@ inline void reallyFillPointsAndWeightsSingular(
     }
 }
 
+template<ELEMENT_SHAPE SHAPE, SING_INT SINGULARITY, typename ValueType>
+inline void reallyFillPointsAndWeightsSingular(
+        const DoubleQuadratureDescriptor& desc,
+        arma::Mat<ValueType>& testPoints,
+        arma::Mat<ValueType>& trialPoints,
+        std::vector<ValueType>& weights)
+{
+    // Is there a more efficient way?
+    const int order = std::max(desc.testOrder, desc.trialOrder);
+    const int numPointsIn1d = std::max((order + 1 + 1) / 2, 1);
+    // quadrangle regardless of SHAPE
+    if (numPointsIn1d <= int(numberOfTensorRules)) {
+        const QuadratureRule<QUADRANGLE, GAUSS> rule(numPointsIn1d);
+        fillPointsAndWeightsSingularFromRule<SHAPE, SINGULARITY>(
+                    rule, desc, testPoints, trialPoints, weights);
+    } else {
+        const GeneratedQuadrangleRule rule(numPointsIn1d);
+        fillPointsAndWeightsSingularFromRule<SHAPE, SINGULARITY>(
+                    rule, desc, testPoints, trialPoints, weights);
+    }
+}
+
 } // namespace
 
 // User-callable functions
@@ -117,6 +117,8 @@ inline size_t tbb_hasher(const DoubleQuadratureDescriptor& d)
  *    Number of corners of the element to be integrated on.
  *  \param[in] accuracyOrder
  *    Accuracy order of the quadrature, i.e. its degree of exactness.
+ *    Tabulated rules are used whenever available; rules of higher orders are
+ *    generated on the fly (see gauss_jacobi_quadrature.hpp).
  *  \param[out] points
  *    Quadrature points.
  *  \param[out] weights
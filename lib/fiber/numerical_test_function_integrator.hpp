@@ -31,6 +31,7 @@ namespace Fiber
 /** \cond FORWARD_DECL */
 class OpenClHandler;
 template <typename CoordinateType> class CollectionOfBasisTransformations;
+template <typename CoordinateType> class GeometricalData;
 template <typename ValueType> class Function;
 template <typename CoordinateType> class RawGridGeometry;
 /** \endcond */
@@ -47,7 +48,7 @@ public:
 
     NumericalTestFunctionIntegrator(
             const arma::Mat<CoordinateType>& localQuadPoints,
-            const std::vector<CoordinateType> quadWeights,
+            const std::vector<CoordinateType>& quadWeights,
             const GeometryFactory& geometryFactory,
             const RawGridGeometry<CoordinateType>& rawGeometry,
             const CollectionOfBasisTransformations<CoordinateType>& testTransformations,
@@ -59,6 +60,16 @@ public:
             const Basis<BasisFunctionType>& testBasis,
             arma::Mat<ResultType>& result) const;
 
+    /** \brief Maximum number of elements at whose quadrature points the
+     *  function is evaluated in a single call. */
+    static const size_t FUNCTION_EVALUATION_BATCH_SIZE = 1024;
+
+private:
+    void appendGeometricalData(
+            const GeometricalData<CoordinateType>& elementGeomData,
+            size_t elementIndexInBatch, size_t batchSize,
+            GeometricalData<CoordinateType>& batchGeomData) const;
+
 private:
     arma::Mat<CoordinateType> m_localQuadPoints;
     std::vector<CoordinateType> m_quadWeights;
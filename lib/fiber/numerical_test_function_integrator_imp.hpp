@@ -22,6 +22,7 @@
 
 #include "../common/common.hpp"
 
+#include "_3d_array.hpp"
 #include "basis.hpp"
 #include "basis_data.hpp"
 #include "collection_of_basis_transformations.hpp"
@@ -32,6 +33,7 @@
 #include "raw_grid_geometry.hpp"
 #include "types.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <memory>
 
@@ -44,7 +46,7 @@ NumericalTestFunctionIntegrator<
 BasisFunctionType, UserFunctionType, ResultType, GeometryFactory>::
 NumericalTestFunctionIntegrator(
         const arma::Mat<CoordinateType>& localQuadPoints,
-        const std::vector<CoordinateType> quadWeights,
+        const std::vector<CoordinateType>& quadWeights,
         const GeometryFactory& geometryFactory,
         const RawGridGeometry<CoordinateType>& rawGeometry,
         const CollectionOfBasisTransformations<CoordinateType>& testTransformations,
@@ -116,26 +118,105 @@ integrate(
 
     testBasis.evaluate(testBasisDeps, m_localQuadPoints, ALL_DOFS, testBasisData);
 
-    // Iterate over the elements
-    for (size_t e = 0; e < elementCount; ++e)
+    // The function is evaluated at the quadrature points of a whole batch of
+    // elements at once, so that functors with an expensive call mechanism
+    // (e.g. Python callbacks) are invoked only once per batch
+    const size_t maxBatchSize = FUNCTION_EVALUATION_BATCH_SIZE;
+    GeometricalData<CoordinateType> batchGeomData;
+    _3dArray<BasisFunctionType> batchTestValues(
+                componentCount, testDofCount,
+                std::min(elementCount, maxBatchSize) * pointCount);
+
+    for (size_t batchStart = 0; batchStart < elementCount;
+         batchStart += maxBatchSize)
     {
-        m_rawGeometry.setupGeometry(elementIndices[e], *geometry);
-        geometry->getData(geomDeps, m_localQuadPoints, geomData);
-        m_testTransformations.evaluate(testBasisData, geomData, testValues);
-        m_function.evaluate(geomData, functionValues);
+        const size_t batchSize =
+                std::min(elementCount - batchStart, maxBatchSize);
 
-        for (int testDof = 0; testDof < testDofCount; ++testDof)
+        // Gather the geometrical data of all elements of the batch
+        for (size_t e = 0; e < batchSize; ++e)
         {
-            ResultType sum = 0.;
+            m_rawGeometry.setupGeometry(elementIndices[batchStart + e],
+                                        *geometry);
+            geometry->getData(geomDeps, m_localQuadPoints, geomData);
+            m_testTransformations.evaluate(testBasisData, geomData, testValues);
             for (size_t point = 0; point < pointCount; ++point)
-                for (int dim = 0; dim < componentCount; ++dim)
-                    sum +=  m_quadWeights[point] *
-                            geomData.integrationElements(point) *
-                            conjugate(testValues[0](dim, testDof, point)) *
-                            functionValues(dim, point);
-            result(testDof, e) = sum;
+                for (int testDof = 0; testDof < testDofCount; ++testDof)
+                    for (int dim = 0; dim < componentCount; ++dim)
+                        batchTestValues(dim, testDof, e * pointCount + point) =
+                                testValues[0](dim, testDof, point);
+            appendGeometricalData(geomData, e, batchSize, batchGeomData);
         }
+
+        m_function.evaluate(batchGeomData, functionValues);
+
+        for (size_t e = 0; e < batchSize; ++e)
+        {
+            const size_t offset = e * pointCount;
+            for (int testDof = 0; testDof < testDofCount; ++testDof)
+            {
+                ResultType sum = 0.;
+                for (size_t point = 0; point < pointCount; ++point)
+                    for (int dim = 0; dim < componentCount; ++dim)
+                        sum +=  m_quadWeights[point] *
+                                batchGeomData.integrationElements(offset + point) *
+                                conjugate(batchTestValues(dim, testDof, offset + point)) *
+                                functionValues(dim, offset + point);
+                result(testDof, batchStart + e) = sum;
+            }
+        }
+    }
+}
+
+template <typename BasisFunctionType, typename UserFunctionType,
+          typename ResultType, typename GeometryFactory>
+void NumericalTestFunctionIntegrator<
+BasisFunctionType, UserFunctionType, ResultType, GeometryFactory>::
+appendGeometricalData(
+        const GeometricalData<CoordinateType>& elementGeomData,
+        size_t elementIndexInBatch, size_t batchSize,
+        GeometricalData<CoordinateType>& batchGeomData) const
+{
+    const size_t pointCount = m_localQuadPoints.n_cols;
+    const size_t totalPointCount = batchSize * pointCount;
+    const size_t first = elementIndexInBatch * pointCount;
+    const size_t last = first + pointCount - 1;
+
+    if (elementIndexInBatch == 0) {
+        batchGeomData.globals.set_size(
+                    elementGeomData.globals.n_rows,
+                    elementGeomData.globals.is_empty() ? 0 : totalPointCount);
+        batchGeomData.integrationElements.set_size(
+                    elementGeomData.integrationElements.is_empty() ?
+                        0 : totalPointCount);
+        batchGeomData.jacobiansTransposed.set_size(
+                    elementGeomData.jacobiansTransposed.n_rows,
+                    elementGeomData.jacobiansTransposed.n_cols,
+                    elementGeomData.jacobiansTransposed.is_empty() ?
+                        0 : totalPointCount);
+        batchGeomData.jacobianInversesTransposed.set_size(
+                    elementGeomData.jacobianInversesTransposed.n_rows,
+                    elementGeomData.jacobianInversesTransposed.n_cols,
+                    elementGeomData.jacobianInversesTransposed.is_empty() ?
+                        0 : totalPointCount);
+        batchGeomData.normals.set_size(
+                    elementGeomData.normals.n_rows,
+                    elementGeomData.normals.is_empty() ? 0 : totalPointCount);
     }
+
+    if (!elementGeomData.globals.is_empty())
+        batchGeomData.globals.cols(first, last) = elementGeomData.globals;
+    if (!elementGeomData.integrationElements.is_empty())
+        batchGeomData.integrationElements.cols(first, last) =
+                elementGeomData.integrationElements;
+    if (!elementGeomData.jacobiansTransposed.is_empty())
+        batchGeomData.jacobiansTransposed.slices(first, last) =
+                elementGeomData.jacobiansTransposed;
+    if (!elementGeomData.jacobianInversesTransposed.is_empty())
+        batchGeomData.jacobianInversesTransposed.slices(first, last) =
+                elementGeomData.jacobianInversesTransposed;
+    if (!elementGeomData.normals.is_empty())
+        batchGeomData.normals.cols(first, last) = elementGeomData.normals;
 }
 
 } // namespace Fiber
@@ -46,7 +46,7 @@ public:
 
     NumericalTestTrialIntegrator(
             const arma::Mat<CoordinateType>& localQuadPoints,
-            const std::vector<CoordinateType> quadWeights,
+            const std::vector<CoordinateType>& quadWeights,
             const GeometryFactory& geometryFactory,
             const RawGridGeometry<CoordinateType>& rawGeometry,
             const CollectionOfBasisTransformations<CoordinateType>& testTransformations,
@@ -41,7 +41,7 @@ template <typename BasisFunctionType, typename ResultType, typename GeometryFact
 NumericalTestTrialIntegrator<BasisFunctionType, ResultType, GeometryFactory>::
 NumericalTestTrialIntegrator(
         const arma::Mat<CoordinateType>& localQuadPoints,
-        const std::vector<CoordinateType> quadWeights,
+        const std::vector<CoordinateType>& quadWeights,
         const GeometryFactory& geometryFactory,
         const RawGridGeometry<CoordinateType>& rawGeometry,
         const CollectionOfBasisTransformations<CoordinateType>& testTransformations,
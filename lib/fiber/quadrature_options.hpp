@@ -58,6 +58,16 @@ public:
         m_value = offset;
     }
 
+    /** \brief Increase the quadrature accuracy order by \p offset.
+     *
+     *  \p offset may be negative. If the order is absolute, it is not
+     *  decreased below zero. */
+    void increaseQuadratureOrder(int offset) {
+        m_value += offset;
+        if (!m_relative && m_value < 0)
+            m_value = 0;
+    }
+
     /** \brief Get quadrature accuracy order assuming that its default value is
      *  \p defaultOrder. */
     int quadratureOrder(int defaultOrder) const {
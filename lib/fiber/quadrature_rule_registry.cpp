@@ -0,0 +1,131 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "quadrature_rule_registry.hpp"
+
+#include "bempp/common/config_data_types.hpp"
+
+#include <memory>
+
+namespace Fiber
+{
+
+template <typename ValueType>
+QuadratureRuleRegistry<ValueType>& QuadratureRuleRegistry<ValueType>::instance()
+{
+    // Initialisation of function-local statics is thread-safe with all the
+    // compilers we support
+    static QuadratureRuleRegistry registry;
+    return registry;
+}
+
+template <typename ValueType>
+QuadratureRuleRegistry<ValueType>::QuadratureRuleRegistry()
+{
+}
+
+template <typename ValueType>
+QuadratureRuleRegistry<ValueType>::~QuadratureRuleRegistry()
+{
+    // Called at program exit, after all threads have stopped using the rules
+    for (typename SingleRuleMap::const_iterator it = m_singleRules.begin();
+         it != m_singleRules.end(); ++it)
+        delete it->second;
+    for (typename DoubleRuleMap::const_iterator it = m_doubleSingularRules.begin();
+         it != m_doubleSingularRules.end(); ++it)
+        delete it->second;
+}
+
+template <typename ValueType>
+const SingleQuadratureRule<ValueType>&
+QuadratureRuleRegistry<ValueType>::singleRule(
+        const SingleQuadratureDescriptor& desc)
+{
+    typename SingleRuleMap::const_iterator it = m_singleRules.find(desc);
+    if (it != m_singleRules.end())
+        return *it->second;
+
+    // Rule doesn't exist yet and must be created.
+    std::auto_ptr<SingleRule> rule(new SingleRule);
+    fillSingleQuadraturePointsAndWeights(desc.vertexCount, desc.order,
+                                         rule->points, rule->weights);
+
+    // Attempt to insert the newly created rule into the map. If another
+    // thread was faster, our copy is deleted by the auto_ptr.
+    std::pair<typename SingleRuleMap::iterator, bool> result =
+            m_singleRules.insert(std::make_pair(desc, rule.get()));
+    if (result.second)
+        rule.release();
+    return *result.first->second;
+}
+
+template <typename ValueType>
+const SingleQuadratureRule<ValueType>&
+QuadratureRuleRegistry<ValueType>::singleRule(
+        int elementCornerCount, int accuracyOrder)
+{
+    SingleQuadratureDescriptor desc;
+    desc.vertexCount = elementCornerCount;
+    desc.order = accuracyOrder;
+    return singleRule(desc);
+}
+
+template <typename ValueType>
+const DoubleQuadratureRule<ValueType>&
+QuadratureRuleRegistry<ValueType>::doubleSingularRule(
+        const DoubleQuadratureDescriptor& desc)
+{
+    typename DoubleRuleMap::const_iterator it = m_doubleSingularRules.find(desc);
+    if (it != m_doubleSingularRules.end())
+        return *it->second;
+
+    // Rule doesn't exist yet and must be created.
+    std::auto_ptr<DoubleRule> rule(new DoubleRule);
+    fillDoubleSingularQuadraturePointsAndWeights(
+                desc, rule->testPoints, rule->trialPoints, rule->weights);
+
+    std::pair<typename DoubleRuleMap::iterator, bool> result =
+            m_doubleSingularRules.insert(std::make_pair(desc, rule.get()));
+    if (result.second)
+        rule.release();
+    return *result.first->second;
+}
+
+template <typename ValueType>
+size_t QuadratureRuleRegistry<ValueType>::singleRuleCount() const
+{
+    return m_singleRules.size();
+}
+
+template <typename ValueType>
+size_t QuadratureRuleRegistry<ValueType>::doubleSingularRuleCount() const
+{
+    return m_doubleSingularRules.size();
+}
+
+#ifdef ENABLE_SINGLE_PRECISION
+template class QuadratureRuleRegistry<float>;
+#endif
+#ifdef ENABLE_DOUBLE_PRECISION
+template class QuadratureRuleRegistry<double>;
+#endif
+
+} // namespace Fiber
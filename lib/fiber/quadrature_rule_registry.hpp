@@ -0,0 +1,126 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef fiber_quadrature_rule_registry_hpp
+#define fiber_quadrature_rule_registry_hpp
+
+#include "../common/common.hpp"
+
+#include "numerical_quadrature.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <boost/noncopyable.hpp>
+#include <tbb/concurrent_unordered_map.h>
+#include <vector>
+
+namespace Fiber
+{
+
+/** \brief Points and weights of a quadrature rule over a single element. */
+template <typename ValueType>
+struct SingleQuadratureRule
+{
+    /** \brief Quadrature points (in local coordinates, stored columnwise). */
+    arma::Mat<ValueType> points;
+    /** \brief Quadrature weights. */
+    std::vector<ValueType> weights;
+};
+
+/** \brief Points and weights of a quadrature rule over a pair of elements. */
+template <typename ValueType>
+struct DoubleQuadratureRule
+{
+    /** \brief Quadrature points on the test element. */
+    arma::Mat<ValueType> testPoints;
+    /** \brief Quadrature points on the trial element. */
+    arma::Mat<ValueType> trialPoints;
+    /** \brief Quadrature weights. */
+    std::vector<ValueType> weights;
+};
+
+/** \brief Process-wide registry of quadrature rules.
+ *
+ *  Quadrature rules are generated on first request and stored for the rest
+ *  of the program's lifetime, so that local assemblers and evaluators
+ *  constructed later can reuse them instead of regenerating the rules from
+ *  the Hyena tables (and, for singular integrals, redoing the Sauter-Schwab
+ *  transformation and the remapping of points to the shared vertices or
+ *  edges).
+ *
+ *  All member functions are thread-safe. The returned rules are immutable and
+ *  references to them remain valid until the end of the program.
+ *
+ *  Use instance() to obtain the registry for a particular \p ValueType. */
+template <typename ValueType>
+class QuadratureRuleRegistry : public boost::noncopyable
+{
+public:
+    typedef SingleQuadratureRule<ValueType> SingleRule;
+    typedef DoubleQuadratureRule<ValueType> DoubleRule;
+
+    /** \brief Return the process-wide registry. */
+    static QuadratureRuleRegistry& instance();
+
+    /** \brief Return the quadrature rule over a single element described by
+     *  \p desc.
+     *
+     *  The points and weights are identical to those produced by
+     *  fillSingleQuadraturePointsAndWeights(). */
+    const SingleRule& singleRule(const SingleQuadratureDescriptor& desc);
+
+    /** \brief Return the quadrature rule over a single element with
+     *  \p elementCornerCount corners and exactness degree \p accuracyOrder. */
+    const SingleRule& singleRule(int elementCornerCount, int accuracyOrder);
+
+    /** \brief Return the singular quadrature rule over the pair of elements
+     *  described by \p desc.
+     *
+     *  The points and weights are identical to those produced by
+     *  fillDoubleSingularQuadraturePointsAndWeights(). */
+    const DoubleRule& doubleSingularRule(const DoubleQuadratureDescriptor& desc);
+
+    /** \brief Return the number of rules over single elements currently
+     *  stored in the registry. */
+    size_t singleRuleCount() const;
+
+    /** \brief Return the number of rules over element pairs currently stored
+     *  in the registry. */
+    size_t doubleSingularRuleCount() const;
+
+private:
+    QuadratureRuleRegistry();
+    ~QuadratureRuleRegistry();
+
+private:
+    /** \cond PRIVATE */
+    typedef tbb::concurrent_unordered_map<SingleQuadratureDescriptor,
+    SingleRule*> SingleRuleMap;
+    typedef tbb::concurrent_unordered_map<DoubleQuadratureDescriptor,
+    DoubleRule*> DoubleRuleMap;
+
+    SingleRuleMap m_singleRules;
+    DoubleRuleMap m_doubleSingularRules;
+    /** \endcond */
+};
+
+} // namespace Fiber
+
+#endif
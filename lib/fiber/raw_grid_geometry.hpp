@@ -24,6 +24,7 @@
 #include "../common/common.hpp"
 
 #include "../common/armadillo_fwd.hpp"
+#include <stdexcept>
 
 namespace Fiber
 {
@@ -66,12 +67,21 @@ public:
         return m_worldDim;
     }
 
-    /** \brief Indices of the corners of the given element. */
+    /** \brief Indices of the corners of the given element.
+     *
+     *  This function allocates a new vector. In performance-critical code use
+     *  elementCornerIndexArray() and elementCornerCount() instead. */
     arma::Col<int> elementCornerIndices(int elementIndex) const {
         const int n = elementCornerCount(elementIndex);
         return m_elementCornerIndices(arma::span(0, n - 1), arma::span(elementIndex));
     }
 
+    /** \brief Pointer to the elementCornerCount(\p elementIndex) indices of
+     *  the corners of the given element. */
+    const int* elementCornerIndexArray(int elementIndex) const {
+        return m_elementCornerIndices.colptr(elementIndex);
+    }
+
     /** \brief Number of corners of the given element. */
     int elementCornerCount(int elementIndex) const {
         int n = m_elementCornerIndices.n_rows;
@@ -96,18 +106,50 @@ public:
 
     // Auxiliary functions
 
+    /** \brief Remove the padding rows of elementCornerIndices() if all
+     *  elements are triangles.
+     *
+     *  If the grid is two-dimensional, embedded in 3D space and all its
+     *  elements are triangles, the corner indices of each element then
+     *  occupy a column of three integers. Otherwise this function does
+     *  nothing.
+     *
+     *  It should be called once vertices() and elementCornerIndices() have
+     *  been filled. */
+    void removeCornerIndexPadding()
+    {
+        if (m_gridDim != 2 || m_worldDim != 3 || m_vertices.n_rows != 3 ||
+                m_elementCornerIndices.n_rows <= 3)
+            return;
+        const int elementCount = m_elementCornerIndices.n_cols;
+        for (int e = 0; e < elementCount; ++e)
+            if (elementCornerCount(e) != 3)
+                return;
+        m_elementCornerIndices.shed_rows(3, m_elementCornerIndices.n_rows - 1);
+    }
+
     template <typename Geometry>
     void setupGeometry(int elementIndex, Geometry& geometry) const
     {
+        const int MAX_CORNER_COUNT = 4, MAX_WORLD_DIM = 3;
         const int dimGrid = m_vertices.n_rows;
-        size_t cornerCount = 0;
-        for (; cornerCount < m_elementCornerIndices.n_rows; ++cornerCount)
-            if (m_elementCornerIndices(cornerCount, elementIndex) < 0)
-                break;
-        arma::Mat<CoordinateType> corners(dimGrid, cornerCount);
-        for (size_t cornerIndex = 0; cornerIndex < cornerCount; ++cornerIndex)
-            corners.col(cornerIndex) = m_vertices.col(
-                        m_elementCornerIndices(cornerIndex, elementIndex));
+        const int cornerCount = elementCornerCount(elementIndex);
+        if (dimGrid > MAX_WORLD_DIM || cornerCount > MAX_CORNER_COUNT)
+            throw std::invalid_argument("RawGridGeometry::setupGeometry(): "
+                                        "unsupported element type");
+        // Avoid a heap allocation by letting the corner matrix use a buffer
+        // on the stack
+        CoordinateType buffer[MAX_WORLD_DIM * MAX_CORNER_COUNT];
+        arma::Mat<CoordinateType> corners(buffer, dimGrid, cornerCount,
+                                          false /* copy_aux_mem */,
+                                          true /* strict */);
+        const int* cornerIndices = elementCornerIndexArray(elementIndex);
+        for (int cornerIndex = 0; cornerIndex < cornerCount; ++cornerIndex) {
+            const CoordinateType* vertex =
+                    m_vertices.colptr(cornerIndices[cornerIndex]);
+            for (int i = 0; i < dimGrid; ++i)
+                corners(i, cornerIndex) = vertex[i];
+        }
         geometry.setup(corners, m_auxData.unsafe_col(elementIndex));
     }
 
@@ -53,8 +53,8 @@ public:
     SeparableNumericalTestKernelTrialIntegrator(
             const arma::Mat<CoordinateType>& localTestQuadPoints,
             const arma::Mat<CoordinateType>& localTrialQuadPoints,
-            const std::vector<CoordinateType> testQuadWeights,
-            const std::vector<CoordinateType> trialQuadWeights,
+            const std::vector<CoordinateType>& testQuadWeights,
+            const std::vector<CoordinateType>& trialQuadWeights,
             const GeometryFactory& testGeometryFactory,
             const GeometryFactory& trialGeometryFactory,
             const RawGridGeometry<CoordinateType>& testRawGeometry,
@@ -82,7 +82,25 @@ public:
             const Basis<BasisFunctionType>& trialBasis,
             const std::vector<arma::Mat<ResultType>*>& result) const;
 
+    virtual void integrate(
+            CallVariant callVariant,
+            const std::vector<int>& elementIndicesA,
+            const std::vector<int>& elementIndicesB,
+            const Basis<BasisFunctionType>& basisA,
+            const Basis<BasisFunctionType>& basisB,
+            const std::vector<LocalDofIndex>& localDofIndicesB,
+            const std::vector<arma::Mat<ResultType>*>& result) const;
+
 private:
+    void integrateCpu(
+            CallVariant callVariant,
+            const std::vector<int>& elementIndicesA,
+            const std::vector<int>& elementIndicesB,
+            const Basis<BasisFunctionType>& basisA,
+            const Basis<BasisFunctionType>& basisB,
+            const std::vector<LocalDofIndex>& localDofIndicesB,
+            const std::vector<arma::Mat<ResultType>*>& result) const;
+
     void integrateCpu(
             CallVariant callVariant,
             const std::vector<int>& elementIndicesA,
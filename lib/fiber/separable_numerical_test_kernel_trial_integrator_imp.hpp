@@ -42,6 +42,7 @@
 
 #include "../common/auto_timer.hpp"
 
+#include <boost/scoped_array.hpp>
 #include <cassert>
 #include <memory>
 
@@ -55,8 +56,8 @@ BasisFunctionType, KernelType, ResultType, GeometryFactory>::
 SeparableNumericalTestKernelTrialIntegrator(
         const arma::Mat<CoordinateType>& localTestQuadPoints,
         const arma::Mat<CoordinateType>& localTrialQuadPoints,
-        const std::vector<CoordinateType> testQuadWeights,
-        const std::vector<CoordinateType> trialQuadWeights,
+        const std::vector<CoordinateType>& testQuadWeights,
+        const std::vector<CoordinateType>& trialQuadWeights,
         const GeometryFactory& testGeometryFactory,
         const GeometryFactory& trialGeometryFactory,
         const RawGridGeometry<CoordinateType>& testRawGeometry,
@@ -251,6 +252,166 @@ integrateCpu(
     }
 }
 
+template <typename BasisFunctionType, typename KernelType,
+          typename ResultType, typename GeometryFactory>
+void SeparableNumericalTestKernelTrialIntegrator<
+BasisFunctionType, KernelType, ResultType, GeometryFactory>::
+integrate(
+        CallVariant callVariant,
+        const std::vector<int>& elementIndicesA,
+        const std::vector<int>& elementIndicesB,
+        const Basis<BasisFunctionType>& basisA,
+        const Basis<BasisFunctionType>& basisB,
+        const std::vector<LocalDofIndex>& localDofIndicesB,
+        const std::vector<arma::Mat<ResultType>*>& result) const
+{
+    if (m_openClHandler.UseOpenCl())
+        // Process one element B at a time
+        Base::integrate(callVariant, elementIndicesA, elementIndicesB,
+                        basisA, basisB, localDofIndicesB, result);
+    else
+        integrateCpu(callVariant, elementIndicesA, elementIndicesB,
+                     basisA, basisB, localDofIndicesB, result);
+}
+
+template <typename BasisFunctionType, typename KernelType,
+          typename ResultType, typename GeometryFactory>
+void SeparableNumericalTestKernelTrialIntegrator<
+BasisFunctionType, KernelType, ResultType, GeometryFactory>::
+integrateCpu(
+        CallVariant callVariant,
+        const std::vector<int>& elementIndicesA,
+        const std::vector<int>& elementIndicesB,
+        const Basis<BasisFunctionType>& basisA,
+        const Basis<BasisFunctionType>& basisB,
+        const std::vector<LocalDofIndex>& localDofIndicesB,
+        const std::vector<arma::Mat<ResultType>*>& result) const
+{
+    const int testPointCount = m_localTestQuadPoints.n_cols;
+    const int trialPointCount = m_localTrialQuadPoints.n_cols;
+    const size_t elementACount = elementIndicesA.size();
+    const size_t elementBCount = elementIndicesB.size();
+
+    if (localDofIndicesB.size() != elementBCount)
+        throw std::invalid_argument(
+            "SeparableNumericalTestKernelTrialIntegrator::integrate(): "
+            "arrays 'localDofIndicesB' and 'elementIndicesB' must have the "
+            "same number of elements");
+    if (result.size() != elementACount * elementBCount)
+        throw std::invalid_argument(
+            "SeparableNumericalTestKernelTrialIntegrator::integrate(): "
+            "the length of 'result' must be equal to the product of the "
+            "lengths of 'elementIndicesA' and 'elementIndicesB'");
+    if (testPointCount == 0 || trialPointCount == 0 ||
+            elementACount == 0 || elementBCount == 0)
+        return;
+
+    size_t testBasisDeps = 0, trialBasisDeps = 0;
+    size_t testGeomDeps = 0, trialGeomDeps = 0;
+
+    m_testTransformations.addDependencies(testBasisDeps, testGeomDeps);
+    m_trialTransformations.addDependencies(trialBasisDeps, trialGeomDeps);
+    m_kernels.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
+    m_integral.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
+
+    // Select the quantities pertaining to elements A and B
+    const bool aIsTest = (callVariant == TEST_TRIAL);
+    const arma::Mat<CoordinateType>& localQuadPointsA =
+            aIsTest ? m_localTestQuadPoints : m_localTrialQuadPoints;
+    const arma::Mat<CoordinateType>& localQuadPointsB =
+            aIsTest ? m_localTrialQuadPoints : m_localTestQuadPoints;
+    const size_t basisDepsA = aIsTest ? testBasisDeps : trialBasisDeps;
+    const size_t basisDepsB = aIsTest ? trialBasisDeps : testBasisDeps;
+    const size_t geomDepsA = aIsTest ? testGeomDeps : trialGeomDeps;
+    const size_t geomDepsB = aIsTest ? trialGeomDeps : testGeomDeps;
+    const CollectionOfBasisTransformations<CoordinateType>& transformationsA =
+            aIsTest ? m_testTransformations : m_trialTransformations;
+    const CollectionOfBasisTransformations<CoordinateType>& transformationsB =
+            aIsTest ? m_trialTransformations : m_testTransformations;
+    const RawGridGeometry<CoordinateType>& rawGeometryA =
+            aIsTest ? m_testRawGeometry : m_trialRawGeometry;
+    const RawGridGeometry<CoordinateType>& rawGeometryB =
+            aIsTest ? m_trialRawGeometry : m_testRawGeometry;
+
+    typedef typename GeometryFactory::Geometry Geometry;
+    std::auto_ptr<Geometry> geometryA, geometryB;
+    if (aIsTest) {
+        geometryA = m_testGeometryFactory.make();
+        geometryB = m_trialGeometryFactory.make();
+    } else {
+        geometryA = m_trialGeometryFactory.make();
+        geometryB = m_testGeometryFactory.make();
+    }
+
+    // Geometrical data and transformed basis functions on the elements A are
+    // calculated only once and reused for all elements B
+    BasisData<BasisFunctionType> basisDataA, basisDataB;
+    basisA.evaluate(basisDepsA, localQuadPointsA, ALL_DOFS, basisDataA);
+
+    boost::scoped_array<GeometricalData<CoordinateType> > geomDataA(
+                new GeometricalData<CoordinateType>[elementACount]);
+    boost::scoped_array<CollectionOf3dArrays<BasisFunctionType> > valuesA(
+                new CollectionOf3dArrays<BasisFunctionType>[elementACount]);
+    for (size_t indexA = 0; indexA < elementACount; ++indexA) {
+        bool needed = false;
+        for (size_t indexB = 0; indexB < elementBCount && !needed; ++indexB)
+            needed = result[indexA + indexB * elementACount] != 0;
+        if (!needed)
+            continue;
+        rawGeometryA.setupGeometry(elementIndicesA[indexA], *geometryA);
+        geometryA->getData(geomDepsA, localQuadPointsA, geomDataA[indexA]);
+        transformationsA.evaluate(basisDataA, geomDataA[indexA], valuesA[indexA]);
+    }
+
+    GeometricalData<CoordinateType> geomDataB;
+    CollectionOf3dArrays<BasisFunctionType> valuesB;
+    CollectionOf4dArrays<KernelType> kernelValues;
+    const int dofCountA = basisA.size();
+    LocalDofIndex evaluatedLocalDofIndexB = ALL_DOFS;
+
+    for (size_t indexB = 0; indexB < elementBCount; ++indexB) {
+        const LocalDofIndex localDofIndexB = localDofIndicesB[indexB];
+        if (indexB == 0 || localDofIndexB != evaluatedLocalDofIndexB) {
+            basisB.evaluate(basisDepsB, localQuadPointsB, localDofIndexB,
+                            basisDataB);
+            evaluatedLocalDofIndexB = localDofIndexB;
+        }
+        const int dofCountB =
+                localDofIndexB == ALL_DOFS ? basisB.size() : 1;
+        const int testDofCount = aIsTest ? dofCountA : dofCountB;
+        const int trialDofCount = aIsTest ? dofCountB : dofCountA;
+
+        rawGeometryB.setupGeometry(elementIndicesB[indexB], *geometryB);
+        geometryB->getData(geomDepsB, localQuadPointsB, geomDataB);
+        transformationsB.evaluate(basisDataB, geomDataB, valuesB);
+
+        for (size_t indexA = 0; indexA < elementACount; ++indexA) {
+            arma::Mat<ResultType>* localResult =
+                    result[indexA + indexB * elementACount];
+            if (!localResult)
+                continue;
+            localResult->set_size(testDofCount, trialDofCount);
+            if (aIsTest) {
+                m_kernels.evaluateOnGrid(geomDataA[indexA], geomDataB,
+                                         kernelValues);
+                m_integral.evaluateWithTensorQuadratureRule(
+                            geomDataA[indexA], geomDataB,
+                            valuesA[indexA], valuesB,
+                            kernelValues, m_testQuadWeights, m_trialQuadWeights,
+                            *localResult);
+            } else {
+                m_kernels.evaluateOnGrid(geomDataB, geomDataA[indexA],
+                                         kernelValues);
+                m_integral.evaluateWithTensorQuadratureRule(
+                            geomDataB, geomDataA[indexA],
+                            valuesB, valuesA[indexA],
+                            kernelValues, m_testQuadWeights, m_trialQuadWeights,
+                            *localResult);
+            }
+        }
+    }
+}
+
 template <typename BasisFunctionType, typename KernelType,
           typename ResultType, typename GeometryFactory>
 void
@@ -83,6 +83,10 @@ public:
         geomDeps |= GLOBALS | NORMALS;
     }
 
+    virtual bool isThreadSafe() const {
+        return IsFunctorThreadSafe<Functor>::value;
+    }
+
     virtual void evaluate(const GeometricalData<CoordinateType>& geomData,
                           arma::Mat<ValueType>& result) const {
         const arma::Mat<CoordinateType>& points  = geomData.globals;
@@ -84,6 +84,10 @@ public:
         geomDeps |= GLOBALS;
     }
 
+    virtual bool isThreadSafe() const {
+        return IsFunctorThreadSafe<Functor>::value;
+    }
+
     virtual void evaluate(const GeometricalData<CoordinateType>& geomData,
                           arma::Mat<ValueType>& result) const {
         const arma::Mat<CoordinateType>& points = geomData.globals;
@@ -27,6 +27,7 @@
 #include "types.hpp"
 
 #include "../common/armadillo_fwd.hpp"
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -61,6 +62,53 @@ public:
             const Basis<BasisFunctionType>& testBasis,
             const Basis<BasisFunctionType>& trialBasis,
             const std::vector<arma::Mat<ResultType>*>& result) const = 0;
+
+    /** \brief Integrate over all pairs of elements from two lists.
+     *
+     *  This overload is equivalent to calling the single-element-B overload
+     *  for each element \p elementIndicesB[j] (and the local DOF
+     *  \p localDofIndicesB[j]) in turn. The local weak form for the pair
+     *  formed by elements \p elementIndicesA[i] and \p elementIndicesB[j] is
+     *  stored in <tt>*result[i + j * elementIndicesA.size()]</tt>; pairs
+     *  whose result pointer is null are skipped.
+     *
+     *  Subclasses can override this function to reuse the geometrical data
+     *  of the elements A across all the elements B. */
+    virtual void integrate(
+            CallVariant callVariant,
+            const std::vector<int>& elementIndicesA,
+            const std::vector<int>& elementIndicesB,
+            const Basis<BasisFunctionType>& basisA,
+            const Basis<BasisFunctionType>& basisB,
+            const std::vector<LocalDofIndex>& localDofIndicesB,
+            const std::vector<arma::Mat<ResultType>*>& result) const {
+        const size_t elementACount = elementIndicesA.size();
+        const size_t elementBCount = elementIndicesB.size();
+        if (localDofIndicesB.size() != elementBCount ||
+                result.size() != elementACount * elementBCount)
+            throw std::invalid_argument(
+                    "TestKernelTrialIntegrator::integrate(): "
+                    "incompatible argument lengths");
+
+        std::vector<int> activeElementIndicesA;
+        std::vector<arma::Mat<ResultType>*> activeResult;
+        activeElementIndicesA.reserve(elementACount);
+        activeResult.reserve(elementACount);
+        for (size_t indexB = 0; indexB < elementBCount; ++indexB) {
+            activeElementIndicesA.clear();
+            activeResult.clear();
+            for (size_t indexA = 0; indexA < elementACount; ++indexA)
+                if (arma::Mat<ResultType>* r =
+                        result[indexA + indexB * elementACount]) {
+                    activeElementIndicesA.push_back(elementIndicesA[indexA]);
+                    activeResult.push_back(r);
+                }
+            if (!activeElementIndicesA.empty())
+                integrate(callVariant, activeElementIndicesA,
+                          elementIndicesB[indexB], basisA, basisB,
+                          localDofIndicesB[indexB], activeResult);
+        }
+    }
 };
 
 } // namespace Fiber
@@ -0,0 +1,119 @@
+// Copyright (C) 2011-2012 by the Bem++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_vectorized_surface_normal_independent_function_hpp
+#define fiber_vectorized_surface_normal_independent_function_hpp
+
+#include "../common/common.hpp"
+
+#include "function.hpp"
+#include "geometrical_data.hpp"
+
+namespace Fiber
+{
+
+/** \brief %Function defined via a user-supplied vectorized functor, depending
+    only on global coordinates.
+
+  Unlike SurfaceNormalIndependentFunction, which calls its functor separately
+  for each point, this class passes all the points at which the function is
+  to be evaluated (typically, the quadrature points of a batch of elements)
+  to the functor in a single call. This reduces the overhead of functors with
+  an expensive call mechanism, e.g. ones calling into an interpreter.
+
+  The template parameter \p Functor should be a class with the following
+  interface:
+
+  \code
+  class Functor
+  {
+  public:
+      // Type of the function's values (float, double, std::complex<float>
+      // or std::complex<double>)
+      typedef <implementiation-defined> ValueType;
+      typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+      // Number of components of the function's argument
+      int argumentDimension() const;
+
+      // Number of components of the function's result
+      int resultDimension() const;
+
+      // Evaluate the function at the points stored in the columns of the
+      // matrix "points" and store the results in the corresponding columns of
+      // the matrix "result".
+      // The "result" matrix will be preinitialised to correct dimensions
+      // (resultDimension() x points.n_cols).
+      void evaluate(const arma::Mat<CoordinateType>& points,
+                    arma::Mat<ValueType>& result) const;
+  };
+  \endcode
+  */
+template <typename Functor>
+class VectorizedSurfaceNormalIndependentFunction :
+        public Function<typename Functor::ValueType>
+{
+public:
+    typedef Function<typename Functor::ValueType> Base;
+    typedef typename Functor::ValueType ValueType;
+    typedef typename Base::CoordinateType CoordinateType;
+
+    VectorizedSurfaceNormalIndependentFunction(const Functor& functor) :
+        m_functor(functor) {
+    }
+
+    virtual int worldDimension() const {
+        return m_functor.argumentDimension();
+    }
+
+    virtual int codomainDimension() const {
+        return m_functor.resultDimension();
+    }
+
+    virtual void addGeometricalDependencies(size_t& geomDeps) const {
+        geomDeps |= GLOBALS;
+    }
+
+    virtual bool isThreadSafe() const {
+        return IsFunctorThreadSafe<Functor>::value;
+    }
+
+    virtual void evaluate(const GeometricalData<CoordinateType>& geomData,
+                          arma::Mat<ValueType>& result) const {
+        const arma::Mat<CoordinateType>& points = geomData.globals;
+
+#ifndef NDEBUG
+        if ((int)points.n_rows != worldDimension())
+            throw std::invalid_argument(
+                    "VectorizedSurfaceNormalIndependentFunction::evaluate(): "
+                    "incompatible world dimension");
+#endif
+
+        result.set_size(codomainDimension(), points.n_cols);
+        m_functor.evaluate(points, result);
+    }
+
+private:
+    const Functor& m_functor;
+};
+
+} // namespace Fiber
+
+#endif
@@ -0,0 +1,560 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bounding_volume_hierarchy.hpp"
+
+#include "ray_triangle_intersection.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <tbb/parallel_invoke.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Maximum number of triangles stored in a leaf
+const int LEAF_SIZE = 4;
+
+// Size of the stacks used to traverse the tree. Since the triangles are
+// split at the median, the depth of the tree is logarithmic in their number.
+const int MAX_STACK_SIZE = 128;
+
+// Intersections closer to each other than this distance are regarded as
+// identical
+const double INTERSECTION_TOLERANCE = 1e-10;
+
+// Subtrees containing fewer triangles than this are built serially
+const int PARALLEL_BUILD_THRESHOLD = 4096;
+
+inline void substract(double* dest, const double* a, const double* b)
+{
+    dest[0] = a[0] - b[0];
+    dest[1] = a[1] - b[1];
+    dest[2] = a[2] - b[2];
+}
+
+inline double innerProduct(const double* v1, const double* v2)
+{
+    return v1[0]*v2[0] + v1[1]*v2[1] + v1[2]*v2[2];
+}
+
+// Squared distance between the point p and the closest point of the
+// triangle (a, b, c). Algorithm from C. Ericson, "Real-Time Collision
+// Detection", section 5.1.5.
+double squaredDistanceToTriangle(const double* p, const double* a,
+                                 const double* b, const double* c)
+{
+    double ab[3], ac[3], ap[3], bp[3], cp[3], closest[3];
+    substract(ab, b, a);
+    substract(ac, c, a);
+    substract(ap, p, a);
+    substract(bp, p, b);
+    substract(cp, p, c);
+
+    const double d1 = innerProduct(ab, ap);
+    const double d2 = innerProduct(ac, ap);
+    const double d3 = innerProduct(ab, bp);
+    const double d4 = innerProduct(ac, bp);
+    const double d5 = innerProduct(ab, cp);
+    const double d6 = innerProduct(ac, cp);
+    const double va = d3 * d6 - d5 * d4;
+    const double vb = d5 * d2 - d1 * d6;
+    const double vc = d1 * d4 - d3 * d2;
+
+    if (d1 <= 0. && d2 <= 0.) // vertex a
+        std::copy(a, a + 3, closest);
+    else if (d3 >= 0. && d4 <= d3) // vertex b
+        std::copy(b, b + 3, closest);
+    else if (d6 >= 0. && d5 <= d6) // vertex c
+        std::copy(c, c + 3, closest);
+    else if (vc <= 0. && d1 >= 0. && d3 <= 0.) { // edge ab
+        const double v = d1 / (d1 - d3);
+        for (int i = 0; i < 3; ++i)
+            closest[i] = a[i] + v * ab[i];
+    } else if (vb <= 0. && d2 >= 0. && d6 <= 0.) { // edge ac
+        const double w = d2 / (d2 - d6);
+        for (int i = 0; i < 3; ++i)
+            closest[i] = a[i] + w * ac[i];
+    } else if (va <= 0. && d4 - d3 >= 0. && d5 - d6 >= 0.) { // edge bc
+        const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        for (int i = 0; i < 3; ++i)
+            closest[i] = b[i] + w * (c[i] - b[i]);
+    } else { // interior
+        const double denom = 1. / (va + vb + vc);
+        const double v = vb * denom;
+        const double w = vc * denom;
+        for (int i = 0; i < 3; ++i)
+            closest[i] = a[i] + v * ab[i] + w * ac[i];
+    }
+
+    double diff[3];
+    substract(diff, p, closest);
+    return innerProduct(diff, diff);
+}
+
+// Squared distance between a point and an axis-aligned box
+inline double squaredDistanceToBox(const double* p, const double* lower,
+                                   const double* upper)
+{
+    double result = 0.;
+    for (int i = 0; i < 3; ++i) {
+        const double d = std::max(std::max(lower[i] - p[i], 0.),
+                                  p[i] - upper[i]);
+        result += d * d;
+    }
+    return result;
+}
+
+// Intersection of the ray p + t d, t >= 0, with an axis-aligned box.
+// inverseDirection contains the reciprocals of the components of d.
+inline bool rayIntersectsBox(const double* p, const double* inverseDirection,
+                             const double* lower, const double* upper)
+{
+    double tMin = 0.;
+    double tMax = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < 3; ++i) {
+        double t1 = (lower[i] - p[i]) * inverseDirection[i];
+        double t2 = (upper[i] - p[i]) * inverseDirection[i];
+        if (t1 > t2)
+            std::swap(t1, t2);
+        // NaNs (d[i] == 0 and p[i] on a face of the box) are ignored
+        if (t1 > tMin)
+            tMin = t1;
+        if (t2 < tMax)
+            tMax = t2;
+    }
+    return tMin <= tMax;
+}
+
+class CentroidLess
+{
+public:
+    CentroidLess(const std::vector<double>& centroids, int axis) :
+        m_centroids(centroids), m_axis(axis) {
+    }
+
+    bool operator()(int a, int b) const {
+        return m_centroids[3 * a + m_axis] < m_centroids[3 * b + m_axis];
+    }
+
+private:
+    const std::vector<double>& m_centroids;
+    int m_axis;
+};
+
+} // namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+        const arma::Mat<double>& vertices,
+        const arma::Mat<int>& elementCorners) :
+    m_elementCount(elementCorners.n_cols)
+{
+    if (vertices.n_rows != 3)
+        throw std::invalid_argument(
+                "BoundingVolumeHierarchy::BoundingVolumeHierarchy(): "
+                "vertices must be embedded in a 3D space");
+    if (elementCorners.n_rows != 3 && elementCorners.n_rows != 4)
+        throw std::invalid_argument(
+                "BoundingVolumeHierarchy::BoundingVolumeHierarchy(): "
+                "elements must be triangles or quadrilaterals");
+
+    m_elementDiameters.resize(m_elementCount);
+
+    // Split elements into triangles
+    std::vector<double> triangles;
+    std::vector<int> triangleElements;
+    triangles.reserve(9 * m_elementCount);
+    triangleElements.reserve(m_elementCount);
+    for (size_t e = 0; e < m_elementCount; ++e) {
+        int cornerCount = elementCorners.n_rows;
+        while (elementCorners(cornerCount - 1, e) < 0)
+            --cornerCount;
+        if (cornerCount != 3 && cornerCount != 4)
+            throw std::invalid_argument(
+                    "BoundingVolumeHierarchy::BoundingVolumeHierarchy(): "
+                    "elements must be triangles or quadrilaterals");
+        // Quadrilaterals, whose corners follow the Dune (lexicographic)
+        // ordering, are split into triangles (0, 1, 2) and (1, 3, 2).
+        // NOTE: this won't work for concave quads
+        static const int triangleCorners[2][3] = {{0, 1, 2}, {1, 3, 2}};
+        for (int t = 0; t < cornerCount - 2; ++t)
+            for (int c = 0; c < 3; ++c) {
+                const int vertex = elementCorners(triangleCorners[t][c], e);
+                for (int dim = 0; dim < 3; ++dim)
+                    triangles.push_back(vertices(dim, vertex));
+            }
+        triangleElements.insert(triangleElements.end(), cornerCount - 2, int(e));
+
+        double squaredDiameter = 0.;
+        for (int c1 = 0; c1 < cornerCount; ++c1)
+            for (int c2 = c1 + 1; c2 < cornerCount; ++c2) {
+                double diff[3];
+                substract(diff, vertices.colptr(elementCorners(c1, e)),
+                          vertices.colptr(elementCorners(c2, e)));
+                squaredDiameter = std::max(squaredDiameter,
+                                           innerProduct(diff, diff));
+            }
+        m_elementDiameters[e] = std::sqrt(squaredDiameter);
+    }
+
+    const int triangleCount = triangleElements.size();
+    if (triangleCount == 0)
+        return;
+
+    std::vector<double> centroids(3 * triangleCount);
+    for (int t = 0; t < triangleCount; ++t)
+        for (int dim = 0; dim < 3; ++dim)
+            centroids[3 * t + dim] = (triangles[9 * t + dim] +
+                                      triangles[9 * t + 3 + dim] +
+                                      triangles[9 * t + 6 + dim]) / 3.;
+
+    std::vector<int> order(triangleCount);
+    for (int t = 0; t < triangleCount; ++t)
+        order[t] = t;
+    m_nodes.resize(subtreeNodeCount(triangleCount));
+    buildNode(0, order, 0, triangleCount, centroids, triangles);
+
+    // Store the triangles in the order of leaves
+    m_triangles.resize(9 * triangleCount);
+    m_triangleElements.resize(triangleCount);
+    for (int t = 0; t < triangleCount; ++t) {
+        std::copy(&triangles[9 * order[t]], &triangles[9 * order[t]] + 9,
+                  &m_triangles[9 * t]);
+        m_triangleElements[t] = triangleElements[order[t]];
+    }
+}
+
+class BoundingVolumeHierarchy::BuildNodeFunctor
+{
+public:
+    BuildNodeFunctor(BoundingVolumeHierarchy& bvh, int nodeIndex,
+                     std::vector<int>& order, int begin, int end,
+                     const std::vector<double>& centroids,
+                     const std::vector<double>& triangles) :
+        m_bvh(bvh), m_nodeIndex(nodeIndex), m_order(order),
+        m_begin(begin), m_end(end), m_centroids(centroids),
+        m_triangles(triangles) {
+    }
+
+    void operator()() const {
+        m_bvh.buildNode(m_nodeIndex, m_order, m_begin, m_end,
+                        m_centroids, m_triangles);
+    }
+
+private:
+    BoundingVolumeHierarchy& m_bvh;
+    int m_nodeIndex;
+    std::vector<int>& m_order;
+    int m_begin, m_end;
+    const std::vector<double>& m_centroids;
+    const std::vector<double>& m_triangles;
+};
+
+int BoundingVolumeHierarchy::subtreeNodeCount(int triangleCount)
+{
+    if (triangleCount <= LEAF_SIZE)
+        return 1;
+    const int leftCount = triangleCount / 2;
+    return 1 + subtreeNodeCount(leftCount) +
+            subtreeNodeCount(triangleCount - leftCount);
+}
+
+void BoundingVolumeHierarchy::buildNode(
+        int nodeIndex, std::vector<int>& order, int begin, int end,
+        const std::vector<double>& centroids,
+        const std::vector<double>& triangles)
+{
+    // Bounding box of the triangles and of their centroids
+    double lower[3], upper[3], centroidLower[3], centroidUpper[3];
+    std::fill(lower, lower + 3, std::numeric_limits<double>::max());
+    std::fill(upper, upper + 3, -std::numeric_limits<double>::max());
+    std::copy(lower, lower + 3, centroidLower);
+    std::copy(upper, upper + 3, centroidUpper);
+    for (int i = begin; i < end; ++i) {
+        const int t = order[i];
+        for (int dim = 0; dim < 3; ++dim) {
+            for (int c = 0; c < 3; ++c) {
+                lower[dim] = std::min(lower[dim], triangles[9 * t + 3 * c + dim]);
+                upper[dim] = std::max(upper[dim], triangles[9 * t + 3 * c + dim]);
+            }
+            centroidLower[dim] = std::min(centroidLower[dim],
+                                          centroids[3 * t + dim]);
+            centroidUpper[dim] = std::max(centroidUpper[dim],
+                                          centroids[3 * t + dim]);
+        }
+    }
+
+    Node& node = m_nodes[nodeIndex];
+    std::copy(lower, lower + 3, node.lower);
+    std::copy(upper, upper + 3, node.upper);
+    node.begin = node.end = node.left = node.right = -1;
+
+    if (end - begin <= LEAF_SIZE) {
+        node.begin = begin;
+        node.end = end;
+        return;
+    }
+
+    int axis = 0;
+    for (int dim = 1; dim < 3; ++dim)
+        if (centroidUpper[dim] - centroidLower[dim] >
+                centroidUpper[axis] - centroidLower[axis])
+            axis = dim;
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle,
+                     order.begin() + end, CentroidLess(centroids, axis));
+
+    // The nodes of the left subtree are stored right after the current
+    // node, followed by those of the right subtree
+    node.left = nodeIndex + 1;
+    node.right = node.left + subtreeNodeCount(middle - begin);
+    BuildNodeFunctor buildLeft(*this, node.left, order, begin, middle,
+                               centroids, triangles);
+    BuildNodeFunctor buildRight(*this, node.right, order, middle, end,
+                                centroids, triangles);
+    if (end - begin < PARALLEL_BUILD_THRESHOLD) {
+        buildLeft();
+        buildRight();
+    } else
+        tbb::parallel_invoke(buildLeft, buildRight);
+}
+
+size_t BoundingVolumeHierarchy::elementCount() const
+{
+    return m_elementCount;
+}
+
+size_t BoundingVolumeHierarchy::triangleCount() const
+{
+    return m_triangleElements.size();
+}
+
+double BoundingVolumeHierarchy::elementDiameter(int element) const
+{
+    return m_elementDiameters[element];
+}
+
+const double* BoundingVolumeHierarchy::triangle(int index) const
+{
+    return &m_triangles[9 * index];
+}
+
+void BoundingVolumeHierarchy::zRayIntersections(
+        const double* point, std::vector<double>& heights) const
+{
+    heights.clear();
+    if (m_nodes.empty())
+        return;
+
+    int stack[MAX_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    double intersection[3];
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (point[0] < node.lower[0] || point[0] > node.upper[0] ||
+                point[1] < node.lower[1] || point[1] > node.upper[1] ||
+                point[2] > node.upper[2])
+            continue;
+        if (node.left < 0) {
+            for (int t = node.begin; t < node.end; ++t) {
+                const double* v = triangle(t);
+                if (zRayIntersectsTriangle(point, v, v + 3, v + 6,
+                                           intersection) > 0.)
+                    heights.push_back(intersection[2]);
+            }
+        } else {
+            assert(stackSize + 2 <= MAX_STACK_SIZE);
+            stack[stackSize++] = node.left;
+            stack[stackSize++] = node.right;
+        }
+    }
+
+    // Remove duplicate intersections (lying on edges or vertices shared by
+    // several triangles)
+    std::sort(heights.begin(), heights.end());
+    size_t distinctCount = 0;
+    for (size_t i = 0; i < heights.size(); ++i)
+        if (distinctCount == 0 || heights[i] - heights[distinctCount - 1] >=
+                INTERSECTION_TOLERANCE)
+            heights[distinctCount++] = heights[i];
+    heights.resize(distinctCount);
+}
+
+int BoundingVolumeHierarchy::nearestElement(const double* point,
+                                            double* distance) const
+{
+    if (m_nodes.empty()) {
+        if (distance)
+            *distance = std::numeric_limits<double>::infinity();
+        return -1;
+    }
+
+    double bestSquaredDistance = std::numeric_limits<double>::infinity();
+    int bestTriangle = -1;
+
+    int stack[MAX_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (squaredDistanceToBox(point, node.lower, node.upper) >=
+                bestSquaredDistance)
+            continue;
+        if (node.left < 0) {
+            for (int t = node.begin; t < node.end; ++t) {
+                const double* v = triangle(t);
+                const double d = squaredDistanceToTriangle(
+                            point, v, v + 3, v + 6);
+                if (d < bestSquaredDistance) {
+                    bestSquaredDistance = d;
+                    bestTriangle = t;
+                }
+            }
+        } else {
+            // Visit the nearer child first
+            const Node& left = m_nodes[node.left];
+            const Node& right = m_nodes[node.right];
+            const double leftDistance =
+                    squaredDistanceToBox(point, left.lower, left.upper);
+            const double rightDistance =
+                    squaredDistanceToBox(point, right.lower, right.upper);
+            assert(stackSize + 2 <= MAX_STACK_SIZE);
+            if (leftDistance < rightDistance) {
+                stack[stackSize++] = node.right;
+                stack[stackSize++] = node.left;
+            } else {
+                stack[stackSize++] = node.left;
+                stack[stackSize++] = node.right;
+            }
+        }
+    }
+
+    if (distance)
+        *distance = std::sqrt(bestSquaredDistance);
+    return m_triangleElements[bestTriangle];
+}
+
+void BoundingVolumeHierarchy::elementsWithinRadius(
+        const double* point, double radius, std::vector<int>& elements) const
+{
+    elements.clear();
+    if (m_nodes.empty())
+        return;
+
+    const double squaredRadius = radius * radius;
+    int stack[MAX_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (squaredDistanceToBox(point, node.lower, node.upper) >
+                squaredRadius)
+            continue;
+        if (node.left < 0) {
+            for (int t = node.begin; t < node.end; ++t) {
+                const double* v = triangle(t);
+                if (squaredDistanceToTriangle(point, v, v + 3, v + 6) <=
+                        squaredRadius)
+                    elements.push_back(m_triangleElements[t]);
+            }
+        } else {
+            assert(stackSize + 2 <= MAX_STACK_SIZE);
+            stack[stackSize++] = node.left;
+            stack[stackSize++] = node.right;
+        }
+    }
+
+    // Both triangles of a quadrilateral may have been found
+    std::sort(elements.begin(), elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()),
+                   elements.end());
+}
+
+void BoundingVolumeHierarchy::rayIntersections(
+        const double* origin, const double* direction,
+        std::vector<double>& distances, std::vector<int>* elements) const
+{
+    distances.clear();
+    if (elements)
+        elements->clear();
+    if (m_nodes.empty())
+        return;
+
+    const double norm = std::sqrt(innerProduct(direction, direction));
+    if (norm == 0.)
+        throw std::invalid_argument(
+                "BoundingVolumeHierarchy::rayIntersections(): "
+                "ray direction must be nonzero");
+    double unitDirection[3], inverseDirection[3];
+    for (int i = 0; i < 3; ++i) {
+        unitDirection[i] = direction[i] / norm;
+        inverseDirection[i] = 1. / unitDirection[i];
+    }
+
+    // Pairs (distance, element)
+    std::vector<std::pair<double, int> > intersections;
+    int stack[MAX_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    double intersection[3], diff[3];
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (!rayIntersectsBox(origin, inverseDirection,
+                              node.lower, node.upper))
+            continue;
+        if (node.left < 0) {
+            for (int t = node.begin; t < node.end; ++t) {
+                const double* v = triangle(t);
+                if (rayIntersectsTriangle(origin, unitDirection,
+                                          v, v + 3, v + 6, intersection) > 0.) {
+                    substract(diff, intersection, origin);
+                    intersections.push_back(std::make_pair(
+                            innerProduct(diff, unitDirection),
+                            m_triangleElements[t]));
+                }
+            }
+        } else {
+            assert(stackSize + 2 <= MAX_STACK_SIZE);
+            stack[stackSize++] = node.left;
+            stack[stackSize++] = node.right;
+        }
+    }
+
+    // Remove duplicate intersections (lying on edges or vertices shared by
+    // several triangles)
+    std::sort(intersections.begin(), intersections.end());
+    for (size_t i = 0; i < intersections.size(); ++i)
+        if (distances.empty() || intersections[i].first - distances.back() >=
+                INTERSECTION_TOLERANCE) {
+            distances.push_back(intersections[i].first);
+            if (elements)
+                elements->push_back(intersections[i].second);
+        }
+}
+
+} // namespace Bempp
@@ -0,0 +1,173 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_bounding_volume_hierarchy_hpp
+#define bempp_bounding_volume_hierarchy_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <cstddef> // size_t
+#include <vector>
+
+namespace Bempp
+{
+
+/** \brief Bounding volume hierarchy of the elements of a 2D grid embedded in
+ *  a 3D space.
+ *
+ *  Each element is represented by one (triangles) or two (quadrilaterals)
+ *  flat triangles. The triangles are stored in the leaves of a binary tree of
+ *  axis-aligned bounding boxes, obtained by recursively splitting the set of
+ *  triangles at the median of their centroids along the longest axis of
+ *  the box containing these centroids. Since the shape of the tree depends
+ *  only on the number of triangles, independent subtrees are built in
+ *  parallel and the result does not depend on the number of threads.
+ *
+ *  Once constructed, the hierarchy is immutable and all its query methods
+ *  can be called concurrently from several threads.
+ *
+ *  Use Grid::boundingVolumeHierarchy() to obtain the hierarchy of the leaf
+ *  elements of a grid; it is built on first use and stored in the grid.
+ *  Besides point-in-domain tests, it can be used to find the element nearest
+ *  to a point, the elements lying in a ball or the intersections of a ray
+ *  with the grid in logarithmic time, e.g. to identify evaluation points
+ *  lying in the near field of a surface. */
+class BoundingVolumeHierarchy
+{
+public:
+    /** \brief Constructor.
+     *
+     *  \param[in] vertices
+     *    A 2D array of dimensions (3, \c m) whose (\c i, \c j)th element is the
+     *    \c i'th coordinate of \c j'th vertex.
+     *  \param[in] elementCorners
+     *    A 2D array of dimensions (3 or 4, \c n) whose \c j'th column contains
+     *    the indices of the vertices of the \c j'th element. In grids with
+     *    both triangular and quadrilateral elements, the fourth row should be
+     *    set to -1 for triangles.
+     *
+     *  These arrays are laid out as the ones returned by
+     *  GridView::getRawElementData(). */
+    BoundingVolumeHierarchy(const arma::Mat<double>& vertices,
+                            const arma::Mat<int>& elementCorners);
+
+    /** \brief Number of elements whose triangles are stored in the hierarchy. */
+    size_t elementCount() const;
+
+    /** \brief Number of triangles stored in the hierarchy. */
+    size_t triangleCount() const;
+
+    /** \brief Diameter of an element.
+     *
+     *  \returns The largest distance between two corners of the element
+     *  with index \p element. */
+    double elementDiameter(int element) const;
+
+    /** \brief Find the intersections of a vertical ray with the grid.
+     *
+     *  \param[in] point
+     *    Pointer to the three coordinates of the origin \f$p\f$ of the ray
+     *    \f$p + t e_z\f$, \f$t > 0\f$.
+     *  \param[out] heights
+     *    The \c z coordinates of the distinct points at which the ray
+     *    intersects the grid, sorted in ascending order. Intersections lying
+     *    on edges or vertices shared by several elements are reported only
+     *    once. */
+    void zRayIntersections(const double* point,
+                           std::vector<double>& heights) const;
+
+    /** \brief Find the element nearest to a point.
+     *
+     *  \param[in] point
+     *    Pointer to the three coordinates of the point.
+     *  \param[out] distance
+     *    If not NULL, on output set to the distance between \p point and the
+     *    nearest element.
+     *
+     *  \returns Index of the element nearest to \p point, or -1 if the
+     *  hierarchy is empty. */
+    int nearestElement(const double* point, double* distance = 0) const;
+
+    /** \brief Find the elements lying within a given distance from a point.
+     *
+     *  \param[in] point
+     *    Pointer to the three coordinates of the point.
+     *  \param[in] radius
+     *    Search radius.
+     *  \param[out] elements
+     *    Indices of the elements whose distance from \p point does not
+     *    exceed \p radius, sorted in ascending order. */
+    void elementsWithinRadius(const double* point, double radius,
+                              std::vector<int>& elements) const;
+
+    /** \brief Find the intersections of a ray with the grid.
+     *
+     *  \param[in] origin
+     *    Pointer to the three coordinates of the origin \f$p\f$ of the ray.
+     *  \param[in] direction
+     *    Pointer to the three coordinates of the direction \f$d\f$ of the
+     *    ray. It does not need to be normalised.
+     *  \param[out] distances
+     *    Distances \f$t\f$ from \p origin of the distinct points
+     *    \f$p + t d / |d|\f$, \f$t > 0\f$, at which the ray intersects
+     *    the grid, sorted in ascending order.
+     *  \param[out] elements
+     *    If not NULL, on output the \c i'th element of this vector is set to
+     *    the index of an element containing the \c i'th intersection. */
+    void rayIntersections(const double* origin, const double* direction,
+                          std::vector<double>& distances,
+                          std::vector<int>* elements = 0) const;
+
+private:
+    /** \cond PRIVATE */
+    struct Node
+    {
+        double lower[3];
+        double upper[3];
+        // Range of triangles (leaves) or -1 (internal nodes)
+        int begin, end;
+        // Children (internal nodes) or -1 (leaves)
+        int left, right;
+    };
+
+    class BuildNodeFunctor;
+
+    static int subtreeNodeCount(int triangleCount);
+    void buildNode(int nodeIndex, std::vector<int>& order, int begin, int end,
+                   const std::vector<double>& centroids,
+                   const std::vector<double>& triangles);
+    const double* triangle(int index) const;
+    /** \endcond */
+
+private:
+    size_t m_elementCount;
+    std::vector<Node> m_nodes;
+    // Coordinates of the corners of triangles (9 per triangle), in the order
+    // in which the triangles are stored in the leaves
+    std::vector<double> m_triangles;
+    // Index of the element to which each triangle belongs
+    std::vector<int> m_triangleElements;
+    std::vector<double> m_elementDiameters;
+};
+
+} // namespace Bempp
+
+#endif
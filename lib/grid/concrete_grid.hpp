@@ -31,6 +31,7 @@
 #include "concrete_id_set.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace Bempp
 {
@@ -55,6 +56,7 @@ private:
     bool m_owns_dune_grid;
     GridParameters::Topology m_topology;
     ConcreteIdSet<DuneGrid, typename DuneGrid::Traits::GlobalIdSet> m_global_id_set;
+    std::vector<int> m_domain_indices;
 
 public:
     /** \brief Underlying Dune grid's type*/
@@ -71,10 +73,14 @@ public:
      \param[in]  dune_grid  Pointer to the Dune grid to wrap.
      \param[in]  topology   The topology of the grid
      \param[in]  own  If true, *dune_grid is deleted in this object's destructor.
+     \param[in]  domainIndices  Domain indices of the elements of the grid
+                                (see Grid::getDomainIndices()). May be empty.
      */
-    explicit ConcreteGrid(DuneGrid* dune_grid, GridParameters::Topology topology, bool own = false) :
+    explicit ConcreteGrid(DuneGrid* dune_grid, GridParameters::Topology topology, bool own = false,
+                          const std::vector<int>& domainIndices = std::vector<int>()) :
         m_dune_grid(dune_grid), m_topology(topology), m_owns_dune_grid(own), m_global_id_set(
-            dune_grid ? &dune_grid->globalIdSet() : 0) { // safety net
+            dune_grid ? &dune_grid->globalIdSet() : 0), // safety net
+        m_domain_indices(domainIndices) {
     }
 
     /** \brief Destructor. */
@@ -149,6 +155,16 @@ public:
         return m_topology;
     }
 
+    /** @}
+    @name Domains
+    @{ */
+
+    virtual void getDomainIndices(std::vector<int>& domainIndices) const {
+        if (m_domain_indices.empty())
+            domainIndices.assign(m_dune_grid->leafView().size(0 /* codim */), 0);
+        else
+            domainIndices = m_domain_indices;
+    }
 
     /** @} */
 
@@ -30,6 +30,7 @@
 #include "concrete_vtk_writer.hpp"
 #include "geometry_type.hpp"
 #include "reverse_element_mapper.hpp"
+#include "vtu_writer.hpp"
 
 namespace Bempp
 {
@@ -98,6 +99,7 @@ public:
     virtual void getRawElementDataFloatImpl(arma::Mat<float>& vertices,
                                              arma::Mat<int>& elementCorners,
                                              arma::Mat<char>& auxData) const;
+    virtual void getRawElementEdgeDataImpl(arma::Mat<int>& elementEdges) const;
 
     virtual const ReverseElementMapper& reverseElementMapper() const {
         if (!m_reverse_element_mapper_is_up_to_date)
@@ -109,6 +111,13 @@ public:
     }
 
     virtual std::auto_ptr<VtkWriter> vtkWriter(Dune::VTK::DataMode dm=Dune::VTK::conforming) const {
+        // VtuWriter relies on getRawElementData(), which numbers elements
+        // with a leaf mapper; hence the check of the number of elements
+        if (dm == Dune::VTK::conforming &&
+                m_dune_gv.indexSet().geomTypes(0).size() == 1 &&
+                m_dune_gv.size(0) == m_dune_gv.grid().size(0))
+            return std::auto_ptr<VtkWriter>(
+                        new VtuWriter(*this, DuneGridView::dimension));
         return std::auto_ptr<VtkWriter>(new ConcreteVtkWriter<DuneGridView>(m_dune_gv, dm));
     }
 
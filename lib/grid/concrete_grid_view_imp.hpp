@@ -101,4 +101,43 @@ void ConcreteGridView<DuneGridView>::getRawElementDataImpl(
     auxData.set_size(0, elementCorners.n_cols);
 }
 
+template <typename DuneGridView>
+void ConcreteGridView<DuneGridView>::getRawElementEdgeDataImpl(
+        arma::Mat<int>& elementEdges) const
+{
+    typedef typename DuneGridView::Grid DuneGrid;
+    typedef typename DuneGridView::IndexSet DuneIndexSet;
+    const int dimGrid = DuneGrid::dimension;
+    const int codimEdge = dimGrid - 1;
+    const int codimElement = 0;
+    typedef Dune::LeafMultipleCodimMultipleGeomTypeMapper<DuneGrid,
+            Dune::MCMGElementLayout> DuneElementMapper;
+    typedef typename DuneGridView::template Codim<codimElement>::Iterator
+            DuneElementIterator;
+    typedef typename DuneGrid::ctype ctype;
+
+    if (dimGrid != 2)
+        throw std::logic_error("GridView::getRawElementEdgeData(): "
+                               "only 2D grids are supported");
+
+    const DuneIndexSet& indexSet = m_dune_gv.indexSet();
+
+    const int MAX_EDGE_COUNT = 4;
+    DuneElementMapper elementMapper(m_dune_gv.grid());
+    elementEdges.set_size(MAX_EDGE_COUNT, elementMapper.size());
+    for (DuneElementIterator it = m_dune_gv.template begin<codimElement>();
+         it != m_dune_gv.template end<codimElement>(); ++it)
+    {
+        size_t index = elementMapper.map(*it);
+        const Dune::GenericReferenceElement<ctype, dimGrid>& refElement =
+                Dune::GenericReferenceElements<ctype, dimGrid>::general(it->type());
+        const int edgeCount = refElement.size(codimEdge);
+        assert(edgeCount <= MAX_EDGE_COUNT);
+        for (int i = 0; i < edgeCount; ++i)
+            elementEdges(i, index) = indexSet.subIndex(*it, i, codimEdge);
+        for (int i = edgeCount; i < MAX_EDGE_COUNT; ++i)
+            elementEdges(i, index) = -1;
+    }
+}
+
 } // namespace Bempp
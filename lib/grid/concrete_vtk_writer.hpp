@@ -28,6 +28,7 @@
 #include "vtk_writer.hpp"
 
 #include "../common/armadillo_fwd.hpp"
+#include "../common/not_implemented_error.hpp"
 #include <memory>
 #include <string>
 
@@ -149,6 +150,10 @@ private:
             return Dune::VTK::appendedraw;
         case APPENDED_BASE_64:
             return Dune::VTK::appendedbase64;
+        case APPENDED_RAW_COMPRESSED:
+            throw NotImplementedError("ConcreteVtkWriter::write(): compressed "
+                                      "output is not supported by Dune's "
+                                      "VTK writer");
         default:
             return static_cast<Dune::VTK::OutputType>(type);
         }
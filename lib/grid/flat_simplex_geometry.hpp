@@ -0,0 +1,322 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_flat_simplex_geometry_hpp
+#define bempp_flat_simplex_geometry_hpp
+
+#include "../common/common.hpp"
+
+#include "geometry.hpp"
+#include "geometry_factory.hpp"
+#include "geometry_type.hpp"
+
+#include "../fiber/geometrical_data.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace Bempp
+{
+
+/** \brief Affine simplex of dimension \p mydim embedded in the
+ *  three-dimensional space.
+ *
+ *  Unlike ConcreteGeometry, this class does not wrap a Dune geometry: the
+ *  corner coordinates and the (constant) Jacobian are stored directly in the
+ *  object, so that setting up a geometry involves no heap allocation. The
+ *  reference element is the same as in Dune, i.e. the simplex spanned by the
+ *  origin and the unit vectors of \f$\mathbb{R}^{\textrm{mydim}}\f$.
+ */
+template <int mydim>
+class FlatSimplexGeometry : public Geometry
+{
+public:
+    enum {
+        /** \brief Dimension of the simplex. */
+        mydimension = mydim,
+        /** \brief Dimension of the space in which the simplex is embedded. */
+        coorddimension = 3,
+        /** \brief Number of corners of the simplex. */
+        cornercount = mydim + 1
+    };
+
+    /** \brief Default constructor.
+
+      Should be followed by a call to setup() or setCorners(). */
+    FlatSimplexGeometry() : m_integration_element(0.) {
+        for (int c = 0; c < cornercount; ++c)
+            for (int d = 0; d < coorddimension; ++d)
+                m_corners[c][d] = 0.;
+        updateJacobian();
+    }
+
+    /** \brief Set the corners of the simplex.
+
+      \param[in] corners Array of \p cornercount pointers to the coordinates of
+                         the consecutive corners. */
+    void setCorners(const double* const* corners) {
+        for (int c = 0; c < cornercount; ++c)
+            for (int d = 0; d < coorddimension; ++d)
+                m_corners[c][d] = corners[c][d];
+        updateJacobian();
+    }
+
+    virtual int dim() const {
+        return mydim;
+    }
+
+    virtual int dimWorld() const {
+        return coorddimension;
+    }
+
+    virtual GeometryType type() const {
+        GeometryType type;
+        if (mydim == 0)
+            type.makeVertex();
+        else if (mydim == 1)
+            type.makeLine();
+        else
+            type.makeTriangle();
+        return type;
+    }
+
+    virtual bool affine() const {
+        return true;
+    }
+
+    virtual int cornerCount() const {
+        return cornercount;
+    }
+
+    virtual double volume() const {
+        // volume of the reference simplex is 1 / mydim!
+        return mydim == 2 ? 0.5 * m_integration_element : m_integration_element;
+    }
+
+private:
+    virtual void setupImpl(const arma::Mat<double>& corners,
+                           const arma::Col<char>& auxData) {
+        if (corners.n_rows != coorddimension || corners.n_cols != cornercount)
+            throw std::invalid_argument("FlatSimplexGeometry::setup(): "
+                                        "invalid dimensions of the 'corners' array");
+        const double* cornerPtrs[cornercount];
+        for (int c = 0; c < cornercount; ++c)
+            cornerPtrs[c] = corners.colptr(c);
+        setCorners(cornerPtrs);
+    }
+
+    virtual void getCornersImpl(arma::Mat<double>& c) const {
+        c.set_size(coorddimension, cornercount);
+        for (int j = 0; j < cornercount; ++j)
+            for (int i = 0; i < coorddimension; ++i)
+                c(i, j) = m_corners[j][i];
+    }
+
+    virtual void local2globalImpl(const arma::Mat<double>& local,
+                                  arma::Mat<double>& global) const {
+#ifndef NDEBUG
+        if ((int)local.n_rows != mydim)
+            throw std::invalid_argument("Geometry::local2global(): invalid dimensions of the 'local' array");
+#endif
+        const size_t n = local.n_cols;
+        global.set_size(coorddimension, n);
+        for (size_t j = 0; j < n; ++j)
+            for (int i = 0; i < coorddimension; ++i) {
+                double g = m_corners[0][i];
+                for (int k = 0; k < mydim; ++k)
+                    g += m_jacobian_t[k][i] * local(k, j);
+                global(i, j) = g;
+            }
+    }
+
+    virtual void global2localImpl(const arma::Mat<double>& global,
+                                  arma::Mat<double>& local) const {
+#ifndef NDEBUG
+        if ((int)global.n_rows != coorddimension)
+            throw std::invalid_argument("Geometry::global2local(): invalid dimensions of the 'global' array");
+#endif
+        // For mydim < 3 this yields the local coordinates of the orthogonal
+        // projection of the point onto the plane (line) of the simplex
+        const size_t n = global.n_cols;
+        local.set_size(mydim, n);
+        for (size_t j = 0; j < n; ++j)
+            for (int k = 0; k < mydim; ++k) {
+                double l = 0.;
+                for (int i = 0; i < coorddimension; ++i)
+                    l += m_jacobian_inv_t[i][k] * (global(i, j) - m_corners[0][i]);
+                local(k, j) = l;
+            }
+    }
+
+    virtual void getIntegrationElementsImpl(const arma::Mat<double>& local,
+                                            arma::Row<double>& int_element) const {
+#ifndef NDEBUG
+        if ((int)local.n_rows != mydim)
+            throw std::invalid_argument("Geometry::getIntegrationElements(): invalid dimensions of the 'local' array");
+#endif
+        int_element.set_size(local.n_cols);
+        int_element.fill(m_integration_element);
+    }
+
+    virtual void getCenterImpl(arma::Col<double>& c) const {
+        c.set_size(coorddimension);
+        for (int i = 0; i < coorddimension; ++i) {
+            double sum = 0.;
+            for (int j = 0; j < cornercount; ++j)
+                sum += m_corners[j][i];
+            c(i) = sum / cornercount;
+        }
+    }
+
+    virtual void getJacobiansTransposedImpl(const arma::Mat<double>& local,
+                                            arma::Cube<double>& jacobian_t) const {
+#ifndef NDEBUG
+        if ((int)local.n_rows != mydim)
+            throw std::invalid_argument("Geometry::getJacobiansTransposed(): "
+                                        "invalid dimensions of the 'local' array");
+#endif
+        const size_t n = local.n_cols;
+        jacobian_t.set_size(mydim, coorddimension, n);
+        for (size_t k = 0; k < n; ++k)
+            for (int j = 0; j < coorddimension; ++j)
+                for (int i = 0; i < mydim; ++i)
+                    jacobian_t(i, j, k) = m_jacobian_t[i][j];
+    }
+
+    virtual void getJacobianInversesTransposedImpl(
+            const arma::Mat<double>& local,
+            arma::Cube<double>& jacobian_inv_t) const {
+#ifndef NDEBUG
+        if ((int)local.n_rows != mydim)
+            throw std::invalid_argument("Geometry::getJacobianInversesTransposed(): "
+                                        "invalid dimensions of the 'local' array");
+#endif
+        const size_t n = local.n_cols;
+        jacobian_inv_t.set_size(coorddimension, mydim, n);
+        for (size_t k = 0; k < n; ++k)
+            for (int j = 0; j < mydim; ++j)
+                for (int i = 0; i < coorddimension; ++i)
+                    jacobian_inv_t(i, j, k) = m_jacobian_inv_t[i][j];
+    }
+
+    virtual void getNormalsImpl(const arma::Mat<double>& local,
+                                arma::Mat<double>& normal) const {
+        if (mydim != coorddimension - 1)
+            throw std::logic_error("FlatSimplexGeometry::getNormals(): "
+                                   "normal vectors are defined only for "
+                                   "entities of dimension (worldDimension - 1)");
+        const size_t n = local.n_cols;
+        normal.set_size(coorddimension, n);
+        for (size_t j = 0; j < n; ++j)
+            for (int i = 0; i < coorddimension; ++i)
+                normal(i, j) = m_normal[i];
+    }
+
+    virtual void getDataImpl(size_t what, const arma::Mat<double>& local,
+                             Fiber::GeometricalData<double>& data) const {
+        typedef FlatSimplexGeometry<mydim> This; // to avoid virtual function calls
+
+        if (what & Fiber::GLOBALS)
+            This::local2globalImpl(local, data.globals);
+        if (what & Fiber::INTEGRATION_ELEMENTS)
+            This::getIntegrationElementsImpl(local, data.integrationElements);
+        if (what & Fiber::JACOBIANS_TRANSPOSED)
+            This::getJacobiansTransposedImpl(local, data.jacobiansTransposed);
+        if (what & Fiber::JACOBIAN_INVERSES_TRANSPOSED)
+            This::getJacobianInversesTransposedImpl(
+                        local, data.jacobianInversesTransposed);
+        if (what & Fiber::NORMALS)
+            This::getNormalsImpl(local, data.normals);
+    }
+
+    /** \brief Recalculate the Jacobian, its pseudoinverse, the integration
+     *  element and the normal from the corner coordinates. */
+    void updateJacobian() {
+        for (int k = 0; k < mydim; ++k)
+            for (int i = 0; i < coorddimension; ++i)
+                m_jacobian_t[k][i] = m_corners[k + 1][i] - m_corners[0][i];
+
+        // Gram matrix G = J^T J and its inverse
+        double gram[2][2] = {{1., 0.}, {0., 1.}};
+        for (int k = 0; k < mydim; ++k)
+            for (int l = 0; l < mydim; ++l) {
+                gram[k][l] = 0.;
+                for (int i = 0; i < coorddimension; ++i)
+                    gram[k][l] += m_jacobian_t[k][i] * m_jacobian_t[l][i];
+            }
+        double gramDet = 1.;
+        double gramInv[2][2] = {{1., 0.}, {0., 1.}};
+        if (mydim == 1) {
+            gramDet = gram[0][0];
+            gramInv[0][0] = 1. / gramDet;
+        }
+        else if (mydim == 2) {
+            gramDet = gram[0][0] * gram[1][1] - gram[0][1] * gram[1][0];
+            gramInv[0][0] = gram[1][1] / gramDet;
+            gramInv[0][1] = -gram[0][1] / gramDet;
+            gramInv[1][0] = -gram[1][0] / gramDet;
+            gramInv[1][1] = gram[0][0] / gramDet;
+        }
+        m_integration_element = std::sqrt(std::abs(gramDet));
+
+        // Pseudoinverse transposed: J G^{-1}
+        for (int i = 0; i < coorddimension; ++i)
+            for (int k = 0; k < mydim; ++k) {
+                m_jacobian_inv_t[i][k] = 0.;
+                for (int l = 0; l < mydim; ++l)
+                    m_jacobian_inv_t[i][k] += m_jacobian_t[l][i] * gramInv[l][k];
+            }
+
+        for (int i = 0; i < coorddimension; ++i)
+            m_normal[i] = 0.;
+        if (mydim == 2) {
+            const double (*jt)[coorddimension] = m_jacobian_t;
+            m_normal[0] = jt[0][1] * jt[1][2] - jt[0][2] * jt[1][1];
+            m_normal[1] = jt[0][2] * jt[1][0] - jt[0][0] * jt[1][2];
+            m_normal[2] = jt[0][0] * jt[1][1] - jt[0][1] * jt[1][0];
+            for (int i = 0; i < coorddimension; ++i)
+                m_normal[i] /= m_integration_element;
+        }
+    }
+
+private:
+    // Arrays of size 0 are not allowed, hence the "+ 1"s below
+    double m_corners[cornercount][coorddimension];
+    double m_jacobian_t[mydim + 1][coorddimension];
+    double m_jacobian_inv_t[coorddimension][mydim + 1];
+    double m_normal[coorddimension];
+    double m_integration_element;
+};
+
+/** \brief Factory of FlatSimplexGeometry objects of dimension \p mydim. */
+template <int mydim>
+class FlatSimplexGeometryFactory : public GeometryFactory
+{
+public:
+    virtual std::auto_ptr<Geometry> make() const {
+        return std::auto_ptr<Geometry>(new FlatSimplexGeometry<mydim>);
+    }
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,316 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_flat_triangle_entity_hpp
+#define bempp_flat_triangle_entity_hpp
+
+#include "../common/common.hpp"
+
+#include "entity.hpp"
+#include "entity_iterator.hpp"
+#include "entity_pointer.hpp"
+#include "flat_simplex_geometry.hpp"
+#include "flat_triangle_grid.hpp"
+#include "geometry_type.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+template <int codim> class FlatTriangleEntityIterator;
+/** \endcond */
+
+/** \brief Entity of codimension \p codim (1 or 2) of a FlatTriangleGrid.
+
+  The entity is a lightweight (grid, index) pair. Its geometry is set up from
+  the connectivity arrays of the grid on the first call to geometry(). */
+template <int codim>
+class FlatTriangleEntity: public Entity<codim>
+{
+public:
+    /** \brief Constructor. */
+    FlatTriangleEntity(const FlatTriangleGrid* grid, int index) :
+        m_grid(grid), m_index(index), m_geometry_up_to_date(false) {
+    }
+
+    /** \brief Grid containing this entity. */
+    const FlatTriangleGrid& grid() const {
+        return *m_grid;
+    }
+
+    /** \brief Index of this entity in the grid. */
+    int index() const {
+        return m_index;
+    }
+
+    virtual size_t level() const {
+        return 0;
+    }
+
+    virtual const Geometry& geometry() const {
+        if (!m_geometry_up_to_date) {
+            updateGeometry();
+            m_geometry_up_to_date = true;
+        }
+        return m_geometry;
+    }
+
+    virtual GeometryType type() const {
+        return m_geometry.type();
+    }
+
+private:
+    template <int> friend class FlatTriangleEntityIterator;
+
+    void setIndex(int index) {
+        m_index = index;
+        m_geometry_up_to_date = false;
+    }
+
+    void updateGeometry() const;
+
+private:
+    const FlatTriangleGrid* m_grid;
+    int m_index;
+    /** \internal Entity geometry. Updated on demand (on calling
+     * geometry()), hence declared as mutable. */
+    mutable FlatSimplexGeometry<2 - codim> m_geometry;
+    mutable bool m_geometry_up_to_date;
+};
+
+template <>
+inline void FlatTriangleEntity<1>::updateGeometry() const
+{
+    const arma::Mat<double>& vertices = m_grid->vertices();
+    const int* edgeVertices = m_grid->edgeVertices().colptr(m_index);
+    const double* corners[2] = {
+        vertices.colptr(edgeVertices[0]), vertices.colptr(edgeVertices[1])
+    };
+    m_geometry.setCorners(corners);
+}
+
+template <>
+inline void FlatTriangleEntity<2>::updateGeometry() const
+{
+    const double* corners[1] = { m_grid->vertices().colptr(m_index) };
+    m_geometry.setCorners(corners);
+}
+
+/** \brief Element (entity of codimension 0) of a FlatTriangleGrid. */
+template <>
+class FlatTriangleEntity<0>: public Entity<0>
+{
+public:
+    /** \brief Constructor. */
+    FlatTriangleEntity(const FlatTriangleGrid* grid, int index) :
+        m_grid(grid), m_index(index), m_geometry_up_to_date(false) {
+    }
+
+    /** \brief Grid containing this entity. */
+    const FlatTriangleGrid& grid() const {
+        return *m_grid;
+    }
+
+    /** \brief Index of this entity in the grid. */
+    int index() const {
+        return m_index;
+    }
+
+    virtual size_t level() const {
+        return 0;
+    }
+
+    virtual const Geometry& geometry() const {
+        if (!m_geometry_up_to_date) {
+            const arma::Mat<double>& vertices = m_grid->vertices();
+            const int* elementCorners =
+                    m_grid->elementCorners().colptr(m_index);
+            const double* corners[3] = {
+                vertices.colptr(elementCorners[0]),
+                vertices.colptr(elementCorners[1]),
+                vertices.colptr(elementCorners[2])
+            };
+            m_geometry.setCorners(corners);
+            m_geometry_up_to_date = true;
+        }
+        return m_geometry;
+    }
+
+    virtual GeometryType type() const {
+        return m_geometry.type();
+    }
+
+    /** \brief Inter-level access to father entity on the next-coarser grid.
+
+      A FlatTriangleGrid has only one level, so a null pointer is always
+      returned. */
+    virtual std::auto_ptr<EntityPointer<0> > father() const {
+        return std::auto_ptr<EntityPointer<0> >();
+    }
+
+    virtual bool hasFather() const {
+        return false;
+    }
+
+    virtual bool isLeaf() const {
+        return true;
+    }
+
+    virtual bool isRegular() const {
+        return true;
+    }
+
+    virtual std::auto_ptr<EntityIterator<0> > sonIterator(int maxlevel) const;
+
+    virtual bool isNew() const {
+        return false;
+    }
+
+    virtual bool mightVanish() const {
+        return false;
+    }
+
+private:
+    template <int> friend class FlatTriangleEntityIterator;
+
+    void setIndex(int index) {
+        m_index = index;
+        m_geometry_up_to_date = false;
+    }
+
+    virtual std::auto_ptr<EntityIterator<1> > subEntityCodim1Iterator() const;
+    virtual std::auto_ptr<EntityIterator<2> > subEntityCodim2Iterator() const;
+    virtual std::auto_ptr<EntityIterator<3> > subEntityCodim3Iterator() const {
+        throw std::logic_error("Entity::subEntityIterator(): invalid entity codimension");
+    }
+
+    virtual size_t subEntityCodim1Count() const {
+        return 3;
+    }
+    virtual size_t subEntityCodim2Count() const {
+        return 3;
+    }
+    virtual size_t subEntityCodim3Count() const {
+        return 0;
+    }
+
+private:
+    const FlatTriangleGrid* m_grid;
+    int m_index;
+    /** \internal Entity geometry. Updated on demand (on calling
+     * geometry()), hence declared as mutable. */
+    mutable FlatSimplexGeometry<2> m_geometry;
+    mutable bool m_geometry_up_to_date;
+};
+
+/** \brief Pointer to an entity of codimension \p codim of a FlatTriangleGrid. */
+template <int codim>
+class FlatTriangleEntityPointer: public EntityPointer<codim>
+{
+public:
+    /** \brief Constructor. */
+    FlatTriangleEntityPointer(const FlatTriangleGrid* grid, int index) :
+        m_entity(grid, index) {
+    }
+
+    virtual const Entity<codim>& entity() const {
+        return m_entity;
+    }
+
+private:
+    FlatTriangleEntity<codim> m_entity;
+};
+
+/** \brief Iterator over entities of codimension \p codim of a FlatTriangleGrid.
+
+  The iterator traverses either the range 0, 1, ..., \p count - 1 of entity
+  indices or, if \p indices is not null, the indices stored in the array
+  indices[0], ..., indices[count - 1]. The array must stay alive as long
+  as the iterator is used. */
+template <int codim>
+class FlatTriangleEntityIterator: public EntityIterator<codim>
+{
+public:
+    /** \brief Constructor. */
+    FlatTriangleEntityIterator(const FlatTriangleGrid* grid, int count,
+                               const int* indices = 0) :
+        m_entity(grid, 0), m_indices(indices), m_count(count), m_pos(0) {
+        update();
+    }
+
+    virtual void next() {
+        ++m_pos;
+        update();
+    }
+
+    virtual const Entity<codim>& entity() const {
+        return m_entity;
+    }
+
+    virtual std::auto_ptr<EntityPointer<codim> > frozen() const {
+        return std::auto_ptr<EntityPointer<codim> >(
+                    new FlatTriangleEntityPointer<codim>(
+                        &m_entity.grid(), m_entity.index()));
+    }
+
+private:
+    void update() {
+        this->m_finished = (m_pos >= m_count);
+        if (!this->m_finished)
+            m_entity.setIndex(m_indices ? m_indices[m_pos] : m_pos);
+    }
+
+private:
+    FlatTriangleEntity<codim> m_entity;
+    const int* m_indices;
+    int m_count;
+    int m_pos;
+};
+
+inline std::auto_ptr<EntityIterator<0> >
+FlatTriangleEntity<0>::sonIterator(int maxlevel) const
+{
+    // Elements of a FlatTriangleGrid have no sons
+    return std::auto_ptr<EntityIterator<0> >(
+                new FlatTriangleEntityIterator<0>(m_grid, 0));
+}
+
+inline std::auto_ptr<EntityIterator<1> >
+FlatTriangleEntity<0>::subEntityCodim1Iterator() const
+{
+    return std::auto_ptr<EntityIterator<1> >(
+                new FlatTriangleEntityIterator<1>(
+                    m_grid, 3, m_grid->elementEdges().colptr(m_index)));
+}
+
+inline std::auto_ptr<EntityIterator<2> >
+FlatTriangleEntity<0>::subEntityCodim2Iterator() const
+{
+    return std::auto_ptr<EntityIterator<2> >(
+                new FlatTriangleEntityIterator<2>(
+                    m_grid, 3, m_grid->elementCorners().colptr(m_index)));
+}
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,344 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "flat_triangle_grid.hpp"
+
+#include "flat_simplex_geometry.hpp"
+#include "flat_triangle_entity.hpp"
+#include "flat_triangle_grid_view.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tbb/parallel_sort.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Vertices of the edges of the reference triangle (Dune numbering)
+const int EDGE_CORNERS[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+// Local edge of an element, identified by its (sorted) endpoints
+struct HalfEdge
+{
+    int v0, v1;
+    int element;
+    int localEdge;
+
+    bool operator<(const HalfEdge& other) const {
+        if (v0 != other.v0)
+            return v0 < other.v0;
+        if (v1 != other.v1)
+            return v1 < other.v1;
+        if (element != other.element)
+            return element < other.element;
+        return localEdge < other.localEdge;
+    }
+
+    bool sameEdge(const HalfEdge& other) const {
+        return v0 == other.v0 && v1 == other.v1;
+    }
+};
+
+} // namespace
+
+FlatTriangleGrid::FlatTriangleGrid(const arma::Mat<double>& vertices,
+                                   const arma::Mat<int>& elementCorners,
+                                   const std::vector<int>& domainIndices) :
+    m_vertices(vertices), m_element_corners(elementCorners),
+    m_domain_indices(domainIndices), m_boundary_segment_count(0),
+    m_id_set(this)
+{
+    if (vertices.n_rows != 3)
+        throw std::invalid_argument("FlatTriangleGrid::FlatTriangleGrid(): "
+                                    "vertices must have three coordinates");
+    if (elementCorners.n_rows != 3)
+        throw std::invalid_argument("FlatTriangleGrid::FlatTriangleGrid(): "
+                                    "elementCorners must have three rows");
+    if (!domainIndices.empty() && domainIndices.size() != elementCorners.n_cols)
+        throw std::invalid_argument("FlatTriangleGrid::FlatTriangleGrid(): "
+                                    "domainIndices must be empty or have as "
+                                    "many elements as elementCorners has columns");
+    const int vertexCount = vertices.n_cols;
+    for (size_t i = 0; i < elementCorners.n_elem; ++i)
+        if (elementCorners[i] < 0 || elementCorners[i] >= vertexCount)
+            throw std::invalid_argument("FlatTriangleGrid::FlatTriangleGrid(): "
+                                        "invalid vertex index in elementCorners");
+    buildEdges();
+}
+
+FlatTriangleGrid::~FlatTriangleGrid()
+{
+}
+
+void FlatTriangleGrid::buildEdges()
+{
+    const int elementCount = m_element_corners.n_cols;
+
+    // Sort the local edges of all elements by their endpoints; local edges
+    // belonging to the same edge end up next to each other
+    std::vector<HalfEdge> halfEdges(3 * elementCount);
+    for (int e = 0; e < elementCount; ++e)
+        for (int l = 0; l < 3; ++l) {
+            HalfEdge& he = halfEdges[3 * e + l];
+            const int a = m_element_corners(EDGE_CORNERS[l][0], e);
+            const int b = m_element_corners(EDGE_CORNERS[l][1], e);
+            he.v0 = std::min(a, b);
+            he.v1 = std::max(a, b);
+            he.element = e;
+            he.localEdge = l;
+        }
+    tbb::parallel_sort(halfEdges.begin(), halfEdges.end());
+
+    int edgeCount = 0;
+    for (size_t i = 0; i < halfEdges.size(); ++i)
+        if (i == 0 || !halfEdges[i].sameEdge(halfEdges[i - 1]))
+            ++edgeCount;
+
+    m_element_edges.set_size(3, elementCount);
+    m_edge_vertices.set_size(2, edgeCount);
+    m_element_neighbours.set_size(3, elementCount);
+    m_element_neighbours.fill(-1);
+    m_boundary_segment_count = 0;
+
+    int edge = -1;
+    for (size_t begin = 0, end = 0; begin < halfEdges.size(); begin = end) {
+        end = begin + 1;
+        while (end < halfEdges.size() &&
+               halfEdges[end].sameEdge(halfEdges[begin]))
+            ++end;
+
+        ++edge;
+        m_edge_vertices(0, edge) = halfEdges[begin].v0;
+        m_edge_vertices(1, edge) = halfEdges[begin].v1;
+        for (size_t i = begin; i < end; ++i)
+            m_element_edges(halfEdges[i].localEdge, halfEdges[i].element) = edge;
+
+        if (end - begin == 1)
+            ++m_boundary_segment_count;
+        else if (end - begin == 2) {
+            const HalfEdge& first = halfEdges[begin];
+            const HalfEdge& second = halfEdges[begin + 1];
+            m_element_neighbours(first.localEdge, first.element) = second.element;
+            m_element_neighbours(second.localEdge, second.element) = first.element;
+        }
+        // Edges shared by more than two elements have no well-defined
+        // neighbours
+    }
+}
+
+int FlatTriangleGrid::dim() const
+{
+    return 2;
+}
+
+int FlatTriangleGrid::dimWorld() const
+{
+    return 3;
+}
+
+int FlatTriangleGrid::maxLevel() const
+{
+    return 0;
+}
+
+size_t FlatTriangleGrid::boundarySegmentCount() const
+{
+    return m_boundary_segment_count;
+}
+
+std::auto_ptr<GridView> FlatTriangleGrid::levelView(size_t level) const
+{
+    if (level != 0)
+        throw std::invalid_argument("FlatTriangleGrid::levelView(): "
+                                    "the grid has only one level");
+    return leafView();
+}
+
+std::auto_ptr<GridView> FlatTriangleGrid::leafView() const
+{
+    return std::auto_ptr<GridView>(new FlatTriangleGridView(this));
+}
+
+GridParameters::Topology FlatTriangleGrid::topology() const
+{
+    return GridParameters::TRIANGULAR;
+}
+
+std::auto_ptr<GeometryFactory> FlatTriangleGrid::elementGeometryFactory() const
+{
+    return std::auto_ptr<GeometryFactory>(new FlatSimplexGeometryFactory<2>);
+}
+
+const IdSet& FlatTriangleGrid::globalIdSet() const
+{
+    return m_id_set;
+}
+
+void FlatTriangleGrid::getDomainIndices(std::vector<int>& domainIndices) const
+{
+    if (m_domain_indices.empty())
+        domainIndices.assign(elementCount(), 0);
+    else
+        domainIndices = m_domain_indices;
+}
+
+// FlatTriangleIndexSet
+
+FlatTriangleIndexSet::FlatTriangleIndexSet(const FlatTriangleGrid* grid) :
+    m_grid(grid)
+{
+}
+
+IndexSet::IndexType FlatTriangleIndexSet::entityIndex(const Entity<0>& e) const
+{
+    return dynamic_cast<const FlatTriangleEntity<0>&>(e).index();
+}
+
+IndexSet::IndexType FlatTriangleIndexSet::entityIndex(const Entity<1>& e) const
+{
+    return dynamic_cast<const FlatTriangleEntity<1>&>(e).index();
+}
+
+IndexSet::IndexType FlatTriangleIndexSet::entityIndex(const Entity<2>& e) const
+{
+    return dynamic_cast<const FlatTriangleEntity<2>&>(e).index();
+}
+
+IndexSet::IndexType FlatTriangleIndexSet::entityIndex(const Entity<3>& e) const
+{
+    throw std::logic_error("IndexSet::entityIndex(): invalid entity codimension");
+}
+
+IndexSet::IndexType FlatTriangleIndexSet::subEntityIndex(
+        const Entity<0>& e, size_t i, int codimSub) const
+{
+    const int index = dynamic_cast<const FlatTriangleEntity<0>&>(e).index();
+    switch (codimSub) {
+    case 0:
+        return index;
+    case 1:
+        return m_grid->elementEdges()(i, index);
+    case 2:
+        return m_grid->elementCorners()(i, index);
+    default:
+        throw std::invalid_argument("IndexSet::subEntityIndex(): codimSub exceeds grid dimension");
+    }
+}
+
+// FlatTriangleIdSet
+
+FlatTriangleIdSet::FlatTriangleIdSet(const FlatTriangleGrid* grid) :
+    m_grid(grid), m_index_set(grid)
+{
+}
+
+IdSet::IdType FlatTriangleIdSet::offset(int codim) const
+{
+    switch (codim) {
+    case 0:
+        return 0;
+    case 1:
+        return m_grid->elementCount();
+    case 2:
+        return m_grid->elementCount() + m_grid->edgeCount();
+    default:
+        throw std::invalid_argument("IdSet::entityId(): codimension exceeds "
+                                    "grid dimension");
+    }
+}
+
+IdSet::IdType FlatTriangleIdSet::entityId(const Entity<0>& e) const
+{
+    return offset(0) + m_index_set.entityIndex(e);
+}
+
+IdSet::IdType FlatTriangleIdSet::entityId(const Entity<1>& e) const
+{
+    return offset(1) + m_index_set.entityIndex(e);
+}
+
+IdSet::IdType FlatTriangleIdSet::entityId(const Entity<2>& e) const
+{
+    return offset(2) + m_index_set.entityIndex(e);
+}
+
+IdSet::IdType FlatTriangleIdSet::entityId(const Entity<3>& e) const
+{
+    return m_index_set.entityIndex(e); // throws
+}
+
+IdSet::IdType FlatTriangleIdSet::subEntityId(
+        const Entity<0>& e, size_t i, int codimSub) const
+{
+    return offset(codimSub) + m_index_set.subEntityIndex(e, i, codimSub);
+}
+
+// FlatTriangleElementMapper
+
+FlatTriangleElementMapper::FlatTriangleElementMapper(const FlatTriangleGrid* grid) :
+    m_grid(grid)
+{
+}
+
+size_t FlatTriangleElementMapper::size() const
+{
+    return m_grid->elementCount();
+}
+
+size_t FlatTriangleElementMapper::entityIndex(const Entity<0>& e) const
+{
+    return dynamic_cast<const FlatTriangleEntity<0>&>(e).index();
+}
+
+size_t FlatTriangleElementMapper::entityIndex(const Entity<1>& e) const
+{
+    throw std::logic_error("FlatTriangleElementMapper::entityIndex(): "
+                           "entities of codimension 1 do not belong to the "
+                           "managed set.");
+}
+
+size_t FlatTriangleElementMapper::entityIndex(const Entity<2>& e) const
+{
+    throw std::logic_error("FlatTriangleElementMapper::entityIndex(): "
+                           "entities of codimension 2 do not belong to the "
+                           "managed set.");
+}
+
+size_t FlatTriangleElementMapper::entityIndex(const Entity<3>& e) const
+{
+    throw std::logic_error("FlatTriangleElementMapper::entityIndex(): "
+                           "entities of codimension 3 do not belong to the "
+                           "managed set.");
+}
+
+size_t FlatTriangleElementMapper::subEntityIndex(
+        const Entity<0>& e, size_t i, int codimSub) const
+{
+    if (codimSub != 0)
+        throw std::logic_error("FlatTriangleElementMapper::subEntityIndex(): "
+                               "only entities of codimension 0 belong to the "
+                               "managed set.");
+    return entityIndex(e);
+}
+
+} // namespace Bempp
@@ -0,0 +1,178 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_flat_triangle_grid_hpp
+#define bempp_flat_triangle_grid_hpp
+
+#include "../common/common.hpp"
+
+#include "grid.hpp"
+#include "flat_triangle_index_set.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <memory>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \brief Triangular surface grid stored in flat connectivity arrays.
+
+  Unlike ConcreteGrid, this class does not wrap a Dune grid. The vertex
+  coordinates, the element-vertex, element-edge and edge-vertex connectivity
+  and the element neighbours are kept in contiguous arrays, which can be
+  accessed directly through the methods in the "Connectivity" group. Index
+  sets, mappers and entities of the grid are thin views of these arrays;
+  iterating over entities does not allocate memory per entity.
+
+  The local numbering of the edges of an element follows the Dune reference
+  triangle: edge 0 joins corners 0 and 1, edge 1 joins corners 0 and 2 and
+  edge 2 joins corners 1 and 2.
+
+  The grid consists of a single level and cannot be adapted.
+ */
+class FlatTriangleGrid: public Grid
+{
+public:
+    /** \brief Constructor.
+
+     \param[in] vertices        (3 x m) array whose ith column contains the
+                                coordinates of the ith vertex.
+     \param[in] elementCorners  (3 x n) array whose ith column contains the
+                                indices of the vertices of the ith element.
+     \param[in] domainIndices   Domain indices of the elements of the grid
+                                (see Grid::getDomainIndices()). May be empty.
+
+     Vertices and elements are numbered in the order of the columns of
+     \p vertices and \p elementCorners. Edges are numbered in the
+     lexicographic order of the indices of their endpoints. */
+    FlatTriangleGrid(const arma::Mat<double>& vertices,
+                     const arma::Mat<int>& elementCorners,
+                     const std::vector<int>& domainIndices = std::vector<int>());
+
+    /** \brief Destructor. */
+    virtual ~FlatTriangleGrid();
+
+    /** @name Grid parameters
+    @{ */
+
+    virtual int dim() const;
+    virtual int dimWorld() const;
+    virtual int maxLevel() const;
+    virtual size_t boundarySegmentCount() const;
+
+    /** @}
+    @name Views
+    @{ */
+
+    /** \brief View of the entities on grid level \p level.
+
+      Since the grid has only one level, \p level must be 0. */
+    virtual std::auto_ptr<GridView> levelView(size_t level) const;
+    virtual std::auto_ptr<GridView> leafView() const;
+    virtual GridParameters::Topology topology() const;
+    virtual std::auto_ptr<GeometryFactory> elementGeometryFactory() const;
+
+    /** @}
+    @name Id sets
+    @{ */
+
+    virtual const IdSet& globalIdSet() const;
+
+    /** @}
+    @name Domains
+    @{ */
+
+    virtual void getDomainIndices(std::vector<int>& domainIndices) const;
+
+    /** @}
+    @name Connectivity
+    @{ */
+
+    /** \brief Number of vertices. */
+    size_t vertexCount() const {
+        return m_vertices.n_cols;
+    }
+
+    /** \brief Number of edges. */
+    size_t edgeCount() const {
+        return m_edge_vertices.n_cols;
+    }
+
+    /** \brief Number of elements. */
+    size_t elementCount() const {
+        return m_element_corners.n_cols;
+    }
+
+    /** \brief (3 x vertexCount()) array of vertex coordinates. */
+    const arma::Mat<double>& vertices() const {
+        return m_vertices;
+    }
+
+    /** \brief (3 x elementCount()) array whose ith column contains the
+     *  indices of the vertices of the ith element. */
+    const arma::Mat<int>& elementCorners() const {
+        return m_element_corners;
+    }
+
+    /** \brief (3 x elementCount()) array whose ith column contains the
+     *  indices of the edges of the ith element. */
+    const arma::Mat<int>& elementEdges() const {
+        return m_element_edges;
+    }
+
+    /** \brief (2 x edgeCount()) array whose ith column contains the
+     *  indices of the endpoints of the ith edge in increasing order. */
+    const arma::Mat<int>& edgeVertices() const {
+        return m_edge_vertices;
+    }
+
+    /** \brief (3 x elementCount()) array of element neighbours.
+     *
+     *  The (j, i)th entry is the index of the element sharing the jth edge
+     *  of the ith element, or -1 if that edge lies on the boundary of the
+     *  grid or is shared by more than two elements. */
+    const arma::Mat<int>& elementNeighbours() const {
+        return m_element_neighbours;
+    }
+
+    /** @} */
+
+private:
+    void buildEdges();
+
+    // Disable copy constructor and assignment operator
+    FlatTriangleGrid(const FlatTriangleGrid&);
+    FlatTriangleGrid& operator=(const FlatTriangleGrid&);
+
+private:
+    arma::Mat<double> m_vertices;
+    arma::Mat<int> m_element_corners;
+    arma::Mat<int> m_element_edges;
+    arma::Mat<int> m_edge_vertices;
+    arma::Mat<int> m_element_neighbours;
+    std::vector<int> m_domain_indices;
+    size_t m_boundary_segment_count;
+    FlatTriangleIdSet m_id_set;
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "flat_triangle_grid_view.hpp"
+
+#include "flat_triangle_entity.hpp"
+#include "flat_triangle_grid.hpp"
+#include "vtu_writer.hpp"
+
+#include "../common/not_implemented_error.hpp"
+
+#include <stdexcept>
+
+namespace Bempp
+{
+
+FlatTriangleGridView::FlatTriangleGridView(const FlatTriangleGrid* grid) :
+    m_grid(grid), m_index_set(grid), m_element_mapper(grid),
+    m_reverse_element_mapper(*this),
+    m_reverse_element_mapper_is_up_to_date(false)
+{
+}
+
+size_t FlatTriangleGridView::entityCount(int codim) const
+{
+    switch (codim) {
+    case 0:
+        return m_grid->elementCount();
+    case 1:
+        return m_grid->edgeCount();
+    case 2:
+        return m_grid->vertexCount();
+    default:
+        return 0;
+    }
+}
+
+size_t FlatTriangleGridView::entityCount(const GeometryType& type) const
+{
+    if (type.isTriangle())
+        return m_grid->elementCount();
+    else if (type.isLine())
+        return m_grid->edgeCount();
+    else if (type.isVertex())
+        return m_grid->vertexCount();
+    else
+        return 0;
+}
+
+namespace
+{
+
+template <int codim>
+bool containsFlatTriangleEntity(const FlatTriangleGrid* grid,
+                                const Entity<codim>& e)
+{
+    const FlatTriangleEntity<codim>* fe =
+            dynamic_cast<const FlatTriangleEntity<codim>*>(&e);
+    return fe && &fe->grid() == grid;
+}
+
+} // namespace
+
+bool FlatTriangleGridView::containsEntity(const Entity<0>& e) const
+{
+    return containsFlatTriangleEntity(m_grid, e);
+}
+
+bool FlatTriangleGridView::containsEntity(const Entity<1>& e) const
+{
+    return containsFlatTriangleEntity(m_grid, e);
+}
+
+bool FlatTriangleGridView::containsEntity(const Entity<2>& e) const
+{
+    return containsFlatTriangleEntity(m_grid, e);
+}
+
+bool FlatTriangleGridView::containsEntity(const Entity<3>& e) const
+{
+    throw std::logic_error("GridView::containsEntity(): invalid entity codimension");
+}
+
+const ReverseElementMapper& FlatTriangleGridView::reverseElementMapper() const
+{
+    if (!m_reverse_element_mapper_is_up_to_date)
+    {
+        m_reverse_element_mapper.update();
+        m_reverse_element_mapper_is_up_to_date = true;
+    }
+    return m_reverse_element_mapper;
+}
+
+std::auto_ptr<VtkWriter> FlatTriangleGridView::vtkWriter(Dune::VTK::DataMode dm) const
+{
+    if (dm != Dune::VTK::conforming)
+        throw NotImplementedError("FlatTriangleGridView::vtkWriter(): "
+                                  "only conforming VTK output is supported");
+    return std::auto_ptr<VtkWriter>(new VtuWriter(*this, 2 /* gridDim */));
+}
+
+void FlatTriangleGridView::getRawElementDataDoubleImpl(
+        arma::Mat<double>& vertices,
+        arma::Mat<int>& elementCorners,
+        arma::Mat<char>& auxData) const
+{
+    getRawElementDataImpl(vertices, elementCorners, auxData);
+}
+
+void FlatTriangleGridView::getRawElementDataFloatImpl(
+        arma::Mat<float>& vertices,
+        arma::Mat<int>& elementCorners,
+        arma::Mat<char>& auxData) const
+{
+    getRawElementDataImpl(vertices, elementCorners, auxData);
+}
+
+template <typename CoordinateType>
+void FlatTriangleGridView::getRawElementDataImpl(
+        arma::Mat<CoordinateType>& vertices,
+        arma::Mat<int>& elementCorners,
+        arma::Mat<char>& auxData) const
+{
+    const arma::Mat<double>& gridVertices = m_grid->vertices();
+    const arma::Mat<int>& gridElementCorners = m_grid->elementCorners();
+
+    vertices.set_size(gridVertices.n_rows, gridVertices.n_cols);
+    for (size_t i = 0; i < gridVertices.n_elem; ++i)
+        vertices[i] = gridVertices[i];
+
+    // Same layout as in ConcreteGridView: room for four corners per element,
+    // unused entries set to -1
+    const int MAX_CORNER_COUNT = 4;
+    const size_t elementCount = gridElementCorners.n_cols;
+    elementCorners.set_size(MAX_CORNER_COUNT, elementCount);
+    for (size_t e = 0; e < elementCount; ++e) {
+        for (int i = 0; i < 3; ++i)
+            elementCorners(i, e) = gridElementCorners(i, e);
+        elementCorners(3, e) = -1;
+    }
+
+    auxData.set_size(0, elementCount);
+}
+
+void FlatTriangleGridView::getRawElementEdgeDataImpl(
+        arma::Mat<int>& elementEdges) const
+{
+    const arma::Mat<int>& gridElementEdges = m_grid->elementEdges();
+
+    // Same layout as in ConcreteGridView
+    const int MAX_EDGE_COUNT = 4;
+    const size_t elementCount = gridElementEdges.n_cols;
+    elementEdges.set_size(MAX_EDGE_COUNT, elementCount);
+    for (size_t e = 0; e < elementCount; ++e) {
+        for (int i = 0; i < 3; ++i)
+            elementEdges(i, e) = gridElementEdges(i, e);
+        elementEdges(3, e) = -1;
+    }
+}
+
+std::auto_ptr<EntityIterator<0> > FlatTriangleGridView::entityCodim0Iterator() const
+{
+    return std::auto_ptr<EntityIterator<0> >(
+                new FlatTriangleEntityIterator<0>(m_grid, m_grid->elementCount()));
+}
+
+std::auto_ptr<EntityIterator<1> > FlatTriangleGridView::entityCodim1Iterator() const
+{
+    return std::auto_ptr<EntityIterator<1> >(
+                new FlatTriangleEntityIterator<1>(m_grid, m_grid->edgeCount()));
+}
+
+std::auto_ptr<EntityIterator<2> > FlatTriangleGridView::entityCodim2Iterator() const
+{
+    return std::auto_ptr<EntityIterator<2> >(
+                new FlatTriangleEntityIterator<2>(m_grid, m_grid->vertexCount()));
+}
+
+std::auto_ptr<EntityIterator<3> > FlatTriangleGridView::entityCodim3Iterator() const
+{
+    throw std::logic_error("GridView::entityIterator(): invalid entity codimension");
+}
+
+} // namespace Bempp
@@ -0,0 +1,100 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_flat_triangle_grid_view_hpp
+#define bempp_flat_triangle_grid_view_hpp
+
+#include "../common/common.hpp"
+
+#include "grid_view.hpp"
+#include "flat_triangle_index_set.hpp"
+#include "reverse_element_mapper.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class FlatTriangleGrid;
+/** \endcond */
+
+/** \brief View of the (only) level of a FlatTriangleGrid. */
+class FlatTriangleGridView: public GridView
+{
+public:
+    /** \brief Constructor.
+
+    This object does not assume ownership of \p *grid. */
+    explicit FlatTriangleGridView(const FlatTriangleGrid* grid);
+
+    /** \brief Grid viewed by this object. */
+    const FlatTriangleGrid& grid() const {
+        return *m_grid;
+    }
+
+    virtual const IndexSet& indexSet() const {
+        return m_index_set;
+    }
+
+    virtual const Mapper& elementMapper() const {
+        return m_element_mapper;
+    }
+
+    virtual size_t entityCount(int codim) const;
+    virtual size_t entityCount(const GeometryType &type) const;
+
+    virtual bool containsEntity(const Entity<0>& e) const;
+    virtual bool containsEntity(const Entity<1>& e) const;
+    virtual bool containsEntity(const Entity<2>& e) const;
+    virtual bool containsEntity(const Entity<3>& e) const;
+
+    virtual const ReverseElementMapper& reverseElementMapper() const;
+
+    virtual std::auto_ptr<VtkWriter> vtkWriter(Dune::VTK::DataMode dm=Dune::VTK::conforming) const;
+
+private:
+    virtual void getRawElementDataDoubleImpl(arma::Mat<double>& vertices,
+                                             arma::Mat<int>& elementCorners,
+                                             arma::Mat<char>& auxData) const;
+    virtual void getRawElementDataFloatImpl(arma::Mat<float>& vertices,
+                                            arma::Mat<int>& elementCorners,
+                                            arma::Mat<char>& auxData) const;
+    virtual void getRawElementEdgeDataImpl(arma::Mat<int>& elementEdges) const;
+
+    virtual std::auto_ptr<EntityIterator<0> > entityCodim0Iterator() const;
+    virtual std::auto_ptr<EntityIterator<1> > entityCodim1Iterator() const;
+    virtual std::auto_ptr<EntityIterator<2> > entityCodim2Iterator() const;
+    virtual std::auto_ptr<EntityIterator<3> > entityCodim3Iterator() const;
+
+    template <typename CoordinateType>
+    void getRawElementDataImpl(arma::Mat<CoordinateType>& vertices,
+                               arma::Mat<int>& elementCorners,
+                               arma::Mat<char>& auxData) const;
+
+private:
+    const FlatTriangleGrid* m_grid;
+    FlatTriangleIndexSet m_index_set;
+    FlatTriangleElementMapper m_element_mapper;
+    mutable ReverseElementMapper m_reverse_element_mapper;
+    mutable bool m_reverse_element_mapper_is_up_to_date;
+};
+
+} // namespace Bempp
+
+#endif
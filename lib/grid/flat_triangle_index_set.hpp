@@ -0,0 +1,114 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_flat_triangle_index_set_hpp
+#define bempp_flat_triangle_index_set_hpp
+
+#include "../common/common.hpp"
+
+#include "id_set.hpp"
+#include "index_set.hpp"
+#include "mapper.hpp"
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class FlatTriangleGrid;
+/** \endcond */
+
+/** \brief Index set of a FlatTriangleGrid.
+
+  Entities are indexed by their positions in the connectivity arrays of the
+  grid, so that all index queries reduce to array lookups. */
+class FlatTriangleIndexSet: public IndexSet
+{
+public:
+    /** \brief Constructor.
+
+    This object does not assume ownership of \p *grid. */
+    explicit FlatTriangleIndexSet(const FlatTriangleGrid* grid);
+
+    virtual IndexType entityIndex(const Entity<0>& e) const;
+    virtual IndexType entityIndex(const Entity<1>& e) const;
+    virtual IndexType entityIndex(const Entity<2>& e) const;
+    virtual IndexType entityIndex(const Entity<3>& e) const;
+
+    virtual IndexType subEntityIndex(const Entity<0>& e, size_t i, int codimSub) const;
+
+private:
+    const FlatTriangleGrid* m_grid;
+};
+
+/** \brief Id set of a FlatTriangleGrid.
+
+  A FlatTriangleGrid cannot be adapted, hence the ids of its entities are
+  derived from their indices. To make them unique across codimensions,
+  elements have ids [0, elementCount()), edges the following edgeCount() ids
+  and vertices the following vertexCount() ids. */
+class FlatTriangleIdSet: public IdSet
+{
+public:
+    /** \brief Constructor.
+
+    This object does not assume ownership of \p *grid. */
+    explicit FlatTriangleIdSet(const FlatTriangleGrid* grid);
+
+    virtual IdType entityId(const Entity<0>& e) const;
+    virtual IdType entityId(const Entity<1>& e) const;
+    virtual IdType entityId(const Entity<2>& e) const;
+    virtual IdType entityId(const Entity<3>& e) const;
+
+    virtual IdType subEntityId(const Entity<0>& e, size_t i, int codimSub) const;
+
+private:
+    IdType offset(int codim) const;
+
+private:
+    const FlatTriangleGrid* m_grid;
+    FlatTriangleIndexSet m_index_set;
+};
+
+/** \brief Element mapper of a FlatTriangleGrid. */
+class FlatTriangleElementMapper : public Mapper
+{
+public:
+    /** \brief Constructor.
+
+    This object does not assume ownership of \p *grid. */
+    explicit FlatTriangleElementMapper(const FlatTriangleGrid* grid);
+
+    virtual size_t size() const;
+
+    virtual size_t entityIndex(const Entity<0>& e) const;
+    virtual size_t entityIndex(const Entity<1>& e) const;
+    virtual size_t entityIndex(const Entity<2>& e) const;
+    virtual size_t entityIndex(const Entity<3>& e) const;
+
+    virtual size_t subEntityIndex(const Entity<0>& e, size_t i,
+                                  int codimSub) const;
+
+private:
+    const FlatTriangleGrid* m_grid;
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,610 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "gmsh_reader.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/tick_count.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Gmsh element types
+const int GMSH_LINE = 1;
+const int GMSH_TRIANGLE = 2;
+const int GMSH_POINT = 15;
+
+// Maximum number of nodes of supported elements
+const int MAX_NODE_COUNT = 3;
+
+// Approximate size (in bytes) of the chunks of ASCII sections parsed by
+// individual tasks
+const size_t CHUNK_SIZE = 1 << 16;
+
+void throwError(const std::string& fileName, const std::string& message)
+{
+    throw std::runtime_error("readGmshTriangularGrid(): error reading file '" +
+                             fileName + "': " + message);
+}
+
+/** \brief Read-only memory mapping of a file. */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& fileName) :
+        m_fd(-1), m_size(0), m_data(0)
+    {
+        m_fd = open(fileName.c_str(), O_RDONLY);
+        if (m_fd < 0)
+            throwError(fileName, "cannot open file");
+        struct stat status;
+        if (fstat(m_fd, &status) != 0) {
+            close(m_fd);
+            throwError(fileName, "cannot determine file size");
+        }
+        m_size = status.st_size;
+        if (m_size > 0) {
+            m_data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+            if (m_data == MAP_FAILED) {
+                close(m_fd);
+                throwError(fileName, "cannot map file into memory");
+            }
+        }
+    }
+
+    ~MappedFile() {
+        if (m_data)
+            munmap(m_data, m_size);
+        close(m_fd);
+    }
+
+    const char* begin() const {
+        return static_cast<const char*>(m_data);
+    }
+
+    const char* end() const {
+        return begin() + m_size;
+    }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+private:
+    int m_fd;
+    size_t m_size;
+    void* m_data;
+};
+
+// Parsing helpers. The mapped file is not null-terminated, so none of them
+// reads beyond 'end'.
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline const char* skipSpaces(const char* p, const char* end)
+{
+    while (p != end && isSpace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* skipLine(const char* p, const char* end)
+{
+    p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return p ? p + 1 : end;
+}
+
+inline bool readInt(const char*& p, const char* end, int& value)
+{
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+    int result = 0;
+    while (p != end && *p >= '0' && *p <= '9')
+        result = 10 * result + (*p++ - '0');
+    value = negative ? -result : result;
+    return true;
+}
+
+inline bool readDouble(const char*& p, const char* end, double& value)
+{
+    p = skipSpaces(p, end);
+    // Copy the token to a null-terminated buffer
+    const int MAX_TOKEN_LENGTH = 63;
+    char token[MAX_TOKEN_LENGTH + 1];
+    int length = 0;
+    while (p + length != end && !isSpace(p[length]) &&
+           length < MAX_TOKEN_LENGTH) {
+        token[length] = p[length];
+        ++length;
+    }
+    token[length] = '\0';
+    char* tokenEnd;
+    value = std::strtod(token, &tokenEnd);
+    if (tokenEnd == token)
+        return false;
+    p += tokenEnd - token;
+    return true;
+}
+
+// Return the first line starting with 'keyword', or 'end' if not found
+const char* findLine(const char* p, const char* end, const char* keyword)
+{
+    const size_t length = std::strlen(keyword);
+    while (p != end) {
+        if (size_t(end - p) >= length && std::memcmp(p, keyword, length) == 0)
+            return p;
+        p = skipLine(p, end);
+    }
+    return end;
+}
+
+// Split the lines between 'begin' and 'end' into chunks of approximately
+// equal size. On output, chunkStarts contains the beginnings of chunks
+// (followed by 'end') and firstLines the indices of their first lines
+// (followed by the total number of lines).
+class LineCountLoopBody
+{
+public:
+    LineCountLoopBody(const std::vector<const char*>& chunkStarts,
+                      std::vector<size_t>& lineCounts) :
+        m_chunkStarts(chunkStarts), m_lineCounts(lineCounts) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t chunk = r.begin(); chunk != r.end(); ++chunk) {
+            size_t count = 0;
+            const char* p = m_chunkStarts[chunk];
+            const char* end = m_chunkStarts[chunk + 1];
+            while (p != end) {
+                const char* lineEnd = skipLine(p, end);
+                if (skipSpaces(p, lineEnd) != lineEnd) // skip empty lines
+                    ++count;
+                p = lineEnd;
+            }
+            m_lineCounts[chunk] = count;
+        }
+    }
+
+private:
+    const std::vector<const char*>& m_chunkStarts;
+    std::vector<size_t>& m_lineCounts;
+};
+
+void splitIntoChunks(const char* begin, const char* end,
+                     std::vector<const char*>& chunkStarts,
+                     std::vector<size_t>& firstLines)
+{
+    const size_t chunkCount = (end - begin) / CHUNK_SIZE + 1;
+    chunkStarts.clear();
+    chunkStarts.push_back(begin);
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        const char* p = skipLine(
+                    std::max(chunkStarts.back(),
+                             begin + chunk * ((end - begin) / chunkCount)),
+                    end);
+        if (p != chunkStarts.back())
+            chunkStarts.push_back(p);
+    }
+    chunkStarts.push_back(end);
+
+    std::vector<size_t> lineCounts(chunkStarts.size() - 1);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, lineCounts.size()),
+                      LineCountLoopBody(chunkStarts, lineCounts));
+    firstLines.resize(chunkStarts.size());
+    firstLines[0] = 0;
+    for (size_t chunk = 0; chunk < lineCounts.size(); ++chunk)
+        firstLines[chunk + 1] = firstLines[chunk] + lineCounts[chunk];
+}
+
+/** \brief Contents of the node and element sections of a Gmsh file. */
+struct GmshData
+{
+    std::vector<int> nodeIds;
+    std::vector<double> nodeCoordinates; // 3 per node
+    std::vector<int> elementTypes;
+    std::vector<int> elementPhysicalEntities;
+    std::vector<int> elementNodes; // MAX_NODE_COUNT per element
+};
+
+int nodeCount(int elementType)
+{
+    switch (elementType) {
+    case GMSH_POINT: return 1;
+    case GMSH_LINE: return 2;
+    case GMSH_TRIANGLE: return 3;
+    default: return -1; // unsupported
+    }
+}
+
+class AsciiNodeLoopBody
+{
+public:
+    AsciiNodeLoopBody(const std::vector<const char*>& chunkStarts,
+                      const std::vector<size_t>& firstLines,
+                      GmshData& data, std::vector<char>& chunkErrors) :
+        m_chunkStarts(chunkStarts), m_firstLines(firstLines), m_data(data),
+        m_chunkErrors(chunkErrors) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t chunk = r.begin(); chunk != r.end(); ++chunk) {
+            const char* p = m_chunkStarts[chunk];
+            const char* end = m_chunkStarts[chunk + 1];
+            for (size_t node = m_firstLines[chunk];
+                 node < m_firstLines[chunk + 1]; ++node) {
+                double* coords = &m_data.nodeCoordinates[3 * node];
+                if (!readInt(p, end, m_data.nodeIds[node]) ||
+                        !readDouble(p, end, coords[0]) ||
+                        !readDouble(p, end, coords[1]) ||
+                        !readDouble(p, end, coords[2])) {
+                    m_chunkErrors[chunk] = true;
+                    break;
+                }
+                p = skipLine(p, end);
+            }
+        }
+    }
+
+private:
+    const std::vector<const char*>& m_chunkStarts;
+    const std::vector<size_t>& m_firstLines;
+    GmshData& m_data;
+    std::vector<char>& m_chunkErrors;
+};
+
+class AsciiElementLoopBody
+{
+public:
+    AsciiElementLoopBody(const std::vector<const char*>& chunkStarts,
+                         const std::vector<size_t>& firstLines,
+                         GmshData& data, std::vector<char>& chunkErrors) :
+        m_chunkStarts(chunkStarts), m_firstLines(firstLines), m_data(data),
+        m_chunkErrors(chunkErrors) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t chunk = r.begin(); chunk != r.end(); ++chunk) {
+            const char* p = m_chunkStarts[chunk];
+            const char* end = m_chunkStarts[chunk + 1];
+            for (size_t element = m_firstLines[chunk];
+                 element < m_firstLines[chunk + 1]; ++element) {
+                if (!readElement(p, end, element)) {
+                    m_chunkErrors[chunk] = true;
+                    break;
+                }
+                p = skipLine(p, end);
+            }
+        }
+    }
+
+private:
+    // Line format: id type tagCount tag1 ... tagN node1 ... nodeM
+    bool readElement(const char*& p, const char* end, size_t element) const {
+        int id, type, tagCount, tag;
+        if (!readInt(p, end, id) || !readInt(p, end, type) ||
+                !readInt(p, end, tagCount))
+            return false;
+        m_data.elementTypes[element] = type;
+        m_data.elementPhysicalEntities[element] = 0;
+        for (int i = 0; i < tagCount; ++i) {
+            if (!readInt(p, end, tag))
+                return false;
+            if (i == 0)
+                m_data.elementPhysicalEntities[element] = tag;
+        }
+        const int count = nodeCount(type);
+        for (int i = 0; i < count; ++i)
+            if (!readInt(p, end,
+                         m_data.elementNodes[MAX_NODE_COUNT * element + i]))
+                return false;
+        return true;
+    }
+
+private:
+    const std::vector<const char*>& m_chunkStarts;
+    const std::vector<size_t>& m_firstLines;
+    GmshData& m_data;
+    std::vector<char>& m_chunkErrors;
+};
+
+class BinaryNodeLoopBody
+{
+public:
+    // Record format: int id, double x, double y, double z
+    static const size_t RECORD_SIZE = sizeof(int) + 3 * sizeof(double);
+
+    BinaryNodeLoopBody(const char* begin, GmshData& data) :
+        m_begin(begin), m_data(data) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t node = r.begin(); node != r.end(); ++node) {
+            const char* record = m_begin + node * RECORD_SIZE;
+            // Records are not aligned, hence memcpy
+            std::memcpy(&m_data.nodeIds[node], record, sizeof(int));
+            std::memcpy(&m_data.nodeCoordinates[3 * node],
+                        record + sizeof(int), 3 * sizeof(double));
+        }
+    }
+
+private:
+    const char* m_begin;
+    GmshData& m_data;
+};
+
+// Read the section starting at p, which should point to the line
+// following "$Nodes"
+const char* readNodes(const std::string& fileName, const char* p,
+                      const char* end, bool binary, GmshData& data)
+{
+    int count;
+    if (!readInt(p, end, count) || count < 0)
+        throwError(fileName, "invalid number of nodes");
+    p = skipLine(p, end);
+    data.nodeIds.resize(count);
+    data.nodeCoordinates.resize(3 * count);
+
+    if (binary) {
+        const size_t size = count * BinaryNodeLoopBody::RECORD_SIZE;
+        if (size_t(end - p) < size)
+            throwError(fileName, "unexpected end of file in section $Nodes");
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, count),
+                          BinaryNodeLoopBody(p, data));
+        p += size;
+    } else {
+        const char* sectionEnd = findLine(p, end, "$EndNodes");
+        std::vector<const char*> chunkStarts;
+        std::vector<size_t> firstLines;
+        splitIntoChunks(p, sectionEnd, chunkStarts, firstLines);
+        if (firstLines.back() != size_t(count))
+            throwError(fileName, "number of nodes does not match the header "
+                       "of section $Nodes");
+        std::vector<char> chunkErrors(chunkStarts.size() - 1, false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, chunkErrors.size()),
+                          AsciiNodeLoopBody(chunkStarts, firstLines, data,
+                                            chunkErrors));
+        if (std::find(chunkErrors.begin(), chunkErrors.end(), true) !=
+                chunkErrors.end())
+            throwError(fileName, "invalid entry in section $Nodes");
+        p = sectionEnd;
+    }
+    p = skipSpaces(p, end);
+    if (findLine(p, end, "$EndNodes") != p)
+        throwError(fileName, "section $Nodes not terminated by $EndNodes");
+    return skipLine(p, end);
+}
+
+const char* readElements(const std::string& fileName, const char* p,
+                         const char* end, bool binary, GmshData& data)
+{
+    int count;
+    if (!readInt(p, end, count) || count < 0)
+        throwError(fileName, "invalid number of elements");
+    p = skipLine(p, end);
+    data.elementTypes.resize(count);
+    data.elementPhysicalEntities.resize(count);
+    data.elementNodes.assign(MAX_NODE_COUNT * count, 0);
+
+    if (binary) {
+        // Elements are stored in blocks with headers
+        // (int type, int elementCount, int tagCount); each element consists
+        // of its id, tags and nodes (all ints). The data are copied directly.
+        int element = 0;
+        while (element < count) {
+            int header[3];
+            if (size_t(end - p) < sizeof(header))
+                throwError(fileName, "unexpected end of file in section "
+                           "$Elements");
+            std::memcpy(header, p, sizeof(header));
+            p += sizeof(header);
+            const int type = header[0];
+            const int blockSize = header[1];
+            const int tagCount = header[2];
+            const int nodes = nodeCount(type);
+            if (nodes < 0)
+                throwError(fileName, "unsupported element type");
+            if (blockSize < 0 || tagCount < 0 || blockSize > count - element)
+                throwError(fileName, "invalid element block header");
+            const int recordLength = 1 + tagCount + nodes;
+            const size_t blockBytes = size_t(blockSize) * recordLength *
+                    sizeof(int);
+            if (size_t(end - p) < blockBytes)
+                throwError(fileName, "unexpected end of file in section "
+                           "$Elements");
+            std::vector<int> record(recordLength);
+            for (int i = 0; i < blockSize; ++i, ++element) {
+                std::memcpy(&record[0], p, recordLength * sizeof(int));
+                p += recordLength * sizeof(int);
+                data.elementTypes[element] = type;
+                data.elementPhysicalEntities[element] =
+                        tagCount > 0 ? record[1] : 0;
+                std::copy(record.begin() + 1 + tagCount, record.end(),
+                          data.elementNodes.begin() + MAX_NODE_COUNT * element);
+            }
+        }
+    } else {
+        const char* sectionEnd = findLine(p, end, "$EndElements");
+        std::vector<const char*> chunkStarts;
+        std::vector<size_t> firstLines;
+        splitIntoChunks(p, sectionEnd, chunkStarts, firstLines);
+        if (firstLines.back() != size_t(count))
+            throwError(fileName, "number of elements does not match the "
+                       "header of section $Elements");
+        std::vector<char> chunkErrors(chunkStarts.size() - 1, false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, chunkErrors.size()),
+                          AsciiElementLoopBody(chunkStarts, firstLines, data,
+                                               chunkErrors));
+        if (std::find(chunkErrors.begin(), chunkErrors.end(), true) !=
+                chunkErrors.end())
+            throwError(fileName, "invalid entry in section $Elements");
+        p = sectionEnd;
+    }
+    p = skipSpaces(p, end);
+    if (findLine(p, end, "$EndElements") != p)
+        throwError(fileName, "section $Elements not terminated by "
+                   "$EndElements");
+    return skipLine(p, end);
+}
+
+} // namespace
+
+void readGmshTriangularGrid(const std::string& fileName,
+                            arma::Mat<double>& vertices,
+                            arma::Mat<int>& elementCorners,
+                            std::vector<int>& boundaryId2PhysicalEntity,
+                            std::vector<int>& elementIndex2PhysicalEntity,
+                            bool verbose)
+{
+    tbb::tick_count start = tbb::tick_count::now();
+
+    MappedFile file(fileName);
+    const char* p = file.begin();
+    const char* end = file.end();
+
+    // Header
+    p = findLine(p, end, "$MeshFormat");
+    if (p == end)
+        throwError(fileName, "section $MeshFormat not found");
+    p = skipLine(p, end);
+    double version;
+    int fileType, dataSize;
+    if (!readDouble(p, end, version) || !readInt(p, end, fileType) ||
+            !readInt(p, end, dataSize))
+        throwError(fileName, "invalid section $MeshFormat");
+    if (version < 2. || version >= 3.)
+        throwError(fileName, "only version 2 of the Gmsh format is supported");
+    if (fileType != 0 && fileType != 1)
+        throwError(fileName, "invalid file type");
+    const bool binary = (fileType == 1);
+    if (dataSize != sizeof(double))
+        throwError(fileName, "unsupported floating-point data size");
+    p = skipLine(p, end);
+    if (binary) {
+        int one;
+        if (size_t(end - p) < sizeof(int))
+            throwError(fileName, "invalid section $MeshFormat");
+        std::memcpy(&one, p, sizeof(int));
+        if (one != 1)
+            throwError(fileName, "byte order of the file differs from that "
+                       "of the host");
+        p = skipLine(p + sizeof(int), end);
+    }
+
+    // Nodes and elements. Other sections are skipped.
+    GmshData data;
+    p = findLine(p, end, "$Nodes");
+    if (p == end)
+        throwError(fileName, "section $Nodes not found");
+    p = readNodes(fileName, skipLine(p, end), end, binary, data);
+    p = findLine(p, end, "$Elements");
+    if (p == end)
+        throwError(fileName, "section $Elements not found");
+    p = readElements(fileName, skipLine(p, end), end, binary, data);
+
+    // Map node ids to node indices
+    const int maxNodeId = data.nodeIds.empty() ?
+                -1 : *std::max_element(data.nodeIds.begin(),
+                                       data.nodeIds.end());
+    std::vector<int> nodeIndices(maxNodeId + 1, -1);
+    for (size_t node = 0; node < data.nodeIds.size(); ++node) {
+        if (data.nodeIds[node] < 0)
+            throwError(fileName, "negative node id");
+        nodeIndices[data.nodeIds[node]] = node;
+    }
+
+    // Collect triangles and number their vertices in the order of first use
+    const size_t elementCount = data.elementTypes.size();
+    const size_t triangleCount = std::count(data.elementTypes.begin(),
+                                            data.elementTypes.end(),
+                                            GMSH_TRIANGLE);
+    elementCorners.set_size(3, triangleCount);
+    elementIndex2PhysicalEntity.resize(triangleCount);
+    boundaryId2PhysicalEntity.clear();
+    std::vector<int> vertexIndices(data.nodeIds.size(), -1);
+    std::vector<int> vertexNodes;
+    vertexNodes.reserve(data.nodeIds.size());
+    size_t triangle = 0;
+    for (size_t element = 0; element < elementCount; ++element) {
+        const int type = data.elementTypes[element];
+        if (type == GMSH_TRIANGLE) {
+            for (int corner = 0; corner < 3; ++corner) {
+                const int nodeId =
+                        data.elementNodes[MAX_NODE_COUNT * element + corner];
+                if (nodeId < 0 || nodeId > maxNodeId ||
+                        nodeIndices[nodeId] < 0)
+                    throwError(fileName, "element refers to a nonexistent "
+                               "node");
+                const int node = nodeIndices[nodeId];
+                if (vertexIndices[node] < 0) {
+                    vertexIndices[node] = vertexNodes.size();
+                    vertexNodes.push_back(node);
+                }
+                elementCorners(corner, triangle) = vertexIndices[node];
+            }
+            elementIndex2PhysicalEntity[triangle] =
+                    data.elementPhysicalEntities[element];
+            ++triangle;
+        } else if (type == GMSH_LINE)
+            boundaryId2PhysicalEntity.push_back(
+                        data.elementPhysicalEntities[element]);
+        else if (type != GMSH_POINT)
+            throwError(fileName, "unsupported element type");
+    }
+
+    vertices.set_size(3, vertexNodes.size());
+    for (size_t vertex = 0; vertex < vertexNodes.size(); ++vertex)
+        for (int dim = 0; dim < 3; ++dim)
+            vertices(dim, vertex) =
+                    data.nodeCoordinates[3 * vertexNodes[vertex] + dim];
+
+    if (verbose)
+        std::cout << "Read " << vertices.n_cols << " vertices, "
+                  << triangleCount << " triangles and "
+                  << boundaryId2PhysicalEntity.size()
+                  << " boundary segments from file '" << fileName << "' in "
+                  << (tbb::tick_count::now() - start).seconds() << " s"
+                  << std::endl;
+}
+
+} // namespace Bempp
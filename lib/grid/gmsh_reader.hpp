@@ -0,0 +1,70 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_gmsh_reader_hpp
+#define bempp_gmsh_reader_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <string>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \brief Read a triangular surface grid from a file in Gmsh format.
+ *
+ *  \param[in] fileName
+ *    Name of a file in the ASCII or binary variant of the Gmsh 2 format.
+ *  \param[out] vertices
+ *    On output, a 2D array of dimensions (3, \c m) whose (\c i, \c j)th
+ *    element is the \c i'th coordinate of \c j'th vertex.
+ *  \param[out] elementCorners
+ *    On output, a 2D array of dimensions (3, \c n) whose \c j'th column
+ *    contains the indices of the vertices of the \c j'th triangle.
+ *  \param[out] boundaryId2PhysicalEntity
+ *    On output, the physical entity of each line element (boundary segment),
+ *    in the order of the file.
+ *  \param[out] elementIndex2PhysicalEntity
+ *    On output, the physical entity of each triangle.
+ *  \param[in] verbose
+ *    If true, print statistics of the grid and the time taken to read it.
+ *
+ *  Only the vertices belonging to at least one triangle are returned. They
+ *  are numbered in the order in which they are first referenced by a
+ *  triangle, which is the order used by Dune::GmshReader. Point elements are
+ *  ignored; other element types are not supported.
+ *
+ *  The file is memory-mapped and the node and element sections are parsed
+ *  in parallel.
+ *
+ *  \note Binary files are only supported if their byte order matches that
+ *  of the host. */
+void readGmshTriangularGrid(const std::string& fileName,
+                            arma::Mat<double>& vertices,
+                            arma::Mat<int>& elementCorners,
+                            std::vector<int>& boundaryId2PhysicalEntity,
+                            std::vector<int>& elementIndex2PhysicalEntity,
+                            bool verbose = false);
+
+} // namespace Bempp
+
+#endif
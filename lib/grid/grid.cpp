@@ -20,43 +20,142 @@
 
 #include "grid.hpp"
 
-#include "entity.hpp"
-#include "entity_iterator.hpp"
-#include "geometry.hpp"
+#include "bounding_volume_hierarchy.hpp"
+#include "grid_connectivity.hpp"
 #include "grid_view.hpp"
-#include "ray_triangle_intersection.hpp"
 
 #include "../common/not_implemented_error.hpp"
 
+#include <stdexcept>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace Bempp
 {
 
-namespace {
+namespace
+{
 
-double min3(double x, double y, double z)
+template <typename CoordinateType>
+class AreInsideLoopBody
 {
-    return std::min(x, std::min(y, z));
-}
+public:
+    AreInsideLoopBody(const BoundingVolumeHierarchy& bvh,
+                      const arma::Mat<CoordinateType>& points,
+                      std::vector<char>& insideMask,
+                      std::vector<int>* nearestElements) :
+        m_bvh(bvh), m_points(points), m_insideMask(insideMask),
+        m_nearestElements(nearestElements) {
+    }
 
-double max3(double x, double y, double z)
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        std::vector<double> heights;
+        double point[3];
+        for (size_t pt = r.begin(); pt != r.end(); ++pt) {
+            for (int dim = 0; dim < 3; ++dim)
+                point[dim] = m_points(dim, pt);
+            // The point lies inside the grid if a ray starting from it
+            // intersects the grid an odd number of times
+            m_bvh.zRayIntersections(point, heights);
+            m_insideMask[pt] = heights.size() % 2;
+            if (m_nearestElements)
+                (*m_nearestElements)[pt] = m_bvh.nearestElement(point);
+        }
+    }
+
+private:
+    const BoundingVolumeHierarchy& m_bvh;
+    const arma::Mat<CoordinateType>& m_points;
+    std::vector<char>& m_insideMask;
+    std::vector<int>* m_nearestElements;
+};
+
+template <typename CoordinateType>
+void reallyAreInside(const Grid& grid,
+                     const arma::Mat<CoordinateType>& points,
+                     std::vector<char>& insideMask,
+                     std::vector<int>* nearestElements)
 {
-    return std::max(x, std::max(y, z));
+    if (grid.dim() != 2 || grid.dimWorld() != 3)
+        throw NotImplementedError("areInside(): currently implemented only for "
+                                  "2D grids embedded in 3D spaces");
+    if (points.n_rows != 3)
+        throw std::invalid_argument("areInside(): points must have three "
+                                    "coordinates");
+
+    const BoundingVolumeHierarchy& bvh = grid.boundingVolumeHierarchy();
+
+    const size_t pointCount = points.n_cols;
+    insideMask.resize(pointCount);
+    if (nearestElements)
+        nearestElements->resize(pointCount);
+
+    const size_t GRAIN_SIZE = 256;
+    typedef AreInsideLoopBody<CoordinateType> Body;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pointCount, GRAIN_SIZE),
+                      Body(bvh, points, insideMask, nearestElements));
 }
 
-bool isNew(const arma::Col<double>& intersection,
-           const std::vector<arma::Col<double> >& intersections)
+template <typename CoordinateType>
+std::vector<bool> reallyAreInside(const Grid& grid,
+                                  const arma::Mat<CoordinateType>& points)
 {
-    const double EPSILON = 1e-10;
-    for (size_t i = 0; i < intersections.size(); ++i)
-        if (fabs(intersections[i](0) - intersection(0)) < EPSILON &&
-                fabs(intersections[i](1) - intersection(1)) < EPSILON &&
-                fabs(intersections[i](2) - intersection(2)) < EPSILON)
-            return false;
-    return true;
+    std::vector<char> insideMask;
+    reallyAreInside(grid, points, insideMask, 0 /* nearestElements */);
+    return std::vector<bool>(insideMask.begin(), insideMask.end());
 }
 
 } // namespace
 
+Grid::BoundingVolumeHierarchyInitializer::BoundingVolumeHierarchyInitializer(
+        const Grid& grid) :
+    m_grid(grid)
+{
+}
+
+std::auto_ptr<const BoundingVolumeHierarchy>
+Grid::BoundingVolumeHierarchyInitializer::operator()() const
+{
+    if (m_grid.dim() != 2 || m_grid.dimWorld() != 3)
+        throw NotImplementedError("Grid::boundingVolumeHierarchy(): currently "
+                                  "implemented only for 2D grids embedded in "
+                                  "3D spaces");
+
+    std::auto_ptr<GridView> view = m_grid.leafView();
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    arma::Mat<char> auxData; // unused
+    view->getRawElementData(vertices, elementCorners, auxData);
+
+    return std::auto_ptr<const BoundingVolumeHierarchy>(
+                new BoundingVolumeHierarchy(vertices, elementCorners));
+}
+
+Grid::GridConnectivityInitializer::GridConnectivityInitializer(
+        const Grid& grid) :
+    m_grid(grid)
+{
+}
+
+std::auto_ptr<const GridConnectivity>
+Grid::GridConnectivityInitializer::operator()() const
+{
+    std::auto_ptr<GridView> view = m_grid.leafView();
+    return std::auto_ptr<const GridConnectivity>(
+                new GridConnectivity(*view, m_grid.dim()));
+}
+
+Grid::Grid() :
+    m_bvh(BoundingVolumeHierarchyInitializer(*this)),
+    m_leaf_connectivity(GridConnectivityInitializer(*this))
+{
+}
+
+Grid::~Grid()
+{
+}
+
 void Grid::getBoundingBox(arma::Col<double>& lowerBound,
                           arma::Col<double>& upperBound) const
 {
@@ -79,98 +178,74 @@ void Grid::getBoundingBox(arma::Col<double>& lowerBound,
     m_upperBound = upperBound = arma::max(vertices, 1); // 1 -> max. value in each row
 }
 
-std::vector<bool> areInside(const Grid& grid, const arma::Mat<double>& points)
+const BoundingVolumeHierarchy& Grid::boundingVolumeHierarchy() const
 {
-    if (grid.dim() != 2 || grid.dimWorld() != 3)
-        throw NotImplementedError("areInside(): currently implemented only for"
-                                  "2D grids embedded in 3D spaces");
+    return m_bvh.get();
+}
 
-    std::auto_ptr<GridView> view = grid.leafView();
-    std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
-
-    std::vector<arma::Mat<double> > triangles;
-    triangles.reserve(view->entityCount(0));
-
-    {
-        arma::Mat<double> triangle(grid.dimWorld(), 3);
-        arma::Mat<double> corners;
-        while (!it->finished()) {
-            const Entity<0>& element = it->entity();
-            element.geometry().getCorners(corners);
-            if (corners.n_cols == 3) // triangle
-                triangles.push_back(corners);
-            else if (corners.n_cols == 4) { // quadrilateral, split into 2 triangles
-                // NOTE: this won't work for concave quads,
-                triangle.col(0) = corners.col(0);
-                triangle.col(1) = corners.col(1);
-                triangle.col(2) = corners.col(2);
-                triangles.push_back(triangle);
-                triangle.col(0) = corners.col(2);
-                triangle.col(1) = corners.col(3);
-                triangle.col(2) = corners.col(0);
-                triangles.push_back(triangle);
-            } else
-                throw std::runtime_error("areInside(): unknown element type");
-            it->next();
-        }
+const GridConnectivity& Grid::leafConnectivity() const
+{
+    return m_leaf_connectivity.get();
+}
+
+void Grid::getOriginalElementIndices(std::vector<int>& indices) const
+{
+    if (m_original_element_indices.empty()) {
+        const int elementCount = leafView()->entityCount(0);
+        indices.resize(elementCount);
+        for (int e = 0; e < elementCount; ++e)
+            indices[e] = e;
     }
+    else
+        indices = m_original_element_indices;
+}
 
-    const size_t triangleCount = triangles.size();
-    arma::Row<double> xMins(triangleCount);
-    arma::Row<double> xMaxs(triangleCount);
-    arma::Row<double> yMins(triangleCount);
-    arma::Row<double> yMaxs(triangleCount);
-    arma::Row<double> zMins(triangleCount);
-    arma::Row<double> zMaxs(triangleCount);
-    for (size_t i = 0; i < triangleCount; ++i) {
-        const arma::Mat<double>& triangle = triangles[i];
-        xMins(i) = min3(triangle(0, 0), triangle(0, 1), triangle(0, 2));
-        xMaxs(i) = max3(triangle(0, 0), triangle(0, 1), triangle(0, 2));
-        yMins(i) = min3(triangle(1, 0), triangle(1, 1), triangle(1, 2));
-        yMaxs(i) = max3(triangle(1, 0), triangle(1, 1), triangle(1, 2));
-        zMins(i) = min3(triangle(2, 0), triangle(2, 1), triangle(2, 2));
-        zMaxs(i) = max3(triangle(2, 0), triangle(2, 1), triangle(2, 2));
+void Grid::getOriginalVertexIndices(std::vector<int>& indices) const
+{
+    if (m_original_vertex_indices.empty()) {
+        const int vertexCount = leafView()->entityCount(dim());
+        indices.resize(vertexCount);
+        for (int v = 0; v < vertexCount; ++v)
+            indices[v] = v;
     }
+    else
+        indices = m_original_vertex_indices;
+}
 
-    const double gridXMin = arma::min(xMins);
-    const double gridXMax = arma::max(xMaxs);
-    const double gridYMin = arma::min(yMins);
-    const double gridYMax = arma::max(yMaxs);
-    const double gridZMin = arma::min(zMins);
-    const double gridZMax = arma::max(zMaxs);
+void Grid::setOriginalIndices(const std::vector<int>& elementIndices,
+                              const std::vector<int>& vertexIndices)
+{
+    std::auto_ptr<GridView> view = leafView();
+    if (elementIndices.size() != view->entityCount(0) ||
+            vertexIndices.size() != view->entityCount(dim()))
+        throw std::invalid_argument("Grid::setOriginalIndices(): "
+                                    "incorrect number of indices");
+    m_original_element_indices = elementIndices;
+    m_original_vertex_indices = vertexIndices;
+}
 
-    const size_t pointCount = points.n_cols;
-    std::vector<bool> result(pointCount, false);
-    std::vector<arma::Col<double> > intersections;
-    arma::Col<double> intersection(3);
-    for (size_t pt = 0; pt < pointCount; ++pt) {
-        if (points(0, pt) < gridXMin || points(0, pt) > gridXMax ||
-                points(1, pt) < gridYMin || points(1, pt) > gridYMax ||
-                points(2, pt) < gridZMin || points(2, pt) > gridZMax)
-            continue; // point outside grid's bounding box
-        intersections.clear();
-        for (size_t tri = 0; tri < triangleCount; ++tri)
-            if (points(0, pt) >= xMins(tri) && points(0, pt) <= xMaxs(tri) &&
-                    points(1, pt) >= yMins(tri) && points(1, pt) <= yMaxs(tri))
-                if (zRayIntersectsTriangle(points.colptr(pt),
-                                           triangles[tri].colptr(0),
-                                           triangles[tri].colptr(1),
-                                           triangles[tri].colptr(2),
-                                           intersection.colptr(0)) > 0.)
-                    if (isNew(intersection, intersections))
-                        intersections.push_back(intersection);
-        result[pt] = intersections.size();
-    }
-    return result;
+std::vector<bool> areInside(const Grid& grid, const arma::Mat<double>& points)
+{
+    return reallyAreInside(grid, points);
 }
 
 std::vector<bool> areInside(const Grid& grid, const arma::Mat<float>& points)
 {
-    arma::Mat<double> pointsDouble(points.n_rows, points.n_cols);
-    for (int c = 0; c < points.n_cols; ++c)
-        for (int r = 0; r < points.n_rows; ++r)
-            pointsDouble(r, c) = points(r, c);
-    return areInside(grid, pointsDouble);
+    return reallyAreInside(grid, points);
+}
+
+void areInside(const Grid& grid, const arma::Mat<double>& points,
+               std::vector<char>& insideMask,
+               std::vector<int>* nearestElements)
+{
+    reallyAreInside(grid, points, insideMask, nearestElements);
+}
+
+void areInside(const Grid& grid, const arma::Mat<float>& points,
+               std::vector<char>& insideMask,
+               std::vector<int>* nearestElements)
+{
+    reallyAreInside(grid, points, insideMask, nearestElements);
 }
 
 } // namespace Bempp
@@ -24,6 +24,8 @@
 #include "../common/common.hpp"
 #include "grid_parameters.hpp"
 
+#include "../common/lazy.hpp"
+
 #include "../common/armadillo_fwd.hpp"
 #include <cstddef> // size_t
 #include <memory>
@@ -33,8 +35,10 @@ namespace Bempp
 {
 
 /** \cond FORWARD_DECL */
+class BoundingVolumeHierarchy;
 template<int codim> class Entity;
 class GeometryFactory;
+class GridConnectivity;
 class GridView;
 class IdSet;
 /** \endcond */
@@ -46,9 +50,11 @@ class IdSet;
 class Grid
 {
 public:
+    /** \brief Constructor */
+    Grid();
+
     /** \brief Destructor */
-    virtual ~Grid() {
-    }
+    virtual ~Grid();
 
     /** @name Grid parameters
     @{ */
@@ -97,11 +103,104 @@ public:
     /** \brief Reference to the grid's global id set. */
     virtual const IdSet& globalIdSet() const = 0;
 
+    /** @}
+    @name Domains
+    @{ */
+
+    /** \brief Get the domain indices of the elements of the grid.
+     *
+     *  On output, the \c i'th element of \p domainIndices is the index of the
+     *  domain (e.g. the Gmsh physical entity) to which the element with index
+     *  \c i in the leaf view belongs. All indices are zero if no domain
+     *  information was supplied when the grid was constructed. */
+    virtual void getDomainIndices(std::vector<int>& domainIndices) const = 0;
+
+    /** @}
+    @name Ordering
+    @{ */
+
+    /** \brief Get the original indices of the elements of the grid.
+     *
+     *  On output, the \c i'th element of \p indices is the index that the
+     *  element with index \c i in the leaf view had in the arrays or the file
+     *  from which the grid was created. The two indices differ only if the
+     *  elements were renumbered on construction (see
+     *  GridParameters::elementOrdering).
+     *
+     *  Use coefficientsInOriginalOrdering() and
+     *  gridFunctionFromOriginalOrdering() to convert the coefficients of
+     *  grid functions to and from the original numbering. */
+    void getOriginalElementIndices(std::vector<int>& indices) const;
+
+    /** \brief Get the original indices of the vertices of the grid.
+     *
+     *  On output, the \c i'th element of \p indices is the index that the
+     *  vertex with index \c i in the leaf view had in the arrays or the file
+     *  from which the grid was created. See getOriginalElementIndices() for
+     *  more information. */
+    void getOriginalVertexIndices(std::vector<int>& indices) const;
+
+    /** \brief Set the original indices of the elements and vertices of the
+     *  grid.
+     *
+     *  \note For internal use (called by GridFactory). */
+    void setOriginalIndices(const std::vector<int>& elementIndices,
+                            const std::vector<int>& vertexIndices);
+
+    /** @} */
+
     void getBoundingBox(arma::Col<double>& lowerBound,
                         arma::Col<double>& upperBound) const;
 
+    /** \brief Bounding volume hierarchy of the leaf elements of the grid.
+     *
+     *  The hierarchy is constructed on first use and stored in the grid.
+     *  This function can be called concurrently from several threads.
+     *
+     *  \note Currently implemented only for 2D grids embedded in 3D spaces. */
+    const BoundingVolumeHierarchy& boundingVolumeHierarchy() const;
+
+    /** \brief Connectivity of the leaf elements of the grid.
+     *
+     *  The connectivity arrays are extracted on first use and stored in the
+     *  grid, so that they are shared by all objects needing them (e.g. the
+     *  function spaces defined on the grid). This function can be called
+     *  concurrently from several threads.
+     *
+     *  \note Currently implemented only for 1D and 2D grids. */
+    const GridConnectivity& leafConnectivity() const;
+
+private:
+    /** \cond PRIVATE */
+    class BoundingVolumeHierarchyInitializer
+    {
+    public:
+        explicit BoundingVolumeHierarchyInitializer(const Grid& grid);
+        std::auto_ptr<const BoundingVolumeHierarchy> operator()() const;
+
+    private:
+        const Grid& m_grid;
+    };
+
+    class GridConnectivityInitializer
+    {
+    public:
+        explicit GridConnectivityInitializer(const Grid& grid);
+        std::auto_ptr<const GridConnectivity> operator()() const;
+
+    private:
+        const Grid& m_grid;
+    };
+    /** \endcond */
+
 private:
     mutable arma::Col<double> m_lowerBound, m_upperBound;
+    std::vector<int> m_original_element_indices;
+    std::vector<int> m_original_vertex_indices;
+    mutable Lazy<const BoundingVolumeHierarchy,
+                 BoundingVolumeHierarchyInitializer> m_bvh;
+    mutable Lazy<const GridConnectivity,
+                 GridConnectivityInitializer> m_leaf_connectivity;
 };
 
 /** \brief Check whether points are inside or outside a closed grid.
@@ -125,6 +224,31 @@ private:
 std::vector<bool> areInside(const Grid& grid, const arma::Mat<double>& points);
 std::vector<bool> areInside(const Grid& grid, const arma::Mat<float>& points);
 
+/** \brief Check whether points are inside or outside a closed grid and
+ *  optionally find the elements nearest to them.
+ *
+ *  \param[in] grid A grid representing a closed 2D surface embedded in a 3D
+ *    space.
+ *  \param[in] points A 2D array of dimensions (3, \c n) whose (\c i, \c j)th
+ *    element is the \c i'th coordinate of \c j'th point.
+ *  \param[out] insideMask On output, a vector of length \c n whose \c j'th
+ *    element is nonzero if the \c j'th point lies inside \c grid and zero
+ *    otherwise.
+ *  \param[out] nearestElements If not NULL, on output a vector of length \c n
+ *    whose \c j'th element is the index of the leaf element of \c grid
+ *    nearest to the \c j'th point.
+ *
+ *  The points are processed in parallel using the bounding volume hierarchy
+ *  returned by Grid::boundingVolumeHierarchy(). The notes in the
+ *  documentation of the other overloads of this function apply here as well.
+ */
+void areInside(const Grid& grid, const arma::Mat<double>& points,
+               std::vector<char>& insideMask,
+               std::vector<int>* nearestElements = 0);
+void areInside(const Grid& grid, const arma::Mat<float>& points,
+               std::vector<char>& insideMask,
+               std::vector<int>* nearestElements = 0);
+
 } // namespace Bempp
 
 #endif
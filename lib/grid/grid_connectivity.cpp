@@ -0,0 +1,49 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid_connectivity.hpp"
+
+#include "grid_view.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <stdexcept>
+
+namespace Bempp
+{
+
+GridConnectivity::GridConnectivity(const GridView& view, int gridDim) :
+    m_grid_dim(gridDim), m_vertex_count(0), m_edge_count(0)
+{
+    if (gridDim != 1 && gridDim != 2)
+        throw std::invalid_argument("GridConnectivity::GridConnectivity(): "
+                                    "only 1- and 2-dimensional grids are "
+                                    "supported");
+    arma::Mat<double> vertices; // unused
+    arma::Mat<char> auxData; // unused
+    view.getRawElementData(vertices, m_element_corners, auxData);
+    m_vertex_count = vertices.n_cols;
+    if (gridDim == 2) {
+        view.getRawElementEdgeData(m_element_edges);
+        m_edge_count = view.entityCount(1);
+    }
+}
+
+} // namespace Bempp
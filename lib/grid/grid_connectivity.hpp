@@ -0,0 +1,114 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_grid_connectivity_hpp
+#define bempp_grid_connectivity_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <cstddef> // size_t
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class GridView;
+/** \endcond */
+
+/** \brief Connectivity of the codim-0 entities of a grid view, stored in
+ *  flat arrays.
+ *
+ *  Elements are numbered as by the element mapper of the view, vertices and
+ *  edges as by its index set. The arrays are extracted from the grid view
+ *  in a single pass, so that code needing the connectivity of all elements
+ *  (e.g. DOF assignment in function spaces) does not have to walk the grid
+ *  through entity iterators and can process elements in parallel.
+ *
+ *  Use Grid::leafConnectivity() to obtain the connectivity of the leaf view
+ *  of a grid; it is built on first use and stored in the grid. */
+class GridConnectivity
+{
+public:
+    /** \brief Constructor.
+     *
+     *  \param[in] view     Grid view whose connectivity should be stored.
+     *  \param[in] gridDim  Dimension of the grid (1 or 2). */
+    GridConnectivity(const GridView& view, int gridDim);
+
+    /** \brief Dimension of the grid. */
+    int dim() const {
+        return m_grid_dim;
+    }
+
+    /** \brief Number of elements. */
+    size_t elementCount() const {
+        return m_element_corners.n_cols;
+    }
+
+    /** \brief Number of vertices. */
+    size_t vertexCount() const {
+        return m_vertex_count;
+    }
+
+    /** \brief Number of edges (zero for 1D grids). */
+    size_t edgeCount() const {
+        return m_edge_count;
+    }
+
+    /** \brief Array whose (\c i, \c j)th element is the index of the \c i'th
+     *  corner of the \c j'th element, or -1 if this element has less than
+     *  \c i+1 corners.
+     *
+     *  Laid out as the array returned by GridView::getRawElementData(). */
+    const arma::Mat<int>& elementCorners() const {
+        return m_element_corners;
+    }
+
+    /** \brief Array whose (\c i, \c j)th element is the index of the \c i'th
+     *  edge of the \c j'th element, or -1 if this element has less than
+     *  \c i+1 edges.
+     *
+     *  Laid out as the array returned by GridView::getRawElementEdgeData().
+     *  Empty for 1D grids. */
+    const arma::Mat<int>& elementEdges() const {
+        return m_element_edges;
+    }
+
+    /** \brief Number of corners of element \p element. */
+    int elementCornerCount(size_t element) const {
+        int count = 0;
+        while (count < (int)m_element_corners.n_rows &&
+               m_element_corners(count, element) >= 0)
+            ++count;
+        return count;
+    }
+
+private:
+    int m_grid_dim;
+    size_t m_vertex_count;
+    size_t m_edge_count;
+    arma::Mat<int> m_element_corners;
+    arma::Mat<int> m_element_edges;
+};
+
+} // namespace Bempp
+
+#endif
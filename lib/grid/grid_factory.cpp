@@ -21,8 +21,13 @@
 #include "grid_factory.hpp"
 #include "concrete_grid.hpp"
 #include "dune.hpp"
+#include "flat_triangle_grid.hpp"
+#include "gmsh_reader.hpp"
+#include "grid_view.hpp"
+#include "space_filling_curve.hpp"
 #include "structured_grid_factory.hpp"
 
+#include "../common/armadillo_fwd.hpp"
 #include <dune/grid/io/file/gmshreader.hh>
 #include <stdexcept>
 #include <string>
@@ -37,6 +42,72 @@ typedef ConcreteGrid<Default2dIn3dDuneGrid> Default2dIn3dGrid;
 typedef ConcreteGrid<Default3dIn3dDuneGrid> Default3dIn3dGrid;
 #endif
 
+namespace
+{
+
+// Construct a triangular Dune grid from arrays laid out as those returned by
+// GridView::getRawElementData()
+std::auto_ptr<Default2dIn3dDuneGrid> createTriangularDuneGrid(
+        const arma::Mat<double>& vertices,
+        const arma::Mat<int>& elementCorners)
+{
+    typedef Default2dIn3dDuneGrid::ctype ctype;
+    const int dimWorld = 3;
+    Dune::GridFactory<Default2dIn3dDuneGrid> factory;
+
+    Dune::FieldVector<ctype, dimWorld> vertex;
+    for (size_t v = 0; v < vertices.n_cols; ++v) {
+        for (int dim = 0; dim < dimWorld; ++dim)
+            vertex[dim] = vertices(dim, v);
+        factory.insertVertex(vertex);
+    }
+
+    const Dune::GeometryType type(Dune::GeometryType::simplex, 2);
+    std::vector<unsigned int> corners(3);
+    for (size_t e = 0; e < elementCorners.n_cols; ++e) {
+        for (int c = 0; c < 3; ++c)
+            corners[c] = elementCorners(c, e);
+        factory.insertElement(type, corners);
+    }
+
+    return std::auto_ptr<Default2dIn3dDuneGrid>(factory.createGrid());
+}
+
+typedef shared_ptr<Grid> (*ArrayGridCreator)(
+        const GridParameters& params,
+        const arma::Mat<double>& vertices,
+        const arma::Mat<int>& elementCorners,
+        const std::vector<int>& domainIndices);
+
+// Renumber the elements and vertices as requested by params.elementOrdering
+// and create a grid from the renumbered arrays with create(). Both grid
+// implementations number the leaf elements and vertices in the order in
+// which they are inserted, so the permutations can be stored directly.
+shared_ptr<Grid> createReorderedGrid(
+        ArrayGridCreator create,
+        const GridParameters& params,
+        const arma::Mat<double>& vertices,
+        const arma::Mat<int>& elementCorners,
+        const std::vector<int>& domainIndices)
+{
+    arma::Mat<double> newVertices(vertices);
+    arma::Mat<int> newElementCorners(elementCorners);
+    std::vector<int> newDomainIndices(domainIndices);
+    std::vector<int> originalElementIndices, originalVertexIndices;
+    reorderConnectivityArrays(params.elementOrdering,
+                              newVertices, newElementCorners, newDomainIndices,
+                              originalElementIndices, originalVertexIndices);
+
+    GridParameters originalParams(params);
+    originalParams.elementOrdering = GridParameters::ORIGINAL_ORDERING;
+    shared_ptr<Grid> grid = create(originalParams, newVertices,
+                                   newElementCorners, newDomainIndices);
+    grid->setOriginalIndices(originalElementIndices, originalVertexIndices);
+    return grid;
+}
+
+} // namespace
+
 shared_ptr<Grid> GridFactory::createStructuredGrid(
     const GridParameters& params, const arma::Col<double>& lowerLeft,
     const arma::Col<double>& upperRight, const arma::Col<unsigned int> &nElements)
@@ -73,35 +144,83 @@ shared_ptr<Grid> GridFactory::createStructuredGrid(
     // TODO: Support quadrilateral grids using createCubeGrid()
     apDuneGrid = Dune::BemppStructuredGridFactory<Default2dIn3dDuneGrid>::
                  createSimplexGrid(duneLowerLeft, duneUpperRight, duneNElements);
-    return shared_ptr<Grid>(new Default2dIn3dGrid(apDuneGrid.release(),
-                                                  GridParameters::TRIANGULAR,
-                                                  true)); // true -> owns Dune grid
+    shared_ptr<Grid> grid(new Default2dIn3dGrid(apDuneGrid.release(),
+                                                GridParameters::TRIANGULAR,
+                                                true)); // true -> owns Dune grid
+    if (params.elementOrdering == GridParameters::ORIGINAL_ORDERING)
+        return grid;
+
+    // Renumber the structured grid
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    arma::Mat<char> auxData; // unused
+    grid->leafView()->getRawElementData(vertices, elementCorners, auxData);
+    return createGridFromConnectivityArrays(params, vertices,
+                                            elementCorners.rows(0, 2));
+}
+
+shared_ptr<Grid> GridFactory::createGridFromConnectivityArrays(
+    const GridParameters& params, const arma::Mat<double>& vertices,
+    const arma::Mat<int>& elementCorners,
+    const std::vector<int>& domainIndices)
+{
+    // Check arguments
+    if (params.topology != GridParameters::TRIANGULAR)
+        throw std::invalid_argument("GridFactory::createGridFromConnectivityArrays(): "
+                                    "unsupported grid topology");
+    if (vertices.n_rows != 3)
+        throw std::invalid_argument("GridFactory::createGridFromConnectivityArrays(): "
+                                    "vertices must have three coordinates");
+    if (elementCorners.n_rows != 3)
+        throw std::invalid_argument("GridFactory::createGridFromConnectivityArrays(): "
+                                    "elementCorners must have three rows");
+    if (!domainIndices.empty() && domainIndices.size() != elementCorners.n_cols)
+        throw std::invalid_argument("GridFactory::createGridFromConnectivityArrays(): "
+                                    "domainIndices must be empty or have as "
+                                    "many elements as elementCorners has columns");
+    const int vertexCount = vertices.n_cols;
+    for (size_t i = 0; i < elementCorners.n_elem; ++i)
+        if (elementCorners[i] < 0 || elementCorners[i] >= vertexCount)
+            throw std::invalid_argument("GridFactory::createGridFromConnectivityArrays(): "
+                                        "invalid vertex index in elementCorners");
+    if (params.elementOrdering != GridParameters::ORIGINAL_ORDERING)
+        return createReorderedGrid(&createGridFromConnectivityArrays, params,
+                                   vertices, elementCorners, domainIndices);
+
+    std::auto_ptr<Default2dIn3dDuneGrid> duneGrid =
+            createTriangularDuneGrid(vertices, elementCorners);
+    return shared_ptr<Grid>(new Default2dIn3dGrid(duneGrid.release(),
+                                                  params.topology,
+                                                  true, // true -> owns Dune grid
+                                                  domainIndices));
+}
+
+shared_ptr<Grid> GridFactory::createFlatGridFromConnectivityArrays(
+    const GridParameters& params, const arma::Mat<double>& vertices,
+    const arma::Mat<int>& elementCorners,
+    const std::vector<int>& domainIndices)
+{
+    if (params.topology != GridParameters::TRIANGULAR)
+        throw std::invalid_argument("GridFactory::createFlatGridFromConnectivityArrays(): "
+                                    "unsupported grid topology");
+    if (params.elementOrdering != GridParameters::ORIGINAL_ORDERING)
+        return createReorderedGrid(&createFlatGridFromConnectivityArrays,
+                                   params, vertices, elementCorners,
+                                   domainIndices);
+    // The remaining arguments are checked by the FlatTriangleGrid constructor
+    return shared_ptr<Grid>(new FlatTriangleGrid(vertices, elementCorners,
+                                                 domainIndices));
 }
 
 shared_ptr<Grid> GridFactory::importGmshGrid(
     const GridParameters& params, const std::string& fileName,
     bool verbose, bool insertBoundarySegments)
 {
-    // Check arguments
-    if (params.topology == GridParameters::TRIANGULAR)
-    {
-        Default2dIn3dDuneGrid* duneGrid = Dune::GmshReader<Default2dIn3dDuneGrid>
-                ::read(fileName, verbose, insertBoundarySegments);
-        return shared_ptr<Grid>(new Default2dIn3dGrid(duneGrid, params.topology,
-                                                      true)); // true -> owns Dune grid
-    }
-#ifdef WITH_ALUGRID
-    else if (params.topology == GridParameters::TETRAHEDRAL)
-    {
-        Default3dIn3dDuneGrid* duneGrid = Dune::GmshReader<Default3dIn3dDuneGrid>
-                ::read(fileName, verbose, insertBoundarySegments);
-        return shared_ptr<Grid>(new Default3dIn3dGrid(duneGrid, params.topology,
-                                                      true));
-    }
-#endif
-    else
-        throw std::invalid_argument("GridFactory::importGmshGrid(): "
-                                    "unsupported grid topology");
+    std::vector<int> boundaryId2PhysicalEntity;
+    std::vector<int> elementIndex2PhysicalEntity;
+    return importGmshGrid(params, fileName,
+                          boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
+                          verbose, insertBoundarySegments);
 }
 
 shared_ptr<Grid> GridFactory::importGmshGrid(
@@ -111,14 +230,36 @@ shared_ptr<Grid> GridFactory::importGmshGrid(
     bool verbose, bool insertBoundarySegments)
 {
     // Check arguments
-    if (params.topology == GridParameters::TRIANGULAR)
+    if (params.topology == GridParameters::TRIANGULAR &&
+            !insertBoundarySegments)
+    {
+        // Native reader; boundary segments are only handled by Dune
+        arma::Mat<double> vertices;
+        arma::Mat<int> elementCorners;
+        readGmshTriangularGrid(fileName, vertices, elementCorners,
+                               boundaryId2PhysicalEntity,
+                               elementIndex2PhysicalEntity, verbose);
+        shared_ptr<Grid> grid = createGridFromConnectivityArrays(
+                    params, vertices, elementCorners,
+                    elementIndex2PhysicalEntity);
+        if (params.elementOrdering != GridParameters::ORIGINAL_ORDERING)
+            grid->getDomainIndices(elementIndex2PhysicalEntity);
+        return grid;
+    }
+    else if (params.elementOrdering != GridParameters::ORIGINAL_ORDERING)
+        throw std::invalid_argument("GridFactory::importGmshGrid(): "
+                                    "elements can be renumbered only in "
+                                    "triangular grids imported without "
+                                    "boundary segments");
+    else if (params.topology == GridParameters::TRIANGULAR)
     {
         Default2dIn3dDuneGrid* duneGrid = Dune::GmshReader<Default2dIn3dDuneGrid>
                 ::read(fileName,
                        boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
                        verbose, insertBoundarySegments);
         return shared_ptr<Grid>(new Default2dIn3dGrid(duneGrid, params.topology,
-                                                         true)); // true -> owns Dune grid
+                                                      true, // true -> owns Dune grid
+                                                      elementIndex2PhysicalEntity));
     }
 #ifdef WITH_ALUGRID
     else if (params.topology == GridParameters::TETRAHEDRAL)
@@ -128,7 +269,8 @@ shared_ptr<Grid> GridFactory::importGmshGrid(
                        boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
                        verbose, insertBoundarySegments);
         return shared_ptr<Grid>(new Default3dIn3dGrid(duneGrid, params.topology,
-                                                      true)); // true -> owns Dune grid
+                                                      true, // true -> owns Dune grid
+                                                      elementIndex2PhysicalEntity));
     }
 #endif
     else
@@ -27,6 +27,8 @@
 
 #include "../common/armadillo_fwd.hpp"
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace Bempp
 {
@@ -72,6 +74,51 @@ public:
             const arma::Col<double>& upperRight,
             const arma::Col<unsigned int>& nElements);
 
+    /** \brief Construct a grid from arrays of vertices and elements.
+
+      \param params Parameters of the grid to be constructed.
+      \param vertices
+        2D array of dimensions (3, \c m) whose (\c i, \c j)th element is the
+        \c i'th coordinate of \c j'th vertex.
+      \param elementCorners
+        2D array of dimensions (3, \c n) whose \c j'th column contains the
+        indices of the vertices of the \c j'th element.
+      \param domainIndices
+        Either an empty vector or a vector of length \c n whose \c j'th
+        element is the index of the domain to which the \c j'th element
+        belongs (see Grid::getDomainIndices()).
+
+      The arrays are laid out as those returned by GridView::getRawElementData()
+      and are inserted directly into the underlying grid, so that meshes held
+      in memory do not need to be written to a file to be loaded. Elements are
+      numbered in the order of the columns of \p elementCorners.
+
+      \note Currently only grids with triangular topology are supported.
+    */
+    static shared_ptr<Grid> createGridFromConnectivityArrays(
+            const GridParameters& params,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const std::vector<int>& domainIndices = std::vector<int>());
+
+    /** \brief Construct a grid not based on Dune from arrays of vertices
+      and elements.
+
+      The parameters have the same meaning as in
+      createGridFromConnectivityArrays(). The returned grid is a
+      FlatTriangleGrid, which stores the connectivity of the mesh in flat
+      arrays instead of wrapping a Dune grid. This makes iteration over
+      entities and extraction of raw element data considerably cheaper; on
+      the other hand, such a grid has a single level and cannot be refined.
+
+      \note Currently only grids with triangular topology are supported.
+    */
+    static shared_ptr<Grid> createFlatGridFromConnectivityArrays(
+            const GridParameters& params,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const std::vector<int>& domainIndices = std::vector<int>());
+
     /** \brief Import grid from a file in Gmsh format.
 
       \param params Parameters of the grid to be constructed.
@@ -79,6 +126,14 @@ public:
       \param verbose  Output diagnostic information.
       \param insertBoundarySegments
 
+      Triangular grids are read with readGmshTriangularGrid(), which supports
+      both the ASCII and the binary variant of version 2 of the Gmsh format,
+      unless \p insertBoundarySegments is set. Otherwise Dune::GmshReader is
+      used.
+
+      The physical entities of the elements are used as their domain indices
+      (see Grid::getDomainIndices()).
+
       \bug Ask Dune developers about the significance of insertBoundarySegments.
       \see <a href>http://geuz.org/gmsh/</a> for information about the Gmsh file format.
       \see Dune::GmshReader documentation for information about the supported Gmsh features.
@@ -96,6 +151,9 @@ public:
       \param verbose  Output diagnostic information.
       \param insertBoundarySegments
 
+      See the documentation of the other overload for the choice of the
+      reader.
+
       \bug Ask Dune developers about the significance of the undocumented parameters.
       \see <a href>http://geuz.org/gmsh/</a> for information about the Gmsh file format.
       \see Dune::GmshReader documentation for information about the supported Gmsh features.
@@ -28,6 +28,13 @@ namespace Bempp {
   This structure is used to specify parameters of grid constructed by GridFactory.
   */
 struct GridParameters {
+    /** \brief Constructor.
+
+      Sets elementOrdering to ORIGINAL_ORDERING; the topology must be set
+      explicitly. */
+    GridParameters() : elementOrdering(ORIGINAL_ORDERING) {
+    }
+
     /** \brief %Grid topology */
     enum Topology {
         /** \brief one-dimensional grid embedded in a two-dimensional space */
@@ -46,6 +53,29 @@ struct GridParameters {
             embedded in a three-dimensional space*/
         TETRAHEDRAL
     } topology;
+
+    /** \brief Numbering of the elements and vertices of the grid.
+
+      Renumbering the elements along a space-filling curve makes elements
+      with close indices lie close to each other, which improves the
+      locality of memory accesses during assembly. The original indices are
+      available from Grid::getOriginalElementIndices() and
+      Grid::getOriginalVertexIndices().
+
+      Currently only triangular grids can be renumbered. */
+    enum ElementOrdering {
+        /** \brief elements and vertices are numbered as in the arrays or
+            file from which the grid is created */
+        ORIGINAL_ORDERING,
+        /** \brief elements are numbered in the order in which their
+            centroids are visited by the Morton (Z-order) curve; vertices
+            are numbered in the order in which they are first reached when
+            the elements are traversed in this order */
+        MORTON_ORDERING,
+        /** \brief as MORTON_ORDERING, but using the Hilbert curve, which
+            yields slightly better locality at a slightly higher cost */
+        HILBERT_ORDERING
+    } elementOrdering;
 };
 
 } // namespace Bempp
@@ -0,0 +1,225 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid_refinement.hpp"
+
+#include "flat_triangle_grid.hpp"
+#include "grid.hpp"
+#include "grid_connectivity.hpp"
+#include "grid_factory.hpp"
+#include "grid_view.hpp"
+
+#include "../common/not_implemented_error.hpp"
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Vertices of the edges of the reference triangle (Dune numbering)
+const int EDGE_CORNERS[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+// The same edges traversed in the direction of the element's orientation,
+// followed by the opposite vertex
+const int ORIENTED_EDGE_CORNERS[3][3] = {{0, 1, 2}, {2, 0, 1}, {1, 2, 0}};
+
+void checkGrid(const Grid& grid)
+{
+    if (grid.dim() != 2 || grid.dimWorld() != 3)
+        throw NotImplementedError("GridRefinement::GridRefinement(): "
+                                  "currently implemented only for 2D grids "
+                                  "embedded in 3D spaces");
+    const GridConnectivity& connectivity = grid.leafConnectivity();
+    for (size_t e = 0; e < connectivity.elementCount(); ++e)
+        if (connectivity.elementCornerCount(e) != 3)
+            throw NotImplementedError("GridRefinement::GridRefinement(): "
+                                      "only triangular elements are supported");
+}
+
+} // namespace
+
+GridRefinement::GridRefinement(const shared_ptr<const Grid>& coarseGrid) :
+    m_coarse_grid(coarseGrid)
+{
+    if (!coarseGrid)
+        throw std::invalid_argument("GridRefinement::GridRefinement(): "
+                                    "coarseGrid must not be null");
+    checkGrid(*coarseGrid);
+    std::vector<char> edgeMarks(coarseGrid->leafConnectivity().edgeCount(), 1);
+    refine(edgeMarks);
+}
+
+GridRefinement::GridRefinement(const shared_ptr<const Grid>& coarseGrid,
+                               const std::vector<bool>& marks) :
+    m_coarse_grid(coarseGrid)
+{
+    if (!coarseGrid)
+        throw std::invalid_argument("GridRefinement::GridRefinement(): "
+                                    "coarseGrid must not be null");
+    checkGrid(*coarseGrid);
+    const GridConnectivity& connectivity = coarseGrid->leafConnectivity();
+    const size_t elementCount = connectivity.elementCount();
+    if (marks.size() != elementCount)
+        throw std::invalid_argument("GridRefinement::GridRefinement(): "
+                                    "marks must have as many elements as "
+                                    "the grid");
+    const arma::Mat<int>& elementEdges = connectivity.elementEdges();
+
+    std::vector<char> edgeMarks(connectivity.edgeCount(), 0);
+    for (size_t e = 0; e < elementCount; ++e)
+        if (marks[e])
+            for (int l = 0; l < 3; ++l)
+                edgeMarks[elementEdges(l, e)] = 1;
+
+    // Refine red all elements with more than one refined edge; repeat until
+    // all remaining elements have at most one refined edge
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t e = 0; e < elementCount; ++e) {
+            int markedEdgeCount = 0;
+            for (int l = 0; l < 3; ++l)
+                markedEdgeCount += edgeMarks[elementEdges(l, e)];
+            if (markedEdgeCount == 2) {
+                for (int l = 0; l < 3; ++l)
+                    edgeMarks[elementEdges(l, e)] = 1;
+                changed = true;
+            }
+        }
+    }
+    refine(edgeMarks);
+}
+
+void GridRefinement::refine(const std::vector<char>& edgeMarks)
+{
+    const GridConnectivity& connectivity = m_coarse_grid->leafConnectivity();
+    const arma::Mat<int>& elementCorners = connectivity.elementCorners();
+    const arma::Mat<int>& elementEdges = connectivity.elementEdges();
+    const size_t elementCount = connectivity.elementCount();
+    const size_t coarseVertexCount = connectivity.vertexCount();
+    const size_t edgeCount = connectivity.edgeCount();
+
+    arma::Mat<double> coarseVertices;
+    arma::Mat<int> coarseElementCorners; // unused
+    arma::Mat<char> auxData; // unused
+    m_coarse_grid->leafView()->getRawElementData(
+                coarseVertices, coarseElementCorners, auxData);
+    std::vector<int> coarseDomainIndices;
+    m_coarse_grid->getDomainIndices(coarseDomainIndices);
+
+    // Number the midpoints of refined edges
+    std::vector<int> midpoints(edgeCount, -1);
+    size_t fineVertexCount = coarseVertexCount;
+    for (size_t edge = 0; edge < edgeCount; ++edge)
+        if (edgeMarks[edge])
+            midpoints[edge] = fineVertexCount++;
+
+    arma::Mat<double> vertices(3, fineVertexCount);
+    m_vertex_parents.set_size(2, fineVertexCount);
+    for (size_t v = 0; v < coarseVertexCount; ++v) {
+        for (int dim = 0; dim < 3; ++dim)
+            vertices(dim, v) = coarseVertices(dim, v);
+        m_vertex_parents(0, v) = m_vertex_parents(1, v) = v;
+    }
+    for (size_t e = 0; e < elementCount; ++e)
+        for (int l = 0; l < 3; ++l) {
+            const int midpoint = midpoints[elementEdges(l, e)];
+            if (midpoint < 0)
+                continue;
+            const int v0 = elementCorners(EDGE_CORNERS[l][0], e);
+            const int v1 = elementCorners(EDGE_CORNERS[l][1], e);
+            for (int dim = 0; dim < 3; ++dim)
+                vertices(dim, midpoint) =
+                        0.5 * (coarseVertices(dim, v0) +
+                               coarseVertices(dim, v1));
+            m_vertex_parents(0, midpoint) = v0;
+            m_vertex_parents(1, midpoint) = v1;
+        }
+
+    // Count the children
+    size_t fineElementCount = 0;
+    for (size_t e = 0; e < elementCount; ++e) {
+        int markedEdgeCount = 0;
+        for (int l = 0; l < 3; ++l)
+            markedEdgeCount += edgeMarks[elementEdges(l, e)];
+        fineElementCount += markedEdgeCount == 0 ? 1 :
+                            markedEdgeCount == 1 ? 2 : 4;
+    }
+
+    arma::Mat<int> corners(3, fineElementCount);
+    std::vector<int> domainIndices(fineElementCount);
+    m_element_parents.resize(fineElementCount);
+    size_t child = 0;
+    for (size_t e = 0; e < elementCount; ++e) {
+        const int c[3] = {elementCorners(0, e), elementCorners(1, e),
+                          elementCorners(2, e)};
+        // Midpoints of the edges (-1 for unrefined edges)
+        const int m[3] = {midpoints[elementEdges(0, e)],
+                          midpoints[elementEdges(1, e)],
+                          midpoints[elementEdges(2, e)]};
+        const int markedEdgeCount = (m[0] >= 0) + (m[1] >= 0) + (m[2] >= 0);
+        const size_t firstChild = child;
+        if (markedEdgeCount == 0) {
+            for (int i = 0; i < 3; ++i)
+                corners(i, child) = c[i];
+            ++child;
+        } else if (markedEdgeCount == 1) {
+            // Green refinement: bisect the element
+            int l = 0;
+            while (m[l] < 0)
+                ++l;
+            const int p = c[ORIENTED_EDGE_CORNERS[l][0]];
+            const int q = c[ORIENTED_EDGE_CORNERS[l][1]];
+            const int r = c[ORIENTED_EDGE_CORNERS[l][2]];
+            corners(0, child) = p;
+            corners(1, child) = m[l];
+            corners(2, child) = r;
+            ++child;
+            corners(0, child) = m[l];
+            corners(1, child) = q;
+            corners(2, child) = r;
+            ++child;
+        } else {
+            // Red refinement: split the element into four
+            const int children[4][3] = {
+                {c[0], m[0], m[1]}, {m[0], c[1], m[2]},
+                {m[1], m[2], c[2]}, {m[0], m[2], m[1]}};
+            for (int k = 0; k < 4; ++k, ++child)
+                for (int i = 0; i < 3; ++i)
+                    corners(i, child) = children[k][i];
+        }
+        for (size_t f = firstChild; f < child; ++f) {
+            m_element_parents[f] = e;
+            domainIndices[f] = coarseDomainIndices[e];
+        }
+    }
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    if (dynamic_cast<const FlatTriangleGrid*>(m_coarse_grid.get()))
+        m_fine_grid = GridFactory::createFlatGridFromConnectivityArrays(
+                    params, vertices, corners, domainIndices);
+    else
+        m_fine_grid = GridFactory::createGridFromConnectivityArrays(
+                    params, vertices, corners, domainIndices);
+}
+
+} // namespace Bempp
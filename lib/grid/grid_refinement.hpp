@@ -0,0 +1,195 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_grid_refinement_hpp
+#define bempp_grid_refinement_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/shared_ptr.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <stdexcept>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class Grid;
+/** \endcond */
+
+/** \brief Refinement of a triangular surface grid.
+
+  An object of this class constructs a new (fine) grid by refining the leaf
+  elements of an existing (coarse) grid and stores the relations between the
+  entities of the two grids. The coarse grid is left unchanged, so that
+  objects defined on it (e.g. function spaces or grid functions) stay valid.
+
+  Elements are refined by the red-green scheme. A red-refined element is
+  split into four similar triangles by joining the midpoints of its edges; a
+  green-refined element is bisected by joining the midpoint of one of its
+  edges with the opposite vertex. Green refinement is used only to remove the
+  hanging nodes created by red refinement of neighbouring elements, hence the
+  fine grid is conforming. Elements with two refined edges are refined red as
+  well. New vertices are placed at the midpoints of the edges of the coarse
+  grid, i.e. no attempt is made to reconstruct a curved surface.
+
+  The fine grid is a FlatTriangleGrid if the coarse grid is one, and a grid
+  created by GridFactory::createGridFromConnectivityArrays() otherwise. Its
+  vertices are numbered as follows: first come the vertices of the coarse
+  grid, in their original order, then the midpoints of the refined edges, in
+  the order of increasing edge index. The children of each coarse element
+  have consecutive indices and are ordered as their parents. The children
+  inherit the domain index (see Grid::getDomainIndices()) and the
+  orientation of their parent.
+
+  The fine grid carries no record of how it was created. In particular, when
+  it is itself refined by another GridRefinement, the children of
+  green-refined elements are treated as ordinary elements and bisected or
+  split again rather than being replaced by a red refinement of their parent.
+  Each green bisection halves one angle of the element, so repeated adaptive
+  refinement of the same region may degrade the shape of the elements. If
+  this matters, refine the original grid with the union of the marks
+  (propagated to it with elementParents()) instead of refining the fine grid.
+
+  \note Only 2D grids composed of triangles and embedded in 3D spaces are
+  supported. */
+class GridRefinement
+{
+public:
+    /** \brief Refine all elements of \p coarseGrid uniformly (red refinement).
+
+      Each element is split into four children. */
+    explicit GridRefinement(const shared_ptr<const Grid>& coarseGrid);
+
+    /** \brief Refine the marked elements of \p coarseGrid.
+
+      \param[in] coarseGrid Grid to refine.
+      \param[in] marks      Vector whose \c i'th element determines whether
+                            the element with index \c i in the leaf view of
+                            \p coarseGrid should be refined red.
+
+      Additional elements are refined as needed to keep the fine grid
+      conforming (see the class description). */
+    GridRefinement(const shared_ptr<const Grid>& coarseGrid,
+                   const std::vector<bool>& marks);
+
+    /** \brief The grid that was refined. */
+    shared_ptr<const Grid> coarseGrid() const {
+        return m_coarse_grid;
+    }
+
+    /** \brief The grid obtained by refinement. */
+    shared_ptr<Grid> fineGrid() const {
+        return m_fine_grid;
+    }
+
+    /** \brief Vector whose \c i'th element is the index of the parent (in the
+     *  coarse grid) of the element with index \c i in the fine grid. */
+    const std::vector<int>& elementParents() const {
+        return m_element_parents;
+    }
+
+    /** \brief Array of dimensions (2, \c n), where \c n is the number of
+     *  vertices of the fine grid, whose \c j'th column contains the indices of
+     *  the endpoints of the coarse edge at whose midpoint the \c j'th fine
+     *  vertex lies.
+     *
+     *  Both indices are equal to \c j for vertices of the coarse grid. */
+    const arma::Mat<int>& vertexParents() const {
+        return m_vertex_parents;
+    }
+
+    /** \brief Transfer data attached to the elements of the coarse grid to
+     *  the elements of the fine grid.
+     *
+     *  \param[in]  coarseData %Vector whose \c i'th element is attached to
+     *                         the \c i'th coarse element.
+     *  \param[out] fineData   %Vector whose \c i'th element is set to the
+     *                         value attached to the parent of the \c i'th
+     *                         fine element.
+     *
+     *  This is the exact prolongation of piecewise constant functions. */
+    template <typename ValueType>
+    void prolongElementData(const arma::Col<ValueType>& coarseData,
+                            arma::Col<ValueType>& fineData) const;
+
+    /** \brief Transfer data attached to the vertices of the coarse grid to
+     *  the vertices of the fine grid by linear interpolation.
+     *
+     *  \param[in]  coarseData %Vector whose \c i'th element is attached to
+     *                         the \c i'th coarse vertex.
+     *  \param[out] fineData   %Vector whose \c j'th element is set to the
+     *                         mean of the values attached to the two
+     *                         vertices stored in the \c j'th column of
+     *                         vertexParents().
+     *
+     *  This is the exact prolongation of continuous piecewise linear
+     *  functions. */
+    template <typename ValueType>
+    void prolongVertexData(const arma::Col<ValueType>& coarseData,
+                           arma::Col<ValueType>& fineData) const;
+
+private:
+    void refine(const std::vector<char>& edgeMarks);
+
+private:
+    shared_ptr<const Grid> m_coarse_grid;
+    shared_ptr<Grid> m_fine_grid;
+    std::vector<int> m_element_parents;
+    arma::Mat<int> m_vertex_parents;
+};
+
+template <typename ValueType>
+void GridRefinement::prolongElementData(const arma::Col<ValueType>& coarseData,
+                                        arma::Col<ValueType>& fineData) const
+{
+    const size_t fineElementCount = m_element_parents.size();
+    fineData.set_size(fineElementCount);
+    for (size_t e = 0; e < fineElementCount; ++e) {
+        const size_t parent = m_element_parents[e];
+        if (parent >= coarseData.n_rows)
+            throw std::invalid_argument("GridRefinement::prolongElementData(): "
+                                        "coarseData is too short");
+        fineData(e) = coarseData(parent);
+    }
+}
+
+template <typename ValueType>
+void GridRefinement::prolongVertexData(const arma::Col<ValueType>& coarseData,
+                                       arma::Col<ValueType>& fineData) const
+{
+    const size_t fineVertexCount = m_vertex_parents.n_cols;
+    fineData.set_size(fineVertexCount);
+    for (size_t v = 0; v < fineVertexCount; ++v) {
+        const size_t parent0 = m_vertex_parents(0, v);
+        const size_t parent1 = m_vertex_parents(1, v);
+        if (parent0 >= coarseData.n_rows || parent1 >= coarseData.n_rows)
+            throw std::invalid_argument("GridRefinement::prolongVertexData(): "
+                                        "coarseData is too short");
+        fineData(v) = (coarseData(parent0) + coarseData(parent1)) /
+                ValueType(2.);
+    }
+}
+
+} // namespace Bempp
+
+#endif
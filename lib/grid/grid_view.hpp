@@ -120,6 +120,20 @@ public:
                            arma::Mat<int>& elementCorners,
                            arma::Mat<char>& auxData) const;
 
+    /** \brief Get the indices of the edges of all codim-0 entities contained
+      in this grid view.
+
+      Available only for views of 2D grids.
+
+      \param[out] elementEdges
+        On output, a 2D array whose (i,j)th element is the index (in the
+        sense of indexSet()) of the ith edge of the jth codim-0 entity, or -1
+        if this entity has less than i-1 edges. Edges are numbered locally
+        as in Dune's reference elements, and codim-0 entities as in
+        getRawElementData().
+      */
+    void getRawElementEdgeData(arma::Mat<int>& elementEdges) const;
+
     /** \brief Mapping from codim-0 entity index to entity pointer.
 
       Note that this object is *not* updated when the grid is adapted. In that
@@ -134,6 +148,11 @@ public:
 
     /** \brief Create a VtkWriter for this grid view.
 
+      In the conforming mode, views of grids composed of elements of a single
+      type get a VtuWriter, which supports compressed output
+      (VtkWriter::APPENDED_RAW_COMPRESSED) and writes files in parallel
+      blocks. Otherwise a wrapper of Dune's VTK writer is returned.
+
       \param dm Data mode (conforming or nonconforming; see the documentation of Dune::VTK::DataMode for details). */
     virtual std::auto_ptr<VtkWriter> vtkWriter(Dune::VTK::DataMode dm=Dune::VTK::conforming) const = 0;
 
@@ -149,6 +168,8 @@ private:
             arma::Mat<float>& vertices,
             arma::Mat<int>& elementCorners,
             arma::Mat<char>& auxData) const = 0;
+    virtual void getRawElementEdgeDataImpl(
+            arma::Mat<int>& elementEdges) const = 0;
 
     /** \brief Iterator over entities of codimension 0 contained in this view. */
     virtual std::auto_ptr<EntityIterator<0> > entityCodim0Iterator() const = 0;
@@ -174,6 +195,11 @@ inline void GridView::getRawElementData(arma::Mat<float>& vertices,
     getRawElementDataFloatImpl(vertices, elementCorners, auxData);
 }
 
+inline void GridView::getRawElementEdgeData(arma::Mat<int>& elementEdges) const
+{
+    getRawElementEdgeDataImpl(elementEdges);
+}
+
 template<>
 inline std::auto_ptr<EntityIterator<0> > GridView::entityIterator<0>() const
 {
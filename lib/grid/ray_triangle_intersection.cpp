@@ -48,17 +48,17 @@ inline double innerProduct(const double* v1, const double* v2)
 
 } // namespace
 
-// Tests if the ray (p[0], p[1], p[2]) + alpha (0, 0, 1) (alpha >= 0)
+// Tests if the ray (p[0], p[1], p[2]) + alpha (d[0], d[1], d[2]) (alpha >= 0)
 // intersects the triangle with vertices v0, v1 and v2. Returns 0 if
 // it doesn't intersect, 1./6. if it intersects a vertex, 0.5 if it
 // intersects an edge, and 1 if it passes through the interior of the
 // triangle. If there is an intersection, its position is stored in the
 // argument 'intersection'.
-double zRayIntersectsTriangle(
-        const double *p, const double *v0, const double *v1, const double *v2,
+double rayIntersectsTriangle(
+        const double *p, const double *d,
+        const double *v0, const double *v1, const double *v2,
         double* intersection)
 {
-    double d[3] = {0., 0., 1.}; // ray directions
     double e1[3],e2[3],h[3],s[3],q[3];
     double a,f,t,u,v;
     substract(e1,v1,v0);
@@ -93,7 +93,7 @@ double zRayIntersectsTriangle(
         return 0.;
     else { // ray intersection
         for (int i = 0; i < 3; ++i)
-            intersection[i] = v1[i] + u * e1[i] + v * e2[i];
+            intersection[i] = v0[i] + u * e1[i] + v * e2[i];
 
         if ((u == 0. && v == 0.) || (u == 0. && v == 1.) || (u == 1. && v == 0.))
             // vertex
@@ -107,4 +107,13 @@ double zRayIntersectsTriangle(
     }
 }
 
+// Special case of rayIntersectsTriangle() for rays parallel to the z axis.
+double zRayIntersectsTriangle(
+        const double *p, const double *v0, const double *v1, const double *v2,
+        double* intersection)
+{
+    const double d[3] = {0., 0., 1.}; // ray direction
+    return rayIntersectsTriangle(p, d, v0, v1, v2, intersection);
+}
+
 } // namespace Bempp
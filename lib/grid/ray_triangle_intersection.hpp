@@ -26,6 +26,11 @@
 namespace Bempp
 {
 
+double rayIntersectsTriangle(
+        const double *p, const double *d,
+        const double *v0, const double *v1, const double *v2,
+        double* intersection);
+
 double zRayIntersectsTriangle(
         const double *p, const double *v0, const double *v1, const double *v2,
         double* intersection);
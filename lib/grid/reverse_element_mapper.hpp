@@ -36,6 +36,7 @@ class GridView;
 class ReverseElementMapper
 {
     template <typename DuneGridView> friend class ConcreteGridView;
+    friend class FlatTriangleGridView;
 
 private:
     const GridView& m_view;
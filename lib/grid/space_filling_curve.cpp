@@ -0,0 +1,251 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "space_filling_curve.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <stdexcept>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <utility>
+
+namespace Bempp
+{
+
+namespace
+{
+
+typedef boost::uint64_t CurveKey;
+typedef boost::uint32_t CellIndex;
+
+// Number of bits of each quantised coordinate; three of them fit in a key
+const int BITS_PER_AXIS = 21;
+
+// Insert two zero bits between consecutive bits of the lowest 21 bits of x
+inline CurveKey spreadBits(CurveKey x)
+{
+    x &= 0x1fffffULL;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+inline CurveKey mortonKey(const CellIndex cell[3])
+{
+    return spreadBits(cell[0]) << 2 | spreadBits(cell[1]) << 1 |
+            spreadBits(cell[2]);
+}
+
+// Skilling's algorithm (J. Skilling, "Programming the Hilbert curve", AIP
+// Conf. Proc. 707, 2004): transform the cell coordinates in place so that
+// interleaving their bits yields the position of the cell along the curve
+inline CurveKey hilbertKey(const CellIndex cell[3])
+{
+    CellIndex x[3] = {cell[0], cell[1], cell[2]};
+    const CellIndex m = CellIndex(1) << (BITS_PER_AXIS - 1);
+    // Inverse undo
+    for (CellIndex q = m; q > 1; q >>= 1) {
+        const CellIndex p = q - 1;
+        for (int i = 0; i < 3; ++i)
+            if (x[i] & q)
+                x[0] ^= p;
+            else {
+                const CellIndex t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+    }
+    // Gray encode
+    for (int i = 1; i < 3; ++i)
+        x[i] ^= x[i - 1];
+    CellIndex t = 0;
+    for (CellIndex q = m; q > 1; q >>= 1)
+        if (x[2] & q)
+            t ^= q - 1;
+    for (int i = 0; i < 3; ++i)
+        x[i] ^= t;
+    return mortonKey(x);
+}
+
+typedef std::pair<CurveKey, int> KeyedPoint;
+
+class CurveKeyLoopBody
+{
+public:
+    CurveKeyLoopBody(const arma::Mat<double>& points,
+                     const double* lowerBound, double scale, bool hilbert,
+                     std::vector<KeyedPoint>& keys) :
+        m_points(points), m_lowerBound(lowerBound), m_scale(scale),
+        m_hilbert(hilbert), m_keys(keys) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        const CellIndex maxCell = (CellIndex(1) << BITS_PER_AXIS) - 1;
+        CellIndex cell[3];
+        for (size_t p = r.begin(); p != r.end(); ++p) {
+            for (int dim = 0; dim < 3; ++dim) {
+                const double x =
+                        (m_points(dim, p) - m_lowerBound[dim]) * m_scale;
+                cell[dim] = std::min(maxCell, CellIndex(std::max(0., x)));
+            }
+            m_keys[p] = KeyedPoint(m_hilbert ? hilbertKey(cell)
+                                             : mortonKey(cell), int(p));
+        }
+    }
+
+private:
+    const arma::Mat<double>& m_points;
+    const double* m_lowerBound;
+    double m_scale;
+    bool m_hilbert;
+    std::vector<KeyedPoint>& m_keys;
+};
+
+} // namespace
+
+void computeSpaceFillingCurveOrder(const arma::Mat<double>& points,
+                                   GridParameters::ElementOrdering ordering,
+                                   std::vector<int>& order)
+{
+    if (ordering != GridParameters::MORTON_ORDERING &&
+            ordering != GridParameters::HILBERT_ORDERING)
+        throw std::invalid_argument("computeSpaceFillingCurveOrder(): "
+                                    "unsupported ordering");
+    if (points.n_rows != 3)
+        throw std::invalid_argument("computeSpaceFillingCurveOrder(): "
+                                    "points must have three coordinates");
+    const size_t pointCount = points.n_cols;
+    order.resize(pointCount);
+    if (pointCount == 0)
+        return;
+
+    // Bounding cube of the points
+    double lowerBound[3], upperBound[3];
+    for (int dim = 0; dim < 3; ++dim)
+        lowerBound[dim] = upperBound[dim] = points(dim, 0);
+    for (size_t p = 1; p < pointCount; ++p)
+        for (int dim = 0; dim < 3; ++dim) {
+            lowerBound[dim] = std::min(lowerBound[dim], points(dim, p));
+            upperBound[dim] = std::max(upperBound[dim], points(dim, p));
+        }
+    double extent = 0.;
+    for (int dim = 0; dim < 3; ++dim)
+        extent = std::max(extent, upperBound[dim] - lowerBound[dim]);
+    const double scale =
+            extent > 0. ? ((CellIndex(1) << BITS_PER_AXIS) - 1) / extent : 0.;
+
+    std::vector<KeyedPoint> keys(pointCount);
+    const size_t GRAIN_SIZE = 1024;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, pointCount, GRAIN_SIZE),
+                      CurveKeyLoopBody(points, lowerBound, scale,
+                                       ordering ==
+                                       GridParameters::HILBERT_ORDERING,
+                                       keys));
+    // Ties are broken by point index, so the result is deterministic
+    tbb::parallel_sort(keys.begin(), keys.end());
+    for (size_t k = 0; k < pointCount; ++k)
+        order[k] = keys[k].second;
+}
+
+void reorderConnectivityArrays(GridParameters::ElementOrdering ordering,
+                               arma::Mat<double>& vertices,
+                               arma::Mat<int>& elementCorners,
+                               std::vector<int>& domainIndices,
+                               std::vector<int>& originalElementIndices,
+                               std::vector<int>& originalVertexIndices)
+{
+    const int vertexCount = vertices.n_cols;
+    const int elementCount = elementCorners.n_cols;
+    if (ordering == GridParameters::ORIGINAL_ORDERING) {
+        originalElementIndices.resize(elementCount);
+        for (int e = 0; e < elementCount; ++e)
+            originalElementIndices[e] = e;
+        originalVertexIndices.resize(vertexCount);
+        for (int v = 0; v < vertexCount; ++v)
+            originalVertexIndices[v] = v;
+        return;
+    }
+    if (vertices.n_rows != 3)
+        throw std::invalid_argument("reorderConnectivityArrays(): "
+                                    "vertices must have three coordinates");
+    if (elementCorners.n_rows != 3)
+        throw std::invalid_argument("reorderConnectivityArrays(): "
+                                    "elementCorners must have three rows");
+    if (!domainIndices.empty() && (int)domainIndices.size() != elementCount)
+        throw std::invalid_argument("reorderConnectivityArrays(): "
+                                    "domainIndices must be empty or have as "
+                                    "many elements as elementCorners has columns");
+    for (size_t i = 0; i < elementCorners.n_elem; ++i)
+        if (elementCorners[i] < 0 || elementCorners[i] >= vertexCount)
+            throw std::invalid_argument("reorderConnectivityArrays(): "
+                                        "invalid vertex index in elementCorners");
+
+    arma::Mat<double> centroids(3, elementCount);
+    for (int e = 0; e < elementCount; ++e)
+        for (int dim = 0; dim < 3; ++dim)
+            centroids(dim, e) = (vertices(dim, elementCorners(0, e)) +
+                                 vertices(dim, elementCorners(1, e)) +
+                                 vertices(dim, elementCorners(2, e))) / 3.;
+    computeSpaceFillingCurveOrder(centroids, ordering, originalElementIndices);
+
+    // Number the vertices in the order of their first appearance
+    std::vector<int> newVertexIndices(vertexCount, -1);
+    originalVertexIndices.clear();
+    originalVertexIndices.reserve(vertexCount);
+    for (int e = 0; e < elementCount; ++e)
+        for (int c = 0; c < 3; ++c) {
+            const int v = elementCorners(c, originalElementIndices[e]);
+            if (newVertexIndices[v] < 0) {
+                newVertexIndices[v] = originalVertexIndices.size();
+                originalVertexIndices.push_back(v);
+            }
+        }
+    for (int v = 0; v < vertexCount; ++v)
+        if (newVertexIndices[v] < 0) {
+            newVertexIndices[v] = originalVertexIndices.size();
+            originalVertexIndices.push_back(v);
+        }
+
+    arma::Mat<double> newVertices(3, vertexCount);
+    for (int v = 0; v < vertexCount; ++v)
+        for (int dim = 0; dim < 3; ++dim)
+            newVertices(dim, v) = vertices(dim, originalVertexIndices[v]);
+    arma::Mat<int> newElementCorners(3, elementCount);
+    for (int e = 0; e < elementCount; ++e)
+        for (int c = 0; c < 3; ++c)
+            newElementCorners(c, e) = newVertexIndices[
+                    elementCorners(c, originalElementIndices[e])];
+    if (!domainIndices.empty()) {
+        std::vector<int> newDomainIndices(elementCount);
+        for (int e = 0; e < elementCount; ++e)
+            newDomainIndices[e] = domainIndices[originalElementIndices[e]];
+        domainIndices.swap(newDomainIndices);
+    }
+    vertices = newVertices;
+    elementCorners = newElementCorners;
+}
+
+} // namespace Bempp
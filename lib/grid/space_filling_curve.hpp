@@ -0,0 +1,88 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_space_filling_curve_hpp
+#define bempp_space_filling_curve_hpp
+
+#include "../common/common.hpp"
+#include "grid_parameters.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <vector>
+
+namespace Bempp
+{
+
+/** \brief Compute the order in which a space-filling curve visits a set of
+ *  points.
+ *
+ *  \param[in] points
+ *    2D array of dimensions (3, \c n) whose (\c i, \c j)th element is the
+ *    \c i'th coordinate of the \c j'th point.
+ *  \param[in] ordering
+ *    Curve to use (GridParameters::MORTON_ORDERING or
+ *    GridParameters::HILBERT_ORDERING).
+ *  \param[out] order
+ *    On output, vector of length \c n whose \c k'th element is the index of
+ *    the \c k'th point visited by the curve.
+ *
+ *  The curve is laid over the bounding cube of the points, subdivided into
+ *  2^21 cells along each axis. Points falling into the same cell are
+ *  visited in order of increasing index. */
+void computeSpaceFillingCurveOrder(const arma::Mat<double>& points,
+                                   GridParameters::ElementOrdering ordering,
+                                   std::vector<int>& order);
+
+/** \brief Renumber the elements and vertices of a triangular grid.
+ *
+ *  \param[in] ordering
+ *    Requested numbering.
+ *  \param[in,out] vertices
+ *    2D array of dimensions (3, \c m) whose (\c i, \c j)th element is the
+ *    \c i'th coordinate of \c j'th vertex.
+ *  \param[in,out] elementCorners
+ *    2D array of dimensions (3, \c n) whose \c j'th column contains the
+ *    indices of the vertices of the \c j'th element.
+ *  \param[in,out] domainIndices
+ *    Either an empty vector or a vector of length \c n containing the domain
+ *    indices of the elements.
+ *  \param[out] originalElementIndices
+ *    On output, vector whose \c j'th element is the index the \c j'th
+ *    element had on input.
+ *  \param[out] originalVertexIndices
+ *    On output, vector whose \c j'th element is the index the \c j'th
+ *    vertex had on input.
+ *
+ *  Elements are sorted by the position of their centroids along the
+ *  space-filling curve selected by \p ordering. Vertices are numbered in the
+ *  order in which they are first reached when the sorted elements are
+ *  traversed; vertices not belonging to any element are put at the end. If
+ *  \p ordering is GridParameters::ORIGINAL_ORDERING, the arrays are left
+ *  unchanged. */
+void reorderConnectivityArrays(GridParameters::ElementOrdering ordering,
+                               arma::Mat<double>& vertices,
+                               arma::Mat<int>& elementCorners,
+                               std::vector<int>& domainIndices,
+                               std::vector<int>& originalElementIndices,
+                               std::vector<int>& originalVertexIndices);
+
+} // namespace Bempp
+
+#endif
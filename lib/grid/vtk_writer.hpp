@@ -50,7 +50,11 @@ public:
       //! Output to the file is in appended raw binary.
       APPENDED_RAW,
       //! Output to the file is in appended base64 binary.
-      APPENDED_BASE_64
+      APPENDED_BASE_64,
+      //! Output to the file is in appended raw binary compressed with zlib.
+      //! Supported only by VtuWriter, and only if BEM++ has been built
+      //! with zlib support (WITH_ZLIB option).
+      APPENDED_RAW_COMPRESSED
     };
 
     /** \brief Dataset type. */
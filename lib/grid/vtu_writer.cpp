@@ -0,0 +1,906 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "vtu_writer.hpp"
+
+#include "grid_view.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../common/not_implemented_error.hpp"
+#include "bempp/common/config_zlib.hpp"
+
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Bempp
+{
+
+namespace
+{
+
+// Type of the integers stored in the headers of binary arrays
+typedef boost::uint64_t HeaderType;
+
+// Number of blocks processed in parallel before being written to the file
+const size_t BATCH_SIZE = 64;
+
+// Width of the placeholders reserved for the offsets of appended arrays
+const int OFFSET_WIDTH = 20;
+
+// VTK cell types
+const unsigned char VTK_LINE = 3;
+const unsigned char VTK_TRIANGLE = 5;
+const unsigned char VTK_QUAD = 9;
+const unsigned char VTK_TETRA = 10;
+
+// Permutations of element corners from the Dune to the VTK ordering
+const int IDENTITY_CORNER_ORDER[4] = {0, 1, 2, 3};
+const int QUAD_CORNER_ORDER[4] = {0, 1, 3, 2};
+
+unsigned char vtkCellType(int gridDim, int cornerCount)
+{
+    if (gridDim == 1 && cornerCount == 2)
+        return VTK_LINE;
+    if (gridDim == 2 && cornerCount == 3)
+        return VTK_TRIANGLE;
+    if (gridDim == 2 && cornerCount == 4)
+        return VTK_QUAD;
+    if (gridDim == 3 && cornerCount == 4)
+        return VTK_TETRA;
+    throw NotImplementedError("VtuWriter::VtuWriter(): unsupported element type");
+}
+
+const char* byteOrder()
+{
+    const HeaderType one = 1;
+    return *reinterpret_cast<const char*>(&one) ? "LittleEndian" : "BigEndian";
+}
+
+bool isValidOutputType(VtkWriter::OutputType type)
+{
+    return type == VtkWriter::ASCII || type == VtkWriter::BASE_64 ||
+            type == VtkWriter::APPENDED_RAW ||
+            type == VtkWriter::APPENDED_BASE_64 ||
+            type == VtkWriter::APPENDED_RAW_COMPRESSED;
+}
+
+bool isAppended(VtkWriter::OutputType type)
+{
+    return type == VtkWriter::APPENDED_RAW ||
+            type == VtkWriter::APPENDED_BASE_64 ||
+            type == VtkWriter::APPENDED_RAW_COMPRESSED;
+}
+
+std::string joinPaths(const std::string& directory, const std::string& path)
+{
+    if (directory.empty() || (!path.empty() && path[0] == '/'))
+        return path;
+    if (directory[directory.size() - 1] == '/')
+        return directory + path;
+    return directory + "/" + path;
+}
+
+// Return true if a data array of the given shape should be registered, false
+// if it is empty (and should be ignored); throw if its number of columns is
+// wrong
+bool checkDataShape(size_t rowCount, size_t colCount, size_t expectedColCount,
+                    const char* errorMessage)
+{
+    if (rowCount < 1)
+        return false; // empty matrix
+    if (colCount != expectedColCount)
+        throw std::logic_error(errorMessage);
+    return true;
+}
+
+template <typename T> struct VtkTypeTraits;
+
+template <> struct VtkTypeTraits<double>
+{
+    static const char* name() { return "Float64"; }
+    static const char* format() { return "%.17g"; }
+};
+
+template <> struct VtkTypeTraits<float>
+{
+    static const char* name() { return "Float32"; }
+    static const char* format() { return "%.9g"; }
+};
+
+template <> struct VtkTypeTraits<int>
+{
+    static const char* name() { return "Int32"; }
+    static const char* format() { return "%d"; }
+};
+
+template <> struct VtkTypeTraits<unsigned char>
+{
+    static const char* name() { return "UInt8"; }
+    static const char* format() { return "%d"; }
+};
+
+// Array stored in a VTU file. Its contents are produced on demand, a range
+// of tuples at a time.
+class ArraySource
+{
+public:
+    ArraySource(const std::string& name, int componentCount, size_t tupleCount) :
+        m_name(name), m_componentCount(componentCount), m_tupleCount(tupleCount) {
+    }
+
+    virtual ~ArraySource() {
+    }
+
+    const std::string& name() const { return m_name; }
+    int componentCount() const { return m_componentCount; }
+    size_t tupleCount() const { return m_tupleCount; }
+    size_t byteCount() const { return m_tupleCount * tupleSize(); }
+
+    virtual const char* typeName() const = 0;
+    virtual size_t tupleSize() const = 0;
+
+    // Binary contents of the whole array if they are already stored
+    // contiguously in memory, null otherwise
+    virtual const char* contiguousData() const { return 0; }
+
+    // Store the binary representation of tuples [begin, end) in 'buffer'
+    virtual void fill(size_t begin, size_t end, char* buffer) const = 0;
+
+    // Append the textual representation of tuples [begin, end) to 'text'
+    virtual void format(size_t begin, size_t end,
+                        std::vector<char>& text) const = 0;
+
+private:
+    std::string m_name;
+    int m_componentCount;
+    size_t m_tupleCount;
+};
+
+template <typename T>
+class TypedArraySource : public ArraySource
+{
+public:
+    TypedArraySource(const std::string& name, int componentCount,
+                     size_t tupleCount) :
+        ArraySource(name, componentCount, tupleCount) {
+    }
+
+    virtual const char* typeName() const {
+        return VtkTypeTraits<T>::name();
+    }
+
+    virtual size_t tupleSize() const {
+        return componentCount() * sizeof(T);
+    }
+
+    virtual void fill(size_t begin, size_t end, char* buffer) const {
+        fillValues(begin, end, reinterpret_cast<T*>(buffer));
+    }
+
+    virtual void format(size_t begin, size_t end,
+                        std::vector<char>& text) const {
+        const int componentCount = this->componentCount();
+        std::vector<T> values((end - begin) * componentCount);
+        if (values.empty())
+            return;
+        fillValues(begin, end, &values[0]);
+        char number[32];
+        for (size_t i = 0; i < values.size(); ++i) {
+            const int length = std::sprintf(
+                        number, VtkTypeTraits<T>::format(), values[i]);
+            text.insert(text.end(), number, number + length);
+            text.push_back((i + 1) % componentCount == 0 ? '\n' : ' ');
+        }
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end, T* values) const = 0;
+};
+
+// Array whose tuples are stored contiguously in memory (e.g. in a matrix
+// passed to addCellData())
+template <typename T>
+class ContiguousArraySource : public TypedArraySource<T>
+{
+public:
+    ContiguousArraySource(const std::string& name, int componentCount,
+                          size_t tupleCount, const T* data) :
+        TypedArraySource<T>(name, componentCount, tupleCount), m_data(data) {
+    }
+
+    virtual const char* contiguousData() const {
+        return reinterpret_cast<const char*>(m_data);
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end, T* values) const {
+        const int componentCount = this->componentCount();
+        std::copy(m_data + begin * componentCount, m_data + end * componentCount,
+                  values);
+    }
+
+private:
+    const T* m_data;
+};
+
+// Vertex coordinates, padded with zeros to three components
+class PointSource : public TypedArraySource<double>
+{
+public:
+    explicit PointSource(const arma::Mat<double>& vertices) :
+        TypedArraySource<double>("Coordinates", 3, vertices.n_cols),
+        m_vertices(vertices) {
+    }
+
+    virtual const char* contiguousData() const {
+        if (m_vertices.n_rows == 3)
+            return reinterpret_cast<const char*>(m_vertices.memptr());
+        return 0;
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end, double* values) const {
+        const size_t dimWorld = m_vertices.n_rows;
+        for (size_t v = begin; v < end; ++v, values += 3)
+            for (size_t i = 0; i < 3; ++i)
+                values[i] = i < dimWorld ? m_vertices(i, v) : 0.;
+    }
+
+private:
+    const arma::Mat<double>& m_vertices;
+};
+
+// Element corners, in the VTK ordering
+class ConnectivitySource : public TypedArraySource<int>
+{
+public:
+    ConnectivitySource(const arma::Mat<int>& elementCorners, int cornerCount,
+                       const int* cornerOrder) :
+        TypedArraySource<int>("connectivity", cornerCount,
+                              elementCorners.n_cols),
+        m_elementCorners(elementCorners), m_cornerOrder(cornerOrder) {
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end, int* values) const {
+        const int cornerCount = componentCount();
+        for (size_t e = begin; e < end; ++e, values += cornerCount)
+            for (int i = 0; i < cornerCount; ++i)
+                values[i] = m_elementCorners(m_cornerOrder[i], e);
+    }
+
+private:
+    const arma::Mat<int>& m_elementCorners;
+    const int* m_cornerOrder;
+};
+
+// Offsets of the ends of the elements in the connectivity array
+class OffsetSource : public TypedArraySource<int>
+{
+public:
+    OffsetSource(size_t elementCount, int cornerCount) :
+        TypedArraySource<int>("offsets", 1, elementCount),
+        m_cornerCount(cornerCount) {
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end, int* values) const {
+        for (size_t e = begin; e < end; ++e)
+            *values++ = (e + 1) * m_cornerCount;
+    }
+
+private:
+    int m_cornerCount;
+};
+
+// Types of the elements (all identical)
+class CellTypeSource : public TypedArraySource<unsigned char>
+{
+public:
+    CellTypeSource(size_t elementCount, unsigned char cellType) :
+        TypedArraySource<unsigned char>("types", 1, elementCount),
+        m_cellType(cellType) {
+    }
+
+protected:
+    virtual void fillValues(size_t begin, size_t end,
+                            unsigned char* values) const {
+        std::fill(values, values + (end - begin), m_cellType);
+    }
+
+private:
+    unsigned char m_cellType;
+};
+
+// Division of an array into blocks of whole tuples of size at most
+// VtuWriter::BLOCK_SIZE (unless a single tuple is larger)
+struct BlockLayout
+{
+    explicit BlockLayout(const ArraySource& source) :
+        tupleCount(source.tupleCount()),
+        blockTupleCount(std::max<size_t>(
+                            1, VtuWriter::BLOCK_SIZE / source.tupleSize())),
+        blockCount((tupleCount + blockTupleCount - 1) / blockTupleCount) {
+    }
+
+    size_t begin(size_t block) const {
+        return block * blockTupleCount;
+    }
+
+    size_t end(size_t block) const {
+        return std::min(tupleCount, (block + 1) * blockTupleCount);
+    }
+
+    size_t tupleCount;
+    size_t blockTupleCount;
+    size_t blockCount;
+};
+
+enum BlockMode
+{
+    FILL,
+    FORMAT,
+    COMPRESS
+};
+
+class BlockLoopBody
+{
+public:
+    BlockLoopBody(const ArraySource& source, const BlockLayout& layout,
+                  size_t firstBlock, BlockMode mode,
+                  std::vector<std::vector<char> >& buffers) :
+        m_source(source), m_layout(layout), m_firstBlock(firstBlock),
+        m_mode(mode), m_buffers(buffers) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+            const size_t begin = m_layout.begin(m_firstBlock + i);
+            const size_t end = m_layout.end(m_firstBlock + i);
+            std::vector<char>& buffer = m_buffers[i];
+            buffer.clear();
+            switch (m_mode) {
+            case FILL:
+                buffer.resize((end - begin) * m_source.tupleSize());
+                m_source.fill(begin, end, &buffer[0]);
+                break;
+            case FORMAT:
+                m_source.format(begin, end, buffer);
+                break;
+            case COMPRESS:
+                compress(begin, end, buffer);
+                break;
+            }
+        }
+    }
+
+private:
+    void compress(size_t begin, size_t end, std::vector<char>& buffer) const {
+#ifdef WITH_ZLIB
+        const size_t tupleSize = m_source.tupleSize();
+        const size_t size = (end - begin) * tupleSize;
+        // Compress contiguous data in place to avoid copying them
+        const char* data = m_source.contiguousData();
+        std::vector<char> uncompressed;
+        if (data)
+            data += begin * tupleSize;
+        else {
+            uncompressed.resize(size);
+            m_source.fill(begin, end, &uncompressed[0]);
+            data = &uncompressed[0];
+        }
+        uLongf compressedSize = compressBound(size);
+        buffer.resize(compressedSize);
+        if (compress2(reinterpret_cast<Bytef*>(&buffer[0]), &compressedSize,
+                      reinterpret_cast<const Bytef*>(data), size,
+                      Z_DEFAULT_COMPRESSION) != Z_OK)
+            throw std::runtime_error("VtuWriter::write(): "
+                                     "zlib compression failed");
+        buffer.resize(compressedSize);
+#endif
+    }
+
+private:
+    const ArraySource& m_source;
+    const BlockLayout& m_layout;
+    size_t m_firstBlock;
+    BlockMode m_mode;
+    std::vector<std::vector<char> >& m_buffers;
+};
+
+// Produce the blocks of 'source' in parallel, in batches of BATCH_SIZE
+// blocks, and pass them in order to 'sink'
+template <typename Sink>
+void processBlocks(const ArraySource& source, BlockMode mode, Sink& sink)
+{
+    const BlockLayout layout(source);
+    std::vector<std::vector<char> > buffers(
+                std::min(BATCH_SIZE, layout.blockCount));
+    for (size_t first = 0; first < layout.blockCount; first += BATCH_SIZE) {
+        const size_t count = std::min(BATCH_SIZE, layout.blockCount - first);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, count, 1),
+                          BlockLoopBody(source, layout, first, mode, buffers));
+        for (size_t i = 0; i < count; ++i)
+            sink.put(buffers[i]);
+    }
+}
+
+class StreamSink
+{
+public:
+    explicit StreamSink(std::ostream& out) : m_out(out) {
+    }
+
+    void put(const std::vector<char>& block) {
+        if (!block.empty())
+            m_out.write(&block[0], block.size());
+    }
+
+private:
+    std::ostream& m_out;
+};
+
+class CompressedBlockSink
+{
+public:
+    CompressedBlockSink(std::ostream& out, std::vector<HeaderType>& sizes) :
+        m_out(out), m_sizes(sizes) {
+    }
+
+    void put(const std::vector<char>& block) {
+        m_sizes.push_back(block.size());
+        if (!block.empty())
+            m_out.write(&block[0], block.size());
+    }
+
+private:
+    std::ostream& m_out;
+    std::vector<HeaderType>& m_sizes;
+};
+
+// Base64 encoder of a stream of bytes passed in pieces of arbitrary length
+class Base64Encoder
+{
+public:
+    explicit Base64Encoder(std::ostream& out) :
+        m_out(out), m_pendingCount(0) {
+    }
+
+    void put(const std::vector<char>& block) {
+        if (!block.empty())
+            put(&block[0], block.size());
+    }
+
+    void put(const char* data, size_t size) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+        const unsigned char* end = p + size;
+        while (m_pendingCount > 0 && m_pendingCount < 3 && p != end)
+            m_pending[m_pendingCount++] = *p++;
+        if (m_pendingCount == 3) {
+            encode(m_pending, 3);
+            m_pendingCount = 0;
+        }
+        for (; end - p >= 3; p += 3)
+            encode(p, 3);
+        while (p != end)
+            m_pending[m_pendingCount++] = *p++;
+    }
+
+    // Encode the remaining bytes (with padding) and write the output
+    void flush() {
+        if (m_pendingCount > 0)
+            encode(m_pending, m_pendingCount);
+        m_pendingCount = 0;
+        writeBuffer();
+    }
+
+private:
+    void encode(const unsigned char* in, int count) {
+        static const char ALPHABET[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const unsigned int triple = (in[0] << 16) |
+                ((count > 1 ? in[1] : 0) << 8) | (count > 2 ? in[2] : 0);
+        m_buffer.push_back(ALPHABET[(triple >> 18) & 63]);
+        m_buffer.push_back(ALPHABET[(triple >> 12) & 63]);
+        m_buffer.push_back(count > 1 ? ALPHABET[(triple >> 6) & 63] : '=');
+        m_buffer.push_back(count > 2 ? ALPHABET[triple & 63] : '=');
+        if (m_buffer.size() >= VtuWriter::BLOCK_SIZE)
+            writeBuffer();
+    }
+
+    void writeBuffer() {
+        m_out.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+
+private:
+    std::ostream& m_out;
+    std::string m_buffer;
+    unsigned char m_pending[3];
+    int m_pendingCount;
+};
+
+void writeHeader(std::ostream& out, const HeaderType* header, size_t count)
+{
+    out.write(reinterpret_cast<const char*>(header), count * sizeof(HeaderType));
+}
+
+void writeAsciiArray(std::ostream& out, const ArraySource& source)
+{
+    StreamSink sink(out);
+    processBlocks(source, FORMAT, sink);
+}
+
+void writeRawArray(std::ostream& out, const ArraySource& source)
+{
+    const HeaderType byteCount = source.byteCount();
+    writeHeader(out, &byteCount, 1);
+    if (const char* data = source.contiguousData())
+        out.write(data, byteCount);
+    else {
+        StreamSink sink(out);
+        processBlocks(source, FILL, sink);
+    }
+}
+
+void writeBase64Array(std::ostream& out, const ArraySource& source)
+{
+    // The header and the data are encoded as a single stream
+    Base64Encoder encoder(out);
+    const HeaderType byteCount = source.byteCount();
+    encoder.put(reinterpret_cast<const char*>(&byteCount), sizeof(HeaderType));
+    if (const char* data = source.contiguousData())
+        encoder.put(data, byteCount);
+    else
+        processBlocks(source, FILL, encoder);
+    encoder.flush();
+}
+
+void writeCompressedArray(std::ostream& out, const ArraySource& source)
+{
+    // Header: number of blocks, block size, size of the last block if it is
+    // partial (0 otherwise), compressed sizes of the blocks. The compressed
+    // sizes are written after all blocks have been compressed.
+    const BlockLayout layout(source);
+    const HeaderType blockSize = layout.blockTupleCount * source.tupleSize();
+    std::vector<HeaderType> header;
+    header.reserve(3 + layout.blockCount);
+    header.push_back(layout.blockCount);
+    header.push_back(blockSize);
+    header.push_back(source.byteCount() % blockSize);
+
+    const std::streampos headerPosition = out.tellp();
+    const std::vector<HeaderType> placeholder(3 + layout.blockCount, 0);
+    writeHeader(out, &placeholder[0], placeholder.size());
+    CompressedBlockSink sink(out, header);
+    processBlocks(source, COMPRESS, sink);
+
+    const std::streampos endPosition = out.tellp();
+    out.seekp(headerPosition);
+    writeHeader(out, &header[0], header.size());
+    out.seekp(endPosition);
+}
+
+void writeAppendedArray(std::ostream& out, const ArraySource& source,
+                        VtkWriter::OutputType type)
+{
+    switch (type) {
+    case VtkWriter::APPENDED_RAW:
+        writeRawArray(out, source);
+        break;
+    case VtkWriter::APPENDED_BASE_64:
+        writeBase64Array(out, source);
+        break;
+    case VtkWriter::APPENDED_RAW_COMPRESSED:
+        writeCompressedArray(out, source);
+        break;
+    default:
+        throw std::invalid_argument("VtuWriter::write(): invalid output type");
+    }
+}
+
+// Write the DataArray elements describing the arrays [begin, end) of
+// 'sources'. In appended mode, store the positions of the placeholders for
+// the offsets of the arrays in 'offsetPositions'.
+void writeDataArrays(std::ostream& out,
+                     const boost::ptr_vector<ArraySource>& sources,
+                     size_t begin, size_t end, VtkWriter::OutputType type,
+                     std::vector<std::streampos>& offsetPositions)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const ArraySource& source = sources[i];
+        out << "        <DataArray type=\"" << source.typeName()
+            << "\" Name=\"" << source.name()
+            << "\" NumberOfComponents=\"" << source.componentCount() << "\"";
+        if (isAppended(type)) {
+            out << " format=\"appended\" offset=\"";
+            offsetPositions.push_back(out.tellp());
+            out << std::string(OFFSET_WIDTH, '0') << "\"/>\n";
+        } else if (type == VtkWriter::ASCII) {
+            out << " format=\"ascii\">\n";
+            writeAsciiArray(out, source);
+            out << "        </DataArray>\n";
+        } else { // BASE_64
+            out << " format=\"binary\">\n";
+            writeBase64Array(out, source);
+            out << "\n        </DataArray>\n";
+        }
+    }
+}
+
+} // namespace
+
+VtuWriter::VtuWriter(const GridView& view, int gridDim) :
+    m_grid_dim(gridDim), m_corner_count(gridDim + 1)
+{
+    arma::Mat<char> auxData;
+    view.getRawElementData(m_vertices, m_element_corners, auxData);
+
+    // Unused corners are marked with -1
+    const size_t elementCount = m_element_corners.n_cols;
+    for (size_t e = 0; e < elementCount; ++e) {
+        int cornerCount = 0;
+        while (cornerCount < (int)m_element_corners.n_rows &&
+               m_element_corners(cornerCount, e) >= 0)
+            ++cornerCount;
+        if (e == 0)
+            m_corner_count = cornerCount;
+        else if (cornerCount != m_corner_count)
+            throw NotImplementedError(
+                    "VtuWriter::VtuWriter(): grids composed of elements "
+                    "of different types are not supported");
+    }
+    vtkCellType(m_grid_dim, m_corner_count); // check element type
+}
+
+void VtuWriter::clear()
+{
+    m_cell_data.clear();
+    m_vertex_data.clear();
+}
+
+std::string VtuWriter::write(const std::string& name, OutputType type)
+{
+    const std::string fileName = name + ".vtu";
+    writePiece(fileName, type);
+    return fileName;
+}
+
+std::string VtuWriter::pwrite(const std::string& name, const std::string& path,
+                              const std::string& extendpath, OutputType type)
+{
+    // Same naming scheme as Dune's VTKWriter for a serial run
+    const std::string pieceName =
+            joinPaths(extendpath, "s0001:p0000:" + name + ".vtu");
+    const std::string headerName = joinPaths(path, "s0001:" + name + ".pvtu");
+    writePiece(joinPaths(path, pieceName), type);
+    writeParallelHeader(headerName, pieceName);
+    return headerName;
+}
+
+void VtuWriter::addCellDataDoubleImpl(const arma::Mat<double>& data,
+                                      const std::string& name)
+{
+    if (checkDataShape(data.n_rows, data.n_cols, m_element_corners.n_cols,
+                       "VtkWriter::addCellData(): number of columns "
+                       "of 'data' different from the number of cells")) {
+        DataArray array = {name, (int)data.n_rows, data.n_cols,
+                           data.memptr(), 0};
+        m_cell_data.push_back(array);
+    }
+}
+
+void VtuWriter::addCellDataFloatImpl(const arma::Mat<float>& data,
+                                     const std::string& name)
+{
+    if (checkDataShape(data.n_rows, data.n_cols, m_element_corners.n_cols,
+                       "VtkWriter::addCellData(): number of columns "
+                       "of 'data' different from the number of cells")) {
+        DataArray array = {name, (int)data.n_rows, data.n_cols,
+                           0, data.memptr()};
+        m_cell_data.push_back(array);
+    }
+}
+
+void VtuWriter::addVertexDataDoubleImpl(const arma::Mat<double>& data,
+                                        const std::string& name)
+{
+    if (checkDataShape(data.n_rows, data.n_cols, m_vertices.n_cols,
+                       "VtkWriter::addVertexData(): number of columns "
+                       "of 'data' different from the number of vertices")) {
+        DataArray array = {name, (int)data.n_rows, data.n_cols,
+                           data.memptr(), 0};
+        m_vertex_data.push_back(array);
+    }
+}
+
+void VtuWriter::addVertexDataFloatImpl(const arma::Mat<float>& data,
+                                       const std::string& name)
+{
+    if (checkDataShape(data.n_rows, data.n_cols, m_vertices.n_cols,
+                       "VtkWriter::addVertexData(): number of columns "
+                       "of 'data' different from the number of vertices")) {
+        DataArray array = {name, (int)data.n_rows, data.n_cols,
+                           0, data.memptr()};
+        m_vertex_data.push_back(array);
+    }
+}
+
+void VtuWriter::writePiece(const std::string& fileName, OutputType type) const
+{
+    if (!isValidOutputType(type))
+        throw std::invalid_argument("VtuWriter::write(): invalid output type");
+#ifndef WITH_ZLIB
+    if (type == APPENDED_RAW_COMPRESSED)
+        throw std::runtime_error("VtuWriter::write(): compressed output "
+                                 "requires BEM++ to be built with zlib "
+                                 "support (WITH_ZLIB)");
+#endif
+
+    // Arrays stored in the file, in the order of the sections PointData,
+    // CellData, Points and Cells
+    boost::ptr_vector<ArraySource> sources;
+    for (size_t i = 0; i < m_vertex_data.size(); ++i) {
+        const DataArray& a = m_vertex_data[i];
+        if (a.doubleData)
+            sources.push_back(new ContiguousArraySource<double>(
+                                  a.name, a.componentCount, a.tupleCount,
+                                  a.doubleData));
+        else
+            sources.push_back(new ContiguousArraySource<float>(
+                                  a.name, a.componentCount, a.tupleCount,
+                                  a.floatData));
+    }
+    const size_t cellDataBegin = sources.size();
+    for (size_t i = 0; i < m_cell_data.size(); ++i) {
+        const DataArray& a = m_cell_data[i];
+        if (a.doubleData)
+            sources.push_back(new ContiguousArraySource<double>(
+                                  a.name, a.componentCount, a.tupleCount,
+                                  a.doubleData));
+        else
+            sources.push_back(new ContiguousArraySource<float>(
+                                  a.name, a.componentCount, a.tupleCount,
+                                  a.floatData));
+    }
+    const size_t pointsBegin = sources.size();
+    sources.push_back(new PointSource(m_vertices));
+    const size_t cellsBegin = sources.size();
+    const size_t elementCount = m_element_corners.n_cols;
+    const unsigned char cellType = vtkCellType(m_grid_dim, m_corner_count);
+    sources.push_back(new ConnectivitySource(
+                          m_element_corners, m_corner_count,
+                          cellType == VTK_QUAD ? QUAD_CORNER_ORDER
+                                               : IDENTITY_CORNER_ORDER));
+    sources.push_back(new OffsetSource(elementCount, m_corner_count));
+    sources.push_back(new CellTypeSource(elementCount, cellType));
+
+    std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary);
+    if (!out)
+        throw std::runtime_error("VtuWriter::write(): cannot open file '" +
+                                 fileName + "'");
+
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+        << byteOrder() << "\" header_type=\"UInt64\"";
+    if (type == APPENDED_RAW_COMPRESSED)
+        out << " compressor=\"vtkZLibDataCompressor\"";
+    out << ">\n"
+        << "  <UnstructuredGrid>\n"
+        << "    <Piece NumberOfPoints=\"" << m_vertices.n_cols
+        << "\" NumberOfCells=\"" << elementCount << "\">\n";
+    std::vector<std::streampos> offsetPositions;
+    out << "      <PointData>\n";
+    writeDataArrays(out, sources, 0, cellDataBegin, type, offsetPositions);
+    out << "      </PointData>\n"
+        << "      <CellData>\n";
+    writeDataArrays(out, sources, cellDataBegin, pointsBegin, type,
+                    offsetPositions);
+    out << "      </CellData>\n"
+        << "      <Points>\n";
+    writeDataArrays(out, sources, pointsBegin, cellsBegin, type,
+                    offsetPositions);
+    out << "      </Points>\n"
+        << "      <Cells>\n";
+    writeDataArrays(out, sources, cellsBegin, sources.size(), type,
+                    offsetPositions);
+    out << "      </Cells>\n"
+        << "    </Piece>\n"
+        << "  </UnstructuredGrid>\n";
+
+    if (isAppended(type)) {
+        out << "  <AppendedData encoding=\""
+            << (type == APPENDED_BASE_64 ? "base64" : "raw") << "\">\n   _";
+        const std::streampos dataBegin = out.tellp();
+        std::vector<HeaderType> offsets(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i) {
+            offsets[i] = out.tellp() - dataBegin;
+            writeAppendedArray(out, sources[i], type);
+        }
+        out << "\n  </AppendedData>\n";
+
+        // Fill in the placeholders for array offsets
+        const std::streampos endPosition = out.tellp();
+        char offset[OFFSET_WIDTH + 1];
+        for (size_t i = 0; i < sources.size(); ++i) {
+            std::sprintf(offset, "%020llu", (unsigned long long)offsets[i]);
+            out.seekp(offsetPositions[i]);
+            out.write(offset, OFFSET_WIDTH);
+        }
+        out.seekp(endPosition);
+    }
+    out << "</VTKFile>\n";
+    if (!out)
+        throw std::runtime_error("VtuWriter::write(): error writing file '" +
+                                 fileName + "'");
+}
+
+void VtuWriter::writeParallelHeader(const std::string& fileName,
+                                    const std::string& pieceName) const
+{
+    std::ofstream out(fileName.c_str());
+    if (!out)
+        throw std::runtime_error("VtuWriter::pwrite(): cannot open file '" +
+                                 fileName + "'");
+
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+        << byteOrder() << "\" header_type=\"UInt64\">\n"
+        << "  <PUnstructuredGrid GhostLevel=\"0\">\n"
+        << "    <PPointData>\n";
+    for (size_t i = 0; i < m_vertex_data.size(); ++i)
+        out << "      <PDataArray type=\""
+            << (m_vertex_data[i].doubleData ? "Float64" : "Float32")
+            << "\" Name=\"" << m_vertex_data[i].name
+            << "\" NumberOfComponents=\"" << m_vertex_data[i].componentCount
+            << "\"/>\n";
+    out << "    </PPointData>\n"
+        << "    <PCellData>\n";
+    for (size_t i = 0; i < m_cell_data.size(); ++i)
+        out << "      <PDataArray type=\""
+            << (m_cell_data[i].doubleData ? "Float64" : "Float32")
+            << "\" Name=\"" << m_cell_data[i].name
+            << "\" NumberOfComponents=\"" << m_cell_data[i].componentCount
+            << "\"/>\n";
+    out << "    </PCellData>\n"
+        << "    <PPoints>\n"
+        << "      <PDataArray type=\"Float64\" Name=\"Coordinates\" "
+           "NumberOfComponents=\"3\"/>\n"
+        << "    </PPoints>\n"
+        << "    <Piece Source=\"" << pieceName << "\"/>\n"
+        << "  </PUnstructuredGrid>\n"
+        << "</VTKFile>\n";
+    if (!out)
+        throw std::runtime_error("VtuWriter::pwrite(): error writing file '" +
+                                 fileName + "'");
+}
+
+} // namespace Bempp
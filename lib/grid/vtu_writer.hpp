@@ -0,0 +1,115 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_vtu_writer_hpp
+#define bempp_vtu_writer_hpp
+
+#include "../common/common.hpp"
+
+#include "vtk_writer.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class GridView;
+/** \endcond */
+
+/** \brief Native writer of VTK unstructured grid (.vtu) files.
+
+  Unlike ConcreteVtkWriter, this class does not wrap a Dune VTK writer. It
+  works directly on the raw element data of a grid view (see
+  GridView::getRawElementData()), supports output compressed with zlib
+  (VtkWriter::APPENDED_RAW_COMPRESSED) and processes the arrays stored in the
+  file in blocks: blocks are formatted, encoded and compressed in parallel
+  and written to the file as soon as they are ready, so that no complete
+  intermediate copy of any array is made. Floating-point arrays are stored in
+  the precision in which they are passed to addCellData() and
+  addVertexData().
+
+  Only conforming output is supported, i.e. vertex data are attached to the
+  vertices of the grid, and all elements of the grid must be of the same type.
+
+  As with ConcreteVtkWriter, the data arrays are not copied: they must stay
+  alive until write() or pwrite() is called.
+ */
+class VtuWriter : public VtkWriter
+{
+public:
+    /** \brief Constructor.
+
+      \param[in] view     Grid view whose elements will be written.
+      \param[in] gridDim  Dimension of the grid (1, 2 or 3). */
+    VtuWriter(const GridView& view, int gridDim);
+
+    virtual void clear();
+
+    virtual std::string write(const std::string &name,
+                              OutputType type = ASCII);
+
+    virtual std::string pwrite(const std::string& name, const std::string& path,
+                               const std::string& extendpath,
+                               OutputType type = ASCII);
+
+    /** \brief Size (in bytes) of the blocks in which arrays are processed. */
+    static const size_t BLOCK_SIZE = 1 << 16;
+
+private:
+    virtual void addCellDataDoubleImpl(
+            const arma::Mat<double>& data, const std::string &name);
+    virtual void addCellDataFloatImpl(
+            const arma::Mat<float>& data, const std::string &name);
+    virtual void addVertexDataDoubleImpl(
+            const arma::Mat<double>& data, const std::string &name);
+    virtual void addVertexDataFloatImpl(
+            const arma::Mat<float>& data, const std::string &name);
+
+    /** \cond PRIVATE */
+    struct DataArray
+    {
+        std::string name;
+        int componentCount;
+        size_t tupleCount;
+        const double* doubleData;
+        const float* floatData;
+    };
+    /** \endcond */
+
+    void writePiece(const std::string& fileName, OutputType type) const;
+    void writeParallelHeader(const std::string& fileName,
+                             const std::string& pieceName) const;
+
+private:
+    int m_grid_dim;
+    int m_corner_count;
+    arma::Mat<double> m_vertices;
+    arma::Mat<int> m_element_corners;
+    std::vector<DataArray> m_cell_data;
+    std::vector<DataArray> m_vertex_data;
+};
+
+} // namespace Bempp
+
+#endif
@@ -57,7 +57,8 @@ Teuchos::RCP<Thyra::LinearOpWithSolveBase<typename ScalarTraits<ValueType>::Real
 makeOperatorWithSolve(
         const Teuchos::RCP<Teuchos::ParameterList>& paramList,
         const Teuchos::RCP<const Thyra::LinearOpBase<ValueType> >& linOp,
-        const Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> >& preconditioner)
+        const Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> >& preconditioner,
+        const Teuchos::RCP<Thyra::LinearOpWithSolveBase<ValueType> >& previousOp)
 {
     Teuchos::RCP<Teuchos::FancyOStream> out =
             Teuchos::VerboseObjectBase::getDefaultOStream();
@@ -67,19 +68,23 @@ makeOperatorWithSolve(
     invertibleOpFactory.setOStream(out);
     invertibleOpFactory.setVerbLevel(Teuchos::VERB_DEFAULT);
 
-    Teuchos::RCP<Thyra::LinearOpWithSolveBase<ValueType> > result;
+    // Reinitializing an existing operator makes Stratimikos reuse its Belos
+    // solver manager (and hence e.g. the GCRO-DR recycle space)
+    Teuchos::RCP<Thyra::LinearOpWithSolveBase<ValueType> > result = previousOp;
+    if (result.is_null())
+        result = invertibleOpFactory.createOp();
+    Teuchos::RCP<const Thyra::LinearOpSourceBase<ValueType> > linOpSourcePtr(
+                new Thyra::DefaultLinearOpSource<ValueType>(linOp));
     if (preconditioner.is_null())
         // No preconditioner
-        result = Thyra::linearOpWithSolve(invertibleOpFactory, linOp);
-    else {
+        invertibleOpFactory.initializeOp(
+                    linOpSourcePtr, result.get(),
+                    Thyra::SUPPORT_SOLVE_UNSPECIFIED);
+    else
         // Preconditioner defined
-        result = invertibleOpFactory.createOp();
-        Teuchos::RCP<const Thyra::LinearOpSourceBase<ValueType> > linOpSourcePtr(
-                    new Thyra::DefaultLinearOpSource<ValueType>(linOp));
         invertibleOpFactory.initializePreconditionedOp(
                     linOpSourcePtr, preconditioner, result.get(),
                     Thyra::SUPPORT_SOLVE_UNSPECIFIED);
-    }
     return result;
 }
 
@@ -92,7 +97,9 @@ Teuchos::RCP<Thyra::LinearOpWithSolveBase<typename ScalarTraits<ValueType>::Real
 makeOperatorWithSolve(
         const Teuchos::RCP<Teuchos::ParameterList>& paramList,
         const Teuchos::RCP<const Thyra::LinearOpBase<ValueType> >& linOp,
-        const Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> >& preconditioner)
+        const Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> >& preconditioner,
+        const Teuchos::RCP<Thyra::LinearOpWithSolveBase<
+        typename ScalarTraits<ValueType>::RealType> >& previousOp)
 {
     typedef typename ScalarTraits<ValueType>::RealType RealType;
 
@@ -107,15 +114,20 @@ makeOperatorWithSolve(
     Teuchos::RCP<const Thyra::LinearOpBase<RealType> > realLinOp(
                 new RealWrapperOfComplexThyraLinearOperator<RealType>(linOp));
 
-    Teuchos::RCP<Thyra::LinearOpWithSolveBase<RealType> > result;
+    // Reinitializing an existing operator makes Stratimikos reuse its Belos
+    // solver manager (and hence e.g. the GCRO-DR recycle space)
+    Teuchos::RCP<Thyra::LinearOpWithSolveBase<RealType> > result = previousOp;
+    if (result.is_null())
+        result = invertibleOpFactory.createOp();
+    Teuchos::RCP<const Thyra::LinearOpSourceBase<RealType> > realLinOpSourcePtr(
+                new Thyra::DefaultLinearOpSource<RealType>(realLinOp));
     if (preconditioner.is_null())
         // No preconditioner
-        result = Thyra::linearOpWithSolve(invertibleOpFactory, realLinOp);
+        invertibleOpFactory.initializeOp(
+                    realLinOpSourcePtr, result.get(),
+                    Thyra::SUPPORT_SOLVE_UNSPECIFIED);
     else {
         // Preconditioner defined
-        result = invertibleOpFactory.createOp();
-        Teuchos::RCP<const Thyra::LinearOpSourceBase<RealType> > realLinOpSourcePtr(
-                    new Thyra::DefaultLinearOpSource<RealType>(realLinOp));
         Teuchos::RCP<const Thyra::PreconditionerBase<RealType> > realPreconditioner(
                     new RealWrapperOfComplexThyraPreconditioner<RealType>(preconditioner));
         invertibleOpFactory.initializePreconditionedOp(
@@ -217,6 +229,28 @@ reallySolve(
     return op.solve(trans, *realRhs, realSol.ptr());
 }
 
+template <typename MagnitudeType>
+MagnitudeType convergenceToleranceFromParameterList(
+        const Teuchos::ParameterList& paramList)
+{
+    const MagnitudeType unknown = -1.;
+    if (!paramList.isType<std::string>("Solver Type") ||
+            !paramList.isSublist("Solver Types"))
+        return unknown;
+    const std::string& solverType = paramList.get<std::string>("Solver Type");
+    const Teuchos::ParameterList& solverTypesList =
+            paramList.sublist("Solver Types");
+    if (!solverTypesList.isSublist(solverType))
+        return unknown;
+    const Teuchos::ParameterList& solverList =
+            solverTypesList.sublist(solverType);
+    if (solverList.isType<double>("Convergence Tolerance"))
+        return solverList.get<double>("Convergence Tolerance");
+    if (solverList.isType<float>("Convergence Tolerance"))
+        return solverList.get<float>("Convergence Tolerance");
+    return unknown;
+}
+
 } // namespace
 
 // BelosSolverWrapper member functions
@@ -224,7 +258,7 @@ reallySolve(
 template <typename ValueType>
 BelosSolverWrapper<ValueType>::BelosSolverWrapper(
         const Teuchos::RCP<const Thyra::LinearOpBase<ValueType> >& linOp) :
-    m_linOp(linOp)
+    m_linOp(linOp), m_convergenceTolerance(-1.)
 {
 }
 
@@ -240,12 +274,34 @@ void BelosSolverWrapper<ValueType>::setPreconditioner(
     m_preconditioner = preconditioner;
 }
 
+template <typename ValueType>
+void BelosSolverWrapper<ValueType>::setLinearOperator(
+        const Teuchos::RCP<const Thyra::LinearOpBase<ValueType> >& linOp)
+{
+    m_linOp = linOp;
+    if (!m_linOpWithSolve.is_null())
+        m_linOpWithSolve = makeOperatorWithSolve(
+                    m_paramList, m_linOp, m_preconditioner, m_linOpWithSolve);
+}
+
 template <typename ValueType>
 void BelosSolverWrapper<ValueType>::initializeSolver(
         const Teuchos::RCP<Teuchos::ParameterList>& paramList)
 {
+    const std::string solverType =
+            paramList->isType<std::string>("Solver Type") ?
+                paramList->get<std::string>("Solver Type") : std::string();
+    // The existing Belos solver can only be reused if the solver type has
+    // not changed
+    Teuchos::RCP<Thyra::LinearOpWithSolveBase<MagnitudeType> > previousOp;
+    if (solverType == m_solverType)
+        previousOp = m_linOpWithSolve;
     m_linOpWithSolve = makeOperatorWithSolve(
-                paramList, m_linOp, m_preconditioner);
+                paramList, m_linOp, m_preconditioner, previousOp);
+    m_paramList = paramList;
+    m_solverType = solverType;
+    m_convergenceTolerance =
+            convergenceToleranceFromParameterList<MagnitudeType>(*paramList);
 }
 
 template <typename ValueType>
@@ -261,6 +317,13 @@ BelosSolverWrapper<ValueType>::solve(
     return reallySolve(*m_linOpWithSolve, trans, rhs, sol);
 }
 
+template <typename ValueType>
+typename BelosSolverWrapper<ValueType>::MagnitudeType
+BelosSolverWrapper<ValueType>::convergenceTolerance() const
+{
+    return m_convergenceTolerance;
+}
+
 // nonmember functions
 
 namespace
@@ -296,6 +359,24 @@ inline defaultCgParameterListInternal(MagnitudeType tol, int maxIterationCount)
     return paramList;
 }
 
+template <typename MagnitudeType>
+Teuchos::RCP<Teuchos::ParameterList>
+inline defaultGcrodrParameterListInternal(
+        MagnitudeType tol, int maxIterationCount,
+        int krylovSubspaceDimension, int recycledSubspaceDimension)
+{
+    Teuchos::RCP<Teuchos::ParameterList> paramList(
+                new Teuchos::ParameterList("DefaultParameters"));
+    paramList->set("Solver Type", "GCRODR");
+    Teuchos::ParameterList& solverTypesList = paramList->sublist("Solver Types");
+    Teuchos::ParameterList& gcrodrList = solverTypesList.sublist("GCRODR");
+    gcrodrList.set("Convergence Tolerance", tol);
+    gcrodrList.set("Maximum Iterations", maxIterationCount);
+    gcrodrList.set("Num Blocks", krylovSubspaceDimension);
+    gcrodrList.set("Num Recycled Blocks", recycledSubspaceDimension);
+    return paramList;
+}
+
 } // namespace
 
 Teuchos::RCP<Teuchos::ParameterList> defaultGmresParameterList(
@@ -322,6 +403,24 @@ Teuchos::RCP<Teuchos::ParameterList> defaultCgParameterList(
     return defaultCgParameterListInternal(tol, maxIterationCount);
 }
 
+Teuchos::RCP<Teuchos::ParameterList> defaultGcrodrParameterList(
+        double tol, int maxIterationCount,
+        int krylovSubspaceDimension, int recycledSubspaceDimension)
+{
+    return defaultGcrodrParameterListInternal(
+                tol, maxIterationCount,
+                krylovSubspaceDimension, recycledSubspaceDimension);
+}
+
+Teuchos::RCP<Teuchos::ParameterList> defaultGcrodrParameterList(
+        float tol, int maxIterationCount,
+        int krylovSubspaceDimension, int recycledSubspaceDimension)
+{
+    return defaultGcrodrParameterListInternal(
+                tol, maxIterationCount,
+                krylovSubspaceDimension, recycledSubspaceDimension);
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(BelosSolverWrapper);
 
 } // namespace Bempp
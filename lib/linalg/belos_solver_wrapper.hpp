@@ -26,6 +26,8 @@
 #include "belos_solver_wrapper_fwd.hpp"
 #include "../common/scalar_traits.hpp"
 
+#include <string>
+
 namespace Thyra
 {
 /** \cond FORWARD_DECL */
@@ -51,6 +53,19 @@ public:
     void setPreconditioner(
             const Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> >& preconditioner);
 
+    /** \brief Replace the operator of the system.
+     *
+     *  If the solver has already been initialized, it is reinitialized with
+     *  the same parameter list and preconditioner, reusing the existing Belos
+     *  solver object (so that recycling solvers keep their recycle space). */
+    void setLinearOperator(
+            const Teuchos::RCP<const Thyra::LinearOpBase<ValueType> >& linOp);
+
+    /** \brief Initialize the solver.
+     *
+     *  If the solver has already been initialized with a parameter list
+     *  selecting the same solver type, the existing Belos solver object is
+     *  reused. */
     void initializeSolver(
             const Teuchos::RCP<Teuchos::ParameterList>& paramList);
 
@@ -59,10 +74,18 @@ public:
             const Thyra::MultiVectorBase<ValueType>& rhs,
             const Teuchos::Ptr<Thyra::MultiVectorBase<ValueType> >& sol) const;
 
+    /** \brief Convergence tolerance of the solver selected in the parameter
+     *  list passed to initializeSolver(), or a negative number if the list
+     *  does not specify it. */
+    MagnitudeType convergenceTolerance() const;
+
 private:
     Teuchos::RCP<const Thyra::LinearOpBase<ValueType> > m_linOp;
     Teuchos::RCP<const Thyra::PreconditionerBase<ValueType> > m_preconditioner;
-    Teuchos::RCP<const Thyra::LinearOpWithSolveBase<MagnitudeType> > m_linOpWithSolve;
+    Teuchos::RCP<Teuchos::ParameterList> m_paramList;
+    std::string m_solverType;
+    Teuchos::RCP<Thyra::LinearOpWithSolveBase<MagnitudeType> > m_linOpWithSolve;
+    MagnitudeType m_convergenceTolerance;
 };
 
 } // namespace Bempp
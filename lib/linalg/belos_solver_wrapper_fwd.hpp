@@ -24,6 +24,23 @@ Teuchos::RCP<Teuchos::ParameterList> defaultGmresParameterList(
 Teuchos::RCP<Teuchos::ParameterList> defaultCgParameterList(
         float tol, int maxIterationCount = 1000);
 
+/** \brief Default parameter list for the GCRO-DR solver.
+ *
+ *  GCRO-DR is a restarted GMRES variant that deflates a subspace of dimension
+ *  \p recycledSubspaceDimension, spanned by approximate eigenvectors
+ *  associated with the eigenvalues of smallest magnitude. The subspace is
+ *  carried over to subsequent solves with the same solver, which makes this
+ *  method attractive for sequences of systems with slowly varying operators
+ *  (see DefaultIterativeSolver::setBoundaryOperator()).
+ *  \p krylovSubspaceDimension is the maximum dimension of the Krylov
+ *  subspace constructed before a restart. */
+Teuchos::RCP<Teuchos::ParameterList> defaultGcrodrParameterList(
+        double tol, int maxIterationCount = 1000,
+        int krylovSubspaceDimension = 50, int recycledSubspaceDimension = 10);
+Teuchos::RCP<Teuchos::ParameterList> defaultGcrodrParameterList(
+        float tol, int maxIterationCount = 1000,
+        int krylovSubspaceDimension = 50, int recycledSubspaceDimension = 10);
+
 } // namespace Bempp
 
 #endif // WITH_TRILINOS
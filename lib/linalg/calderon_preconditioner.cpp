@@ -0,0 +1,170 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#ifdef WITH_TRILINOS
+
+#include "calderon_preconditioner.hpp"
+
+#include "../assembly/abstract_boundary_operator.hpp"
+#include "../assembly/abstract_boundary_operator_pseudoinverse.hpp"
+#include "../assembly/assembly_options.hpp"
+#include "../assembly/boundary_operator.hpp"
+#include "../assembly/context.hpp"
+#include "../assembly/discrete_boundary_operator.hpp"
+#include "../assembly/discrete_boundary_operator_composition.hpp"
+#include "../assembly/fused_discrete_boundary_operator.hpp"
+#include "../assembly/identity_operator.hpp"
+#include "../assembly/numerical_quadrature_strategy.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+
+namespace Bempp
+{
+
+CalderonPreconditionerOptions::CalderonPreconditionerOptions() :
+    acaEps(1e-2),
+    regularQuadratureOrderOffset(0),
+    singularQuadratureOrderOffset(-2)
+{
+}
+
+namespace
+{
+
+template <typename BasisFunctionType, typename ResultType>
+shared_ptr<const Context<BasisFunctionType, ResultType> >
+reducedAccuracyContext(
+        const Context<BasisFunctionType, ResultType>& context,
+        const CalderonPreconditionerOptions& options)
+{
+    AssemblyOptions assemblyOptions = context.assemblyOptions();
+    if (assemblyOptions.assemblyMode() == AssemblyOptions::ACA) {
+        AcaOptions acaOptions = assemblyOptions.acaOptions();
+        acaOptions.eps = std::max(acaOptions.eps, options.acaEps);
+        assemblyOptions.switchToAcaMode(acaOptions);
+    }
+
+    // Lower the quadrature orders used by the context's own strategy. Other
+    // quadrature strategies cannot be adjusted and are reused unchanged.
+    typedef Fiber::NumericalQuadratureStrategy<
+            BasisFunctionType, ResultType, GeometryFactory> FiberQuadStrategy;
+    shared_ptr<const FiberQuadStrategy> numericalQuadStrategy =
+            boost::dynamic_pointer_cast<const FiberQuadStrategy>(
+                context.quadStrategy());
+    if (!numericalQuadStrategy)
+        return boost::make_shared<Context<BasisFunctionType, ResultType> >(
+                    context.quadStrategy(), assemblyOptions);
+
+    AccuracyOptionsEx accuracyOptions = numericalQuadStrategy->accuracyOptions();
+    accuracyOptions.increaseQuadratureOrders(
+                options.regularQuadratureOrderOffset,
+                options.regularQuadratureOrderOffset,
+                options.singularQuadratureOrderOffset);
+    shared_ptr<const NumericalQuadratureStrategy<BasisFunctionType, ResultType> >
+            quadStrategy = boost::make_shared<
+                NumericalQuadratureStrategy<BasisFunctionType, ResultType> >(
+                accuracyOptions);
+    return boost::make_shared<Context<BasisFunctionType, ResultType> >(
+                quadStrategy, assemblyOptions);
+}
+
+// Return the inverse of the Gram matrix of the spaces trial and test.
+template <typename BasisFunctionType, typename ResultType>
+shared_ptr<const DiscreteBoundaryOperator<ResultType> > inverseGramMatrix(
+        const shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
+        const shared_ptr<const Space<BasisFunctionType> >& trial,
+        const shared_ptr<const Space<BasisFunctionType> >& test)
+{
+    return pseudoinverse(identityOperator(
+                             context, trial, trial, test)).weakForm();
+}
+
+} // namespace
+
+template <typename BasisFunctionType, typename ResultType>
+Preconditioner<ResultType> calderonPreconditioner(
+        const BoundaryOperator<BasisFunctionType, ResultType>& op,
+        const BoundaryOperator<BasisFunctionType, ResultType>& preconditioningOp,
+        const CalderonPreconditionerOptions& options)
+{
+    typedef DiscreteBoundaryOperator<ResultType> DiscreteLinOp;
+    typedef DiscreteBoundaryOperatorComposition<ResultType> Composition;
+
+    if (!op.isInitialized() || !preconditioningOp.isInitialized())
+        throw std::invalid_argument(
+                "calderonPreconditioner(): "
+                "both operators must be initialized");
+    if (preconditioningOp.domain() != op.range())
+        throw std::invalid_argument(
+                "calderonPreconditioner(): domain of the preconditioning "
+                "operator must be equal to the range of the operator");
+    if (preconditioningOp.range() != op.domain())
+        throw std::invalid_argument(
+                "calderonPreconditioner(): range of the preconditioning "
+                "operator must be equal to the domain of the operator");
+
+    shared_ptr<const Context<BasisFunctionType, ResultType> > context =
+            op.context();
+
+    // M1^{-1}: from the dual to the range of op to its range
+    shared_ptr<const DiscreteLinOp> m1Inverse =
+            inverseGramMatrix(context, op.range(), op.dualToRange());
+
+    // M2^{-1}: from the dual to the range of preconditioningOp to the domain
+    // of op. The Gram matrix is symmetric in its spaces, so M1^{-1} can
+    // often be reused.
+    shared_ptr<const DiscreteLinOp> m2Inverse;
+    if (preconditioningOp.dualToRange() == op.dualToRange() &&
+            op.domain() == op.range())
+        m2Inverse = m1Inverse;
+    else if (preconditioningOp.dualToRange() == op.range() &&
+             op.domain() == op.dualToRange())
+        m2Inverse = transpose(m1Inverse);
+    else
+        m2Inverse = inverseGramMatrix(context, op.domain(),
+                                      preconditioningOp.dualToRange());
+
+    shared_ptr<const DiscreteLinOp> cheapWeakForm =
+            preconditioningOp.abstractOperator()->assembleWeakForm(
+                *reducedAccuracyContext(*context, options));
+
+    shared_ptr<const DiscreteLinOp> composition =
+            boost::make_shared<Composition>(
+                m2Inverse,
+                boost::make_shared<Composition>(cheapWeakForm, m1Inverse));
+    return discreteOperatorToPreconditioner(fusedDiscreteOperator(composition));
+}
+
+#define INSTANTIATE_FREE_FUNCTIONS(BASIS, RESULT) \
+    template Preconditioner<RESULT> calderonPreconditioner( \
+        const BoundaryOperator<BASIS, RESULT>& op, \
+        const BoundaryOperator<BASIS, RESULT>& preconditioningOp, \
+        const CalderonPreconditionerOptions& options)
+
+FIBER_ITERATE_OVER_BASIS_AND_RESULT_TYPES(INSTANTIATE_FREE_FUNCTIONS);
+
+} // namespace Bempp
+
+#endif // WITH_TRILINOS
@@ -0,0 +1,111 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_calderon_preconditioner_hpp
+#define bempp_calderon_preconditioner_hpp
+
+#include "../common/common.hpp"
+
+#include "bempp/common/config_trilinos.hpp"
+
+#ifdef WITH_TRILINOS
+
+#include "preconditioner.hpp"
+
+namespace Bempp
+{
+
+template <typename BasisFunctionType, typename ResultType> class BoundaryOperator;
+
+/** \ingroup linalg
+ *  \brief Accuracy settings used by calderonPreconditioner() to assemble
+ *  the preconditioning operator.
+ *
+ *  A preconditioner only needs to be spectrally equivalent to the inverse of
+ *  the system operator, so it can be assembled much less accurately than the
+ *  operator itself. */
+struct CalderonPreconditionerOptions
+{
+    /** \brief Construct an object with default settings. */
+    CalderonPreconditionerOptions();
+
+    /** \brief Lower bound of the ACA tolerance.
+     *
+     *  If the context of the system operator uses ACA, the preconditioning
+     *  operator is assembled with the tolerance max(AcaOptions::eps,
+     *  acaEps). Default: 1e-2. */
+    double acaEps;
+    /** \brief Offset of the orders of regular quadrature rules.
+     *
+     *  Added to the orders of both single and double regular integrals used
+     *  by the quadrature strategy of the system operator's context (if it is
+     *  a NumericalQuadratureStrategy). Default: 0. */
+    int regularQuadratureOrderOffset;
+    /** \brief Offset of the orders of singular quadrature rules.
+     *
+     *  Added to the order of singular integrals used by the quadrature
+     *  strategy of the system operator's context (if it is a
+     *  NumericalQuadratureStrategy). Default: -2. */
+    int singularQuadratureOrderOffset;
+};
+
+/** \ingroup linalg
+ *  \brief Construct a Calderon preconditioner for a boundary operator.
+ *
+ *  Let \f$A\f$ be the operator \p op and \f$C\f$ the operator \p
+ *  preconditioningOp, chosen so that \f$CA\f$ is (up to a compact
+ *  perturbation) a multiple of the identity, e.g. the hypersingular operator
+ *  for a single-layer \p op. This function returns the discrete operator
+ *
+ *  \f[ P = M_2^{-1} C_h M_1^{-1}, \f]
+ *
+ *  where \f$C_h\f$ is the weak form of \f$C\f$ assembled with the reduced
+ *  accuracy settings given in \p options, \f$M_1\f$ is the Gram matrix of
+ *  the range of \p op and its dual, and \f$M_2\f$ is the Gram matrix of the
+ *  dual to the range of \p preconditioningOp and the domain of \p op. If the
+ *  spaces allow it, the factorisation of \f$M_1\f$ is reused (possibly
+ *  transposed) in place of \f$M_2^{-1}\f$. The resulting composition is
+ *  wrapped with fusedDiscreteOperator(), so that it can be applied many
+ *  times without allocating temporaries.
+ *
+ *  Both operators must share their assembly settings with the solver: the
+ *  context of \p op determines the assembly mode, ACA options and quadrature
+ *  of the Gram matrices. Operators assembled in ACA mode on the same spaces
+ *  share their cluster trees, so the preconditioner reuses the trees built
+ *  for \p op if the latter is assembled first.
+ *
+ *  \note If \p preconditioningOp is itself a composite (e.g. a sum or a
+ *  product of operators), its terms are assembled with their own contexts
+ *  and the reduced accuracy settings apply only to its top-level weak form.
+ *
+ *  An exception is thrown if the domain of \p preconditioningOp is not the
+ *  range of \p op or if its range is not the domain of \p op. */
+template <typename BasisFunctionType, typename ResultType>
+Preconditioner<ResultType> calderonPreconditioner(
+        const BoundaryOperator<BasisFunctionType, ResultType>& op,
+        const BoundaryOperator<BasisFunctionType, ResultType>& preconditioningOp,
+        const CalderonPreconditionerOptions& options =
+            CalderonPreconditionerOptions());
+
+} // namespace Bempp
+
+#endif // WITH_TRILINOS
+
+#endif
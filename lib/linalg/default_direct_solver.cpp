@@ -24,9 +24,15 @@
 #include "../assembly/blocked_boundary_operator.hpp"
 #include "../assembly/boundary_operator.hpp"
 #include "../assembly/discrete_boundary_operator.hpp"
+#include "../assembly/symmetry.hpp"
+#include "../common/complex_aux.hpp"
+#include "../common/lapack_aux.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 
+#include <algorithm>
 #include <boost/variant.hpp>
+#include <stdexcept>
+#include <vector>
 
 namespace Bempp
 {
@@ -36,19 +42,103 @@ namespace Bempp
 template <typename BasisFunctionType, typename ResultType> 
 struct DefaultDirectSolver<BasisFunctionType, ResultType>::Impl
 {
+    enum Factorization {
+        LU, SYMMETRIC_LDLT, HERMITIAN_LDLT
+    };
+
     Impl(const BoundaryOperator<BasisFunctionType, ResultType>& op_) :
         op(op_)
     {
+        factorize(op_.weakForm()->asMatrix(), op_.abstractOperator()->symmetry());
     }
 
     Impl(const BlockedBoundaryOperator<BasisFunctionType, ResultType>& op_) :
         op(op_)
     {
+        factorize(op_.weakForm()->asMatrix(), NO_SYMMETRY);
+    }
+
+    void factorize(const arma::Mat<ResultType>& matrix, int symmetry)
+    {
+        if (matrix.n_rows != matrix.n_cols)
+            throw std::invalid_argument(
+                "DefaultDirectSolver::DefaultDirectSolver(): "
+                "the weak form of the operator is not a square matrix");
+        factors = matrix;
+        const int n = factors.n_rows;
+        pivots.resize(std::max(n, 1));
+        int info = 0;
+        if (symmetry & (SYMMETRIC | HERMITIAN)) {
+            // Bunch-Kaufman factorisation using the lower triangle;
+            // start with a workspace query
+            factorization = (symmetry & HERMITIAN) ?
+                        HERMITIAN_LDLT : SYMMETRIC_LDLT;
+            ResultType optimalWorkSize;
+            doSymmetricFactorization(n, &optimalWorkSize, -1, info);
+            int workSize = std::max(
+                        static_cast<int>(realPart(optimalWorkSize)), 1);
+            std::vector<ResultType> work(workSize);
+            doSymmetricFactorization(n, &work[0], workSize, info);
+        } else {
+            factorization = LU;
+            Lapack::getrf(n, n, factors.memptr(), std::max(n, 1),
+                          &pivots[0], info);
+        }
+        if (info < 0)
+            throw std::runtime_error(
+                "DefaultDirectSolver::DefaultDirectSolver(): "
+                "invalid argument passed to the LAPACK factorisation routine");
+        if (info > 0)
+            throw std::runtime_error(
+                "DefaultDirectSolver::DefaultDirectSolver(): "
+                "the weak form of the operator is singular");
+    }
+
+    void doSymmetricFactorization(int n, ResultType* work, int workSize,
+                                  int& info)
+    {
+        if (factorization == HERMITIAN_LDLT)
+            Lapack::hetrf('L', n, factors.memptr(), std::max(n, 1),
+                          &pivots[0], work, workSize, info);
+        else
+            Lapack::sytrf('L', n, factors.memptr(), std::max(n, 1),
+                          &pivots[0], work, workSize, info);
+    }
+
+    // Overwrite each column of rhsAndSolution with the solution of the
+    // system whose right-hand side it contains
+    void solve(arma::Mat<ResultType>& rhsAndSolution) const
+    {
+        if (rhsAndSolution.n_rows != factors.n_rows)
+            throw std::invalid_argument(
+                "DefaultDirectSolver::solve(): "
+                "right-hand side has incorrect length");
+        const int n = factors.n_rows;
+        const int nrhs = rhsAndSolution.n_cols;
+        if (n == 0 || nrhs == 0)
+            return;
+        int info = 0;
+        if (factorization == LU)
+            Lapack::getrs('N', n, nrhs, factors.memptr(), n, &pivots[0],
+                          rhsAndSolution.memptr(), n, info);
+        else if (factorization == SYMMETRIC_LDLT)
+            Lapack::sytrs('L', n, nrhs, factors.memptr(), n, &pivots[0],
+                          rhsAndSolution.memptr(), n, info);
+        else
+            Lapack::hetrs('L', n, nrhs, factors.memptr(), n, &pivots[0],
+                          rhsAndSolution.memptr(), n, info);
+        if (info != 0)
+            throw std::runtime_error(
+                "DefaultDirectSolver::solve(): "
+                "LAPACK triangular solve failed");
     }
-    
+
     boost::variant<
         BoundaryOperator<BasisFunctionType, ResultType>,
         BlockedBoundaryOperator<BasisFunctionType, ResultType> > op;
+    arma::Mat<ResultType> factors;
+    std::vector<int> pivots;
+    Factorization factorization;
 };
 
 /** \endcond */
@@ -76,6 +166,26 @@ template <typename BasisFunctionType, typename ResultType>
 Solution<BasisFunctionType, ResultType> 
 DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
         const GridFunction<BasisFunctionType, ResultType>& rhs) const
+{
+    return solveImplNonblockedMultiple(
+                std::vector<GridFunction<BasisFunctionType, ResultType> >(
+                    1, rhs))[0];
+}
+
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplBlocked(
+    const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
+{
+    return solveImplBlockedMultiple(
+                std::vector<std::vector<GridFunction<BasisFunctionType,
+                ResultType> > >(1, rhs))[0];
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType> >
+DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplNonblockedMultiple(
+        const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
 {
     typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
 
@@ -85,25 +195,40 @@ DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
             "DefaultDirectSolver::solve(): for solvers constructed "
             "from a BlockedBoundaryOperator the other solve() overload "
             "must be used");
-    Solver<BasisFunctionType, ResultType>::checkConsistency(
-        *boundaryOp, rhs, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
-
-    arma::Col<ResultType> armaSolution = arma::solve(
-                boundaryOp->weakForm()->asMatrix(),
-                rhs.projections(*boundaryOp->dualToRange()));
-    
-    return Solution<BasisFunctionType, ResultType>(
-        GridFunction<BasisFunctionType, ResultType>(
-            boundaryOp->context(), boundaryOp->domain(), armaSolution),
-        SolutionStatus::CONVERGED,
-        SolutionBase<BasisFunctionType, ResultType>::unknownTolerance(),
-        "Solver finished");
+
+    // Gather the projections of all right-hand sides into one matrix
+    const size_t rhsCount = rhs.size();
+    arma::Mat<ResultType> armaRhs(
+                boundaryOp->dualToRange()->globalDofCount(), rhsCount);
+    for (size_t i = 0; i < rhsCount; ++i) {
+        Solver<BasisFunctionType, ResultType>::checkConsistency(
+            *boundaryOp, rhs[i],
+            ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+        armaRhs.col(i) = rhs[i].projections(*boundaryOp->dualToRange());
+    }
+
+    // Solve
+    m_impl->solve(armaRhs);
+
+    std::vector<Solution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhsCount);
+    for (size_t i = 0; i < rhsCount; ++i) {
+        arma::Col<ResultType> armaSolution = armaRhs.col(i);
+        solutions.push_back(Solution<BasisFunctionType, ResultType>(
+            GridFunction<BasisFunctionType, ResultType>(
+                boundaryOp->context(), boundaryOp->domain(), armaSolution),
+            SolutionStatus::CONVERGED,
+            SolutionBase<BasisFunctionType, ResultType>::unknownTolerance(),
+            "Solver finished"));
+    }
+    return solutions;
 }
 
 template <typename BasisFunctionType, typename ResultType>
-BlockedSolution<BasisFunctionType, ResultType>
-DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplBlocked(
-    const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
+std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplBlockedMultiple(
+    const std::vector<std::vector<GridFunction<BasisFunctionType, ResultType> > >&
+    rhs) const
 {
     typedef BlockedBoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
 
@@ -113,41 +238,50 @@ DefaultDirectSolver<BasisFunctionType, ResultType>::solveImplBlocked(
             "DefaultDirectSolver::solve(): for solvers constructed "
             "from a (non-blocked) BoundaryOperator the other solve() overload "
             "must be used");
-    std::vector<GridFunction<BasisFunctionType, ResultType> > canonicalRhs =
-            Solver<BasisFunctionType, ResultType>::canonicalizeBlockedRhs(
-                *boundaryOp, rhs,
-                ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
-    // Shouldn't be needed, but better safe than sorry...
-    Solver<BasisFunctionType, ResultType>::checkConsistency(
-                *boundaryOp, canonicalRhs,
-                ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
-
-    // Construct the right-hand size vector
-    arma::Col<ResultType> armaRhs(boundaryOp->totalGlobalDofCountInDualsToRanges());
-    for (size_t i = 0, start = 0; i < canonicalRhs.size(); ++i) {
-        const arma::Col<ResultType>& chunkProjections =
-                canonicalRhs[i].projections(*boundaryOp->dualToRange(i));
-        size_t chunkSize = chunkProjections.n_rows;
-        armaRhs.rows(start, start + chunkSize - 1) = chunkProjections;
-        start += chunkSize;
-    }        
+
+    // Construct the matrix of right-hand sides
+    const size_t rhsCount = rhs.size();
+    arma::Mat<ResultType> armaRhs(
+                boundaryOp->totalGlobalDofCountInDualsToRanges(), rhsCount);
+    for (size_t j = 0; j < rhsCount; ++j) {
+        std::vector<GridFunction<BasisFunctionType, ResultType> > canonicalRhs =
+                Solver<BasisFunctionType, ResultType>::canonicalizeBlockedRhs(
+                    *boundaryOp, rhs[j],
+                    ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+        // Shouldn't be needed, but better safe than sorry...
+        Solver<BasisFunctionType, ResultType>::checkConsistency(
+                    *boundaryOp, canonicalRhs,
+                    ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+
+        for (size_t i = 0, start = 0; i < canonicalRhs.size(); ++i) {
+            const arma::Col<ResultType>& chunkProjections =
+                    canonicalRhs[i].projections(*boundaryOp->dualToRange(i));
+            size_t chunkSize = chunkProjections.n_rows;
+            armaRhs.submat(start, j, start + chunkSize - 1, j) =
+                    chunkProjections;
+            start += chunkSize;
+        }
+    }
 
     // Solve
-    arma::Col<ResultType> armaSolution = arma::solve(
-                boundaryOp->weakForm()->asMatrix(),
-                armaRhs);
-    
-    // Convert chunks of the solution vector into grid functions
-    std::vector<GridFunction<BasisFunctionType, ResultType> > solutionFunctions;
-    Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
-        armaSolution, *boundaryOp, solutionFunctions);
-
-    // Return solution
-    return BlockedSolution<BasisFunctionType, ResultType>(
-        solutionFunctions,
-        SolutionStatus::CONVERGED,
-        SolutionBase<BasisFunctionType, ResultType>::unknownTolerance(),
-        "Solver finished");
+    m_impl->solve(armaRhs);
+
+    // Convert chunks of the solution vectors into grid functions
+    std::vector<BlockedSolution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhsCount);
+    for (size_t j = 0; j < rhsCount; ++j) {
+        arma::Col<ResultType> armaSolution = armaRhs.col(j);
+        std::vector<GridFunction<BasisFunctionType, ResultType> >
+                solutionFunctions;
+        Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
+            armaSolution, *boundaryOp, solutionFunctions);
+        solutions.push_back(BlockedSolution<BasisFunctionType, ResultType>(
+            solutionFunctions,
+            SolutionStatus::CONVERGED,
+            SolutionBase<BasisFunctionType, ResultType>::unknownTolerance(),
+            "Solver finished"));
+    }
+    return solutions;
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DefaultDirectSolver);
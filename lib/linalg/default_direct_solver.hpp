@@ -32,9 +32,15 @@ namespace Bempp
   * \brief Default Interface to the solution of boundary integral equations using a dense LU decomposition.
   *
   * This class provides an interface to the direct solution of boundary integral equations using standard LU.
-  * It is implemented via a call to the <a href="http://arma.sourceforge.net">Armadillo</a> dense solver, which
-  * is an interface to the corresponding Lapack routines.
+  * The weak form of the operator is converted to a dense matrix and factorised with
+  * <a href="http://www.netlib.org/lapack">LAPACK</a> once, in the constructor; the factorisation is then
+  * reused by all calls to solve() and solveMultiple(). Operators whose weak form is symmetric or Hermitian
+  * (see AbstractBoundaryOperator::symmetry()) are factorised with the Bunch-Kaufman (LDL^T or LDL^H)
+  * method, which halves the cost of the factorisation; all other operators, including blocked ones, are
+  * factorised with LU decomposition with partial pivoting.
   *
+  * Solving for many right-hand sides at once with solveMultiple() is considerably more efficient than
+  * calling solve() repeatedly, since all right-hand sides are then processed by a single LAPACK call.
   */
 
 template <typename BasisFunctionType, typename ResultType>
@@ -43,10 +49,20 @@ class DefaultDirectSolver : public Solver<BasisFunctionType, ResultType>
 public:
     typedef Solver<BasisFunctionType, ResultType> Base;
 
-    /** \brief Construct a solver for a non-blocked boundary operator. */
+    /** \brief Construct a solver for a non-blocked boundary operator.
+     *
+     *  The weak form of \p boundaryOp is assembled (if necessary) and
+     *  factorised.
+     *
+     *  \throws std::runtime_error if the matrix is found to be singular. */
     DefaultDirectSolver(
             const BoundaryOperator<BasisFunctionType, ResultType>& boundaryOp);
-    /** \brief Construct a solver for a blocked boundary operator. */
+    /** \brief Construct a solver for a blocked boundary operator.
+     *
+     *  The weak form of \p boundaryOp is assembled (if necessary) and
+     *  factorised.
+     *
+     *  \throws std::runtime_error if the matrix is found to be singular. */
     DefaultDirectSolver(
             const BlockedBoundaryOperator<BasisFunctionType, ResultType>& boundaryOp);
     ~DefaultDirectSolver();
@@ -57,6 +73,14 @@ private:
     virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
             const std::vector<GridFunction<BasisFunctionType, ResultType> >&
             rhs) const;
+    virtual std::vector<Solution<BasisFunctionType, ResultType> >
+    solveImplNonblockedMultiple(
+            const std::vector<GridFunction<BasisFunctionType, ResultType> >&
+            rhs) const;
+    virtual std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+    solveImplBlockedMultiple(
+            const std::vector<std::vector<GridFunction<BasisFunctionType,
+            ResultType> > >& rhs) const;
 
 private:
     struct Impl;
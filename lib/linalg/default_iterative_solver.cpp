@@ -35,11 +35,11 @@
 #include "../assembly/discrete_boundary_operator.hpp"
 #include "../assembly/discrete_boundary_operator_composition.hpp"
 #include "../assembly/identity_operator.hpp"
-#include "../assembly/vector.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../space/space.hpp"
 
 #include <Teuchos_RCPBoostSharedPtrConversions.hpp>
+#include <Thyra_DefaultSpmdMultiVector.hpp>
 #include <Thyra_DefaultSpmdVectorSpace.hpp>
 
 #include <boost/make_shared.hpp>
@@ -50,20 +50,64 @@
 namespace Bempp
 {
 
+namespace
+{
+
 template <typename ValueType>
-Teuchos::RCP<Thyra::DefaultSpmdVector<ValueType> >
-wrapInTrilinosVector(arma::Col<ValueType>& col)
+Teuchos::RCP<Thyra::DefaultSpmdMultiVector<ValueType> >
+wrapInTrilinosMultiVector(arma::Mat<ValueType>& mat)
 {
-    size_t size = col.n_rows;
+    const size_t rowCount = mat.n_rows;
+    const size_t colCount = mat.n_cols;
     Teuchos::ArrayRCP<ValueType> trilinosArray =
-            Teuchos::arcp(col.memptr(), 0 /* lowerOffset */,
-                          size, false /* doesn't own memory */);
-    typedef Thyra::DefaultSpmdVector<ValueType> TrilinosVector;
-    return Teuchos::RCP<TrilinosVector>(new TrilinosVector(
-        Thyra::defaultSpmdVectorSpace<ValueType>(size),
-        trilinosArray, 1 /* stride */));
+            Teuchos::arcp(mat.memptr(), 0 /* lowerOffset */,
+                          rowCount * colCount, false /* doesn't own memory */);
+    typedef Thyra::DefaultSpmdMultiVector<ValueType> TrilinosMultiVector;
+    return Teuchos::RCP<TrilinosMultiVector>(new TrilinosMultiVector(
+        Thyra::defaultSpmdVectorSpace<ValueType>(rowCount),
+        Thyra::defaultSpmdVectorSpace<ValueType>(colCount),
+        trilinosArray, rowCount /* leadingDim */));
+}
+
+// Split the status returned by Belos for a whole block of right-hand sides
+// into statuses of individual right-hand sides. If the block solve did not
+// converge, the explicit relative residual of each column is compared
+// against the tolerance requested from the solver.
+template <typename ValueType>
+std::vector<Thyra::SolveStatus<typename ScalarTraits<ValueType>::RealType> >
+splitSolveStatus(
+        const Thyra::SolveStatus<typename ScalarTraits<ValueType>::RealType>&
+        blockStatus,
+        typename ScalarTraits<ValueType>::RealType tolerance,
+        const DiscreteBoundaryOperator<ValueType>& systemOp,
+        const arma::Mat<ValueType>& rhs,
+        const arma::Mat<ValueType>& solution)
+{
+    typedef typename ScalarTraits<ValueType>::RealType MagnitudeType;
+
+    const size_t rhsCount = rhs.n_cols;
+    std::vector<Thyra::SolveStatus<MagnitudeType> > statuses(
+                rhsCount, blockStatus);
+    if (rhsCount <= 1 ||
+            blockStatus.solveStatus == Thyra::SOLVE_STATUS_CONVERGED)
+        return statuses;
+
+    arma::Mat<ValueType> residual = rhs;
+    systemOp.apply(NO_TRANSPOSE, solution, residual, -1., 1.);
+    for (size_t i = 0; i < rhsCount; ++i) {
+        const MagnitudeType rhsNorm = arma::norm(rhs.col(i), 2);
+        MagnitudeType relativeResidual = arma::norm(residual.col(i), 2);
+        if (rhsNorm != 0.)
+            relativeResidual /= rhsNorm;
+        statuses[i].achievedTol = relativeResidual;
+        if (tolerance >= 0. && relativeResidual <= tolerance)
+            statuses[i].solveStatus = Thyra::SOLVE_STATUS_CONVERGED;
+    }
+    return statuses;
 }
 
+} // namespace
+
 /** \cond HIDDEN_INTERNAL */
 
 template <typename BasisFunctionType, typename ResultType>
@@ -75,10 +119,33 @@ struct DefaultIterativeSolver<BasisFunctionType, ResultType>::Impl
          ConvergenceTestMode::Mode mode_) :
         op(op_),
         mode(mode_)
+    {
+        setOperator(op_);
+        solverWrapper.reset(
+                    new BelosSolverWrapper<ResultType>(
+                        Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
+                            systemOp)));
+    }
+
+    // Constructor for blocked operators
+    Impl(const BlockedBoundaryOperator<BasisFunctionType, ResultType>& op_,
+         ConvergenceTestMode::Mode mode_) :
+        op(op_),
+        mode(mode_)
+    {
+        setOperator(op_);
+        solverWrapper.reset(
+                    new BelosSolverWrapper<ResultType>(
+                        Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
+                            systemOp)));
+    }
+
+    // Store a non-blocked operator and construct the discrete operator of
+    // the system to be passed to Belos
+    void setOperator(const BoundaryOperator<BasisFunctionType, ResultType>& op_)
     {
         typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
-        typedef Solver<BasisFunctionType, ResultType> Solver_;
-        const BoundaryOp& boundaryOp = boost::get<BoundaryOp>(op);
+        const BoundaryOp& boundaryOp = op_;
         if (!boundaryOp.isInitialized())
             throw std::invalid_argument("DefaultIterativeSolver::Impl::Impl(): "
                                         "boundary operator must be initialized");
@@ -89,10 +156,7 @@ struct DefaultIterativeSolver<BasisFunctionType, ResultType>::Impl
                 throw std::invalid_argument("DefaultIterativeSolver::Impl::Impl(): "
                                             "non-square system provided");
 
-            solverWrapper.reset(
-                        new BelosSolverWrapper<ResultType>(
-                            Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
-                                boundaryOp.weakForm())));
+            systemOp = boundaryOp.weakForm();
         }
         else if (mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_RANGE) {
             if (boundaryOp.domain()->globalDofCount() !=
@@ -104,40 +168,32 @@ struct DefaultIterativeSolver<BasisFunctionType, ResultType>::Impl
                         boundaryOp.context(), boundaryOp.range(), boundaryOp.range(),
                         boundaryOp.dualToRange());
             pinvId = pseudoinverse(id);
-            shared_ptr<DiscreteBoundaryOperator<ResultType> > totalBoundaryOp =
+            systemOp =
                     boost::make_shared<DiscreteBoundaryOperatorComposition<ResultType> >(
                         boost::get<BoundaryOp>(pinvId).weakForm(),
                         boundaryOp.weakForm());
-            solverWrapper.reset(
-                        new BelosSolverWrapper<ResultType>(
-                            Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
-                                totalBoundaryOp)));
         }
         else
             throw std::invalid_argument(
                     "DefaultIterativeSolver::DefaultIterativeSolver(): "
                     "invalid convergence test mode");
+        op = op_;
     }
 
-    // Constructor for blocked operators
-    Impl(const BlockedBoundaryOperator<BasisFunctionType, ResultType>& op_,
-         ConvergenceTestMode::Mode mode_) :
-        op(op_),
-        mode(mode_)
+    // Store a blocked operator and construct the discrete operator of
+    // the system to be passed to Belos
+    void setOperator(
+            const BlockedBoundaryOperator<BasisFunctionType, ResultType>& op_)
     {
         typedef BlockedBoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
-        typedef Solver<BasisFunctionType, ResultType> Solver_;
-        const BoundaryOp& boundaryOp = boost::get<BoundaryOp>(op);
+        const BoundaryOp& boundaryOp = op_;
 
         if (mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE) {
             if (boundaryOp.totalGlobalDofCountInDomains() !=
                     boundaryOp.totalGlobalDofCountInDualsToRanges())
                 throw std::invalid_argument("DefaultIterativeSolver::Impl::Impl(): "
                                             "non-square system provided");
-            solverWrapper.reset(
-                        new BelosSolverWrapper<ResultType>(
-                            Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
-                                boundaryOp.weakForm())));
+            systemOp = boundaryOp.weakForm();
         }
         else if (mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_RANGE) {
             if (boundaryOp.totalGlobalDofCountInDomains() !=
@@ -168,25 +224,24 @@ struct DefaultIterativeSolver<BasisFunctionType, ResultType>::Impl
             pinvId = BlockedBoundaryOperator<BasisFunctionType, ResultType>(
                 pinvIdStructure);
 
-            shared_ptr<DiscreteBoundaryOperator<ResultType> > totalBoundaryOp =
+            systemOp =
                     boost::make_shared<DiscreteBoundaryOperatorComposition<ResultType> >(
                         boost::get<BoundaryOp>(pinvId).weakForm(),
                         boundaryOp.weakForm());
-            solverWrapper.reset(
-                        new BelosSolverWrapper<ResultType>(
-                            Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
-                                totalBoundaryOp)));
         }
         else
             throw std::invalid_argument(
                     "DefaultIterativeSolver::DefaultIterativeSolver(): "
                     "invalid convergence test mode");
+        op = op_;
     }
 
     boost::variant<
         BoundaryOperator<BasisFunctionType, ResultType>,
         BlockedBoundaryOperator<BasisFunctionType, ResultType> > op;
     ConvergenceTestMode::Mode mode;
+    // Operator of the system passed to Belos
+    shared_ptr<const DiscreteBoundaryOperator<ResultType> > systemOp;
     boost::scoped_ptr<BelosSolverWrapper<ResultType> > solverWrapper;
     boost::variant<
         BoundaryOperator<BasisFunctionType, ResultType>,
@@ -239,14 +294,85 @@ void DefaultIterativeSolver<BasisFunctionType, ResultType>::initializeSolver(
     m_impl->solverWrapper->initializeSolver(paramList);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+void DefaultIterativeSolver<BasisFunctionType, ResultType>::setBoundaryOperator(
+        const BoundaryOperator<BasisFunctionType, ResultType>& boundaryOp)
+{
+    typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+
+    const BoundaryOp* oldBoundaryOp = boost::get<BoundaryOp>(&m_impl->op);
+    if (!oldBoundaryOp)
+        throw std::logic_error(
+            "DefaultIterativeSolver::setBoundaryOperator(): for solvers "
+            "constructed from a BlockedBoundaryOperator the other "
+            "setBoundaryOperator() overload must be used");
+    if (boundaryOp.isInitialized() &&
+            (boundaryOp.domain()->globalDofCount() !=
+             oldBoundaryOp->domain()->globalDofCount() ||
+             boundaryOp.dualToRange()->globalDofCount() !=
+             oldBoundaryOp->dualToRange()->globalDofCount()))
+        throw std::invalid_argument(
+            "DefaultIterativeSolver::setBoundaryOperator(): "
+            "the new operator must have the same dimensions as the old one");
+    m_impl->setOperator(boundaryOp);
+    m_impl->solverWrapper->setLinearOperator(
+                Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
+                    m_impl->systemOp));
+}
+
+template <typename BasisFunctionType, typename ResultType>
+void DefaultIterativeSolver<BasisFunctionType, ResultType>::setBoundaryOperator(
+        const BlockedBoundaryOperator<BasisFunctionType, ResultType>& boundaryOp)
+{
+    typedef BlockedBoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+
+    const BoundaryOp* oldBoundaryOp = boost::get<BoundaryOp>(&m_impl->op);
+    if (!oldBoundaryOp)
+        throw std::logic_error(
+            "DefaultIterativeSolver::setBoundaryOperator(): for solvers "
+            "constructed from a (non-blocked) BoundaryOperator the other "
+            "setBoundaryOperator() overload must be used");
+    if (boundaryOp.totalGlobalDofCountInDomains() !=
+            oldBoundaryOp->totalGlobalDofCountInDomains() ||
+            boundaryOp.totalGlobalDofCountInDualsToRanges() !=
+            oldBoundaryOp->totalGlobalDofCountInDualsToRanges())
+        throw std::invalid_argument(
+            "DefaultIterativeSolver::setBoundaryOperator(): "
+            "the new operator must have the same dimensions as the old one");
+    m_impl->setOperator(boundaryOp);
+    m_impl->solverWrapper->setLinearOperator(
+                Teuchos::rcp<const Thyra::LinearOpBase<ResultType> >(
+                    m_impl->systemOp));
+}
+
 template <typename BasisFunctionType, typename ResultType>
 Solution<BasisFunctionType, ResultType>
 DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
         const GridFunction<BasisFunctionType, ResultType>& rhs) const
+{
+    return solveImplNonblockedMultiple(
+                std::vector<GridFunction<BasisFunctionType, ResultType> >(
+                    1, rhs))[0];
+}
+
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
+    const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
+{
+    return solveImplBlockedMultiple(
+                std::vector<std::vector<GridFunction<BasisFunctionType,
+                ResultType> > >(1, rhs))[0];
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType> >
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblockedMultiple(
+        const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
 {
     typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
     typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
-    typedef Thyra::MultiVectorBase<ResultType> TrilinosVector;
+    typedef Thyra::MultiVectorBase<ResultType> TrilinosMultiVector;
 
     const BoundaryOp* boundaryOp = boost::get<BoundaryOp>(&m_impl->op);
     if (!boundaryOp)
@@ -254,26 +380,32 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
             "DefaultIterativeSolver::solve(): for solvers constructed "
             "from a BlockedBoundaryOperator the other solve() overload "
             "must be used");
-    Solver<BasisFunctionType, ResultType>::checkConsistency(
-        *boundaryOp, rhs, m_impl->mode);
 
-    // Construct rhs vector
-    Vector<ResultType> projectionsVector(
-                rhs.projections(*boundaryOp->dualToRange()));
-    Teuchos::RCP<TrilinosVector> rhsVector;
+    // Construct the matrix whose columns are the right-hand sides
+    const size_t rhsCount = rhs.size();
+    arma::Mat<ResultType> armaProjections(
+                boundaryOp->dualToRange()->globalDofCount(), rhsCount);
+    for (size_t i = 0; i < rhsCount; ++i) {
+        Solver<BasisFunctionType, ResultType>::checkConsistency(
+            *boundaryOp, rhs[i], m_impl->mode);
+        armaProjections.col(i) = rhs[i].projections(*boundaryOp->dualToRange());
+    }
+    arma::Mat<ResultType> armaRhs;
     if (m_impl->mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE)
-        rhsVector = Teuchos::rcpFromRef(projectionsVector);
+        armaRhs = armaProjections;
     else {
-        const size_t size = boundaryOp->range()->globalDofCount();
-        rhsVector.reset(new Vector<ResultType>(size));
+        armaRhs.set_size(boundaryOp->range()->globalDofCount(), rhsCount);
         boost::get<BoundaryOp>(m_impl->pinvId).weakForm()->apply(
-            Thyra::NOTRANS, projectionsVector, rhsVector.ptr(), 1., 0.);
+            NO_TRANSPOSE, armaProjections, armaRhs, 1., 0.);
     }
+    Teuchos::RCP<TrilinosMultiVector> rhsVector =
+            wrapInTrilinosMultiVector(armaRhs);
 
-    // Construct solution vector
-    arma::Col<ResultType> armaSolution(rhsVector->range()->dim());
+    // Construct solution vectors
+    arma::Mat<ResultType> armaSolution(armaRhs.n_rows, rhsCount);
     armaSolution.fill(static_cast<ResultType>(0.));
-    Teuchos::RCP<TrilinosVector> solutionVector = wrapInTrilinosVector(armaSolution);
+    Teuchos::RCP<TrilinosMultiVector> solutionVector =
+            wrapInTrilinosMultiVector(armaSolution);
 
     // Get number of threads
     Fiber::ParallelizationOptions parallelOptions =
@@ -287,31 +419,43 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
             maxThreadCount = parallelOptions.maxThreadCount();
     }
 
-    // Solve
-    Thyra::SolveStatus<MagnitudeType> status;
+    // Solve for all right-hand sides at once
+    std::vector<Thyra::SolveStatus<MagnitudeType> > statuses;
     {
         // Initialize TBB threads here (to prevent their construction and
         // destruction on every matrix-vector multiplication)
         tbb::task_scheduler_init scheduler(maxThreadCount);
-        status = m_impl->solverWrapper->solve(
-            Thyra::NOTRANS, *rhsVector, solutionVector.ptr());
+        Thyra::SolveStatus<MagnitudeType> status =
+                m_impl->solverWrapper->solve(
+                    Thyra::NOTRANS, *rhsVector, solutionVector.ptr());
+        statuses = splitSolveStatus(
+                    status, m_impl->solverWrapper->convergenceTolerance(),
+                    *m_impl->systemOp, armaRhs, armaSolution);
     }
 
-    // Construct grid function and return
-    return Solution<BasisFunctionType, ResultType>(
-        GridFunction<BasisFunctionType, ResultType>(
-            boundaryOp->context(), boundaryOp->domain(), armaSolution),
-        status);
+    // Construct grid functions and return
+    std::vector<Solution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhsCount);
+    for (size_t i = 0; i < rhsCount; ++i) {
+        arma::Col<ResultType> armaSolutionColumn = armaSolution.col(i);
+        solutions.push_back(Solution<BasisFunctionType, ResultType>(
+            GridFunction<BasisFunctionType, ResultType>(
+                boundaryOp->context(), boundaryOp->domain(),
+                armaSolutionColumn),
+            statuses[i]));
+    }
+    return solutions;
 }
 
 template <typename BasisFunctionType, typename ResultType>
-BlockedSolution<BasisFunctionType, ResultType>
-DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
-    const std::vector<GridFunction<BasisFunctionType, ResultType> >& rhs) const
+std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlockedMultiple(
+    const std::vector<std::vector<GridFunction<BasisFunctionType, ResultType> > >&
+    rhs) const
 {
     typedef BlockedBoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
     typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
-    typedef Thyra::MultiVectorBase<ResultType> TrilinosVector;
+    typedef Thyra::MultiVectorBase<ResultType> TrilinosMultiVector;
 
     const BoundaryOp* boundaryOp = boost::get<BoundaryOp>(&m_impl->op);
     if (!boundaryOp)
@@ -319,44 +463,46 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
             "DefaultIterativeSolver::solve(): for solvers constructed "
             "from a (non-blocked) BoundaryOperator the other solve() overload "
             "must be used");
-    std::vector<GridFunction<BasisFunctionType, ResultType> > canonicalRhs =
-            Solver<BasisFunctionType, ResultType>::canonicalizeBlockedRhs(
-        *boundaryOp, rhs, m_impl->mode);
-    // Shouldn't be needed, but better safe than sorry...
-    Solver<BasisFunctionType, ResultType>::checkConsistency(
-                *boundaryOp, canonicalRhs, m_impl->mode);
-
-    // Currently we only support convergence testing in space dual to range.
-
-    // Construct the right-hand-side vector
-    arma::Col<ResultType> armaProjections(
-        boundaryOp->totalGlobalDofCountInDualsToRanges());
-    for (size_t i = 0, start = 0; i < canonicalRhs.size(); ++i) {
-        const arma::Col<ResultType>& chunkProjections =
-                canonicalRhs[i].projections(*boundaryOp->dualToRange(i));
-        size_t chunkSize = chunkProjections.n_rows;
-        armaProjections.rows(start, start + chunkSize - 1) = chunkProjections;
-        start += chunkSize;
+
+    // Construct the matrix whose columns are the right-hand sides
+    const size_t rhsCount = rhs.size();
+    arma::Mat<ResultType> armaProjections(
+        boundaryOp->totalGlobalDofCountInDualsToRanges(), rhsCount);
+    for (size_t j = 0; j < rhsCount; ++j) {
+        std::vector<GridFunction<BasisFunctionType, ResultType> > canonicalRhs =
+                Solver<BasisFunctionType, ResultType>::canonicalizeBlockedRhs(
+            *boundaryOp, rhs[j], m_impl->mode);
+        // Shouldn't be needed, but better safe than sorry...
+        Solver<BasisFunctionType, ResultType>::checkConsistency(
+                    *boundaryOp, canonicalRhs, m_impl->mode);
+
+        for (size_t i = 0, start = 0; i < canonicalRhs.size(); ++i) {
+            const arma::Col<ResultType>& chunkProjections =
+                    canonicalRhs[i].projections(*boundaryOp->dualToRange(i));
+            size_t chunkSize = chunkProjections.n_rows;
+            armaProjections.submat(start, j, start + chunkSize - 1, j) =
+                    chunkProjections;
+            start += chunkSize;
+        }
     }
 
-    Vector<ResultType> projectionsVector(armaProjections);
-    Teuchos::RCP<TrilinosVector> rhsVector;
+    arma::Mat<ResultType> armaRhs;
     if (m_impl->mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE)
-        rhsVector = Teuchos::rcpFromRef(projectionsVector);
+        armaRhs = armaProjections;
     else {
-        const size_t rhsSize = boundaryOp->totalGlobalDofCountInRanges();
-        rhsVector.reset(new Vector<ResultType>(rhsSize));
+        armaRhs.set_size(boundaryOp->totalGlobalDofCountInRanges(), rhsCount);
         boost::get<BoundaryOp>(m_impl->pinvId).weakForm()->apply(
-            Thyra::NOTRANS, projectionsVector, rhsVector.ptr(), 1., 0.);
+            NO_TRANSPOSE, armaProjections, armaRhs, 1., 0.);
     }
+    Teuchos::RCP<TrilinosMultiVector> rhsVector =
+            wrapInTrilinosMultiVector(armaRhs);
 
-    // Initialize the solution vector
-    size_t solutionSize = 0;
-    for (size_t i = 0; i < canonicalRhs.size(); ++i)
-        solutionSize += boundaryOp->domain(i)->globalDofCount();
-    arma::Col<ResultType> armaSolution(solutionSize);
+    // Initialize the solution vectors
+    arma::Mat<ResultType> armaSolution(
+                boundaryOp->totalGlobalDofCountInDomains(), rhsCount);
     armaSolution.fill(static_cast<ResultType>(0.));
-    Teuchos::RCP<TrilinosVector> solutionVector = wrapInTrilinosVector(armaSolution);
+    Teuchos::RCP<TrilinosMultiVector> solutionVector =
+            wrapInTrilinosMultiVector(armaSolution);
 
     // Get context of the first non-empty operator
     size_t rowCount = boundaryOp->rowCount();
@@ -380,23 +526,33 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
             maxThreadCount = parallelOptions.maxThreadCount();
     }
 
-    // Solve
-    Thyra::SolveStatus<MagnitudeType> status;
+    // Solve for all right-hand sides at once
+    std::vector<Thyra::SolveStatus<MagnitudeType> > statuses;
     {
         // Initialize TBB threads here (to prevent their construction and
         // destruction on every matrix-vector multiplication)
         tbb::task_scheduler_init scheduler(maxThreadCount);
-        status = m_impl->solverWrapper->solve(
-            Thyra::NOTRANS, *rhsVector, solutionVector.ptr());
+        Thyra::SolveStatus<MagnitudeType> status =
+                m_impl->solverWrapper->solve(
+                    Thyra::NOTRANS, *rhsVector, solutionVector.ptr());
+        statuses = splitSolveStatus(
+                    status, m_impl->solverWrapper->convergenceTolerance(),
+                    *m_impl->systemOp, armaRhs, armaSolution);
     }
 
-    // Convert chunks of the solution vector into grid functions
-    std::vector<GridFunction<BasisFunctionType, ResultType> > solutionFunctions;
-    Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
-        armaSolution, *boundaryOp, solutionFunctions);
-
-    // Return solution
-    return BlockedSolution<BasisFunctionType, ResultType>(solutionFunctions, status);
+    // Convert chunks of the solution vectors into grid functions
+    std::vector<BlockedSolution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhsCount);
+    for (size_t j = 0; j < rhsCount; ++j) {
+        arma::Col<ResultType> armaSolutionColumn = armaSolution.col(j);
+        std::vector<GridFunction<BasisFunctionType, ResultType> >
+                solutionFunctions;
+        Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
+            armaSolutionColumn, *boundaryOp, solutionFunctions);
+        solutions.push_back(BlockedSolution<BasisFunctionType, ResultType>(
+            solutionFunctions, statuses[j]));
+    }
+    return solutions;
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DefaultIterativeSolver);
@@ -59,6 +59,18 @@ namespace Bempp
   * Ax=M^\dagger b\f$ is solved, where \f$M\f$ is the mass matrix, mapping from
   * the range space into its dual and \f$M^\dagger\f$ is its pseudoinverse.
   *
+  * Several right-hand sides can be solved for simultaneously with
+  * solveMultiple(). They are then passed to Belos as a single multivector,
+  * so that each iteration of a block or pseudo-block solver (e.g. "Block
+  * GMRES" or the default "Pseudo Block GMRES") applies the operator to all
+  * of them at once. The convergence status is reported separately for each
+  * right-hand side.
+  *
+  * The Belos solver object is kept between successive calls to solve(), and
+  * also survives setBoundaryOperator() and reinitialization with a parameter
+  * list selecting the same solver type. Recycling solvers such as GCRO-DR
+  * (see defaultGcrodrParameterList()) can therefore reuse the deflation
+  * subspace harvested from earlier systems.
   */
 template <typename BasisFunctionType, typename ResultType>
 class DefaultIterativeSolver : public Solver<BasisFunctionType, ResultType>
@@ -112,8 +124,9 @@ public:
       *
       * \param[in] paramList
       *   Parameter lists can be read in from XML files or defined in code. Use
-      *   defaultGmresParameterList() and defaultCgParameterList() to construct
-      *   default parameter lists for the GMRES and CG solvers.
+      *   defaultGmresParameterList(), defaultCgParameterList() and
+      *   defaultGcrodrParameterList() to construct default parameter lists
+      *   for the GMRES, CG and GCRO-DR solvers.
       */
     void initializeSolver(const Teuchos::RCP<Teuchos::ParameterList>& paramList);
 
@@ -121,20 +134,54 @@ public:
       *
       * \param[in] paramList
       *   Parameter lists can be read in from XML files or defined in code. Use
-      *   defaultGmresParameterList() and defaultCgParameterList() to construct
-      *   default parameter lists for the GMRES and CG solvers.
+      *   defaultGmresParameterList(), defaultCgParameterList() and
+      *   defaultGcrodrParameterList() to construct default parameter lists
+      *   for the GMRES, CG and GCRO-DR solvers.
       * \param[in] preconditioner
       *   Preconditioner to be used by the solver.
       */
     void initializeSolver(const Teuchos::RCP<Teuchos::ParameterList>& paramList,
                           const Preconditioner<ResultType>& preconditioner);
 
+    /** \brief Replace the (non-blocked) boundary operator of the system.
+      *
+      * This function is intended for sequences of related problems, such as
+      * frequency sweeps or time stepping, in which the operator changes
+      * slowly from one system to the next. The new operator must have the
+      * same dimensions as the old one. If the solver has already been
+      * initialized, it remains initialized with the same parameter list and
+      * preconditioner; in particular, recycling solvers such as GCRO-DR (see
+      * defaultGcrodrParameterList()) keep their deflation subspace and
+      * use it to accelerate the solution of the new system.
+      *
+      * \note Call initializeSolver() if the preconditioner should be
+      *   updated, too. Reinitialization with a parameter list selecting the
+      *   same solver type preserves the recycled subspace as well.
+      */
+    void setBoundaryOperator(
+            const BoundaryOperator<BasisFunctionType, ResultType>& boundaryOp);
+
+    /** \brief Replace the blocked boundary operator of the system.
+      *
+      * See the documentation of the other overload for details.
+      */
+    void setBoundaryOperator(
+            const BlockedBoundaryOperator<BasisFunctionType, ResultType>& boundaryOp);
+
 private:
     virtual Solution<BasisFunctionType, ResultType> solveImplNonblocked(
             const GridFunction<BasisFunctionType, ResultType>& rhs) const;
     virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
             const std::vector<GridFunction<BasisFunctionType, ResultType> >&
             rhs) const;
+    virtual std::vector<Solution<BasisFunctionType, ResultType> >
+    solveImplNonblockedMultiple(
+            const std::vector<GridFunction<BasisFunctionType, ResultType> >&
+            rhs) const;
+    virtual std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+    solveImplBlockedMultiple(
+            const std::vector<std::vector<GridFunction<BasisFunctionType,
+            ResultType> > >& rhs) const;
 
 private:
     struct Impl;
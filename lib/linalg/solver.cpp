@@ -177,6 +177,32 @@ void Solver<BasisFunctionType, ResultType>::constructBlockedGridFunction(
     }
 }
 
+template <typename BasisFunctionType, typename ResultType>
+std::vector<Solution<BasisFunctionType, ResultType> >
+Solver<BasisFunctionType, ResultType>::solveImplNonblockedMultiple(
+        const std::vector<GridFunction<BasisFunctionType, ResultType> >&
+        rhs) const
+{
+    std::vector<Solution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhs.size());
+    for (size_t i = 0; i < rhs.size(); ++i)
+        solutions.push_back(solveImplNonblocked(rhs[i]));
+    return solutions;
+}
+
+template <typename BasisFunctionType, typename ResultType>
+std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+Solver<BasisFunctionType, ResultType>::solveImplBlockedMultiple(
+        const std::vector<std::vector<GridFunction<BasisFunctionType,
+        ResultType> > >& rhs) const
+{
+    std::vector<BlockedSolution<BasisFunctionType, ResultType> > solutions;
+    solutions.reserve(rhs.size());
+    for (size_t i = 0; i < rhs.size(); ++i)
+        solutions.push_back(solveImplBlocked(rhs[i]));
+    return solutions;
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(Solver);
 
 } // namespace Bempp
@@ -98,6 +98,45 @@ public:
         return solveImplBlocked(rhs); 
     }
 
+    /** \brief Solve a standard (non-blocked) boundary integral equation for
+      * multiple right-hand sides.
+      *
+      * \param[in] rhs
+      *   <tt>vector</tt> of variables of type GridFunction, each representing
+      *   a separate right-hand side of the boundary integral equation.
+      *
+      * \return A <tt>vector</tt> of new Solution objects, one for each
+      * right-hand side.
+      *
+      * The default implementation solves the equations one after another.
+      * Subclasses may override it to treat all right-hand sides at once
+      * (e.g. by reusing a matrix factorisation).
+      */
+
+    std::vector<Solution<BasisFunctionType, ResultType> > solveMultiple(
+            const std::vector<GridFunction<BasisFunctionType, ResultType> >&
+            rhs) const {
+        return solveImplNonblockedMultiple(rhs);
+    }
+
+    /** \brief Solve a block-operator system of boundary integral equations
+      * for multiple right-hand sides.
+      *
+      * \param[in] rhs
+      *   <tt>vector</tt> of right-hand sides; each of them is a <tt>vector</tt>
+      *   of variables of type GridFunction, as in the solve() overload for
+      *   block systems.
+      *
+      * \return A <tt>vector</tt> of new BlockedSolution objects, one for each
+      * right-hand side.
+      */
+
+    std::vector<BlockedSolution<BasisFunctionType, ResultType> > solveMultiple(
+            const std::vector<std::vector<GridFunction<BasisFunctionType,
+            ResultType> > >& rhs) const {
+        return solveImplBlockedMultiple(rhs);
+    }
+
 protected:
     static void checkConsistency(
         const BoundaryOperator<BasisFunctionType, ResultType>& boundaryOp,
@@ -124,6 +163,14 @@ private:
     virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
             const std::vector<GridFunction<BasisFunctionType, ResultType> >&
             rhs) const = 0;    
+    virtual std::vector<Solution<BasisFunctionType, ResultType> >
+    solveImplNonblockedMultiple(
+            const std::vector<GridFunction<BasisFunctionType, ResultType> >&
+            rhs) const;
+    virtual std::vector<BlockedSolution<BasisFunctionType, ResultType> >
+    solveImplBlockedMultiple(
+            const std::vector<std::vector<GridFunction<BasisFunctionType,
+            ResultType> > >& rhs) const;
 };
 
 } // namespace Bempp
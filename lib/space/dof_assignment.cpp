@@ -0,0 +1,130 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "dof_assignment.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Bempp
+{
+
+namespace
+{
+
+const size_t GRAIN_SIZE = 1024;
+
+class Global2LocalDofLoopBody
+{
+public:
+    Global2LocalDofLoopBody(const std::vector<size_t>& offsets,
+                            const std::vector<LocalDof>& localDofs,
+                            std::vector<std::vector<LocalDof> >& global2localDofs) :
+        m_offsets(offsets), m_localDofs(localDofs),
+        m_global2localDofs(global2localDofs) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t g = r.begin(); g != r.end(); ++g)
+            m_global2localDofs[g].assign(
+                        m_localDofs.begin() + m_offsets[g],
+                        m_localDofs.begin() + m_offsets[g + 1]);
+    }
+
+private:
+    const std::vector<size_t>& m_offsets;
+    const std::vector<LocalDof>& m_localDofs;
+    std::vector<std::vector<LocalDof> >& m_global2localDofs;
+};
+
+class FlatLocal2LocalDofLoopBody
+{
+public:
+    FlatLocal2LocalDofLoopBody(
+            const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+            const std::vector<size_t>& offsets,
+            std::vector<LocalDof>& flatLocal2localDofs) :
+        m_local2globalDofs(local2globalDofs), m_offsets(offsets),
+        m_flatLocal2localDofs(flatLocal2localDofs) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t e = r.begin(); e != r.end(); ++e)
+            for (size_t dof = 0; dof < m_local2globalDofs[e].size(); ++dof)
+                m_flatLocal2localDofs[m_offsets[e] + dof] = LocalDof(e, dof);
+    }
+
+private:
+    const std::vector<std::vector<GlobalDofIndex> >& m_local2globalDofs;
+    const std::vector<size_t>& m_offsets;
+    std::vector<LocalDof>& m_flatLocal2localDofs;
+};
+
+} // namespace
+
+void invertLocal2GlobalDofMap(
+        const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+        size_t globalDofCount,
+        std::vector<std::vector<LocalDof> >& global2localDofs)
+{
+    const size_t elementCount = local2globalDofs.size();
+
+    // Store the local DOFs of all global DOFs in a single array (in
+    // compressed-row format); this takes a few sequential sweeps over
+    // integer arrays. The memory allocations needed to split this array
+    // into separate vectors are then done in parallel.
+    std::vector<size_t> offsets(globalDofCount + 1, 0);
+    for (size_t e = 0; e < elementCount; ++e)
+        for (size_t dof = 0; dof < local2globalDofs[e].size(); ++dof)
+            ++offsets[local2globalDofs[e][dof] + 1];
+    for (size_t g = 0; g < globalDofCount; ++g)
+        offsets[g + 1] += offsets[g];
+
+    std::vector<LocalDof> localDofs(offsets[globalDofCount]);
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    for (size_t e = 0; e < elementCount; ++e)
+        for (size_t dof = 0; dof < local2globalDofs[e].size(); ++dof)
+            localDofs[positions[local2globalDofs[e][dof]]++] =
+                    LocalDof(e, dof);
+
+    global2localDofs.clear();
+    global2localDofs.resize(globalDofCount);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, globalDofCount, GRAIN_SIZE),
+                      Global2LocalDofLoopBody(offsets, localDofs,
+                                              global2localDofs));
+}
+
+size_t createFlatLocal2LocalDofMap(
+        const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+        std::vector<LocalDof>& flatLocal2localDofs)
+{
+    const size_t elementCount = local2globalDofs.size();
+    std::vector<size_t> offsets(elementCount + 1, 0);
+    for (size_t e = 0; e < elementCount; ++e)
+        offsets[e + 1] = offsets[e] + local2globalDofs[e].size();
+
+    flatLocal2localDofs.resize(offsets[elementCount]);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, elementCount, GRAIN_SIZE),
+                      FlatLocal2LocalDofLoopBody(local2globalDofs, offsets,
+                                                 flatLocal2localDofs));
+    return offsets[elementCount];
+}
+
+} // namespace Bempp
@@ -0,0 +1,139 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_dof_assignment_hpp
+#define bempp_dof_assignment_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/shared_ptr.hpp"
+#include "../common/types.hpp"
+
+#include <boost/weak_ptr.hpp>
+#include <map>
+#include <memory>
+#include <tbb/mutex.h>
+#include <vector>
+
+namespace Bempp
+{
+
+/** \cond FORWARD_DECL */
+class Grid;
+/** \endcond */
+
+/** \ingroup space
+ *  \brief Thread-safe cache of DOF maps shared by all spaces of a given type
+ *  defined on the same grid.
+ *
+ *  \tparam DofMaps Type of the objects storing the DOF maps of a space.
+ *
+ *  The cache holds only weak pointers to the DOF maps, which are therefore
+ *  released together with the last space using them. Since each space keeps
+ *  a shared pointer to its grid, a grid cannot be destroyed (and its address
+ *  reused) while DOF maps built for it are still alive. */
+template <typename DofMaps>
+class DofMapCache
+{
+public:
+    /** \brief Return the DOF maps of \p grid.
+     *
+     *  If no DOF maps of \p grid are currently in use, they are created by
+     *  calling \p create(grid), which should return a
+     *  <tt>std::auto_ptr<DofMaps></tt>.
+     *
+     *  \p create is called without holding the cache's lock, so it may run
+     *  parallel algorithms and construct other spaces (possibly calling
+     *  get() recursively on the same thread), and maps of different grids
+     *  can be built concurrently. If two threads build the maps of the same
+     *  grid at the same time, both get the maps stored first. */
+    template <typename Creator>
+    shared_ptr<const DofMaps> get(const Grid& grid, Creator create) {
+        {
+            tbb::mutex::scoped_lock lock(m_mutex);
+            shared_ptr<const DofMaps> maps = find(grid);
+            if (maps)
+                return maps;
+        }
+        shared_ptr<const DofMaps> newMaps(create(grid).release());
+        tbb::mutex::scoped_lock lock(m_mutex);
+        shared_ptr<const DofMaps> maps = find(grid);
+        if (maps)
+            return maps;
+        m_entries[&grid] = newMaps;
+        return newMaps;
+    }
+
+private:
+    typedef std::map<const Grid*, boost::weak_ptr<const DofMaps> > Entries;
+
+    // Remove expired entries and return the live maps of grid, if any.
+    // Must be called with m_mutex held.
+    shared_ptr<const DofMaps> find(const Grid& grid) {
+        typename Entries::iterator it = m_entries.begin();
+        while (it != m_entries.end())
+            if (it->second.expired())
+                m_entries.erase(it++);
+            else
+                ++it;
+        it = m_entries.find(&grid);
+        if (it == m_entries.end())
+            return shared_ptr<const DofMaps>();
+        // The last user may have released the maps after the purge above
+        return it->second.lock();
+    }
+
+    tbb::mutex m_mutex;
+    Entries m_entries;
+};
+
+/** \ingroup space
+ *  \brief Construct the global-to-local DOF map of a space from its
+ *  local-to-global DOF map.
+ *
+ *  \param[in] local2globalDofs
+ *    Vector whose \c e'th element lists the global DOFs corresponding to the
+ *    local DOFs of the element with index \c e.
+ *  \param[in] globalDofCount
+ *    Number of global DOFs.
+ *  \param[out] global2localDofs
+ *    On output, vector whose \c g'th element lists the local DOFs
+ *    corresponding to the global DOF \c g, in order of increasing element
+ *    index.
+ *
+ *  The lists of local DOFs are filled in parallel. */
+void invertLocal2GlobalDofMap(
+        const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+        size_t globalDofCount,
+        std::vector<std::vector<LocalDof> >& global2localDofs);
+
+/** \ingroup space
+ *  \brief Construct the map of flat local DOFs to local DOFs of a space.
+ *
+ *  Local DOFs are numbered consecutively, element after element.
+ *
+ *  \returns The number of flat local DOFs. */
+size_t createFlatLocal2LocalDofMap(
+        const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+        std::vector<LocalDof>& flatLocal2localDofs);
+
+} // namespace Bempp
+
+#endif
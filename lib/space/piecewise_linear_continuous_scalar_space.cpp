@@ -19,6 +19,7 @@
 // THE SOFTWARE.
 
 #include "piecewise_linear_continuous_scalar_space.hpp"
+#include "dof_assignment.hpp"
 
 #include "../assembly/discrete_sparse_boundary_operator.hpp"
 #include "../common/boost_make_shared_fwd.hpp"
@@ -27,6 +28,7 @@
 #include "../grid/entity_iterator.hpp"
 #include "../grid/geometry.hpp"
 #include "../grid/grid.hpp"
+#include "../grid/grid_connectivity.hpp"
 #include "../grid/grid_view.hpp"
 #include "../grid/mapper.hpp"
 #include "../grid/vtk_writer.hpp"
@@ -36,14 +38,63 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 namespace Bempp
 {
 
+namespace
+{
+
+// Global DOFs of the elements of a piecewise linear space (i.e. indices of
+// their vertices)
+class Local2GlobalDofLoopBody
+{
+public:
+    Local2GlobalDofLoopBody(
+            const GridConnectivity& connectivity,
+            std::vector<std::vector<GlobalDofIndex> >& local2globalDofs) :
+        m_connectivity(connectivity), m_local2globalDofs(local2globalDofs) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        const arma::Mat<int>& elementCorners = m_connectivity.elementCorners();
+        for (size_t e = r.begin(); e != r.end(); ++e) {
+            const int vertexCount = m_connectivity.elementCornerCount(e);
+            std::vector<GlobalDofIndex>& globalDofs = m_local2globalDofs[e];
+            globalDofs.resize(vertexCount);
+            for (int i = 0; i < vertexCount; ++i)
+                globalDofs[i] = elementCorners(i, e);
+        }
+    }
+
+private:
+    const GridConnectivity& m_connectivity;
+    std::vector<std::vector<GlobalDofIndex> >& m_local2globalDofs;
+};
+
+} // namespace
+
+/** \cond PRIVATE */
+template <typename BasisFunctionType>
+struct PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::DofMaps
+{
+    std::vector<std::vector<GlobalDofIndex> > local2globalDofs;
+    std::vector<std::vector<LocalDof> > global2localDofs;
+    std::vector<LocalDof> flatLocal2localDofs;
+    size_t flatLocalDofCount;
+};
+/** \endcond */
+
+template <typename BasisFunctionType>
+DofMapCache<typename PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::DofMaps>
+PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::s_dofMapCache;
+
 template <typename BasisFunctionType>
 PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::
 PiecewiseLinearContinuousScalarSpace(const shared_ptr<const Grid>& grid) :
-    ScalarSpace<BasisFunctionType>(grid), m_flatLocalDofCount(0)
+    ScalarSpace<BasisFunctionType>(grid)
 {
     const int gridDim = grid->dim();
     if (gridDim != 1 && gridDim != 2)
@@ -121,83 +172,39 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::setElementVariant(
 template <typename BasisFunctionType>
 void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::assignDofsImpl()
 {
-    const int gridDim = domainDimension();
+    // The DOF maps depend only on the grid, so they are built once and
+    // shared by all spaces of this type defined on the same grid
+    m_dofMaps = s_dofMapCache.get(*this->grid(), &createDofMaps);
+}
 
-    const Mapper& elementMapper = m_view->elementMapper();
-    const IndexSet& indexSet = m_view->indexSet();
+template <typename BasisFunctionType>
+std::auto_ptr<typename PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::DofMaps>
+PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::createDofMaps(
+        const Grid& grid)
+{
+    const GridConnectivity& connectivity = grid.leafConnectivity();
+    const size_t elementCount = connectivity.elementCount();
+    std::auto_ptr<DofMaps> maps(new DofMaps);
 
     // Global DOF numbers will be identical with vertex indices.
     // Thus, the will be as many global DOFs as there are vertices.
-    int globalDofCount_ = m_view->entityCount(this->grid()->dim());
-    int elementCount = m_view->entityCount(0);
-
-//    // DEBUG
-//    {
-//        std::cout << "Vertices:\n" << std::endl;
-//        std::auto_ptr<EntityIterator<2> > vit = m_view->entityIterator<2>();
-//        const IndexSet& indexSet = m_view->indexSet();
-//        while (!vit->finished())
-//        {
-//            arma::Col<BasisFunctionType> vertex;
-//            vit->entity().geometry().center(vertex);
-//            std::cout << indexSet.entityIndex(vit->entity()) << ": "
-//                      << vertex(0) << " "
-//                      << vertex(1) << " "
-//                      << vertex(2) << std::endl;
-//            vit->next();
-//        }
-//    }
-
-    // (Re)initialise DOF maps
-    m_local2globalDofs.clear();
-    m_local2globalDofs.resize(elementCount);
-    m_global2localDofs.clear();
-    m_global2localDofs.resize(globalDofCount_);
-    // TODO: consider calling reserve(x) for each element of m_global2localDofs
-    // with x being the typical number of elements adjacent to a vertex in a
-    // grid of dimension gridDim
-
-    // Iterate over elements
-    std::auto_ptr<EntityIterator<0> > it = m_view->entityIterator<0>();
-    m_flatLocalDofCount = 0;
-    while (!it->finished())
-    {
-        const Entity<0>& element = it->entity();
-        EntityIndex elementIndex = elementMapper.entityIndex(element);
-
-        int vertexCount;
-        if (gridDim == 1)
-            vertexCount = element.template subEntityCount<1>();
-        else // gridDim == 2
-            vertexCount = element.template subEntityCount<2>();
-        m_flatLocalDofCount += vertexCount;
-
-        // List of global DOF indices corresponding to the local DOFs of the
-        // current element
-        std::vector<GlobalDofIndex>& globalDofs = m_local2globalDofs[elementIndex];
-        globalDofs.resize(vertexCount);
-        for (int i = 0; i < vertexCount; ++i)
-        {
-            GlobalDofIndex globalDofIndex = indexSet.subEntityIndex(element, i, gridDim);
-            globalDofs[i] = globalDofIndex;
-            m_global2localDofs[globalDofIndex].push_back(LocalDof(elementIndex, i));
-        }
-        it->next();
-    }
-
-    // Initialize the container mapping the flat local dof indices to
-    // local dof indices
-    m_flatLocal2localDofs.clear();
-    m_flatLocal2localDofs.reserve(m_flatLocalDofCount);
-    for (size_t e = 0; e < m_local2globalDofs.size(); ++e)
-        for (size_t dof = 0; dof < m_local2globalDofs[e].size(); ++dof)
-            m_flatLocal2localDofs.push_back(LocalDof(e, dof));
+    maps->local2globalDofs.resize(elementCount);
+    const size_t GRAIN_SIZE = 1024;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, elementCount, GRAIN_SIZE),
+                      Local2GlobalDofLoopBody(connectivity,
+                                              maps->local2globalDofs));
+    invertLocal2GlobalDofMap(maps->local2globalDofs,
+                             connectivity.vertexCount(),
+                             maps->global2localDofs);
+    maps->flatLocalDofCount = createFlatLocal2LocalDofMap(
+                maps->local2globalDofs, maps->flatLocal2localDofs);
+    return maps;
 }
 
 template <typename BasisFunctionType>
 size_t PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::globalDofCount() const
 {
-    return m_global2localDofs.size();
+    return m_dofMaps->global2localDofs.size();
 }
 
 template <typename BasisFunctionType>
@@ -211,7 +218,7 @@ size_t PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::flatLocalDofCoun
 //        return m_view->entityCount(GeometryType(GeometryType::cube, 2)) * 4 +
 //                m_view->entityCount(GeometryType(GeometryType::simplex, 2)) * 3;
 
-    return m_flatLocalDofCount;
+    return m_dofMaps->flatLocalDofCount;
 }
 
 template <typename BasisFunctionType>
@@ -220,7 +227,7 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::getGlobalDofs(
 {
     const Mapper& mapper = m_view->elementMapper();
     EntityIndex index = mapper.entityIndex(element);
-    dofs = m_local2globalDofs[index];
+    dofs = m_dofMaps->local2globalDofs[index];
 }
 
 template <typename BasisFunctionType>
@@ -230,7 +237,7 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::global2localDofs(
 {
     localDofs.resize(globalDofs.size());
     for (size_t i = 0; i < globalDofs.size(); ++i)
-        localDofs[i] = m_global2localDofs[globalDofs[i]];
+        localDofs[i] = m_dofMaps->global2localDofs[globalDofs[i]];
 }
 
 template <typename BasisFunctionType>
@@ -240,7 +247,7 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::flatLocal2localDof
 {
     localDofs.resize(flatLocalDofs.size());
     for (size_t i = 0; i < flatLocalDofs.size(); ++i)
-        localDofs[i] = m_flatLocal2localDofs[flatLocalDofs[i]];
+        localDofs[i] = m_dofMaps->flatLocal2localDofs[flatLocalDofs[i]];
 }
 
 template <typename BasisFunctionType>
@@ -293,7 +300,7 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::getFlatLocalDofPos
 {
     const int gridDim = domainDimension();
     const int worldDim = this->grid()->dimWorld();
-    positions.resize(m_flatLocalDofCount);
+    positions.resize(m_dofMaps->flatLocalDofCount);
 
     const IndexSet& indexSet = m_view->indexSet();
     int elementCount = m_view->entityCount(0);
@@ -312,10 +319,12 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::getFlatLocalDofPos
         it->next();
     }
 
+    const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs =
+            m_dofMaps->local2globalDofs;
     size_t flatLdofIndex = 0;
     if (gridDim == 1)
-        for (size_t e = 0; e < m_local2globalDofs.size(); ++e) {
-            for (size_t v = 0; v < m_local2globalDofs[e].size(); ++v) {
+        for (size_t e = 0; e < local2globalDofs.size(); ++e) {
+            for (size_t v = 0; v < local2globalDofs[e].size(); ++v) {
                 positions[flatLdofIndex].x = elementCenters(0, e);
                 positions[flatLdofIndex].y = elementCenters(1, e);
                 positions[flatLdofIndex].z = 0.;
@@ -323,15 +332,15 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::getFlatLocalDofPos
             }
         }
     else // gridDim == 2
-        for (size_t e = 0; e < m_local2globalDofs.size(); ++e) {
-            for (size_t v = 0; v < m_local2globalDofs[e].size(); ++v) {
+        for (size_t e = 0; e < local2globalDofs.size(); ++e) {
+            for (size_t v = 0; v < local2globalDofs[e].size(); ++v) {
                 positions[flatLdofIndex].x = elementCenters(0, e);
                 positions[flatLdofIndex].y = elementCenters(1, e);
                 positions[flatLdofIndex].z = elementCenters(2, e);
                 ++flatLdofIndex;
             }
         }
-    assert(flatLdofIndex == m_flatLocalDofCount);
+    assert(flatLdofIndex == m_dofMaps->flatLocalDofCount);
 }
 
 template <typename BasisFunctionType>
@@ -373,8 +382,8 @@ void PiecewiseLinearContinuousScalarSpace<BasisFunctionType>::dumpClusterIdsEx(
             bool exists = false;
             for (size_t fldof = 0; fldof < idCount; ++fldof) {
                 if (clusterIdsOfDofs[fldof] == id) {
-                    LocalDof ldof = m_flatLocal2localDofs[fldof];
-                    GlobalDofIndex gdof = m_local2globalDofs[ldof.entityIndex][ldof.dofIndex];
+                    LocalDof ldof = m_dofMaps->flatLocal2localDofs[fldof];
+                    GlobalDofIndex gdof = m_dofMaps->local2globalDofs[ldof.entityIndex][ldof.dofIndex];
                     data(row, gdof) = 1;
                     exists = true;
                 }
@@ -19,6 +19,7 @@
 // THE SOFTWARE.
 
 #include "raviart_thomas_0_vector_space.hpp"
+#include "dof_assignment.hpp"
 
 #include "../assembly/discrete_sparse_boundary_operator.hpp"
 #include "../common/boost_make_shared_fwd.hpp"
@@ -29,16 +30,101 @@
 #include "../grid/entity_iterator.hpp"
 #include "../grid/geometry.hpp"
 #include "../grid/grid.hpp"
+#include "../grid/grid_connectivity.hpp"
 #include "../grid/grid_view.hpp"
 #include "../grid/mapper.hpp"
 #include "../grid/vtk_writer.hpp"
 
 #include <stdexcept>
 #include <iostream>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 namespace Bempp
 {
 
+namespace
+{
+
+// Vertices (in Dune's local numbering) at the beginning and the end of the
+// edges of a triangle, oriented anticlockwise
+const int TRIANGLE_EDGE_VERTICES[3][2] = {{0, 1}, {2, 0}, {1, 2}};
+
+// Global DOFs of the (triangular) elements of a Raviart-Thomas space (i.e.
+// indices of their edges) and the weights of the corresponding basis
+// functions, which are set to -1 if the orientations of the local and global
+// edges differ
+template <typename BasisFunctionType>
+class Local2GlobalDofLoopBody
+{
+public:
+    Local2GlobalDofLoopBody(
+            const GridConnectivity& connectivity,
+            std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+            std::vector<std::vector<BasisFunctionType> >& local2globalDofWeights) :
+        m_connectivity(connectivity), m_local2globalDofs(local2globalDofs),
+        m_local2globalDofWeights(local2globalDofWeights) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        const arma::Mat<int>& elementCorners = m_connectivity.elementCorners();
+        const arma::Mat<int>& elementEdges = m_connectivity.elementEdges();
+        for (size_t e = r.begin(); e != r.end(); ++e) {
+            const int edgeCount = 3; // only triangles are supported
+            std::vector<GlobalDofIndex>& globalDofs = m_local2globalDofs[e];
+            std::vector<BasisFunctionType>& globalDofWeights =
+                    m_local2globalDofWeights[e];
+            globalDofs.resize(edgeCount);
+            globalDofWeights.resize(edgeCount);
+            for (int i = 0; i < edgeCount; ++i) {
+                const int vertex1Index =
+                        elementCorners(TRIANGLE_EDGE_VERTICES[i][0], e);
+                const int vertex2Index =
+                        elementCorners(TRIANGLE_EDGE_VERTICES[i][1], e);
+                globalDofs[i] = elementEdges(i, e);
+                globalDofWeights[i] = vertex1Index < vertex2Index ? 1. : -1.;
+            }
+        }
+    }
+
+private:
+    const GridConnectivity& m_connectivity;
+    std::vector<std::vector<GlobalDofIndex> >& m_local2globalDofs;
+    std::vector<std::vector<BasisFunctionType> >& m_local2globalDofWeights;
+};
+
+template <typename BasisFunctionType>
+class Global2LocalDofWeightLoopBody
+{
+public:
+    Global2LocalDofWeightLoopBody(
+            const std::vector<std::vector<BasisFunctionType> >& local2globalDofWeights,
+            const std::vector<std::vector<LocalDof> >& global2localDofs,
+            std::vector<std::vector<BasisFunctionType> >& global2localDofWeights) :
+        m_local2globalDofWeights(local2globalDofWeights),
+        m_global2localDofs(global2localDofs),
+        m_global2localDofWeights(global2localDofWeights) {
+    }
+
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+        for (size_t g = r.begin(); g != r.end(); ++g) {
+            const std::vector<LocalDof>& localDofs = m_global2localDofs[g];
+            std::vector<BasisFunctionType>& weights = m_global2localDofWeights[g];
+            weights.resize(localDofs.size());
+            for (size_t i = 0; i < localDofs.size(); ++i)
+                weights[i] = m_local2globalDofWeights[
+                        localDofs[i].entityIndex][localDofs[i].dofIndex];
+        }
+    }
+
+private:
+    const std::vector<std::vector<BasisFunctionType> >& m_local2globalDofWeights;
+    const std::vector<std::vector<LocalDof> >& m_global2localDofs;
+    std::vector<std::vector<BasisFunctionType> >& m_global2localDofWeights;
+};
+
+} // namespace
+
 /** \cond PRIVATE */
 template <typename BasisFunctionType>
 struct RaviartThomas0VectorSpace<BasisFunctionType>::Impl
@@ -54,10 +140,27 @@ struct RaviartThomas0VectorSpace<BasisFunctionType>::Impl
 };
 /** \endcond */
 
+/** \cond PRIVATE */
+template <typename BasisFunctionType>
+struct RaviartThomas0VectorSpace<BasisFunctionType>::DofMaps
+{
+    std::vector<std::vector<GlobalDofIndex> > local2globalDofs;
+    std::vector<std::vector<BasisFunctionType> > local2globalDofWeights;
+    std::vector<std::vector<LocalDof> > global2localDofs;
+    std::vector<std::vector<BasisFunctionType> > global2localDofWeights;
+    std::vector<LocalDof> flatLocal2localDofs;
+    size_t flatLocalDofCount;
+};
+/** \endcond */
+
+template <typename BasisFunctionType>
+DofMapCache<typename RaviartThomas0VectorSpace<BasisFunctionType>::DofMaps>
+RaviartThomas0VectorSpace<BasisFunctionType>::s_dofMapCache;
+
 template <typename BasisFunctionType>
 RaviartThomas0VectorSpace<BasisFunctionType>::
 RaviartThomas0VectorSpace(const shared_ptr<const Grid>& grid) :
-    Base(grid), m_impl(new Impl), m_flatLocalDofCount(0)
+    Base(grid), m_impl(new Impl)
 {
     if (grid->dim() != 2)
         throw std::invalid_argument("RaviartThomas0VectorSpace::"
@@ -139,101 +242,56 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::setElementVariant(
 template <typename BasisFunctionType>
 void RaviartThomas0VectorSpace<BasisFunctionType>::assignDofsImpl()
 {
-    const int gridDim = domainDimension();
+    // The DOF maps depend only on the grid, so they are built once and
+    // shared by all spaces of this type defined on the same grid
+    m_dofMaps = s_dofMapCache.get(*this->grid(), &createDofMaps);
+}
 
-    const Mapper& elementMapper = m_view->elementMapper();
-    const IndexSet& indexSet = m_view->indexSet();
+template <typename BasisFunctionType>
+std::auto_ptr<typename RaviartThomas0VectorSpace<BasisFunctionType>::DofMaps>
+RaviartThomas0VectorSpace<BasisFunctionType>::createDofMaps(const Grid& grid)
+{
+    const GridConnectivity& connectivity = grid.leafConnectivity();
+    const size_t elementCount = connectivity.elementCount();
+    const size_t globalDofCount_ = connectivity.edgeCount();
+    for (size_t e = 0; e < elementCount; ++e)
+        if (connectivity.elementCornerCount(e) != 3)
+            throw std::runtime_error(
+                "RaviartThomas0VectorSpace::"
+                "assignDofsImpl(): support for quadrilaterals not in place yet");
+    std::auto_ptr<DofMaps> maps(new DofMaps);
 
     // Global DOF numbers will be identical with edge indices.
     // Thus, the will be as many global DOFs as there are edges.
-    int globalDofCount_ = m_view->entityCount(1);
-    int elementCount = m_view->entityCount(0);
-
-    // (Re)initialise DOF maps
-    m_local2globalDofs.clear();
-    m_local2globalDofs.resize(elementCount);
-    m_local2globalDofWeights.clear();
-    m_local2globalDofWeights.resize(elementCount);
-    m_global2localDofs.clear();
-    m_global2localDofs.resize(globalDofCount_);
-    m_global2localDofWeights.clear();
-    m_global2localDofWeights.resize(globalDofCount_);
-    // TODO: consider calling reserve(2) for each element of m_global2localDofs
-
-    const int vertexCodim = 2;
-    const int edgeCodim = 1;
-    const int elementCodim = 0;
-
-    // Iterate over elements
-    std::auto_ptr<EntityIterator<elementCodim> > it =
-        m_view->entityIterator<elementCodim>();
-    m_flatLocalDofCount = 0;
-    while (!it->finished())
-    {
-        const Entity<elementCodim>& element = it->entity();
-        EntityIndex elementIndex = elementMapper.entityIndex(element);
-
-        const int vertexCount = element.template subEntityCount<vertexCodim>();
-        const int edgeCount = vertexCount;
-        m_flatLocalDofCount += edgeCount;
-
-        // List of global DOF indices corresponding to the local DOFs of the
-        // current element
-        std::vector<GlobalDofIndex>& globalDofs = m_local2globalDofs[elementIndex];
-        // List of weights of the local DOFs residing on the current element
-        std::vector<BasisFunctionType>& globalDofWeights =
-            m_local2globalDofWeights[elementIndex];
-        globalDofs.resize(edgeCount);
-        globalDofWeights.resize(edgeCount);
-        for (int i = 0; i < edgeCount; ++i)
-        {
-            GlobalDofIndex globalDofIndex =
-                indexSet.subEntityIndex(element, i, edgeCodim);
-            int vertex1Index, vertex2Index;
-            // Handle Dune's funny subentity indexing order
-            if (edgeCount == 3) {
-                if (i == 0) {
-                    vertex1Index = indexSet.subEntityIndex(element, 0, vertexCodim);
-                    vertex2Index = indexSet.subEntityIndex(element, 1, vertexCodim);
-                } else if (i == 1) {
-                    vertex1Index = indexSet.subEntityIndex(element, 2, vertexCodim);
-                    vertex2Index = indexSet.subEntityIndex(element, 0, vertexCodim);
-                } else { // i == 2
-                    vertex1Index = indexSet.subEntityIndex(element, 1, vertexCodim);
-                    vertex2Index = indexSet.subEntityIndex(element, 2, vertexCodim);
-                }
-            } else // edgeCount == 4
-                throw std::runtime_error(
-                    "RaviartThomas0VectorSpace::"
-                    "assignDofsImpl(): support for quadrilaterals not in place yet");
-            BasisFunctionType weight = vertex1Index < vertex2Index ? 1. : -1.;
-            globalDofs[i] = globalDofIndex;
-            globalDofWeights[i] = weight;
-            m_global2localDofs[globalDofIndex].push_back(LocalDof(elementIndex, i));
-            m_global2localDofWeights[globalDofIndex].push_back(weight);
-        }
-        it->next();
-    }
-
-    // Initialize the container mapping the flat local dof indices to
-    // local dof indices
-    m_flatLocal2localDofs.clear();
-    m_flatLocal2localDofs.reserve(m_flatLocalDofCount);
-    for (size_t e = 0; e < m_local2globalDofs.size(); ++e)
-        for (size_t dof = 0; dof < m_local2globalDofs[e].size(); ++dof)
-            m_flatLocal2localDofs.push_back(LocalDof(e, dof));
+    maps->local2globalDofs.resize(elementCount);
+    maps->local2globalDofWeights.resize(elementCount);
+    const size_t GRAIN_SIZE = 1024;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, elementCount, GRAIN_SIZE),
+                      Local2GlobalDofLoopBody<BasisFunctionType>(
+                          connectivity, maps->local2globalDofs,
+                          maps->local2globalDofWeights));
+    invertLocal2GlobalDofMap(maps->local2globalDofs, globalDofCount_,
+                             maps->global2localDofs);
+    maps->global2localDofWeights.resize(globalDofCount_);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, globalDofCount_, GRAIN_SIZE),
+                      Global2LocalDofWeightLoopBody<BasisFunctionType>(
+                          maps->local2globalDofWeights, maps->global2localDofs,
+                          maps->global2localDofWeights));
+    maps->flatLocalDofCount = createFlatLocal2LocalDofMap(
+                maps->local2globalDofs, maps->flatLocal2localDofs);
+    return maps;
 }
 
 template <typename BasisFunctionType>
 size_t RaviartThomas0VectorSpace<BasisFunctionType>::globalDofCount() const
 {
-    return m_global2localDofs.size();
+    return m_dofMaps->global2localDofs.size();
 }
 
 template <typename BasisFunctionType>
 size_t RaviartThomas0VectorSpace<BasisFunctionType>::flatLocalDofCount() const
 {
-    return m_flatLocalDofCount;
+    return m_dofMaps->flatLocalDofCount;
 }
 
 template <typename BasisFunctionType>
@@ -244,8 +302,8 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::getGlobalDofs(
 {
     const Mapper& mapper = m_view->elementMapper();
     EntityIndex index = mapper.entityIndex(element);
-    dofs = m_local2globalDofs[index];
-    dofWeights = m_local2globalDofWeights[index];
+    dofs = m_dofMaps->local2globalDofs[index];
+    dofWeights = m_dofMaps->local2globalDofWeights[index];
 }
 
 template <typename BasisFunctionType>
@@ -257,9 +315,9 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::global2localDofs(
     localDofs.resize(globalDofs.size());
     localDofWeights.resize(globalDofs.size());
     for (size_t i = 0; i < globalDofs.size(); ++i)
-        localDofs[i] = m_global2localDofs[globalDofs[i]];
+        localDofs[i] = m_dofMaps->global2localDofs[globalDofs[i]];
     for (size_t i = 0; i < globalDofs.size(); ++i)
-        localDofWeights[i] = m_global2localDofWeights[globalDofs[i]];
+        localDofWeights[i] = m_dofMaps->global2localDofWeights[globalDofs[i]];
 }
 
 template <typename BasisFunctionType>
@@ -269,7 +327,7 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::flatLocal2localDofs(
 {
     localDofs.resize(flatLocalDofs.size());
     for (size_t i = 0; i < flatLocalDofs.size(); ++i)
-        localDofs[i] = m_flatLocal2localDofs[flatLocalDofs[i]];
+        localDofs[i] = m_dofMaps->flatLocal2localDofs[flatLocalDofs[i]];
 }
 
 template <typename BasisFunctionType>
@@ -303,7 +361,7 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::getFlatLocalDofPositions(
 {
     const int gridDim = domainDimension();
     const int worldDim = this->grid()->dimWorld();
-    positions.resize(m_flatLocalDofCount);
+    positions.resize(m_dofMaps->flatLocalDofCount);
 
     const IndexSet& indexSet = m_view->indexSet();
     int elementCount = m_view->entityCount(0);
@@ -322,15 +380,17 @@ void RaviartThomas0VectorSpace<BasisFunctionType>::getFlatLocalDofPositions(
         it->next();
     }
 
+    const std::vector<std::vector<GlobalDofIndex> >& local2globalDofs =
+            m_dofMaps->local2globalDofs;
     size_t flatLdofIndex = 0;
-    for (size_t e = 0; e < m_local2globalDofs.size(); ++e)
-        for (size_t v = 0; v < m_local2globalDofs[e].size(); ++v) {
+    for (size_t e = 0; e < local2globalDofs.size(); ++e)
+        for (size_t v = 0; v < local2globalDofs[e].size(); ++v) {
             positions[flatLdofIndex].x = elementCenters(0, e);
             positions[flatLdofIndex].y = elementCenters(1, e);
             positions[flatLdofIndex].z = elementCenters(2, e);
             ++flatLdofIndex;
         }
-    assert(flatLdofIndex == m_flatLocalDofCount);
+    assert(flatLdofIndex == m_dofMaps->flatLocalDofCount);
 }
 
 template <typename BasisFunctionType>
@@ -37,6 +37,7 @@ namespace Bempp
 
 /** \cond FORWARD_DECL */
 class GridView;
+template <typename DofMaps> class DofMapCache;
 /** \endcond */
 
 /** \ingroup space
@@ -98,19 +99,25 @@ public:
             DofType dofType) const;
 
 private:
+    /** \cond PRIVATE */
+    struct DofMaps;
+    /** \endcond */
+
     void assignDofsImpl();
+    static std::auto_ptr<DofMaps> createDofMaps(const Grid& grid);
+
+    // DOF maps of all spaces of this type, indexed by grid. A static data
+    // member rather than a function-local static, since initialisation of
+    // the latter is not thread-safe in C++03
+    static DofMapCache<DofMaps> s_dofMapCache;
 
 private:
     struct Impl;
     boost::scoped_ptr<Impl> m_impl;
     std::auto_ptr<GridView> m_view;
     Fiber::RaviartThomas0Basis<3, BasisFunctionType> m_triangleBasis;
-    std::vector<std::vector<GlobalDofIndex> > m_local2globalDofs;
-    std::vector<std::vector<BasisFunctionType> > m_local2globalDofWeights;
-    std::vector<std::vector<LocalDof> > m_global2localDofs;
-    std::vector<std::vector<BasisFunctionType> > m_global2localDofWeights;
-    std::vector<LocalDof> m_flatLocal2localDofs;
-    size_t m_flatLocalDofCount;
+    // Shared by all spaces of this type defined on the same grid
+    shared_ptr<const DofMaps> m_dofMaps;
 };
 
 } // namespace Bempp
@@ -18,8 +18,6 @@ namespace Bempp
 %define BEMPP_ACA_FREE_FUNCTIONS(VALUE,PY_VALUE)
 namespace Bempp 
 {
-    %template(acaOperatorApproximateLuInverse_## PY_VALUE) 
-        acaOperatorApproximateLuInverse< VALUE >;
     %template(scaledAcaOperator_## PY_VALUE)
          scaledAcaOperator< VALUE >;
     %template(acaOperatorSum_## PY_VALUE) 
@@ -30,3 +28,26 @@ namespace Bempp
 BEMPP_ITERATE_OVER_BASIS_TYPES(BEMPP_ACA_FREE_FUNCTIONS)
 
 #endif // WITH_AHMED
+
+%{
+#include "assembly/h_matrix_approximate_lu_inverse.hpp"
+%}
+
+namespace Bempp
+{
+    %ignore HMatrixApproximateLuInverse;
+}
+
+#define shared_ptr boost::shared_ptr
+%include "assembly/h_matrix_approximate_lu_inverse.hpp"
+#undef shared_ptr
+
+%define BEMPP_H_MATRIX_LU_FREE_FUNCTIONS(VALUE,PY_VALUE)
+namespace Bempp
+{
+    %template(acaOperatorApproximateLuInverse_## PY_VALUE)
+        acaOperatorApproximateLuInverse< VALUE >;
+}
+%enddef
+
+BEMPP_ITERATE_OVER_BASIS_TYPES(BEMPP_H_MATRIX_LU_FREE_FUNCTIONS)
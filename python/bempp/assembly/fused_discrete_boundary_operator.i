@@ -0,0 +1,15 @@
+%{
+#include "assembly/fused_discrete_boundary_operator.hpp"
+%}
+
+namespace Bempp {
+
+#define shared_ptr boost::shared_ptr
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType> >
+fusedDiscreteOperator(const shared_ptr<const DiscreteBoundaryOperator<ValueType> >& op);
+#undef shared_ptr
+
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_VALUE(fusedDiscreteOperator)
+
+}
@@ -2,10 +2,14 @@
 #include "assembly/grid_function.hpp"
 #include "assembly/surface_normal_dependent_function.hpp"
 #include "assembly/surface_normal_independent_function.hpp"
+#include "assembly/vectorized_surface_normal_dependent_function.hpp"
+#include "assembly/vectorized_surface_normal_independent_function.hpp"
 %}
 
 %newobject gridFunctionFromPythonSurfaceNormalIndependentFunctor;
 %newobject gridFunctionFromPythonSurfaceNormalDependentFunctor;
+%newobject gridFunctionFromPythonVectorizedSurfaceNormalIndependentFunctor;
+%newobject gridFunctionFromPythonVectorizedSurfaceNormalDependentFunctor;
 
 namespace Bempp {
 
@@ -62,6 +66,32 @@ gridFunctionFromPythonSurfaceNormalDependentFunctor(
         surfaceNormalDependentFunction(functor));
 }
 
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType>*
+gridFunctionFromPythonVectorizedSurfaceNormalIndependentFunctor(
+    const boost::shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
+    const boost::shared_ptr<const Space<BasisFunctionType> >& space,
+    const boost::shared_ptr<const Space<BasisFunctionType> >& dualSpace,
+    const PythonVectorizedSurfaceNormalIndependentFunctor<ResultType>& functor)
+{
+    return new GridFunction<BasisFunctionType, ResultType>(
+        context, space, dualSpace,
+        vectorizedSurfaceNormalIndependentFunction(functor));
+}
+
+template <typename BasisFunctionType, typename ResultType>
+GridFunction<BasisFunctionType, ResultType>*
+gridFunctionFromPythonVectorizedSurfaceNormalDependentFunctor(
+    const boost::shared_ptr<const Context<BasisFunctionType, ResultType> >& context,
+    const boost::shared_ptr<const Space<BasisFunctionType> >& space,
+    const boost::shared_ptr<const Space<BasisFunctionType> >& dualSpace,
+    const PythonVectorizedSurfaceNormalDependentFunctor<ResultType>& functor)
+{
+    return new GridFunction<BasisFunctionType, ResultType>(
+        context, space, dualSpace,
+        vectorizedSurfaceNormalDependentFunction(functor));
+}
+
 template <typename BasisFunctionType, typename ResultType>
 GridFunction<BasisFunctionType, ResultType>*
 gridFunctionFromCoefficients(
@@ -253,6 +283,8 @@ BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(GridFunction);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(uninitializedGridFunction);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromPythonSurfaceNormalIndependentFunctor);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromPythonSurfaceNormalDependentFunctor);
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromPythonVectorizedSurfaceNormalIndependentFunctor);
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromPythonVectorizedSurfaceNormalDependentFunctor);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromCoefficients);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(gridFunctionFromProjections);
 
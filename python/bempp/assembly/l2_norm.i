@@ -37,6 +37,36 @@ L2NormOfDifferenceFromPythonSurfaceNormalDependentFunctor(
                               options);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+typename ScalarTraits<BasisFunctionType>::RealType
+L2NormOfDifferenceFromPythonVectorizedSurfaceNormalIndependentFunctor(
+        const GridFunction<BasisFunctionType, ResultType>& gridFunction,
+        const PythonVectorizedSurfaceNormalIndependentFunctor<ResultType>& functor,
+        const Fiber::QuadratureStrategy<
+            BasisFunctionType, ResultType, GeometryFactory>& quadStrategy,
+        const EvaluationOptions& options)
+{
+    return L2NormOfDifference(gridFunction,
+                              vectorizedSurfaceNormalIndependentFunction(functor),
+                              quadStrategy,
+                              options);
+}
+
+template <typename BasisFunctionType, typename ResultType>
+typename ScalarTraits<BasisFunctionType>::RealType
+L2NormOfDifferenceFromPythonVectorizedSurfaceNormalDependentFunctor(
+        const GridFunction<BasisFunctionType, ResultType>& gridFunction,
+        const PythonVectorizedSurfaceNormalDependentFunctor<ResultType>& functor,
+        const Fiber::QuadratureStrategy<
+            BasisFunctionType, ResultType, GeometryFactory>& quadStrategy,
+        const EvaluationOptions& options)
+{
+    return L2NormOfDifference(gridFunction,
+                              vectorizedSurfaceNormalDependentFunction(functor),
+                              quadStrategy,
+                              options);
+}
+
 } // namespace Bempp
 
 %}
@@ -46,5 +76,7 @@ namespace Bempp
 
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(L2NormOfDifferenceFromPythonSurfaceNormalIndependentFunctor);
 BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(L2NormOfDifferenceFromPythonSurfaceNormalDependentFunctor);
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(L2NormOfDifferenceFromPythonVectorizedSurfaceNormalIndependentFunctor);
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(L2NormOfDifferenceFromPythonVectorizedSurfaceNormalDependentFunctor);
 
 } // namespace Bempp
\ No newline at end of file
@@ -0,0 +1,24 @@
+%{
+#include "assembly/near_field_approximate_inverse.hpp"
+%}
+
+namespace Bempp
+{
+    %ignore NearFieldApproximateInverse;
+}
+
+#define shared_ptr boost::shared_ptr
+%include "assembly/near_field_approximate_inverse.hpp"
+#undef shared_ptr
+
+%define BEMPP_NEAR_FIELD_INVERSE_FREE_FUNCTIONS(VALUE,PY_VALUE)
+namespace Bempp
+{
+    %template(nearFieldSparseApproximateInverse_## PY_VALUE)
+        nearFieldSparseApproximateInverse< VALUE >;
+    %template(nearFieldBlockJacobiInverse_## PY_VALUE)
+        nearFieldBlockJacobiInverse< VALUE >;
+}
+%enddef
+
+BEMPP_ITERATE_OVER_BASIS_TYPES(BEMPP_NEAR_FIELD_INVERSE_FREE_FUNCTIONS)
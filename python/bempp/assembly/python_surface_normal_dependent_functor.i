@@ -136,6 +136,25 @@ public:
 
 %}
 
+%{
+
+#include "fiber/function.hpp"
+
+namespace Fiber
+{
+
+// The functor calls into the Python interpreter, which must not be entered
+// concurrently from threads other than the one that called into BEM++
+template <typename ValueType>
+struct IsFunctorThreadSafe<Bempp::PythonSurfaceNormalDependentFunctor<ValueType> >
+{
+    static const bool value = false;
+};
+
+} // namespace Fiber
+
+%}
+
 namespace Bempp
 {
 
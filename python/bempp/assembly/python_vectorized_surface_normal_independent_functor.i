@@ -0,0 +1,141 @@
+%inline %{
+
+namespace Bempp
+{
+
+// Python functor evaluated at many points at once. The callable is passed a
+// 2D array whose columns are the points at which the function is to be
+// evaluated and should return a 2D array whose columns are the
+// corresponding function values (or a 1D array of values if the function
+// is scalar-valued).
+template <typename ValueType_>
+class PythonVectorizedSurfaceNormalIndependentFunctor
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    PythonVectorizedSurfaceNormalIndependentFunctor(
+        PyObject *pyFunc, int argumentDimension, int resultDimension) :
+            m_pyFunc(pyFunc),
+            m_argumentDimension(argumentDimension),
+            m_resultDimension(resultDimension) {
+        if (!PyCallable_Check(pyFunc))
+            PyErr_SetString(PyExc_TypeError, "Python object is not callable");
+        Py_INCREF(m_pyFunc); // Increase shared pointer reference count
+    }
+
+    ~PythonVectorizedSurfaceNormalIndependentFunctor() {
+        Py_DECREF(m_pyFunc);
+    }
+
+    int argumentDimension() const {
+        return m_argumentDimension;
+    }
+
+    int resultDimension() const {
+        return m_resultDimension;
+    }
+
+    void evaluate(const arma::Mat<CoordinateType>& points,
+                  arma::Mat<ValueType>& result_) const
+    {
+        const int valueNumpyType = PythonScalarTraits<ValueType>::numpyType;
+        const size_t pointCount = points.n_cols;
+
+        // Create the input array
+        PyObject* pyPoints = createCoordinateArray(points);
+        if (!pyPoints)
+            throw std::runtime_error("Point array creation failed");
+
+        // Call into Python
+        PyObject* pyReturnVal = PyObject_CallFunctionObjArgs(
+            m_pyFunc, pyPoints, NULL);
+        Py_XDECREF(pyPoints);
+        if (!pyReturnVal)
+            throw std::runtime_error("Callable did not execute successfully");
+
+        int is_new_object;
+        PyArrayObject* pyReturnValArray =
+            obj_to_array_fortran_allow_conversion(
+                pyReturnVal, valueNumpyType, &is_new_object);
+        if (!pyReturnValArray) {
+            Py_XDECREF(pyReturnVal);
+            throw std::runtime_error("Result from callable cannot be converted to array.");
+        }
+
+        // Check size of array
+        bool sizeOk = false;
+        if (array_numdims(pyReturnValArray) == 2)
+            sizeOk = (array_size(pyReturnValArray, 0) == (npy_intp) m_resultDimension &&
+                      array_size(pyReturnValArray, 1) == (npy_intp) pointCount);
+        else if (array_numdims(pyReturnValArray) == 1)
+            sizeOk = (m_resultDimension == 1 &&
+                      array_size(pyReturnValArray, 0) == (npy_intp) pointCount);
+
+        // Copy data back
+        if (sizeOk) {
+            const ValueType* data = (const ValueType*) array_data(pyReturnValArray);
+            std::copy(data, data + m_resultDimension * pointCount,
+                      result_.memptr());
+        }
+
+        // Clean up
+        if (is_new_object)
+            Py_XDECREF(pyReturnValArray);
+        Py_XDECREF(pyReturnVal);
+
+        if (!sizeOk)
+            throw std::runtime_error("Return array has wrong dimensions");
+    }
+
+private:
+    static PyObject* createCoordinateArray(
+        const arma::Mat<CoordinateType>& coords)
+    {
+        const int coordinateNumpyType = PythonScalarTraits<CoordinateType>::numpyType;
+        npy_intp dims[2];
+        dims[0] = coords.n_rows;
+        dims[1] = coords.n_cols;
+        PyObject* pyCoords = PyArray_ZEROS(2, dims, coordinateNumpyType, NPY_FORTRAN);
+        if (pyCoords)
+            std::copy(coords.begin(), coords.end(),
+                      (CoordinateType*) array_data(pyCoords));
+        return pyCoords;
+    }
+
+private:
+    PyObject* m_pyFunc;
+    int m_argumentDimension;
+    int m_resultDimension;
+};
+
+} // namespace Bempp
+
+%}
+
+%{
+
+#include "fiber/function.hpp"
+
+namespace Fiber
+{
+
+// The functor calls into the Python interpreter, which must not be entered
+// concurrently from threads other than the one that called into BEM++
+template <typename ValueType>
+struct IsFunctorThreadSafe<Bempp::PythonVectorizedSurfaceNormalIndependentFunctor<ValueType> >
+{
+    static const bool value = false;
+};
+
+} // namespace Fiber
+
+%}
+
+namespace Bempp
+{
+
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_VALUE(PythonVectorizedSurfaceNormalIndependentFunctor);
+
+} // namespace Bempp
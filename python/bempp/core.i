@@ -149,6 +149,8 @@ AUTO_PTR_TYPEMAPS_FOR_CLASS_TEMPLATED_ON_RESULT(Bempp::InterpolatedFunction)
 %include "assembly/symmetry.i"
 %include "assembly/python_surface_normal_independent_functor.i"
 %include "assembly/python_surface_normal_dependent_functor.i"
+%include "assembly/python_vectorized_surface_normal_independent_functor.i"
+%include "assembly/python_vectorized_surface_normal_dependent_functor.i"
 %include "assembly/discrete_boundary_operator.i"
 %include "assembly/context.i"
 %include "assembly/grid_function.i"
@@ -171,8 +173,10 @@ AUTO_PTR_TYPEMAPS_FOR_CLASS_TEMPLATED_ON_RESULT(Bempp::InterpolatedFunction)
 %include "assembly/blocked_operator_structure.i"
 %include "assembly/blocked_boundary_operator.i"
 %include "assembly/discrete_aca_boundary_operator.i"
+%include "assembly/near_field_approximate_inverse.i"
 %include "assembly/discrete_dense_boundary_operator.i"
 %include "assembly/discrete_inverse_sparse_boundary_operator.i"
+%include "assembly/fused_discrete_boundary_operator.i"
 
 // Linear algebra
 %include "linalg/parameter_list.i"
@@ -181,5 +185,6 @@ AUTO_PTR_TYPEMAPS_FOR_CLASS_TEMPLATED_ON_RESULT(Bempp::InterpolatedFunction)
 %include "linalg/blocked_solution.i"
 %include "linalg/solver.i"
 %include "linalg/preconditioner.i"
+%include "linalg/calderon_preconditioner.i"
 %include "linalg/default_iterative_solver.i"
 
@@ -41,8 +41,41 @@ namespace Bempp
         %}
 
 
-    // this function is only for internal use
+    %apply arma::Col<int>& ARGOUT_COL {
+        arma::Col<int>& domainIndices
+    };
+    void getDomainIndices(arma::Col<int>& domainIndices) const {
+        std::vector<int> indices;
+        $self->getDomainIndices(indices);
+        domainIndices.set_size(indices.size());
+        std::copy(indices.begin(), indices.end(), domainIndices.begin());
+    }
+    %clear arma::Col<int>& domainIndices;
+    %ignore getDomainIndices;
+
+    %apply arma::Col<int>& ARGOUT_COL {
+        arma::Col<int>& originalIndices
+    };
+    void getOriginalElementIndices(arma::Col<int>& originalIndices) const {
+        std::vector<int> indices;
+        $self->getOriginalElementIndices(indices);
+        originalIndices.set_size(indices.size());
+        std::copy(indices.begin(), indices.end(), originalIndices.begin());
+    }
+    void getOriginalVertexIndices(arma::Col<int>& originalIndices) const {
+        std::vector<int> indices;
+        $self->getOriginalVertexIndices(indices);
+        originalIndices.set_size(indices.size());
+        std::copy(indices.begin(), indices.end(), originalIndices.begin());
+    }
+    %clear arma::Col<int>& originalIndices;
+    %ignore getOriginalElementIndices;
+    %ignore getOriginalVertexIndices;
+
+    // these functions are only for internal use
+    %ignore setOriginalIndices;
     %ignore elementGeometryFactory;
+    %ignore boundingVolumeHierarchy;
 }
 
 %apply const arma::Mat<float>& IN_MAT {
@@ -53,6 +86,12 @@ namespace Bempp
 };
 
 %ignore areInside(const Grid& grid, const arma::Mat<float>& points);
+%ignore areInside(const Grid& grid, const arma::Mat<double>& points,
+                  std::vector<char>& insideMask,
+                  std::vector<int>* nearestElements);
+%ignore areInside(const Grid& grid, const arma::Mat<float>& points,
+                  std::vector<char>& insideMask,
+                  std::vector<int>* nearestElements);
 
 } // namespace Bempp
 
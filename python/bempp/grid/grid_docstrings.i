@@ -46,6 +46,45 @@ Levels are numbered 0 ... maxLevel() with 0 the coarsest level."
 "Grid's global id set."
 %enddef
 
+%define Grid_getDomainIndices_autodoc_docstring
+"getDomainIndices(self) -> ndarray"
+%enddef
+
+%define Grid_getDomainIndices_docstring
+"Domain indices of the leaf elements of the grid.
+
+Return an array whose ith element is the index of the domain (e.g. the
+Gmsh physical entity) to which the element with index i belongs. All
+indices are zero if no domain information was supplied when the grid
+was constructed."
+%enddef
+
+%define Grid_getOriginalElementIndices_autodoc_docstring
+"getOriginalElementIndices(self) -> ndarray"
+%enddef
+
+%define Grid_getOriginalElementIndices_docstring
+"Original indices of the leaf elements of the grid.
+
+Return an array whose ith element is the index that the element with
+index i had in the arrays or the file from which the grid was created.
+The two indices differ only if the grid was created with an
+elementOrdering other than 'original'."
+%enddef
+
+%define Grid_getOriginalVertexIndices_autodoc_docstring
+"getOriginalVertexIndices(self) -> ndarray"
+%enddef
+
+%define Grid_getOriginalVertexIndices_docstring
+"Original indices of the leaf vertices of the grid.
+
+Return an array whose ith element is the index that the vertex with
+index i had in the arrays or the file from which the grid was created.
+The two indices differ only if the grid was created with an
+elementOrdering other than 'original'."
+%enddef
+
 %define Grid_refineGlobally_docstring
 "Refine the grid refCount times using the default refinement rule.
 
@@ -124,6 +163,9 @@ DECLARE_METHOD_DOCSTRING(Grid, boundarySegmentCount, 0);
 DECLARE_METHOD_DOCSTRING(Grid, levelView, 0);
 DECLARE_METHOD_DOCSTRING(Grid, leafView, 0);
 DECLARE_METHOD_DOCSTRING(Grid, globalIdSet, 1);
+DECLARE_METHOD_DOCSTRING(Grid, getDomainIndices, 0);
+DECLARE_METHOD_DOCSTRING(Grid, getOriginalElementIndices, 0);
+DECLARE_METHOD_DOCSTRING(Grid, getOriginalVertexIndices, 0);
 DECLARE_METHOD_DOCSTRING(Grid, refineGlobally, 1);
 DECLARE_METHOD_DOCSTRING(Grid, mark, 0);
 DECLARE_METHOD_DOCSTRING(Grid, getMark, 0);
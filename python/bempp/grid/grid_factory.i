@@ -21,6 +21,20 @@ inline void makeGridParameters(GridParameters& params, const std::string& topolo
         throw std::runtime_error("Invalid grid topology requested");
 }
 
+inline void makeGridParameters(GridParameters& params, const std::string& topology,
+                               const std::string& elementOrdering)
+{
+    makeGridParameters(params, topology);
+    if (elementOrdering == "original")
+        params.elementOrdering = Bempp::GridParameters::ORIGINAL_ORDERING;
+    else if (elementOrdering == "morton")
+        params.elementOrdering = Bempp::GridParameters::MORTON_ORDERING;
+    else if (elementOrdering == "hilbert")
+        params.elementOrdering = Bempp::GridParameters::HILBERT_ORDERING;
+    else
+        throw std::runtime_error("Invalid element ordering requested");
+}
+
 } // namespace Bempp
 %}
 
@@ -50,13 +64,15 @@ namespace Bempp
   //    val.topology = args[0]
   //	%}
 
+    %feature("compactdefaultargs") createStructuredGrid;
     static boost::shared_ptr<Bempp::Grid> createStructuredGrid(
             const std::string& topology,
             const arma::Col<Bempp::ctype>& lowerLeft, 
             const arma::Col<Bempp::ctype>& upperRight,
-            const arma::Col<unsigned int>& nElements) {
+            const arma::Col<unsigned int>& nElements,
+            const std::string& elementOrdering="original") {
         Bempp::GridParameters params;
-        makeGridParameters(params, topology);
+        makeGridParameters(params, topology, elementOrdering);
         return Bempp::GridFactory::createStructuredGrid(params, lowerLeft, upperRight, nElements);
     }
     %clear const arma::Col<ctype>& lowerLeft; 
@@ -71,12 +87,82 @@ namespace Bempp
     %feature("compactdefaultargs") importGmshGrid;
     static boost::shared_ptr<Bempp::Grid> importGmshGrid(
             const std::string& topology, const std::string& fileName, 
-            bool verbose=false, bool insertBoundarySegments=false) {
+            bool verbose=false, bool insertBoundarySegments=false,
+            const std::string& elementOrdering="original") {
         Bempp::GridParameters params;
-        makeGridParameters(params, topology);
+        makeGridParameters(params, topology, elementOrdering);
         return Bempp::GridFactory::importGmshGrid(params, fileName, verbose, insertBoundarySegments);
     }
     %ignore importGmshGrid;
+
+    // The IN_MAT and IN_COL typemaps wrap Fortran-ordered NumPy arrays of
+    // the right type without copying them
+    %apply const arma::Mat<double>& IN_MAT {
+        const arma::Mat<double>& vertices
+    };
+    %apply const arma::Mat<int>& IN_MAT {
+        const arma::Mat<int>& elementCorners
+    };
+    %apply const arma::Col<int>& IN_COL {
+        const arma::Col<int>& domainIndices
+    };
+
+    %feature("compactdefaultargs") createGridFromConnectivityArrays;
+    %feature("compactdefaultargs") createFlatGridFromConnectivityArrays;
+    static boost::shared_ptr<Bempp::Grid> createGridFromConnectivityArrays(
+            const std::string& topology,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const std::string& elementOrdering="original") {
+        Bempp::GridParameters params;
+        makeGridParameters(params, topology, elementOrdering);
+        return Bempp::GridFactory::createGridFromConnectivityArrays(
+            params, vertices, elementCorners);
+    }
+
+    static boost::shared_ptr<Bempp::Grid> createGridFromConnectivityArrays(
+            const std::string& topology,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const arma::Col<int>& domainIndices,
+            const std::string& elementOrdering="original") {
+        Bempp::GridParameters params;
+        makeGridParameters(params, topology, elementOrdering);
+        std::vector<int> domainIndicesVector(
+            domainIndices.memptr(), domainIndices.memptr() + domainIndices.n_elem);
+        return Bempp::GridFactory::createGridFromConnectivityArrays(
+            params, vertices, elementCorners, domainIndicesVector);
+    }
+
+    static boost::shared_ptr<Bempp::Grid> createFlatGridFromConnectivityArrays(
+            const std::string& topology,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const std::string& elementOrdering="original") {
+        Bempp::GridParameters params;
+        makeGridParameters(params, topology, elementOrdering);
+        return Bempp::GridFactory::createFlatGridFromConnectivityArrays(
+            params, vertices, elementCorners);
+    }
+
+    static boost::shared_ptr<Bempp::Grid> createFlatGridFromConnectivityArrays(
+            const std::string& topology,
+            const arma::Mat<double>& vertices,
+            const arma::Mat<int>& elementCorners,
+            const arma::Col<int>& domainIndices,
+            const std::string& elementOrdering="original") {
+        Bempp::GridParameters params;
+        makeGridParameters(params, topology, elementOrdering);
+        std::vector<int> domainIndicesVector(
+            domainIndices.memptr(), domainIndices.memptr() + domainIndices.n_elem);
+        return Bempp::GridFactory::createFlatGridFromConnectivityArrays(
+            params, vertices, elementCorners, domainIndicesVector);
+    }
+    %clear const arma::Mat<double>& vertices;
+    %clear const arma::Mat<int>& elementCorners;
+    %clear const arma::Col<int>& domainIndices;
+    %ignore createGridFromConnectivityArrays;
+    %ignore createFlatGridFromConnectivityArrays;
 }
 
 } // namespace Bempp
@@ -8,7 +8,8 @@ fly and to import grids from existing files."
 %enddef
 
 %define GridFactory_createStructuredGrid_autodoc_docstring
-"createStructuredGrid(topology, lowerLeft, upperRight, nElements) -> Grid"
+"createStructuredGrid(topology, lowerLeft, upperRight, nElements,
+    elementOrdering = 'original') -> Grid"
 %enddef
 
 %define GridFactory_createStructuredGrid_docstring
@@ -24,6 +25,15 @@ fly and to import grids from existing files."
         Coordinates of the upper right corner of the grid.
    - nElements (tuple)
         Number of grid subdivisions in each direction.
+   - elementOrdering (string, default: 'original')
+        Order in which the elements and vertices of the grid are
+        numbered (one of 'original', 'morton', 'hilbert'). With
+        'morton' and 'hilbert', elements are sorted along a
+        space-filling curve through their centroids, which improves
+        the locality of memory accesses during assembly. The
+        original indices can be retrieved with
+        Grid.getOriginalElementIndices() and
+        Grid.getOriginalVertexIndices().
 
 This function constructs a regular structured grid. Its dimension,
 dimGrid, and the dimension of the surrounding space, dimWorld, are
@@ -41,9 +51,61 @@ subdivided into nElements(n) segments.
 *Note:* Currently only grids with triangular topology are supported."
 %enddef
 
+%define GridFactory_createGridFromConnectivityArrays_autodoc_docstring
+"createGridFromConnectivityArrays(topology, vertices, elementCorners,
+    domainIndices = None, elementOrdering = 'original') -> Grid"
+%enddef
+
+%define GridFactory_createGridFromConnectivityArrays_docstring
+"Construct a grid from arrays of vertices and elements.
+
+*Parameters:*
+   - topology (string)
+        Topology of the grid to be constructed (currently only
+        'triangular' is supported).
+   - vertices (2D array)
+        Array of dimensions (3, m) whose (i, j)th element is the ith
+        coordinate of the jth vertex.
+   - elementCorners (2D array of ints)
+        Array of dimensions (3, n) whose jth column contains the indices
+        of the vertices of the jth element.
+   - domainIndices (1D array of ints, optional)
+        Array of length n whose jth element is the index of the domain
+        to which the jth element belongs.
+   - elementOrdering (string, default: 'original')
+        Order in which the elements and vertices of the grid are
+        numbered (one of 'original', 'morton', 'hilbert'). With
+        'morton' and 'hilbert', elements are sorted along a
+        space-filling curve through their centroids, which improves
+        the locality of memory accesses during assembly. The
+        original indices can be retrieved with
+        Grid.getOriginalElementIndices() and
+        Grid.getOriginalVertexIndices().
+
+Arrays of type float64 (vertices) and int32 (elementCorners and
+domainIndices) stored in Fortran order are used without being copied.
+In particular, this is the case for the transposes of C-ordered arrays
+of dimensions (m, 3) and (n, 3)."
+%enddef
+
+%define GridFactory_createFlatGridFromConnectivityArrays_autodoc_docstring
+"createFlatGridFromConnectivityArrays(topology, vertices, elementCorners,
+    domainIndices = None, elementOrdering = 'original') -> Grid"
+%enddef
+
+%define GridFactory_createFlatGridFromConnectivityArrays_docstring
+"Construct a grid not based on Dune from arrays of vertices and elements.
+
+The parameters have the same meaning as in
+createGridFromConnectivityArrays(). The connectivity of the returned
+grid is stored in flat arrays, which makes iteration over its entities
+cheaper than for grids wrapping Dune grids. Such a grid cannot be
+refined."
+%enddef
+
 %define GridFactory_importGmshGrid_autodoc_docstring
 "importGmshGrid(topology, fileName, verbose = True,
-    insertBoundarySegments = False) -> Grid"
+    insertBoundarySegments = False, elementOrdering = 'original') -> Grid"
 %enddef
 
 %define GridFactory_importGmshGrid_docstring
@@ -59,6 +121,17 @@ subdivided into nElements(n) segments.
         Output diagnostic information.
    - insertBoundarySegments (bool, default: False)
         Insert boundary segments.
+   - elementOrdering (string, default: 'original')
+        Order in which the elements and vertices of the grid are
+        numbered (one of 'original', 'morton', 'hilbert'; the
+        latter two are supported only for triangular grids imported
+        without boundary segments). With
+        'morton' and 'hilbert', elements are sorted along a
+        space-filling curve through their centroids, which improves
+        the locality of memory accesses during assembly. The
+        original indices can be retrieved with
+        Grid.getOriginalElementIndices() and
+        Grid.getOriginalVertexIndices().
 
 See http://geuz.org/gmsh for information about the Gmsh file format.
 See Dune::GmshReader documentation for information about the supported
@@ -72,6 +145,8 @@ namespace Bempp
 
 DECLARE_CLASS_DOCSTRING (GridFactory);
 DECLARE_METHOD_DOCSTRING(GridFactory, createStructuredGrid, 0);
+DECLARE_METHOD_DOCSTRING(GridFactory, createGridFromConnectivityArrays, 0);
+DECLARE_METHOD_DOCSTRING(GridFactory, createFlatGridFromConnectivityArrays, 0);
 DECLARE_METHOD_DOCSTRING(GridFactory, importGmshGrid, 0);
 
 } // namespace Bempp
@@ -28,12 +28,14 @@ namespace Bempp
         $1 = Bempp::VtkWriter::APPENDED_RAW;
     else if (s == "appendedbase64")
         $1 = Bempp::VtkWriter::APPENDED_BASE_64;
+    else if (s == "appendedrawcompressed")
+        $1 = Bempp::VtkWriter::APPENDED_RAW_COMPRESSED;
     else
     {
         PyErr_SetString(PyExc_ValueError,
                         "in method '$symname', argument $argnum: "
-                        "expected one of 'ascii', 'base64', 'appendedraw' or "
-                        "'appendedbase64'");
+                        "expected one of 'ascii', 'base64', 'appendedraw', "
+                        "'appendedbase64' or 'appendedrawcompressed'");
         SWIG_fail;
     }
 }
@@ -54,7 +54,10 @@ same as a call to pwrite() with path='' and extendpath=''.
         Basic name to write (may not contain a path).
    - type (string, optional)
         Format of the output, one of 'ascii' (default), 'base64',
-        'appendedraw' or 'appendedbase64'.
+        'appendedraw', 'appendedbase64' or 'appendedrawcompressed'.
+        The last format (zlib-compressed binary) is supported only
+        by writers of conforming grid views with elements of a
+        single type and only if BEM++ has been built with zlib.
 
 Returns the name of the created file."
 %enddef
@@ -86,7 +89,10 @@ parallel writing, the regular write() method can do that just fine.
         directory denoted by path.
    - type (string, optional)
         Format of the output, one of 'ascii' (default), 'base64',
-        'appendedraw' or 'appendedbase64'.
+        'appendedraw', 'appendedbase64' or 'appendedrawcompressed'.
+        The last format (zlib-compressed binary) is supported only
+        by writers of conforming grid views with elements of a
+        single type and only if BEM++ has been built with zlib.
 
 Returns the name of the created file.
 
@@ -1428,7 +1428,8 @@ def __gridFunctionFromFunctor(
 
 def createGridFunction(
         context, space, dualSpace=None,
-        function=None, surfaceNormalDependent=False, coefficients=None, projections=None):
+        function=None, surfaceNormalDependent=False, coefficients=None, projections=None,
+        vectorized=False):
     """
     Create and return a GridFunction object with values determined by a Python
     function or by an input vector of coefficients or projections.
@@ -1460,6 +1461,19 @@ def createGridFunction(
        - surfaceNormalDependent (bool)
             Indicates whether the grid function depends on the unit vector
             normal to the grid or not.
+       - vectorized (bool)
+            If set to True, 'function' will be called with all the points at
+            which it needs to be evaluated (typically, the quadrature points
+            of a batch of elements) at once, instead of separately for each
+            point. In this case its first argument will be a 2D array whose
+            columns are the coordinates of the points, its second argument (if
+            'surfaceNormalDependent' is True) a 2D array whose columns are the
+            corresponding unit normals, and it should return a 2D array whose
+            columns are the function's values at these points (or a 1D array
+            if the function is scalar-valued). This greatly reduces the
+            overhead of calling Python code and is therefore recommended for
+            functions that can be expressed in terms of NumPy array
+            operations.
 
     If both the 'space' and 'dualSpace' are given, they must be defined on the
     same grid and have the same codomain dimension.
@@ -1498,6 +1512,14 @@ def createGridFunction(
             nx, ny, nz = normal
             k = 5
             return cmath.exp(1j * k * x) * (nx - 1)
+
+    Vectorized version of 'fun1', which can be passed to 'createGridFunction'
+    with 'surfaceNormalDependent = False' and 'vectorized = True'::
+
+        def fun1Vectorized(points):
+            x, y, z = points
+            r = np.sqrt(x**2 + y**2 + z**2)
+            return 2 * x * z / r**5 - y / r**3
     """
 
     params = [function,coefficients,projections]
@@ -1527,6 +1549,8 @@ def createGridFunction(
         className = "SurfaceNormalDependentFunctor"
     else:
         className = "SurfaceNormalIndependentFunctor"
+    if vectorized:
+        className = "Vectorized" + className
     return __gridFunctionFromFunctor(
         className, context, space, dualSpace, function,
         argumentDimension=space.grid().dimWorld(),
@@ -1560,7 +1584,7 @@ def gridFunctionFromSurfaceNormalIndependentFunction(
 
 def estimateL2Error(
         gridFunction, exactFunction, quadStrategy, evaluationOptions,
-        surfaceNormalDependent=False):
+        surfaceNormalDependent=False, vectorized=False):
     """
     Calculate the L^2-norm of the difference between a grid function and a function
     defined as a Python callable.
@@ -1588,6 +1612,10 @@ def estimateL2Error(
        - surfaceNormalDependent (bool)
             Indicates whether 'exactFunction' depends on the unit vector
             normal to the grid or not.
+       - vectorized (bool)
+            Indicates whether 'exactFunction' accepts arrays of points (and
+            normals) rather than single points; see the documentation of
+            createGridFunction() for details.
 
     *Returns* a tuple (absError, relError), where absError is the L^2-norm of
     the difference between 'gridFunction' and 'exactFunction' and relError is
@@ -1603,21 +1631,23 @@ def estimateL2Error(
         raise TypeError("BasisFunctionType and ResultType of gridFunction "
                         "and exactFunction must be the same")
     if surfaceNormalDependent:
-        dependent = "Dependent"
+        functorType = "SurfaceNormalDependentFunctor"
     else:
-        dependent = "Independent"
+        functorType = "SurfaceNormalIndependentFunctor"
+    if vectorized:
+        functorType = "Vectorized" + functorType
     functor = _constructObjectTemplatedOnValue(
-        core, "PythonSurfaceNormal%sFunctor" % dependent,
+        core, "Python" + functorType,
         resultType, exactFunction,
         gridFunction.space().grid().dimWorld(), # argument dimension
         gridFunction.space().codomainDimension() # result dimension
         )
     absError = _constructObjectTemplatedOnBasisAndResult(
-        core, "L2NormOfDifferenceFromPythonSurfaceNormal%sFunctor" % dependent,
+        core, "L2NormOfDifferenceFromPython" + functorType,
         basisFunctionType, resultType,
         gridFunction, functor, quadStrategy, evaluationOptions)
     exactFunctionL2Norm = _constructObjectTemplatedOnBasisAndResult(
-        core, "L2NormOfDifferenceFromPythonSurfaceNormal%sFunctor" % dependent,
+        core, "L2NormOfDifferenceFromPython" + functorType,
         basisFunctionType, resultType,
         0 * gridFunction, functor, quadStrategy, evaluationOptions)
     return absError, absError / exactFunctionL2Norm
@@ -1798,36 +1828,79 @@ def adjoint(*args):
     return _constructObjectTemplatedOnBasisAndResult(
         core, "adjoint", args[0].basisFunctionType(), args[0].resultType(), *args)
 
-if core._withAhmed:
-    def acaOperatorApproximateLuInverse(operator, delta):
-        """
-        Create and return a discrete boundary operator representing an approximate
-        inverse of an H-matrix.
+def acaOperatorApproximateLuInverse(operator, delta):
+    """
+    Create and return a discrete boundary operator representing an approximate
+    inverse of an H-matrix.
 
-        *Parameters:*
-           - operator (DiscreteBoundaryOperator)
-                A discrete boundary operator stored in the form of an H-matrix.
-           - delta (float)
-                Approximation accuracy.
+    *Parameters:*
+       - operator (DiscreteBoundaryOperator)
+            A discrete boundary operator stored in the form of an H-matrix
+            (either by AHMED or by the built-in H-matrix engine).
+       - delta (float)
+            Approximation accuracy.
+
+    *Returns* a DiscreteBoundaryOperator_ValueType object representing an
+    approximate inverse of the operator supplied in the 'operator' argument,
+    stored in the form of an approximate H-matrix LU decomposition. ValueType is
+    set to operator.valueType().
+    """
+    # name = 'createAcaApproximateLuInverse'
+    name = 'acaOperatorApproximateLuInverse'
+    return _constructObjectTemplatedOnValue(
+        core, name, operator.valueType(), operator, delta)
 
-        *Returns* a DiscreteBoundaryOperator_ValueType object representing an
-        approximate inverse of the operator supplied in the 'operator' argument,
-        stored in the form of an approximate H-matrix LU decomposition. ValueType is
-        set to operator.valueType().
-        """
-        # name = 'createAcaApproximateLuInverse'
-        name = 'acaOperatorApproximateLuInverse'
-        return _constructObjectTemplatedOnValue(
-            core, name, operator.valueType(), operator, delta)
+def nearFieldSparseApproximateInverse(operator):
+    """
+    Create and return a discrete boundary operator representing a sparse
+    approximate inverse of the near field of an H-matrix.
 
-    def createAcaApproximateLuInverse(operator, delta):
-        """
-        Deprecated. Superseded by acaOperatorApproximateLuInverse().
-        """
-        print ("createAcaApproximateLuInverse(): DEPRECATED: "
-               "use acaOperatorApproximateLuInverse() instead.")
-        return acaOperatorApproximateLuInverse(operator, delta)
+    *Parameters:*
+       - operator (DiscreteBoundaryOperator)
+            A discrete boundary operator stored in the form of an H-matrix
+            by the built-in H-matrix engine.
+
+    The near field consists of the dense blocks of the H-matrix. The inverse
+    is computed in time proportional to the size of the operator and applied
+    as a sparse matrix-vector product, so it is a cheap alternative to
+    acaOperatorApproximateLuInverse() for preconditioning.
+
+    *Returns* a DiscreteBoundaryOperator_ValueType object, with ValueType
+    set to operator.valueType().
+    """
+    name = 'nearFieldSparseApproximateInverse'
+    return _constructObjectTemplatedOnValue(
+        core, name, operator.valueType(), operator)
+
+def nearFieldBlockJacobiInverse(operator, overlap=1):
+    """
+    Create and return a discrete boundary operator representing an
+    overlapping block-Jacobi inverse of the near field of an H-matrix.
+
+    *Parameters:*
+       - operator (DiscreteBoundaryOperator)
+            A discrete boundary operator stored in the form of an H-matrix
+            by the built-in H-matrix engine.
+       - overlap (int)
+            Number of layers of near-field neighbours added to the block of
+            each leaf cluster (default: 1).
 
+    *Returns* a DiscreteBoundaryOperator_ValueType object, with ValueType
+    set to operator.valueType().
+    """
+    name = 'nearFieldBlockJacobiInverse'
+    return _constructObjectTemplatedOnValue(
+        core, name, operator.valueType(), operator, overlap)
+
+def createAcaApproximateLuInverse(operator, delta):
+    """
+    Deprecated. Superseded by acaOperatorApproximateLuInverse().
+    """
+    print ("createAcaApproximateLuInverse(): DEPRECATED: "
+           "use acaOperatorApproximateLuInverse() instead.")
+    return acaOperatorApproximateLuInverse(operator, delta)
+
+if core._withAhmed:
     def scaledAcaOperator(operator, multiplier):
         """
         Multiply a discrete boundary operator stored as an H-matrix by a scalar.
@@ -1908,6 +1981,23 @@ def discreteSparseInverse(op):
     name = 'discreteSparseInverse'
     return _constructObjectTemplatedOnValue(core, name, op.valueType(), op)
 
+def fusedDiscreteOperator(op):
+    """
+    Return a discrete operator object that applies a composite discrete
+    operator (built from sums, scaled, transposed and blocked operators and
+    products) without allocating temporary vectors on each application.
+
+    *Parameters:*
+       - op (DiscreteBoundaryOperator)
+           A discrete boundary operator, typically a composite one that is
+           applied many times, e.g. inside an iterative solver.
+
+    *Returns* a newly constructed DiscreteBoundaryOperator_ValueType object
+    representing the same matrix as op.
+    """
+    name = 'fusedDiscreteOperator'
+    return _constructObjectTemplatedOnValue(core, name, op.valueType(), op)
+
 def discreteOperatorToPreconditioner(op):
     """
     Create a preconditioner from a discrete boundary operator.
@@ -1936,6 +2026,42 @@ def discreteBlockDiagonalPreconditioner(opArray):
     return _constructObjectTemplatedOnValue(
         core, name, opArray[0].valueType(), opArray)
 
+def createCalderonPreconditionerOptions():
+    """
+    Create and return a CalderonPreconditionerOptions object with default
+    settings.
+    """
+    return core.CalderonPreconditionerOptions()
+
+def calderonPreconditioner(op, preconditioningOp, options=None):
+    """
+    Create a Calderon preconditioner for a boundary operator.
+
+    *Parameters:*
+       - op (BoundaryOperator)
+           The operator of the system to be solved.
+       - preconditioningOp (BoundaryOperator)
+           An operator whose product with 'op' is a compact perturbation of
+           a multiple of the identity, e.g. the hypersingular operator for a
+           single-layer 'op'. Its domain must be the range of 'op' and its
+           range the domain of 'op'.
+       - options (CalderonPreconditionerOptions)
+           Reduced accuracy settings used to assemble 'preconditioningOp'.
+           If set to None (default), default settings are used.
+
+    The weak form of 'preconditioningOp' is assembled with a cheaper
+    quadrature and (in ACA mode) a looser ACA tolerance than 'op', and
+    sandwiched between the inverses of the appropriate Gram matrices.
+
+    *Returns* a preconditioner.
+    """
+    if options is None:
+        options = createCalderonPreconditionerOptions()
+    name = 'calderonPreconditioner'
+    return _constructObjectTemplatedOnBasisAndResult(
+        core, name, op.basisFunctionType(), op.resultType(),
+        op, preconditioningOp, options)
+
 def areInside(grid, points):
     """Determine whether points lie inside a grid (assumed to be closed)."""
     if points.shape[0] != grid.dimWorld():
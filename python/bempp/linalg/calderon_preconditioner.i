@@ -0,0 +1,17 @@
+%{
+#include "linalg/calderon_preconditioner.hpp"
+%}
+
+namespace Bempp
+{
+%feature("compactdefaultargs") calderonPreconditioner;
+}
+
+#define shared_ptr boost::shared_ptr
+%include "linalg/calderon_preconditioner.hpp"
+#undef shared_ptr
+
+namespace Bempp
+{
+BEMPP_INSTANTIATE_SYMBOL_TEMPLATED_ON_BASIS_AND_RESULT(calderonPreconditioner);
+}
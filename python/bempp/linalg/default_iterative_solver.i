@@ -30,6 +30,9 @@ Teuchos::RCP<Teuchos::ParameterList> defaultGmresParameterList(
     double tol, int maxIterationCount = 1000);
 Teuchos::RCP<Teuchos::ParameterList> defaultCgParameterList(
     double tol, int maxIterationCount = 1000);
+Teuchos::RCP<Teuchos::ParameterList> defaultGcrodrParameterList(
+    double tol, int maxIterationCount = 1000,
+    int krylovSubspaceDimension = 50, int recycledSubspaceDimension = 10);
 
 } // namespace Bempp
 
@@ -189,8 +189,8 @@ def replaceParameters(m):
         line = line.replace("enum VtkWriter::DataType",
                             "'cell_data' or 'vertex_data'")
         line = line.replace("enum VtkWriter::OutputType",
-                            "'ascii', 'base64', 'appendedraw' "
-                            "or 'appendedbase64'")
+                            "'ascii', 'base64', 'appendedraw', "
+                            "'appendedbase64' or 'appendedrawcompressed'")
         line = line.replace("enum Bempp::GridParameters::Topology",
                             "string")
         line = line.replace("enum TranspositionMode",
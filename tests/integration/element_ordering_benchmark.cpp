@@ -0,0 +1,207 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Measures the effect of renumbering grid elements along a space-filling
+// curve (GridParameters::elementOrdering) on the locality of a near-field
+// sweep resembling the assembly of a P1 boundary operator: for each element,
+// the geometry of all elements within a few element diameters is read and
+// contributions are added to the entries of a result vector corresponding to
+// their vertices.
+//
+// For each ordering the following quantities are reported:
+// - the time needed to create the grid (including the renumbering),
+// - the mean difference between the indices of interacting elements,
+// - the mean number of distinct cache lines of the element geometry array and
+//   of the result vector touched while processing a single element (a proxy
+//   for the number of cache misses),
+// - the time taken by the sweep.
+//
+// Usage: element_ordering_benchmark [file.msh ...]
+
+#include "grid/bounding_volume_hierarchy.hpp"
+#include "grid/gmsh_reader.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <tbb/tick_count.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace Bempp;
+
+namespace
+{
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// Number of distinct cache lines containing the given array entries
+template <typename T>
+int cacheLineCount(const T* array, const std::vector<size_t>& entries,
+                   std::vector<size_t>& lines)
+{
+    lines.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+        lines[i] = size_t(array + entries[i]) / CACHE_LINE_SIZE;
+    std::sort(lines.begin(), lines.end());
+    return std::unique(lines.begin(), lines.end()) - lines.begin();
+}
+
+void benchmark(const char* label, const GridParameters& params,
+               const arma::Mat<double>& vertices,
+               const arma::Mat<int>& elementCorners, int repetitions)
+{
+    tbb::tick_count start = tbb::tick_count::now();
+    shared_ptr<Grid> grid = GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+    const double creationTime = (tbb::tick_count::now() - start).seconds();
+
+    arma::Mat<double> rawVertices;
+    arma::Mat<int> rawElementCorners;
+    arma::Mat<char> auxData;
+    grid->leafView()->getRawElementData(rawVertices, rawElementCorners,
+                                        auxData);
+    const size_t elementCount = rawElementCorners.n_cols;
+    const size_t vertexCount = rawVertices.n_cols;
+
+    // Element centroids, stored as in the geometry arrays used in assembly
+    std::vector<double> centroids(3 * elementCount, 0.);
+    for (size_t e = 0; e < elementCount; ++e)
+        for (int c = 0; c < 3; ++c)
+            for (int dim = 0; dim < 3; ++dim)
+                centroids[3 * e + dim] +=
+                        rawVertices(dim, rawElementCorners(c, e)) / 3.;
+
+    // Near-field interaction lists
+    const BoundingVolumeHierarchy& bvh = grid->boundingVolumeHierarchy();
+    double meanDiameter = 0.;
+    for (size_t e = 0; e < elementCount; ++e)
+        meanDiameter += bvh.elementDiameter(e);
+    meanDiameter /= elementCount;
+    std::vector<std::vector<int> > nearField(elementCount);
+    for (size_t e = 0; e < elementCount; ++e)
+        bvh.elementsWithinRadius(&centroids[3 * e], 2. * meanDiameter,
+                                 nearField[e]);
+
+    // Locality statistics
+    double indexDistance = 0., geometryLines = 0., resultLines = 0.;
+    size_t pairCount = 0;
+    std::vector<size_t> entries, lines;
+    std::vector<double> result(vertexCount, 0.);
+    for (size_t e = 0; e < elementCount; ++e) {
+        const std::vector<int>& near = nearField[e];
+        entries.clear();
+        for (size_t i = 0; i < near.size(); ++i) {
+            indexDistance += std::abs(int(e) - near[i]);
+            for (int dim = 0; dim < 3; ++dim)
+                entries.push_back(3 * near[i] + dim);
+        }
+        pairCount += near.size();
+        geometryLines += cacheLineCount(&centroids[0], entries, lines);
+        entries.clear();
+        for (size_t i = 0; i < near.size(); ++i)
+            for (int c = 0; c < 3; ++c)
+                entries.push_back(rawElementCorners(c, near[i]));
+        resultLines += cacheLineCount(&result[0], entries, lines);
+    }
+
+    // Near-field sweep
+    start = tbb::tick_count::now();
+    for (int r = 0; r < repetitions; ++r)
+        for (size_t e = 0; e < elementCount; ++e) {
+            const double* x = &centroids[3 * e];
+            const std::vector<int>& near = nearField[e];
+            for (size_t i = 0; i < near.size(); ++i) {
+                const double* y = &centroids[3 * near[i]];
+                const double dx = x[0] - y[0], dy = x[1] - y[1],
+                        dz = x[2] - y[2];
+                const double value = 1. / (std::sqrt(dx * dx + dy * dy +
+                                                     dz * dz) + meanDiameter);
+                for (int c = 0; c < 3; ++c)
+                    result[rawElementCorners(c, near[i])] += value;
+            }
+        }
+    const double sweepTime =
+            (tbb::tick_count::now() - start).seconds() / repetitions;
+
+    std::printf("%-10s %10.4f %12.1f %10.2f %10.2f %10.4f\n",
+                label, creationTime, indexDistance / pairCount,
+                geometryLines / elementCount, resultLines / elementCount,
+                sweepTime);
+}
+
+void benchmark(const std::string& fileName, int repetitions)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+    readGmshTriangularGrid(fileName, vertices, elementCorners,
+                           boundaryId2PhysicalEntity,
+                           elementIndex2PhysicalEntity);
+    std::printf("\n%s: %d vertices, %d elements\n", fileName.c_str(),
+                int(vertices.n_cols), int(elementCorners.n_cols));
+    std::printf("%-10s %10s %12s %10s %10s %10s\n", "ordering", "create [s]",
+                "index dist.", "geom. lines", "res. lines", "sweep [s]");
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    benchmark("file", params, vertices, elementCorners, repetitions);
+
+    // Worst case: elements listed in random order
+    const size_t elementCount = elementCorners.n_cols;
+    std::vector<int> order(elementCount);
+    for (size_t e = 0; e < elementCount; ++e)
+        order[e] = e;
+    std::srand(1);
+    std::random_shuffle(order.begin(), order.end());
+    arma::Mat<int> shuffledElementCorners(3, elementCount);
+    for (size_t e = 0; e < elementCount; ++e)
+        for (int c = 0; c < 3; ++c)
+            shuffledElementCorners(c, e) = elementCorners(c, order[e]);
+    benchmark("random", params, vertices, shuffledElementCorners, repetitions);
+
+    params.elementOrdering = GridParameters::MORTON_ORDERING;
+    benchmark("Morton", params, vertices, shuffledElementCorners, repetitions);
+    params.elementOrdering = GridParameters::HILBERT_ORDERING;
+    benchmark("Hilbert", params, vertices, shuffledElementCorners, repetitions);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> fileNames;
+    for (int i = 1; i < argc; ++i)
+        fileNames.push_back(argv[i]);
+    if (fileNames.empty()) {
+        fileNames.push_back("../../examples/meshes/sphere-h-0.05.msh");
+        fileNames.push_back("../../examples/meshes/sphere-h-0.025.msh");
+        fileNames.push_back("../../examples/meshes/cube-h-0.0125.msh");
+    }
+    const int repetitions = 3;
+
+    for (size_t i = 0; i < fileNames.size(); ++i)
+        benchmark(fileNames[i], repetitions);
+}
@@ -0,0 +1,105 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares the time needed to import Gmsh files with Dune::GmshReader and
+// with the native reader used by GridFactory::importGmshGrid(), both for
+// parsing alone and for the construction of the complete grid.
+//
+// Usage: gmsh_import_benchmark [file.msh ...]
+
+#include "grid/dune.hpp"
+#include "grid/gmsh_reader.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <dune/grid/io/file/gmshreader.hh>
+#include <tbb/tick_count.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Bempp;
+
+namespace
+{
+
+void benchmark(const std::string& fileName, int repetitions)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+
+    tbb::tick_count start = tbb::tick_count::now();
+    for (int r = 0; r < repetitions; ++r) {
+        std::auto_ptr<Default2dIn3dDuneGrid> duneGrid(
+                    Dune::GmshReader<Default2dIn3dDuneGrid>::read(
+                        fileName, boundaryId2PhysicalEntity,
+                        elementIndex2PhysicalEntity, false /* verbose */));
+    }
+    const double duneTime =
+            (tbb::tick_count::now() - start).seconds() / repetitions;
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    start = tbb::tick_count::now();
+    for (int r = 0; r < repetitions; ++r)
+        readGmshTriangularGrid(fileName, vertices, elementCorners,
+                               boundaryId2PhysicalEntity,
+                               elementIndex2PhysicalEntity);
+    const double parseTime =
+            (tbb::tick_count::now() - start).seconds() / repetitions;
+
+    shared_ptr<Grid> grid;
+    start = tbb::tick_count::now();
+    for (int r = 0; r < repetitions; ++r)
+        grid = GridFactory::importGmshGrid(params, fileName);
+    const double nativeTime =
+            (tbb::tick_count::now() - start).seconds() / repetitions;
+
+    std::printf("%-40s %10d %10d | %10.3f | %10.3f %10.3f %8.2f\n",
+                fileName.c_str(), int(vertices.n_cols),
+                int(grid->leafView()->entityCount(0)), duneTime,
+                parseTime, nativeTime, duneTime / nativeTime);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> fileNames;
+    for (int i = 1; i < argc; ++i)
+        fileNames.push_back(argv[i]);
+    if (fileNames.empty()) {
+        fileNames.push_back("../../examples/meshes/sphere-h-0.1.msh");
+        fileNames.push_back("../../examples/meshes/sphere-h-0.05.msh");
+        fileNames.push_back("../../examples/meshes/sphere-h-0.025.msh");
+        fileNames.push_back("../../examples/meshes/cube-h-0.0125.msh");
+    }
+    const int repetitions = 3;
+
+    std::printf("%-40s %10s %10s | %10s | %10s %10s %8s\n",
+                "file", "vertices", "elements", "Dune [s]",
+                "parse [s]", "total [s]", "speedup");
+    for (size_t i = 0; i < fileNames.size(); ++i)
+        benchmark(fileNames[i], repetitions);
+}
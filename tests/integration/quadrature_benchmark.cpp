@@ -0,0 +1,122 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// Compares the tabulated (Dunavant) triangle quadrature rules with the
+// collapsed Gauss-Jacobi rules generated on the fly: number of points,
+// maximum error in the integrals of monomials of degree up to the accuracy
+// order, error in the integral of a smooth non-polynomial function and time
+// needed to construct the rule.
+
+#include "fiber/gauss_jacobi_quadrature.hpp"
+#include "fiber/numerical_quadrature.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <tbb/tick_count.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+double factorial(int n)
+{
+    double result = 1.;
+    for (int i = 2; i <= n; ++i)
+        result *= i;
+    return result;
+}
+
+// Maximum relative error in the integrals of x^a y^b, a + b <= order, over
+// the reference triangle (0,0)--(1,0)--(0,1)
+double maxMonomialError(int order, const arma::Mat<double>& points,
+                        const std::vector<double>& weights)
+{
+    double maxError = 0.;
+    for (int a = 0; a <= order; ++a)
+        for (int b = 0; a + b <= order; ++b) {
+            const double exact = factorial(a) * factorial(b) / factorial(a + b + 2);
+            double approx = 0.;
+            for (size_t i = 0; i < weights.size(); ++i)
+                approx += weights[i] * std::pow(points(0, i), a) *
+                        std::pow(points(1, i), b);
+            maxError = std::max(maxError, std::abs(approx - exact) / exact);
+        }
+    return maxError;
+}
+
+// Relative error in the integral of exp(x + 2 y) over the reference triangle
+double smoothFunctionError(const arma::Mat<double>& points,
+                           const std::vector<double>& weights)
+{
+    const double e = std::exp(1.);
+    const double exact = (e - 1.) * (e - 1.) / 2.;
+    double approx = 0.;
+    for (size_t i = 0; i < weights.size(); ++i)
+        approx += weights[i] * std::exp(points(0, i) + 2. * points(1, i));
+    return std::abs(approx - exact) / exact;
+}
+
+} // namespace
+
+int main()
+{
+    const int tabulatedMaxOrder = 20;
+    const int maxOrder = 30;
+    const int repetitions = 100;
+
+    std::printf("%5s | %8s %12s %12s %10s | %8s %12s %12s %10s\n",
+                "order", "points", "monomials", "exp(x+2y)", "time [us]",
+                "points", "monomials", "exp(x+2y)", "time [us]");
+    std::printf("%5s | %45s | %45s\n", "",
+                "tabulated (symmetric) rule", "collapsed Gauss-Jacobi rule");
+
+    for (int order = 1; order <= maxOrder; ++order) {
+        arma::Mat<double> points;
+        std::vector<double> weights;
+
+        std::printf("%5d | ", order);
+        if (order <= tabulatedMaxOrder) {
+            tbb::tick_count start = tbb::tick_count::now();
+            for (int r = 0; r < repetitions; ++r)
+                Fiber::fillSingleQuadraturePointsAndWeights(
+                            3, order, points, weights);
+            tbb::tick_count end = tbb::tick_count::now();
+            std::printf("%8d %12.3e %12.3e %10.3f | ",
+                        int(weights.size()),
+                        maxMonomialError(order, points, weights),
+                        smoothFunctionError(points, weights),
+                        (end - start).seconds() * 1e6 / repetitions);
+        } else
+            std::printf("%45s | ", "n/a");
+
+        tbb::tick_count start = tbb::tick_count::now();
+        for (int r = 0; r < repetitions; ++r)
+            Fiber::fillCollapsedGaussTrianglePointsAndWeights(
+                        order, points, weights);
+        tbb::tick_count end = tbb::tick_count::now();
+        std::printf("%8d %12.3e %12.3e %10.3f\n",
+                    int(weights.size()),
+                    maxMonomialError(order, points, weights),
+                    smoothFunctionError(points, weights),
+                    (end - start).seconds() * 1e6 / repetitions);
+    }
+}
@@ -20,8 +20,6 @@
 
 #include "bempp/common/config_ahmed.hpp"
 
-#ifdef WITH_AHMED
-
 #include "../type_template.hpp"
 #include "../check_arrays_are_close.hpp"
 
@@ -46,6 +44,8 @@ using namespace Bempp;
 
 // Tests
 
+#ifdef WITH_AHMED
+
 BOOST_AUTO_TEST_SUITE(AcaAssembly)
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(aca_of_assembled_operator_agrees_with_dense_assembly_for_614_element_mesh,
@@ -347,3 +347,61 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(aca_of_disassembled_helmholtz_hypersingular_operat
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif // WITH_AHMED
+
+BOOST_AUTO_TEST_SUITE(BuiltInHMatrixAssembly)
+
+// With a large admissibility parameter, pairs of adjacent leaf clusters
+// whose DOF bounding boxes are separated by a small gap become admissible,
+// although the supports of their DOFs touch. The blocks they form must
+// still be evaluated with the quadrature used for nearby elements.
+BOOST_AUTO_TEST_CASE_TEMPLATE(built_in_h_matrix_agrees_with_dense_assembly_for_adjacent_admissible_leaf_clusters,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > pwiseConstants(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+    shared_ptr<Space<BFT> > pwiseLinears(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    accuracyOptions.doubleRegular.setRelativeQuadratureOrder(2);
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+
+    AssemblyOptions assemblyOptionsDense;
+    assemblyOptionsDense.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > contextDense(
+        new Context<BFT, RT>(quadStrategy, assemblyOptionsDense));
+
+    BoundaryOperator<BFT, RT> opDense =
+            laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+                contextDense, pwiseLinears, pwiseConstants, pwiseLinears);
+    arma::Mat<RT> weakFormDense = opDense.weakForm()->asMatrix();
+
+    AssemblyOptions assemblyOptionsHMatrix;
+    assemblyOptionsHMatrix.setVerbosityLevel(VerbosityLevel::LOW);
+    AcaOptions acaOptions;
+    acaOptions.backend = AcaOptions::BUILT_IN;
+    acaOptions.eta = 1000.;
+    assemblyOptionsHMatrix.switchToAcaMode(acaOptions);
+    shared_ptr<Context<BFT, RT> > contextHMatrix(
+        new Context<BFT, RT>(quadStrategy, assemblyOptionsHMatrix));
+
+    BoundaryOperator<BFT, RT> opHMatrix =
+            laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+                contextHMatrix, pwiseLinears, pwiseConstants, pwiseLinears);
+    arma::Mat<RT> weakFormHMatrix = opHMatrix.weakForm()->asMatrix();
+
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    weakFormDense, weakFormHMatrix, 2. * acaOptions.eps));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
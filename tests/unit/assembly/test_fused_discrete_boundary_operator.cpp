@@ -0,0 +1,214 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../type_template.hpp"
+#include "../random_arrays.hpp"
+
+#include "assembly/discrete_blocked_boundary_operator.hpp"
+#include "assembly/discrete_boundary_operator_composition.hpp"
+#include "assembly/discrete_dense_boundary_operator.hpp"
+#include "assembly/fused_discrete_boundary_operator.hpp"
+
+#include "common/boost_make_shared_fwd.hpp"
+#include "fiber/_2d_array.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <complex>
+#include <limits>
+
+// Tests
+
+using namespace Bempp;
+
+namespace
+{
+
+template <typename RT>
+shared_ptr<const DiscreteBoundaryOperator<RT> > denseOperator(
+        const arma::Mat<RT>& mat)
+{
+    return boost::make_shared<DiscreteDenseBoundaryOperator<RT> >(mat);
+}
+
+template <typename RT>
+arma::Mat<RT> transformedMatrix(const arma::Mat<RT>& mat,
+                                TranspositionMode trans)
+{
+    switch (trans) {
+    case CONJUGATE:
+        return arma::conj(mat);
+    case TRANSPOSE:
+        return mat.st();
+    case CONJUGATE_TRANSPOSE:
+        return mat.t();
+    default:
+        return mat;
+    }
+}
+
+// Operator tree
+//
+//   [ (2 A + B^T) (C - 3 D)   0 ]
+//   [ E                       F ]
+//
+// exercising all kinds of composite nodes
+template <typename RT>
+struct FusedDiscreteBoundaryOperatorFixture
+{
+    FusedDiscreteBoundaryOperatorFixture()
+    {
+        typedef DiscreteBoundaryOperator<RT> DiscreteOp;
+        const arma::Mat<RT> a = generateRandomMatrix<RT>(5, 4);
+        const arma::Mat<RT> b = generateRandomMatrix<RT>(4, 5);
+        const arma::Mat<RT> c = generateRandomMatrix<RT>(4, 6);
+        const arma::Mat<RT> d = generateRandomMatrix<RT>(4, 6);
+        const arma::Mat<RT> e = generateRandomMatrix<RT>(3, 6);
+        const arma::Mat<RT> f = generateRandomMatrix<RT>(3, 2);
+
+        shared_ptr<const DiscreteOp> outer =
+                static_cast<RT>(2.) * denseOperator(a) +
+                transpose(denseOperator(b));
+        shared_ptr<const DiscreteOp> inner =
+                denseOperator(c) - denseOperator(d) * static_cast<RT>(3.);
+        shared_ptr<const DiscreteOp> product =
+                boost::make_shared<DiscreteBoundaryOperatorComposition<RT> >(
+                    outer, inner);
+
+        Fiber::_2dArray<shared_ptr<const DiscreteOp> > blocks(2, 2);
+        blocks(0, 0) = product;
+        blocks(1, 0) = denseOperator(e);
+        blocks(1, 1) = denseOperator(f);
+        std::vector<size_t> rowCounts(2), columnCounts(2);
+        rowCounts[0] = 5; rowCounts[1] = 3;
+        columnCounts[0] = 6; columnCounts[1] = 2;
+        op = boost::make_shared<DiscreteBlockedBoundaryOperator<RT> >(
+                    blocks, rowCounts, columnCounts);
+        fused = boost::make_shared<FusedDiscreteBoundaryOperator<RT> >(op);
+
+        mat.zeros(8, 8);
+        mat.submat(0, 0, 4, 5) = (static_cast<RT>(2.) * a + b.st()) *
+                (c - static_cast<RT>(3.) * d);
+        mat.submat(5, 0, 7, 5) = e;
+        mat.submat(5, 6, 7, 7) = f;
+    }
+
+    shared_ptr<const DiscreteBoundaryOperator<RT> > op;
+    shared_ptr<const FusedDiscreteBoundaryOperator<RT> > fused;
+    arma::Mat<RT> mat;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FusedDiscreteBoundaryOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(plan_contains_all_leaves,
+                              ResultType, result_types)
+{
+    typedef ResultType RT;
+
+    FusedDiscreteBoundaryOperatorFixture<RT> fixture;
+    BOOST_CHECK_EQUAL(fixture.fused->leafCount(), 6u);
+    BOOST_CHECK_EQUAL(fixture.fused->rowCount(), 8u);
+    BOOST_CHECK_EQUAL(fixture.fused->columnCount(), 8u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(builtin_apply_agrees_with_matrix_for_all_transposition_modes,
+                              ResultType, result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    FusedDiscreteBoundaryOperatorFixture<RT> fixture;
+    const TranspositionMode modes[] = {
+        NO_TRANSPOSE, CONJUGATE, TRANSPOSE, CONJUGATE_TRANSPOSE };
+    const RT alpha = static_cast<RT>(2.);
+    const RT beta = static_cast<RT>(3.);
+
+    for (int i = 0; i < 4; ++i) {
+        const arma::Mat<RT> mat = transformedMatrix(fixture.mat, modes[i]);
+        arma::Col<RT> x = generateRandomVector<RT>(mat.n_cols);
+        arma::Col<RT> y = generateRandomVector<RT>(mat.n_rows);
+        arma::Col<RT> expected = alpha * mat * x + beta * y;
+
+        fixture.fused->apply(modes[i], x, y, alpha, beta);
+
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        y, expected, 100. * std::numeric_limits<CT>::epsilon()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(multiple_apply_agrees_with_matrix_for_all_transposition_modes,
+                              ResultType, result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    FusedDiscreteBoundaryOperatorFixture<RT> fixture;
+    const TranspositionMode modes[] = {
+        NO_TRANSPOSE, CONJUGATE, TRANSPOSE, CONJUGATE_TRANSPOSE };
+    const RT alpha = static_cast<RT>(2.);
+    const RT beta = static_cast<RT>(3.);
+
+    for (int i = 0; i < 4; ++i) {
+        const arma::Mat<RT> mat = transformedMatrix(fixture.mat, modes[i]);
+        arma::Mat<RT> x = generateRandomMatrix<RT>(mat.n_cols, 3);
+        arma::Mat<RT> y = generateRandomMatrix<RT>(mat.n_rows, 3);
+        arma::Mat<RT> expected = alpha * mat * x + beta * y;
+
+        fixture.fused->apply(modes[i], x, y, alpha, beta);
+
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        y, expected, 100. * std::numeric_limits<CT>::epsilon()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(repeated_apply_gives_identical_results_for_beta_equal_to_0_and_y_initialized_to_nans,
+                              ResultType, result_types)
+{
+    std::srand(1);
+
+    typedef ResultType RT;
+    typedef typename Fiber::ScalarTraits<RT>::RealType CT;
+
+    FusedDiscreteBoundaryOperatorFixture<RT> fixture;
+    const RT alpha = static_cast<RT>(2.);
+    const RT beta = static_cast<RT>(0.);
+
+    arma::Col<RT> x = generateRandomVector<RT>(fixture.mat.n_cols);
+    arma::Col<RT> expected = alpha * fixture.mat * x;
+    for (int i = 0; i < 3; ++i) {
+        arma::Col<RT> y(fixture.mat.n_rows);
+        y.fill(std::numeric_limits<CT>::quiet_NaN());
+
+        fixture.fused->apply(NO_TRANSPOSE, x, y, alpha, beta);
+
+        BOOST_CHECK(y.is_finite());
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        y, expected, 100. * std::numeric_limits<CT>::epsilon()));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
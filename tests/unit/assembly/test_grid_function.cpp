@@ -25,19 +25,24 @@
 #include "assembly/boundary_operator.hpp"
 #include "assembly/context.hpp"
 #include "assembly/grid_function.hpp"
+#include "assembly/grid_function_ordering.hpp"
+#include "assembly/grid_function_prolongation.hpp"
 #include "assembly/identity_operator.hpp"
 #include "assembly/numerical_quadrature_strategy.hpp"
 #include "assembly/surface_normal_independent_function.hpp"
+#include "assembly/vectorized_surface_normal_independent_function.hpp"
 
 #include "common/scalar_traits.hpp"
 
 #include "grid/grid.hpp"
 #include "grid/grid_factory.hpp"
+#include "grid/grid_refinement.hpp"
 
 #include "space/piecewise_linear_continuous_scalar_space.hpp"
 #include "space/piecewise_constant_scalar_space.hpp"
 
 #include <boost/test/floating_point_comparison.hpp>
+#include <limits>
 
 using namespace Bempp;
 
@@ -73,6 +78,23 @@ public:
     }
 };
 
+template <typename ValueType_>
+class VectorizedSinusoidalFunction
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    inline void evaluate(const arma::Mat<CoordinateType>& points,
+                         arma::Mat<ValueType>& result) const {
+        for (size_t i = 0; i < points.n_cols; ++i)
+            result(0, i) = points(0, i);
+    }
+};
+
 template <typename ValueType_>
 class ExponentialFunction
 {
@@ -188,4 +210,250 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(L2Norm_works_for_exponential_function_and_piecewis
     BOOST_CHECK_CLOSE(norm, expectedNorm, 1 /* percent */);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(projections_do_not_depend_on_thread_count, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.1.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+
+    AssemblyOptions serialAssemblyOptions;
+    serialAssemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    serialAssemblyOptions.setMaxThreadCount(1);
+    shared_ptr<Context<BFT, RT> > serialContext(
+        new Context<BFT, RT>(quadStrategy, serialAssemblyOptions));
+
+    AssemblyOptions parallelAssemblyOptions;
+    parallelAssemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > parallelContext(
+        new Context<BFT, RT>(quadStrategy, parallelAssemblyOptions));
+
+    Bempp::GridFunction<BFT, RT> serialFun(serialContext, space, space,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> parallelFun(parallelContext, space, space,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+
+    arma::Col<RT> serialProjections = serialFun.projections(*space);
+    arma::Col<RT> parallelProjections = parallelFun.projections(*space);
+
+    // The local contributions are summed in a fixed order, so the results
+    // should agree to the last bit
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    serialProjections, parallelProjections, 0.));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(vectorized_function_gives_same_projections_as_pointwise_function, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.1.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    Bempp::GridFunction<BFT, RT> pointwiseFun(context, space, space,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> vectorizedFun(context, space, space,
+                vectorizedSurfaceNormalIndependentFunction(
+                    VectorizedSinusoidalFunction<RT>()));
+
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    pointwiseFun.projections(*space),
+                    vectorizedFun.projections(*space),
+                    10. * std::numeric_limits<CT>::epsilon()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(L2Norm_and_evaluateAtSpecialPoints_do_not_depend_on_thread_count, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.1.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+
+    AssemblyOptions serialAssemblyOptions;
+    serialAssemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    serialAssemblyOptions.setMaxThreadCount(1);
+    shared_ptr<Context<BFT, RT> > serialContext(
+        new Context<BFT, RT>(quadStrategy, serialAssemblyOptions));
+
+    AssemblyOptions parallelAssemblyOptions;
+    parallelAssemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > parallelContext(
+        new Context<BFT, RT>(quadStrategy, parallelAssemblyOptions));
+
+    Bempp::GridFunction<BFT, RT> serialFun(serialContext, space, space,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> parallelFun(
+                parallelContext, space, serialFun.coefficients());
+
+    BOOST_CHECK_EQUAL(serialFun.L2Norm(), parallelFun.L2Norm());
+
+    // The L2 norm agrees with sqrt(u^H M u), M being the mass matrix
+    BoundaryOperator<BFT, RT> id = identityOperator<BFT, RT>(
+                serialContext, space, space, space);
+    const arma::Col<RT>& u = serialFun.coefficients();
+    arma::Col<RT> mu(u.n_rows);
+    id.weakForm()->apply(NO_TRANSPOSE, u, mu, 1., 0.);
+    const CT massNorm = std::sqrt(std::abs(arma::cdot(u, mu)));
+    BOOST_CHECK_CLOSE(serialFun.L2Norm(), massNorm, 1e-8 /* percent */);
+
+    arma::Mat<CT> serialPoints, parallelPoints;
+    arma::Mat<RT> serialValues, parallelValues;
+    serialFun.evaluateAtSpecialPoints(VtkWriter::VERTEX_DATA,
+                                      serialPoints, serialValues);
+    parallelFun.evaluateAtSpecialPoints(VtkWriter::VERTEX_DATA,
+                                        parallelPoints, parallelValues);
+    BOOST_CHECK(check_arrays_are_close<CT>(serialPoints, parallelPoints, 0.));
+    BOOST_CHECK(check_arrays_are_close<RT>(serialValues, parallelValues, 0.));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(prolonged_functions_have_the_same_L2Norm, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.1.msh", false /* verbose */);
+    GridRefinement refinement(grid);
+
+    shared_ptr<Space<BFT> > coarseConstSpace(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > fineConstSpace(
+        new PiecewiseConstantScalarSpace<BFT>(refinement.fineGrid()));
+    shared_ptr<Space<BFT> > coarseLinSpace(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+    shared_ptr<const Space<BFT> > fineLinSpace(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(refinement.fineGrid()));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    // Refinement does not move the surface, hence piecewise constant and
+    // piecewise linear functions are represented exactly on the finer grid
+    Bempp::GridFunction<BFT, RT> coarseConstFun(
+                context, coarseConstSpace, coarseConstSpace,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> fineConstFun = prolongGridFunction(
+                refinement, coarseConstFun, fineConstSpace);
+    BOOST_CHECK_EQUAL(fineConstFun.coefficients().n_rows,
+                      refinement.fineGrid()->leafView()->entityCount(0));
+    BOOST_CHECK_CLOSE(fineConstFun.L2Norm(), coarseConstFun.L2Norm(),
+                      1e-6 /* percent */);
+
+    Bempp::GridFunction<BFT, RT> coarseLinFun(
+                context, coarseLinSpace, coarseLinSpace,
+                surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> fineLinFun = prolongGridFunction(
+                refinement, coarseLinFun, fineLinSpace);
+    BOOST_CHECK_CLOSE(fineLinFun.L2Norm(), coarseLinFun.L2Norm(),
+                      1e-6 /* percent */);
+
+    BOOST_CHECK_THROW(prolongGridFunction(refinement, coarseConstFun,
+                                          fineLinSpace),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(coefficients_in_original_ordering_do_not_depend_on_element_ordering, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> originalGrid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.4.msh", false /* verbose */);
+    params.elementOrdering = GridParameters::MORTON_ORDERING;
+    shared_ptr<Grid> mortonGrid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.4.msh", false /* verbose */);
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    const CT tolerance = 1000 * std::numeric_limits<CT>::epsilon();
+    for (int linear = 0; linear < 2; ++linear) {
+        shared_ptr<Space<BFT> > originalSpace, mortonSpace;
+        if (linear) {
+            originalSpace.reset(
+                new PiecewiseLinearContinuousScalarSpace<BFT>(originalGrid));
+            mortonSpace.reset(
+                new PiecewiseLinearContinuousScalarSpace<BFT>(mortonGrid));
+        } else {
+            originalSpace.reset(
+                new PiecewiseConstantScalarSpace<BFT>(originalGrid));
+            mortonSpace.reset(
+                new PiecewiseConstantScalarSpace<BFT>(mortonGrid));
+        }
+
+        Bempp::GridFunction<BFT, RT> originalFun(
+                    context, originalSpace, originalSpace,
+                    surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+        Bempp::GridFunction<BFT, RT> mortonFun(
+                    context, mortonSpace, mortonSpace,
+                    surfaceNormalIndependentFunction(SinusoidalFunction<RT>()));
+
+        // Without renumbering the original ordering is the identity
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        coefficientsInOriginalOrdering(originalFun),
+                        originalFun.coefficients(), tolerance));
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        coefficientsInOriginalOrdering(mortonFun),
+                        originalFun.coefficients(), tolerance));
+
+        Bempp::GridFunction<BFT, RT> convertedFun =
+                gridFunctionFromOriginalOrdering<BFT, RT>(
+                    context, mortonSpace, originalFun.coefficients());
+        BOOST_CHECK(check_arrays_are_close<RT>(
+                        convertedFun.coefficients(), mortonFun.coefficients(),
+                        tolerance));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
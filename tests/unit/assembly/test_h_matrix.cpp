@@ -0,0 +1,501 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../type_template.hpp"
+#include "../random_arrays.hpp"
+
+#include "assembly/aca_options.hpp"
+#include "assembly/assembly_options.hpp"
+#include "assembly/discrete_h_matrix_boundary_operator.hpp"
+#include "assembly/h2_matrix.hpp"
+#include "assembly/h_matrix.hpp"
+#include "assembly/h_matrix_aca.hpp"
+#include "assembly/h_matrix_approximate_lu_inverse.hpp"
+#include "assembly/h_matrix_cluster.hpp"
+#include "assembly/h_matrix_lu.hpp"
+#include "assembly/h_matrix_near_field.hpp"
+#include "assembly/index_permutation.hpp"
+#include "common/armadillo_fwd.hpp"
+#include "common/shared_ptr.hpp"
+#include "common/types.hpp"
+#include "fiber/scalar_traits.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/type_traits/is_complex.hpp>
+#include <boost/utility/enable_if.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Points distributed quasi-uniformly on the unit sphere
+template <typename CoordinateType>
+std::vector<Point3D<CoordinateType> > spherePoints(int pointCount)
+{
+    std::vector<Point3D<CoordinateType> > points(pointCount);
+    const double goldenAngle = M_PI * (3. - std::sqrt(5.));
+    for (int i = 0; i < pointCount; ++i) {
+        const double z = 1. - (2. * i + 1.) / pointCount;
+        const double r = std::sqrt(1. - z * z);
+        points[i].x = r * std::cos(goldenAngle * i);
+        points[i].y = r * std::sin(goldenAngle * i);
+        points[i].z = z;
+    }
+    return points;
+}
+
+template <typename ValueType>
+typename boost::disable_if<boost::is_complex<ValueType>, ValueType>::type
+kernelValue(double distance)
+{
+    return 1. / (4. * M_PI * distance);
+}
+
+template <typename ValueType>
+typename boost::enable_if<boost::is_complex<ValueType>, ValueType>::type
+kernelValue(double distance)
+{
+    return ValueType(std::cos(distance), std::sin(distance)) /
+            typename ValueType::value_type(4. * M_PI * distance);
+}
+
+// Matrix of a single-layer-like kernel sampled at pairs of points, with a
+// dominant diagonal
+template <typename ValueType>
+class PointKernelGenerator : public HMatrixEntryGenerator<ValueType>
+{
+public:
+    typedef typename HMatrixEntryGenerator<ValueType>::CoordinateType
+    CoordinateType;
+
+    PointKernelGenerator(const std::vector<Point3D<CoordinateType> >& points,
+                         const std::vector<unsigned int>& p2o) :
+        m_points(points), m_p2o(p2o) {
+    }
+
+    ValueType entry(size_t row, size_t col) const {
+        if (row == col)
+            return ValueType(m_points.size() / 20.);
+        const Point3D<CoordinateType>& a = m_points[row];
+        const Point3D<CoordinateType>& b = m_points[col];
+        const double distance = std::sqrt(
+                    (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) +
+                    (a.z - b.z) * (a.z - b.z));
+        return kernelValue<ValueType>(distance);
+    }
+
+    virtual void evaluate(size_t rowBegin, size_t rowCount,
+                          size_t columnBegin, size_t columnCount,
+                          CoordinateType minimumDistance,
+                          arma::Mat<ValueType>& result) const {
+        result.set_size(rowCount, columnCount);
+        for (size_t c = 0; c < columnCount; ++c)
+            for (size_t r = 0; r < rowCount; ++r)
+                result(r, c) = entry(m_p2o[rowBegin + r],
+                                     m_p2o[columnBegin + c]);
+    }
+
+private:
+    const std::vector<Point3D<CoordinateType> >& m_points;
+    const std::vector<unsigned int>& m_p2o;
+};
+
+template <typename ValueType>
+typename Fiber::ScalarTraits<ValueType>::RealType
+frobeniusNorm(const arma::Mat<ValueType>& m)
+{
+    typename Fiber::ScalarTraits<ValueType>::RealType sum = 0.;
+    for (size_t c = 0; c < m.n_cols; ++c)
+        for (size_t r = 0; r < m.n_rows; ++r)
+            sum += std::abs(m(r, c)) * std::abs(m(r, c));
+    return std::sqrt(sum);
+}
+
+template <typename ValueType>
+typename Fiber::ScalarTraits<ValueType>::RealType
+relativeError(const arma::Mat<ValueType>& actual,
+              const arma::Mat<ValueType>& expected)
+{
+    arma::Mat<ValueType> difference = actual;
+    difference -= expected;
+    return frobeniusNorm(difference) / frobeniusNorm(expected);
+}
+
+template <typename ValueType>
+struct HMatrixFixture
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    typedef HMatrixCluster<CoordinateType> Cluster;
+
+    // If eta is 0, no blocks are admissible
+    explicit HMatrixFixture(int pointCount = 1000,
+                            double eta = AcaOptions().eta) :
+        points(spherePoints<CoordinateType>(pointCount))
+    {
+        shared_ptr<const Cluster> tree(
+                    Cluster::construct(points, 16, p2o).release());
+        generator.reset(new PointKernelGenerator<ValueType>(points, p2o));
+        AcaOptions acaOptions;
+        acaOptions.eps = eps();
+        acaOptions.eta = eta;
+        acaOptions.minimumBlockSize = 16;
+        hmat.reset(new HMatrix<ValueType>(tree, tree, acaOptions));
+        fillHMatrix(*hmat, *generator, eps(), 1000);
+
+        dense.set_size(points.size(), points.size());
+        generator->evaluate(0, points.size(), 0, points.size(), -1., dense);
+    }
+
+    static double eps() {
+        return sizeof(CoordinateType) == sizeof(float) ? 1e-4 : 1e-7;
+    }
+
+    std::vector<Point3D<CoordinateType> > points;
+    std::vector<unsigned int> p2o;
+    shared_ptr<PointKernelGenerator<ValueType> > generator;
+    shared_ptr<HMatrix<ValueType> > hmat;
+    arma::Mat<ValueType> dense; // in the permuted ordering
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatrixTests)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(cluster_tree_permutation_is_valid,
+                              ValueType, real_numeric_types)
+{
+    typedef HMatrixCluster<ValueType> Cluster;
+    std::vector<Point3D<ValueType> > points = spherePoints<ValueType>(1000);
+    std::vector<unsigned int> p2o;
+    std::auto_ptr<Cluster> tree = Cluster::construct(points, 16, p2o);
+
+    BOOST_CHECK_EQUAL(tree->size(), points.size());
+    std::vector<unsigned int> sorted(p2o);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        BOOST_REQUIRE_EQUAL(sorted[i], i);
+    BOOST_CHECK(tree->depth() >= 6);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(shared_cluster_tree_is_reused_while_alive,
+                              ValueType, real_numeric_types)
+{
+    typedef HMatrixCluster<ValueType> Cluster;
+    std::vector<Point3D<ValueType> > points = spherePoints<ValueType>(1000);
+    shared_ptr<const std::vector<unsigned int> > p2o1, p2o2, p2o3;
+    shared_ptr<const Cluster> tree1 = sharedClusterTree(points, 16, p2o1);
+    shared_ptr<const Cluster> tree2 = sharedClusterTree(points, 16, p2o2);
+    BOOST_CHECK(tree1 == tree2);
+    BOOST_CHECK(p2o1 == p2o2);
+
+    // A different leaf size or different points give a different tree
+    shared_ptr<const Cluster> tree3 = sharedClusterTree(points, 32, p2o3);
+    BOOST_CHECK(tree3 != tree1);
+    points[0].x += 1;
+    shared_ptr<const Cluster> tree4 = sharedClusterTree(points, 16, p2o3);
+    BOOST_CHECK(tree4 != tree1);
+    BOOST_CHECK_EQUAL(tree4->size(), points.size());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(h_matrix_agrees_with_dense_matrix,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    BOOST_CHECK(relativeError(f.hmat->asMatrix(), f.dense) <
+                10. * HMatrixFixture<ValueType>::eps());
+    // The matrix should be compressed
+    BOOST_CHECK(f.hmat->storedEntryCount() < f.dense.n_elem);
+    BOOST_CHECK(f.hmat->maximumRank() > 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(apply_agrees_with_dense_matrix,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    const double tolerance = 10. * HMatrixFixture<ValueType>::eps();
+    const size_t n = f.dense.n_rows;
+    arma::Col<ValueType> x = generateRandomVector<ValueType>(n);
+    arma::Col<ValueType> y = generateRandomVector<ValueType>(n);
+    const ValueType alpha = 2., beta = 3.;
+
+    arma::Col<ValueType> expected = beta * y + alpha * (f.dense * x);
+    arma::Col<ValueType> actual = y;
+    f.hmat->apply(NO_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.st() * x);
+    actual = y;
+    f.hmat->apply(TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.t() * x);
+    actual = y;
+    f.hmat->apply(CONJUGATE_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.t().st() * x);
+    actual = y;
+    f.hmat->apply(CONJUGATE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(coarsening_preserves_accuracy,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    const size_t entryCountBefore = f.hmat->storedEntryCount();
+    f.hmat->coarsen(HMatrixFixture<ValueType>::eps(), 1000);
+    BOOST_CHECK(f.hmat->storedEntryCount() <= entryCountBefore);
+    BOOST_CHECK(relativeError(f.hmat->asMatrix(), f.dense) <
+                20. * HMatrixFixture<ValueType>::eps());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(lu_decomposition_solves_system,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    const size_t n = f.dense.n_rows;
+    arma::Mat<ValueType> rhs = generateRandomMatrix<ValueType>(n, 2);
+    arma::Mat<ValueType> solution = rhs;
+    hMatrixLuDecompose(*f.hmat, HMatrixFixture<ValueType>::eps(), 1000);
+    hMatrixLuSolve(*f.hmat, solution);
+    BOOST_CHECK(relativeError<ValueType>(f.dense * solution, rhs) <
+                100. * HMatrixFixture<ValueType>::eps());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(lu_decomposition_of_clone_leaves_original_intact,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    const size_t n = f.dense.n_rows;
+    const arma::Mat<ValueType> before = f.hmat->asMatrix();
+    std::auto_ptr<HMatrix<ValueType> > lu = f.hmat->clone();
+    BOOST_CHECK(relativeError(lu->asMatrix(), before) < 1e-12);
+
+    arma::Mat<ValueType> rhs = generateRandomMatrix<ValueType>(n, 3);
+    arma::Mat<ValueType> solution = rhs;
+    hMatrixLuDecompose(*lu, HMatrixFixture<ValueType>::eps(), 1000);
+    hMatrixLuSolve(*lu, solution);
+    BOOST_CHECK(relativeError<ValueType>(f.dense * solution, rhs) <
+                100. * HMatrixFixture<ValueType>::eps());
+    BOOST_CHECK(relativeError(f.hmat->asMatrix(), before) < 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(approximate_lu_inverse_inverts_operator_in_original_ordering,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f(400);
+    const size_t n = f.dense.n_rows;
+    const double tolerance = 100. * HMatrixFixture<ValueType>::eps();
+
+    // Operator indexed with the original (unpermuted) DOF numbers
+    std::vector<unsigned int> o2p(n);
+    for (size_t i = 0; i < n; ++i)
+        o2p[f.p2o[i]] = i;
+    const IndexPermutation permutation(o2p);
+    shared_ptr<const DiscreteBoundaryOperator<ValueType> > op(
+                new DiscreteHMatrixBoundaryOperator<ValueType>(
+                    f.hmat, permutation, permutation,
+                    HMatrixFixture<ValueType>::eps(), 1000,
+                    ParallelizationOptions()));
+    arma::Mat<ValueType> original(n, n);
+    for (size_t c = 0; c < n; ++c)
+        for (size_t r = 0; r < n; ++r)
+            original(f.p2o[r], f.p2o[c]) = f.dense(r, c);
+    BOOST_REQUIRE(relativeError(op->asMatrix(), original) < tolerance);
+
+    shared_ptr<const DiscreteBoundaryOperator<ValueType> > inverse =
+            acaOperatorApproximateLuInverse(
+                op, HMatrixFixture<ValueType>::eps());
+    BOOST_CHECK(dynamic_cast<const HMatrixApproximateLuInverse<ValueType>*>(
+                    inverse.get()));
+    BOOST_CHECK_EQUAL(inverse->rowCount(), n);
+    BOOST_CHECK_EQUAL(inverse->columnCount(), n);
+
+    // Applying the inverse to all columns of the operator at once (i.e. to
+    // multiple right-hand sides) yields the identity
+    arma::Mat<ValueType> identity(n, n);
+    identity.fill(0.);
+    for (size_t i = 0; i < n; ++i)
+        identity(i, i) = 1.;
+    arma::Mat<ValueType> product(n, n);
+    inverse->apply(NO_TRANSPOSE, original, product,
+                   static_cast<ValueType>(1.), static_cast<ValueType>(0.));
+    BOOST_CHECK(relativeError(product, identity) < tolerance);
+
+    // alpha and beta are taken into account
+    arma::Mat<ValueType> solution = generateRandomMatrix<ValueType>(n, 3);
+    arma::Mat<ValueType> rhs = original * solution;
+    arma::Mat<ValueType> y = generateRandomMatrix<ValueType>(n, 3);
+    arma::Mat<ValueType> expected = static_cast<ValueType>(2.) * solution;
+    expected -= y;
+    inverse->apply(NO_TRANSPOSE, rhs, y,
+                   static_cast<ValueType>(2.), static_cast<ValueType>(-1.));
+    BOOST_CHECK(relativeError(y, expected) < tolerance);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(near_field_inverses_are_exact_without_far_field,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f(200, 0. /* eta */);
+    const size_t n = f.dense.n_rows;
+    arma::Mat<ValueType> identity(n, n);
+    identity.fill(0.);
+    for (size_t i = 0; i < n; ++i)
+        identity(i, i) = 1.;
+    const double tolerance = 100. * HMatrixFixture<ValueType>::eps();
+
+    std::auto_ptr<CompressedRowMatrix<ValueType> > spai =
+            hMatrixNearFieldSparseApproximateInverse(*f.hmat);
+    BOOST_CHECK(relativeError<ValueType>(spai->asMatrix() * f.dense, identity) <
+                tolerance);
+    std::auto_ptr<CompressedRowMatrix<ValueType> > blockJacobi =
+            hMatrixNearFieldBlockJacobiInverse(*f.hmat, 1);
+    BOOST_CHECK(relativeError<ValueType>(
+                    blockJacobi->asMatrix() * f.dense, identity) < tolerance);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(near_field_inverses_approximate_inverse,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    const size_t n = f.dense.n_rows;
+    arma::Mat<ValueType> identity(n, n);
+    identity.fill(0.);
+    for (size_t i = 0; i < n; ++i)
+        identity(i, i) = 1.;
+
+    std::auto_ptr<CompressedRowMatrix<ValueType> > spai =
+            hMatrixNearFieldSparseApproximateInverse(*f.hmat);
+    std::auto_ptr<CompressedRowMatrix<ValueType> > blockJacobi0 =
+            hMatrixNearFieldBlockJacobiInverse(*f.hmat, 0);
+    std::auto_ptr<CompressedRowMatrix<ValueType> > blockJacobi1 =
+            hMatrixNearFieldBlockJacobiInverse(*f.hmat, 1);
+    BOOST_CHECK(spai->nonzeroCount() < n * n / 2);
+    BOOST_CHECK(blockJacobi0->nonzeroCount() < blockJacobi1->nonzeroCount());
+
+    // The residual I - M * A is much smaller than that of the diagonal scaling
+    arma::Mat<ValueType> jacobi(n, n);
+    jacobi.fill(0.);
+    for (size_t i = 0; i < n; ++i)
+        jacobi(i, i) = static_cast<ValueType>(1.) / f.dense(i, i);
+    const double jacobiError = relativeError<ValueType>(jacobi * f.dense, identity);
+    const double spaiError =
+            relativeError<ValueType>(spai->asMatrix() * f.dense, identity);
+    const double blockJacobi0Error =
+            relativeError<ValueType>(blockJacobi0->asMatrix() * f.dense, identity);
+    const double blockJacobi1Error =
+            relativeError<ValueType>(blockJacobi1->asMatrix() * f.dense, identity);
+    BOOST_CHECK(spaiError < 0.5 * jacobiError);
+    BOOST_CHECK(blockJacobi0Error < jacobiError);
+    BOOST_CHECK(blockJacobi1Error < blockJacobi0Error);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(compressed_row_matrix_apply_agrees_with_dense_matrix,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    std::auto_ptr<CompressedRowMatrix<ValueType> > spai =
+            hMatrixNearFieldSparseApproximateInverse(*f.hmat);
+    const arma::Mat<ValueType> dense = spai->asMatrix();
+    const double tolerance = 10. * HMatrixFixture<ValueType>::eps();
+    const size_t n = dense.n_rows;
+    arma::Mat<ValueType> x = generateRandomMatrix<ValueType>(n, 2);
+    arma::Mat<ValueType> y = generateRandomMatrix<ValueType>(n, 2);
+    const ValueType alpha = 2., beta = 3.;
+
+    arma::Mat<ValueType> expected = beta * y + alpha * (dense * x);
+    arma::Mat<ValueType> actual = y;
+    spai->apply(NO_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (dense.st() * x);
+    actual = y;
+    spai->apply(TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (dense.t() * x);
+    actual = y;
+    spai->apply(CONJUGATE_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (dense.t().st() * x);
+    actual = y;
+    spai->apply(CONJUGATE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(h2_matrix_agrees_with_dense_matrix,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    H2Matrix<ValueType> h2mat(*f.hmat, HMatrixFixture<ValueType>::eps(), 1000);
+    BOOST_CHECK(relativeError(h2mat.asMatrix(), f.dense) <
+                100. * HMatrixFixture<ValueType>::eps());
+    BOOST_CHECK(h2mat.maximumRank() > 0);
+
+    const arma::Mat<ValueType> h2Dense = h2mat.asMatrix();
+    for (size_t k = 0; k < 100; ++k) {
+        const size_t row = (37 * k) % h2Dense.n_rows;
+        const size_t col = (101 * k + 13) % h2Dense.n_cols;
+        BOOST_CHECK(std::abs(h2mat.entry(row, col) - h2Dense(row, col)) <=
+                    100. * HMatrixFixture<ValueType>::eps() *
+                    std::abs(f.dense(row, col)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(h2_matrix_apply_agrees_with_dense_matrix,
+                              ValueType, result_types)
+{
+    HMatrixFixture<ValueType> f;
+    H2Matrix<ValueType> h2mat(*f.hmat, HMatrixFixture<ValueType>::eps(), 1000);
+    const double tolerance = 100. * HMatrixFixture<ValueType>::eps();
+    const size_t n = f.dense.n_rows;
+    arma::Col<ValueType> x = generateRandomVector<ValueType>(n);
+    arma::Col<ValueType> y = generateRandomVector<ValueType>(n);
+    const ValueType alpha = 2., beta = 3.;
+
+    arma::Col<ValueType> expected = beta * y + alpha * (f.dense * x);
+    arma::Col<ValueType> actual = y;
+    h2mat.apply(NO_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.st() * x);
+    actual = y;
+    h2mat.apply(TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.t() * x);
+    actual = y;
+    h2mat.apply(CONJUGATE_TRANSPOSE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+
+    expected = beta * y + alpha * (f.dense.t().st() * x);
+    actual = y;
+    h2mat.apply(CONJUGATE, x, actual, alpha, beta);
+    BOOST_CHECK(relativeError<ValueType>(actual, expected) < tolerance);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../type_template.hpp"
+
+#include "assembly/assembly_options.hpp"
+#include "assembly/context.hpp"
+#include "assembly/evaluation_options.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/laplace_3d_single_layer_potential_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+#include "assembly/surface_normal_independent_function.hpp"
+
+#include "common/scalar_traits.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+template <typename ValueType_>
+class LinearFunction
+{
+public:
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    inline void evaluate(const arma::Col<CoordinateType>& point,
+                         arma::Col<ValueType>& result) const {
+        result(0) = 1. + point(0) - 2. * point(2);
+    }
+};
+
+// Points at the given distance from the unit sphere, in directions not
+// aligned with any mesh features
+template <typename CoordinateType>
+arma::Mat<CoordinateType> pointsNearUnitSphere(CoordinateType radius)
+{
+    const int pointCount = 20;
+    arma::Mat<CoordinateType> points(3, pointCount);
+    for (int i = 0; i < pointCount; ++i) {
+        const CoordinateType z = -0.95 + 1.9 * (i + 0.5) / pointCount;
+        const CoordinateType phi = 2.4 * i + 0.3;
+        const CoordinateType rho = std::sqrt(1. - z * z);
+        points(0, i) = radius * rho * std::cos(phi);
+        points(1, i) = radius * rho * std::sin(phi);
+        points(2, i) = radius * z;
+    }
+    return points;
+}
+
+template <typename ValueType>
+typename ScalarTraits<ValueType>::RealType
+maxRelativeDifference(const arma::Mat<ValueType>& actual,
+                      const arma::Mat<ValueType>& expected)
+{
+    typedef typename ScalarTraits<ValueType>::RealType MagnitudeType;
+    MagnitudeType maxDiff = 0., maxValue = 0.;
+    for (size_t i = 0; i < expected.n_elem; ++i) {
+        maxDiff = std::max<MagnitudeType>(
+                    maxDiff, std::abs(actual[i] - expected[i]));
+        maxValue = std::max<MagnitudeType>(maxValue, std::abs(expected[i]));
+    }
+    return maxDiff / maxValue;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(Laplace3dSingleLayerPotentialOperator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(evaluateAtPoints_is_accurate_within_one_element_diameter_of_the_surface,
+                              ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    GridFunction<BFT, RT> fun(context, space, space,
+                surfaceNormalIndependentFunction(LinearFunction<RT>()));
+
+    // Reference: quadrature of a very high order on all elements
+    AccuracyOptionsEx referenceAccuracyOptions;
+    referenceAccuracyOptions.setSingleRegular(20, false /* absolute */);
+    NumericalQuadratureStrategy<BFT, RT> referenceQuadStrategy(
+                referenceAccuracyOptions);
+
+    EvaluationOptions evaluationOptions;
+    evaluationOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    Bempp::Laplace3dSingleLayerPotentialOperator<BFT, RT> op;
+
+    // The mesh size is 0.2, so these points lie within one element diameter
+    // of the (polyhedral) surface, on both sides of it
+    const CT radii[] = {0.9, 1.1};
+    for (int r = 0; r < 2; ++r) {
+        arma::Mat<CT> points = pointsNearUnitSphere<CT>(radii[r]);
+        arma::Mat<RT> values = op.evaluateAtPoints(
+                    fun, points, *quadStrategy, evaluationOptions);
+        arma::Mat<RT> expected = op.evaluateAtPoints(
+                    fun, points, referenceQuadStrategy, evaluationOptions);
+        BOOST_REQUIRE_EQUAL(values.n_cols, points.n_cols);
+        BOOST_CHECK_SMALL(maxRelativeDifference(values, expected), CT(1e-3));
+    }
+
+    // Points far away from the surface
+    arma::Mat<CT> points = pointsNearUnitSphere<CT>(3.);
+    arma::Mat<RT> values = op.evaluateAtPoints(
+                fun, points, *quadStrategy, evaluationOptions);
+    arma::Mat<RT> expected = op.evaluateAtPoints(
+                fun, points, referenceQuadStrategy, evaluationOptions);
+    BOOST_CHECK_SMALL(maxRelativeDifference(values, expected), CT(1e-4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -232,4 +232,24 @@ BOOST_AUTO_TEST_CASE(quadratureOrder_agrees_with_setDoubleRegular_for_three_rela
     BOOST_CHECK_EQUAL(orderFar, defaultOrder + order3);
 }
 
+BOOST_AUTO_TEST_CASE(increaseQuadratureOrders_shifts_relative_and_absolute_orders)
+{
+    Fiber::AccuracyOptionsEx opts;
+    const int defaultOrder = 3;
+    const double maxNormalizedDistance1 = 4.;
+    opts.setSingleRegular(2);
+    opts.setDoubleRegular(maxNormalizedDistance1, 5, 2, false /* absolute */);
+    opts.setDoubleSingular(1, false /* absolute */);
+    opts.increaseQuadratureOrders(-1, 1, -2);
+
+    BOOST_CHECK_EQUAL(opts.singleRegular().quadratureOrder(defaultOrder),
+                      defaultOrder + 1);
+    BOOST_CHECK_EQUAL(opts.doubleRegular(maxNormalizedDistance1 - 0.1)
+                      .quadratureOrder(defaultOrder), 6);
+    BOOST_CHECK_EQUAL(opts.doubleRegular(maxNormalizedDistance1 + 0.1)
+                      .quadratureOrder(defaultOrder), 3);
+    // absolute orders are not decreased below zero
+    BOOST_CHECK_EQUAL(opts.doubleSingular().quadratureOrder(defaultOrder), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
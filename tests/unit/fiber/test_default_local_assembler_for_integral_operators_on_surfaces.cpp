@@ -344,6 +344,94 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
             ResultType>(true);
 }
 
+template <typename ResultType>
+void
+batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_and_cacheSingularIntegrals(
+        Fiber::CallVariant callVariant, bool cacheSingularIntegrals)
+{
+    DefaultLocalAssemblerForIntegralOperatorsOnSurfacesManager<
+            typename ScalarTraits<ResultType>::RealType, ResultType> mgr(
+                cacheSingularIntegrals);
+
+    const int elementCount = N_ELEMENTS_X * N_ELEMENTS_Y * 2;
+    std::vector<int> elementIndicesA(elementCount);
+    for (int i = 0; i < elementCount; ++i)
+        elementIndicesA[i] = i;
+
+    // Elements B include neighbours of all elements A (so that both cached
+    // singular and regular integrals are exercised) and repeat element 2
+    // with different local DOFs. Elements B are trial elements (with one
+    // piecewise constant DOF) for TEST_TRIAL and test elements (with three
+    // piecewise linear DOFs) for TRIAL_TEST.
+    const int elementIndicesBData[] = {2, 0, 2, 7, 11, 2};
+    const int testTrialLocalDofIndicesBData[] = {
+        0, Fiber::ALL_DOFS, Fiber::ALL_DOFS, 0, Fiber::ALL_DOFS, 0};
+    const int trialTestLocalDofIndicesBData[] = {
+        0, Fiber::ALL_DOFS, 2, 1, Fiber::ALL_DOFS, 1};
+    const int* localDofIndicesBData = callVariant == Fiber::TEST_TRIAL ?
+                testTrialLocalDofIndicesBData : trialTestLocalDofIndicesBData;
+    std::vector<int> elementIndicesB;
+    std::vector<Fiber::LocalDofIndex> localDofIndicesB;
+    for (size_t j = 0; j < sizeof(elementIndicesBData) / sizeof(int); ++j) {
+        elementIndicesB.push_back(elementIndicesBData[j]);
+        localDofIndicesB.push_back(localDofIndicesBData[j]);
+    }
+
+    Fiber::_2dArray<arma::Mat<ResultType> > batchedResult;
+    mgr.assembler->evaluateLocalWeakForms(callVariant, elementIndicesA,
+                                          elementIndicesB, localDofIndicesB,
+                                          batchedResult);
+    BOOST_REQUIRE_EQUAL(batchedResult.extent(0), elementIndicesA.size());
+    BOOST_REQUIRE_EQUAL(batchedResult.extent(1), elementIndicesB.size());
+
+    Fiber::_2dArray<arma::Mat<ResultType> > unbatchedResult(
+                elementIndicesA.size(), elementIndicesB.size());
+    std::vector<arma::Mat<ResultType> > singleResult;
+    for (size_t j = 0; j < elementIndicesB.size(); ++j) {
+        mgr.assembler->evaluateLocalWeakForms(callVariant, elementIndicesA,
+                                              elementIndicesB[j],
+                                              localDofIndicesB[j],
+                                              singleResult);
+        for (size_t i = 0; i < elementIndicesA.size(); ++i)
+            unbatchedResult(i, j) = singleResult[i];
+    }
+
+    BOOST_CHECK(check_arrays_are_close<ResultType>(
+                    batchedResult, unbatchedResult, 1e-10));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+        batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_TEST_TRIAL_and_cacheSingularIntegrals_false,
+        ResultType, result_types)
+{
+    batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_and_cacheSingularIntegrals<
+            ResultType>(Fiber::TEST_TRIAL, false);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+        batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_TEST_TRIAL_and_cacheSingularIntegrals_true,
+        ResultType, result_types)
+{
+    batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_and_cacheSingularIntegrals<
+            ResultType>(Fiber::TEST_TRIAL, true);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+        batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_TRIAL_TEST_and_cacheSingularIntegrals_false,
+        ResultType, result_types)
+{
+    batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_and_cacheSingularIntegrals<
+            ResultType>(Fiber::TRIAL_TEST, false);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+        batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_TRIAL_TEST_and_cacheSingularIntegrals_true,
+        ResultType, result_types)
+{
+    batched_and_unbatched_evaluateLocalWeakForms_agree_for_callVariant_and_cacheSingularIntegrals<
+            ResultType>(Fiber::TRIAL_TEST, true);
+}
+
 template <typename ResultType>
 void
 evaluateLocalWeakForms_with_and_without_singular_integral_caching_gives_same_results(
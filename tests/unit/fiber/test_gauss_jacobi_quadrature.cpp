@@ -0,0 +1,96 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "fiber/gauss_jacobi_quadrature.hpp"
+#include "fiber/numerical_quadrature.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <cmath>
+
+// Tests
+
+using namespace Fiber;
+
+namespace
+{
+
+double factorial(int n)
+{
+    double result = 1.;
+    for (int i = 2; i <= n; ++i)
+        result *= i;
+    return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(GaussJacobiQuadrature)
+
+BOOST_AUTO_TEST_CASE(gauss_legendre_rule_integrates_polynomials_exactly)
+{
+    const int pointCount = 7;
+    std::vector<double> points, weights;
+    fillGaussJacobiPointsAndWeights(pointCount, 0., 0., points, weights);
+
+    for (int degree = 0; degree < 2 * pointCount; ++degree) {
+        double approx = 0.;
+        for (int i = 0; i < pointCount; ++i)
+            approx += weights[i] * std::pow(points[i], degree);
+        const double exact = (degree % 2 == 0) ? 2. / (degree + 1) : 0.;
+        BOOST_CHECK_SMALL(approx - exact, 1e-13);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(collapsed_triangle_rule_of_order_25_integrates_monomials_exactly)
+{
+    const int order = 25;
+    arma::Mat<double> points;
+    std::vector<double> weights;
+    fillCollapsedGaussTrianglePointsAndWeights(order, points, weights);
+
+    for (int a = 0; a <= order; ++a)
+        for (int b = 0; a + b <= order; ++b) {
+            double approx = 0.;
+            for (size_t i = 0; i < weights.size(); ++i)
+                approx += weights[i] * std::pow(points(0, i), a) *
+                        std::pow(points(1, i), b);
+            const double exact =
+                    factorial(a) * factorial(b) / factorial(a + b + 2);
+            BOOST_CHECK_CLOSE(approx, exact, 1e-9 /* percent */);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(fillSingleQuadraturePointsAndWeights_supports_orders_beyond_tables)
+{
+    const int order = 31;
+    arma::Mat<double> points;
+    std::vector<double> weights;
+    fillSingleQuadraturePointsAndWeights(3, order, points, weights);
+
+    BOOST_CHECK_EQUAL(weights.size(), 16u * 16u);
+    double sum = 0.;
+    for (size_t i = 0; i < weights.size(); ++i)
+        sum += weights[i];
+    BOOST_CHECK_CLOSE(sum, 0.5, 1e-10 /* percent */);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "type_template.hpp"
+#include "check_arrays_are_close.hpp"
+
+#include "fiber/numerical_quadrature.hpp"
+#include "fiber/quadrature_rule_registry.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+// Tests
+
+using namespace Fiber;
+
+BOOST_AUTO_TEST_SUITE(QuadratureRuleRegistry)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(singleRule_agrees_with_fillSingleQuadraturePointsAndWeights,
+                              ValueType, real_numeric_types)
+{
+    arma::Mat<ValueType> expectedPoints;
+    std::vector<ValueType> expectedWeights;
+    fillSingleQuadraturePointsAndWeights(3, 6, expectedPoints, expectedWeights);
+
+    const SingleQuadratureRule<ValueType>& rule =
+            Fiber::QuadratureRuleRegistry<ValueType>::instance().singleRule(3, 6);
+
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    rule.points, expectedPoints,
+                    10. * std::numeric_limits<ValueType>::epsilon()));
+    BOOST_CHECK_EQUAL_COLLECTIONS(rule.weights.begin(), rule.weights.end(),
+                                  expectedWeights.begin(), expectedWeights.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(singleRule_returns_the_same_object_for_equal_descriptors,
+                              ValueType, real_numeric_types)
+{
+    Fiber::QuadratureRuleRegistry<ValueType>& registry =
+            Fiber::QuadratureRuleRegistry<ValueType>::instance();
+    const SingleQuadratureRule<ValueType>& rule1 = registry.singleRule(4, 5);
+    const size_t count = registry.singleRuleCount();
+    const SingleQuadratureRule<ValueType>& rule2 = registry.singleRule(4, 5);
+
+    BOOST_CHECK_EQUAL(&rule1, &rule2);
+    BOOST_CHECK_EQUAL(registry.singleRuleCount(), count);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(doubleSingularRule_agrees_with_fillDoubleSingularQuadraturePointsAndWeights,
+                              ValueType, real_numeric_types)
+{
+    DoubleQuadratureDescriptor desc;
+    desc.topology.type = ElementPairTopology::SharedEdge;
+    desc.topology.testVertexCount = 3;
+    desc.topology.trialVertexCount = 3;
+    desc.topology.testSharedVertex0 = 1;
+    desc.topology.testSharedVertex1 = 2;
+    desc.topology.trialSharedVertex0 = 0;
+    desc.topology.trialSharedVertex1 = 2;
+    desc.testOrder = 4;
+    desc.trialOrder = 5;
+
+    arma::Mat<ValueType> expectedTestPoints, expectedTrialPoints;
+    std::vector<ValueType> expectedWeights;
+    fillDoubleSingularQuadraturePointsAndWeights(
+                desc, expectedTestPoints, expectedTrialPoints, expectedWeights);
+
+    Fiber::QuadratureRuleRegistry<ValueType>& registry =
+            Fiber::QuadratureRuleRegistry<ValueType>::instance();
+    const DoubleQuadratureRule<ValueType>& rule = registry.doubleSingularRule(desc);
+
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    rule.testPoints, expectedTestPoints,
+                    10. * std::numeric_limits<ValueType>::epsilon()));
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    rule.trialPoints, expectedTrialPoints,
+                    10. * std::numeric_limits<ValueType>::epsilon()));
+    BOOST_CHECK_EQUAL_COLLECTIONS(rule.weights.begin(), rule.weights.end(),
+                                  expectedWeights.begin(), expectedWeights.end());
+    BOOST_CHECK_EQUAL(&rule, &registry.doubleSingularRule(desc));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/element_pair_topology.hpp"
+#include "fiber/raw_grid_geometry.hpp"
+
+#include <armadillo>
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+// Two triangles forming the square [0, 2] x [0, 1] x {1}, with corners
+// padded to four rows as returned by GridView::getRawElementData()
+void fillTriangleGeometry(Fiber::RawGridGeometry<double>& rawGeometry)
+{
+    const double vertexData[4][3] = {{0., 0., 1.}, {2., 0., 1.},
+                                     {2., 1., 1.}, {0., 1., 1.}};
+    arma::Mat<double>& vertices = rawGeometry.vertices();
+    vertices.set_size(3, 4);
+    for (int v = 0; v < 4; ++v)
+        for (int i = 0; i < 3; ++i)
+            vertices(i, v) = vertexData[v][i];
+    const int cornerData[2][4] = {{0, 1, 2, -1}, {0, 2, 3, -1}};
+    arma::Mat<int>& corners = rawGeometry.elementCornerIndices();
+    corners.set_size(4, 2);
+    for (int e = 0; e < 2; ++e)
+        for (int c = 0; c < 4; ++c)
+            corners(c, e) = cornerData[e][c];
+    rawGeometry.auxData().set_size(0, 2);
+}
+
+// Geometry recording the corners passed to setup()
+struct CornerRecorder
+{
+    void setup(const arma::Mat<double>& corners, const arma::Col<char>&) {
+        this->corners = corners;
+    }
+    arma::Mat<double> corners;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RawGridGeometry_)
+
+BOOST_AUTO_TEST_CASE(removeCornerIndexPadding_removes_padding_of_triangles)
+{
+    Fiber::RawGridGeometry<double> rawGeometry(2, 3);
+    fillTriangleGeometry(rawGeometry);
+    rawGeometry.removeCornerIndexPadding();
+
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerIndices().n_rows, 3u);
+    BOOST_CHECK_EQUAL(rawGeometry.elementCount(), 2);
+    for (int e = 0; e < 2; ++e)
+        BOOST_CHECK_EQUAL(rawGeometry.elementCornerCount(e), 3);
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerIndexArray(1)[2], 3);
+}
+
+BOOST_AUTO_TEST_CASE(removeCornerIndexPadding_does_nothing_for_quadrilaterals)
+{
+    Fiber::RawGridGeometry<double> rawGeometry(2, 3);
+    fillTriangleGeometry(rawGeometry);
+    rawGeometry.elementCornerIndices()(3, 1) = 3;
+    rawGeometry.removeCornerIndexPadding();
+
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerIndices().n_rows, 4u);
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerCount(0), 3);
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerCount(1), 4);
+}
+
+BOOST_AUTO_TEST_CASE(removeCornerIndexPadding_does_nothing_for_planar_grids)
+{
+    Fiber::RawGridGeometry<double> rawGeometry(2, 2);
+    fillTriangleGeometry(rawGeometry);
+    rawGeometry.vertices().shed_row(2);
+    rawGeometry.removeCornerIndexPadding();
+
+    BOOST_CHECK_EQUAL(rawGeometry.elementCornerIndices().n_rows, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(setupGeometry_passes_element_corners)
+{
+    Fiber::RawGridGeometry<double> rawGeometry(2, 3);
+    fillTriangleGeometry(rawGeometry);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1)
+            rawGeometry.removeCornerIndexPadding();
+        CornerRecorder geometry;
+        rawGeometry.setupGeometry(1, geometry);
+        BOOST_REQUIRE_EQUAL(geometry.corners.n_rows, 3u);
+        BOOST_REQUIRE_EQUAL(geometry.corners.n_cols, 3u);
+        for (int c = 0; c < 3; ++c)
+            for (int i = 0; i < 3; ++i)
+                BOOST_CHECK_EQUAL(geometry.corners(i, c),
+                                  rawGeometry.vertices()(
+                                      i, rawGeometry.elementCornerIndices()(c, 1)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(topology_from_corner_arrays_agrees_with_topology_from_vectors)
+{
+    Fiber::RawGridGeometry<double> rawGeometry(2, 3);
+    fillTriangleGeometry(rawGeometry);
+    rawGeometry.removeCornerIndexPadding();
+
+    for (int testE = 0; testE < 2; ++testE)
+        for (int trialE = 0; trialE < 2; ++trialE) {
+            Fiber::ElementPairTopology fromArrays =
+                    Fiber::determineElementPairTopologyIn3D(
+                        rawGeometry.elementCornerIndexArray(testE), 3,
+                        rawGeometry.elementCornerIndexArray(trialE), 3);
+            Fiber::ElementPairTopology fromVectors =
+                    Fiber::determineElementPairTopologyIn3D(
+                        rawGeometry.elementCornerIndices(testE),
+                        rawGeometry.elementCornerIndices(trialE));
+            BOOST_CHECK_EQUAL(fromArrays, fromVectors);
+            BOOST_CHECK_EQUAL(fromArrays.type, testE == trialE ?
+                                  Fiber::ElementPairTopology::Coincident :
+                                  Fiber::ElementPairTopology::SharedEdge);
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
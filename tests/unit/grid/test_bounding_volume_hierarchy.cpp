@@ -0,0 +1,364 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid/bounding_volume_hierarchy.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include <algorithm>
+#include <armadillo>
+#include <cmath>
+#include <cstdlib>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Surface of the unit cube [0, 1]^3, each face divided into n x n
+// quadrilaterals with corners in the Dune (lexicographic) order
+void createCubeSurface(int n, arma::Mat<double>& vertices,
+                       arma::Mat<int>& elementCorners)
+{
+    const int faceVertexCount = (n + 1) * (n + 1);
+    vertices.set_size(3, 6 * faceVertexCount);
+    elementCorners.set_size(4, 6 * n * n);
+    int element = 0;
+    for (int face = 0; face < 6; ++face) {
+        const int normalDim = face / 2;
+        const int uDim = (normalDim + 1) % 3;
+        const int vDim = (normalDim + 2) % 3;
+        const double normalCoord = face % 2;
+        const int offset = face * faceVertexCount;
+        for (int j = 0; j <= n; ++j)
+            for (int i = 0; i <= n; ++i) {
+                const int vertex = offset + j * (n + 1) + i;
+                vertices(normalDim, vertex) = normalCoord;
+                vertices(uDim, vertex) = double(i) / n;
+                vertices(vDim, vertex) = double(j) / n;
+            }
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i, ++element) {
+                elementCorners(0, element) = offset + j * (n + 1) + i;
+                elementCorners(1, element) = offset + j * (n + 1) + i + 1;
+                elementCorners(2, element) = offset + (j + 1) * (n + 1) + i;
+                elementCorners(3, element) = offset + (j + 1) * (n + 1) + i + 1;
+            }
+    }
+}
+
+double randomCoordinate(double min, double max)
+{
+    return min + (max - min) * std::rand() / double(RAND_MAX);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(BoundingVolumeHierarchy)
+
+BOOST_AUTO_TEST_CASE(quadrilaterals_are_split_into_two_triangles)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    BOOST_CHECK_EQUAL(bvh.elementCount(), (size_t)(6 * 5 * 5));
+    BOOST_CHECK_EQUAL(bvh.triangleCount(), (size_t)(2 * 6 * 5 * 5));
+}
+
+BOOST_AUTO_TEST_CASE(triangles_cover_a_quadrilateral_in_dune_order)
+{
+    // Unit square in the plane z = 1; corners in the Dune order
+    arma::Mat<double> vertices(3, 4);
+    vertices.fill(1.);
+    vertices(0, 0) = 0.; vertices(1, 0) = 0.;
+    vertices(0, 1) = 1.; vertices(1, 1) = 0.;
+    vertices(0, 2) = 0.; vertices(1, 2) = 1.;
+    vertices(0, 3) = 1.; vertices(1, 3) = 1.;
+    arma::Mat<int> elementCorners(4, 1);
+    for (int c = 0; c < 4; ++c)
+        elementCorners(c, 0) = c;
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    // Points near each of the four corners
+    const double coords[4][2] = {{0.1, 0.1}, {0.9, 0.2}, {0.2, 0.9}, {0.9, 0.8}};
+    std::vector<double> heights;
+    for (int i = 0; i < 4; ++i) {
+        double point[3] = {coords[i][0], coords[i][1], 0.};
+        bvh.zRayIntersections(point, heights);
+        BOOST_REQUIRE_EQUAL(heights.size(), (size_t)1);
+        BOOST_CHECK_CLOSE(heights[0], 1., 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zRayIntersections_works_for_points_inside_the_cube)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    std::srand(1);
+    std::vector<double> heights;
+    for (int i = 0; i < 100; ++i) {
+        double point[3];
+        for (int dim = 0; dim < 3; ++dim)
+            point[dim] = randomCoordinate(0.05, 0.95);
+        bvh.zRayIntersections(point, heights);
+        BOOST_REQUIRE_EQUAL(heights.size(), (size_t)1);
+        BOOST_CHECK_CLOSE(heights[0], 1., 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(zRayIntersections_works_for_points_below_the_cube)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    std::srand(1);
+    std::vector<double> heights;
+    for (int i = 0; i < 100; ++i) {
+        // The ray passes through edges and vertices shared by several
+        // elements for some of these points
+        double point[3] = {
+            std::floor(randomCoordinate(0., 1.) * 10.) / 10.,
+            std::floor(randomCoordinate(0., 1.) * 10.) / 10.,
+            -1.};
+        bvh.zRayIntersections(point, heights);
+        BOOST_REQUIRE_EQUAL(heights.size(), (size_t)2);
+        BOOST_CHECK_SMALL(heights[0], 1e-10);
+        BOOST_CHECK_CLOSE(heights[1], 1., 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nearestElement_works_for_points_inside_the_cube)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    std::srand(1);
+    for (int i = 0; i < 100; ++i) {
+        double point[3];
+        for (int dim = 0; dim < 3; ++dim)
+            point[dim] = randomCoordinate(0.05, 0.95);
+        double expectedDistance = 1.;
+        for (int dim = 0; dim < 3; ++dim)
+            expectedDistance = std::min(expectedDistance,
+                                        std::min(point[dim], 1. - point[dim]));
+
+        double distance;
+        const int element = bvh.nearestElement(point, &distance);
+        BOOST_CHECK_CLOSE(distance, expectedDistance, 1e-8);
+        BOOST_REQUIRE(element >= 0 && element < (int)elementCorners.n_cols);
+
+        // The nearest element should lie on the face closest to the point
+        const int face = element / 25;
+        const int normalDim = face / 2;
+        BOOST_CHECK_CLOSE(std::abs(point[normalDim] - face % 2),
+                          expectedDistance, 1e-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nearestElement_works_for_points_outside_the_cube)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    double point[3] = {2., 3., 0.5};
+    double distance;
+    bvh.nearestElement(point, &distance);
+    BOOST_CHECK_CLOSE(distance, std::sqrt(1. + 4.), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(elementDiameter_works_for_quadrilaterals)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    BOOST_CHECK_CLOSE(bvh.elementDiameter(7), std::sqrt(2.) / 5., 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(elementsWithinRadius_works_for_cube_centre)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    // Only the central element of each face touches the ball
+    double point[3] = {0.5, 0.5, 0.5};
+    std::vector<int> elements;
+    bvh.elementsWithinRadius(point, 0.5 + 1e-9, elements);
+    BOOST_REQUIRE_EQUAL(elements.size(), (size_t)6);
+    for (int face = 0; face < 6; ++face)
+        BOOST_CHECK_EQUAL(elements[face], face * 25 + 2 * 5 + 2);
+
+    bvh.elementsWithinRadius(point, 0.5 - 1e-9, elements);
+    BOOST_CHECK(elements.empty());
+}
+
+BOOST_AUTO_TEST_CASE(elementsWithinRadius_agrees_with_nearestElement)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    std::srand(1);
+    std::vector<int> elements;
+    for (int i = 0; i < 100; ++i) {
+        double point[3];
+        for (int dim = 0; dim < 3; ++dim)
+            point[dim] = randomCoordinate(-0.5, 1.5);
+        double distance;
+        const int nearest = bvh.nearestElement(point, &distance);
+        bvh.elementsWithinRadius(point, distance * (1. + 1e-8), elements);
+        BOOST_CHECK(std::find(elements.begin(), elements.end(), nearest) !=
+                    elements.end());
+        bvh.elementsWithinRadius(point, distance * (1. - 1e-8), elements);
+        BOOST_CHECK(elements.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rayIntersections_works_for_ray_from_cube_centre)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    double origin[3] = {0.5, 0.5, 0.5};
+    double direction[3] = {1., 2., 3.};
+    std::vector<double> distances;
+    std::vector<int> elements;
+    bvh.rayIntersections(origin, direction, distances, &elements);
+    BOOST_REQUIRE_EQUAL(distances.size(), (size_t)1);
+    BOOST_CHECK_CLOSE(distances[0], std::sqrt(14.) / 6., 1e-10);
+    BOOST_REQUIRE_EQUAL(elements.size(), (size_t)1);
+    BOOST_CHECK_EQUAL(elements[0] / 25, 5); // face z = 1
+}
+
+BOOST_AUTO_TEST_CASE(rayIntersections_works_for_ray_crossing_the_cube)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createCubeSurface(5, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+
+    double origin[3] = {-1., 0.3, 0.5};
+    double direction[3] = {2., 0., 0.};
+    std::vector<double> distances;
+    std::vector<int> elements;
+    bvh.rayIntersections(origin, direction, distances, &elements);
+    BOOST_REQUIRE_EQUAL(distances.size(), (size_t)2);
+    BOOST_CHECK_CLOSE(distances[0], 1., 1e-10);
+    BOOST_CHECK_CLOSE(distances[1], 2., 1e-10);
+    BOOST_REQUIRE_EQUAL(elements.size(), (size_t)2);
+    BOOST_CHECK_EQUAL(elements[0] / 25, 0); // face x = 0
+    BOOST_CHECK_EQUAL(elements[1] / 25, 1); // face x = 1
+
+    // Ray pointing away from the cube
+    direction[0] = -1.;
+    bvh.rayIntersections(origin, direction, distances, &elements);
+    BOOST_CHECK(distances.empty());
+    BOOST_CHECK(elements.empty());
+}
+
+BOOST_AUTO_TEST_CASE(queries_work_for_hierarchy_built_in_parallel)
+{
+    // Large enough for subtrees to be built in parallel
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    const int n = 40;
+    createCubeSurface(n, vertices, elementCorners);
+    Bempp::BoundingVolumeHierarchy bvh(vertices, elementCorners);
+    BOOST_REQUIRE_EQUAL(bvh.triangleCount(), (size_t)(2 * 6 * n * n));
+
+    std::srand(1);
+    std::vector<double> heights;
+    for (int i = 0; i < 100; ++i) {
+        double point[3];
+        for (int dim = 0; dim < 3; ++dim)
+            point[dim] = randomCoordinate(0.05, 0.95);
+        bvh.zRayIntersections(point, heights);
+        BOOST_CHECK_EQUAL(heights.size(), (size_t)1);
+
+        double expectedDistance = 1.;
+        for (int dim = 0; dim < 3; ++dim)
+            expectedDistance = std::min(expectedDistance,
+                                        std::min(point[dim], 1. - point[dim]));
+        double distance;
+        bvh.nearestElement(point, &distance);
+        BOOST_CHECK_CLOSE(distance, expectedDistance, 1e-8);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(AreInside)
+
+BOOST_AUTO_TEST_CASE(areInside_works_for_sphere)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    std::srand(1);
+    const int pointCount = 200;
+    arma::Mat<double> points(3, pointCount);
+    std::vector<char> expectedInsideMask(pointCount);
+    for (int pt = 0; pt < pointCount; ++pt) {
+        // Points either well inside or well outside the unit sphere
+        const double radius = pt % 2 ? 0.5 : 1.5;
+        double norm = 0.;
+        for (int dim = 0; dim < 3; ++dim) {
+            points(dim, pt) = randomCoordinate(-1., 1.);
+            norm += points(dim, pt) * points(dim, pt);
+        }
+        norm = std::sqrt(norm);
+        for (int dim = 0; dim < 3; ++dim)
+            points(dim, pt) *= radius / norm;
+        expectedInsideMask[pt] = pt % 2;
+    }
+
+    std::vector<char> insideMask;
+    std::vector<int> nearestElements;
+    areInside(*grid, points, insideMask, &nearestElements);
+    BOOST_CHECK(insideMask == expectedInsideMask);
+    BOOST_REQUIRE_EQUAL(nearestElements.size(), (size_t)pointCount);
+
+    std::vector<bool> inside = areInside(*grid, points);
+    BOOST_CHECK(std::equal(inside.begin(), inside.end(),
+                           expectedInsideMask.begin()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,474 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "test_grid.hpp"
+
+#include "grid/entity.hpp"
+#include "grid/entity_iterator.hpp"
+#include "grid/flat_triangle_grid.hpp"
+#include "grid/geometry.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/id_set.hpp"
+#include "grid/index_set.hpp"
+#include "grid/mapper.hpp"
+#include "grid/reverse_element_mapper.hpp"
+
+#include <algorithm>
+#include <armadillo>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+const double EPSILON = 1e-13;
+
+// Unit square in the plane z = 0 divided into two triangles
+void createSquareArrays(arma::Mat<double>& vertices,
+                        arma::Mat<int>& elementCorners)
+{
+    vertices.zeros(3, 4);
+    vertices(0, 1) = vertices(0, 2) = vertices(1, 2) = vertices(1, 3) = 1.;
+    const int corners[2][3] = {{0, 1, 2}, {0, 2, 3}};
+    elementCorners.set_size(3, 2);
+    for (int e = 0; e < 2; ++e)
+        for (int c = 0; c < 3; ++c)
+            elementCorners(c, e) = corners[e][c];
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FlatTriangleGrid_Topology)
+
+BOOST_AUTO_TEST_CASE(entity_counts_are_correct_for_closed_surface)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<GridView> view = grid.leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 4u);
+    BOOST_CHECK_EQUAL(view->entityCount(1), 6u);
+    BOOST_CHECK_EQUAL(view->entityCount(2), 4u);
+    BOOST_CHECK_EQUAL(grid.boundarySegmentCount(), 0u);
+    BOOST_CHECK_EQUAL(grid.dim(), 2);
+    BOOST_CHECK_EQUAL(grid.dimWorld(), 3);
+    BOOST_CHECK_EQUAL(grid.maxLevel(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(entity_counts_are_correct_for_open_surface)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createSquareArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    BOOST_CHECK_EQUAL(grid.edgeCount(), 5u);
+    BOOST_CHECK_EQUAL(grid.boundarySegmentCount(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(element_edges_follow_reference_element_numbering)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    const int edgeCorners[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for (int e = 0; e < 4; ++e)
+        for (int l = 0; l < 3; ++l) {
+            const int edge = grid.elementEdges()(l, e);
+            const int a = elementCorners(edgeCorners[l][0], e);
+            const int b = elementCorners(edgeCorners[l][1], e);
+            BOOST_CHECK_EQUAL(grid.edgeVertices()(0, edge), std::min(a, b));
+            BOOST_CHECK_EQUAL(grid.edgeVertices()(1, edge), std::max(a, b));
+        }
+}
+
+BOOST_AUTO_TEST_CASE(element_neighbours_share_edges)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    const arma::Mat<int>& neighbours = grid.elementNeighbours();
+    const arma::Mat<int>& elementEdges = grid.elementEdges();
+    for (int e = 0; e < 4; ++e)
+        for (int l = 0; l < 3; ++l) {
+            const int n = neighbours(l, e);
+            BOOST_REQUIRE(n >= 0 && n < 4 && n != e);
+            int sharedEdgeCount = 0;
+            for (int m = 0; m < 3; ++m)
+                if (elementEdges(m, n) == elementEdges(l, e)) {
+                    ++sharedEdgeCount;
+                    BOOST_CHECK_EQUAL(neighbours(m, n), e);
+                }
+            BOOST_CHECK_EQUAL(sharedEdgeCount, 1);
+        }
+}
+
+BOOST_AUTO_TEST_CASE(boundary_edges_have_no_neighbours)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createSquareArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    // The diagonal is local edge 1 of element 0 and local edge 0 of
+    // element 1
+    const arma::Mat<int>& neighbours = grid.elementNeighbours();
+    BOOST_CHECK_EQUAL(neighbours(0, 0), -1);
+    BOOST_CHECK_EQUAL(neighbours(1, 0), 1);
+    BOOST_CHECK_EQUAL(neighbours(2, 0), -1);
+    BOOST_CHECK_EQUAL(neighbours(0, 1), 0);
+    BOOST_CHECK_EQUAL(neighbours(1, 1), -1);
+    BOOST_CHECK_EQUAL(neighbours(2, 1), -1);
+}
+
+BOOST_AUTO_TEST_CASE(constructor_throws_for_invalid_vertex_index)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    elementCorners(1, 2) = -1;
+    BOOST_CHECK_THROW(FlatTriangleGrid(vertices, elementCorners),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(levelView_throws_for_nonzero_level)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+    BOOST_CHECK_THROW(grid.levelView(1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(FlatTriangleGrid_View)
+
+BOOST_AUTO_TEST_CASE(element_indices_agree_with_connectivity_arrays)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<GridView> view = grid.leafView();
+    const IndexSet& indexSet = view->indexSet();
+    const Mapper& mapper = view->elementMapper();
+    std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
+    size_t expectedIndex = 0;
+    while (!it->finished()) {
+        const Entity<0>& element = it->entity();
+        const size_t index = indexSet.entityIndex(element);
+        BOOST_CHECK_EQUAL(index, expectedIndex);
+        BOOST_CHECK_EQUAL(mapper.entityIndex(element), expectedIndex);
+        BOOST_CHECK(view->containsEntity(element));
+
+        for (int i = 0; i < 3; ++i) {
+            BOOST_CHECK_EQUAL(indexSet.subEntityIndex(element, i, 2),
+                              (size_t)elementCorners(i, index));
+            BOOST_CHECK_EQUAL(indexSet.subEntityIndex(element, i, 1),
+                              (size_t)grid.elementEdges()(i, index));
+        }
+
+        std::auto_ptr<EntityIterator<1> > edgeIt =
+                element.subEntityIterator<1>();
+        for (int i = 0; i < 3; ++i, edgeIt->next()) {
+            BOOST_REQUIRE(!edgeIt->finished());
+            BOOST_CHECK_EQUAL(indexSet.entityIndex(edgeIt->entity()),
+                              (size_t)grid.elementEdges()(i, index));
+        }
+        BOOST_CHECK(edgeIt->finished());
+
+        it->next();
+        ++expectedIndex;
+    }
+    BOOST_CHECK_EQUAL(expectedIndex, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(ids_are_unique_across_codimensions)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    const IdSet& idSet = grid.globalIdSet();
+    std::auto_ptr<GridView> view = grid.leafView();
+    std::set<IdSet::IdType> ids;
+    for (std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
+         !it->finished(); it->next()) {
+        const Entity<0>& element = it->entity();
+        ids.insert(idSet.entityId(element));
+
+        // Ids of subentities agree with those of the subentities themselves
+        std::auto_ptr<EntityIterator<1> > edgeIt =
+                element.subEntityIterator<1>();
+        for (int i = 0; i < 3; ++i, edgeIt->next())
+            BOOST_CHECK_EQUAL(idSet.subEntityId(element, i, 1),
+                              idSet.entityId(edgeIt->entity()));
+        std::auto_ptr<EntityIterator<2> > vertexIt =
+                element.subEntityIterator<2>();
+        for (int i = 0; i < 3; ++i, vertexIt->next())
+            BOOST_CHECK_EQUAL(idSet.subEntityId(element, i, 2),
+                              idSet.entityId(vertexIt->entity()));
+    }
+    for (std::auto_ptr<EntityIterator<1> > it = view->entityIterator<1>();
+         !it->finished(); it->next())
+        ids.insert(idSet.entityId(it->entity()));
+    for (std::auto_ptr<EntityIterator<2> > it = view->entityIterator<2>();
+         !it->finished(); it->next())
+        ids.insert(idSet.entityId(it->entity()));
+
+    BOOST_CHECK_EQUAL(ids.size(), (size_t)(4 + 6 + 4));
+}
+
+BOOST_AUTO_TEST_CASE(reverseElementMapper_inverts_elementMapper)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<GridView> view = grid.leafView();
+    const ReverseElementMapper& reverseMapper = view->reverseElementMapper();
+    for (size_t e = 0; e < 4; ++e)
+        BOOST_CHECK_EQUAL(view->elementMapper().entityIndex(
+                              reverseMapper.entityPointer(e).entity()), e);
+}
+
+BOOST_AUTO_TEST_CASE(getRawElementData_reproduces_input_arrays)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    arma::Mat<double> rawVertices;
+    arma::Mat<int> rawElementCorners;
+    arma::Mat<char> auxData;
+    grid.leafView()->getRawElementData(rawVertices, rawElementCorners, auxData);
+
+    BOOST_REQUIRE_EQUAL(rawVertices.n_cols, 4u);
+    BOOST_REQUIRE_EQUAL(rawElementCorners.n_rows, 4u);
+    BOOST_REQUIRE_EQUAL(rawElementCorners.n_cols, 4u);
+    for (int v = 0; v < 4; ++v)
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_EQUAL(rawVertices(dim, v), vertices(dim, v));
+    for (int e = 0; e < 4; ++e) {
+        for (int c = 0; c < 3; ++c)
+            BOOST_CHECK_EQUAL(rawElementCorners(c, e), elementCorners(c, e));
+        BOOST_CHECK_EQUAL(rawElementCorners(3, e), -1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(FlatTriangleGrid_Geometry)
+
+BOOST_AUTO_TEST_CASE(local2global_maps_reference_corners_to_element_corners)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    arma::Mat<double> local(2, 3);
+    local.fill(0.);
+    local(0, 1) = local(1, 2) = 1.;
+
+    std::auto_ptr<EntityIterator<0> > it = grid.leafView()->entityIterator<0>();
+    for (int e = 0; !it->finished(); it->next(), ++e) {
+        const Geometry& geo = it->entity().geometry();
+        arma::Mat<double> global;
+        geo.local2global(local, global);
+        for (int c = 0; c < 3; ++c)
+            for (int dim = 0; dim < 3; ++dim)
+                BOOST_CHECK_CLOSE(global(dim, c) + 1.,
+                                  vertices(dim, elementCorners(c, e)) + 1.,
+                                  EPSILON);
+
+        arma::Mat<double> local2;
+        geo.global2local(global, local2);
+        for (int c = 0; c < 3; ++c)
+            for (int dim = 0; dim < 2; ++dim)
+                BOOST_CHECK_SMALL(local2(dim, c) - local(dim, c), EPSILON);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(volumes_and_normals_are_correct)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    arma::Mat<double> local(2, 1);
+    local.fill(0.25);
+
+    // Elements 0 to 2 lie in coordinate planes; all elements are oriented
+    // so that their normals point outwards
+    const double expectedVolumes[4] = {0.5, 0.5, 0.5, 0.5 * std::sqrt(3.)};
+    const double s = 1. / std::sqrt(3.);
+    const double expectedNormals[4][3] = {
+        {0., 0., -1.}, {0., -1., 0.}, {-1., 0., 0.}, {s, s, s}
+    };
+    std::auto_ptr<EntityIterator<0> > it = grid.leafView()->entityIterator<0>();
+    for (int e = 0; !it->finished(); it->next(), ++e) {
+        const Geometry& geo = it->entity().geometry();
+        BOOST_CHECK_CLOSE(geo.volume(), expectedVolumes[e], EPSILON);
+
+        arma::Row<double> intElement;
+        geo.getIntegrationElements(local, intElement);
+        BOOST_CHECK_CLOSE(intElement(0), 2. * expectedVolumes[e], EPSILON);
+
+        arma::Mat<double> normals;
+        geo.getNormals(local, normals);
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_SMALL(normals(dim, 0) - expectedNormals[e][dim], EPSILON);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(jacobian_inverse_is_left_inverse_of_jacobian)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    arma::Mat<double> local(2, 1);
+    local.fill(0.25);
+
+    std::auto_ptr<EntityIterator<0> > it = grid.leafView()->entityIterator<0>();
+    for (; !it->finished(); it->next()) {
+        const Geometry& geo = it->entity().geometry();
+        arma::Cube<double> jt, jit;
+        geo.getJacobiansTransposed(local, jt);
+        geo.getJacobianInversesTransposed(local, jit);
+        // jit contains the transpose of the pseudoinverse J^+ of J;
+        // J^+ J should be the identity
+        for (int i = 0; i < 2; ++i)
+            for (int j = 0; j < 2; ++j) {
+                double sum = 0.;
+                for (int k = 0; k < 3; ++k)
+                    sum += jit(k, i, 0) * jt(j, k, 0);
+                BOOST_CHECK_SMALL(sum - (i == j ? 1. : 0.), EPSILON);
+            }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(edge_volumes_are_edge_lengths)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<EntityIterator<1> > it = grid.leafView()->entityIterator<1>();
+    for (int edge = 0; !it->finished(); it->next(), ++edge) {
+        const int a = grid.edgeVertices()(0, edge);
+        const int b = grid.edgeVertices()(1, edge);
+        double length = 0.;
+        for (int dim = 0; dim < 3; ++dim)
+            length += (vertices(dim, b) - vertices(dim, a)) *
+                    (vertices(dim, b) - vertices(dim, a));
+        BOOST_CHECK_CLOSE(it->entity().geometry().volume(),
+                          std::sqrt(length), EPSILON);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(FlatTriangleGrid_GridFactory)
+
+BOOST_AUTO_TEST_CASE(createFlatGridFromConnectivityArrays_stores_domain_indices)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    std::vector<int> domainIndices(4);
+    for (int e = 0; e < 4; ++e)
+        domainIndices[e] = 10 + e;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners, domainIndices);
+
+    std::vector<int> gridDomainIndices;
+    grid->getDomainIndices(gridDomainIndices);
+    BOOST_CHECK(gridDomainIndices == domainIndices);
+}
+
+BOOST_AUTO_TEST_CASE(element_geometries_agree_with_Dune_based_grid)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> flatGrid = GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+    shared_ptr<Grid> duneGrid = GridFactory::createGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+
+    std::auto_ptr<GridView> flatView = flatGrid->leafView();
+    std::auto_ptr<GridView> duneView = duneGrid->leafView();
+    BOOST_REQUIRE_EQUAL(flatView->entityCount(0), duneView->entityCount(0));
+    BOOST_CHECK_EQUAL(flatView->entityCount(1), duneView->entityCount(1));
+    BOOST_CHECK_EQUAL(flatView->entityCount(2), duneView->entityCount(2));
+
+    arma::Mat<double> local(2, 2);
+    local(0, 0) = 0.2; local(1, 0) = 0.3;
+    local(0, 1) = 0.6; local(1, 1) = 0.1;
+
+    for (size_t e = 0; e < flatView->entityCount(0); ++e) {
+        const Geometry& flatGeo =
+                flatView->reverseElementMapper().entityPointer(e).entity().geometry();
+        const Geometry& duneGeo =
+                duneView->reverseElementMapper().entityPointer(e).entity().geometry();
+
+        arma::Mat<double> flatGlobal, duneGlobal, flatNormals, duneNormals;
+        flatGeo.local2global(local, flatGlobal);
+        duneGeo.local2global(local, duneGlobal);
+        flatGeo.getNormals(local, flatNormals);
+        duneGeo.getNormals(local, duneNormals);
+        for (int p = 0; p < 2; ++p)
+            for (int dim = 0; dim < 3; ++dim) {
+                BOOST_CHECK_SMALL(flatGlobal(dim, p) - duneGlobal(dim, p), EPSILON);
+                BOOST_CHECK_SMALL(flatNormals(dim, p) - duneNormals(dim, p), EPSILON);
+            }
+        BOOST_CHECK_CLOSE(flatGeo.volume(), duneGeo.volume(), EPSILON);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,217 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid/gmsh_reader.hpp"
+
+#include <armadillo>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Surface of a tetrahedron. Node 5 is not used by any triangle; element 1
+// is a point and element 2 a line.
+const int NODE_COUNT = 5;
+const int NODE_IDS[NODE_COUNT] = {1, 2, 3, 4, 5};
+const double NODE_COORDS[NODE_COUNT][3] = {
+    {0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}, {7., 7., 7.}};
+const int ELEMENT_COUNT = 6;
+const int ELEMENT_TYPES[ELEMENT_COUNT] = {15, 1, 2, 2, 2, 2};
+const int ELEMENT_PHYSICAL_ENTITIES[ELEMENT_COUNT] = {1, 2, 10, 10, 11, 12};
+const int ELEMENT_NODES[ELEMENT_COUNT][3] = {
+    {5, 0, 0}, {1, 2, 0}, {4, 3, 2}, {1, 2, 3}, {1, 4, 2}, {1, 3, 4}};
+
+int elementNodeCount(int type)
+{
+    return type == 15 ? 1 : type == 1 ? 2 : 3;
+}
+
+void writeAsciiFile(const char* fileName)
+{
+    std::ofstream out(fileName);
+    out << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n";
+    out << "$Nodes\n" << NODE_COUNT << "\n";
+    for (int i = 0; i < NODE_COUNT; ++i)
+        out << NODE_IDS[i] << " " << NODE_COORDS[i][0] << " "
+            << NODE_COORDS[i][1] << " " << NODE_COORDS[i][2] << "\n";
+    out << "$EndNodes\n";
+    out << "$Elements\n" << ELEMENT_COUNT << "\n";
+    for (int e = 0; e < ELEMENT_COUNT; ++e) {
+        out << e + 1 << " " << ELEMENT_TYPES[e] << " 2 "
+            << ELEMENT_PHYSICAL_ENTITIES[e] << " 0";
+        for (int i = 0; i < elementNodeCount(ELEMENT_TYPES[e]); ++i)
+            out << " " << ELEMENT_NODES[e][i];
+        out << "\n";
+    }
+    out << "$EndElements\n";
+}
+
+template <typename T>
+void writeBinary(std::ofstream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeBinaryFile(const char* fileName)
+{
+    std::ofstream out(fileName, std::ios::binary);
+    out << "$MeshFormat\n2.2 1 8\n";
+    writeBinary(out, int(1));
+    out << "\n$EndMeshFormat\n";
+    out << "$Nodes\n" << NODE_COUNT << "\n";
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        writeBinary(out, NODE_IDS[i]);
+        for (int dim = 0; dim < 3; ++dim)
+            writeBinary(out, NODE_COORDS[i][dim]);
+    }
+    out << "\n$EndNodes\n";
+    out << "$Elements\n" << ELEMENT_COUNT << "\n";
+    // One block per element type
+    int e = 0;
+    while (e < ELEMENT_COUNT) {
+        int blockEnd = e;
+        while (blockEnd < ELEMENT_COUNT &&
+               ELEMENT_TYPES[blockEnd] == ELEMENT_TYPES[e])
+            ++blockEnd;
+        writeBinary(out, ELEMENT_TYPES[e]);
+        writeBinary(out, blockEnd - e);
+        writeBinary(out, int(2)); // tag count
+        for (; e < blockEnd; ++e) {
+            writeBinary(out, e + 1);
+            writeBinary(out, ELEMENT_PHYSICAL_ENTITIES[e]);
+            writeBinary(out, int(0));
+            for (int i = 0; i < elementNodeCount(ELEMENT_TYPES[e]); ++i)
+                writeBinary(out, ELEMENT_NODES[e][i]);
+        }
+    }
+    out << "\n$EndElements\n";
+}
+
+void checkTetrahedron(const arma::Mat<double>& vertices,
+                      const arma::Mat<int>& elementCorners,
+                      const std::vector<int>& boundaryId2PhysicalEntity,
+                      const std::vector<int>& elementIndex2PhysicalEntity)
+{
+    // Vertices are numbered in the order of first use by triangles
+    const int expectedVertexNodes[4] = {4, 3, 2, 1};
+    BOOST_REQUIRE_EQUAL(vertices.n_rows, 3u);
+    BOOST_REQUIRE_EQUAL(vertices.n_cols, 4u);
+    for (int v = 0; v < 4; ++v)
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_EQUAL(vertices(dim, v),
+                              NODE_COORDS[expectedVertexNodes[v] - 1][dim]);
+
+    const int expectedCorners[4][3] = {
+        {0, 1, 2}, {3, 2, 1}, {3, 0, 2}, {3, 1, 0}};
+    BOOST_REQUIRE_EQUAL(elementCorners.n_rows, 3u);
+    BOOST_REQUIRE_EQUAL(elementCorners.n_cols, 4u);
+    for (int e = 0; e < 4; ++e)
+        for (int c = 0; c < 3; ++c)
+            BOOST_CHECK_EQUAL(elementCorners(c, e), expectedCorners[e][c]);
+
+    BOOST_REQUIRE_EQUAL(boundaryId2PhysicalEntity.size(), 1u);
+    BOOST_CHECK_EQUAL(boundaryId2PhysicalEntity[0], 2);
+    BOOST_REQUIRE_EQUAL(elementIndex2PhysicalEntity.size(), 4u);
+    BOOST_CHECK_EQUAL(elementIndex2PhysicalEntity[0], 10);
+    BOOST_CHECK_EQUAL(elementIndex2PhysicalEntity[1], 10);
+    BOOST_CHECK_EQUAL(elementIndex2PhysicalEntity[2], 11);
+    BOOST_CHECK_EQUAL(elementIndex2PhysicalEntity[3], 12);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(GmshReader)
+
+BOOST_AUTO_TEST_CASE(readGmshTriangularGrid_works_for_ascii_file)
+{
+    const char fileName[] = "test_gmsh_reader_ascii.msh";
+    writeAsciiFile(fileName);
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+    readGmshTriangularGrid(fileName, vertices, elementCorners,
+                           boundaryId2PhysicalEntity,
+                           elementIndex2PhysicalEntity);
+    std::remove(fileName);
+
+    checkTetrahedron(vertices, elementCorners, boundaryId2PhysicalEntity,
+                     elementIndex2PhysicalEntity);
+}
+
+BOOST_AUTO_TEST_CASE(readGmshTriangularGrid_works_for_binary_file)
+{
+    const char fileName[] = "test_gmsh_reader_binary.msh";
+    writeBinaryFile(fileName);
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+    readGmshTriangularGrid(fileName, vertices, elementCorners,
+                           boundaryId2PhysicalEntity,
+                           elementIndex2PhysicalEntity);
+    std::remove(fileName);
+
+    checkTetrahedron(vertices, elementCorners, boundaryId2PhysicalEntity,
+                     elementIndex2PhysicalEntity);
+}
+
+BOOST_AUTO_TEST_CASE(readGmshTriangularGrid_works_for_sphere)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+    readGmshTriangularGrid("../../examples/meshes/sphere-h-0.2.msh",
+                           vertices, elementCorners,
+                           boundaryId2PhysicalEntity,
+                           elementIndex2PhysicalEntity);
+
+    // The centre of the sphere is not a vertex of any triangle
+    BOOST_CHECK_EQUAL(vertices.n_cols, 304u);
+    BOOST_CHECK_EQUAL(elementCorners.n_cols, 604u);
+    BOOST_CHECK_EQUAL(boundaryId2PhysicalEntity.size(), 84u);
+    BOOST_CHECK_EQUAL(elementIndex2PhysicalEntity.size(), 604u);
+    for (size_t v = 0; v < vertices.n_cols; ++v)
+        BOOST_CHECK_CLOSE(std::sqrt(vertices(0, v) * vertices(0, v) +
+                                    vertices(1, v) * vertices(1, v) +
+                                    vertices(2, v) * vertices(2, v)),
+                          1., 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(readGmshTriangularGrid_throws_for_missing_file)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    std::vector<int> boundaryId2PhysicalEntity, elementIndex2PhysicalEntity;
+    BOOST_CHECK_THROW(readGmshTriangularGrid("nonexistent_file.msh",
+                                             vertices, elementCorners,
+                                             boundaryId2PhysicalEntity,
+                                             elementIndex2PhysicalEntity),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
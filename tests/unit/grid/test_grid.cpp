@@ -64,6 +64,18 @@ SimpleTriangularGridManager::createDuneGrid()
     return Bempp::shared_ptr<DuneGrid>(grid.release());
 }
 
+void createTetrahedronArrays(arma::Mat<double>& vertices,
+                             arma::Mat<int>& elementCorners)
+{
+    vertices.zeros(3, 4);
+    vertices(0, 1) = vertices(1, 2) = vertices(2, 3) = 1.;
+    const int corners[4][3] = {{0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {1, 2, 3}};
+    elementCorners.set_size(3, 4);
+    for (int e = 0; e < 4; ++e)
+        for (int c = 0; c < 3; ++c)
+            elementCorners(c, e) = corners[e][c];
+}
+
 // Tests
 
 BOOST_FIXTURE_TEST_SUITE(Grid, SimpleTriangularGridManager)
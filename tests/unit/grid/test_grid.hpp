@@ -23,6 +23,7 @@
 
 #include "grid/dune.hpp"
 #include "grid/grid.hpp"
+#include "common/armadillo_fwd.hpp"
 #include "common/shared_ptr.hpp"
 
 /** Fixture class for Bempp::Grid tests */
@@ -54,4 +55,10 @@ public:
     Bempp::shared_ptr<DuneGrid> duneGrid;
 };
 
+/** Fill vertices and elementCorners with the connectivity arrays of the
+    surface of the tetrahedron with vertices (0, 0, 0), (1, 0, 0), (0, 1, 0)
+    and (0, 0, 1), composed of 4 triangles with outward normals. */
+void createTetrahedronArrays(arma::Mat<double>& vertices,
+                             arma::Mat<int>& elementCorners);
+
 #endif
@@ -0,0 +1,139 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "test_grid.hpp"
+
+#include "grid/entity.hpp"
+#include "grid/entity_iterator.hpp"
+#include "grid/flat_triangle_grid.hpp"
+#include "grid/grid_connectivity.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/index_set.hpp"
+#include "grid/mapper.hpp"
+
+#include <armadillo>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Check that the arrays stored in connectivity agree with the index set and
+// element mapper of view
+void checkConnectivityAgreesWithView(const GridConnectivity& connectivity,
+                                     const GridView& view)
+{
+    BOOST_REQUIRE_EQUAL(connectivity.elementCount(), view.entityCount(0));
+    BOOST_CHECK_EQUAL(connectivity.edgeCount(), view.entityCount(1));
+    BOOST_CHECK_EQUAL(connectivity.vertexCount(), view.entityCount(2));
+
+    const IndexSet& indexSet = view.indexSet();
+    const Mapper& mapper = view.elementMapper();
+    std::auto_ptr<EntityIterator<0> > it = view.entityIterator<0>();
+    while (!it->finished()) {
+        const Entity<0>& element = it->entity();
+        const size_t index = mapper.entityIndex(element);
+        BOOST_REQUIRE_EQUAL(connectivity.elementCornerCount(index), 3);
+        for (int i = 0; i < 3; ++i) {
+            BOOST_CHECK_EQUAL(
+                        (size_t)connectivity.elementCorners()(i, index),
+                        indexSet.subEntityIndex(element, i, 2));
+            BOOST_CHECK_EQUAL(
+                        (size_t)connectivity.elementEdges()(i, index),
+                        indexSet.subEntityIndex(element, i, 1));
+        }
+        BOOST_CHECK_EQUAL(connectivity.elementCorners()(3, index), -1);
+        BOOST_CHECK_EQUAL(connectivity.elementEdges()(3, index), -1);
+        it->next();
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(GridConnectivity_FlatTriangleGrid)
+
+BOOST_AUTO_TEST_CASE(connectivity_agrees_with_view)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<GridView> view = grid.leafView();
+    GridConnectivity connectivity(*view, 2);
+    BOOST_CHECK_EQUAL(connectivity.dim(), 2);
+    BOOST_CHECK_EQUAL(connectivity.elementCount(), 4u);
+    BOOST_CHECK_EQUAL(connectivity.edgeCount(), 6u);
+    BOOST_CHECK_EQUAL(connectivity.vertexCount(), 4u);
+    checkConnectivityAgreesWithView(connectivity, *view);
+}
+
+BOOST_AUTO_TEST_CASE(edges_agree_with_grid_arrays)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    const GridConnectivity& connectivity = grid.leafConnectivity();
+    for (int e = 0; e < 4; ++e)
+        for (int i = 0; i < 3; ++i) {
+            BOOST_CHECK_EQUAL(connectivity.elementCorners()(i, e),
+                              elementCorners(i, e));
+            BOOST_CHECK_EQUAL(connectivity.elementEdges()(i, e),
+                              grid.elementEdges()(i, e));
+        }
+}
+
+BOOST_AUTO_TEST_CASE(leafConnectivity_is_built_once)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    const GridConnectivity* first = &grid.leafConnectivity();
+    BOOST_CHECK_EQUAL(first, &grid.leafConnectivity());
+}
+
+BOOST_AUTO_TEST_CASE(constructor_throws_for_invalid_dimension)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    FlatTriangleGrid grid(vertices, elementCorners);
+
+    std::auto_ptr<GridView> view = grid.leafView();
+    BOOST_CHECK_THROW(GridConnectivity(*view, 3), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(GridConnectivity_DuneGrid, SimpleTriangularGridManager)
+
+BOOST_AUTO_TEST_CASE(leaf_connectivity_agrees_with_leaf_view)
+{
+    std::auto_ptr<GridView> view = bemppGrid->leafView();
+    checkConnectivityAgreesWithView(bemppGrid->leafConnectivity(), *view);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,9 +19,11 @@
 // THE SOFTWARE.
 
 #include "test_entity.hpp"
+#include "test_grid.hpp"
 #include "grid/armadillo_helpers.hpp"
 #include "grid/entity_iterator.hpp"
 #include "grid/geometry.hpp"
+#include "grid/grid_factory.hpp"
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
@@ -120,3 +122,112 @@ BOOST_AUTO_TEST_CASE(jacobian_is_constant_everywhere_on_the_second_face)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(GridFactory_ConnectivityArrays)
+
+BOOST_AUTO_TEST_CASE(createGridFromConnectivityArrays_reproduces_input_arrays)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    std::vector<int> domainIndices(4);
+    for (int e = 0; e < 4; ++e)
+        domainIndices[e] = 10 + e;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::createGridFromConnectivityArrays(
+                params, vertices, elementCorners, domainIndices);
+
+    std::auto_ptr<GridView> view = grid->leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 4u);
+    BOOST_CHECK_EQUAL(view->entityCount(2), 4u);
+
+    arma::Mat<double> rawVertices;
+    arma::Mat<int> rawElementCorners;
+    arma::Mat<char> auxData;
+    view->getRawElementData(rawVertices, rawElementCorners, auxData);
+    BOOST_REQUIRE_EQUAL(rawElementCorners.n_cols, 4u);
+    // Compare the coordinates of the corners of each element
+    for (int e = 0; e < 4; ++e)
+        for (int c = 0; c < 3; ++c)
+            for (int dim = 0; dim < 3; ++dim)
+                BOOST_CHECK_EQUAL(
+                        rawVertices(dim, rawElementCorners(c, e)),
+                        vertices(dim, elementCorners(c, e)));
+
+    std::vector<int> gridDomainIndices;
+    grid->getDomainIndices(gridDomainIndices);
+    BOOST_CHECK(gridDomainIndices == domainIndices);
+}
+
+BOOST_AUTO_TEST_CASE(domain_indices_are_zero_by_default)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::createGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+
+    std::vector<int> domainIndices;
+    grid->getDomainIndices(domainIndices);
+    BOOST_CHECK(domainIndices == std::vector<int>(4, 0));
+}
+
+BOOST_AUTO_TEST_CASE(createGridFromConnectivityArrays_throws_for_invalid_vertex_index)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    elementCorners(2, 3) = 4;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    BOOST_CHECK_THROW(GridFactory::createGridFromConnectivityArrays(
+                          params, vertices, elementCorners),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(createGridFromConnectivityArrays_stores_original_indices_of_renumbered_grid)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    std::vector<int> domainIndices(4);
+    for (int e = 0; e < 4; ++e)
+        domainIndices[e] = 10 + e;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    params.elementOrdering = GridParameters::HILBERT_ORDERING;
+    shared_ptr<Grid> grid = GridFactory::createGridFromConnectivityArrays(
+                params, vertices, elementCorners, domainIndices);
+
+    std::vector<int> originalElements, originalVertices, gridDomainIndices;
+    grid->getOriginalElementIndices(originalElements);
+    grid->getOriginalVertexIndices(originalVertices);
+    grid->getDomainIndices(gridDomainIndices);
+    BOOST_REQUIRE_EQUAL(originalElements.size(), 4u);
+    BOOST_REQUIRE_EQUAL(originalVertices.size(), 4u);
+
+    arma::Mat<double> rawVertices;
+    arma::Mat<int> rawElementCorners;
+    arma::Mat<char> auxData;
+    grid->leafView()->getRawElementData(rawVertices, rawElementCorners, auxData);
+    for (int v = 0; v < 4; ++v)
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_EQUAL(rawVertices(dim, v),
+                              vertices(dim, originalVertices[v]));
+    for (int e = 0; e < 4; ++e) {
+        BOOST_CHECK_EQUAL(gridDomainIndices[e],
+                          domainIndices[originalElements[e]]);
+        for (int c = 0; c < 3; ++c)
+            BOOST_CHECK_EQUAL(originalVertices[rawElementCorners(c, e)],
+                              elementCorners(c, originalElements[e]));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
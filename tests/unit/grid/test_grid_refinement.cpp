@@ -0,0 +1,276 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "test_grid.hpp"
+
+#include "grid/flat_triangle_grid.hpp"
+#include "grid/grid_connectivity.hpp"
+#include "grid/grid_refinement.hpp"
+#include "grid/grid_view.hpp"
+
+#include "common/not_implemented_error.hpp"
+
+#include <armadillo>
+#include <cmath>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+const double EPSILON = 1e-12;
+
+// Surface of the tetrahedron from createTetrahedronArrays(), with domain
+// indices 10, 11, 12 and 13
+shared_ptr<const Grid> createTetrahedronGrid()
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createTetrahedronArrays(vertices, elementCorners);
+    std::vector<int> domainIndices(4);
+    for (int e = 0; e < 4; ++e)
+        domainIndices[e] = 10 + e;
+    return shared_ptr<const Grid>(
+                new FlatTriangleGrid(vertices, elementCorners, domainIndices));
+}
+
+// Area-weighted normal of element e
+arma::Col<double> elementNormal(const arma::Mat<double>& vertices,
+                                const arma::Mat<int>& elementCorners,
+                                int e)
+{
+    double a[3], b[3];
+    for (int dim = 0; dim < 3; ++dim) {
+        a[dim] = vertices(dim, elementCorners(1, e)) -
+                vertices(dim, elementCorners(0, e));
+        b[dim] = vertices(dim, elementCorners(2, e)) -
+                vertices(dim, elementCorners(0, e));
+    }
+    arma::Col<double> normal(3);
+    normal(0) = 0.5 * (a[1] * b[2] - a[2] * b[1]);
+    normal(1) = 0.5 * (a[2] * b[0] - a[0] * b[2]);
+    normal(2) = 0.5 * (a[0] * b[1] - a[1] * b[0]);
+    return normal;
+}
+
+// Check that the children of each coarse element cover it, have the same
+// orientation and inherit its domain index
+void checkChildrenCoverParents(const GridRefinement& refinement)
+{
+    arma::Mat<double> coarseVertices, fineVertices;
+    arma::Mat<int> coarseCorners, fineCorners;
+    arma::Mat<char> auxData;
+    refinement.coarseGrid()->leafView()->getRawElementData(
+                coarseVertices, coarseCorners, auxData);
+    refinement.fineGrid()->leafView()->getRawElementData(
+                fineVertices, fineCorners, auxData);
+    std::vector<int> coarseDomainIndices, fineDomainIndices;
+    refinement.coarseGrid()->getDomainIndices(coarseDomainIndices);
+    refinement.fineGrid()->getDomainIndices(fineDomainIndices);
+
+    const std::vector<int>& parents = refinement.elementParents();
+    BOOST_REQUIRE_EQUAL(parents.size(), fineCorners.n_cols);
+    std::vector<arma::Col<double> > childNormals(
+                coarseCorners.n_cols, arma::Col<double>(3));
+    for (size_t p = 0; p < childNormals.size(); ++p)
+        childNormals[p].zeros();
+    for (size_t e = 0; e < parents.size(); ++e) {
+        childNormals[parents[e]] += elementNormal(fineVertices, fineCorners, e);
+        BOOST_CHECK_EQUAL(fineDomainIndices[e],
+                          coarseDomainIndices[parents[e]]);
+    }
+    for (size_t p = 0; p < childNormals.size(); ++p) {
+        const arma::Col<double> parentNormal =
+                elementNormal(coarseVertices, coarseCorners, p);
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_SMALL(childNormals[p](dim) - parentNormal(dim),
+                              EPSILON);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(GridRefinement_FlatTriangleGrid)
+
+BOOST_AUTO_TEST_CASE(uniform_refinement_produces_four_children_per_element)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    GridRefinement refinement(coarseGrid);
+
+    shared_ptr<Grid> fineGrid = refinement.fineGrid();
+    BOOST_REQUIRE(fineGrid);
+    BOOST_CHECK(dynamic_cast<FlatTriangleGrid*>(fineGrid.get()));
+    std::auto_ptr<GridView> view = fineGrid->leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 16u);
+    BOOST_CHECK_EQUAL(view->entityCount(1), 24u);
+    BOOST_CHECK_EQUAL(view->entityCount(2), 10u);
+    // The refined surface is closed
+    BOOST_CHECK_EQUAL(fineGrid->boundarySegmentCount(), 0u);
+
+    for (int e = 0; e < 16; ++e)
+        BOOST_CHECK_EQUAL(refinement.elementParents()[e], e / 4);
+    checkChildrenCoverParents(refinement);
+}
+
+BOOST_AUTO_TEST_CASE(new_vertices_lie_at_edge_midpoints)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    GridRefinement refinement(coarseGrid);
+
+    arma::Mat<double> coarseVertices, fineVertices;
+    arma::Mat<int> elementCorners;
+    arma::Mat<char> auxData;
+    coarseGrid->leafView()->getRawElementData(coarseVertices, elementCorners,
+                                              auxData);
+    refinement.fineGrid()->leafView()->getRawElementData(
+                fineVertices, elementCorners, auxData);
+
+    const arma::Mat<int>& parents = refinement.vertexParents();
+    BOOST_REQUIRE_EQUAL(parents.n_cols, fineVertices.n_cols);
+    for (size_t v = 0; v < fineVertices.n_cols; ++v) {
+        if (v < 4) {
+            BOOST_CHECK_EQUAL(parents(0, v), (int)v);
+            BOOST_CHECK_EQUAL(parents(1, v), (int)v);
+        } else
+            BOOST_CHECK(parents(0, v) != parents(1, v));
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_CLOSE(fineVertices(dim, v) + 1.,
+                              0.5 * (coarseVertices(dim, parents(0, v)) +
+                                     coarseVertices(dim, parents(1, v))) + 1.,
+                              1e-10 /* percent */);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(refinement_of_one_element_is_closed_by_green_refinement)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    std::vector<bool> marks(4, false);
+    marks[3] = true;
+    GridRefinement refinement(coarseGrid, marks);
+
+    // The marked element is split into four, its three neighbours into two
+    shared_ptr<Grid> fineGrid = refinement.fineGrid();
+    std::auto_ptr<GridView> view = fineGrid->leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 10u);
+    BOOST_CHECK_EQUAL(view->entityCount(2), 7u);
+    BOOST_CHECK_EQUAL(fineGrid->boundarySegmentCount(), 0u);
+    checkChildrenCoverParents(refinement);
+}
+
+BOOST_AUTO_TEST_CASE(elements_with_two_refined_edges_are_refined_red)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    std::vector<bool> marks(4, false);
+    marks[0] = marks[1] = true;
+    GridRefinement refinement(coarseGrid, marks);
+
+    // Each of the two unmarked elements shares an edge with both marked
+    // elements, hence all elements are refined red
+    std::auto_ptr<GridView> view = refinement.fineGrid()->leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 16u);
+    checkChildrenCoverParents(refinement);
+}
+
+BOOST_AUTO_TEST_CASE(no_marks_leave_grid_unchanged)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    GridRefinement refinement(coarseGrid, std::vector<bool>(4, false));
+
+    std::auto_ptr<GridView> view = refinement.fineGrid()->leafView();
+    BOOST_CHECK_EQUAL(view->entityCount(0), 4u);
+    BOOST_CHECK_EQUAL(view->entityCount(2), 4u);
+    for (int e = 0; e < 4; ++e)
+        BOOST_CHECK_EQUAL(refinement.elementParents()[e], e);
+}
+
+BOOST_AUTO_TEST_CASE(constructor_throws_for_wrong_number_of_marks)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    BOOST_CHECK_THROW(GridRefinement(coarseGrid, std::vector<bool>(3, true)),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(prolongVertexData_interpolates_linear_functions_exactly)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    std::vector<bool> marks(4, false);
+    marks[2] = true;
+    GridRefinement refinement(coarseGrid, marks);
+
+    arma::Mat<double> coarseVertices, fineVertices;
+    arma::Mat<int> elementCorners;
+    arma::Mat<char> auxData;
+    coarseGrid->leafView()->getRawElementData(coarseVertices, elementCorners,
+                                              auxData);
+    refinement.fineGrid()->leafView()->getRawElementData(
+                fineVertices, elementCorners, auxData);
+
+    // f(x, y, z) = 1 + 2x - y + 3z
+    arma::Col<double> coarseValues(coarseVertices.n_cols);
+    for (size_t v = 0; v < coarseVertices.n_cols; ++v)
+        coarseValues(v) = 1. + 2. * coarseVertices(0, v) -
+                coarseVertices(1, v) + 3. * coarseVertices(2, v);
+    arma::Col<double> fineValues;
+    refinement.prolongVertexData(coarseValues, fineValues);
+
+    BOOST_REQUIRE_EQUAL(fineValues.n_rows, fineVertices.n_cols);
+    for (size_t v = 0; v < fineVertices.n_cols; ++v)
+        BOOST_CHECK_CLOSE(fineValues(v),
+                          1. + 2. * fineVertices(0, v) - fineVertices(1, v) +
+                          3. * fineVertices(2, v), 1e-10 /* percent */);
+}
+
+BOOST_AUTO_TEST_CASE(prolongElementData_copies_values_of_parents)
+{
+    shared_ptr<const Grid> coarseGrid = createTetrahedronGrid();
+    GridRefinement refinement(coarseGrid);
+
+    arma::Col<double> coarseValues(4);
+    for (int e = 0; e < 4; ++e)
+        coarseValues(e) = 10. * e;
+    arma::Col<double> fineValues;
+    refinement.prolongElementData(coarseValues, fineValues);
+
+    BOOST_REQUIRE_EQUAL(fineValues.n_rows, 16u);
+    for (int e = 0; e < 16; ++e)
+        BOOST_CHECK_EQUAL(fineValues(e),
+                          coarseValues(refinement.elementParents()[e]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(GridRefinement_DuneGrid, SimpleTriangularGridManager)
+
+BOOST_AUTO_TEST_CASE(uniform_refinement_produces_four_children_per_element)
+{
+    GridRefinement refinement(bemppGrid);
+
+    std::auto_ptr<GridView> coarseView = bemppGrid->leafView();
+    std::auto_ptr<GridView> fineView = refinement.fineGrid()->leafView();
+    BOOST_CHECK_EQUAL(fineView->entityCount(0), 4 * coarseView->entityCount(0));
+    BOOST_CHECK_EQUAL(fineView->entityCount(2),
+                      coarseView->entityCount(2) + coarseView->entityCount(1));
+    checkChildrenCoverParents(refinement);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,294 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/space_filling_curve.hpp"
+
+#include <algorithm>
+#include <armadillo>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Corners of the unit cube, listed in random order
+void createCubeCorners(arma::Mat<double>& points, std::vector<int>& mortonIndices)
+{
+    const int shuffled[8] = {5, 2, 7, 0, 3, 6, 1, 4};
+    points.set_size(3, 8);
+    mortonIndices.resize(8);
+    for (int p = 0; p < 8; ++p) {
+        const int m = shuffled[p];
+        points(0, p) = (m >> 2) & 1;
+        points(1, p) = (m >> 1) & 1;
+        points(2, p) = m & 1;
+        mortonIndices[p] = m;
+    }
+}
+
+// Regular triangulation of the unit square with n * n squares, with
+// elements listed in random order
+void createShuffledSquareArrays(int n, arma::Mat<double>& vertices,
+                                arma::Mat<int>& elementCorners)
+{
+    vertices.zeros(3, (n + 1) * (n + 1));
+    for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i) {
+            vertices(0, j * (n + 1) + i) = double(i) / n;
+            vertices(1, j * (n + 1) + i) = double(j) / n;
+        }
+    std::vector<int> order(2 * n * n);
+    for (size_t e = 0; e < order.size(); ++e)
+        order[e] = e;
+    std::srand(1);
+    std::random_shuffle(order.begin(), order.end());
+    elementCorners.set_size(3, 2 * n * n);
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            const int v = j * (n + 1) + i;
+            const int lower = order[2 * (j * n + i)];
+            const int upper = order[2 * (j * n + i) + 1];
+            elementCorners(0, lower) = v;
+            elementCorners(1, lower) = v + 1;
+            elementCorners(2, lower) = v + n + 2;
+            elementCorners(0, upper) = v;
+            elementCorners(1, upper) = v + n + 2;
+            elementCorners(2, upper) = v + n + 1;
+        }
+}
+
+double meanNeighbourDistance(const arma::Mat<double>& vertices,
+                             const arma::Mat<int>& elementCorners)
+{
+    double sum = 0.;
+    for (size_t e = 1; e < elementCorners.n_cols; ++e) {
+        double distance2 = 0.;
+        for (int dim = 0; dim < 3; ++dim) {
+            double d = 0.;
+            for (int c = 0; c < 3; ++c)
+                d += vertices(dim, elementCorners(c, e)) -
+                        vertices(dim, elementCorners(c, e - 1));
+            distance2 += d * d / 9.;
+        }
+        sum += std::sqrt(distance2);
+    }
+    return sum / (elementCorners.n_cols - 1);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SpaceFillingCurve)
+
+BOOST_AUTO_TEST_CASE(Morton_order_of_cube_corners_is_correct)
+{
+    arma::Mat<double> points;
+    std::vector<int> mortonIndices;
+    createCubeCorners(points, mortonIndices);
+
+    std::vector<int> order;
+    computeSpaceFillingCurveOrder(points, GridParameters::MORTON_ORDERING,
+                                  order);
+    BOOST_REQUIRE_EQUAL(order.size(), 8u);
+    for (int k = 0; k < 8; ++k)
+        BOOST_CHECK_EQUAL(mortonIndices[order[k]], k);
+}
+
+BOOST_AUTO_TEST_CASE(Hilbert_curve_visits_adjacent_cube_corners_consecutively)
+{
+    arma::Mat<double> points;
+    std::vector<int> mortonIndices;
+    createCubeCorners(points, mortonIndices);
+
+    std::vector<int> order;
+    computeSpaceFillingCurveOrder(points, GridParameters::HILBERT_ORDERING,
+                                  order);
+    BOOST_REQUIRE_EQUAL(order.size(), 8u);
+    std::vector<int> sortedOrder(order);
+    std::sort(sortedOrder.begin(), sortedOrder.end());
+    for (int k = 0; k < 8; ++k)
+        BOOST_CHECK_EQUAL(sortedOrder[k], k);
+    // Consecutive corners differ in exactly one coordinate
+    for (int k = 1; k < 8; ++k) {
+        int differences = 0;
+        for (int dim = 0; dim < 3; ++dim)
+            differences += points(dim, order[k]) != points(dim, order[k - 1]);
+        BOOST_CHECK_EQUAL(differences, 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(computeSpaceFillingCurveOrder_throws_for_original_ordering)
+{
+    arma::Mat<double> points;
+    std::vector<int> mortonIndices;
+    createCubeCorners(points, mortonIndices);
+
+    std::vector<int> order;
+    BOOST_CHECK_THROW(computeSpaceFillingCurveOrder(
+                          points, GridParameters::ORIGINAL_ORDERING, order),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(reorderConnectivityArrays_preserves_the_grid)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createShuffledSquareArrays(8, vertices, elementCorners);
+    std::vector<int> domainIndices(elementCorners.n_cols);
+    for (size_t e = 0; e < domainIndices.size(); ++e)
+        domainIndices[e] = e;
+
+    arma::Mat<double> newVertices(vertices);
+    arma::Mat<int> newElementCorners(elementCorners);
+    std::vector<int> newDomainIndices(domainIndices);
+    std::vector<int> originalElements, originalVertices;
+    reorderConnectivityArrays(GridParameters::HILBERT_ORDERING,
+                              newVertices, newElementCorners, newDomainIndices,
+                              originalElements, originalVertices);
+
+    BOOST_REQUIRE_EQUAL(newVertices.n_cols, vertices.n_cols);
+    BOOST_REQUIRE_EQUAL(newElementCorners.n_cols, elementCorners.n_cols);
+    BOOST_REQUIRE_EQUAL(originalVertices.size(), vertices.n_cols);
+    BOOST_REQUIRE(newDomainIndices == originalElements);
+    for (size_t v = 0; v < newVertices.n_cols; ++v)
+        for (int dim = 0; dim < 3; ++dim)
+            BOOST_CHECK_EQUAL(newVertices(dim, v),
+                              vertices(dim, originalVertices[v]));
+    for (size_t e = 0; e < newElementCorners.n_cols; ++e)
+        for (int c = 0; c < 3; ++c)
+            BOOST_CHECK_EQUAL(originalVertices[newElementCorners(c, e)],
+                              elementCorners(c, originalElements[e]));
+
+    // Vertices are numbered in the order of their first appearance
+    int nextVertex = 0;
+    for (size_t i = 0; i < newElementCorners.n_elem; ++i) {
+        BOOST_CHECK(newElementCorners[i] <= nextVertex);
+        if (newElementCorners[i] == nextVertex)
+            ++nextVertex;
+    }
+
+    // Consecutive elements lie closer to each other
+    BOOST_CHECK(meanNeighbourDistance(newVertices, newElementCorners) <
+                0.5 * meanNeighbourDistance(vertices, elementCorners));
+}
+
+BOOST_AUTO_TEST_CASE(reorderConnectivityArrays_puts_unused_vertices_last)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createShuffledSquareArrays(2, vertices, elementCorners);
+    // Remove the two elements containing the vertex 0, which becomes unused
+    arma::Mat<int> corners(3, elementCorners.n_cols - 2);
+    for (size_t e = 0, f = 0; e < elementCorners.n_cols; ++e)
+        if (elementCorners(0, e) != 0) {
+            for (int c = 0; c < 3; ++c)
+                corners(c, f) = elementCorners(c, e);
+            ++f;
+        }
+
+    std::vector<int> domainIndices, originalElements, originalVertices;
+    reorderConnectivityArrays(GridParameters::MORTON_ORDERING,
+                              vertices, corners, domainIndices,
+                              originalElements, originalVertices);
+    BOOST_CHECK(domainIndices.empty());
+    BOOST_REQUIRE_EQUAL(originalVertices.size(), 9u);
+    BOOST_CHECK_EQUAL(originalVertices.back(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(reorderConnectivityArrays_throws_for_invalid_vertex_index)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createShuffledSquareArrays(2, vertices, elementCorners);
+    elementCorners(1, 3) = vertices.n_cols;
+
+    std::vector<int> domainIndices, originalElements, originalVertices;
+    BOOST_CHECK_THROW(reorderConnectivityArrays(
+                          GridParameters::MORTON_ORDERING,
+                          vertices, elementCorners, domainIndices,
+                          originalElements, originalVertices),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SpaceFillingCurve_Grid)
+
+BOOST_AUTO_TEST_CASE(original_indices_are_identity_by_default)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createShuffledSquareArrays(2, vertices, elementCorners);
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+
+    std::vector<int> originalElements, originalVertices;
+    grid->getOriginalElementIndices(originalElements);
+    grid->getOriginalVertexIndices(originalVertices);
+    BOOST_REQUIRE_EQUAL(originalElements.size(), 8u);
+    BOOST_REQUIRE_EQUAL(originalVertices.size(), 9u);
+    for (int e = 0; e < 8; ++e)
+        BOOST_CHECK_EQUAL(originalElements[e], e);
+    for (int v = 0; v < 9; ++v)
+        BOOST_CHECK_EQUAL(originalVertices[v], v);
+}
+
+BOOST_AUTO_TEST_CASE(flat_grid_stores_original_indices_of_renumbered_grid)
+{
+    arma::Mat<double> vertices;
+    arma::Mat<int> elementCorners;
+    createShuffledSquareArrays(4, vertices, elementCorners);
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    params.elementOrdering = GridParameters::MORTON_ORDERING;
+    shared_ptr<Grid> grid = GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+
+    std::vector<int> originalElements, originalVertices;
+    grid->getOriginalElementIndices(originalElements);
+    grid->getOriginalVertexIndices(originalVertices);
+
+    arma::Mat<double> rawVertices;
+    arma::Mat<int> rawElementCorners;
+    arma::Mat<char> auxData;
+    grid->leafView()->getRawElementData(rawVertices, rawElementCorners, auxData);
+    BOOST_REQUIRE_EQUAL(rawElementCorners.n_cols, elementCorners.n_cols);
+    for (size_t e = 0; e < rawElementCorners.n_cols; ++e)
+        for (int c = 0; c < 3; ++c) {
+            const int v = rawElementCorners(c, e);
+            BOOST_CHECK_EQUAL(originalVertices[v],
+                              elementCorners(c, originalElements[e]));
+            for (int dim = 0; dim < 3; ++dim)
+                BOOST_CHECK_EQUAL(rawVertices(dim, v),
+                                  vertices(dim, originalVertices[v]));
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
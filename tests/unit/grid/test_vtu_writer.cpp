@@ -0,0 +1,320 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "grid/flat_triangle_grid.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/vtk_writer.hpp"
+#include "grid/vtu_writer.hpp"
+#include "bempp/common/config_zlib.hpp"
+
+#include <armadillo>
+#include <boost/cstdint.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace Bempp;
+
+namespace
+{
+
+typedef boost::uint64_t HeaderType;
+
+// Unit square in the plane z = 0 divided into 2 * n * n triangles; large
+// enough for data arrays to span several blocks
+void createSquareArrays(int n, arma::Mat<double>& vertices,
+                        arma::Mat<int>& elementCorners)
+{
+    vertices.set_size(3, (n + 1) * (n + 1));
+    for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i) {
+            vertices(0, j * (n + 1) + i) = i / double(n);
+            vertices(1, j * (n + 1) + i) = j / double(n);
+            vertices(2, j * (n + 1) + i) = 0.;
+        }
+    elementCorners.set_size(3, 2 * n * n);
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            const int v = j * (n + 1) + i;
+            const int e = 2 * (j * n + i);
+            elementCorners(0, e) = v;
+            elementCorners(1, e) = v + 1;
+            elementCorners(2, e) = v + n + 2;
+            elementCorners(0, e + 1) = v;
+            elementCorners(1, e + 1) = v + n + 2;
+            elementCorners(2, e + 1) = v + n + 1;
+        }
+}
+
+struct VtuWriterFixture
+{
+    VtuWriterFixture() {
+        arma::Mat<double> vertices;
+        arma::Mat<int> elementCorners;
+        createSquareArrays(50, vertices, elementCorners);
+        grid.reset(new FlatTriangleGrid(vertices, elementCorners));
+        view = grid->leafView();
+        vtkWriter = view->vtkWriter();
+
+        cellData.set_size(4, grid->elementCount());
+        for (size_t i = 0; i < cellData.n_elem; ++i)
+            cellData[i] = 0.1 * i - 1000. / (i + 1);
+        vertexData.set_size(1, grid->vertexCount());
+        for (size_t i = 0; i < vertexData.n_elem; ++i)
+            vertexData[i] = 0.25f * i;
+        vtkWriter->addCellData(cellData, "cell_data");
+        vtkWriter->addVertexData(vertexData, "vertex_data");
+    }
+
+    std::auto_ptr<FlatTriangleGrid> grid;
+    std::auto_ptr<GridView> view;
+    std::auto_ptr<VtkWriter> vtkWriter;
+    arma::Mat<double> cellData;
+    arma::Mat<float> vertexData;
+};
+
+std::string readFile(const std::string& fileName)
+{
+    std::ifstream in(fileName.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+std::vector<size_t> appendedOffsets(const std::string& contents)
+{
+    std::vector<size_t> offsets;
+    const std::string key = "offset=\"";
+    for (size_t pos = contents.find(key); pos != std::string::npos;
+         pos = contents.find(key, pos + 1))
+        offsets.push_back(std::strtoul(&contents[pos + key.size()], 0, 10));
+    return offsets;
+}
+
+size_t appendedDataBegin(const std::string& contents)
+{
+    return contents.find('_', contents.find("<AppendedData")) + 1;
+}
+
+std::string decodeBase64(const std::string& text)
+{
+    const std::string alphabet =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    unsigned int bits = 0;
+    int bitCount = 0;
+    for (size_t i = 0; i < text.size() && text[i] != '='; ++i) {
+        bits = (bits << 6) | alphabet.find(text[i]);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            result.push_back(char((bits >> bitCount) & 0xff));
+        }
+    }
+    return result;
+}
+
+// Contents (without headers) of the arrays stored in an appended raw file
+std::vector<std::string> rawArrays(const std::string& contents)
+{
+    const std::vector<size_t> offsets = appendedOffsets(contents);
+    const size_t begin = appendedDataBegin(contents);
+    std::vector<std::string> arrays;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        HeaderType size;
+        std::memcpy(&size, &contents[begin + offsets[i]], sizeof(size));
+        arrays.push_back(contents.substr(
+                             begin + offsets[i] + sizeof(size), size));
+    }
+    return arrays;
+}
+
+template <typename T>
+std::string bytes(const arma::Mat<T>& data)
+{
+    return std::string(reinterpret_cast<const char*>(data.memptr()),
+                       data.n_elem * sizeof(T));
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(VtuWriter_, VtuWriterFixture)
+
+BOOST_AUTO_TEST_CASE(vtkWriter_of_flat_grid_is_a_VtuWriter)
+{
+    BOOST_CHECK(dynamic_cast<VtuWriter*>(vtkWriter.get()));
+}
+
+BOOST_AUTO_TEST_CASE(addCellData_throws_for_data_of_wrong_size)
+{
+    arma::Mat<double> data(2, grid->elementCount() + 1);
+    BOOST_CHECK_THROW(vtkWriter->addCellData(data, "wrong"), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(write_returns_name_of_created_file)
+{
+    const std::string fileName = vtkWriter->write("test_vtu_writer_name");
+    BOOST_CHECK_EQUAL(fileName, "test_vtu_writer_name.vtu");
+    BOOST_CHECK(!readFile(fileName).empty());
+    std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(appended_raw_output_contains_data_and_connectivity)
+{
+    const std::string fileName =
+            vtkWriter->write("test_vtu_writer_raw", VtkWriter::APPENDED_RAW);
+    const std::vector<std::string> arrays = rawArrays(readFile(fileName));
+    std::remove(fileName.c_str());
+
+    // vertex data, cell data, points, connectivity, offsets, types
+    BOOST_REQUIRE_EQUAL(arrays.size(), 6u);
+    BOOST_CHECK(arrays[0] == bytes(vertexData));
+    BOOST_CHECK(arrays[1] == bytes(cellData));
+    BOOST_CHECK(arrays[2] == bytes(grid->vertices()));
+    BOOST_CHECK(arrays[3] == bytes(grid->elementCorners()));
+    BOOST_REQUIRE_EQUAL(arrays[4].size(), grid->elementCount() * sizeof(int));
+    int lastOffset;
+    std::memcpy(&lastOffset, &arrays[4][arrays[4].size() - sizeof(int)],
+                sizeof(int));
+    BOOST_CHECK_EQUAL(lastOffset, 3 * (int)grid->elementCount());
+    BOOST_CHECK(arrays[5] == std::string(grid->elementCount(), char(5)));
+}
+
+BOOST_AUTO_TEST_CASE(appended_base64_output_decodes_to_appended_raw_output)
+{
+    const std::string rawFileName =
+            vtkWriter->write("test_vtu_writer_raw", VtkWriter::APPENDED_RAW);
+    const std::vector<std::string> expected = rawArrays(readFile(rawFileName));
+    std::remove(rawFileName.c_str());
+    const std::string fileName = vtkWriter->write(
+                "test_vtu_writer_base64", VtkWriter::APPENDED_BASE_64);
+    const std::string contents = readFile(fileName);
+    std::remove(fileName.c_str());
+
+    const std::vector<size_t> offsets = appendedOffsets(contents);
+    const size_t begin = appendedDataBegin(contents);
+    const size_t end = contents.find('\n', begin);
+    BOOST_REQUIRE_EQUAL(offsets.size(), expected.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const size_t next = i + 1 < offsets.size() ? begin + offsets[i + 1] : end;
+        const std::string decoded = decodeBase64(
+                    contents.substr(begin + offsets[i], next - begin - offsets[i]));
+        BOOST_CHECK(decoded.substr(sizeof(HeaderType)) == expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ascii_output_contains_values_of_cell_data)
+{
+    const std::string fileName = vtkWriter->write("test_vtu_writer_ascii");
+    const std::string contents = readFile(fileName);
+    std::remove(fileName.c_str());
+
+    const size_t pos = contents.find('>', contents.find("Name=\"cell_data\""));
+    std::istringstream in(contents.substr(pos + 1));
+    bool allEqual = true;
+    for (size_t i = 0; i < cellData.n_elem; ++i) {
+        double value;
+        in >> value;
+        allEqual = allEqual && value == cellData[i];
+    }
+    BOOST_CHECK(allEqual);
+}
+
+#ifdef WITH_ZLIB
+
+BOOST_AUTO_TEST_CASE(compressed_output_decompresses_to_appended_raw_output)
+{
+    const std::string rawFileName =
+            vtkWriter->write("test_vtu_writer_raw", VtkWriter::APPENDED_RAW);
+    const std::vector<std::string> expected = rawArrays(readFile(rawFileName));
+    std::remove(rawFileName.c_str());
+    const std::string fileName = vtkWriter->write(
+                "test_vtu_writer_zlib", VtkWriter::APPENDED_RAW_COMPRESSED);
+    const std::string contents = readFile(fileName);
+    std::remove(fileName.c_str());
+
+    BOOST_CHECK(contents.find("compressor=\"vtkZLibDataCompressor\"") !=
+                std::string::npos);
+    const std::vector<size_t> offsets = appendedOffsets(contents);
+    const size_t begin = appendedDataBegin(contents);
+    BOOST_REQUIRE_EQUAL(offsets.size(), expected.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const char* p = &contents[begin + offsets[i]];
+        HeaderType blockCount, blockSize, lastBlockSize;
+        std::memcpy(&blockCount, p, sizeof(HeaderType));
+        std::memcpy(&blockSize, p + sizeof(HeaderType), sizeof(HeaderType));
+        std::memcpy(&lastBlockSize, p + 2 * sizeof(HeaderType),
+                    sizeof(HeaderType));
+        const char* data = p + (3 + blockCount) * sizeof(HeaderType);
+        std::string decompressed;
+        for (HeaderType b = 0; b < blockCount; ++b) {
+            HeaderType compressedSize;
+            std::memcpy(&compressedSize, p + (3 + b) * sizeof(HeaderType),
+                        sizeof(HeaderType));
+            uLongf size = (b + 1 == blockCount && lastBlockSize != 0) ?
+                        lastBlockSize : blockSize;
+            std::vector<char> block(size);
+            BOOST_REQUIRE_EQUAL(
+                        uncompress(reinterpret_cast<Bytef*>(&block[0]), &size,
+                                   reinterpret_cast<const Bytef*>(data),
+                                   compressedSize), Z_OK);
+            decompressed.append(&block[0], size);
+            data += compressedSize;
+        }
+        BOOST_CHECK(decompressed == expected[i]);
+    }
+}
+
+#else
+
+BOOST_AUTO_TEST_CASE(compressed_output_throws_without_zlib)
+{
+    BOOST_CHECK_THROW(vtkWriter->write("test_vtu_writer_zlib",
+                                       VtkWriter::APPENDED_RAW_COMPRESSED),
+                      std::runtime_error);
+}
+
+#endif
+
+BOOST_AUTO_TEST_CASE(pwrite_uses_dune_file_naming_scheme)
+{
+    const std::string fileName = vtkWriter->pwrite(
+                "test_vtu_writer_pwrite", ".", ".", VtkWriter::APPENDED_RAW);
+    BOOST_CHECK_EQUAL(fileName, "./s0001:test_vtu_writer_pwrite.pvtu");
+    const std::string contents = readFile(fileName);
+    BOOST_CHECK(contents.find(
+                    "<Piece Source=\"./s0001:p0000:test_vtu_writer_pwrite.vtu\"/>") !=
+                std::string::npos);
+    BOOST_CHECK(!readFile("./s0001:p0000:test_vtu_writer_pwrite.vtu").empty());
+    std::remove(fileName.c_str());
+    std::remove("./s0001:p0000:test_vtu_writer_pwrite.vtu");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
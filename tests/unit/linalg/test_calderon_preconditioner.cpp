@@ -0,0 +1,102 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "bempp/common/config_trilinos.hpp"
+
+#ifdef WITH_TRILINOS
+
+#include "../type_template.hpp"
+#include "../check_arrays_are_close.hpp"
+
+#include "laplace_3d_dirichlet_fixture.hpp"
+
+#include "assembly/laplace_3d_hypersingular_boundary_operator.hpp"
+#include "linalg/calderon_preconditioner.hpp"
+#include "linalg/default_iterative_solver.hpp"
+#include "linalg/solver.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <stdexcept>
+
+using namespace Bempp;
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(CalderonPreconditioner)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(preconditioned_solution_agrees_with_unpreconditioned_one,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture(
+        PIECEWISE_LINEARS, PIECEWISE_LINEARS, PIECEWISE_LINEARS, PIECEWISE_LINEARS);
+    const BoundaryOperator<BFT, RT>& slpOp = fixture.lhsOp;
+    BoundaryOperator<BFT, RT> hypOp =
+        laplace3dHypersingularBoundaryOperator<BFT, RT>(
+            slpOp.context(), slpOp.range(), slpOp.domain(), slpOp.dualToRange());
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-6;
+
+    IterSolver solver(
+        slpOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(defaultGmresParameterList(solverTol));
+    Solution<BFT, RT> solution = solver.solve(fixture.rhs);
+    arma::Col<RT> solutionVector = solution.gridFunction().coefficients();
+
+    IterSolver preconditionedSolver(
+        slpOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    preconditionedSolver.initializeSolver(
+        defaultGmresParameterList(solverTol),
+        calderonPreconditioner(slpOp, hypOp));
+    Solution<BFT, RT> preconditionedSolution =
+        preconditionedSolver.solve(fixture.rhs);
+    arma::Col<RT> preconditionedSolutionVector =
+        preconditionedSolution.gridFunction().coefficients();
+
+    BOOST_CHECK_EQUAL(preconditionedSolution.status(), SolutionStatus::CONVERGED);
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    preconditionedSolutionVector, solutionVector,
+                    solverTol * 1000.));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(mismatched_spaces_are_rejected,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture(
+        PIECEWISE_LINEARS, PIECEWISE_CONSTANTS, PIECEWISE_LINEARS, PIECEWISE_CONSTANTS);
+    const BoundaryOperator<BFT, RT>& slpOp = fixture.lhsOp;
+
+    // The domain of the preconditioning operator should be the range of slpOp
+    BOOST_CHECK_THROW(calderonPreconditioner(slpOp, slpOp),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
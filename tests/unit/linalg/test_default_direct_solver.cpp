@@ -165,4 +165,74 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(boundary_operator_agrees_with_2x2_blocked_boundary
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_multiple_agrees_with_solve,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultDirectSolver<BFT, RT> DirectSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    DirectSolver solver(fixture.lhsOp);
+    arma::Col<RT> solutionVectorSingle =
+            solver.solve(fixture.rhs).gridFunction().coefficients();
+
+    std::vector<GridFunction<BFT, RT> > rhs(2);
+    rhs[0] = fixture.rhs;
+    rhs[1] = 2. * fixture.rhs;
+    std::vector<Solution<BFT, RT> > solutions = solver.solveMultiple(rhs);
+    BOOST_CHECK_EQUAL(solutions.size(), 2u);
+
+    arma::Col<RT> solutionVector0 = solutions[0].gridFunction().coefficients();
+    arma::Col<RT> solutionVector1 = solutions[1].gridFunction().coefficients() / 2.;
+
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    solutionVectorSingle, solutionVector0, solverTol * 10));
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    solutionVectorSingle, solutionVector1, solverTol * 10));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_multiple_agrees_with_solve_for_blocked_boundary_operator,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultDirectSolver<BFT, RT> DirectSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    BlockedOperatorStructure<BFT, RT> structure;
+    structure.setBlock(0, 0, fixture.lhsOp);
+    structure.setBlock(1, 1, fixture.lhsOp);
+    BlockedBoundaryOperator<BFT, RT> lhsBlockedOp(structure);
+
+    std::vector<std::vector<GridFunction<BFT, RT> > > blockedRhs(
+                2, std::vector<GridFunction<BFT, RT> >(2));
+    blockedRhs[0][0] = fixture.rhs;
+    blockedRhs[0][1] = 2. * fixture.rhs;
+    blockedRhs[1][0] = 3. * fixture.rhs;
+    blockedRhs[1][1] = 4. * fixture.rhs;
+
+    DirectSolver solver(lhsBlockedOp);
+    std::vector<BlockedSolution<BFT, RT> > solutions =
+            solver.solveMultiple(blockedRhs);
+    BOOST_CHECK_EQUAL(solutions.size(), 2u);
+
+    for (size_t i = 0; i < 2; ++i) {
+        BlockedSolution<BFT, RT> solution = solver.solve(blockedRhs[i]);
+        for (size_t block = 0; block < 2; ++block)
+            BOOST_CHECK(check_arrays_are_close<ValueType>(
+                            solution.gridFunction(block).coefficients(),
+                            solutions[i].gridFunction(block).coefficients(),
+                            solverTol * 10));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
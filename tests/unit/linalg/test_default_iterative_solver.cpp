@@ -355,6 +355,126 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(boundary_operator_agrees_with_2x2_blocked_boundary
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_multiple_agrees_with_solve_for_convergence_testing_in_dual,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    IterSolver solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(defaultGmresParameterList(solverTol));
+    arma::Col<RT> solutionVectorSingle =
+            solver.solve(fixture.rhs).gridFunction().coefficients();
+
+    std::vector<GridFunction<BFT, RT> > rhs(3);
+    rhs[0] = fixture.rhs;
+    rhs[1] = 2. * fixture.rhs;
+    rhs[2] = -1. * fixture.rhs;
+    std::vector<Solution<BFT, RT> > solutions = solver.solveMultiple(rhs);
+    BOOST_CHECK_EQUAL(solutions.size(), 3u);
+
+    const RT factors[] = { 1., 2., -1. };
+    for (size_t i = 0; i < solutions.size(); ++i) {
+        BOOST_CHECK_EQUAL(solutions[i].status(), SolutionStatus::CONVERGED);
+        arma::Col<RT> solutionVector =
+                solutions[i].gridFunction().coefficients() / factors[i];
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        solutionVectorSingle, solutionVector, solverTol * 10));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_multiple_agrees_with_solve_for_blocked_boundary_operator_and_convergence_testing_in_range,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    BlockedOperatorStructure<BFT, RT> structure;
+    structure.setBlock(0, 0, fixture.lhsOp);
+    structure.setBlock(1, 1, fixture.lhsOp);
+    BlockedBoundaryOperator<BFT, RT> lhsBlockedOp(structure);
+
+    std::vector<std::vector<GridFunction<BFT, RT> > > blockedRhs(
+                2, std::vector<GridFunction<BFT, RT> >(2));
+    blockedRhs[0][0] = fixture.rhs;
+    blockedRhs[0][1] = 2. * fixture.rhs;
+    blockedRhs[1][0] = 3. * fixture.rhs;
+    blockedRhs[1][1] = 4. * fixture.rhs;
+
+    IterSolver solver(
+        lhsBlockedOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_RANGE);
+    solver.initializeSolver(defaultGmresParameterList(solverTol));
+    std::vector<BlockedSolution<BFT, RT> > solutions =
+            solver.solveMultiple(blockedRhs);
+    BOOST_CHECK_EQUAL(solutions.size(), 2u);
+
+    for (size_t i = 0; i < 2; ++i) {
+        BlockedSolution<BFT, RT> solution = solver.solve(blockedRhs[i]);
+        for (size_t block = 0; block < 2; ++block)
+            BOOST_CHECK(check_arrays_are_close<ValueType>(
+                            solution.gridFunction(block).coefficients(),
+                            solutions[i].gridFunction(block).coefficients(),
+                            solverTol * 10));
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(gcrodr_solver_agrees_with_gmres_after_change_of_operator,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    IterSolver gmresSolver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    gmresSolver.initializeSolver(defaultGmresParameterList(solverTol));
+    arma::Col<RT> gmresSolutionVector =
+            gmresSolver.solve(fixture.rhs).gridFunction().coefficients();
+
+    IterSolver gcrodrSolver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    gcrodrSolver.initializeSolver(defaultGcrodrParameterList(
+                                      solverTol, 1000, 20, 5));
+
+    // Solve twice with the same operator (the second solve uses the
+    // recycled subspace)...
+    for (int i = 0; i < 2; ++i) {
+        Solution<BFT, RT> solution = gcrodrSolver.solve(fixture.rhs);
+        BOOST_CHECK_EQUAL(solution.status(), SolutionStatus::CONVERGED);
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        gmresSolutionVector,
+                        solution.gridFunction().coefficients(),
+                        solverTol * 10));
+    }
+
+    // ... and once after replacing the operator with a scaled copy
+    gcrodrSolver.setBoundaryOperator(2. * fixture.lhsOp);
+    Solution<BFT, RT> solution = gcrodrSolver.solve(fixture.rhs);
+    BOOST_CHECK_EQUAL(solution.status(), SolutionStatus::CONVERGED);
+    arma::Col<RT> solutionVector =
+            solution.gridFunction().coefficients() * static_cast<RT>(2.);
+    BOOST_CHECK(check_arrays_are_close<ValueType>(
+                    gmresSolutionVector, solutionVector, solverTol * 10));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
@@ -0,0 +1,214 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "space/dof_assignment.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include <armadillo>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Local-to-global DOF map of a P1 space on two triangles sharing the edge
+// (1, 2): element 0 has corners 0, 1, 2 and element 1 has corners 2, 1, 3
+std::vector<std::vector<GlobalDofIndex> > createLocal2GlobalDofs()
+{
+    const int dofs[2][3] = {{0, 1, 2}, {2, 1, 3}};
+    std::vector<std::vector<GlobalDofIndex> > local2globalDofs(2);
+    for (int e = 0; e < 2; ++e)
+        local2globalDofs[e].assign(dofs[e], dofs[e] + 3);
+    return local2globalDofs;
+}
+
+struct DummyDofMaps
+{
+    const Grid* grid;
+};
+
+// Creates DummyDofMaps and counts its calls
+class CountingDofMapCreator
+{
+public:
+    explicit CountingDofMapCreator(int& callCount) : m_callCount(callCount) {
+    }
+
+    std::auto_ptr<DummyDofMaps> operator()(const Grid& grid) const {
+        ++m_callCount;
+        std::auto_ptr<DummyDofMaps> maps(new DummyDofMaps);
+        maps->grid = &grid;
+        return maps;
+    }
+
+private:
+    int& m_callCount;
+};
+
+// Creates DummyDofMaps after obtaining the DOF maps of another grid from the
+// same cache, as the creator of a space built from other spaces would
+class NestedDofMapCreator
+{
+public:
+    NestedDofMapCreator(DofMapCache<DummyDofMaps>& cache, const Grid& otherGrid,
+                        shared_ptr<const DummyDofMaps>& otherMaps) :
+        m_cache(cache), m_otherGrid(otherGrid), m_otherMaps(otherMaps) {
+    }
+
+    std::auto_ptr<DummyDofMaps> operator()(const Grid& grid) const {
+        int callCount = 0;
+        m_otherMaps = m_cache.get(m_otherGrid,
+                                  CountingDofMapCreator(callCount));
+        std::auto_ptr<DummyDofMaps> maps(new DummyDofMaps);
+        maps->grid = &grid;
+        return maps;
+    }
+
+private:
+    DofMapCache<DummyDofMaps>& m_cache;
+    const Grid& m_otherGrid;
+    shared_ptr<const DummyDofMaps>& m_otherMaps;
+};
+
+shared_ptr<Grid> createSingleTriangleGrid()
+{
+    arma::Mat<double> vertices(3, 3);
+    vertices.fill(0.);
+    vertices(0, 1) = vertices(1, 2) = 1.;
+    arma::Mat<int> elementCorners(3, 1);
+    for (int c = 0; c < 3; ++c)
+        elementCorners(c, 0) = c;
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    return GridFactory::createFlatGridFromConnectivityArrays(
+                params, vertices, elementCorners);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(DofAssignment)
+
+BOOST_AUTO_TEST_CASE(DofMapCache_shares_dof_maps_of_the_same_grid)
+{
+    shared_ptr<Grid> grid1 = createSingleTriangleGrid();
+    shared_ptr<Grid> grid2 = createSingleTriangleGrid();
+    DofMapCache<DummyDofMaps> cache;
+    int callCount = 0;
+    CountingDofMapCreator create(callCount);
+
+    shared_ptr<const DummyDofMaps> maps1 = cache.get(*grid1, create);
+    shared_ptr<const DummyDofMaps> maps1Again = cache.get(*grid1, create);
+    BOOST_CHECK_EQUAL(callCount, 1);
+    BOOST_CHECK(maps1 == maps1Again);
+    BOOST_CHECK(maps1->grid == grid1.get());
+
+    shared_ptr<const DummyDofMaps> maps2 = cache.get(*grid2, create);
+    BOOST_CHECK_EQUAL(callCount, 2);
+    BOOST_CHECK(maps2 != maps1);
+    BOOST_CHECK(maps2->grid == grid2.get());
+}
+
+BOOST_AUTO_TEST_CASE(DofMapCache_recreates_dof_maps_released_by_all_users)
+{
+    shared_ptr<Grid> grid = createSingleTriangleGrid();
+    DofMapCache<DummyDofMaps> cache;
+    int callCount = 0;
+    CountingDofMapCreator create(callCount);
+
+    cache.get(*grid, create); // released immediately
+    shared_ptr<const DummyDofMaps> maps = cache.get(*grid, create);
+    BOOST_CHECK_EQUAL(callCount, 2);
+    BOOST_CHECK(maps->grid == grid.get());
+}
+
+BOOST_AUTO_TEST_CASE(DofMapCache_can_be_used_by_the_creator)
+{
+    shared_ptr<Grid> grid1 = createSingleTriangleGrid();
+    shared_ptr<Grid> grid2 = createSingleTriangleGrid();
+    DofMapCache<DummyDofMaps> cache;
+    shared_ptr<const DummyDofMaps> maps2;
+
+    shared_ptr<const DummyDofMaps> maps1 =
+            cache.get(*grid1, NestedDofMapCreator(cache, *grid2, maps2));
+    BOOST_CHECK(maps1->grid == grid1.get());
+    BOOST_REQUIRE(maps2);
+    BOOST_CHECK(maps2->grid == grid2.get());
+
+    int callCount = 0;
+    CountingDofMapCreator create(callCount);
+    BOOST_CHECK(cache.get(*grid1, create) == maps1);
+    BOOST_CHECK(cache.get(*grid2, create) == maps2);
+    BOOST_CHECK_EQUAL(callCount, 0);
+}
+
+BOOST_AUTO_TEST_CASE(invertLocal2GlobalDofMap_works)
+{
+    std::vector<std::vector<LocalDof> > global2localDofs;
+    invertLocal2GlobalDofMap(createLocal2GlobalDofs(), 4, global2localDofs);
+
+    BOOST_REQUIRE_EQUAL(global2localDofs.size(), 4u);
+    const int expectedCounts[4] = {1, 2, 2, 1};
+    for (int g = 0; g < 4; ++g)
+        BOOST_CHECK_EQUAL(global2localDofs[g].size(), (size_t)expectedCounts[g]);
+
+    // Local DOFs are listed in order of increasing element index
+    BOOST_CHECK_EQUAL(global2localDofs[1][0].entityIndex, 0);
+    BOOST_CHECK_EQUAL(global2localDofs[1][0].dofIndex, 1);
+    BOOST_CHECK_EQUAL(global2localDofs[1][1].entityIndex, 1);
+    BOOST_CHECK_EQUAL(global2localDofs[1][1].dofIndex, 1);
+    BOOST_CHECK_EQUAL(global2localDofs[2][0].entityIndex, 0);
+    BOOST_CHECK_EQUAL(global2localDofs[2][0].dofIndex, 2);
+    BOOST_CHECK_EQUAL(global2localDofs[2][1].entityIndex, 1);
+    BOOST_CHECK_EQUAL(global2localDofs[2][1].dofIndex, 0);
+    BOOST_CHECK_EQUAL(global2localDofs[3][0].entityIndex, 1);
+    BOOST_CHECK_EQUAL(global2localDofs[3][0].dofIndex, 2);
+}
+
+BOOST_AUTO_TEST_CASE(invertLocal2GlobalDofMap_leaves_unused_global_dofs_empty)
+{
+    std::vector<std::vector<LocalDof> > global2localDofs;
+    invertLocal2GlobalDofMap(createLocal2GlobalDofs(), 6, global2localDofs);
+
+    BOOST_REQUIRE_EQUAL(global2localDofs.size(), 6u);
+    BOOST_CHECK(global2localDofs[4].empty());
+    BOOST_CHECK(global2localDofs[5].empty());
+}
+
+BOOST_AUTO_TEST_CASE(createFlatLocal2LocalDofMap_works)
+{
+    std::vector<LocalDof> flatLocal2localDofs;
+    const size_t count = createFlatLocal2LocalDofMap(
+                createLocal2GlobalDofs(), flatLocal2localDofs);
+
+    BOOST_CHECK_EQUAL(count, 6u);
+    BOOST_REQUIRE_EQUAL(flatLocal2localDofs.size(), 6u);
+    for (int e = 0; e < 2; ++e)
+        for (int dof = 0; dof < 3; ++dof) {
+            BOOST_CHECK_EQUAL(flatLocal2localDofs[3 * e + dof].entityIndex, e);
+            BOOST_CHECK_EQUAL(flatLocal2localDofs[3 * e + dof].dofIndex, dof);
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
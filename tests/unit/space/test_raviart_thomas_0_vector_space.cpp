@@ -0,0 +1,171 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../type_template.hpp"
+
+#include "common/scalar_traits.hpp"
+
+#include "grid/entity.hpp"
+#include "grid/entity_iterator.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/index_set.hpp"
+#include "grid/mapper.hpp"
+
+#include "space/raviart_thomas_0_vector_space.hpp"
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+using namespace Bempp;
+
+namespace
+{
+
+// DOF maps of an RT0 space computed element by element from the index set of
+// the grid view, in the way used before the DOF maps were built from the grid
+// connectivity
+template <typename BasisFunctionType>
+void referenceRaviartThomas0DofMaps(
+        const GridView& view,
+        std::vector<std::vector<GlobalDofIndex> >& local2globalDofs,
+        std::vector<std::vector<BasisFunctionType> >& local2globalDofWeights,
+        std::vector<std::vector<LocalDof> >& global2localDofs,
+        std::vector<std::vector<BasisFunctionType> >& global2localDofWeights)
+{
+    const Mapper& elementMapper = view.elementMapper();
+    const IndexSet& indexSet = view.indexSet();
+    local2globalDofs.assign(view.entityCount(0),
+                            std::vector<GlobalDofIndex>());
+    local2globalDofWeights.assign(view.entityCount(0),
+                                  std::vector<BasisFunctionType>());
+    global2localDofs.assign(view.entityCount(1), std::vector<LocalDof>());
+    global2localDofWeights.assign(view.entityCount(1),
+                                  std::vector<BasisFunctionType>());
+
+    // Dune numbers the edges of a triangle (0, 1), (2, 0), (1, 2)
+    const int edgeVertices[3][2] = {{0, 1}, {2, 0}, {1, 2}};
+    for (std::auto_ptr<EntityIterator<0> > it = view.entityIterator<0>();
+         !it->finished(); it->next()) {
+        const Entity<0>& element = it->entity();
+        const EntityIndex elementIndex = elementMapper.entityIndex(element);
+        for (int i = 0; i < 3; ++i) {
+            const GlobalDofIndex globalDof = indexSet.subEntityIndex(element, i, 1);
+            const int vertex1 =
+                    indexSet.subEntityIndex(element, edgeVertices[i][0], 2);
+            const int vertex2 =
+                    indexSet.subEntityIndex(element, edgeVertices[i][1], 2);
+            const BasisFunctionType weight = vertex1 < vertex2 ? 1. : -1.;
+            local2globalDofs[elementIndex].push_back(globalDof);
+            local2globalDofWeights[elementIndex].push_back(weight);
+            global2localDofs[globalDof].push_back(LocalDof(elementIndex, i));
+            global2localDofWeights[globalDof].push_back(weight);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RaviartThomas0VectorSpace_)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(dof_maps_agree_with_index_set_on_dune_grid,
+                              BasisFunctionType, basis_function_types)
+{
+    typedef BasisFunctionType BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.4.msh", false /* verbose */);
+    RaviartThomas0VectorSpace<BFT> space(grid);
+
+    std::auto_ptr<GridView> view = grid->leafView();
+    std::vector<std::vector<GlobalDofIndex> > expectedLocal2globalDofs;
+    std::vector<std::vector<BFT> > expectedLocal2globalDofWeights;
+    std::vector<std::vector<LocalDof> > expectedGlobal2localDofs;
+    std::vector<std::vector<BFT> > expectedGlobal2localDofWeights;
+    referenceRaviartThomas0DofMaps(*view,
+                                   expectedLocal2globalDofs,
+                                   expectedLocal2globalDofWeights,
+                                   expectedGlobal2localDofs,
+                                   expectedGlobal2localDofWeights);
+
+    BOOST_CHECK_EQUAL(space.globalDofCount(), view->entityCount(1));
+    BOOST_CHECK_EQUAL(space.flatLocalDofCount(), 3 * view->entityCount(0));
+
+    const Mapper& elementMapper = view->elementMapper();
+    std::vector<GlobalDofIndex> dofs;
+    std::vector<BFT> weights;
+    for (std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
+         !it->finished(); it->next()) {
+        const Entity<0>& element = it->entity();
+        const EntityIndex index = elementMapper.entityIndex(element);
+        space.getGlobalDofs(element, dofs, weights);
+        BOOST_CHECK(dofs == expectedLocal2globalDofs[index]);
+        BOOST_CHECK(weights == expectedLocal2globalDofWeights[index]);
+    }
+
+    std::vector<GlobalDofIndex> globalDofs(space.globalDofCount());
+    for (size_t g = 0; g < globalDofs.size(); ++g)
+        globalDofs[g] = g;
+    std::vector<std::vector<LocalDof> > localDofs;
+    std::vector<std::vector<BFT> > localDofWeights;
+    space.global2localDofs(globalDofs, localDofs, localDofWeights);
+    BOOST_REQUIRE_EQUAL(localDofs.size(), expectedGlobal2localDofs.size());
+    for (size_t g = 0; g < globalDofs.size(); ++g) {
+        BOOST_REQUIRE_EQUAL(localDofs[g].size(),
+                            expectedGlobal2localDofs[g].size());
+        for (size_t l = 0; l < localDofs[g].size(); ++l) {
+            BOOST_CHECK_EQUAL(localDofs[g][l].entityIndex,
+                              expectedGlobal2localDofs[g][l].entityIndex);
+            BOOST_CHECK_EQUAL(localDofs[g][l].dofIndex,
+                              expectedGlobal2localDofs[g][l].dofIndex);
+        }
+        BOOST_CHECK(localDofWeights[g] == expectedGlobal2localDofWeights[g]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(spaces_on_the_same_grid_have_identical_dof_maps,
+                              BasisFunctionType, basis_function_types)
+{
+    typedef BasisFunctionType BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../examples/meshes/sphere-h-0.4.msh", false /* verbose */);
+    RaviartThomas0VectorSpace<BFT> space1(grid);
+    RaviartThomas0VectorSpace<BFT> space2(grid);
+
+    BOOST_CHECK_EQUAL(space1.globalDofCount(), space2.globalDofCount());
+    std::auto_ptr<GridView> view = grid->leafView();
+    std::vector<GlobalDofIndex> dofs1, dofs2;
+    std::vector<BFT> weights1, weights2;
+    for (std::auto_ptr<EntityIterator<0> > it = view->entityIterator<0>();
+         !it->finished(); it->next()) {
+        space1.getGlobalDofs(it->entity(), dofs1, weights1);
+        space2.getGlobalDofs(it->entity(), dofs2, weights2);
+        BOOST_CHECK(dofs1 == dofs2);
+        BOOST_CHECK(weights1 == weights2);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()